@@ -0,0 +1,2939 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench.cpp
+// Desc : Benchmark for d3dx9math_stub.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "d3dx9math_stub.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// BenchState class
+///////////////////////////////////////////////////////////////////////////////
+class BenchState
+{
+public:
+    BenchState(uint64_t iterations, int64_t arg)
+    : m_Iterations(iterations)
+    , m_Arg(arg)
+    { /* DO_NOTHING */ }
+
+    bool KeepRunning()
+    {
+        if (m_Count == 0)
+        { m_Start = Clock::now(); }
+
+        if (m_Count < m_Iterations)
+        {
+            ++m_Count;
+            return true;
+        }
+
+        m_Elapsed = std::chrono::duration<double>(Clock::now() - m_Start).count();
+        return false;
+    }
+
+    int64_t Arg() const
+    { return m_Arg; }
+
+    uint64_t Iterations() const
+    { return m_Iterations; }
+
+    double Elapsed() const
+    { return m_Elapsed; }
+
+    // 1反復あたりの処理量.
+    void SetItemsProcessed(uint64_t count)
+    { m_Items = count; }
+
+    void SetBytesProcessed(uint64_t bytes)
+    { m_Bytes = bytes; }
+
+    uint64_t ItemsProcessed() const
+    { return m_Items; }
+
+    uint64_t BytesProcessed() const
+    { return m_Bytes; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t            m_Iterations = 0;
+    uint64_t            m_Count      = 0;
+    int64_t             m_Arg        = 0;
+    uint64_t            m_Items      = 0;
+    uint64_t            m_Bytes      = 0;
+    double              m_Elapsed    = 0.0;
+    Clock::time_point   m_Start;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark class
+///////////////////////////////////////////////////////////////////////////////
+class Benchmark
+{
+public:
+    using Func = void (*)(BenchState&);
+
+    Benchmark(const char* name, Func func)
+    : m_Name(name)
+    , m_Func(func)
+    { /* DO_NOTHING */ }
+
+    Benchmark* Arg(int64_t value)
+    {
+        m_Args.push_back(value);
+        return this;
+    }
+
+    const char* Name() const
+    { return m_Name; }
+
+    Func Function() const
+    { return m_Func; }
+
+    const std::vector<int64_t>& Args() const
+    { return m_Args; }
+
+private:
+    const char*             m_Name;
+    Func                    m_Func;
+    std::vector<int64_t>    m_Args;
+};
+
+std::vector<Benchmark*>& GetBenchmarks()
+{
+    static std::vector<Benchmark*> s_Benchmarks;
+    return s_Benchmarks;
+}
+
+Benchmark* RegisterBenchmark(const char* name, Benchmark::Func func)
+{
+    auto bench = new Benchmark(name, func);
+    GetBenchmarks().push_back(bench);
+    return bench;
+}
+
+#define BENCHMARK_CONCAT2(a, b) a##b
+#define BENCHMARK_CONCAT(a, b)  BENCHMARK_CONCAT2(a, b)
+#define BENCHMARK(func) \
+    static Benchmark* BENCHMARK_CONCAT(s_Bench_, __LINE__) = RegisterBenchmark(#func, func)
+
+// 最適化で計算が消されないようにする.
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* s_Sink;
+    s_Sink = &value;
+    _ReadWriteBarrier();
+#endif
+}
+
+inline void ClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ volatile("" : : : "memory");
+#else
+    _ReadWriteBarrier();
+#endif
+}
+
+std::vector<float> RandomFloats(size_t count, float minValue, float maxValue)
+{
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> dist(minValue, maxValue);
+
+    std::vector<float> result(count);
+    for (auto& value : result)
+    { value = dist(rng); }
+    return result;
+}
+
+// float要素のみで構成される型をランダムに生成する.
+template<typename T>
+std::vector<T> RandomElements(size_t count, float minValue, float maxValue)
+{
+    const auto tmp = RandomFloats(count * sizeof(T) / sizeof(float), minValue, maxValue);
+    std::vector<T> result(count);
+    memcpy(static_cast<void*>(result.data()), tmp.data(), count * sizeof(T));
+    return result;
+}
+
+void RunBenchmark(const Benchmark& bench, int64_t arg, bool hasArg)
+{
+    const double kMinTime = 0.2;
+
+    uint64_t iterations = 1;
+    for (;;)
+    {
+        BenchState state(iterations, arg);
+        bench.Function()(state);
+
+        const auto elapsed = state.Elapsed();
+        if (elapsed >= kMinTime || iterations >= (uint64_t(1) << 40))
+        {
+            std::string name = bench.Name();
+            if (hasArg)
+            { name += "/" + std::to_string(arg); }
+
+            const auto nsPerOp = elapsed * 1e9 / double(iterations);
+            printf("%-48s %14.2f ns/op %12llu iter", name.c_str(), nsPerOp, (unsigned long long)iterations);
+
+            if (state.ItemsProcessed() != 0)
+            {
+                const auto items = double(state.ItemsProcessed()) * double(iterations) / elapsed;
+                printf(" %10.2f Mitems/s", items * 1e-6);
+            }
+
+            if (state.BytesProcessed() != 0)
+            {
+                const auto bytes = double(state.BytesProcessed()) * double(iterations) / elapsed;
+                printf(" %8.2f GB/s", bytes * 1e-9);
+            }
+
+            printf("\n");
+            return;
+        }
+
+        // 計測時間が最低時間を超えるように反復回数を見積もる.
+        auto scale = (elapsed > 0.0) ? (kMinTime * 1.4 / elapsed) : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        if (scale < 2.0)  scale = 2.0;
+        iterations = uint64_t(double(iterations) * scale);
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Float16
+///////////////////////////////////////////////////////////////////////////////
+
+// 従来の1要素ずつ変換するループ.
+void BM_Float32To16_Loop(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomFloats(n, -1000.0f, 1000.0f);
+    std::vector<D3DXFLOAT16> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { dst[i] = D3DXFLOAT16(src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) + sizeof(D3DXFLOAT16)));
+}
+BENCHMARK(BM_Float32To16_Loop)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXFloat32To16Array(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomFloats(n, -1000.0f, 1000.0f);
+    std::vector<D3DXFLOAT16> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXFloat32To16Array(dst.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) + sizeof(D3DXFLOAT16)));
+}
+BENCHMARK(BM_D3DXFloat32To16Array)->Arg(4096)->Arg(1 << 20);
+
+// 従来の1要素ずつ変換するループ.
+void BM_Float16To32_Loop(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto tmp = RandomFloats(n, -1000.0f, 1000.0f);
+    std::vector<D3DXFLOAT16> src(tmp.begin(), tmp.end());
+    std::vector<float> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { dst[i] = float(src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) + sizeof(D3DXFLOAT16)));
+}
+BENCHMARK(BM_Float16To32_Loop)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXFloat16To32Array(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto tmp = RandomFloats(n, -1000.0f, 1000.0f);
+    std::vector<D3DXFLOAT16> src(tmp.begin(), tmp.end());
+    std::vector<float> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXFloat16To32Array(dst.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) + sizeof(D3DXFLOAT16)));
+}
+BENCHMARK(BM_D3DXFloat16To32Array)->Arg(4096)->Arg(1 << 20);
+
+///////////////////////////////////////////////////////////////////////////////
+// Color
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<uint32_t> RandomARGB(size_t count)
+{
+    const auto bytes = RandomFloats(count * 4, 0.0f, 255.0f);
+
+    std::vector<uint32_t> result(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        result[i] = (uint32_t(bytes[i * 4 + 0]) << 24) | (uint32_t(bytes[i * 4 + 1]) << 16)
+                  | (uint32_t(bytes[i * 4 + 2]) <<  8) |  uint32_t(bytes[i * 4 + 3]);
+    }
+    return result;
+}
+
+// 従来の1要素ずつ変換するループ.
+void BM_ColorFromARGB_Loop(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomARGB(n);
+    std::vector<D3DXCOLOR> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { dst[i] = D3DXCOLOR(src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(uint32_t) + sizeof(D3DXCOLOR)));
+}
+BENCHMARK(BM_ColorFromARGB_Loop)->Arg(4096)->Arg(1 << 20);
+
+template<D3DXCOLORSPACE ColorSpace, bool Parallel>
+void BM_ColorFromARGB(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomARGB(n);
+    std::vector<D3DXCOLOR> dst(n);
+
+    while (state.KeepRunning())
+    {
+        if (Parallel)
+        { D3DXColorFromARGBArrayParallel(dst.data(), src.data(), uint32_t(n), ColorSpace); }
+        else
+        { D3DXColorFromARGBArray(dst.data(), src.data(), uint32_t(n), ColorSpace); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(uint32_t) + sizeof(D3DXCOLOR)));
+}
+
+void BM_D3DXColorFromARGBArray(BenchState& state)
+{ BM_ColorFromARGB<D3DXCOLORSPACE_LINEAR, false>(state); }
+BENCHMARK(BM_D3DXColorFromARGBArray)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXColorFromARGBArray_SRGB(BenchState& state)
+{ BM_ColorFromARGB<D3DXCOLORSPACE_SRGB, false>(state); }
+BENCHMARK(BM_D3DXColorFromARGBArray_SRGB)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXColorFromARGBArrayParallel_SRGB(BenchState& state)
+{ BM_ColorFromARGB<D3DXCOLORSPACE_SRGB, true>(state); }
+BENCHMARK(BM_D3DXColorFromARGBArrayParallel_SRGB)->Arg(1 << 20);
+
+// 従来の1要素ずつ変換するループ.
+void BM_ColorToARGB_Loop(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXCOLOR>(n, -0.1f, 1.1f);
+    std::vector<uint32_t> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { dst[i] = uint32_t(src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(uint32_t) + sizeof(D3DXCOLOR)));
+}
+BENCHMARK(BM_ColorToARGB_Loop)->Arg(4096)->Arg(1 << 20);
+
+template<D3DXCOLORSPACE ColorSpace, bool Parallel>
+void BM_ColorToARGB(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXCOLOR>(n, -0.1f, 1.1f);
+    std::vector<uint32_t> dst(n);
+
+    while (state.KeepRunning())
+    {
+        if (Parallel)
+        { D3DXColorToARGBArrayParallel(dst.data(), src.data(), uint32_t(n), ColorSpace); }
+        else
+        { D3DXColorToARGBArray(dst.data(), src.data(), uint32_t(n), ColorSpace); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(uint32_t) + sizeof(D3DXCOLOR)));
+}
+
+void BM_D3DXColorToARGBArray(BenchState& state)
+{ BM_ColorToARGB<D3DXCOLORSPACE_LINEAR, false>(state); }
+BENCHMARK(BM_D3DXColorToARGBArray)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXColorToARGBArray_SRGB(BenchState& state)
+{ BM_ColorToARGB<D3DXCOLORSPACE_SRGB, false>(state); }
+BENCHMARK(BM_D3DXColorToARGBArray_SRGB)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXColorToARGBArrayParallel_SRGB(BenchState& state)
+{ BM_ColorToARGB<D3DXCOLORSPACE_SRGB, true>(state); }
+BENCHMARK(BM_D3DXColorToARGBArrayParallel_SRGB)->Arg(1 << 20);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector Transform
+///////////////////////////////////////////////////////////////////////////////
+
+D3DXMATRIX BenchMatrix()
+{
+    D3DXMATRIX rot, trans, ret;
+    D3DXMatrixRotationYawPitchRoll(&rot, 0.3f, 0.2f, 0.1f);
+    D3DXMatrixTranslation(&trans, 1.0f, 2.0f, 3.0f);
+    return *D3DXMatrixMultiply(&ret, &rot, &trans);
+}
+
+std::vector<D3DXVECTOR3> RandomVec3(size_t count)
+{
+    const auto tmp = RandomFloats(count * 3, -100.0f, 100.0f);
+    std::vector<D3DXVECTOR3> result(count);
+    memcpy(static_cast<void*>(result.data()), tmp.data(), count * sizeof(D3DXVECTOR3));
+    return result;
+}
+
+void BM_D3DXVec3TransformCoordArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3TransformCoordArray(dst.data(), sizeof(D3DXVECTOR3), src.data(), sizeof(D3DXVECTOR3), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR3) * 2);
+}
+BENCHMARK(BM_D3DXVec3TransformCoordArray)->Arg(1 << 17)->Arg(1 << 20);
+
+void BM_D3DXVec3TransformCoordArrayParallel(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3TransformCoordArrayParallel(dst.data(), sizeof(D3DXVECTOR3), src.data(), sizeof(D3DXVECTOR3), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR3) * 2);
+}
+BENCHMARK(BM_D3DXVec3TransformCoordArrayParallel)->Arg(1 << 17)->Arg(1 << 20);
+
+void BM_D3DXVec3TransformCoordSoA(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    const auto mtx = BenchMatrix();
+    std::vector<float> x(n), y(n), z(n);
+    D3DXVec3AoSToSoA(x.data(), y.data(), z.data(), src.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+
+    std::vector<float> ox(n), oy(n), oz(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3TransformCoordSoA(ox.data(), oy.data(), oz.data(), x.data(), y.data(), z.data(), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(float) * 6);
+}
+BENCHMARK(BM_D3DXVec3TransformCoordSoA)->Arg(4096)->Arg(1 << 17)->Arg(1 << 20);
+
+void BM_D3DXVec3AoSToSoA(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    std::vector<float> x(n), y(n), z(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3AoSToSoA(x.data(), y.data(), z.data(), src.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR3) * 2);
+}
+BENCHMARK(BM_D3DXVec3AoSToSoA)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXVec3SoAToAoS(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    std::vector<float> x(n), y(n), z(n);
+    D3DXVec3AoSToSoA(x.data(), y.data(), z.data(), src.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3SoAToAoS(dst.data(), sizeof(D3DXVECTOR3), x.data(), y.data(), z.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR3) * 2);
+}
+BENCHMARK(BM_D3DXVec3SoAToAoS)->Arg(4096)->Arg(1 << 20);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Frustum culling
+///////////////////////////////////////////////////////////////////////////////
+
+struct BenchBounds
+{
+    D3DXFRUSTUM         Frustum;
+    std::vector<float>  X, Y, Z, Radius, ExtentX, ExtentY, ExtentZ, Axis;
+};
+
+BenchBounds RandomBounds(size_t n)
+{
+    D3DXMATRIX view, proj;
+    const D3DXVECTOR3 eye(3.0f, 2.0f, -20.0f), at(0.0f, 0.0f, 0.0f), up(0.0f, 1.0f, 0.0f);
+    D3DXMatrixLookAtLH(&view, &eye, &at, &up);
+    D3DXMatrixPerspectiveFovLH(&proj, 1.0f, 16.0f / 9.0f, 0.5f, 40.0f);
+    D3DXMatrixMultiply(&proj, &view, &proj);
+
+    BenchBounds ret;
+    D3DXFrustumFromMatrix(&ret.Frustum, &proj);
+
+    const auto centers = RandomVec3(n);
+    const auto sizes   = RandomFloats(n * 4, 0.1f, 2.0f);
+    ret.X.resize(n); ret.Y.resize(n); ret.Z.resize(n);
+    ret.Radius.resize(n); ret.ExtentX.resize(n); ret.ExtentY.resize(n); ret.ExtentZ.resize(n);
+    ret.Axis.resize(n * 9);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ret.X[i] = centers[i].x * 3.0f;
+        ret.Y[i] = centers[i].y * 2.0f;
+        ret.Z[i] = centers[i].z * 3.0f;
+        ret.Radius [i] = sizes[i * 4 + 0];
+        ret.ExtentX[i] = sizes[i * 4 + 1];
+        ret.ExtentY[i] = sizes[i * 4 + 2];
+        ret.ExtentZ[i] = sizes[i * 4 + 3];
+
+        D3DXMATRIX r;
+        D3DXMatrixRotationYawPitchRoll(&r, centers[i].x, centers[i].y, centers[i].z);
+        for (int k = 0; k < 9; ++k)
+        { ret.Axis[k * n + i] = r.m[k / 3][k % 3]; }
+    }
+    return ret;
+}
+
+// 1個ずつ D3DXPlaneDotCoord で判定する場合と比較する.
+void BM_D3DXFrustumClassifySpheres_Scalar(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto b = RandomBounds(n);
+    std::vector<uint8_t> result(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const D3DXVECTOR3 center(b.X[i], b.Y[i], b.Z[i]);
+            uint8_t cull = D3DXCULL_INSIDE;
+            for (const auto& plane : b.Frustum.Planes)
+            {
+                const auto d = D3DXPlaneDotCoord(&plane, &center);
+                if (d < -b.Radius[i])
+                { cull = D3DXCULL_OUTSIDE; break; }
+                if (d < b.Radius[i])
+                { cull = D3DXCULL_INTERSECT; }
+            }
+            result[i] = cull;
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXFrustumClassifySpheres_Scalar)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXFrustumClassifySpheres(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto b = RandomBounds(n);
+    std::vector<uint8_t> result(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXFrustumClassifySpheres(result.data(), &b.Frustum, b.X.data(), b.Y.data(), b.Z.data(), b.Radius.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) * 4 + sizeof(uint8_t)));
+}
+BENCHMARK(BM_D3DXFrustumClassifySpheres)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXFrustumClassifyAABBs(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto b = RandomBounds(n);
+    std::vector<uint8_t> result(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXFrustumClassifyAABBs(result.data(), &b.Frustum, b.X.data(), b.Y.data(), b.Z.data(),
+            b.ExtentX.data(), b.ExtentY.data(), b.ExtentZ.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) * 6 + sizeof(uint8_t)));
+}
+BENCHMARK(BM_D3DXFrustumClassifyAABBs)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXFrustumClassifyOBBs(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto b = RandomBounds(n);
+    std::vector<uint8_t> result(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXFrustumClassifyOBBs(result.data(), &b.Frustum, b.X.data(), b.Y.data(), b.Z.data(),
+            b.ExtentX.data(), b.ExtentY.data(), b.ExtentZ.data(), b.Axis.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) * 15 + sizeof(uint8_t)));
+}
+BENCHMARK(BM_D3DXFrustumClassifyOBBs)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXFrustumClassifySpheresParallel(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto b = RandomBounds(n);
+    std::vector<uint8_t> result(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXFrustumClassifySpheresParallel(result.data(), &b.Frustum, b.X.data(), b.Y.data(), b.Z.data(), b.Radius.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(float) * 4 + sizeof(uint8_t)));
+}
+BENCHMARK(BM_D3DXFrustumClassifySpheresParallel)->Arg(1 << 20);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bounding volumes
+///////////////////////////////////////////////////////////////////////////////
+
+// 位置の後ろに法線とテクスチャ座標が並んだ頂点.
+struct BoundsBenchVertex
+{
+    D3DXVECTOR3 Position;
+    D3DXVECTOR3 Normal;
+    float       TexCoord[2];
+};
+
+std::vector<BoundsBenchVertex> RandomBoundsVertices(size_t count)
+{
+    const auto tmp = RandomFloats(count * 3, -100.0f, 100.0f);
+    std::vector<BoundsBenchVertex> result(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        result[i].Position    = D3DXVECTOR3(tmp[i * 3 + 0], tmp[i * 3 + 1], tmp[i * 3 + 2]);
+        result[i].Normal      = D3DXVECTOR3(0.0f, 1.0f, 0.0f);
+        result[i].TexCoord[0] = 0.0f;
+        result[i].TexCoord[1] = 0.0f;
+    }
+    return result;
+}
+
+void BM_ComputeBoundingBox_Loop(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 lower, upper;
+
+    while (state.KeepRunning())
+    {
+        lower = upper = v[0].Position;
+        for (size_t i = 1; i < n; ++i)
+        {
+            D3DXVec3Minimize(&lower, &lower, &v[i].Position);
+            D3DXVec3Maximize(&upper, &upper, &v[i].Position);
+        }
+        DoNotOptimize(lower);
+        DoNotOptimize(upper);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_ComputeBoundingBox_Loop)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXComputeBoundingBox(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 lower, upper;
+
+    while (state.KeepRunning())
+    {
+        D3DXComputeBoundingBox(&v[0].Position, uint32_t(n), sizeof(BoundsBenchVertex), &lower, &upper);
+        DoNotOptimize(lower);
+        DoNotOptimize(upper);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_D3DXComputeBoundingBox)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXComputeBoundingBoxParallel(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 lower, upper;
+
+    while (state.KeepRunning())
+    {
+        D3DXComputeBoundingBoxParallel(&v[0].Position, uint32_t(n), sizeof(BoundsBenchVertex), &lower, &upper);
+        DoNotOptimize(lower);
+        DoNotOptimize(upper);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_D3DXComputeBoundingBoxParallel)->Arg(1 << 20);
+
+void BM_D3DXComputeCentroid(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 centroid;
+
+    while (state.KeepRunning())
+    {
+        D3DXComputeCentroid(&v[0].Position, uint32_t(n), sizeof(BoundsBenchVertex), &centroid);
+        DoNotOptimize(centroid);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_D3DXComputeCentroid)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXComputeBoundingSphereRitter(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 center;
+    float radius;
+
+    while (state.KeepRunning())
+    {
+        D3DXComputeBoundingSphereEx(&v[0].Position, uint32_t(n), sizeof(BoundsBenchVertex), D3DXSPHERE_RITTER, &center, &radius);
+        DoNotOptimize(center);
+        DoNotOptimize(radius);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_D3DXComputeBoundingSphereRitter)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXComputeBoundingSphereEPOS(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 center;
+    float radius;
+
+    while (state.KeepRunning())
+    {
+        D3DXComputeBoundingSphereEx(&v[0].Position, uint32_t(n), sizeof(BoundsBenchVertex), D3DXSPHERE_EPOS, &center, &radius);
+        DoNotOptimize(center);
+        DoNotOptimize(radius);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_D3DXComputeBoundingSphereEPOS)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXComputeBoundingSphereEPOSParallel(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomBoundsVertices(n);
+    D3DXVECTOR3 center;
+    float radius;
+
+    while (state.KeepRunning())
+    {
+        D3DXComputeBoundingSphereExParallel(&v[0].Position, uint32_t(n), sizeof(BoundsBenchVertex), D3DXSPHERE_EPOS, &center, &radius);
+        DoNotOptimize(center);
+        DoNotOptimize(radius);
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(BoundsBenchVertex));
+}
+BENCHMARK(BM_D3DXComputeBoundingSphereEPOSParallel)->Arg(1 << 20);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Ray intersection
+///////////////////////////////////////////////////////////////////////////////
+
+// 原点付近の三角形と, 半径30の球面上から原点付近に向かう光線.
+struct RayBenchScene
+{
+    std::vector<D3DXVECTOR3>    Triangles;
+    std::vector<D3DXVECTOR3>    RayPos;
+    std::vector<D3DXVECTOR3>    RayDir;
+};
+
+RayBenchScene RandomRayScene(size_t triCount, size_t rayCount)
+{
+    const auto center = RandomFloats(triCount * 3, -8.0f, 8.0f);
+    const auto offset = RandomFloats(triCount * 9, -2.0f, 2.0f);
+    const auto pos    = RandomFloats(rayCount * 3, -1.0f, 1.0f);
+    const auto target = RandomFloats(rayCount * 3, -8.0f, 8.0f);
+
+    RayBenchScene result;
+    result.Triangles.resize(triCount * 3);
+    for (size_t i = 0; i < triCount * 3; ++i)
+    {
+        const auto c = &center[(i / 3) * 3];
+        const auto o = &offset[i * 3];
+        result.Triangles[i] = D3DXVECTOR3(c[0] + o[0], c[1] + o[1], c[2] + o[2]);
+    }
+
+    result.RayPos.resize(rayCount);
+    result.RayDir.resize(rayCount);
+    for (size_t i = 0; i < rayCount; ++i)
+    {
+        D3DXVECTOR3 p(pos[i * 3 + 0], pos[i * 3 + 1], pos[i * 3 + 2]);
+        D3DXVec3Normalize(&p, &p);
+        result.RayPos[i] = p * 30.0f;
+        result.RayDir[i] = D3DXVECTOR3(target[i * 3 + 0], target[i * 3 + 1], target[i * 3 + 2]) - result.RayPos[i];
+    }
+    return result;
+}
+
+const size_t kRayBenchCount = 256;
+
+void BM_D3DXIntersectTri_Loop(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(n, kRayBenchCount);
+
+    while (state.KeepRunning())
+    {
+        for (size_t r = 0; r < kRayBenchCount; ++r)
+        {
+            D3DXINTERSECTINFO hit = { 0, 0.0f, 0.0f, FLT_MAX };
+            for (size_t i = 0; i < n; ++i)
+            {
+                float u, v, t;
+                if (D3DXIntersectTri(&s.Triangles[i * 3 + 0], &s.Triangles[i * 3 + 1], &s.Triangles[i * 3 + 2],
+                    &s.RayPos[r], &s.RayDir[r], &u, &v, &t) && t < hit.Dist)
+                { hit = { uint32_t(i), u, v, t }; }
+            }
+            DoNotOptimize(hit);
+        }
+    }
+
+    state.SetItemsProcessed(n * kRayBenchCount);
+}
+BENCHMARK(BM_D3DXIntersectTri_Loop)->Arg(1024);
+
+void BM_D3DXIntersectTriPackets4(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(n, kRayBenchCount);
+    std::vector<D3DXTRIANGLE4> packets((n + 3) / 4);
+    D3DXTrianglePackets4FromMesh(packets.data(), s.Triangles.data(), sizeof(D3DXVECTOR3), nullptr, uint32_t(n));
+
+    while (state.KeepRunning())
+    {
+        for (size_t r = 0; r < kRayBenchCount; ++r)
+        {
+            D3DXINTERSECTINFO hit = { 0, 0.0f, 0.0f, FLT_MAX };
+            D3DXIntersectTriPackets4(&hit, packets.data(), uint32_t(packets.size()), &s.RayPos[r], &s.RayDir[r]);
+            DoNotOptimize(hit);
+        }
+    }
+
+    state.SetItemsProcessed(n * kRayBenchCount);
+    state.SetBytesProcessed(packets.size() * sizeof(D3DXTRIANGLE4) * kRayBenchCount);
+}
+BENCHMARK(BM_D3DXIntersectTriPackets4)->Arg(1024);
+
+void BM_D3DXIntersectTriPackets8(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(n, kRayBenchCount);
+    std::vector<D3DXTRIANGLE8> packets((n + 7) / 8);
+    D3DXTrianglePackets8FromMesh(packets.data(), s.Triangles.data(), sizeof(D3DXVECTOR3), nullptr, uint32_t(n));
+
+    while (state.KeepRunning())
+    {
+        for (size_t r = 0; r < kRayBenchCount; ++r)
+        {
+            D3DXINTERSECTINFO hit = { 0, 0.0f, 0.0f, FLT_MAX };
+            D3DXIntersectTriPackets8(&hit, packets.data(), uint32_t(packets.size()), &s.RayPos[r], &s.RayDir[r]);
+            DoNotOptimize(hit);
+        }
+    }
+
+    state.SetItemsProcessed(n * kRayBenchCount);
+    state.SetBytesProcessed(packets.size() * sizeof(D3DXTRIANGLE8) * kRayBenchCount);
+}
+BENCHMARK(BM_D3DXIntersectTriPackets8)->Arg(1024);
+
+void BM_D3DXIntersectTriRays(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(64, n);
+
+    std::vector<float> soa(n * 6);
+    for (size_t i = 0; i < n; ++i)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            soa[c * n + i]       = s.RayPos[i][c];
+            soa[(3 + c) * n + i] = s.RayDir[i][c];
+        }
+    }
+    std::vector<D3DXINTERSECTINFO> hits(n);
+
+    while (state.KeepRunning())
+    {
+        for (auto& hit : hits)
+        { hit = { 0, 0.0f, 0.0f, FLT_MAX }; }
+
+        for (size_t i = 0; i < 64; ++i)
+        {
+            D3DXIntersectTriRays(hits.data(), &s.Triangles[i * 3 + 0], &s.Triangles[i * 3 + 1], &s.Triangles[i * 3 + 2], uint32_t(i),
+                &soa[0], &soa[n], &soa[2 * n], &soa[3 * n], &soa[4 * n], &soa[5 * n], uint32_t(n));
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n * 64);
+}
+BENCHMARK(BM_D3DXIntersectTriRays)->Arg(4096);
+
+///////////////////////////////////////////////////////////////////////////////
+// Triangle BVH
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t kBVHBenchTriangles = 64 * 1024;
+const size_t kBVHBenchRays      = 16 * 1024;
+
+void BM_D3DXCreateTriangleBVH(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(n, 0);
+
+    while (state.KeepRunning())
+    {
+        D3DXTRIANGLEBVH* pBVH = nullptr;
+        D3DXCreateTriangleBVH(s.Triangles.data(), uint32_t(n * 3), sizeof(D3DXVECTOR3), nullptr, uint32_t(n), &pBVH);
+        DoNotOptimize(pBVH);
+        D3DXDestroyTriangleBVH(pBVH);
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXCreateTriangleBVH)->Arg(kBVHBenchTriangles);
+
+void BM_D3DXCreateTriangleBVHParallel(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(n, 0);
+
+    while (state.KeepRunning())
+    {
+        D3DXTRIANGLEBVH* pBVH = nullptr;
+        D3DXCreateTriangleBVHParallel(s.Triangles.data(), uint32_t(n * 3), sizeof(D3DXVECTOR3), nullptr, uint32_t(n), &pBVH);
+        DoNotOptimize(pBVH);
+        D3DXDestroyTriangleBVH(pBVH);
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXCreateTriangleBVHParallel)->Arg(kBVHBenchTriangles);
+
+// 光線の判定の Mitems/s は Mrays/s になる.
+template<bool Parallel>
+void BM_TriangleBVHIntersect(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(kBVHBenchTriangles, n);
+
+    D3DXTRIANGLEBVH* pBVH = nullptr;
+    D3DXCreateTriangleBVHParallel(s.Triangles.data(), uint32_t(s.Triangles.size()), sizeof(D3DXVECTOR3), nullptr, uint32_t(kBVHBenchTriangles), &pBVH);
+    std::vector<D3DXINTERSECTINFO> hits(n);
+
+    while (state.KeepRunning())
+    {
+        for (auto& hit : hits)
+        { hit = { 0, 0.0f, 0.0f, FLT_MAX }; }
+
+        if (Parallel)
+        { D3DXTriangleBVHIntersectArrayParallel(hits.data(), pBVH, s.RayPos.data(), s.RayDir.data(), uint32_t(n)); }
+        else
+        { D3DXTriangleBVHIntersectArray(hits.data(), pBVH, s.RayPos.data(), s.RayDir.data(), uint32_t(n)); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    D3DXDestroyTriangleBVH(pBVH);
+}
+
+template<bool Parallel>
+void BM_TriangleBVHOccluded(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto s = RandomRayScene(kBVHBenchTriangles, n);
+
+    D3DXTRIANGLEBVH* pBVH = nullptr;
+    D3DXCreateTriangleBVHParallel(s.Triangles.data(), uint32_t(s.Triangles.size()), sizeof(D3DXVECTOR3), nullptr, uint32_t(kBVHBenchTriangles), &pBVH);
+    const auto maxDist = RandomFloats(n, 0.0f, 1.0f);
+    std::vector<uint8_t> occluded(n);
+
+    while (state.KeepRunning())
+    {
+        if (Parallel)
+        { D3DXTriangleBVHOccludedArrayParallel(occluded.data(), pBVH, s.RayPos.data(), s.RayDir.data(), maxDist.data(), uint32_t(n)); }
+        else
+        { D3DXTriangleBVHOccludedArray(occluded.data(), pBVH, s.RayPos.data(), s.RayDir.data(), maxDist.data(), uint32_t(n)); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    D3DXDestroyTriangleBVH(pBVH);
+}
+
+void BM_D3DXTriangleBVHIntersectArray(BenchState& state)
+{ BM_TriangleBVHIntersect<false>(state); }
+BENCHMARK(BM_D3DXTriangleBVHIntersectArray)->Arg(kBVHBenchRays);
+
+void BM_D3DXTriangleBVHIntersectArrayParallel(BenchState& state)
+{ BM_TriangleBVHIntersect<true>(state); }
+BENCHMARK(BM_D3DXTriangleBVHIntersectArrayParallel)->Arg(kBVHBenchRays);
+
+void BM_D3DXTriangleBVHOccludedArray(BenchState& state)
+{ BM_TriangleBVHOccluded<false>(state); }
+BENCHMARK(BM_D3DXTriangleBVHOccludedArray)->Arg(kBVHBenchRays);
+
+void BM_D3DXTriangleBVHOccludedArrayParallel(BenchState& state)
+{ BM_TriangleBVHOccluded<true>(state); }
+BENCHMARK(BM_D3DXTriangleBVHOccludedArrayParallel)->Arg(kBVHBenchRays);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Matrix Multiply
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<D3DXMATRIX> RandomMatrices(size_t count)
+{
+    const auto tmp = RandomFloats(count * 6, -1.0f, 1.0f);
+    std::vector<D3DXMATRIX> result(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        D3DXMatrixRotationYawPitchRoll(&result[i], tmp[i * 6 + 0], tmp[i * 6 + 1], tmp[i * 6 + 2]);
+        result[i]._41 = tmp[i * 6 + 3];
+        result[i]._42 = tmp[i * 6 + 4];
+        result[i]._43 = tmp[i * 6 + 5];
+    }
+    return result;
+}
+
+// 親が先に並ぶランダムな階層.
+std::vector<int32_t> RandomHierarchy(size_t count)
+{
+    std::mt19937 rng(12345);
+    std::vector<int32_t> result(count);
+    for (size_t i = 0; i < count; ++i)
+    { result[i] = (i < 16) ? -1 : int32_t(rng() % i); }
+    return result;
+}
+
+// 従来の1回ずつ呼び出すループ.
+void BM_D3DXMatrixMultiply_Loop(BenchState& state)
+{
+    const auto n  = size_t(state.Arg());
+    const auto m1 = RandomMatrices(n);
+    const auto m2 = RandomMatrices(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixMultiply(&dst[i], &m1[i], &m2[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiply_Loop)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXMatrixMultiplyArray(BenchState& state)
+{
+    const auto n  = size_t(state.Arg());
+    const auto m1 = RandomMatrices(n);
+    const auto m2 = RandomMatrices(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixMultiplyArray(dst.data(), m1.data(), m2.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyArray)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXMatrixMultiplyArrayParallel(BenchState& state)
+{
+    const auto n  = size_t(state.Arg());
+    const auto m1 = RandomMatrices(n);
+    const auto m2 = RandomMatrices(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixMultiplyArrayParallel(dst.data(), m1.data(), m2.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyArrayParallel)->Arg(64 * 1024);
+
+void BM_D3DXMatrixMultiplyArrayByMatrix(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixMultiplyArrayByMatrix(dst.data(), src.data(), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyArrayByMatrix)->Arg(1024)->Arg(64 * 1024);
+
+// 従来の1回ずつ呼び出す階層計算.
+void BM_D3DXMatrixMultiplyHierarchy_Loop(BenchState& state)
+{
+    const auto n      = size_t(state.Arg());
+    const auto local  = RandomMatrices(n);
+    const auto parent = RandomHierarchy(n);
+    std::vector<D3DXMATRIX> world(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (parent[i] < 0)
+            { world[i] = local[i]; }
+            else
+            { D3DXMatrixMultiply(&world[i], &local[i], &world[parent[i]]); }
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyHierarchy_Loop)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXMatrixMultiplyHierarchy(BenchState& state)
+{
+    const auto n      = size_t(state.Arg());
+    const auto local  = RandomMatrices(n);
+    const auto parent = RandomHierarchy(n);
+    std::vector<D3DXMATRIX> world(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixMultiplyHierarchy(world.data(), local.data(), parent.data(), nullptr, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyHierarchy)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXMatrixMultiplyHierarchyParallel(BenchState& state)
+{
+    const auto n      = size_t(state.Arg());
+    const auto local  = RandomMatrices(n);
+    const auto parent = RandomHierarchy(n);
+    std::vector<D3DXMATRIX> world(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixMultiplyHierarchyParallel(world.data(), local.data(), parent.data(), nullptr, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyHierarchyParallel)->Arg(64 * 1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Alignment
+///////////////////////////////////////////////////////////////////////////////
+
+// offsetバイトずらした位置に行列を配置して乗算する.
+void MatrixMultiplyWithOffset(BenchState& state, size_t offset)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n * 2);
+
+    std::vector<uint8_t> buffer(sizeof(D3DXMATRIX) * n * 3 + 16);
+    auto base = buffer.data() + ((16 - (reinterpret_cast<uintptr_t>(buffer.data()) & 0xF)) & 0xF) + offset;
+    auto m1   = reinterpret_cast<D3DXMATRIX*>(base);
+    auto m2   = m1 + n;
+    auto dst  = m2 + n;
+    memcpy(m1, src.data(), sizeof(D3DXMATRIX) * n * 2);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixMultiply(&dst[i], &m1[i], &m2[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+
+void BM_D3DXMatrixMultiply_Aligned(BenchState& state)
+{ MatrixMultiplyWithOffset(state, 0); }
+BENCHMARK(BM_D3DXMatrixMultiply_Aligned)->Arg(1024);
+
+void BM_D3DXMatrixMultiply_Unaligned(BenchState& state)
+{ MatrixMultiplyWithOffset(state, 4); }
+BENCHMARK(BM_D3DXMatrixMultiply_Unaligned)->Arg(1024);
+
+void BM_D3DXMatrixMultiplyArray_Aligned(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    std::unique_ptr<D3DXMATRIXA16[]> m1(new D3DXMATRIXA16[n]);
+    std::unique_ptr<D3DXMATRIXA16[]> m2(new D3DXMATRIXA16[n]);
+    std::unique_ptr<D3DXMATRIXA16[]> dst(new D3DXMATRIXA16[n]);
+
+    const auto src = RandomMatrices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        m1[i] = src[i];
+        m2[i] = src[n - 1 - i];
+    }
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixMultiplyArray(dst.get(), m1.get(), m2.get(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixMultiplyArray_Aligned)->Arg(1024);
+
+// 細かい呼び出しを繰り返す場合のオーバーヘッド計測.
+// D3DX9MATH_STUB_INLINE 有無でビルドして比較する.
+void BM_D3DXVec3TransformCoord_Call(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXVec3TransformCoord(&dst[i], &src[i], &mtx); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXVec3TransformCoord_Call)->Arg(1024);
+
+void BM_D3DXQuaternionSlerp_Call(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto v = RandomFloats(n * 4, -1.0f, 1.0f);
+    std::vector<D3DXQUATERNION> q(n);
+    for (size_t i = 0; i < n; ++i)
+    { D3DXQuaternionNormalize(&q[i], reinterpret_cast<const D3DXQUATERNION*>(&v[i * 4])); }
+
+    std::vector<D3DXQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i + 1 < n; ++i)
+        { D3DXQuaternionSlerp(&dst[i], &q[i], &q[i + 1], 0.25f); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n - 1);
+}
+BENCHMARK(BM_D3DXQuaternionSlerp_Call)->Arg(1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector2
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXVec2Normalize(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXVECTOR2>(n, -100.0f, 100.0f);
+    std::vector<D3DXVECTOR2> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXVec2Normalize(&dst[i], &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXVec2Normalize)->Arg(1024);
+
+void BM_D3DXVec2TransformCoordArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXVECTOR2>(n, -100.0f, 100.0f);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXVECTOR2> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec2TransformCoordArray(dst.data(), sizeof(D3DXVECTOR2), src.data(), sizeof(D3DXVECTOR2), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR2) * 2);
+}
+BENCHMARK(BM_D3DXVec2TransformCoordArray)->Arg(4096)->Arg(1 << 20);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector3
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXVec3Normalize(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXVec3Normalize(&dst[i], &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXVec3Normalize)->Arg(1024);
+
+void BM_D3DXVec3TransformNormalArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3TransformNormalArray(dst.data(), sizeof(D3DXVECTOR3), src.data(), sizeof(D3DXVECTOR3), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR3) * 2);
+}
+BENCHMARK(BM_D3DXVec3TransformNormalArray)->Arg(4096)->Arg(1 << 20);
+
+void BM_D3DXVec3ProjectArray(BenchState& state)
+{
+    const auto n     = size_t(state.Arg());
+    const auto src   = RandomVec3(n);
+    const auto world = BenchMatrix();
+
+    D3DXMATRIX view, proj;
+    D3DXVECTOR3 eye(0.0f, 0.0f, -500.0f), at(0.0f, 0.0f, 0.0f), up(0.0f, 1.0f, 0.0f);
+    D3DXMatrixLookAtLH(&view, &eye, &at, &up);
+    D3DXMatrixPerspectiveFovLH(&proj, D3DXToRadian(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+    D3DVIEWPORT9 viewport = {};
+    viewport.Width  = 1920;
+    viewport.Height = 1080;
+    viewport.MaxZ   = 1.0f;
+
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3ProjectArray(dst.data(), sizeof(D3DXVECTOR3), src.data(), sizeof(D3DXVECTOR3), &viewport, &proj, &view, &world, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR3) * 2);
+}
+BENCHMARK(BM_D3DXVec3ProjectArray)->Arg(4096);
+
+void BM_D3DXVec3ProjectSoA(BenchState& state)
+{
+    const auto n     = size_t(state.Arg());
+    const auto src   = RandomVec3(n);
+    const auto world = BenchMatrix();
+
+    D3DXMATRIX view, proj;
+    D3DXVECTOR3 eye(0.0f, 0.0f, -500.0f), at(0.0f, 0.0f, 0.0f), up(0.0f, 1.0f, 0.0f);
+    D3DXMatrixLookAtLH(&view, &eye, &at, &up);
+    D3DXMatrixPerspectiveFovLH(&proj, D3DXToRadian(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+    D3DVIEWPORT9 viewport = {};
+    viewport.Width  = 1920;
+    viewport.Height = 1080;
+    viewport.MaxZ   = 1.0f;
+
+    std::vector<float> x(n), y(n), z(n), ox(n), oy(n), oz(n);
+    D3DXVec3AoSToSoA(x.data(), y.data(), z.data(), src.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+
+    while (state.KeepRunning())
+    {
+        D3DXVec3ProjectSoA(ox.data(), oy.data(), oz.data(), x.data(), y.data(), z.data(), &viewport, &proj, &view, &world, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(float) * 6);
+}
+BENCHMARK(BM_D3DXVec3ProjectSoA)->Arg(4096);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector4
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXVec4Normalize(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXVECTOR4>(n, -100.0f, 100.0f);
+    std::vector<D3DXVECTOR4> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXVec4Normalize(&dst[i], &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXVec4Normalize)->Arg(1024);
+
+void BM_D3DXVec4TransformArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXVECTOR4>(n, -100.0f, 100.0f);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXVECTOR4> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXVec4TransformArray(dst.data(), sizeof(D3DXVECTOR4), src.data(), sizeof(D3DXVECTOR4), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXVECTOR4) * 2);
+}
+BENCHMARK(BM_D3DXVec4TransformArray)->Arg(4096)->Arg(1 << 20);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Matrix
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXMatrixInverse(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixInverse(&dst[i], nullptr, &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixInverse)->Arg(1024);
+
+// 指定した種類の行列. 剛体変換に縮尺や射影の成分を加える.
+std::vector<D3DXMATRIX> RandomMatrices(size_t count, D3DXMATRIXCLASS type)
+{
+    auto result = RandomMatrices(count);
+    if (type == D3DXMATRIXCLASS_RIGID)
+        return result;
+
+    const auto tmp = RandomFloats(count * 3, 0.5f, 2.0f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (auto r = 0; r < 3; ++r)
+        for (auto c = 0; c < 3; ++c)
+        { result[i].m[r][c] *= tmp[i * 3 + r]; }
+
+        if (type == D3DXMATRIXCLASS_GENERAL)
+        { result[i]._34 = tmp[i * 3]; }
+    }
+    return result;
+}
+
+void BenchMatrixInverse(BenchState& state, D3DXMATRIXCLASS type, bool batch)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n, type);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        if (batch)
+        { D3DXMatrixInverseArray(dst.data(), nullptr, src.data(), uint32_t(n)); }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            { D3DXMatrixInverse(&dst[i], nullptr, &src[i]); }
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+
+void BM_D3DXMatrixInverse_Affine(BenchState& state)
+{ BenchMatrixInverse(state, D3DXMATRIXCLASS_AFFINE, false); }
+BENCHMARK(BM_D3DXMatrixInverse_Affine)->Arg(1024);
+
+void BM_D3DXMatrixInverse_General(BenchState& state)
+{ BenchMatrixInverse(state, D3DXMATRIXCLASS_GENERAL, false); }
+BENCHMARK(BM_D3DXMatrixInverse_General)->Arg(1024);
+
+void BM_D3DXMatrixInverseArray_Rigid(BenchState& state)
+{ BenchMatrixInverse(state, D3DXMATRIXCLASS_RIGID, true); }
+BENCHMARK(BM_D3DXMatrixInverseArray_Rigid)->Arg(1024);
+
+void BM_D3DXMatrixInverseArray_Affine(BenchState& state)
+{ BenchMatrixInverse(state, D3DXMATRIXCLASS_AFFINE, true); }
+BENCHMARK(BM_D3DXMatrixInverseArray_Affine)->Arg(1024);
+
+void BM_D3DXMatrixInverseArray_General(BenchState& state)
+{ BenchMatrixInverse(state, D3DXMATRIXCLASS_GENERAL, true); }
+BENCHMARK(BM_D3DXMatrixInverseArray_General)->Arg(1024);
+
+void BM_D3DXMatrixInverseArrayParallel(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n, D3DXMATRIXCLASS_AFFINE);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixInverseArrayParallel(dst.data(), nullptr, src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixInverseArrayParallel)->Arg(64 * 1024);
+
+void BM_D3DXMatrixTranspose(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixTranspose(&dst[i], &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixTranspose)->Arg(1024);
+
+void BM_D3DXMatrixDecompose(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    std::vector<D3DXVECTOR3>    scale(n);
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixDecompose(&scale[i], &rotation[i], &translation[i], &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixDecompose)->Arg(1024);
+
+void BM_D3DXMatrixTransformation(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    const D3DXVECTOR3    center(0.0f, 0.0f, 0.0f);
+    const D3DXVECTOR3    scaling(1.0f, 2.0f, 3.0f);
+    const D3DXQUATERNION identity(0.0f, 0.0f, 0.0f, 1.0f);
+    D3DXQUATERNION rotation;
+    D3DXQuaternionRotationYawPitchRoll(&rotation, 0.3f, 0.2f, 0.1f);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixTransformation(&dst[i], &center, &identity, &scaling, &center, &rotation, &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixTransformation)->Arg(1024);
+
+void BM_D3DXMatrixDecomposeArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    std::vector<D3DXVECTOR3>    scale(n);
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+    std::vector<uint32_t>       failed((n + 31) / 32);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixDecomposeArray(scale.data(), rotation.data(), translation.data(), failed.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixDecomposeArray)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXMatrixDecomposeArrayParallel(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    std::vector<D3DXVECTOR3>    scale(n);
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+    std::vector<uint32_t>       failed((n + 31) / 32);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixDecomposeArrayParallel(scale.data(), rotation.data(), translation.data(), failed.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixDecomposeArrayParallel)->Arg(64 * 1024);
+
+void BM_D3DXMatrixComposeArray(BenchState& state)
+{
+    const auto n           = size_t(state.Arg());
+    const auto translation = RandomVec3(n);
+    const std::vector<D3DXVECTOR3> scaling(n, D3DXVECTOR3(1.0f, 2.0f, 3.0f));
+    std::vector<D3DXQUATERNION>    rotation(n);
+    std::vector<D3DXMATRIX>        dst(n);
+    for (auto& q : rotation)
+    { D3DXQuaternionRotationYawPitchRoll(&q, 0.3f, 0.2f, 0.1f); }
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixComposeArray(dst.data(), scaling.data(), rotation.data(), translation.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixComposeArray)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXMatrixComposeArrayParallel(BenchState& state)
+{
+    const auto n           = size_t(state.Arg());
+    const auto translation = RandomVec3(n);
+    const std::vector<D3DXVECTOR3> scaling(n, D3DXVECTOR3(1.0f, 2.0f, 3.0f));
+    std::vector<D3DXQUATERNION>    rotation(n);
+    std::vector<D3DXMATRIX>        dst(n);
+    for (auto& q : rotation)
+    { D3DXQuaternionRotationYawPitchRoll(&q, 0.3f, 0.2f, 0.1f); }
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixComposeArrayParallel(dst.data(), scaling.data(), rotation.data(), translation.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixComposeArrayParallel)->Arg(64 * 1024);
+
+void BM_D3DXMatrixRotationYawPitchRoll(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXMatrixRotationYawPitchRoll(&dst[i], src[i].x, src[i].y, src[i].z); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixRotationYawPitchRoll)->Arg(1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Quaternion
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<D3DXQUATERNION> RandomQuaternions(size_t count)
+{
+    auto result = RandomElements<D3DXQUATERNION>(count, -1.0f, 1.0f);
+    for (auto& q : result)
+    { D3DXQuaternionNormalize(&q, &q); }
+    return result;
+}
+
+void BM_D3DXQuaternionMultiply(BenchState& state)
+{
+    const auto n  = size_t(state.Arg());
+    const auto q1 = RandomQuaternions(n);
+    const auto q2 = RandomQuaternions(n + 1);
+    std::vector<D3DXQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXQuaternionMultiply(&dst[i], &q1[i], &q2[i + 1]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXQuaternionMultiply)->Arg(1024);
+
+void BM_D3DXQuaternionRotationMatrix(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomQuaternions(n);
+    std::vector<D3DXMATRIX> mtx(n);
+    for (size_t i = 0; i < n; ++i)
+    { D3DXMatrixRotationQuaternion(&mtx[i], &src[i]); }
+
+    std::vector<D3DXQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXQuaternionRotationMatrix(&dst[i], &mtx[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXQuaternionRotationMatrix)->Arg(1024);
+
+void BM_D3DXQuaternionSquad(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto q = RandomQuaternions(n + 3);
+    std::vector<D3DXQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXQuaternionSquad(&dst[i], &q[i], &q[i + 1], &q[i + 2], &q[i + 3], 0.25f); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXQuaternionSquad)->Arg(1024);
+
+// 1トラックあたり32キーのトラック群.
+struct BenchAnimTracks
+{
+    std::vector<uint32_t>       Offsets;
+    std::vector<float>          Times;
+    std::vector<D3DXQUATERNION> Rotations;
+    std::vector<D3DXVECTOR3>    Translations;
+    std::vector<D3DXQUATERNION> Controls;
+    D3DXANIMTRACKS              Tracks;
+};
+
+void MakeAnimTracks(BenchAnimTracks& ret, size_t trackCount)
+{
+    const size_t keys = 32;
+    ret.Rotations    = RandomQuaternions(trackCount * keys);
+    ret.Translations = RandomVec3(trackCount * keys);
+    ret.Offsets.resize(trackCount + 1);
+    ret.Times.resize(trackCount * keys);
+    for (size_t i = 0; i <= trackCount; ++i)
+    { ret.Offsets[i] = uint32_t(i * keys); }
+    for (size_t i = 0; i < ret.Times.size(); ++i)
+    { ret.Times[i] = float(i % keys) / 30.0f; }
+
+    ret.Tracks = {};
+    ret.Tracks.TrackCount    = uint32_t(trackCount);
+    ret.Tracks.pKeyOffsets   = ret.Offsets.data();
+    ret.Tracks.pTimes        = ret.Times.data();
+    ret.Tracks.pRotations    = ret.Rotations.data();
+    ret.Tracks.pTranslations = ret.Translations.data();
+
+    ret.Controls.resize(ret.Rotations.size() * 3);
+    D3DXAnimTracksSquadSetup(ret.Controls.data(), &ret.Tracks);
+}
+
+// トラックごとにキーを探して D3DXQuaternionSlerp を呼ぶ場合と比較する.
+void BM_D3DXAnimTracksSample_Scalar(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchAnimTracks b;
+    MakeAnimTracks(b, n);
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+
+    float time = 0.0f;
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto pBegin = b.Times.data() + b.Offsets[i];
+            const auto pEnd   = b.Times.data() + b.Offsets[i + 1];
+            const auto key    = size_t(std::upper_bound(pBegin, pEnd - 1, time) - b.Times.data()) - 1;
+            const auto s      = (time - b.Times[key]) / (b.Times[key + 1] - b.Times[key]);
+            D3DXQuaternionSlerp(&rotation[i], &b.Rotations[key], &b.Rotations[key + 1], s);
+            D3DXVec3Lerp(&translation[i], &b.Translations[key], &b.Translations[key + 1], s);
+        }
+        time = (time < 1.0f) ? time + 0.01f : 0.0f;
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXAnimTracksSample_Scalar)->Arg(256);
+
+void BM_D3DXAnimTracksSample(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchAnimTracks b;
+    MakeAnimTracks(b, n);
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+
+    float time = 0.0f;
+    while (state.KeepRunning())
+    {
+        D3DXAnimTracksSample(rotation.data(), translation.data(), &b.Tracks, time);
+        time = (time < 1.0f) ? time + 0.01f : 0.0f;
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * 2 * (sizeof(D3DXQUATERNION) + sizeof(D3DXVECTOR3)));
+}
+BENCHMARK(BM_D3DXAnimTracksSample)->Arg(256);
+
+void BM_D3DXAnimTracksSampleSquad(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchAnimTracks b;
+    MakeAnimTracks(b, n);
+    b.Tracks.pControls = b.Controls.data();
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+
+    float time = 0.0f;
+    while (state.KeepRunning())
+    {
+        D3DXAnimTracksSample(rotation.data(), translation.data(), &b.Tracks, time);
+        time = (time < 1.0f) ? time + 0.01f : 0.0f;
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXAnimTracksSampleSquad)->Arg(256);
+
+// 64ボーンのキャラクターを n 体評価する.
+void BM_D3DXAnimTracksSampleParallel(BenchState& state)
+{
+    const auto n     = size_t(state.Arg());
+    const auto bones = size_t(64);
+    BenchAnimTracks b;
+    MakeAnimTracks(b, bones);
+    const auto times = RandomFloats(n, 0.0f, 1.0f);
+    std::vector<D3DXQUATERNION> rotation(n * bones);
+    std::vector<D3DXVECTOR3>    translation(n * bones);
+
+    while (state.KeepRunning())
+    {
+        D3DXAnimTracksSampleParallel(rotation.data(), translation.data(), &b.Tracks, times.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n * bones);
+}
+BENCHMARK(BM_D3DXAnimTracksSampleParallel)->Arg(1024);
+
+void MakeCompressedAnimTracks(BenchAnimTracks& b, std::vector<D3DXQUATERNION_48>& rotations,
+    std::vector<D3DXVECTOR3_16F>& translations, std::vector<D3DXVECTOR3>& origins, D3DXCOMPRESSEDANIMTRACKS& ret)
+{
+    rotations.resize(b.Rotations.size());
+    translations.resize(b.Translations.size());
+    origins.resize(b.Tracks.TrackCount);
+    D3DXAnimTracksCompress(rotations.data(), translations.data(), origins.data(), &b.Tracks);
+
+    ret = {};
+    ret.TrackCount    = b.Tracks.TrackCount;
+    ret.pKeyOffsets   = b.Tracks.pKeyOffsets;
+    ret.pTimes        = b.Tracks.pTimes;
+    ret.pRotations    = rotations.data();
+    ret.pTranslations = translations.data();
+    ret.pOrigins      = origins.data();
+}
+
+// 1キーあたりのバイト数は BytesProcessed / ItemsProcessed で比較する.
+void BM_D3DXQuaternion48To32Array(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomQuaternions(n);
+    std::vector<D3DXQUATERNION_48> packed(n);
+    D3DXQuaternion32To48Array(packed.data(), src.data(), uint32_t(n));
+    std::vector<D3DXQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXQuaternion48To32Array(dst.data(), packed.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXQUATERNION_48));
+}
+BENCHMARK(BM_D3DXQuaternion48To32Array)->Arg(4096);
+
+void BM_D3DXCompressedAnimTracksSample(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchAnimTracks b;
+    MakeAnimTracks(b, n);
+
+    std::vector<D3DXQUATERNION_48>  rotations;
+    std::vector<D3DXVECTOR3_16F>    translations;
+    std::vector<D3DXVECTOR3>        origins;
+    D3DXCOMPRESSEDANIMTRACKS        tracks;
+    MakeCompressedAnimTracks(b, rotations, translations, origins, tracks);
+
+    std::vector<D3DXQUATERNION> rotation(n);
+    std::vector<D3DXVECTOR3>    translation(n);
+
+    float time = 0.0f;
+    while (state.KeepRunning())
+    {
+        D3DXCompressedAnimTracksSample(rotation.data(), translation.data(), &tracks, time);
+        time = (time < 1.0f) ? time + 0.01f : 0.0f;
+        ClobberMemory();
+    }
+
+    // 1トラックあたり2キーを読む.
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * 2 * (sizeof(D3DXQUATERNION_48) + sizeof(D3DXVECTOR3_16F)));
+}
+BENCHMARK(BM_D3DXCompressedAnimTracksSample)->Arg(256);
+
+void BM_D3DXCompressedAnimTracksSampleParallel(BenchState& state)
+{
+    const auto n     = size_t(state.Arg());
+    const auto bones = size_t(64);
+    BenchAnimTracks b;
+    MakeAnimTracks(b, bones);
+
+    std::vector<D3DXQUATERNION_48>  rotations;
+    std::vector<D3DXVECTOR3_16F>    translations;
+    std::vector<D3DXVECTOR3>        origins;
+    D3DXCOMPRESSEDANIMTRACKS        tracks;
+    MakeCompressedAnimTracks(b, rotations, translations, origins, tracks);
+
+    const auto times = RandomFloats(n, 0.0f, 1.0f);
+    std::vector<D3DXQUATERNION> rotation(n * bones);
+    std::vector<D3DXVECTOR3>    translation(n * bones);
+
+    while (state.KeepRunning())
+    {
+        D3DXCompressedAnimTracksSampleParallel(rotation.data(), translation.data(), &tracks, times.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n * bones);
+}
+BENCHMARK(BM_D3DXCompressedAnimTracksSampleParallel)->Arg(1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Dual quaternions
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<D3DXDUALQUATERNION> RandomDualQuaternions(size_t count)
+{
+    const auto m = RandomMatrices(count);
+    std::vector<D3DXDUALQUATERNION> result(count);
+    D3DXDualQuaternionFromMatrixArray(result.data(), m.data(), uint32_t(count));
+    return result;
+}
+
+// 同じ剛体変換の積を BM_D3DXMatrixMultiplyArray と比較する. 1要素のバイト数は半分になる.
+void BM_D3DXDualQuaternionMultiplyArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto dq1 = RandomDualQuaternions(n);
+    const auto dq2 = RandomDualQuaternions(n);
+    std::vector<D3DXDUALQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXDualQuaternionMultiplyArray(dst.data(), dq1.data(), dq2.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXDUALQUATERNION) * 3);
+}
+BENCHMARK(BM_D3DXDualQuaternionMultiplyArray)->Arg(1024)->Arg(64 * 1024);
+
+void BM_D3DXDualQuaternionMultiply_Call(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto dq1 = RandomDualQuaternions(n);
+    const auto dq2 = RandomDualQuaternions(n);
+    std::vector<D3DXDUALQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXDualQuaternionMultiply(&dst[i], &dq1[i], &dq2[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXDualQuaternionMultiply_Call)->Arg(1024);
+
+void BM_D3DXDualQuaternionScLerpArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto dq1 = RandomDualQuaternions(n);
+    const auto dq2 = RandomDualQuaternions(n);
+    std::vector<D3DXDUALQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXDualQuaternionScLerpArray(dst.data(), dq1.data(), dq2.data(), 0.25f, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXDualQuaternionScLerpArray)->Arg(1024);
+
+void BM_D3DXDualQuaternionFromMatrixArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomMatrices(n);
+    std::vector<D3DXDUALQUATERNION> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXDualQuaternionFromMatrixArray(dst.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXDualQuaternionFromMatrixArray)->Arg(1024);
+
+void BM_D3DXMatrixDualQuaternionArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomDualQuaternions(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixDualQuaternionArray(dst.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixDualQuaternionArray)->Arg(1024);
+
+void BM_D3DXMatrixDualQuaternionArrayParallel(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomDualQuaternions(n);
+    std::vector<D3DXMATRIX> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXMatrixDualQuaternionArrayParallel(dst.data(), src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXMatrixDualQuaternionArrayParallel)->Arg(1024 * 1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Skinning
+///////////////////////////////////////////////////////////////////////////////
+
+struct BenchSkinVertex
+{
+    D3DXVECTOR3 Position;
+    D3DXVECTOR3 Normal;
+    float       Weights[4];
+    uint8_t     Indices[4];
+};
+
+// 64ボーン, 1頂点あたり4ボーンのメッシュ.
+struct BenchSkinMesh
+{
+    std::vector<D3DXMATRIX>         Bones;
+    std::vector<BenchSkinVertex>    Src;
+    std::vector<BenchSkinVertex>    Dst;
+    D3DXSKINSTREAMS                 Streams;
+
+    explicit BenchSkinMesh(size_t count)
+    {
+        Bones = RandomMatrices(64);
+        Src.resize(count);
+        Dst.resize(count);
+
+        const auto tmp = RandomFloats(count * 10, 0.0f, 1.0f);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& v = Src[i];
+            v.Position = D3DXVECTOR3(tmp[i * 10 + 0], tmp[i * 10 + 1], tmp[i * 10 + 2]);
+            v.Normal   = D3DXVECTOR3(0.0f, 1.0f, 0.0f);
+
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k)
+            {
+                v.Indices[k] = uint8_t(tmp[i * 10 + 3 + k] * 63.0f);
+                v.Weights[k] = tmp[i * 10 + 6 + (k % 4)] + 0.1f;
+                sum += v.Weights[k];
+            }
+            for (auto& w : v.Weights)
+            { w /= sum; }
+        }
+
+        Streams = {};
+        Streams.VertexCount       = uint32_t(count);
+        Streams.InfluenceCount    = 4;
+        Streams.pPosition         = &Src[0].Position;
+        Streams.PositionStride    = sizeof(BenchSkinVertex);
+        Streams.pNormal           = &Src[0].Normal;
+        Streams.NormalStride      = sizeof(BenchSkinVertex);
+        Streams.pIndices          = Src[0].Indices;
+        Streams.IndicesStride     = sizeof(BenchSkinVertex);
+        Streams.pWeights          = Src[0].Weights;
+        Streams.WeightsStride     = sizeof(BenchSkinVertex);
+        Streams.pPositionOut      = &Dst[0].Position;
+        Streams.PositionOutStride = sizeof(BenchSkinVertex);
+        Streams.pNormalOut        = &Dst[0].Normal;
+        Streams.NormalOutStride   = sizeof(BenchSkinVertex);
+    }
+};
+
+// 影響する骨ごとに D3DXVec3TransformCoord / D3DXVec3TransformNormal を呼んで足し合わせる場合と比較する.
+void BM_D3DXSkinVertices_Loop(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchSkinMesh mesh(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto& v = mesh.Src[i];
+            D3DXVECTOR3 position(0.0f, 0.0f, 0.0f);
+            D3DXVECTOR3 normal(0.0f, 0.0f, 0.0f);
+            for (int k = 0; k < 4; ++k)
+            {
+                D3DXVECTOR3 tmp;
+                position += *D3DXVec3TransformCoord(&tmp, &v.Position, &mesh.Bones[v.Indices[k]]) * v.Weights[k];
+                normal   += *D3DXVec3TransformNormal(&tmp, &v.Normal, &mesh.Bones[v.Indices[k]]) * v.Weights[k];
+            }
+            mesh.Dst[i].Position = position;
+            D3DXVec3Normalize(&mesh.Dst[i].Normal, &normal);
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSkinVertices_Loop)->Arg(64 * 1024);
+
+void BM_D3DXSkinVertices(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchSkinMesh mesh(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXSkinVertices(&mesh.Streams, mesh.Bones.data(), uint32_t(mesh.Bones.size()), D3DXSKIN_LINEAR);
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSkinVertices)->Arg(64 * 1024);
+
+void BM_D3DXSkinVertices_DualQuaternion(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchSkinMesh mesh(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXSkinVertices(&mesh.Streams, mesh.Bones.data(), uint32_t(mesh.Bones.size()), D3DXSKIN_DUALQUATERNION);
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSkinVertices_DualQuaternion)->Arg(64 * 1024);
+
+// 骨を双対四元数で渡して行列からの変換を省く.
+void BM_D3DXSkinVerticesDualQuaternion(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchSkinMesh mesh(n);
+
+    std::vector<D3DXDUALQUATERNION> bones(mesh.Bones.size());
+    D3DXDualQuaternionFromMatrixArray(bones.data(), mesh.Bones.data(), uint32_t(bones.size()));
+
+    while (state.KeepRunning())
+    {
+        D3DXSkinVerticesDualQuaternion(&mesh.Streams, bones.data(), uint32_t(bones.size()));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSkinVerticesDualQuaternion)->Arg(64 * 1024);
+
+void BM_D3DXSkinVerticesParallel(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    BenchSkinMesh mesh(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXSkinVerticesParallel(&mesh.Streams, mesh.Bones.data(), uint32_t(mesh.Bones.size()), D3DXSKIN_LINEAR);
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSkinVerticesParallel)->Arg(1024 * 1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Plane
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXPlaneNormalize(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXPLANE>(n, -100.0f, 100.0f);
+    std::vector<D3DXPLANE> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXPlaneNormalize(&dst[i], &src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXPlaneNormalize)->Arg(1024);
+
+void BM_D3DXPlaneTransformArray(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXPLANE>(n, -100.0f, 100.0f);
+    const auto mtx = BenchMatrix();
+    std::vector<D3DXPLANE> dst(n);
+
+    while (state.KeepRunning())
+    {
+        D3DXPlaneTransformArray(dst.data(), sizeof(D3DXPLANE), src.data(), sizeof(D3DXPLANE), &mtx, uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXPLANE) * 2);
+}
+BENCHMARK(BM_D3DXPlaneTransformArray)->Arg(4096);
+
+void BM_D3DXPlaneIntersectLine(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomVec3(n + 1);
+    const D3DXPLANE plane(0.0f, 1.0f, 0.0f, -1.0f);
+    std::vector<D3DXVECTOR3> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXPlaneIntersectLine(&dst[i], &plane, &src[i], &src[i + 1]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXPlaneIntersectLine)->Arg(1024);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Color
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXColorAdjustSaturation(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXCOLOR>(n, 0.0f, 1.0f);
+    std::vector<D3DXCOLOR> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXColorAdjustSaturation(&dst[i], &src[i], 0.5f); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXCOLOR) * 2);
+}
+BENCHMARK(BM_D3DXColorAdjustSaturation)->Arg(4096);
+
+void BM_D3DXColorAdjustContrast(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXCOLOR>(n, 0.0f, 1.0f);
+    std::vector<D3DXCOLOR> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXColorAdjustContrast(&dst[i], &src[i], 1.5f); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * sizeof(D3DXCOLOR) * 2);
+}
+BENCHMARK(BM_D3DXColorAdjustContrast)->Arg(4096);
+
+void BM_D3DXCOLOR_ToDWORD(BenchState& state)
+{
+    const auto n   = size_t(state.Arg());
+    const auto src = RandomElements<D3DXCOLOR>(n, 0.0f, 1.0f);
+    std::vector<uint32_t> dst(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { dst[i] = uint32_t(src[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (sizeof(D3DXCOLOR) + sizeof(uint32_t)));
+}
+BENCHMARK(BM_D3DXCOLOR_ToDWORD)->Arg(4096);
+
+// 画像の処理で使う演算の列. 彩度, コントラスト, 乗算の順に適用する.
+const D3DXCOLOROP kBenchColorOps[] = {
+    { D3DXCOLOROP_ADJUSTSATURATION, 0.8f, D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), nullptr },
+    { D3DXCOLOROP_ADJUSTCONTRAST,   1.2f, D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), nullptr },
+    { D3DXCOLOROP_MODULATE,         0.0f, D3DXCOLOR(1.0f, 0.9f, 0.8f, 1.0f), nullptr },
+};
+
+// 従来の1画素ずつ関数を呼ぶループ.
+template<bool Packed>
+void BM_ColorImage_Loop(BenchState& state)
+{
+    const auto width  = size_t(1920);
+    const auto height = size_t(state.Arg());
+    const auto n      = width * height;
+    const auto& tint  = kBenchColorOps[2].Color;
+
+    auto colors = RandomElements<D3DXCOLOR>(n, 0.0f, 1.0f);
+    auto packed = RandomARGB(n);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            D3DXCOLOR c = Packed ? D3DXCOLOR(packed[i]) : colors[i];
+            D3DXColorAdjustSaturation(&c, &c, kBenchColorOps[0].Factor);
+            D3DXColorAdjustContrast(&c, &c, kBenchColorOps[1].Factor);
+            D3DXColorModulate(&c, &c, &tint);
+            if (Packed)
+            { packed[i] = uint32_t(c); }
+            else
+            { colors[i] = c; }
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(n * (Packed ? sizeof(uint32_t) : sizeof(D3DXCOLOR)) * 2);
+}
+
+void BM_ColorImage_Loop_Float(BenchState& state)
+{ BM_ColorImage_Loop<false>(state); }
+BENCHMARK(BM_ColorImage_Loop_Float)->Arg(1080);
+
+void BM_ColorImage_Loop_ARGB(BenchState& state)
+{ BM_ColorImage_Loop<true>(state); }
+BENCHMARK(BM_ColorImage_Loop_ARGB)->Arg(1080);
+
+template<D3DXCOLORFORMAT Format, bool Parallel>
+void BM_ColorImage(BenchState& state)
+{
+    const auto width  = uint32_t(1920);
+    const auto height = uint32_t(state.Arg());
+    const auto n      = size_t(width) * height;
+
+    auto colors = RandomElements<D3DXCOLOR>(n, 0.0f, 1.0f);
+    auto packed = RandomARGB(n);
+
+    D3DXCOLORIMAGE image;
+    image.pBits  = (Format == D3DXCOLORFORMAT_A32B32G32R32F) ? static_cast<void*>(colors.data()) : static_cast<void*>(packed.data());
+    image.Width  = width;
+    image.Height = height;
+    image.Pitch  = width * ((Format == D3DXCOLORFORMAT_A32B32G32R32F) ? sizeof(D3DXCOLOR) : sizeof(uint32_t));
+    image.Format = Format;
+
+    const auto numOps = uint32_t(sizeof(kBenchColorOps) / sizeof(kBenchColorOps[0]));
+    while (state.KeepRunning())
+    {
+        if (Parallel)
+        { D3DXColorImageApplyParallel(&image, nullptr, kBenchColorOps, numOps); }
+        else
+        { D3DXColorImageApply(&image, nullptr, kBenchColorOps, numOps); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+    state.SetBytesProcessed(size_t(image.Pitch) * height * 2);
+}
+
+void BM_D3DXColorImageApply_Float(BenchState& state)
+{ BM_ColorImage<D3DXCOLORFORMAT_A32B32G32R32F, false>(state); }
+BENCHMARK(BM_D3DXColorImageApply_Float)->Arg(1080);
+
+void BM_D3DXColorImageApply_ARGB(BenchState& state)
+{ BM_ColorImage<D3DXCOLORFORMAT_A8R8G8B8, false>(state); }
+BENCHMARK(BM_D3DXColorImageApply_ARGB)->Arg(1080);
+
+void BM_D3DXColorImageApply_SRGB(BenchState& state)
+{ BM_ColorImage<D3DXCOLORFORMAT_A8R8G8B8_SRGB, false>(state); }
+BENCHMARK(BM_D3DXColorImageApply_SRGB)->Arg(1080);
+
+void BM_D3DXColorImageApplyParallel_ARGB(BenchState& state)
+{ BM_ColorImage<D3DXCOLORFORMAT_A8R8G8B8, true>(state); }
+BENCHMARK(BM_D3DXColorImageApplyParallel_ARGB)->Arg(1080);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Spherical Harmonics
+///////////////////////////////////////////////////////////////////////////////
+
+void BM_D3DXSHEvalDirection(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(1024);
+    auto dirs = RandomVec3(n);
+    for (auto& dir : dirs)
+    { D3DXVec3Normalize(&dir, &dir); }
+
+    std::vector<float> dst(n * order * order);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXSHEvalDirection(&dst[i * order * order], order, &dirs[i]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalDirection)->Arg(3)->Arg(6);
+
+// 1方向ずつの版と同じ個数で比較する.
+void BM_D3DXSHEvalDirectionArray(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(1024);
+    auto dirs = RandomVec3(n);
+    for (auto& dir : dirs)
+    { D3DXVec3Normalize(&dir, &dir); }
+
+    std::vector<float> dst(n * order * order);
+
+    while (state.KeepRunning())
+    {
+        D3DXSHEvalDirectionArray(dst.data(), order, dirs.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalDirectionArray)->Arg(3)->Arg(6);
+
+void BM_D3DXSHEvalDirectionSoA(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(1024);
+    auto dirs = RandomVec3(n);
+    std::vector<float> x(n), y(n), z(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        D3DXVec3Normalize(&dirs[i], &dirs[i]);
+        x[i] = dirs[i].x;
+        y[i] = dirs[i].y;
+        z[i] = dirs[i].z;
+    }
+
+    std::vector<float> dst(n * order * order);
+
+    while (state.KeepRunning())
+    {
+        D3DXSHEvalDirectionSoA(dst.data(), order, x.data(), y.data(), z.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalDirectionSoA)->Arg(3)->Arg(6);
+
+void BM_D3DXSHEvalDirectionArrayParallel(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(256 * 1024);
+    auto dirs = RandomVec3(n);
+    for (auto& dir : dirs)
+    { D3DXVec3Normalize(&dir, &dir); }
+
+    std::vector<float> dst(n * order * order);
+
+    while (state.KeepRunning())
+    {
+        D3DXSHEvalDirectionArrayParallel(dst.data(), order, dirs.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalDirectionArrayParallel)->Arg(3)->Arg(6);
+
+void BM_D3DXSHRotate(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(256);
+    const auto src   = RandomFloats(n * order * order, -1.0f, 1.0f);
+    const auto mtx   = BenchMatrix();
+    std::vector<float> dst(src.size());
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXSHRotate(&dst[i * order * order], order, &mtx, &src[i * order * order]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHRotate)->Arg(3)->Arg(6);
+
+// D3DXSHRotate と同じ個数, 同じ行列で比較する.
+void BM_D3DXSHRotatePlan(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(256);
+    const auto src   = RandomFloats(n * order * order, -1.0f, 1.0f);
+    const auto mtx   = BenchMatrix();
+    std::vector<float> dst(src.size());
+
+    while (state.KeepRunning())
+    {
+        D3DXSHROTATEPLAN plan;
+        D3DXSHRotatePlanInit(&plan, order, &mtx);
+        D3DXSHRotatePlanApply(dst.data(), &plan, src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHRotatePlan)->Arg(3)->Arg(6);
+
+void BM_D3DXSHRotatePlanSoA(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(256);
+    const auto src   = RandomFloats(n * order * order, -1.0f, 1.0f);
+    const auto mtx   = BenchMatrix();
+    std::vector<float> dst(src.size());
+
+    while (state.KeepRunning())
+    {
+        D3DXSHROTATEPLAN plan;
+        D3DXSHRotatePlanInit(&plan, order, &mtx);
+        D3DXSHRotatePlanApplySoA(dst.data(), &plan, src.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHRotatePlanSoA)->Arg(3)->Arg(6);
+
+void BM_D3DXSHMultiply3(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto f = RandomFloats(n * 9, -1.0f, 1.0f);
+    const auto g = RandomFloats(n * 9 + 9, -1.0f, 1.0f);
+    std::vector<float> dst(n * 9);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXSHMultiply3(&dst[i * 9], &f[i * 9], &g[i * 9 + 9]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHMultiply3)->Arg(1024);
+
+void BM_D3DXSHMultiply6(BenchState& state)
+{
+    const auto n = size_t(state.Arg());
+    const auto f = RandomFloats(n * 36, -1.0f, 1.0f);
+    const auto g = RandomFloats(n * 36 + 36, -1.0f, 1.0f);
+    std::vector<float> dst(n * 36);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXSHMultiply6(&dst[i * 36], &f[i * 36], &g[i * 36 + 36]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHMultiply6)->Arg(256);
+
+// 1組ずつの版とSoA版を同じ個数で比較する.
+void BM_D3DXSHMultiply_Scalar(BenchState& state)
+{
+    using MultiplyFunc = float* (STUB_API *)(float*, const float*, const float*);
+    const MultiplyFunc funcs[] = {
+        D3DXSHMultiply2, D3DXSHMultiply3, D3DXSHMultiply4, D3DXSHMultiply5, D3DXSHMultiply6 };
+
+    const auto order = uint32_t(state.Arg());
+    const auto count = size_t(order * order);
+    const auto n     = size_t(1024);
+    const auto f     = RandomFloats(n * count, -1.0f, 1.0f);
+    const auto g     = RandomFloats(n * count, -1.0f, 1.0f);
+    const auto func  = funcs[order - D3DXSH_MINORDER];
+    std::vector<float> dst(n * count);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { func(&dst[i * count], &f[i * count], &g[i * count]); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHMultiply_Scalar)->Arg(3)->Arg(6);
+
+void BM_D3DXSHMultiplySoA(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto count = size_t(order * order);
+    const auto n     = size_t(1024);
+    const auto f     = RandomFloats(n * count, -1.0f, 1.0f);
+    const auto g     = RandomFloats(n * count, -1.0f, 1.0f);
+    std::vector<float> dst(n * count);
+
+    while (state.KeepRunning())
+    {
+        D3DXSHMultiplySoA(dst.data(), order, f.data(), g.data(), uint32_t(n));
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHMultiplySoA)->Arg(3)->Arg(6);
+
+void BM_D3DXSHEvalDirectionalLight(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto n     = size_t(256);
+    auto dirs = RandomVec3(n);
+    for (auto& dir : dirs)
+    { D3DXVec3Normalize(&dir, &dir); }
+
+    std::vector<float> r(order * order), g(order * order), b(order * order);
+
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < n; ++i)
+        { D3DXSHEvalDirectionalLight(order, &dirs[i], 1.0f, 0.5f, 0.25f, r.data(), g.data(), b.data()); }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalDirectionalLight)->Arg(3);
+
+std::vector<D3DXSHLIGHT> BenchSHLights(size_t n)
+{
+    const auto vecs = RandomVec3(n);
+    const auto vals = RandomFloats(n * 4, 0.1f, 1.0f);
+
+    std::vector<D3DXSHLIGHT> lights(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto& light = lights[i];
+        light.Type   = D3DXSHLIGHTTYPE(i % 4);
+        light.Vector = vecs[i];
+        if (light.Type != D3DXSHLIGHT_SPHERICAL)
+        { D3DXVec3Normalize(&light.Vector, &light.Vector); }
+        light.Radius = vals[i * 4 + 0];
+        light.Color  = D3DXCOLOR(vals[i * 4 + 1], vals[i * 4 + 2], vals[i * 4 + 3], 1.0f);
+        light.Bottom = D3DXCOLOR(vals[i * 4 + 3], vals[i * 4 + 2], vals[i * 4 + 1], 1.0f);
+    }
+    return lights;
+}
+
+// 1灯ずつ評価して足し合わせる場合と比較する.
+void BM_D3DXSHEvalLights_Scalar(BenchState& state)
+{
+    const auto order  = uint32_t(state.Arg());
+    const auto n      = size_t(1024);
+    const auto lights = BenchSHLights(n);
+    const auto count  = order * order;
+
+    std::vector<float> r(count), g(count), b(count), tr(count), tg(count), tb(count);
+
+    while (state.KeepRunning())
+    {
+        std::fill(r.begin(), r.end(), 0.0f);
+        std::fill(g.begin(), g.end(), 0.0f);
+        std::fill(b.begin(), b.end(), 0.0f);
+        for (const auto& light : lights)
+        {
+            const auto& c = light.Color;
+            switch (light.Type)
+            {
+            case D3DXSHLIGHT_DIRECTIONAL: D3DXSHEvalDirectionalLight(order, &light.Vector, c.r, c.g, c.b, tr.data(), tg.data(), tb.data()); break;
+            case D3DXSHLIGHT_SPHERICAL:   D3DXSHEvalSphericalLight(order, &light.Vector, light.Radius, c.r, c.g, c.b, tr.data(), tg.data(), tb.data()); break;
+            case D3DXSHLIGHT_CONE:        D3DXSHEvalConeLight(order, &light.Vector, light.Radius, c.r, c.g, c.b, tr.data(), tg.data(), tb.data()); break;
+            case D3DXSHLIGHT_HEMISPHERE:  D3DXSHEvalHemisphereLight(order, &light.Vector, light.Color, light.Bottom, tr.data(), tg.data(), tb.data()); break;
+            }
+            D3DXSHAdd(r.data(), order, r.data(), tr.data());
+            D3DXSHAdd(g.data(), order, g.data(), tg.data());
+            D3DXSHAdd(b.data(), order, b.data(), tb.data());
+        }
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalLights_Scalar)->Arg(3)->Arg(6);
+
+void BM_D3DXSHEvalLights(BenchState& state)
+{
+    const auto order  = uint32_t(state.Arg());
+    const auto n      = size_t(1024);
+    const auto lights = BenchSHLights(n);
+
+    std::vector<float> r(order * order), g(order * order), b(order * order);
+
+    while (state.KeepRunning())
+    {
+        D3DXSHEvalLights(order, lights.data(), uint32_t(n), r.data(), g.data(), b.data());
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(n);
+}
+BENCHMARK(BM_D3DXSHEvalLights)->Arg(3)->Arg(6);
+
+void BM_D3DXSHProjectCubeMap(BenchState& state)
+{
+    const auto order = uint32_t(state.Arg());
+    const auto size  = uint32_t(128);
+    const auto texels = RandomFloats(size_t(size) * size * 4 * 6, 0.0f, 1.0f);
+
+    const void* faces[6];
+    for (size_t i = 0; i < 6; ++i)
+    { faces[i] = &texels[i * size * size * 4]; }
+
+    std::vector<float> r(order * order), g(order * order), b(order * order);
+
+    while (state.KeepRunning())
+    {
+        D3DXSHProjectCubeMap(order, faces, size, size * sizeof(float) * 4, D3DXSHCUBEFORMAT_A32B32G32R32F, r.data(), g.data(), b.data());
+        ClobberMemory();
+    }
+
+    state.SetItemsProcessed(size_t(size) * size * 6);
+}
+BENCHMARK(BM_D3DXSHProjectCubeMap)->Arg(3)->Arg(6);
+
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+    // 引数が指定された場合は名前に含まれるものだけ実行.
+    const char* filter = (argc > 1) ? argv[1] : nullptr;
+
+#if defined(D3DX9MATH_STUB_INLINE)
+    printf("D3DX9MATH_STUB_INLINE : on\n");
+#else
+    printf("D3DX9MATH_STUB_INLINE : off\n");
+#endif
+
+    for (auto bench : GetBenchmarks())
+    {
+        if (filter != nullptr && strstr(bench->Name(), filter) == nullptr)
+            continue;
+
+        if (bench->Args().empty())
+        {
+            RunBenchmark(*bench, 0, false);
+            continue;
+        }
+
+        for (auto arg : bench->Args())
+        { RunBenchmark(*bench, arg, true); }
+    }
+
+    return 0;
+}
@@ -7,197 +7,630 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+// ライブラリ側は常に関数の実体を生成する.
+#undef D3DX9MATH_STUB_INLINE
 #include "d3dx9math_stub.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_XM_SSE_INTRINSICS_)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif//_XM_SSE_INTRINSICS_
+
+// 実行時ディスパッチ用の命令セット指定.
+#if defined(__GNUC__) || defined(__clang__)
+#define STUB_TARGET(isa)    __attribute__((target(isa)))
+#else
+#define STUB_TARGET(isa)
+#endif
+
+// DirectXMathの薄いラッパー関数.
+#include "d3dx9math_stub.inl"
 
 
 namespace {
-static constexpr HRESULT kD3D_OK               = 0;            // S_OK.
-static constexpr HRESULT kD3DERR_INVALIDCALL   = MAKE_D3DHRESULT(2156);
+using d3dx9math_stub_detail::kD3D_OK;
+using d3dx9math_stub_detail::kD3DERR_INVALIDCALL;
 
-} // namespace
+///////////////////////////////////////////////////////////////////////////////
+// CpuFeatures structure
+///////////////////////////////////////////////////////////////////////////////
+struct CpuFeatures
+{
+    bool    AVX     = false;
+    bool    AVX2    = false;
+    bool    FMA     = false;
+    bool    F16C    = false;
+};
+
+#if defined(_XM_SSE_INTRINSICS_)
+inline void Cpuid(int info[4], int leaf)
+{
+#if defined(_MSC_VER)
+    __cpuidex(info, leaf, 0);
+#else
+    __cpuid_count(leaf, 0, info[0], info[1], info[2], info[3]);
+#endif
+}
+
+inline uint64_t Xgetbv()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t(edx) << 32) | eax;
+#endif
+}
+#endif//_XM_SSE_INTRINSICS_
+
+CpuFeatures DetectCpuFeatures()
+{
+    CpuFeatures result;
+
+#if defined(_XM_SSE_INTRINSICS_)
+    int info[4] = {};
+    Cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    Cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+
+    // OSがYMMレジスタを退避してくれない場合はAVX系命令は使えない.
+    if (!osxsave || !avx || (Xgetbv() & 0x6) != 0x6)
+        return result;
+
+    result.AVX  = true;
+    result.FMA  = (info[2] & (1 << 12)) != 0;
+    result.F16C = (info[2] & (1 << 29)) != 0;
+
+    if (maxLeaf >= 7)
+    {
+        Cpuid(info, 7);
+        result.AVX2 = (info[1] & (1 << 5)) != 0;
+    }
+#endif
+
+    return result;
+}
+
+const CpuFeatures& GetCpuFeatures()
+{
+    static const CpuFeatures s_Features = DetectCpuFeatures();
+    return s_Features;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
-// Float16
+// WorkerPool class
 ///////////////////////////////////////////////////////////////////////////////
+class WorkerPool
+{
+public:
+    using TaskFunc = void (*)(void* pContext, size_t begin, size_t end);
 
-// Converts an array 32-bit floats to 16-bit floats
-D3DXFLOAT16* STUB_API D3DXFloat32To16Array(D3DXFLOAT16 *pOut, const float *pIn, uint32_t n)
+    explicit WorkerPool(uint32_t threadCount)
+    : m_WorkerCount(threadCount > 1 ? threadCount - 1 : 0)
+    , m_Queues(new Queue[m_WorkerCount + 1])
+    {
+        m_Threads.reserve(m_WorkerCount);
+        for (auto i = 0u; i < m_WorkerCount; ++i)
+        { m_Threads.emplace_back(&WorkerPool::WorkerMain, this, i); }
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Exit = true;
+        }
+        m_WakeUp.notify_all();
+
+        for (auto& thread : m_Threads)
+        { thread.join(); }
+    }
+
+    // 呼び出しスレッドを含めた並列数.
+    uint32_t GetThreadCount() const
+    { return m_WorkerCount + 1; }
+
+    // [0, count)をgrain単位のチャンクに分割して並列実行し, 完了まで待機する.
+    // 待機中の呼び出し元もタスクを処理するので入れ子で呼び出しても良い.
+    void Run(size_t count, size_t grain, TaskFunc func, void* pContext)
+    {
+        if (grain == 0)
+        { grain = 1; }
+
+        const auto chunkCount = (count + grain - 1) / grain;
+        if (m_WorkerCount == 0 || chunkCount <= 1)
+        {
+            func(pContext, 0, count);
+            return;
+        }
+
+        Job job;
+        job.Func     = func;
+        job.pContext = pContext;
+        job.Remaining.store(chunkCount, std::memory_order_relaxed);
+
+        const auto index = GetQueueIndex();
+        {
+            auto& queue = m_Queues[index];
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            for (size_t i = 0; i < chunkCount; ++i)
+            {
+                const auto begin = i * grain;
+                const auto end   = (begin + grain < count) ? begin + grain : count;
+                queue.Tasks.push_back(Task{ &job, begin, end });
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Pending.fetch_add(int64_t(chunkCount));
+        }
+        m_WakeUp.notify_all();
+
+        while (job.Remaining.load(std::memory_order_acquire) != 0)
+        {
+            Task task;
+            if (TryGetTask(index, task))
+            { Execute(task); }
+            else
+            { std::this_thread::yield(); }
+        }
+    }
+
+private:
+    struct Job
+    {
+        TaskFunc                Func     = nullptr;
+        void*                   pContext = nullptr;
+        std::atomic<size_t>     Remaining;
+    };
+
+    struct Task
+    {
+        Job*    pJob  = nullptr;
+        size_t  Begin = 0;
+        size_t  End   = 0;
+    };
+
+    struct Queue
+    {
+        std::mutex          Mutex;
+        std::deque<Task>    Tasks;
+    };
+
+    uint32_t                    m_WorkerCount = 0;
+    std::unique_ptr<Queue[]>    m_Queues;       // 末尾はワーカー以外のスレッド用.
+    std::vector<std::thread>    m_Threads;
+    std::mutex                  m_SleepMutex;
+    std::condition_variable     m_WakeUp;
+    std::atomic<int64_t>        m_Pending = { 0 };
+    bool                        m_Exit    = false;
+
+    static thread_local const WorkerPool*   t_pOwner;
+    static thread_local uint32_t            t_Index;
+
+    uint32_t GetQueueIndex() const
+    { return (t_pOwner == this) ? t_Index : m_WorkerCount; }
+
+    // 自分のキューは後ろから, 他のキューは前から盗む.
+    bool TryGetTask(uint32_t index, Task& task)
+    {
+        const auto queueCount = m_WorkerCount + 1;
+        for (auto i = 0u; i < queueCount; ++i)
+        {
+            const auto target = (index + i) % queueCount;
+            auto& queue = m_Queues[target];
+
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            if (queue.Tasks.empty())
+                continue;
+
+            if (i == 0)
+            {
+                task = queue.Tasks.back();
+                queue.Tasks.pop_back();
+            }
+            else
+            {
+                task = queue.Tasks.front();
+                queue.Tasks.pop_front();
+            }
+
+            m_Pending.fetch_sub(1);
+            return true;
+        }
+
+        return false;
+    }
+
+    static void Execute(const Task& task)
+    {
+        auto pJob = task.pJob;
+        pJob->Func(pJob->pContext, task.Begin, task.End);
+        pJob->Remaining.fetch_sub(1, std::memory_order_release);
+    }
+
+    void WorkerMain(uint32_t index)
+    {
+        t_pOwner = this;
+        t_Index  = index;
+
+        for (;;)
+        {
+            Task task;
+            if (TryGetTask(index, task))
+            {
+                Execute(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_SleepMutex);
+            m_WakeUp.wait(lock, [this] { return m_Exit || m_Pending.load() > 0; });
+            if (m_Exit)
+                return;
+        }
+    }
+};
+
+thread_local const WorkerPool*  WorkerPool::t_pOwner = nullptr;
+thread_local uint32_t           WorkerPool::t_Index  = 0;
+
+std::mutex                      g_WorkerPoolMutex;
+std::unique_ptr<WorkerPool>     g_pWorkerPool;
+uint32_t                        g_WorkerThreadCount = 0;    // 0 の場合はハードウェアスレッド数.
+
+WorkerPool* GetWorkerPool()
 {
-    assert(pOut != nullptr);
-    assert(pIn  != nullptr);
-    for(auto i=0u; i<n; ++i)
+    std::lock_guard<std::mutex> lock(g_WorkerPoolMutex);
+    if (!g_pWorkerPool)
     {
-        pOut[i] = D3DXFLOAT16(pIn[i]);
+        auto count = g_WorkerThreadCount;
+        if (count == 0)
+        { count = std::thread::hardware_concurrency(); }
+        if (count == 0)
+        { count = 1; }
+
+        g_pWorkerPool.reset(new WorkerPool(count));
     }
-    return pOut;
+    return g_pWorkerPool.get();
 }
 
-// Converts an array 16-bit floats to 32-bit floats
-float* STUB_API D3DXFloat16To32Array(float *pOut, const D3DXFLOAT16 *pIn, uint32_t n)
+// [0, count)を分割して func(begin, end) を並列実行する.
+template<typename Func>
+void ParallelFor(size_t count, size_t grain, const Func& func)
 {
-    assert(pOut != nullptr);
-    assert(pIn  != nullptr);
-    for(auto i=0u; i<n; ++i)
+    if (count <= grain)
     {
-        pOut[i] = (float)pIn[i];
+        func(size_t(0), count);
+        return;
     }
-    return pOut;
+
+    GetWorkerPool()->Run(count, grain,
+        [](void* pContext, size_t begin, size_t end)
+        { (*static_cast<const Func*>(pContext))(begin, end); },
+        const_cast<Func*>(&func));
+}
+
+// 1チャンクの入出力がキャッシュに収まる要素数.
+inline size_t GetChunkSize(size_t bytesPerElement)
+{
+    const size_t kChunkBytes = 64 * 1024;
+    const size_t kMinChunk   = 256;
+
+    if (bytesPerElement == 0)
+    { return kMinChunk; }
+
+    const auto count = kChunkBytes / bytesPerElement;
+    return (count > kMinChunk) ? count : kMinChunk;
 }
 
+template<typename T>
+inline T* OffsetPtr(T* ptr, size_t bytes)
+{ return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(ptr) + bytes); }
+
+template<typename T>
+inline const T* OffsetPtr(const T* ptr, size_t bytes)
+{ return reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(ptr) + bytes); }
+
+using d3dx9math_stub_detail::IsAligned16;
+using d3dx9math_stub_detail::LoadMatrix;
+using d3dx9math_stub_detail::StoreMatrix;
+using d3dx9math_stub_detail::LoadFloat4;
+using d3dx9math_stub_detail::StoreFloat4;
+
+} // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
-// D3DXVECTOR2
+// Float16
 ///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+static_assert(sizeof(D3DXFLOAT16) == sizeof(uint16_t), "Invalid D3DXFLOAT16 size.");
+
+using Float32To16Func = void (*)(uint16_t*, const float*, size_t);
+using Float16To32Func = void (*)(float*, const uint16_t*, size_t);
 
-D3DXVECTOR2* STUB_API D3DXVec2Normalize(D3DXVECTOR2 *pOut, const D3DXVECTOR2 *pV)
+void Float32To16Scalar(uint16_t* pOut, const float* pIn, size_t n)
 {
-    auto v   = DirectX::XMLoadFloat2(pV);
-    auto ret = DirectX::XMVector2Normalize(v);
-    DirectX::XMStoreFloat2(pOut, ret);
-    return pOut;
+    for (size_t i = 0; i < n; ++i)
+    { pOut[i] = DirectX::PackedVector::XMConvertFloatToHalf(pIn[i]); }
 }
 
-// Hermite interpolation between position V1, tangent T1 (when s == 0)
-// and position V2, tangent T2 (when s == 1).
-D3DXVECTOR2* STUB_API D3DXVec2Hermite
-(
-     D3DXVECTOR2*       pOut,
-    const D3DXVECTOR2*  pV1,
-    const D3DXVECTOR2*  pT1,
-    const D3DXVECTOR2*  pV2,
-    const D3DXVECTOR2*  pT2,
-    float               s
-)
+void Float16To32Scalar(float* pOut, const uint16_t* pIn, size_t n)
 {
-    assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pT1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pT2  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat2(pV1);
-    auto t1  = DirectX::XMLoadFloat2(pT1);
-    auto v2  = DirectX::XMLoadFloat2(pV2);
-    auto t2  = DirectX::XMLoadFloat2(pT2);
-    auto vs  = DirectX::XMVectorSet(s, s, 0.0f, 0.0f);
-    auto ret = DirectX::XMVectorHermiteV(v1, t1, v2, t2, vs);
-    DirectX::XMStoreFloat2(pOut, ret);
-    return pOut;
+    for (size_t i = 0; i < n; ++i)
+    { pOut[i] = DirectX::PackedVector::XMConvertHalfToFloat(pIn[i]); }
 }
 
-// CatmullRom interpolation between V1 (when s == 0) and V2 (when s == 1)
-D3DXVECTOR2* STUB_API D3DXVec2CatmullRom
-(
-    D3DXVECTOR2*        pOut,
-    const D3DXVECTOR2*  pV0,
-    const D3DXVECTOR2*  pV1,
-    const D3DXVECTOR2*  pV2,
-    const D3DXVECTOR2*  pV3,
-    float               s
-)
+#if defined(_XM_SSE_INTRINSICS_)
+// 4要素を丸め(最近接偶数)付きで変換. 結果は各32bitレーンの下位16bitに入る.
+inline __m128i Float32To16x4(__m128 value)
 {
-    assert(pOut != nullptr);
-    assert(pV0  != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v0  = DirectX::XMLoadFloat2(pV0);
-    auto v1  = DirectX::XMLoadFloat2(pV1);
-    auto v2  = DirectX::XMLoadFloat2(pV2);
-    auto v3  = DirectX::XMLoadFloat2(pV3);
-    auto vs  = DirectX::XMVectorSet(s, s, 0.0f, 0.0f);
-    auto ret = DirectX::XMVectorCatmullRomV(v0, v1, v2, v3, vs);
-    DirectX::XMStoreFloat2(pOut, ret);
-    return pOut;
+    const __m128i kSignMask   = _mm_set1_epi32(int(0x80000000));
+    const __m128i kF16Max     = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i kF32Inf     = _mm_set1_epi32(255 << 23);
+    const __m128i kMinNormal  = _mm_set1_epi32(113 << 23);
+    const __m128i kDenormMagic= _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i kRebias     = _mm_set1_epi32(int(((15u - 127u) << 23) + 0xfff));
+    const __m128i kOne        = _mm_set1_epi32(1);
+
+    auto bits = _mm_castps_si128(value);
+    auto sign = _mm_and_si128(bits, kSignMask);
+    auto abs  = _mm_xor_si128(bits, sign);
+
+    // 正規化数 : 指数を再バイアスして最近接偶数丸め.
+    auto odd    = _mm_and_si128(_mm_srli_epi32(abs, 13), kOne);
+    auto normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(abs, kRebias), odd), 13);
+
+    // 非正規化数 : マジックナンバーを加算してFPUに丸めさせる.
+    auto denorm = _mm_sub_epi32(
+        _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(abs), _mm_castsi128_ps(kDenormMagic))),
+        kDenormMagic);
+
+    // Inf, NaN : NaNはペイロードを残してquiet NaNにする.
+    auto isNaN  = _mm_cmpgt_epi32(abs, kF32Inf);
+    auto infNaN = _mm_or_si128(_mm_set1_epi32(0x7c00),
+        _mm_and_si128(isNaN, _mm_or_si128(_mm_set1_epi32(0x200),
+            _mm_and_si128(_mm_srli_epi32(abs, 13), _mm_set1_epi32(0x3ff)))));
+
+    auto isDenorm = _mm_cmpgt_epi32(kMinNormal, abs);
+    auto isInfNaN = _mm_cmpgt_epi32(abs, _mm_sub_epi32(kF16Max, kOne));
+
+    auto result = _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+    result = _mm_or_si128(_mm_and_si128(isInfNaN, infNaN), _mm_andnot_si128(isInfNaN, result));
+    return _mm_or_si128(result, _mm_srli_epi32(sign, 16));
 }
 
-// Barycentric coordinates.  V1 + f(V2-V1) + g(V3-V1)
-D3DXVECTOR2* STUB_API D3DXVec2BaryCentric
-(
-    D3DXVECTOR2*        pOut,
-    const D3DXVECTOR2*  pV1,
-    const D3DXVECTOR2*  pV2,
-    const D3DXVECTOR2*  pV3,
-    float               f,
-    float               g
-)
+// 各32bitレーンの下位16bitに入ったhalfを変換.
+inline __m128 Float16To32x4(__m128i value)
+{
+    const __m128i kNoSign    = _mm_set1_epi32(0x7fff);
+    const __m128  kMagic     = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const __m128i kWasInfNaN = _mm_set1_epi32(0x7bff);
+    const __m128  kExpInfNaN = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+    auto expmant  = _mm_and_si128(value, kNoSign);
+    auto sign     = _mm_slli_epi32(_mm_xor_si128(value, expmant), 16);
+    auto scaled   = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)), kMagic);
+    auto isInfNaN = _mm_castsi128_ps(_mm_cmpgt_epi32(expmant, kWasInfNaN));
+    auto signInf  = _mm_or_ps(_mm_castsi128_ps(sign), _mm_and_ps(isInfNaN, kExpInfNaN));
+    return _mm_or_ps(scaled, signInf);
+}
+
+// 符号付き飽和パックで値が壊れないよう符号拡張してから詰める.
+inline __m128i PackLow16(__m128i lo, __m128i hi)
+{
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+
+void Float32To16SSE2(uint16_t* pOut, const float* pIn, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto lo = Float32To16x4(_mm_loadu_ps(pIn + i + 0));
+        auto hi = Float32To16x4(_mm_loadu_ps(pIn + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), PackLow16(lo, hi));
+    }
+    for (; i + 4 <= n; i += 4)
+    {
+        auto lo = Float32To16x4(_mm_loadu_ps(pIn + i));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pOut + i), PackLow16(lo, lo));
+    }
+    Float32To16Scalar(pOut + i, pIn + i, n - i);
+}
+
+void Float16To32SSE2(float* pOut, const uint16_t* pIn, size_t n)
+{
+    const auto zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i));
+        _mm_storeu_ps(pOut + i + 0, Float16To32x4(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(pOut + i + 4, Float16To32x4(_mm_unpackhi_epi16(h, zero)));
+    }
+    for (; i + 4 <= n; i += 4)
+    {
+        auto h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pIn + i));
+        _mm_storeu_ps(pOut + i, Float16To32x4(_mm_unpacklo_epi16(h, zero)));
+    }
+    Float16To32Scalar(pOut + i, pIn + i, n - i);
+}
+
+STUB_TARGET("avx,f16c")
+void Float32To16F16C(uint16_t* pOut, const float* pIn, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        auto h0 = _mm256_cvtps_ph(_mm256_loadu_ps(pIn + i +  0), _MM_FROUND_TO_NEAREST_INT);
+        auto h1 = _mm256_cvtps_ph(_mm256_loadu_ps(pIn + i +  8), _MM_FROUND_TO_NEAREST_INT);
+        auto h2 = _mm256_cvtps_ph(_mm256_loadu_ps(pIn + i + 16), _MM_FROUND_TO_NEAREST_INT);
+        auto h3 = _mm256_cvtps_ph(_mm256_loadu_ps(pIn + i + 24), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i +  0), h0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i +  8), h1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i + 16), h2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i + 24), h3);
+    }
+    for (; i + 8 <= n; i += 8)
+    {
+        auto h = _mm256_cvtps_ph(_mm256_loadu_ps(pIn + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), h);
+    }
+    for (; i + 4 <= n; i += 4)
+    {
+        auto h = _mm_cvtps_ph(_mm_loadu_ps(pIn + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pOut + i), h);
+    }
+    Float32To16Scalar(pOut + i, pIn + i, n - i);
+}
+
+STUB_TARGET("avx,f16c")
+void Float16To32F16C(float* pOut, const uint16_t* pIn, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        auto f0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i +  0)));
+        auto f1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i +  8)));
+        auto f2 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i + 16)));
+        auto f3 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i + 24)));
+        _mm256_storeu_ps(pOut + i +  0, f0);
+        _mm256_storeu_ps(pOut + i +  8, f1);
+        _mm256_storeu_ps(pOut + i + 16, f2);
+        _mm256_storeu_ps(pOut + i + 24, f3);
+    }
+    for (; i + 8 <= n; i += 8)
+    {
+        auto f = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i)));
+        _mm256_storeu_ps(pOut + i, f);
+    }
+    for (; i + 4 <= n; i += 4)
+    {
+        auto f = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pIn + i)));
+        _mm_storeu_ps(pOut + i, f);
+    }
+    Float16To32Scalar(pOut + i, pIn + i, n - i);
+}
+#endif//_XM_SSE_INTRINSICS_
+
+Float32To16Func SelectFloat32To16()
+{
+#if defined(_XM_F16C_INTRINSICS_)
+    return Float32To16F16C;
+#elif defined(_XM_SSE_INTRINSICS_)
+    return GetCpuFeatures().F16C ? Float32To16F16C : Float32To16SSE2;
+#else
+    return Float32To16Scalar;
+#endif
+}
+
+Float16To32Func SelectFloat16To32()
+{
+#if defined(_XM_F16C_INTRINSICS_)
+    return Float16To32F16C;
+#elif defined(_XM_SSE_INTRINSICS_)
+    return GetCpuFeatures().F16C ? Float16To32F16C : Float16To32SSE2;
+#else
+    return Float16To32Scalar;
+#endif
+}
+
+} // anonymous namespace
+
+// Converts an array 32-bit floats to 16-bit floats
+D3DXFLOAT16* STUB_API D3DXFloat32To16Array(D3DXFLOAT16 *pOut, const float *pIn, uint32_t n)
 {
     assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat2(pV1);
-    auto v2  = DirectX::XMLoadFloat2(pV2);
-    auto v3  = DirectX::XMLoadFloat2(pV3);
-    auto vf  = DirectX::XMVectorSet(f, f, 0.0f, 0.0f);
-    auto vg  = DirectX::XMVectorSet(g, g, 0.0f, 0.0f);
-    auto ret = DirectX::XMVectorBaryCentricV(v1, v2, v3, vf, vg);
-    DirectX::XMStoreFloat2(pOut, ret);
+    assert(pIn  != nullptr);
+
+    static const auto pConvert = SelectFloat32To16();
+    pConvert(reinterpret_cast<uint16_t*>(pOut), pIn, n);
     return pOut;
 }
 
-// Transform (x, y, 0, 1) by matrix.
-D3DXVECTOR4* STUB_API D3DXVec2Transform
-(
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR2*  pV,
-    const D3DXMATRIX*   pM
-)
+// Converts an array 16-bit floats to 32-bit floats
+float* STUB_API D3DXFloat16To32Array(float *pOut, const D3DXFLOAT16 *pIn, uint32_t n)
 {
     assert(pOut != nullptr);
-    assert(pV   != nullptr);
-    assert(pM   != nullptr);
+    assert(pIn  != nullptr);
 
-    auto vec = DirectX::XMLoadFloat2(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector2Transform(vec, mat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    static const auto pConvert = SelectFloat16To32();
+    pConvert(pOut, reinterpret_cast<const uint16_t*>(pIn), n);
     return pOut;
 }
 
-// Transform (x, y, 0, 1) by matrix, project result back into w=1.
-D3DXVECTOR2* STUB_API D3DXVec2TransformCoord
+///////////////////////////////////////////////////////////////////////////////
+// D3DXVECTOR2
+///////////////////////////////////////////////////////////////////////////////
+
+// Transform Array (x, y, 0, 1) by matrix.
+D3DXVECTOR4* STUB_API D3DXVec2TransformArray
 (
-    D3DXVECTOR2*        pOut,
+    D3DXVECTOR4*        pOut,
+    uint32_t            OutStride,
     const D3DXVECTOR2*  pV,
-    const D3DXMATRIX*   pM
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
 )
 {
     assert(pOut != nullptr);
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto vec = DirectX::XMLoadFloat2(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector2TransformCoord(vec, mat);
-    DirectX::XMStoreFloat2(pOut, ret);
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector2TransformStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
 
-// Transform (x, y, 0, 0) by matrix.
-D3DXVECTOR2* STUB_API D3DXVec2TransformNormal
+// Transform Array (x, y, 0, 1) by matrix, project result back into w=1.
+D3DXVECTOR2* STUB_API D3DXVec2TransformCoordArray
 (
     D3DXVECTOR2*        pOut,
+    uint32_t            OutStride,
     const D3DXVECTOR2*  pV,
-    const D3DXMATRIX*   pM
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
 )
 {
     assert(pOut != nullptr);
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto vec = DirectX::XMLoadFloat2(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector2TransformNormal(vec, mat);
-    DirectX::XMStoreFloat2(pOut, ret);
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector2TransformCoordStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
-     
-// Transform Array (x, y, 0, 1) by matrix.
-D3DXVECTOR4* STUB_API D3DXVec2TransformArray
+
+// Transform Array (x, y, 0, 1) by matrix, project result back into w=1.
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXVECTOR2* STUB_API D3DXVec2TransformCoordArrayParallel
 (
-    D3DXVECTOR4*        pOut,
+    D3DXVECTOR2*        pOut,
     uint32_t            OutStride,
     const D3DXVECTOR2*  pV,
     uint32_t            VStride,
@@ -209,13 +642,22 @@ D3DXVECTOR4* STUB_API D3DXVec2TransformArray
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector2TransformStream(pOut, OutStride, pV, VStride, n, mat);
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXVec2TransformCoordArray(pOut, OutStride, pV, VStride, pM, n); }
+
+    auto mat = LoadMatrix(pM);
+    ParallelFor(n, GetChunkSize(OutStride + VStride), [&](size_t begin, size_t end)
+    {
+        DirectX::XMVector2TransformCoordStream(
+            OffsetPtr(pOut, begin * OutStride), OutStride,
+            OffsetPtr(pV,   begin * VStride),   VStride,
+            end - begin, mat);
+    });
     return pOut;
 }
 
-// Transform Array (x, y, 0, 1) by matrix, project result back into w=1.
-D3DXVECTOR2* STUB_API D3DXVec2TransformCoordArray
+// Transform Array (x, y, 0, 0) by matrix.
+D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArray
 (
     D3DXVECTOR2*        pOut,
     uint32_t            OutStride,
@@ -229,13 +671,14 @@ D3DXVECTOR2* STUB_API D3DXVec2TransformCoordArray
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector2TransformCoordStream(pOut, OutStride, pV, VStride, n, mat);
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector2TransformNormalStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
 
 // Transform Array (x, y, 0, 0) by matrix.
-D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArray
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArrayParallel
 (
     D3DXVECTOR2*        pOut,
     uint32_t            OutStride,
@@ -249,8 +692,17 @@ D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArray
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector2TransformNormalStream(pOut, OutStride, pV, VStride, n, mat);
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXVec2TransformNormalArray(pOut, OutStride, pV, VStride, pM, n); }
+
+    auto mat = LoadMatrix(pM);
+    ParallelFor(n, GetChunkSize(OutStride + VStride), [&](size_t begin, size_t end)
+    {
+        DirectX::XMVector2TransformNormalStream(
+            OffsetPtr(pOut, begin * OutStride), OutStride,
+            OffsetPtr(pV,   begin * VStride),   VStride,
+            end - begin, mat);
+    });
     return pOut;
 }
 
@@ -259,162 +711,209 @@ D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArray
 // D3DXVECTOR3
 ///////////////////////////////////////////////////////////////////////////////
 
-D3DXVECTOR3* STUB_API D3DXVec3Normalize(D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV)
+// Transform Array (x, y, z, 1) by matrix. 
+D3DXVECTOR4* STUB_API D3DXVec3TransformArray
+(
+    D3DXVECTOR4*        pOut,
+    uint32_t            OutStride,
+    const D3DXVECTOR3*  pV,
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
 {
     assert(pOut != nullptr);
     assert(pV   != nullptr);
+    assert(pM   != nullptr);
 
-    auto vec = DirectX::XMLoadFloat3(pV);
-    auto ret = DirectX::XMVector3Normalize(vec);
-    DirectX::XMStoreFloat3(pOut, ret);
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector3TransformStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
 
-// Hermite interpolation between position V1, tangent T1 (when s == 0)
-// and position V2, tangent T2 (when s == 1).
-D3DXVECTOR3* STUB_API D3DXVec3Hermite
+// Transform Array (x, y, z, 1) by matrix, project result back into w=1.
+D3DXVECTOR3* STUB_API D3DXVec3TransformCoordArray
 (
     D3DXVECTOR3*        pOut,
-    const D3DXVECTOR3*  pV1,
-    const D3DXVECTOR3*  pT1,
-    const D3DXVECTOR3*  pV2,
-    const D3DXVECTOR3*  pT2,
-    float               s
-)
+    uint32_t            OutStride,
+    const D3DXVECTOR3*  pV,
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
 {
     assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pT1  != nullptr);
-    assert(pV2  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat3(pV1);
-    auto t1  = DirectX::XMLoadFloat3(pT1);
-    auto v2  = DirectX::XMLoadFloat3(pV2);
-    auto t2  = DirectX::XMLoadFloat3(pT2);
-    auto vs  = DirectX::XMVectorSet(s, s, s, 0.0f);
-    auto ret = DirectX::XMVectorHermiteV(v1, t1, v2, t2, vs);
-    DirectX::XMStoreFloat3(pOut, ret);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector3TransformCoordStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
 
-// CatmullRom interpolation between V1 (when s == 0) and V2 (when s == 1)
-D3DXVECTOR3* STUB_API D3DXVec3CatmullRom
+// Transform Array (x, y, z, 1) by matrix, project result back into w=1.
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXVECTOR3* STUB_API D3DXVec3TransformCoordArrayParallel
 (
     D3DXVECTOR3*        pOut,
-    const D3DXVECTOR3*  pV0,
-    const D3DXVECTOR3*  pV1,
-    const D3DXVECTOR3*  pV2,
-    const D3DXVECTOR3*  pV3,
-    float               s
+    uint32_t            OutStride,
+    const D3DXVECTOR3*  pV,
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
 )
 {
     assert(pOut != nullptr);
-    assert(pV0  != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v0  = DirectX::XMLoadFloat3(pV0);
-    auto v1  = DirectX::XMLoadFloat3(pV1);
-    auto v2  = DirectX::XMLoadFloat3(pV2);
-    auto v3  = DirectX::XMLoadFloat3(pV3);
-    auto vs  = DirectX::XMVectorSet(s, s, s, 0.0f);
-    auto ret = DirectX::XMVectorCatmullRomV(v0, v1, v2, v3, vs);
-    DirectX::XMStoreFloat3(pOut, ret);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXVec3TransformCoordArray(pOut, OutStride, pV, VStride, pM, n); }
+
+    auto mat = LoadMatrix(pM);
+    ParallelFor(n, GetChunkSize(OutStride + VStride), [&](size_t begin, size_t end)
+    {
+        DirectX::XMVector3TransformCoordStream(
+            OffsetPtr(pOut, begin * OutStride), OutStride,
+            OffsetPtr(pV,   begin * VStride),   VStride,
+            end - begin, mat);
+    });
     return pOut;
 }
 
-// Barycentric coordinates.  V1 + f(V2-V1) + g(V3-V1)
-D3DXVECTOR3* STUB_API D3DXVec3BaryCentric
+// Transform (x, y, z, 0) by matrix.  If you transforming a normal by a 
+// non-affine matrix, the matrix you pass to this function should be the 
+// transpose of the inverse of the matrix you would use to transform a coord.
+D3DXVECTOR3* STUB_API D3DXVec3TransformNormalArray
 (
     D3DXVECTOR3*        pOut,
-    const D3DXVECTOR3*  pV1,
-    const D3DXVECTOR3*  pV2,
-    const D3DXVECTOR3*  pV3,
-    float               f,
-    float               g
+    uint32_t            OutStride,
+    const D3DXVECTOR3*  pV,
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
 )
 {
     assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat3(pV1);
-    auto v2  = DirectX::XMLoadFloat3(pV2);
-    auto v3  = DirectX::XMLoadFloat3(pV3);
-    auto vf  = DirectX::XMVectorSet(f, f, f, 0.0f);
-    auto vg  = DirectX::XMVectorSet(g, g, g, 0.0f);
-    auto ret = DirectX::XMVectorBaryCentricV(v1, v2, v3, vf, vg);
-    DirectX::XMStoreFloat3(pOut, ret);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector3TransformNormalStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
 
-// Transform (x, y, z, 1) by matrix.
-D3DXVECTOR4* STUB_API D3DXVec3Transform
+// Transform Array (x, y, z, 0) by matrix.
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXVECTOR3* STUB_API D3DXVec3TransformNormalArrayParallel
 (
-    D3DXVECTOR4*        pOut,
+    D3DXVECTOR3*        pOut,
+    uint32_t            OutStride,
     const D3DXVECTOR3*  pV,
-    const D3DXMATRIX*   pM
+    uint32_t            VStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
 )
 {
     assert(pOut != nullptr);
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto vec = DirectX::XMLoadFloat3(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector3Transform(vec, mat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXVec3TransformNormalArray(pOut, OutStride, pV, VStride, pM, n); }
+
+    auto mat = LoadMatrix(pM);
+    ParallelFor(n, GetChunkSize(OutStride + VStride), [&](size_t begin, size_t end)
+    {
+        DirectX::XMVector3TransformNormalStream(
+            OffsetPtr(pOut, begin * OutStride), OutStride,
+            OffsetPtr(pV,   begin * VStride),   VStride,
+            end - begin, mat);
+    });
     return pOut;
 }
 
-// Transform (x, y, z, 1) by matrix, project result back into w=1.
-D3DXVECTOR3* STUB_API D3DXVec3TransformCoord
+// Project vector Array from object space into screen space
+D3DXVECTOR3* STUB_API D3DXVec3ProjectArray
 (
     D3DXVECTOR3*        pOut,
+    uint32_t            OutStride,
     const D3DXVECTOR3*  pV,
-    const D3DXMATRIX*   pM
+    uint32_t            VStride,
+    const D3DVIEWPORT9* pViewport,
+    const D3DXMATRIX*   pProjection,
+    const D3DXMATRIX*   pView,
+    const D3DXMATRIX*   pWorld,
+    uint32_t            n
 )
 {
-    assert(pOut != nullptr);
-    assert(pV   != nullptr);
-    assert(pM   != nullptr);
+    assert(pOut        != nullptr);
+    assert(pV          != nullptr);
+    assert(pViewport   != nullptr);
+    assert(pProjection != nullptr);
+    assert(pView       != nullptr);
+    assert(pWorld      != nullptr);
+
+    auto x = float(pViewport->X);
+    auto y = float(pViewport->Y);
+    auto w = float(pViewport->Width);
+    auto h = float(pViewport->Height);
+
+    auto proj  = LoadMatrix(pProjection);
+    auto view  = LoadMatrix(pView);
+    auto world = LoadMatrix(pWorld);
 
-    auto vec = DirectX::XMLoadFloat3(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector3TransformCoord(vec, mat);
-    DirectX::XMStoreFloat3(pOut, ret);
+    DirectX::XMVector3ProjectStream(
+        pOut, OutStride, pV, VStride, n, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
     return pOut;
 }
 
-// Transform (x, y, z, 0) by matrix.  If you transforming a normal by a 
-// non-affine matrix, the matrix you pass to this function should be the 
-// transpose of the inverse of the matrix you would use to transform a coord.
-D3DXVECTOR3* STUB_API D3DXVec3TransformNormal
+// Project vector Array from screen space into object space
+D3DXVECTOR3* STUB_API D3DXVec3UnprojectArray
 (
     D3DXVECTOR3*        pOut,
+    uint32_t            OutStride,
     const D3DXVECTOR3*  pV,
-    const D3DXMATRIX*   pM
+    uint32_t            VStride,
+    const D3DVIEWPORT9* pViewport,
+    const D3DXMATRIX*   pProjection,
+    const D3DXMATRIX*   pView,
+    const D3DXMATRIX*   pWorld,
+    uint32_t            n
 )
 {
-    assert(pOut != nullptr);
-    assert(pV   != nullptr);
-    assert(pM   != nullptr);
+    assert(pOut        != nullptr);
+    assert(pV          != nullptr);
+    assert(pViewport   != nullptr);
+    assert(pProjection != nullptr);
+    assert(pView       != nullptr);
+    assert(pWorld      != nullptr);
+
+    auto x = float(pViewport->X);
+    auto y = float(pViewport->Y);
+    auto w = float(pViewport->Width);
+    auto h = float(pViewport->Height);
+
+    auto proj  = LoadMatrix(pProjection);
+    auto view  = LoadMatrix(pView);
+    auto world = LoadMatrix(pWorld);
 
-    auto vec = DirectX::XMLoadFloat3(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector3TransformNormal(vec, mat);
-    DirectX::XMStoreFloat3(pOut, ret);
+    DirectX::XMVector3UnprojectStream(
+        pOut, OutStride, pV, VStride, n, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
     return pOut;
 }
 
-// Transform Array (x, y, z, 1) by matrix. 
-D3DXVECTOR4* STUB_API D3DXVec3TransformArray
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXVECTOR4
+///////////////////////////////////////////////////////////////////////////////
+
+// Transform vector array by matrix.
+D3DXVECTOR4* STUB_API D3DXVec4TransformArray
 (
     D3DXVECTOR4*        pOut,
     uint32_t            OutStride,
-    const D3DXVECTOR3*  pV,
+    const D3DXVECTOR4*  pV,
     uint32_t            VStride,
     const D3DXMATRIX*   pM,
     uint32_t            n
@@ -424,17 +923,18 @@ D3DXVECTOR4* STUB_API D3DXVec3TransformArray
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector3TransformStream(pOut, OutStride, pV, VStride, n, mat);
+    auto mat = LoadMatrix(pM);
+    DirectX::XMVector4TransformStream(pOut, OutStride, pV, VStride, n, mat);
     return pOut;
 }
 
-// Transform Array (x, y, z, 1) by matrix, project result back into w=1.
-D3DXVECTOR3* STUB_API D3DXVec3TransformCoordArray
+// Transform vector array by matrix.
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXVECTOR4* STUB_API D3DXVec4TransformArrayParallel
 (
-    D3DXVECTOR3*        pOut,
+    D3DXVECTOR4*        pOut,
     uint32_t            OutStride,
-    const D3DXVECTOR3*  pV,
+    const D3DXVECTOR4*  pV,
     uint32_t            VStride,
     const D3DXMATRIX*   pM,
     uint32_t            n
@@ -444,1298 +944,6270 @@ D3DXVECTOR3* STUB_API D3DXVec3TransformCoordArray
     assert(pV   != nullptr);
     assert(pM   != nullptr);
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector3TransformCoordStream(pOut, OutStride, pV, VStride, n, mat);
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXVec4TransformArray(pOut, OutStride, pV, VStride, pM, n); }
+
+    auto mat = LoadMatrix(pM);
+    ParallelFor(n, GetChunkSize(OutStride + VStride), [&](size_t begin, size_t end)
+    {
+        DirectX::XMVector4TransformStream(
+            OffsetPtr(pOut, begin * OutStride), OutStride,
+            OffsetPtr(pV,   begin * VStride),   VStride,
+            end - begin, mat);
+    });
     return pOut;
 }
 
-// Transform (x, y, z, 0) by matrix.  If you transforming a normal by a 
-// non-affine matrix, the matrix you pass to this function should be the 
-// transpose of the inverse of the matrix you would use to transform a coord.
-D3DXVECTOR3* STUB_API D3DXVec3TransformNormalArray
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXMATRIX
+///////////////////////////////////////////////////////////////////////////////
+
+namespace /* anonymous */ {
+
+using MultiplyArrayFunc = void (*)(
+    D3DXMATRIX* pOut, const D3DXMATRIX* pM1, const D3DXMATRIX* pM2, size_t m2Stride, size_t n);
+
+using MultiplyHierarchyFunc = void (*)(
+    D3DXMATRIX* pWorld, const D3DXMATRIX* pLocal, const int32_t* pParent, const D3DXMATRIX* pRoot,
+    const uint32_t* pIndex, size_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// MatrixMultiplyKernels structure
+///////////////////////////////////////////////////////////////////////////////
+struct MatrixMultiplyKernels
+{
+    MultiplyArrayFunc       MultiplyArray;
+    MultiplyHierarchyFunc   MultiplyHierarchy;
+};
+
+// m2Strideが0の場合はM2を共有する.
+void MultiplyArrayXM
 (
-    D3DXVECTOR3*        pOut,
-    uint32_t            OutStride,
-    const D3DXVECTOR3*  pV,
-    uint32_t            VStride,
-    const D3DXMATRIX*   pM,
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2,
+    size_t              m2Stride,
+    size_t              n
+)
+{
+    if (m2Stride == 0)
+    {
+        auto m2 = LoadMatrix(pM2);
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto m1 = LoadMatrix(pM1 + i);
+            StoreMatrix(pOut + i, DirectX::XMMatrixMultiply(m1, m2));
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto m1 = LoadMatrix(pM1 + i);
+        auto m2 = LoadMatrix(pM2 + i);
+        StoreMatrix(pOut + i, DirectX::XMMatrixMultiply(m1, m2));
+    }
+}
+
+// pIndexがnullptrでなければ pIndex[0..n) の順に処理する.
+void MultiplyHierarchyXM
+(
+    D3DXMATRIX*         pWorld,
+    const D3DXMATRIX*   pLocal,
+    const int32_t*      pParent,
+    const D3DXMATRIX*   pRoot,
+    const uint32_t*     pIndex,
+    size_t              n
+)
+{
+    auto root = (pRoot != nullptr) ? LoadMatrix(pRoot) : DirectX::XMMatrixIdentity();
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        auto i     = (pIndex != nullptr) ? pIndex[k] : k;
+        auto local = LoadMatrix(pLocal + i);
+        auto p     = pParent[i];
+
+        if (p >= 0)
+        {
+            auto parent = LoadMatrix(pWorld + p);
+            StoreMatrix(pWorld + i, DirectX::XMMatrixMultiply(local, parent));
+        }
+        else if (pRoot != nullptr)
+        { StoreMatrix(pWorld + i, DirectX::XMMatrixMultiply(local, root)); }
+        else
+        { StoreMatrix(pWorld + i, local); }
+    }
+}
+
+#if defined(_XM_SSE_INTRINSICS_)
+// M2の各行を上下128bitに複製して読み込む.
+STUB_TARGET("avx,fma")
+inline void LoadMatrixRowsAVX(__m256 rows[4], const D3DXMATRIX* pM)
+{
+    for (auto r = 0; r < 4; ++r)
+    { rows[r] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&pM->m[r][0])); }
+}
+
+// 2行ずつまとめて計算する. M2の行を先頭から順にFMAで足し込むので, XMMatrixMultiplyとは丸め誤差の分だけ結果が異なる.
+STUB_TARGET("avx,fma")
+inline void MultiplyMatrixAVX(D3DXMATRIX* pOut, const D3DXMATRIX* pM1, const __m256 rows[4])
+{
+    auto a01 = _mm256_loadu_ps(&pM1->m[0][0]);
+    auto a23 = _mm256_loadu_ps(&pM1->m[2][0]);
+
+    auto r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), rows[0]);
+    auto r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), rows[0]);
+    r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0x55), rows[1], r01);
+    r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0x55), rows[1], r23);
+    r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xAA), rows[2], r01);
+    r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xAA), rows[2], r23);
+    r01 = _mm256_fmadd_ps(_mm256_shuffle_ps(a01, a01, 0xFF), rows[3], r01);
+    r23 = _mm256_fmadd_ps(_mm256_shuffle_ps(a23, a23, 0xFF), rows[3], r23);
+
+    _mm256_storeu_ps(&pOut->m[0][0], r01);
+    _mm256_storeu_ps(&pOut->m[2][0], r23);
+}
+
+STUB_TARGET("avx,fma")
+void MultiplyArrayAVX
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2,
+    size_t              m2Stride,
+    size_t              n
+)
+{
+    __m256 rows[4];
+
+    if (m2Stride == 0)
+    {
+        LoadMatrixRowsAVX(rows, pM2);
+        for (size_t i = 0; i < n; ++i)
+        { MultiplyMatrixAVX(pOut + i, pM1 + i, rows); }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        LoadMatrixRowsAVX(rows, pM2 + i);
+        MultiplyMatrixAVX(pOut + i, pM1 + i, rows);
+    }
+}
+
+STUB_TARGET("avx,fma")
+void MultiplyHierarchyAVX
+(
+    D3DXMATRIX*         pWorld,
+    const D3DXMATRIX*   pLocal,
+    const int32_t*      pParent,
+    const D3DXMATRIX*   pRoot,
+    const uint32_t*     pIndex,
+    size_t              n
+)
+{
+    __m256 root[4];
+    if (pRoot != nullptr)
+    { LoadMatrixRowsAVX(root, pRoot); }
+
+    __m256 rows[4];
+    for (size_t k = 0; k < n; ++k)
+    {
+        auto i = (pIndex != nullptr) ? pIndex[k] : k;
+        auto p = pParent[i];
+
+        if (p >= 0)
+        {
+            LoadMatrixRowsAVX(rows, pWorld + p);
+            MultiplyMatrixAVX(pWorld + i, pLocal + i, rows);
+        }
+        else if (pRoot != nullptr)
+        { MultiplyMatrixAVX(pWorld + i, pLocal + i, root); }
+        else if (pWorld != pLocal)
+        { pWorld[i] = pLocal[i]; }
+    }
+}
+#endif//_XM_SSE_INTRINSICS_
+
+MatrixMultiplyKernels SelectMatrixMultiplyKernels()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    const auto& features = GetCpuFeatures();
+    if (features.AVX && features.FMA)
+        return MatrixMultiplyKernels{ MultiplyArrayAVX, MultiplyHierarchyAVX };
+#endif
+    return MatrixMultiplyKernels{ MultiplyArrayXM, MultiplyHierarchyXM };
+}
+
+const MatrixMultiplyKernels& GetMatrixMultiplyKernels()
+{
+    static const auto s_Kernels = SelectMatrixMultiplyKernels();
+    return s_Kernels;
+}
+
+} // anonymous namespace
+
+// Multiply arrays of matrices pairwise. (Out[i] = M1[i] * M2[i])
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArray
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2,
     uint32_t            n
 )
 {
     assert(pOut != nullptr);
-    assert(pV   != nullptr);
-    assert(pM   != nullptr);
+    assert(pM1  != nullptr);
+    assert(pM2  != nullptr);
+
+    GetMatrixMultiplyKernels().MultiplyArray(pOut, pM1, pM2, sizeof(D3DXMATRIX), n);
+    return pOut;
+}
+
+// Multiply an array of matrices by a single matrix. (Out[i] = M1[i] * M2)
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArrayByMatrix
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2,
+    uint32_t            n
+)
+{
+    assert(pOut != nullptr);
+    assert(pM1  != nullptr);
+    assert(pM2  != nullptr);
+
+    GetMatrixMultiplyKernels().MultiplyArray(pOut, pM1, pM2, 0, n);
+    return pOut;
+}
+
+// Propagate local transforms down a hierarchy. (World[i] = Local[i] * World[Parent[i]])
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyHierarchy
+(
+    D3DXMATRIX*         pWorld,
+    const D3DXMATRIX*   pLocal,
+    const int32_t*      pParent,
+    const D3DXMATRIX*   pRoot,
+    uint32_t            n
+)
+{
+    assert(pWorld  != nullptr);
+    assert(pLocal  != nullptr);
+    assert(pParent != nullptr);
+
+    GetMatrixMultiplyKernels().MultiplyHierarchy(pWorld, pLocal, pParent, pRoot, nullptr, n);
+    return pWorld;
+}
+
+// Multiply arrays of matrices pairwise. (Out[i] = M1[i] * M2[i])
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArrayParallel
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2,
+    uint32_t            n
+)
+{
+    assert(pOut != nullptr);
+    assert(pM1  != nullptr);
+    assert(pM2  != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXMatrixMultiplyArray(pOut, pM1, pM2, n); }
+
+    const auto pKernel = GetMatrixMultiplyKernels().MultiplyArray;
+    ParallelFor(n, GetChunkSize(sizeof(D3DXMATRIX) * 3), [&](size_t begin, size_t end)
+    { pKernel(pOut + begin, pM1 + begin, pM2 + begin, sizeof(D3DXMATRIX), end - begin); });
+    return pOut;
+}
+
+// Multiply an array of matrices by a single matrix. (Out[i] = M1[i] * M2)
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArrayByMatrixParallel
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2,
+    uint32_t            n
+)
+{
+    assert(pOut != nullptr);
+    assert(pM1  != nullptr);
+    assert(pM2  != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXMatrixMultiplyArrayByMatrix(pOut, pM1, pM2, n); }
+
+    // M2がpOutの要素を指していても結果が変わらないようにコピーしておく.
+    const auto m2 = *pM2;
+    const auto pKernel = GetMatrixMultiplyKernels().MultiplyArray;
+    ParallelFor(n, GetChunkSize(sizeof(D3DXMATRIX) * 2), [&](size_t begin, size_t end)
+    { pKernel(pOut + begin, pM1 + begin, &m2, 0, end - begin); });
+    return pOut;
+}
+
+// Propagate local transforms down a hierarchy. (World[i] = Local[i] * World[Parent[i]])
+// Multithreaded version. Nodes of the same depth are processed in parallel.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyHierarchyParallel
+(
+    D3DXMATRIX*         pWorld,
+    const D3DXMATRIX*   pLocal,
+    const int32_t*      pParent,
+    const D3DXMATRIX*   pRoot,
+    uint32_t            n
+)
+{
+    assert(pWorld  != nullptr);
+    assert(pLocal  != nullptr);
+    assert(pParent != nullptr);
+
+    // 並べ替えの準備コストがあるので, 1スレッドの場合は逐次版で処理する.
+    if (n < D3DX_PARALLEL_THRESHOLD || GetWorkerPool()->GetThreadCount() <= 1)
+    { return D3DXMatrixMultiplyHierarchy(pWorld, pLocal, pParent, pRoot, n); }
+
+    // 深さを求めて, 深さごとにノード番号を並べる.
+    std::vector<uint32_t> depth(n);
+    uint32_t maxDepth = 0;
+    for (auto i = 0u; i < n; ++i)
+    {
+        auto p = pParent[i];
+        assert(p < int32_t(i));
+        depth[i] = (p >= 0) ? depth[p] + 1 : 0;
+        maxDepth = (depth[i] > maxDepth) ? depth[i] : maxDepth;
+    }
+
+    std::vector<uint32_t> offset(maxDepth + 2, 0);
+    for (auto i = 0u; i < n; ++i)
+    { offset[depth[i] + 1]++; }
+    for (auto d = 0u; d <= maxDepth; ++d)
+    { offset[d + 1] += offset[d]; }
+
+    std::vector<uint32_t> index(n);
+    {
+        auto cursor = offset;
+        for (auto i = 0u; i < n; ++i)
+        { index[cursor[depth[i]]++] = i; }
+    }
+
+    const auto pKernel = GetMatrixMultiplyKernels().MultiplyHierarchy;
+    const auto grain   = GetChunkSize(sizeof(D3DXMATRIX) * 3);
+    for (auto d = 0u; d <= maxDepth; ++d)
+    {
+        auto pIndex = index.data() + offset[d];
+        ParallelFor(offset[d + 1] - offset[d], grain, [&](size_t begin, size_t end)
+        { pKernel(pWorld, pLocal, pParent, pRoot, pIndex + begin, end - begin); });
+    }
+
+    return pWorld;
+}
+
+namespace /* anonymous */ {
+
+// 分解の判定に使う閾値. XMMatrixDecompose の XM3_DECOMP_EPSILON に合わせる.
+const float kDecomposeEpsilon = 0.0001f;
+
+struct MatrixDecomposeArgs
+{
+    D3DXVECTOR3*        pScale;
+    D3DXQUATERNION*     pRotation;
+    D3DXVECTOR3*        pTranslation;
+    uint32_t*           pFailed;
+    const D3DXMATRIX*   pM;
+};
+
+// 1個の行列を分解する. 失敗した場合は単位元を書き込んで false を返す.
+bool DecomposeMatrix
+(
+    D3DXVECTOR3*        pScale,
+    D3DXQUATERNION*     pRotation,
+    D3DXVECTOR3*        pTranslation,
+    const D3DXMATRIX*   pM
+)
+{
+    if (D3DXMatrixDecompose(pScale, pRotation, pTranslation, pM) == kD3D_OK)
+        return true;
+
+    *pScale       = D3DXVECTOR3(1.0f, 1.0f, 1.0f);
+    *pRotation    = D3DXQUATERNION(0.0f, 0.0f, 0.0f, 1.0f);
+    *pTranslation = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
+    return false;
+}
+
+// XMQuaternionRotationMatrix と同じく, 最も大きい成分を対角成分から求めて残りを導く.
+// m[r][c] は4個の回転行列の (r, c) 成分, q は x, y, z, w のレーン.
+void QuaternionFromRotationLanes(const DirectX::XMVECTOR m[3][3], DirectX::XMVECTOR q[4])
+{
+    using namespace DirectX;
+
+    const auto one    = XMVectorSplatOne();
+    const auto zero   = XMVectorZero();
+    const auto negZ   = XMVectorLessOrEqual(m[2][2], zero);
+    const auto dif10  = XMVectorSubtract(m[1][1], m[0][0]);
+    const auto sum10  = XMVectorAdd(m[1][1], m[0][0]);
+    const auto caseX  = XMVectorAndInt(negZ, XMVectorLessOrEqual(dif10, zero));
+    const auto caseY  = XMVectorAndCInt(negZ, caseX);
+    const auto caseZ  = XMVectorAndCInt(XMVectorLessOrEqual(sum10, zero), negZ);
+
+    const auto omr22 = XMVectorSubtract(one, m[2][2]);
+    const auto opr22 = XMVectorAdd(one, m[2][2]);
+    auto fourSqr = XMVectorSelect(XMVectorAdd(opr22, sum10), XMVectorSubtract(omr22, dif10), caseX);
+    fourSqr = XMVectorSelect(fourSqr, XMVectorAdd(omr22, dif10), caseY);
+    fourSqr = XMVectorSelect(fourSqr, XMVectorSubtract(opr22, sum10), caseZ);
+    const auto inv = XMVectorDivide(XMVectorReplicate(0.5f), XMVectorSqrt(fourSqr));
+
+    const auto s01 = XMVectorAdd(m[0][1], m[1][0]);
+    const auto s02 = XMVectorAdd(m[0][2], m[2][0]);
+    const auto s12 = XMVectorAdd(m[1][2], m[2][1]);
+    const auto d01 = XMVectorSubtract(m[0][1], m[1][0]);
+    const auto d20 = XMVectorSubtract(m[2][0], m[0][2]);
+    const auto d12 = XMVectorSubtract(m[1][2], m[2][1]);
+
+    auto select = [&](XMVECTOR x, XMVECTOR y, XMVECTOR z, XMVECTOR w)
+    {
+        auto v = XMVectorSelect(w, x, caseX);
+        v = XMVectorSelect(v, y, caseY);
+        v = XMVectorSelect(v, z, caseZ);
+        return XMVectorMultiply(v, inv);
+    };
+    q[0] = select(fourSqr, s01, s02, d12);
+    q[1] = select(s01, fourSqr, s12, d20);
+    q[2] = select(s02, s12, fourSqr, d01);
+    q[3] = select(d12, d20, d01, fourSqr);
+}
+
+// 4個の行列をレーンごとに分解し, 失敗した行列のビットマスクを返す.
+// 縮尺が 0 に近い軸を持つ行列は基底の補い方が行列ごとに異なるので DecomposeMatrix で処理する.
+uint32_t DecomposeMatrices4
+(
+    D3DXVECTOR3*        pScale,
+    D3DXQUATERNION*     pRotation,
+    D3DXVECTOR3*        pTranslation,
+    const D3DXMATRIX*   pM
+)
+{
+    using namespace DirectX;
+
+    // m[r][c] は4個の行列の (r, c) 成分.
+    XMVECTOR m[3][3];
+    for (auto r = 0; r < 3; ++r)
+    {
+        const auto t = XMMatrixTranspose(XMMATRIX(
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pM[0].m[r][0])),
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pM[1].m[r][0])),
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pM[2].m[r][0])),
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pM[3].m[r][0]))));
+        m[r][0] = t.r[0];
+        m[r][1] = t.r[1];
+        m[r][2] = t.r[2];
+    }
+
+    // 行の長さが縮尺になり, 行を正規化したものが回転の基底になる.
+    const auto eps = XMVectorReplicate(kDecomposeEpsilon);
+    auto valid = XMVectorTrueInt();
+    XMVECTOR scale[3];
+    for (auto r = 0; r < 3; ++r)
+    {
+        scale[r] = XMVectorSqrt(XMVectorAdd(XMVectorAdd(
+            XMVectorMultiply(m[r][0], m[r][0]),
+            XMVectorMultiply(m[r][1], m[r][1])),
+            XMVectorMultiply(m[r][2], m[r][2])));
+        valid = XMVectorAndInt(valid, XMVectorGreaterOrEqual(scale[r], eps));
+
+        for (auto c = 0; c < 3; ++c)
+        { m[r][c] = XMVectorDivide(m[r][c], scale[r]); }
+    }
+
+    // 左手系の場合は最も大きい縮尺の軸を反転する. 軸の選び方は XM3RANKDECOMPOSE に合わせる.
+    auto det = XMVectorAdd(XMVectorAdd(
+        XMVectorMultiply(m[0][0], XMVectorSubtract(XMVectorMultiply(m[1][1], m[2][2]), XMVectorMultiply(m[1][2], m[2][1]))),
+        XMVectorMultiply(m[0][1], XMVectorSubtract(XMVectorMultiply(m[1][2], m[2][0]), XMVectorMultiply(m[1][0], m[2][2])))),
+        XMVectorMultiply(m[0][2], XMVectorSubtract(XMVectorMultiply(m[1][0], m[2][1]), XMVectorMultiply(m[1][1], m[2][0]))));
+
+    const auto xy   = XMVectorLess(scale[0], scale[1]);
+    const auto xz   = XMVectorLess(scale[0], scale[2]);
+    const auto yz   = XMVectorLess(scale[1], scale[2]);
+    const auto flip = XMVectorLess(det, XMVectorZero());
+    const XMVECTOR largest[2] = {
+        XMVectorAndCInt(XMVectorAndCInt(XMVectorTrueInt(), xy), xz),
+        XMVectorAndCInt(xy, yz),
+    };
+    const XMVECTOR axis[3] = {
+        XMVectorAndInt(flip, largest[0]),
+        XMVectorAndInt(flip, largest[1]),
+        XMVectorAndCInt(XMVectorAndCInt(flip, largest[0]), largest[1]),
+    };
+    for (auto r = 0; r < 3; ++r)
+    {
+        scale[r] = XMVectorSelect(scale[r], XMVectorNegate(scale[r]), axis[r]);
+        for (auto c = 0; c < 3; ++c)
+        { m[r][c] = XMVectorSelect(m[r][c], XMVectorNegate(m[r][c]), axis[r]); }
+    }
+
+    // 行列式が 1 から離れていれば回転行列ではない.
+    const auto diff   = XMVectorSubtract(XMVectorAbs(det), XMVectorSplatOne());
+    const auto failed = XMVectorGreater(XMVectorMultiply(diff, diff), eps);
+
+    XMVECTOR rotation[4];
+    QuaternionFromRotationLanes(m, rotation);
+    const auto q = XMMatrixTranspose(XMMATRIX(rotation[0], rotation[1], rotation[2], rotation[3]));
+    const auto s = XMMatrixTranspose(XMMATRIX(scale[0], scale[1], scale[2], XMVectorZero()));
+
+    for (auto k = 0; k < 4; ++k)
+    {
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&pScale[k]), s.r[k]);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&pRotation[k]), q.r[k]);
+        pTranslation[k] = D3DXVECTOR3(pM[k]._41, pM[k]._42, pM[k]._43);
+    }
+
+    uint32_t validMask[4];
+    uint32_t failedMask[4];
+    XMStoreInt4(validMask,  valid);
+    XMStoreInt4(failedMask, failed);
+
+    uint32_t result = 0;
+    for (auto k = 0; k < 4; ++k)
+    {
+        if (!validMask[k])
+        {
+            if (!DecomposeMatrix(&pScale[k], &pRotation[k], &pTranslation[k], &pM[k]))
+            { result |= 1u << k; }
+        }
+        else if (failedMask[k])
+        {
+            pScale[k]       = D3DXVECTOR3(1.0f, 1.0f, 1.0f);
+            pRotation[k]    = D3DXQUATERNION(0.0f, 0.0f, 0.0f, 1.0f);
+            pTranslation[k] = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
+            result |= 1u << k;
+        }
+    }
+    return result;
+}
+
+// [begin, end) を分解して失敗した数を返す. begin は32の倍数であること.
+uint32_t DecomposeMatrices(const MatrixDecomposeArgs& args, size_t begin, size_t end)
+{
+    assert(begin % 32 == 0);
+
+    uint32_t count = 0;
+    for (auto word = begin; word < end; word += 32)
+    {
+        const auto wordEnd = (word + 32 < end) ? word + 32 : end;
+
+        uint32_t bits = 0;
+        size_t   i    = word;
+        for (; i + 4 <= wordEnd; i += 4)
+        { bits |= DecomposeMatrices4(args.pScale + i, args.pRotation + i, args.pTranslation + i, args.pM + i) << (i - word); }
+
+        // 端数は単位行列で埋めて同じ計算をする.
+        if (i < wordEnd)
+        {
+            D3DXMATRIX      m[4];
+            D3DXVECTOR3     s[4];
+            D3DXQUATERNION  q[4];
+            D3DXVECTOR3     t[4];
+            for (auto k = 0; k < 4; ++k)
+            { D3DXMatrixIdentity(&m[k]); }
+            std::copy(args.pM + i, args.pM + wordEnd, m);
+
+            bits |= DecomposeMatrices4(s, q, t, m) << (i - word);
+            std::copy(s, s + (wordEnd - i), args.pScale + i);
+            std::copy(q, q + (wordEnd - i), args.pRotation + i);
+            std::copy(t, t + (wordEnd - i), args.pTranslation + i);
+        }
+
+        if (args.pFailed != nullptr)
+        { args.pFailed[word / 32] = bits; }
+
+        for (; bits != 0; bits &= bits - 1)
+        { count++; }
+    }
+    return count;
+}
+
+// 4個分の縮尺, 回転, 平行移動から行列を組み立てる. 演算順は XMMatrixRotationQuaternion に合わせる.
+void ComposeMatrices4
+(
+    D3DXMATRIX*             pOut,
+    const D3DXVECTOR3*      pScale,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation
+)
+{
+    using namespace DirectX;
+
+    auto load3 = [](const D3DXVECTOR3* p)
+    {
+        return XMMatrixTranspose(XMMATRIX(
+            XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&p[0])),
+            XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&p[1])),
+            XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&p[2])),
+            XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&p[3]))));
+    };
+    const auto s = load3(pScale);
+    const auto t = load3(pTranslation);
+    const auto q = XMMatrixTranspose(XMMATRIX(
+        XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pRotation[0])),
+        XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pRotation[1])),
+        XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pRotation[2])),
+        XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pRotation[3]))));
+
+    const auto x2 = XMVectorAdd(q.r[0], q.r[0]);
+    const auto y2 = XMVectorAdd(q.r[1], q.r[1]);
+    const auto z2 = XMVectorAdd(q.r[2], q.r[2]);
+    const auto xx = XMVectorMultiply(x2, q.r[0]);
+    const auto yy = XMVectorMultiply(y2, q.r[1]);
+    const auto zz = XMVectorMultiply(z2, q.r[2]);
+    const auto xy = XMVectorMultiply(x2, q.r[1]);
+    const auto xz = XMVectorMultiply(x2, q.r[2]);
+    const auto yz = XMVectorMultiply(y2, q.r[2]);
+    const auto wx = XMVectorMultiply(x2, q.r[3]);
+    const auto wy = XMVectorMultiply(y2, q.r[3]);
+    const auto wz = XMVectorMultiply(z2, q.r[3]);
+    const auto one  = XMVectorSplatOne();
+    const auto zero = XMVectorZero();
+
+    const XMMATRIX rows[4] = {
+        XMMatrixTranspose(XMMATRIX(
+            XMVectorMultiply(s.r[0], XMVectorSubtract(XMVectorSubtract(one, yy), zz)),
+            XMVectorMultiply(s.r[0], XMVectorAdd(xy, wz)),
+            XMVectorMultiply(s.r[0], XMVectorSubtract(xz, wy)),
+            zero)),
+        XMMatrixTranspose(XMMATRIX(
+            XMVectorMultiply(s.r[1], XMVectorSubtract(xy, wz)),
+            XMVectorMultiply(s.r[1], XMVectorSubtract(XMVectorSubtract(one, xx), zz)),
+            XMVectorMultiply(s.r[1], XMVectorAdd(yz, wx)),
+            zero)),
+        XMMatrixTranspose(XMMATRIX(
+            XMVectorMultiply(s.r[2], XMVectorAdd(xz, wy)),
+            XMVectorMultiply(s.r[2], XMVectorSubtract(yz, wx)),
+            XMVectorMultiply(s.r[2], XMVectorSubtract(XMVectorSubtract(one, xx), yy)),
+            zero)),
+        XMMatrixTranspose(XMMATRIX(t.r[0], t.r[1], t.r[2], one)),
+    };
+
+    for (auto k = 0; k < 4; ++k)
+    {
+        for (auto r = 0; r < 4; ++r)
+        { XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&pOut[k].m[r][0]), rows[r].r[k]); }
+    }
+}
+
+// [begin, end) の行列を組み立てる. nullptr の配列は単位元として扱う.
+void ComposeMatrices
+(
+    D3DXMATRIX*             pOut,
+    const D3DXVECTOR3*      pScale,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation,
+    size_t                  begin,
+    size_t                  end
+)
+{
+    const D3DXVECTOR3    kOne [4] = { { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
+    const D3DXVECTOR3    kZero[4] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    const D3DXQUATERNION kIdentity[4] = {
+        { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        ComposeMatrices4(pOut + i,
+            (pScale       != nullptr) ? pScale       + i : kOne,
+            (pRotation    != nullptr) ? pRotation    + i : kIdentity,
+            (pTranslation != nullptr) ? pTranslation + i : kZero);
+    }
+
+    // 端数は単位元で埋めて同じ計算をする.
+    if (i < end)
+    {
+        D3DXMATRIX      m[4];
+        D3DXVECTOR3     s[4] = { kOne[0], kOne[1], kOne[2], kOne[3] };
+        D3DXQUATERNION  q[4] = { kIdentity[0], kIdentity[1], kIdentity[2], kIdentity[3] };
+        D3DXVECTOR3     t[4] = { kZero[0], kZero[1], kZero[2], kZero[3] };
+        if (pScale       != nullptr) { std::copy(pScale       + i, pScale       + end, s); }
+        if (pRotation    != nullptr) { std::copy(pRotation    + i, pRotation    + end, q); }
+        if (pTranslation != nullptr) { std::copy(pTranslation + i, pTranslation + end, t); }
+
+        ComposeMatrices4(m, s, q, t);
+        std::copy(m, m + (end - i), pOut + i);
+    }
+}
+
+} // anonymous namespace
+
+// Decompose an array of matrices into scale, rotation and translation.
+uint32_t STUB_API D3DXMatrixDecomposeArray
+(
+    D3DXVECTOR3*        pOutScale,
+    D3DXQUATERNION*     pOutRotation,
+    D3DXVECTOR3*        pOutTranslation,
+    uint32_t*           pFailed,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOutScale       != nullptr);
+    assert(pOutRotation    != nullptr);
+    assert(pOutTranslation != nullptr);
+    assert(pM              != nullptr);
+
+    const MatrixDecomposeArgs args = { pOutScale, pOutRotation, pOutTranslation, pFailed, pM };
+    return DecomposeMatrices(args, 0, n);
+}
+
+// Build an array of matrices from scale, rotation and translation.
+D3DXMATRIX* STUB_API D3DXMatrixComposeArray
+(
+    D3DXMATRIX*             pOut,
+    const D3DXVECTOR3*      pScale,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation,
+    uint32_t                n
+)
+{
+    assert(pOut != nullptr);
+
+    ComposeMatrices(pOut, pScale, pRotation, pTranslation, 0, n);
+    return pOut;
+}
+
+// Decompose an array of matrices into scale, rotation and translation.
+// Multithreaded version. Small arrays stay on the calling thread.
+uint32_t STUB_API D3DXMatrixDecomposeArrayParallel
+(
+    D3DXVECTOR3*        pOutScale,
+    D3DXQUATERNION*     pOutRotation,
+    D3DXVECTOR3*        pOutTranslation,
+    uint32_t*           pFailed,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOutScale       != nullptr);
+    assert(pOutRotation    != nullptr);
+    assert(pOutTranslation != nullptr);
+    assert(pM              != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXMatrixDecomposeArray(pOutScale, pOutRotation, pOutTranslation, pFailed, pM, n); }
+
+    // 失敗ビットの1ワードを複数のスレッドで書き込まないようにチャンクを32の倍数にそろえる.
+    const MatrixDecomposeArgs args = { pOutScale, pOutRotation, pOutTranslation, pFailed, pM };
+    const auto bytes = sizeof(D3DXMATRIX) + sizeof(D3DXVECTOR3) * 2 + sizeof(D3DXQUATERNION);
+
+    std::atomic<uint32_t> failed(0);
+    ParallelFor(n, GetChunkSize(bytes) & ~size_t(31), [&](size_t begin, size_t end)
+    { failed += DecomposeMatrices(args, begin, end); });
+    return failed;
+}
+
+// Build an array of matrices from scale, rotation and translation.
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXMATRIX* STUB_API D3DXMatrixComposeArrayParallel
+(
+    D3DXMATRIX*             pOut,
+    const D3DXVECTOR3*      pScale,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation,
+    uint32_t                n
+)
+{
+    assert(pOut != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXMatrixComposeArray(pOut, pScale, pRotation, pTranslation, n); }
+
+    const auto bytes = sizeof(D3DXMATRIX) + sizeof(D3DXVECTOR3) * 2 + sizeof(D3DXQUATERNION);
+    ParallelFor(n, GetChunkSize(bytes), [&](size_t begin, size_t end)
+    { ComposeMatrices(pOut, pScale, pRotation, pTranslation, begin, end); });
+    return pOut;
+}
+
+namespace /* anonymous */ {
+
+// 剛体変換とみなす直交性の誤差.
+const float kRigidEpsilon = 1.0e-6f;
+
+// 最後の列が (0, 0, 0, 1) なら平行移動を除いた 3x3 部分だけを逆行列にすればよい.
+inline bool IsAffineMatrix(const D3DXMATRIX* pM)
+{ return pM->_14 == 0.0f && pM->_24 == 0.0f && pM->_34 == 0.0f && pM->_44 == 1.0f; }
+
+// 3x3 部分 m と転置 t の積が単位行列に近ければ剛体変換.
+inline bool IsRigidMatrix(const DirectX::XMMATRIX& m, const DirectX::XMMATRIX& t)
+{
+    const auto p   = DirectX::XMMatrixMultiply(m, t);
+    const auto id  = DirectX::XMMatrixIdentity();
+    const auto eps = DirectX::XMVectorReplicate(kRigidEpsilon);
+    return DirectX::XMVector3NearEqual(p.r[0], id.r[0], eps)
+        && DirectX::XMVector3NearEqual(p.r[1], id.r[1], eps)
+        && DirectX::XMVector3NearEqual(p.r[2], id.r[2], eps);
+}
+
+// 行列を分類して逆行列を求める. pDeterminant が nullptr の場合, 剛体変換の行列式は計算しない.
+D3DXMATRIXCLASS InverseMatrix(D3DXMATRIX* pOut, float* pDeterminant, const D3DXMATRIX* pM)
+{
+    using namespace DirectX;
+
+    if (!IsAffineMatrix(pM))
+    {
+        XMVECTOR det;
+        const auto inv = XMMatrixInverse(&det, LoadMatrix(pM));
+        if (pDeterminant != nullptr)
+        { XMStoreFloat(pDeterminant, det); }
+        StoreMatrix(pOut, inv);
+        return D3DXMATRIXCLASS_GENERAL;
+    }
+
+    // 平行移動を外した行列とその転置.
+    auto m = LoadMatrix(pM);
+    const auto translation = m.r[3];
+    m.r[3] = XMMatrixIdentity().r[3];
+    auto inv = XMMatrixTranspose(m);
+
+    auto type = D3DXMATRIXCLASS_RIGID;
+    if (IsRigidMatrix(m, inv))
+    {
+        if (pDeterminant != nullptr)
+        { XMStoreFloat(pDeterminant, XMVector3Dot(m.r[0], XMVector3Cross(m.r[1], m.r[2]))); }
+    }
+    else
+    {
+        // 3x3 部分の余因子を行列式で割る.
+        const auto c0  = XMVector3Cross(m.r[1], m.r[2]);
+        const auto c1  = XMVector3Cross(m.r[2], m.r[0]);
+        const auto c2  = XMVector3Cross(m.r[0], m.r[1]);
+        const auto det = XMVector3Dot(m.r[0], c0);
+        const auto rcp = XMVectorReciprocal(det);
+        if (pDeterminant != nullptr)
+        { XMStoreFloat(pDeterminant, det); }
+
+        inv = XMMatrixTranspose(XMMATRIX(
+            XMVectorMultiply(c0, rcp),
+            XMVectorMultiply(c1, rcp),
+            XMVectorMultiply(c2, rcp),
+            m.r[3]));
+        type = D3DXMATRIXCLASS_AFFINE;
+    }
+
+    inv.r[3] = XMVectorSubtract(m.r[3], XMVector3TransformNormal(translation, inv));
+    StoreMatrix(pOut, inv);
+    return type;
+}
+
+void InverseMatrices(D3DXMATRIX* pOut, float* pDeterminant, const D3DXMATRIX* pM, size_t begin, size_t end)
+{
+    for (auto i = begin; i < end; ++i)
+    { InverseMatrix(pOut + i, (pDeterminant != nullptr) ? pDeterminant + i : nullptr, pM + i); }
+}
+
+} // anonymous namespace
+
+// Classify a matrix.
+D3DXMATRIXCLASS STUB_API D3DXMatrixClassify(const D3DXMATRIX* pM)
+{
+    assert(pM != nullptr);
+
+    if (!IsAffineMatrix(pM))
+        return D3DXMATRIXCLASS_GENERAL;
+
+    auto m = LoadMatrix(pM);
+    m.r[3] = DirectX::XMMatrixIdentity().r[3];
+    return IsRigidMatrix(m, DirectX::XMMatrixTranspose(m)) ? D3DXMATRIXCLASS_RIGID : D3DXMATRIXCLASS_AFFINE;
+}
+
+// Invert an array of matrices.
+D3DXMATRIX* STUB_API D3DXMatrixInverseArray
+(
+    D3DXMATRIX*         pOut,
+    float*              pDeterminant,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOut != nullptr);
+    assert(pM   != nullptr);
+
+    InverseMatrices(pOut, pDeterminant, pM, 0, n);
+    return pOut;
+}
+
+// Invert an array of matrices.
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXMATRIX* STUB_API D3DXMatrixInverseArrayParallel
+(
+    D3DXMATRIX*         pOut,
+    float*              pDeterminant,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOut != nullptr);
+    assert(pM   != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXMatrixInverseArray(pOut, pDeterminant, pM, n); }
+
+    ParallelFor(n, GetChunkSize(sizeof(D3DXMATRIX) * 2 + sizeof(float)), [&](size_t begin, size_t end)
+    { InverseMatrices(pOut, pDeterminant, pM, begin, end); });
+    return pOut;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXQUATERNION
+///////////////////////////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXPLANE
+///////////////////////////////////////////////////////////////////////////////
+
+// Transform an array of planes by a matrix.  The vectors (a,b,c) must be normal.
+// M should be the inverse transpose of the transformation desired.
+D3DXPLANE* STUB_API D3DXPlaneTransformArray
+(
+    D3DXPLANE*          pOut,
+    uint32_t            OutStride,
+    const D3DXPLANE*    pP,
+    uint32_t            PStride,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOut != nullptr);
+    assert(pP   != nullptr);
+    assert(pM   != nullptr);
+    
+    auto m   = LoadMatrix(pM);
+    auto ret = DirectX::XMPlaneTransformStream(
+        (DirectX::XMFLOAT4*)pOut, OutStride, (DirectX::XMFLOAT4*)pP, PStride, n, m);
+    return pOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Structure of Arrays
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////
+// SoATransformArgs structure
+///////////////////////////////////////////////////////////////////////////////
+struct SoATransformArgs
+{
+    float*          pOut[4];        // pOut[3]がnullptrの場合は w を出力しない.
+    const float*    pIn[4];         // pIn[3]がnullptrの場合は w = InW とする.
+    float           InW;
+    bool            Divide;         // w除算後に Scale, Offset を適用する.
+    float           Scale[3];
+    float           Offset[3];
+    D3DXMATRIX      Matrix;
+};
+
+using SoATransformFunc = size_t (*)(const SoATransformArgs& args, size_t begin, size_t end);
+
+// 行ベクトル (x, y, z, w) に行列を掛ける. 加算順はDirectXMathに合わせる.
+size_t TransformSoAScalar(const SoATransformArgs& args, size_t begin, size_t end)
+{
+    const auto& m = args.Matrix;
+    for (auto i = begin; i < end; ++i)
+    {
+        auto x = args.pIn[0][i];
+        auto y = args.pIn[1][i];
+        auto z = args.pIn[2][i];
+        auto w = (args.pIn[3] != nullptr) ? args.pIn[3][i] : args.InW;
+
+        float r[4];
+        for (auto c = 0; c < 4; ++c)
+        { r[c] = x * m.m[0][c] + (y * m.m[1][c] + (z * m.m[2][c] + w * m.m[3][c])); }
+
+        if (args.Divide)
+        {
+            auto rcp = 1.0f / r[3];
+            for (auto c = 0; c < 3; ++c)
+            { r[c] = (r[c] * rcp) * args.Scale[c] + args.Offset[c]; }
+        }
+
+        for (auto c = 0; c < 4; ++c)
+        {
+            if (args.pOut[c] != nullptr)
+            { args.pOut[c][i] = r[c]; }
+        }
+    }
+    return end;
+}
+
+// 4要素ずつ処理する.
+size_t TransformSoAVector(const SoATransformArgs& args, size_t begin, size_t end)
+{
+    DirectX::XMVECTOR m[4][4];
+    for (auto r = 0; r < 4; ++r)
+    {
+        for (auto c = 0; c < 4; ++c)
+        { m[r][c] = DirectX::XMVectorReplicate(args.Matrix.m[r][c]); }
+    }
+
+    DirectX::XMVECTOR scale[3], offset[3];
+    for (auto c = 0; c < 3; ++c)
+    {
+        scale [c] = DirectX::XMVectorReplicate(args.Scale [c]);
+        offset[c] = DirectX::XMVectorReplicate(args.Offset[c]);
+    }
+
+    const auto inW = DirectX::XMVectorReplicate(args.InW);
+
+    // 出力先がargsと別名にならないようにローカルへコピーしておく.
+    float* pOut[4];
+    const float* pIn[4];
+    for (auto c = 0; c < 4; ++c)
+    {
+        pOut[c] = args.pOut[c];
+        pIn [c] = args.pIn [c];
+    }
+    const auto divide = args.Divide;
+
+    auto i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        auto x = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn[0] + i));
+        auto y = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn[1] + i));
+        auto z = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn[2] + i));
+        auto w = (pIn[3] != nullptr)
+            ? DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn[3] + i))
+            : inW;
+
+        DirectX::XMVECTOR r[4];
+        for (auto c = 0; c < 4; ++c)
+        {
+            r[c] = DirectX::XMVectorMultiply(w, m[3][c]);
+            r[c] = DirectX::XMVectorMultiplyAdd(z, m[2][c], r[c]);
+            r[c] = DirectX::XMVectorMultiplyAdd(y, m[1][c], r[c]);
+            r[c] = DirectX::XMVectorMultiplyAdd(x, m[0][c], r[c]);
+        }
+
+        if (divide)
+        {
+            auto rcp = DirectX::XMVectorReciprocal(r[3]);
+            for (auto c = 0; c < 3; ++c)
+            { r[c] = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorMultiply(r[c], rcp), scale[c], offset[c]); }
+        }
+
+        for (auto c = 0; c < 4; ++c)
+        {
+            if (pOut[c] != nullptr)
+            { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(pOut[c] + i), r[c]); }
+        }
+    }
+    return i;
+}
+
+#if defined(_XM_SSE_INTRINSICS_)
+// 8要素ずつ処理する.
+STUB_TARGET("avx2,fma")
+size_t TransformSoAAVX2(const SoATransformArgs& args, size_t begin, size_t end)
+{
+    __m256 m[4][4];
+    for (auto r = 0; r < 4; ++r)
+    {
+        for (auto c = 0; c < 4; ++c)
+        { m[r][c] = _mm256_set1_ps(args.Matrix.m[r][c]); }
+    }
+
+    __m256 scale[3], offset[3];
+    for (auto c = 0; c < 3; ++c)
+    {
+        scale [c] = _mm256_set1_ps(args.Scale [c]);
+        offset[c] = _mm256_set1_ps(args.Offset[c]);
+    }
+
+    const auto inW = _mm256_set1_ps(args.InW);
+    const auto one = _mm256_set1_ps(1.0f);
+
+    float* pOut[4];
+    const float* pIn[4];
+    for (auto c = 0; c < 4; ++c)
+    {
+        pOut[c] = args.pOut[c];
+        pIn [c] = args.pIn [c];
+    }
+    const auto divide = args.Divide;
+
+    auto i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        auto x = _mm256_loadu_ps(pIn[0] + i);
+        auto y = _mm256_loadu_ps(pIn[1] + i);
+        auto z = _mm256_loadu_ps(pIn[2] + i);
+        auto w = (pIn[3] != nullptr) ? _mm256_loadu_ps(pIn[3] + i) : inW;
+
+        __m256 r[4];
+        for (auto c = 0; c < 4; ++c)
+        {
+            r[c] = _mm256_mul_ps(w, m[3][c]);
+            r[c] = _mm256_fmadd_ps(z, m[2][c], r[c]);
+            r[c] = _mm256_fmadd_ps(y, m[1][c], r[c]);
+            r[c] = _mm256_fmadd_ps(x, m[0][c], r[c]);
+        }
+
+        if (divide)
+        {
+            auto rcp = _mm256_div_ps(one, r[3]);
+            for (auto c = 0; c < 3; ++c)
+            { r[c] = _mm256_fmadd_ps(_mm256_mul_ps(r[c], rcp), scale[c], offset[c]); }
+        }
+
+        for (auto c = 0; c < 4; ++c)
+        {
+            if (pOut[c] != nullptr)
+            { _mm256_storeu_ps(pOut[c] + i, r[c]); }
+        }
+    }
+    return i;
+}
+#endif//_XM_SSE_INTRINSICS_
+
+SoATransformFunc SelectTransformSoA()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    const auto& features = GetCpuFeatures();
+    if (features.AVX2 && features.FMA)
+        return TransformSoAAVX2;
+#endif
+    return TransformSoAVector;
+}
+
+void TransformSoA(const SoATransformArgs& args, size_t n)
+{
+    static const auto pKernel = SelectTransformSoA();
+
+    auto i = pKernel(args, 0, n);
+    i = TransformSoAVector(args, i, n);
+    TransformSoAScalar(args, i, n);
+}
+
+SoATransformArgs MakeSoATransformArgs
+(
+    float*              pOutX,
+    float*              pOutY,
+    float*              pOutZ,
+    float*              pOutW,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pW,
+    float               inW,
+    const D3DXMATRIX&   m
+)
+{
+    SoATransformArgs args = {};
+    args.pOut[0] = pOutX;
+    args.pOut[1] = pOutY;
+    args.pOut[2] = pOutZ;
+    args.pOut[3] = pOutW;
+    args.pIn [0] = pX;
+    args.pIn [1] = pY;
+    args.pIn [2] = pZ;
+    args.pIn [3] = pW;
+    args.InW     = inW;
+    args.Matrix  = m;
+    return args;
+}
+
+// 4要素の構造体配列を成分ごとの配列に分解.
+void Float4AoSToSoA(float* pX, float* pY, float* pZ, float* pW, const void* pV, uint32_t stride, size_t n)
+{
+    auto pSrc = static_cast<const uint8_t*>(pV);
+    size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+    if (stride == sizeof(float) * 4)
+    {
+        auto pF = reinterpret_cast<const float*>(pSrc);
+        for (; i + 4 <= n; i += 4)
+        {
+            auto r0 = _mm_loadu_ps(pF + i * 4 +  0);
+            auto r1 = _mm_loadu_ps(pF + i * 4 +  4);
+            auto r2 = _mm_loadu_ps(pF + i * 4 +  8);
+            auto r3 = _mm_loadu_ps(pF + i * 4 + 12);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(pX + i, r0);
+            _mm_storeu_ps(pY + i, r1);
+            _mm_storeu_ps(pZ + i, r2);
+            _mm_storeu_ps(pW + i, r3);
+        }
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        auto pF = reinterpret_cast<const float*>(pSrc + i * stride);
+        pX[i] = pF[0];
+        pY[i] = pF[1];
+        pZ[i] = pF[2];
+        pW[i] = pF[3];
+    }
+}
+
+// 成分ごとの配列を4要素の構造体配列にまとめる.
+void Float4SoAToAoS(void* pOut, uint32_t stride, const float* pX, const float* pY, const float* pZ, const float* pW, size_t n)
+{
+    auto pDst = static_cast<uint8_t*>(pOut);
+    size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+    if (stride == sizeof(float) * 4)
+    {
+        auto pF = reinterpret_cast<float*>(pDst);
+        for (; i + 4 <= n; i += 4)
+        {
+            auto r0 = _mm_loadu_ps(pX + i);
+            auto r1 = _mm_loadu_ps(pY + i);
+            auto r2 = _mm_loadu_ps(pZ + i);
+            auto r3 = _mm_loadu_ps(pW + i);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(pF + i * 4 +  0, r0);
+            _mm_storeu_ps(pF + i * 4 +  4, r1);
+            _mm_storeu_ps(pF + i * 4 +  8, r2);
+            _mm_storeu_ps(pF + i * 4 + 12, r3);
+        }
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        auto pF = reinterpret_cast<float*>(pDst + i * stride);
+        pF[0] = pX[i];
+        pF[1] = pY[i];
+        pF[2] = pZ[i];
+        pF[3] = pW[i];
+    }
+}
+
+} // anonymous namespace
+
+// Split an array of vectors into separate x, y, z arrays.
+void STUB_API D3DXVec3AoSToSoA
+(
+    float*              pX,
+    float*              pY,
+    float*              pZ,
+    const D3DXVECTOR3*  pV,
+    uint32_t            VStride,
+    uint32_t            n
+)
+{
+    assert(pX != nullptr);
+    assert(pY != nullptr);
+    assert(pZ != nullptr);
+    assert(pV != nullptr);
+
+    auto pSrc = reinterpret_cast<const uint8_t*>(pV);
+    size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+    if (VStride == sizeof(D3DXVECTOR3))
+    {
+        // 4要素(12 float)を3回のロードで読み込んで並べ替える.
+        auto pF = reinterpret_cast<const float*>(pSrc);
+        for (; i + 4 <= n; i += 4)
+        {
+            auto a = _mm_loadu_ps(pF + i * 3 + 0);    // x0 y0 z0 x1
+            auto b = _mm_loadu_ps(pF + i * 3 + 4);    // y1 z1 x2 y2
+            auto c = _mm_loadu_ps(pF + i * 3 + 8);    // z2 x3 y3 z3
+
+            auto t0 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2));
+            auto t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1));
+            auto t2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3));
+            auto t3 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2));
+            auto t4 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0));
+
+            _mm_storeu_ps(pX + i, _mm_shuffle_ps(a,  t0, _MM_SHUFFLE(2, 0, 3, 0)));
+            _mm_storeu_ps(pY + i, _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(pZ + i, _mm_shuffle_ps(t3, t4, _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        auto pF = reinterpret_cast<const float*>(pSrc + i * VStride);
+        pX[i] = pF[0];
+        pY[i] = pF[1];
+        pZ[i] = pF[2];
+    }
+}
+
+// Interleave separate x, y, z arrays into an array of vectors.
+void STUB_API D3DXVec3SoAToAoS
+(
+    D3DXVECTOR3*    pOut,
+    uint32_t        OutStride,
+    const float*    pX,
+    const float*    pY,
+    const float*    pZ,
+    uint32_t        n
+)
+{
+    assert(pOut != nullptr);
+    assert(pX   != nullptr);
+    assert(pY   != nullptr);
+    assert(pZ   != nullptr);
+
+    auto pDst = reinterpret_cast<uint8_t*>(pOut);
+    size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+    if (OutStride == sizeof(D3DXVECTOR3))
+    {
+        auto pF = reinterpret_cast<float*>(pDst);
+        for (; i + 4 <= n; i += 4)
+        {
+            auto x = _mm_loadu_ps(pX + i);
+            auto y = _mm_loadu_ps(pY + i);
+            auto z = _mm_loadu_ps(pZ + i);
+
+            auto xy01 = _mm_unpacklo_ps(x, y);     // x0 y0 x1 y1
+            auto xy23 = _mm_unpackhi_ps(x, y);     // x2 y2 x3 y3
+
+            auto t0 = _mm_shuffle_ps(z,    xy01, _MM_SHUFFLE(0, 2, 0, 0));
+            auto t1 = _mm_shuffle_ps(xy01, z,    _MM_SHUFFLE(0, 1, 0, 3));
+            auto t2 = _mm_shuffle_ps(z,    xy23, _MM_SHUFFLE(0, 2, 0, 2));
+            auto t3 = _mm_shuffle_ps(xy23, z,    _MM_SHUFFLE(0, 3, 0, 3));
+
+            _mm_storeu_ps(pF + i * 3 + 0, _mm_shuffle_ps(xy01, t0,   _MM_SHUFFLE(2, 0, 1, 0)));
+            _mm_storeu_ps(pF + i * 3 + 4, _mm_shuffle_ps(t1,   xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+            _mm_storeu_ps(pF + i * 3 + 8, _mm_shuffle_ps(t2,   t3,   _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+    }
+#endif
+
+    for (; i < n; ++i)
+    {
+        auto pF = reinterpret_cast<float*>(pDst + i * OutStride);
+        pF[0] = pX[i];
+        pF[1] = pY[i];
+        pF[2] = pZ[i];
+    }
+}
+
+// Split an array of vectors into separate x, y, z, w arrays.
+void STUB_API D3DXVec4AoSToSoA
+(
+    float*              pX,
+    float*              pY,
+    float*              pZ,
+    float*              pW,
+    const D3DXVECTOR4*  pV,
+    uint32_t            VStride,
+    uint32_t            n
+)
+{
+    assert(pX != nullptr);
+    assert(pY != nullptr);
+    assert(pZ != nullptr);
+    assert(pW != nullptr);
+    assert(pV != nullptr);
+
+    Float4AoSToSoA(pX, pY, pZ, pW, pV, VStride, n);
+}
+
+// Interleave separate x, y, z, w arrays into an array of vectors.
+void STUB_API D3DXVec4SoAToAoS
+(
+    D3DXVECTOR4*    pOut,
+    uint32_t        OutStride,
+    const float*    pX,
+    const float*    pY,
+    const float*    pZ,
+    const float*    pW,
+    uint32_t        n
+)
+{
+    assert(pOut != nullptr);
+    assert(pX   != nullptr);
+    assert(pY   != nullptr);
+    assert(pZ   != nullptr);
+    assert(pW   != nullptr);
+
+    Float4SoAToAoS(pOut, OutStride, pX, pY, pZ, pW, n);
+}
+
+// Split an array of planes into separate a, b, c, d arrays.
+void STUB_API D3DXPlaneAoSToSoA
+(
+    float*              pA,
+    float*              pB,
+    float*              pC,
+    float*              pD,
+    const D3DXPLANE*    pP,
+    uint32_t            PStride,
+    uint32_t            n
+)
+{
+    assert(pA != nullptr);
+    assert(pB != nullptr);
+    assert(pC != nullptr);
+    assert(pD != nullptr);
+    assert(pP != nullptr);
+
+    Float4AoSToSoA(pA, pB, pC, pD, pP, PStride, n);
+}
+
+// Interleave separate a, b, c, d arrays into an array of planes.
+void STUB_API D3DXPlaneSoAToAoS
+(
+    D3DXPLANE*      pOut,
+    uint32_t        OutStride,
+    const float*    pA,
+    const float*    pB,
+    const float*    pC,
+    const float*    pD,
+    uint32_t        n
+)
+{
+    assert(pOut != nullptr);
+    assert(pA   != nullptr);
+    assert(pB   != nullptr);
+    assert(pC   != nullptr);
+    assert(pD   != nullptr);
+
+    Float4SoAToAoS(pOut, OutStride, pA, pB, pC, pD, n);
+}
+
+// Transform SoA (x, y, z, 1) by matrix. pOutW may be NULL.
+void STUB_API D3DXVec3TransformSoA
+(
+    float*              pOutX,
+    float*              pOutY,
+    float*              pOutZ,
+    float*              pOutW,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOutX != nullptr);
+    assert(pOutY != nullptr);
+    assert(pOutZ != nullptr);
+    assert(pX    != nullptr);
+    assert(pY    != nullptr);
+    assert(pZ    != nullptr);
+    assert(pM    != nullptr);
+
+    auto args = MakeSoATransformArgs(pOutX, pOutY, pOutZ, pOutW, pX, pY, pZ, nullptr, 1.0f, *pM);
+    TransformSoA(args, n);
+}
+
+// Transform SoA (x, y, z, 1) by matrix, project result back into w=1.
+void STUB_API D3DXVec3TransformCoordSoA
+(
+    float*              pOutX,
+    float*              pOutY,
+    float*              pOutZ,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOutX != nullptr);
+    assert(pOutY != nullptr);
+    assert(pOutZ != nullptr);
+    assert(pX    != nullptr);
+    assert(pY    != nullptr);
+    assert(pZ    != nullptr);
+    assert(pM    != nullptr);
+
+    auto args = MakeSoATransformArgs(pOutX, pOutY, pOutZ, nullptr, pX, pY, pZ, nullptr, 1.0f, *pM);
+    args.Divide = true;
+    for (auto c = 0; c < 3; ++c)
+    {
+        args.Scale [c] = 1.0f;
+        args.Offset[c] = 0.0f;
+    }
+    TransformSoA(args, n);
+}
+
+// Transform SoA (x, y, z, 0) by matrix.
+void STUB_API D3DXVec3TransformNormalSoA
+(
+    float*              pOutX,
+    float*              pOutY,
+    float*              pOutZ,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOutX != nullptr);
+    assert(pOutY != nullptr);
+    assert(pOutZ != nullptr);
+    assert(pX    != nullptr);
+    assert(pY    != nullptr);
+    assert(pZ    != nullptr);
+    assert(pM    != nullptr);
+
+    auto args = MakeSoATransformArgs(pOutX, pOutY, pOutZ, nullptr, pX, pY, pZ, nullptr, 0.0f, *pM);
+    TransformSoA(args, n);
+}
+
+// Project SoA vectors from object space into screen space
+void STUB_API D3DXVec3ProjectSoA
+(
+    float*              pOutX,
+    float*              pOutY,
+    float*              pOutZ,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const D3DVIEWPORT9* pViewport,
+    const D3DXMATRIX*   pProjection,
+    const D3DXMATRIX*   pView,
+    const D3DXMATRIX*   pWorld,
+    uint32_t            n
+)
+{
+    assert(pOutX       != nullptr);
+    assert(pOutY       != nullptr);
+    assert(pOutZ       != nullptr);
+    assert(pX          != nullptr);
+    assert(pY          != nullptr);
+    assert(pZ          != nullptr);
+    assert(pViewport   != nullptr);
+    assert(pProjection != nullptr);
+    assert(pView       != nullptr);
+    assert(pWorld      != nullptr);
+
+    auto halfW = float(pViewport->Width)  * 0.5f;
+    auto halfH = float(pViewport->Height) * 0.5f;
+
+    // XMVector3Project と同じく World * View * Projection を先に合成する.
+    auto world = LoadMatrix(pWorld);
+    auto view  = LoadMatrix(pView);
+    auto proj  = LoadMatrix(pProjection);
+    auto wvp   = DirectX::XMMatrixMultiply(DirectX::XMMatrixMultiply(world, view), proj);
+
+    D3DXMATRIX m;
+    StoreMatrix(&m, wvp);
+
+    auto args = MakeSoATransformArgs(pOutX, pOutY, pOutZ, nullptr, pX, pY, pZ, nullptr, 1.0f, m);
+    args.Divide    = true;
+    args.Scale [0] = halfW;
+    args.Scale [1] = -halfH;
+    args.Scale [2] = pViewport->MaxZ - pViewport->MinZ;
+    args.Offset[0] = float(pViewport->X) + halfW;
+    args.Offset[1] = float(pViewport->Y) + halfH;
+    args.Offset[2] = pViewport->MinZ;
+    TransformSoA(args, n);
+}
+
+// Transform SoA planes by a matrix.  The vectors (a,b,c) must be normal.
+// M should be the inverse transpose of the transformation desired.
+void STUB_API D3DXPlaneTransformSoA
+(
+    float*              pOutA,
+    float*              pOutB,
+    float*              pOutC,
+    float*              pOutD,
+    const float*        pA,
+    const float*        pB,
+    const float*        pC,
+    const float*        pD,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
+{
+    assert(pOutA != nullptr);
+    assert(pOutB != nullptr);
+    assert(pOutC != nullptr);
+    assert(pOutD != nullptr);
+    assert(pA    != nullptr);
+    assert(pB    != nullptr);
+    assert(pC    != nullptr);
+    assert(pD    != nullptr);
+    assert(pM    != nullptr);
+
+    auto args = MakeSoATransformArgs(pOutA, pOutB, pOutC, pOutD, pA, pB, pC, pD, 0.0f, *pM);
+    TransformSoA(args, n);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Frustum culling
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+///////////////////////////////////////////////////////////////////////////////
+// FrustumCullArgs structure
+///////////////////////////////////////////////////////////////////////////////
+struct FrustumCullArgs
+{
+    uint8_t*        pOut;
+    const float*    pCenter[3];
+    const float*    pRadius;        // 球の半径. nullptrの場合は 0 とする.
+    const float*    pExtent[3];     // 箱の半分の大きさ. pExtent[0]がnullptrの場合は球とする.
+    const float*    pAxis;          // OBB の軸. [(3 * i + j) * Count + k] で, nullptrの場合は AABB とする.
+    size_t          Count;
+    D3DXPLANE       Planes[6];
+};
+
+using FrustumCullFunc = size_t (*)(const FrustumCullArgs& args, size_t begin, size_t end, uint32_t& visible);
+
+inline uint8_t FrustumCullResult(bool outside, bool inside)
+{ return inside ? uint8_t(D3DXCULL_INSIDE) : (outside ? uint8_t(D3DXCULL_OUTSIDE) : uint8_t(D3DXCULL_INTERSECT)); }
+
+// 平面までの距離 d と, 平面の法線方向への広がり r を比較する.
+// d < -r ならば外側, 全ての平面で d >= r ならば内側になる. 計算順はベクトル版に合わせる.
+size_t FrustumCullScalar(const FrustumCullArgs& args, size_t begin, size_t end, uint32_t& visible)
+{
+    for (auto i = begin; i < end; ++i)
+    {
+        const float x = args.pCenter[0][i];
+        const float y = args.pCenter[1][i];
+        const float z = args.pCenter[2][i];
+
+        bool outside = false;
+        bool inside  = true;
+        for (const auto& p : args.Planes)
+        {
+            const float d = x * p.a + (y * p.b + (z * p.c + p.d));
+
+            float r = (args.pRadius != nullptr) ? args.pRadius[i] : 0.0f;
+            if (args.pAxis != nullptr)
+            {
+                for (auto k = 0; k < 3; ++k)
+                {
+                    const auto pAxis = args.pAxis + 3 * k * args.Count;
+                    const float dot  = pAxis[i] * p.a + (pAxis[args.Count + i] * p.b + pAxis[2 * args.Count + i] * p.c);
+                    r = args.pExtent[k][i] * fabsf(dot) + r;
+                }
+            }
+            else if (args.pExtent[0] != nullptr)
+            {
+                r = args.pExtent[0][i] * fabsf(p.a) + r;
+                r = args.pExtent[1][i] * fabsf(p.b) + r;
+                r = args.pExtent[2][i] * fabsf(p.c) + r;
+            }
+
+            outside |= (d < -r);
+            inside  &= (d >= r);
+        }
+
+        args.pOut[i] = FrustumCullResult(outside, inside);
+        visible += outside ? 0 : 1;
+    }
+    return end;
+}
+
+// 4要素ずつ処理する.
+size_t FrustumCullVector(const FrustumCullArgs& args, size_t begin, size_t end, uint32_t& visible)
+{
+    DirectX::XMVECTOR plane[6][4];
+    DirectX::XMVECTOR absN [6][3];
+    for (auto p = 0; p < 6; ++p)
+    {
+        const float* pPlane = args.Planes[p];
+        for (auto c = 0; c < 4; ++c)
+        { plane[p][c] = DirectX::XMVectorReplicate(pPlane[c]); }
+        for (auto c = 0; c < 3; ++c)
+        { absN[p][c] = DirectX::XMVectorAbs(plane[p][c]); }
+    }
+
+    const auto count   = args.Count;
+    const auto pRadius = args.pRadius;
+    const auto pAxis   = args.pAxis;
+    const auto isBox   = (args.pExtent[0] != nullptr);
+
+    auto i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        auto load = [i](const float* p)
+        { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(p + i)); };
+
+        const auto x = load(args.pCenter[0]);
+        const auto y = load(args.pCenter[1]);
+        const auto z = load(args.pCenter[2]);
+        const auto radius = (pRadius != nullptr) ? load(pRadius) : DirectX::XMVectorZero();
+
+        DirectX::XMVECTOR extent[3] = {};
+        DirectX::XMVECTOR axis[9]   = {};
+        if (isBox)
+        {
+            for (auto k = 0; k < 3; ++k)
+            { extent[k] = load(args.pExtent[k]); }
+        }
+        if (pAxis != nullptr)
+        {
+            for (auto k = 0; k < 9; ++k)
+            { axis[k] = load(pAxis + k * count); }
+        }
+
+        auto outside = DirectX::XMVectorFalseInt();
+        auto inside  = DirectX::XMVectorTrueInt();
+        for (auto p = 0; p < 6; ++p)
+        {
+            auto d = DirectX::XMVectorMultiplyAdd(z, plane[p][2], plane[p][3]);
+            d = DirectX::XMVectorMultiplyAdd(y, plane[p][1], d);
+            d = DirectX::XMVectorMultiplyAdd(x, plane[p][0], d);
+
+            auto r = radius;
+            if (pAxis != nullptr)
+            {
+                for (auto k = 0; k < 3; ++k)
+                {
+                    auto dot = DirectX::XMVectorMultiply(axis[3 * k + 2], plane[p][2]);
+                    dot = DirectX::XMVectorMultiplyAdd(axis[3 * k + 1], plane[p][1], dot);
+                    dot = DirectX::XMVectorMultiplyAdd(axis[3 * k + 0], plane[p][0], dot);
+                    r = DirectX::XMVectorMultiplyAdd(extent[k], DirectX::XMVectorAbs(dot), r);
+                }
+            }
+            else if (isBox)
+            {
+                for (auto k = 0; k < 3; ++k)
+                { r = DirectX::XMVectorMultiplyAdd(extent[k], absN[p][k], r); }
+            }
+
+            outside = DirectX::XMVectorOrInt (outside, DirectX::XMVectorLess(d, DirectX::XMVectorNegate(r)));
+            inside  = DirectX::XMVectorAndInt(inside,  DirectX::XMVectorGreaterOrEqual(d, r));
+        }
+
+        uint32_t outsideMask[4], insideMask[4];
+        DirectX::XMStoreInt4(outsideMask, outside);
+        DirectX::XMStoreInt4(insideMask,  inside);
+        for (auto k = 0; k < 4; ++k)
+        {
+            args.pOut[i + k] = FrustumCullResult(outsideMask[k] != 0, insideMask[k] != 0);
+            visible += (outsideMask[k] != 0) ? 0 : 1;
+        }
+    }
+    return i;
+}
+
+#if defined(_XM_SSE_INTRINSICS_)
+// 8要素ずつ処理する.
+STUB_TARGET("avx2,fma")
+size_t FrustumCullAVX2(const FrustumCullArgs& args, size_t begin, size_t end, uint32_t& visible)
+{
+    __m256 plane[6][4];
+    __m256 absN [6][3];
+    const auto signMask = _mm256_set1_ps(-0.0f);
+    for (auto p = 0; p < 6; ++p)
+    {
+        const float* pPlane = args.Planes[p];
+        for (auto c = 0; c < 4; ++c)
+        { plane[p][c] = _mm256_set1_ps(pPlane[c]); }
+        for (auto c = 0; c < 3; ++c)
+        { absN[p][c] = _mm256_andnot_ps(signMask, plane[p][c]); }
+    }
+
+    const auto count   = args.Count;
+    const auto pRadius = args.pRadius;
+    const auto pAxis   = args.pAxis;
+    const auto isBox   = (args.pExtent[0] != nullptr);
+
+    auto i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        const auto x = _mm256_loadu_ps(args.pCenter[0] + i);
+        const auto y = _mm256_loadu_ps(args.pCenter[1] + i);
+        const auto z = _mm256_loadu_ps(args.pCenter[2] + i);
+        const auto radius = (pRadius != nullptr) ? _mm256_loadu_ps(pRadius + i) : _mm256_setzero_ps();
+
+        __m256 extent[3] = {};
+        __m256 axis[9]   = {};
+        if (isBox)
+        {
+            for (auto k = 0; k < 3; ++k)
+            { extent[k] = _mm256_loadu_ps(args.pExtent[k] + i); }
+        }
+        if (pAxis != nullptr)
+        {
+            for (auto k = 0; k < 9; ++k)
+            { axis[k] = _mm256_loadu_ps(pAxis + k * count + i); }
+        }
+
+        auto outside = _mm256_setzero_ps();
+        auto inside  = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (auto p = 0; p < 6; ++p)
+        {
+            auto d = _mm256_fmadd_ps(z, plane[p][2], plane[p][3]);
+            d = _mm256_fmadd_ps(y, plane[p][1], d);
+            d = _mm256_fmadd_ps(x, plane[p][0], d);
+
+            auto r = radius;
+            if (pAxis != nullptr)
+            {
+                for (auto k = 0; k < 3; ++k)
+                {
+                    auto dot = _mm256_mul_ps(axis[3 * k + 2], plane[p][2]);
+                    dot = _mm256_fmadd_ps(axis[3 * k + 1], plane[p][1], dot);
+                    dot = _mm256_fmadd_ps(axis[3 * k + 0], plane[p][0], dot);
+                    r = _mm256_fmadd_ps(extent[k], _mm256_andnot_ps(signMask, dot), r);
+                }
+            }
+            else if (isBox)
+            {
+                for (auto k = 0; k < 3; ++k)
+                { r = _mm256_fmadd_ps(extent[k], absN[p][k], r); }
+            }
+
+            outside = _mm256_or_ps (outside, _mm256_cmp_ps(d, _mm256_xor_ps(r, signMask), _CMP_LT_OQ));
+            inside  = _mm256_and_ps(inside,  _mm256_cmp_ps(d, r, _CMP_GE_OQ));
+        }
+
+        const auto outsideMask = _mm256_movemask_ps(outside);
+        const auto insideMask  = _mm256_movemask_ps(inside);
+        for (auto k = 0; k < 8; ++k)
+        {
+            const bool isOutside = ((outsideMask >> k) & 1) != 0;
+            args.pOut[i + k] = FrustumCullResult(isOutside, ((insideMask >> k) & 1) != 0);
+            visible += isOutside ? 0 : 1;
+        }
+    }
+    return i;
+}
+#endif//_XM_SSE_INTRINSICS_
+
+FrustumCullFunc SelectFrustumCull()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    const auto& features = GetCpuFeatures();
+    if (features.AVX2 && features.FMA)
+        return FrustumCullAVX2;
+#endif
+    return FrustumCullVector;
+}
+
+// [begin, end) を分類して, 外側でない個数を返す.
+uint32_t FrustumCull(const FrustumCullArgs& args, size_t begin, size_t end)
+{
+    static const auto pKernel = SelectFrustumCull();
+
+    uint32_t visible = 0;
+    auto i = pKernel(args, begin, end, visible);
+    i = FrustumCullVector(args, i, end, visible);
+    FrustumCullScalar(args, i, end, visible);
+    return visible;
+}
+
+uint32_t FrustumCullParallel(const FrustumCullArgs& args, size_t bytesPerElement)
+{
+    // SIMD の端数が出ないようにチャンクを8の倍数にそろえる.
+    std::atomic<uint32_t> visible(0);
+    ParallelFor(args.Count, GetChunkSize(bytesPerElement) & ~size_t(7), [&](size_t begin, size_t end)
+    { visible += FrustumCull(args, begin, end); });
+    return visible;
+}
+
+FrustumCullArgs MakeFrustumCullArgs
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM&  frustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    uint32_t            n
+)
+{
+    FrustumCullArgs args = {};
+    args.pOut       = pOut;
+    args.pCenter[0] = pX;
+    args.pCenter[1] = pY;
+    args.pCenter[2] = pZ;
+    args.Count      = n;
+    for (auto p = 0; p < 6; ++p)
+    { args.Planes[p] = frustum.Planes[p]; }
+    return args;
+}
+
+FrustumCullArgs MakeFrustumCullArgs
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM&  frustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pExtentX,
+    const float*        pExtentY,
+    const float*        pExtentZ,
+    const float*        pAxis,
+    uint32_t            n
+)
+{
+    auto args = MakeFrustumCullArgs(pOut, frustum, pX, pY, pZ, n);
+    args.pExtent[0] = pExtentX;
+    args.pExtent[1] = pExtentY;
+    args.pExtent[2] = pExtentZ;
+    args.pAxis      = pAxis;
+    return args;
+}
+
+} // anonymous namespace
+
+// Extract the frustum planes from a view-projection matrix.
+D3DXFRUSTUM* STUB_API D3DXFrustumFromMatrix(D3DXFRUSTUM *pOut, const D3DXMATRIX *pM)
+{
+    assert(pOut != nullptr);
+    assert(pM   != nullptr);
+
+    // 行ベクトルに掛けるので, クリップ座標の各成分は列との内積になる.
+    const auto m = DirectX::XMMatrixTranspose(LoadMatrix(pM));
+
+    const DirectX::XMVECTOR planes[6] = {
+        DirectX::XMVectorAdd     (m.r[3], m.r[0]),  // left   : -w <= x
+        DirectX::XMVectorSubtract(m.r[3], m.r[0]),  // right  :  x <= w
+        DirectX::XMVectorAdd     (m.r[3], m.r[1]),  // bottom : -w <= y
+        DirectX::XMVectorSubtract(m.r[3], m.r[1]),  // top    :  y <= w
+        m.r[2],                                     // near   :  0 <= z
+        DirectX::XMVectorSubtract(m.r[3], m.r[2]),  // far    :  z <= w
+    };
+
+    for (auto p = 0; p < 6; ++p)
+    { StoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut->Planes[p]), DirectX::XMPlaneNormalize(planes[p])); }
+
+    return pOut;
+}
+
+// Classify spheres against a frustum.
+uint32_t STUB_API D3DXFrustumClassifySpheres
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM*  pFrustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pRadius,
+    uint32_t            n
+)
+{
+    assert(pOut     != nullptr);
+    assert(pFrustum != nullptr);
+    assert(pX       != nullptr);
+    assert(pY       != nullptr);
+    assert(pZ       != nullptr);
+    assert(pRadius  != nullptr);
+
+    auto args = MakeFrustumCullArgs(pOut, *pFrustum, pX, pY, pZ, n);
+    args.pRadius = pRadius;
+    return FrustumCull(args, 0, n);
+}
+
+// Classify axis-aligned boxes against a frustum.
+uint32_t STUB_API D3DXFrustumClassifyAABBs
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM*  pFrustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pExtentX,
+    const float*        pExtentY,
+    const float*        pExtentZ,
+    uint32_t            n
+)
+{
+    assert(pOut     != nullptr);
+    assert(pFrustum != nullptr);
+    assert(pX       != nullptr);
+    assert(pY       != nullptr);
+    assert(pZ       != nullptr);
+    assert(pExtentX != nullptr);
+    assert(pExtentY != nullptr);
+    assert(pExtentZ != nullptr);
+
+    auto args = MakeFrustumCullArgs(pOut, *pFrustum, pX, pY, pZ, pExtentX, pExtentY, pExtentZ, nullptr, n);
+    return FrustumCull(args, 0, n);
+}
+
+// Classify oriented boxes against a frustum.
+uint32_t STUB_API D3DXFrustumClassifyOBBs
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM*  pFrustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pExtentX,
+    const float*        pExtentY,
+    const float*        pExtentZ,
+    const float*        pAxis,
+    uint32_t            n
+)
+{
+    assert(pOut     != nullptr);
+    assert(pFrustum != nullptr);
+    assert(pX       != nullptr);
+    assert(pY       != nullptr);
+    assert(pZ       != nullptr);
+    assert(pExtentX != nullptr);
+    assert(pExtentY != nullptr);
+    assert(pExtentZ != nullptr);
+    assert(pAxis    != nullptr);
+
+    auto args = MakeFrustumCullArgs(pOut, *pFrustum, pX, pY, pZ, pExtentX, pExtentY, pExtentZ, pAxis, n);
+    return FrustumCull(args, 0, n);
+}
+
+uint32_t STUB_API D3DXFrustumClassifySpheresParallel
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM*  pFrustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pRadius,
+    uint32_t            n
+)
+{
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXFrustumClassifySpheres(pOut, pFrustum, pX, pY, pZ, pRadius, n); }
+
+    assert(pOut     != nullptr);
+    assert(pFrustum != nullptr);
+    assert(pX       != nullptr);
+    assert(pY       != nullptr);
+    assert(pZ       != nullptr);
+    assert(pRadius  != nullptr);
+
+    auto args = MakeFrustumCullArgs(pOut, *pFrustum, pX, pY, pZ, n);
+    args.pRadius = pRadius;
+    return FrustumCullParallel(args, sizeof(float) * 4 + sizeof(uint8_t));
+}
+
+uint32_t STUB_API D3DXFrustumClassifyAABBsParallel
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM*  pFrustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pExtentX,
+    const float*        pExtentY,
+    const float*        pExtentZ,
+    uint32_t            n
+)
+{
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXFrustumClassifyAABBs(pOut, pFrustum, pX, pY, pZ, pExtentX, pExtentY, pExtentZ, n); }
+
+    assert(pOut     != nullptr);
+    assert(pFrustum != nullptr);
+    assert(pX       != nullptr);
+    assert(pY       != nullptr);
+    assert(pZ       != nullptr);
+    assert(pExtentX != nullptr);
+    assert(pExtentY != nullptr);
+    assert(pExtentZ != nullptr);
+
+    auto args = MakeFrustumCullArgs(pOut, *pFrustum, pX, pY, pZ, pExtentX, pExtentY, pExtentZ, nullptr, n);
+    return FrustumCullParallel(args, sizeof(float) * 6 + sizeof(uint8_t));
+}
+
+uint32_t STUB_API D3DXFrustumClassifyOBBsParallel
+(
+    uint8_t*            pOut,
+    const D3DXFRUSTUM*  pFrustum,
+    const float*        pX,
+    const float*        pY,
+    const float*        pZ,
+    const float*        pExtentX,
+    const float*        pExtentY,
+    const float*        pExtentZ,
+    const float*        pAxis,
+    uint32_t            n
+)
+{
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXFrustumClassifyOBBs(pOut, pFrustum, pX, pY, pZ, pExtentX, pExtentY, pExtentZ, pAxis, n); }
+
+    assert(pOut     != nullptr);
+    assert(pFrustum != nullptr);
+    assert(pX       != nullptr);
+    assert(pY       != nullptr);
+    assert(pZ       != nullptr);
+    assert(pExtentX != nullptr);
+    assert(pExtentY != nullptr);
+    assert(pExtentZ != nullptr);
+    assert(pAxis    != nullptr);
+
+    auto args = MakeFrustumCullArgs(pOut, *pFrustum, pX, pY, pZ, pExtentX, pExtentY, pExtentZ, pAxis, n);
+    return FrustumCullParallel(args, sizeof(float) * 15 + sizeof(uint8_t));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bounding volumes
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+// 部分結果を求める頂点数. 4の倍数にして SIMD の端数を最後のブロックだけにする.
+const size_t kBoundsBlockSize = 4096;
+
+// 外側の頂点を含むように球を広げる回数の上限. 超えた場合は最も遠い頂点までの距離を半径にする.
+const int kSphereGrowIterations = 32;
+
+// ストライド付きの位置ストリーム.
+struct BoundsStream
+{
+    const D3DXVECTOR3*  pFirst;
+    uint32_t            Stride;
+    size_t              Count;
+    bool                Parallel;
+
+    DirectX::XMVECTOR Load(size_t i) const
+    { return DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(OffsetPtr(pFirst, i * Stride))); }
+
+    // 4頂点を x, y, z のレーンに並べる. end 以降は最後の頂点で埋める.
+    void LoadLanes(size_t i, size_t end, DirectX::XMVECTOR p[3]) const
+    {
+        const auto m = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(
+            Load(i),
+            Load((i + 1 < end) ? i + 1 : end - 1),
+            Load((i + 2 < end) ? i + 2 : end - 1),
+            Load((i + 3 < end) ? i + 3 : end - 1)));
+        p[0] = m.r[0];
+        p[1] = m.r[1];
+        p[2] = m.r[2];
+    }
+};
+
+// [0, count) をスレッド数によらない固定のブロックに分け, ブロックごとの部分結果を求める.
+template<typename T, typename Func>
+std::vector<T> ReduceBlocks(size_t count, bool parallel, Func func)
+{
+    const size_t blockCount = (count + kBoundsBlockSize - 1) / kBoundsBlockSize;
+
+    std::vector<T> partials(blockCount);
+    auto reduceBlocks = [&](size_t begin, size_t end)
+    {
+        for (auto b = begin; b < end; ++b)
+        {
+            const auto blockEnd = (b + 1) * kBoundsBlockSize;
+            partials[b] = func(b * kBoundsBlockSize, (blockEnd < count) ? blockEnd : count);
+        }
+    };
+
+    if (parallel && count >= D3DX_PARALLEL_THRESHOLD)
+    { ParallelFor(blockCount, 1, reduceBlocks); }
+    else
+    { reduceBlocks(0, blockCount); }
+
+    return partials;
+}
+
+template<typename T, typename Func>
+std::vector<T> ReduceBoundsBlocks(const BoundsStream& src, Func func)
+{ return ReduceBlocks<T>(src.Count, src.Parallel, func); }
+
+struct BoundsBox
+{
+    DirectX::XMFLOAT3   Min;
+    DirectX::XMFLOAT3   Max;
+};
+
+// 4頂点ずつ読み込んで成分ごとの最小値と最大値を求める.
+BoundsBox ComputeBoxBlock(const BoundsStream& src, size_t begin, size_t end)
+{
+    using namespace DirectX;
+
+    auto lower = src.Load(begin);
+    auto upper = lower;
+
+    auto i = begin + 1;
+    for (; i + 4 <= end; i += 4)
+    {
+        const auto p0 = src.Load(i + 0);
+        const auto p1 = src.Load(i + 1);
+        const auto p2 = src.Load(i + 2);
+        const auto p3 = src.Load(i + 3);
+        lower = XMVectorMin(lower, XMVectorMin(XMVectorMin(p0, p1), XMVectorMin(p2, p3)));
+        upper = XMVectorMax(upper, XMVectorMax(XMVectorMax(p0, p1), XMVectorMax(p2, p3)));
+    }
+    for (; i < end; ++i)
+    {
+        const auto p = src.Load(i);
+        lower = XMVectorMin(lower, p);
+        upper = XMVectorMax(upper, p);
+    }
+
+    BoundsBox result;
+    XMStoreFloat3(&result.Min, lower);
+    XMStoreFloat3(&result.Max, upper);
+    return result;
+}
+
+// 各ブロックの先頭の頂点からの差を単精度で足し合わせ, ブロックの和を倍精度で足し合わせる.
+// 原点から離れたメッシュでも桁落ちしにくい.
+DirectX::XMFLOAT3 EvalCentroid(const BoundsStream& src)
+{
+    using namespace DirectX;
+
+    struct Sum
+    {
+        double  Value[3];
+    };
+
+    const auto partials = ReduceBoundsBlocks<Sum>(src, [&](size_t begin, size_t end)
+    {
+        const auto origin = src.Load(begin);
+
+        XMVECTOR acc[4] = { XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero() };
+        auto i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            for (auto k = 0; k < 4; ++k)
+            { acc[k] = XMVectorAdd(acc[k], XMVectorSubtract(src.Load(i + k), origin)); }
+        }
+        for (; i < end; ++i)
+        { acc[0] = XMVectorAdd(acc[0], XMVectorSubtract(src.Load(i), origin)); }
+
+        XMFLOAT3 o, d;
+        XMStoreFloat3(&o, origin);
+        XMStoreFloat3(&d, XMVectorAdd(XMVectorAdd(acc[0], acc[1]), XMVectorAdd(acc[2], acc[3])));
+
+        const auto count = double(end - begin);
+        return Sum{ { o.x * count + d.x, o.y * count + d.y, o.z * count + d.z } };
+    });
+
+    double sum[3] = {};
+    for (const auto& partial : partials)
+    {
+        for (auto c = 0; c < 3; ++c)
+        { sum[c] += partial.Value[c]; }
+    }
+
+    const auto inv = 1.0 / double(src.Count);
+    return XMFLOAT3(float(sum[0] * inv), float(sum[1] * inv), float(sum[2] * inv));
+}
+
+// 評価値が最大の頂点. 同じ値の場合は番号の小さい頂点を選ぶ.
+struct BoundsExtreme
+{
+    float   Value;
+    size_t  Index;
+};
+
+// 全頂点で eval(p, values) の N 個の値それぞれが最大になる頂点を求める.
+// p は4頂点の x, y, z のレーン. 頂点をレーンごとに走査し, 最後にレーン間で比べる.
+template<size_t N, typename Eval>
+void FindExtremes(const BoundsStream& src, Eval eval, BoundsExtreme* pOut)
+{
+    using namespace DirectX;
+
+    struct Partial
+    {
+        BoundsExtreme   Extreme[N];
+    };
+
+    const auto partials = ReduceBoundsBlocks<Partial>(src, [&](size_t begin, size_t end)
+    {
+        XMVECTOR best [N];
+        XMVECTOR index[N];
+        for (size_t j = 0; j < N; ++j)
+        {
+            best [j] = XMVectorReplicate(-INFINITY);
+            index[j] = XMVectorReplicateInt(uint32_t(begin));
+        }
+
+        XMVECTOR p[3];
+        XMVECTOR values[N];
+        for (auto i = begin; i < end; i += 4)
+        {
+            src.LoadLanes(i, end, p);
+            eval(p, values);
+
+            const auto base = XMVectorReplicateInt(uint32_t(i));
+            for (size_t j = 0; j < N; ++j)
+            {
+                const auto greater = XMVectorGreater(values[j], best[j]);
+                best [j] = XMVectorSelect(best[j], values[j], greater);
+                index[j] = XMVectorSelect(index[j], base, greater);
+            }
+        }
+
+        // レーン k の頂点番号は base + k. 端数の埋め草は最後の頂点と同じ値なので最後の頂点とする.
+        Partial result;
+        for (size_t j = 0; j < N; ++j)
+        {
+            float    value[4];
+            uint32_t base [4];
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(value), best[j]);
+            XMStoreInt4(base, index[j]);
+
+            auto& e = result.Extreme[j];
+            e = { -INFINITY, begin };
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                const auto i = std::min<size_t>(size_t(base[k]) + k, end - 1);
+                if (value[k] > e.Value || (value[k] == e.Value && i < e.Index))
+                { e = { value[k], i }; }
+            }
+        }
+        return result;
+    });
+
+    for (size_t j = 0; j < N; ++j)
+    {
+        pOut[j] = partials[0].Extreme[j];
+        for (size_t b = 1; b < partials.size(); ++b)
+        {
+            if (partials[b].Extreme[j].Value > pOut[j].Value)
+            { pOut[j] = partials[b].Extreme[j]; }
+        }
+    }
+}
+
+// center から最も遠い頂点.
+BoundsExtreme FindFarthest(const BoundsStream& src, const DirectX::XMFLOAT3& center)
+{
+    using namespace DirectX;
+
+    const XMVECTOR c[3] = { XMVectorReplicate(center.x), XMVectorReplicate(center.y), XMVectorReplicate(center.z) };
+
+    BoundsExtreme result;
+    FindExtremes<1>(src, [&](const XMVECTOR p[3], XMVECTOR* pValues)
+    {
+        const auto dx = XMVectorSubtract(p[0], c[0]);
+        const auto dy = XMVectorSubtract(p[1], c[1]);
+        const auto dz = XMVectorSubtract(p[2], c[2]);
+        pValues[0] = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+    }, &result);
+    return result;
+}
+
+// 最も遠い頂点が外側にある間, その頂点と元の球を含む最小の球に広げる.
+void GrowBoundingSphere(const BoundsStream& src, DirectX::XMFLOAT3& center, float& radius)
+{
+    for (auto iteration = 0;; ++iteration)
+    {
+        const auto farthest = FindFarthest(src, center);
+        const auto distance = sqrtf(farthest.Value);
+        if (distance <= radius)
+            break;
+
+        if (iteration == kSphereGrowIterations)
+        {
+            radius = distance;
+            break;
+        }
+
+        const auto p     = src.Load(farthest.Index);
+        const auto c     = DirectX::XMLoadFloat3(&center);
+        const auto newR  = (radius + distance) * 0.5f;
+        const auto shift = (newR - radius) / distance;
+        DirectX::XMStoreFloat3(&center, DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSubtract(p, c), DirectX::XMVectorReplicate(shift), c));
+        radius = newR;
+    }
+}
+
+// 倍精度の球. 半径は2乗で持つ.
+struct BoundsSphere
+{
+    double  Center[3];
+    double  RadiusSq;
+};
+
+inline double DistanceSq(const double a[3], const double b[3])
+{ return (a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]); }
+
+inline void Cross(const double a[3], const double b[3], double out[3])
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline double Dot(const double a[3], const double b[3])
+{ return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+// 2点, 3点, 4点を通る最小の球. 3点が同一直線上, 4点が同一平面上の場合は false を返す.
+bool SphereThrough(const double (*p)[3], int count, BoundsSphere& out)
+{
+    const double* a = p[0];
+    double u[3], v[3], w[3];
+    for (auto c = 0; c < 3; ++c)
+    {
+        u[c] = p[1][c] - a[c];
+        v[c] = (count > 2) ? p[2][c] - a[c] : 0.0;
+        w[c] = (count > 3) ? p[3][c] - a[c] : 0.0;
+    }
+
+    double offset[3];
+    if (count == 2)
+    {
+        for (auto c = 0; c < 3; ++c)
+        { offset[c] = u[c] * 0.5; }
+    }
+    else if (count == 3)
+    {
+        // 外心 a + ((|v|^2 u - |u|^2 v) x (u x v)) / (2 |u x v|^2).
+        double n[3], t[3];
+        Cross(u, v, n);
+        const auto nn = Dot(n, n);
+        if (nn <= 1e-12 * Dot(u, u) * Dot(v, v))
+            return false;
+
+        const auto uu = Dot(u, u);
+        const auto vv = Dot(v, v);
+        for (auto c = 0; c < 3; ++c)
+        { t[c] = vv * u[c] - uu * v[c]; }
+        Cross(t, n, offset);
+        for (auto c = 0; c < 3; ++c)
+        { offset[c] /= 2.0 * nn; }
+    }
+    else
+    {
+        // 外接球 a + (|u|^2 (v x w) + |v|^2 (w x u) + |w|^2 (u x v)) / (2 u・(v x w)).
+        double vw[3], wu[3], uv[3];
+        Cross(v, w, vw);
+        Cross(w, u, wu);
+        Cross(u, v, uv);
+        const auto det = Dot(u, vw);
+        if (fabs(det) <= 1e-9 * sqrt(Dot(u, u) * Dot(v, v) * Dot(w, w)))
+            return false;
+
+        const auto uu = Dot(u, u);
+        const auto vv = Dot(v, v);
+        const auto ww = Dot(w, w);
+        for (auto c = 0; c < 3; ++c)
+        { offset[c] = (uu * vw[c] + vv * wu[c] + ww * uv[c]) / (2.0 * det); }
+    }
+
+    for (auto c = 0; c < 3; ++c)
+    { out.Center[c] = a[c] + offset[c]; }
+    out.RadiusSq = Dot(offset, offset);
+    return true;
+}
+
+// 少数の点を含む最小の球. 2点から4点を通る球を全て試して, 全点を含む最小のものを選ぶ.
+BoundsSphere MinimumSphere(const double (*p)[3], int count)
+{
+    BoundsSphere best = { { p[0][0], p[0][1], p[0][2] }, 0.0 };
+    bool found = (count == 1);
+
+    auto test = [&](std::initializer_list<int> indices)
+    {
+        double support[4][3];
+        int n = 0;
+        for (auto i : indices)
+        {
+            for (auto c = 0; c < 3; ++c)
+            { support[n][c] = p[i][c]; }
+            n++;
+        }
+
+        BoundsSphere sphere;
+        if (!SphereThrough(support, n, sphere) || (found && sphere.RadiusSq >= best.RadiusSq))
+            return;
+
+        const auto limit = sphere.RadiusSq * (1.0 + 1e-9);
+        for (auto i = 0; i < count; ++i)
+        {
+            if (DistanceSq(p[i], sphere.Center) > limit)
+                return;
+        }
+        best  = sphere;
+        found = true;
+    };
+
+    for (auto i = 0; i < count; ++i)
+    for (auto j = i + 1; j < count; ++j)
+    {
+        test({ i, j });
+        for (auto k = j + 1; k < count; ++k)
+        {
+            test({ i, j, k });
+            for (auto l = k + 1; l < count; ++l)
+            { test({ i, j, k, l }); }
+        }
+    }
+    return best;
+}
+
+// EPOS-14 の方向. 座標軸と立方体の対角線.
+const float kEPOSDirections[7][3] = {
+    { 1.0f,  0.0f,  0.0f },
+    { 0.0f,  1.0f,  0.0f },
+    { 0.0f,  0.0f,  1.0f },
+    { 1.0f,  1.0f,  1.0f },
+    { 1.0f,  1.0f, -1.0f },
+    { 1.0f, -1.0f,  1.0f },
+    { 1.0f, -1.0f, -1.0f },
+};
+
+void EvalBoundingSphere(const BoundsStream& src, D3DXSPHEREMETHOD method, DirectX::XMFLOAT3& center, float& radius)
+{
+    using namespace DirectX;
+
+    switch (method)
+    {
+    case D3DXSPHERE_CENTROID:
+        center = EvalCentroid(src);
+        radius = sqrtf(FindFarthest(src, center).Value);
+        return;
+
+    case D3DXSPHERE_RITTER:
+        {
+            // 先頭の頂点から最も遠い頂点 y, y から最も遠い頂点 z を直径とする球から始める.
+            XMFLOAT3 x, y, z;
+            XMStoreFloat3(&x, src.Load(0));
+            XMStoreFloat3(&y, src.Load(FindFarthest(src, x).Index));
+            XMStoreFloat3(&z, src.Load(FindFarthest(src, y).Index));
+
+            const auto a = XMLoadFloat3(&y);
+            const auto b = XMLoadFloat3(&z);
+            XMStoreFloat3(&center, XMVectorScale(XMVectorAdd(a, b), 0.5f));
+            radius = XMVectorGetX(XMVector3Length(XMVectorSubtract(b, a))) * 0.5f;
+        }
+        break;
+
+    case D3DXSPHERE_EPOS:
+        {
+            // 各方向への射影の最大値と最小値 (符号を反転した射影の最大値) をとる頂点.
+            XMVECTOR dir[7][3];
+            for (auto d = 0; d < 7; ++d)
+            for (auto c = 0; c < 3; ++c)
+            { dir[d][c] = XMVectorReplicate(kEPOSDirections[d][c]); }
+
+            BoundsExtreme extremes[14];
+            FindExtremes<14>(src, [&](const XMVECTOR p[3], XMVECTOR* pValues)
+            {
+                for (auto d = 0; d < 7; ++d)
+                {
+                    const auto proj = XMVectorMultiplyAdd(p[0], dir[d][0], XMVectorMultiplyAdd(p[1], dir[d][1], XMVectorMultiply(p[2], dir[d][2])));
+                    pValues[2 * d + 0] = proj;
+                    pValues[2 * d + 1] = XMVectorNegate(proj);
+                }
+            }, extremes);
+
+            double points[14][3];
+            for (auto e = 0; e < 14; ++e)
+            {
+                XMFLOAT3 p;
+                XMStoreFloat3(&p, src.Load(extremes[e].Index));
+                points[e][0] = p.x;
+                points[e][1] = p.y;
+                points[e][2] = p.z;
+            }
+
+            const auto sphere = MinimumSphere(points, 14);
+            center = XMFLOAT3(float(sphere.Center[0]), float(sphere.Center[1]), float(sphere.Center[2]));
+            radius = float(sqrt(sphere.RadiusSq));
+        }
+        break;
+    }
+
+    GrowBoundingSphere(src, center, radius);
+}
+
+inline bool IsValidBoundsStream(const D3DXVECTOR3* pFirstPosition, uint32_t numVertices)
+{ return pFirstPosition != nullptr && numVertices > 0; }
+
+HRESULT ComputeBoundingBox(const BoundsStream& src, D3DXVECTOR3* pMin, D3DXVECTOR3* pMax)
+{
+    if (!IsValidBoundsStream(src.pFirst, uint32_t(src.Count)) || !pMin || !pMax)
+        return kD3DERR_INVALIDCALL;
+
+    const auto partials = ReduceBoundsBlocks<BoundsBox>(src, [&](size_t begin, size_t end)
+    { return ComputeBoxBlock(src, begin, end); });
+
+    auto lower = DirectX::XMLoadFloat3(&partials[0].Min);
+    auto upper = DirectX::XMLoadFloat3(&partials[0].Max);
+    for (size_t b = 1; b < partials.size(); ++b)
+    {
+        lower = DirectX::XMVectorMin(lower, DirectX::XMLoadFloat3(&partials[b].Min));
+        upper = DirectX::XMVectorMax(upper, DirectX::XMLoadFloat3(&partials[b].Max));
+    }
+
+    DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(pMin), lower);
+    DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(pMax), upper);
+    return kD3D_OK;
+}
+
+HRESULT ComputeCentroid(const BoundsStream& src, D3DXVECTOR3* pCentroid)
+{
+    if (!IsValidBoundsStream(src.pFirst, uint32_t(src.Count)) || !pCentroid)
+        return kD3DERR_INVALIDCALL;
+
+    const auto centroid = EvalCentroid(src);
+    *pCentroid = D3DXVECTOR3(centroid.x, centroid.y, centroid.z);
+    return kD3D_OK;
+}
+
+HRESULT ComputeBoundingSphere(const BoundsStream& src, D3DXSPHEREMETHOD method, D3DXVECTOR3* pCenter, float* pRadius)
+{
+    if (!IsValidBoundsStream(src.pFirst, uint32_t(src.Count)) || !pCenter || !pRadius)
+        return kD3DERR_INVALIDCALL;
+
+    if (method != D3DXSPHERE_CENTROID && method != D3DXSPHERE_RITTER && method != D3DXSPHERE_EPOS)
+        return kD3DERR_INVALIDCALL;
+
+    DirectX::XMFLOAT3 center;
+    EvalBoundingSphere(src, method, center, *pRadius);
+    *pCenter = D3DXVECTOR3(center.x, center.y, center.z);
+    return kD3D_OK;
+}
+
+} // anonymous namespace
+
+HRESULT STUB_API D3DXComputeBoundingBox
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXVECTOR3*        pMin,
+    D3DXVECTOR3*        pMax
+)
+{ return ComputeBoundingBox({ pFirstPosition, dwStride, NumVertices, false }, pMin, pMax); }
+
+HRESULT STUB_API D3DXComputeCentroid
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXVECTOR3*        pCentroid
+)
+{ return ComputeCentroid({ pFirstPosition, dwStride, NumVertices, false }, pCentroid); }
+
+HRESULT STUB_API D3DXComputeBoundingSphere
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXVECTOR3*        pCenter,
+    float*              pRadius
+)
+{ return ComputeBoundingSphere({ pFirstPosition, dwStride, NumVertices, false }, D3DXSPHERE_CENTROID, pCenter, pRadius); }
+
+HRESULT STUB_API D3DXComputeBoundingSphereEx
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXSPHEREMETHOD    Method,
+    D3DXVECTOR3*        pCenter,
+    float*              pRadius
+)
+{ return ComputeBoundingSphere({ pFirstPosition, dwStride, NumVertices, false }, Method, pCenter, pRadius); }
+
+HRESULT STUB_API D3DXComputeBoundingBoxParallel
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXVECTOR3*        pMin,
+    D3DXVECTOR3*        pMax
+)
+{ return ComputeBoundingBox({ pFirstPosition, dwStride, NumVertices, true }, pMin, pMax); }
+
+HRESULT STUB_API D3DXComputeCentroidParallel
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXVECTOR3*        pCentroid
+)
+{ return ComputeCentroid({ pFirstPosition, dwStride, NumVertices, true }, pCentroid); }
+
+HRESULT STUB_API D3DXComputeBoundingSphereParallel
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXVECTOR3*        pCenter,
+    float*              pRadius
+)
+{ return ComputeBoundingSphere({ pFirstPosition, dwStride, NumVertices, true }, D3DXSPHERE_CENTROID, pCenter, pRadius); }
+
+HRESULT STUB_API D3DXComputeBoundingSphereExParallel
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    D3DXSPHEREMETHOD    Method,
+    D3DXVECTOR3*        pCenter,
+    float*              pRadius
+)
+{ return ComputeBoundingSphere({ pFirstPosition, dwStride, NumVertices, true }, Method, pCenter, pRadius); }
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Ray intersection
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+// 1パケットの float 数. V0, Edge1, Edge2 がそれぞれ3成分 x 幅の配列になる.
+inline size_t TrianglePacketSize(size_t width)
+{ return 9 * width; }
+
+// Möller–Trumbore 法で光線と三角形の交差を判定する.
+// ベクトル版と同じ演算順で計算し, FMA も使わないので全ての実装で同じ結果になる.
+// det == 0 (平行または縮退した三角形) と, 距離が [0, maxDist) に無い場合は交差しない.
+inline bool IntersectTriScalar
+(
+    const float*    pos,
+    const float*    dir,
+    const float*    v0,
+    const float*    e1,
+    const float*    e2,
+    float           maxDist,
+    float&          u,
+    float&          v,
+    float&          t
+)
+{
+    const float p[3] = {
+        dir[1] * e2[2] - dir[2] * e2[1],
+        dir[2] * e2[0] - dir[0] * e2[2],
+        dir[0] * e2[1] - dir[1] * e2[0],
+    };
+    const float det = (e1[0] * p[0] + e1[1] * p[1]) + e1[2] * p[2];
+    const float inv = 1.0f / det;
+
+    const float s[3] = { pos[0] - v0[0], pos[1] - v0[1], pos[2] - v0[2] };
+    const float q[3] = {
+        s[1] * e1[2] - s[2] * e1[1],
+        s[2] * e1[0] - s[0] * e1[2],
+        s[0] * e1[1] - s[1] * e1[0],
+    };
+
+    u = ((s[0]   * p[0] + s[1]   * p[1]) + s[2]   * p[2]) * inv;
+    v = ((dir[0] * q[0] + dir[1] * q[1]) + dir[2] * q[2]) * inv;
+    t = ((e2[0]  * q[0] + e2[1]  * q[1]) + e2[2]  * q[2]) * inv;
+
+    return (fabsf(det) > 0.0f) && (u >= 0.0f) && (v >= 0.0f) && (u + v <= 1.0f) && (t >= 0.0f) && (t < maxDist);
+}
+
+inline DirectX::XMVECTOR DotLanes(const DirectX::XMVECTOR a[3], const DirectX::XMVECTOR b[3])
+{
+    using namespace DirectX;
+    return XMVectorAdd(XMVectorAdd(XMVectorMultiply(a[0], b[0]), XMVectorMultiply(a[1], b[1])), XMVectorMultiply(a[2], b[2]));
+}
+
+inline void CrossLanes(DirectX::XMVECTOR out[3], const DirectX::XMVECTOR a[3], const DirectX::XMVECTOR b[3])
+{
+    using namespace DirectX;
+    out[0] = XMVectorSubtract(XMVectorMultiply(a[1], b[2]), XMVectorMultiply(a[2], b[1]));
+    out[1] = XMVectorSubtract(XMVectorMultiply(a[2], b[0]), XMVectorMultiply(a[0], b[2]));
+    out[2] = XMVectorSubtract(XMVectorMultiply(a[0], b[1]), XMVectorMultiply(a[1], b[0]));
+}
+
+// 4レーン分の三角形.
+struct TriangleLanes
+{
+    DirectX::XMVECTOR   V0   [3];
+    DirectX::XMVECTOR   Edge1[3];
+    DirectX::XMVECTOR   Edge2[3];
+};
+
+// 幅 width のパケットのレーン [lane, lane + 4) を読み込む.
+inline TriangleLanes LoadTriangleLanes(const float* pPacket, size_t width, size_t lane)
+{
+    auto load = [&](size_t row)
+    { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pPacket + row * width + lane)); };
+
+    TriangleLanes result;
+    for (auto c = 0; c < 3; ++c)
+    {
+        result.V0   [c] = load(c);
+        result.Edge1[c] = load(3 + c);
+        result.Edge2[c] = load(6 + c);
+    }
+    return result;
+}
+
+// IntersectTriScalar の4レーン版. 交差したレーンが全ビット1のマスクを返す.
+inline DirectX::XMVECTOR IntersectTriLanes
+(
+    const DirectX::XMVECTOR pos[3],
+    const DirectX::XMVECTOR dir[3],
+    const TriangleLanes&    tri,
+    DirectX::FXMVECTOR      maxDist,
+    DirectX::XMVECTOR&      u,
+    DirectX::XMVECTOR&      v,
+    DirectX::XMVECTOR&      t
+)
+{
+    using namespace DirectX;
+
+    XMVECTOR p[3];
+    CrossLanes(p, dir, tri.Edge2);
+    const auto det = DotLanes(tri.Edge1, p);
+    const auto inv = XMVectorDivide(XMVectorSplatOne(), det);
+
+    const XMVECTOR s[3] = {
+        XMVectorSubtract(pos[0], tri.V0[0]),
+        XMVectorSubtract(pos[1], tri.V0[1]),
+        XMVectorSubtract(pos[2], tri.V0[2]),
+    };
+    XMVECTOR q[3];
+    CrossLanes(q, s, tri.Edge1);
+
+    u = XMVectorMultiply(DotLanes(s, p), inv);
+    v = XMVectorMultiply(DotLanes(dir, q), inv);
+    t = XMVectorMultiply(DotLanes(tri.Edge2, q), inv);
+
+    const auto zero = XMVectorZero();
+    auto mask = XMVectorGreater(XMVectorAbs(det), zero);
+    mask = XMVectorAndInt(mask, XMVectorGreaterOrEqual(u, zero));
+    mask = XMVectorAndInt(mask, XMVectorGreaterOrEqual(v, zero));
+    mask = XMVectorAndInt(mask, XMVectorLessOrEqual(XMVectorAdd(u, v), XMVectorSplatOne()));
+    mask = XMVectorAndInt(mask, XMVectorGreaterOrEqual(t, zero));
+    return XMVectorAndInt(mask, XMVectorLess(t, maxDist));
+}
+
+// レーンごとの最も近い交差から全体で最も近いものを選ぶ. 距離が等しい場合は面番号が小さい方を選ぶ.
+// pFace[k] はレーン k の面番号. 交差が無いレーンの距離は hit.Dist のままになっている.
+bool SelectNearestLane
+(
+    const float*        pDist,
+    const float*        pU,
+    const float*        pV,
+    const uint32_t*     pFace,
+    size_t              lanes,
+    D3DXINTERSECTINFO&  hit
+)
+{
+    const float maxDist = hit.Dist;
+
+    size_t best = lanes;
+    for (size_t k = 0; k < lanes; ++k)
+    {
+        if (!(pDist[k] < maxDist))
+            continue;
+
+        if (best == lanes || pDist[k] < pDist[best] || (pDist[k] == pDist[best] && pFace[k] < pFace[best]))
+        { best = k; }
+    }
+
+    if (best == lanes)
+        return false;
+
+    hit.FaceIndex = pFace[best];
+    hit.U         = pU[best];
+    hit.V         = pV[best];
+    hit.Dist      = pDist[best];
+    return true;
+}
+
+using IntersectTriPacketsFunc = bool (*)(
+    const float* pPackets, size_t width, size_t count, const float* pos, const float* dir, D3DXINTERSECTINFO& hit);
+
+// 光線を全レーンに複製し, 4レーンずつ判定する. 幅8のパケットは半分ずつ処理する.
+bool IntersectTriPacketsVector
+(
+    const float*        pPackets,
+    size_t              width,
+    size_t              count,
+    const float*        pos,
+    const float*        dir,
+    D3DXINTERSECTINFO&  hit
+)
+{
+    using namespace DirectX;
+
+    const XMVECTOR P[3] = { XMVectorReplicate(pos[0]), XMVectorReplicate(pos[1]), XMVectorReplicate(pos[2]) };
+    const XMVECTOR D[3] = { XMVectorReplicate(dir[0]), XMVectorReplicate(dir[1]), XMVectorReplicate(dir[2]) };
+
+    // レーンごとに最も近い交差を保持する. 面番号はレーン番号を除いた先頭の番号を持つ.
+    auto bestT    = XMVectorReplicate(hit.Dist);
+    auto bestU    = XMVectorZero();
+    auto bestV    = XMVectorZero();
+    auto bestBase = XMVectorZero();
+
+    const auto packetSize = TrianglePacketSize(width);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto pPacket = pPackets + i * packetSize;
+        for (size_t lane = 0; lane < width; lane += 4)
+        {
+            XMVECTOR u, v, t;
+            const auto mask = IntersectTriLanes(P, D, LoadTriangleLanes(pPacket, width, lane), bestT, u, v, t);
+
+            bestT    = XMVectorSelect(bestT, t, mask);
+            bestU    = XMVectorSelect(bestU, u, mask);
+            bestV    = XMVectorSelect(bestV, v, mask);
+            bestBase = XMVectorSelect(bestBase, XMVectorReplicateInt(uint32_t(i * width + lane)), mask);
+        }
+    }
+
+    XMFLOAT4 dist, u, v;
+    uint32_t face[4];
+    XMStoreFloat4(&dist, bestT);
+    XMStoreFloat4(&u, bestU);
+    XMStoreFloat4(&v, bestV);
+    XMStoreInt4(face, bestBase);
+    for (uint32_t k = 0; k < 4; ++k)
+    { face[k] += k; }
+
+    return SelectNearestLane(&dist.x, &u.x, &v.x, face, 4, hit);
+}
+
+#if defined(_XM_SSE_INTRINSICS_)
+STUB_TARGET("avx2")
+inline __m256 DotLanesAVX2(const __m256 a[3], const __m256 b[3])
+{ return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[0], b[0]), _mm256_mul_ps(a[1], b[1])), _mm256_mul_ps(a[2], b[2])); }
+
+STUB_TARGET("avx2")
+inline void CrossLanesAVX2(__m256 out[3], const __m256 a[3], const __m256 b[3])
+{
+    out[0] = _mm256_sub_ps(_mm256_mul_ps(a[1], b[2]), _mm256_mul_ps(a[2], b[1]));
+    out[1] = _mm256_sub_ps(_mm256_mul_ps(a[2], b[0]), _mm256_mul_ps(a[0], b[2]));
+    out[2] = _mm256_sub_ps(_mm256_mul_ps(a[0], b[1]), _mm256_mul_ps(a[1], b[0]));
+}
+
+// IntersectTriScalar の8レーン版.
+STUB_TARGET("avx2")
+inline __m256 IntersectTriLanesAVX2
+(
+    const __m256    P[3],
+    const __m256    D[3],
+    const __m256    V0[3],
+    const __m256    E1[3],
+    const __m256    E2[3],
+    __m256          maxDist,
+    __m256&         u,
+    __m256&         v,
+    __m256&         t
+)
+{
+    const auto zero     = _mm256_setzero_ps();
+    const auto one      = _mm256_set1_ps(1.0f);
+    const auto signMask = _mm256_set1_ps(-0.0f);
+
+    __m256 p[3];
+    CrossLanesAVX2(p, D, E2);
+    const auto det = DotLanesAVX2(E1, p);
+    const auto inv = _mm256_div_ps(one, det);
+
+    const __m256 s[3] = { _mm256_sub_ps(P[0], V0[0]), _mm256_sub_ps(P[1], V0[1]), _mm256_sub_ps(P[2], V0[2]) };
+    __m256 q[3];
+    CrossLanesAVX2(q, s, E1);
+
+    u = _mm256_mul_ps(DotLanesAVX2(s, p), inv);
+    v = _mm256_mul_ps(DotLanesAVX2(D, q), inv);
+    t = _mm256_mul_ps(DotLanesAVX2(E2, q), inv);
+
+    auto mask = _mm256_cmp_ps(_mm256_andnot_ps(signMask, det), zero, _CMP_GT_OQ);
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+    return _mm256_and_ps(mask, _mm256_cmp_ps(t, maxDist, _CMP_LT_OQ));
+}
+
+// 8レーンずつ判定する. 幅8のパケット専用.
+STUB_TARGET("avx2")
+bool IntersectTriPacketsAVX2
+(
+    const float*        pPackets,
+    size_t              width,
+    size_t              count,
+    const float*        pos,
+    const float*        dir,
+    D3DXINTERSECTINFO&  hit
+)
+{
+    assert(width == 8);
+
+    const __m256 P[3] = { _mm256_set1_ps(pos[0]), _mm256_set1_ps(pos[1]), _mm256_set1_ps(pos[2]) };
+    const __m256 D[3] = { _mm256_set1_ps(dir[0]), _mm256_set1_ps(dir[1]), _mm256_set1_ps(dir[2]) };
+
+    auto bestT    = _mm256_set1_ps(hit.Dist);
+    auto bestU    = _mm256_setzero_ps();
+    auto bestV    = _mm256_setzero_ps();
+    auto bestBase = _mm256_setzero_ps();
+
+    const auto packetSize = TrianglePacketSize(width);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto pPacket = pPackets + i * packetSize;
+
+        __m256 V0[3], E1[3], E2[3];
+        for (auto c = 0; c < 3; ++c)
+        {
+            V0[c] = _mm256_loadu_ps(pPacket + c * 8);
+            E1[c] = _mm256_loadu_ps(pPacket + (3 + c) * 8);
+            E2[c] = _mm256_loadu_ps(pPacket + (6 + c) * 8);
+        }
+
+        __m256 u, v, t;
+        const auto mask = IntersectTriLanesAVX2(P, D, V0, E1, E2, bestT, u, v, t);
+
+        bestT    = _mm256_blendv_ps(bestT, t, mask);
+        bestU    = _mm256_blendv_ps(bestU, u, mask);
+        bestV    = _mm256_blendv_ps(bestV, v, mask);
+        bestBase = _mm256_blendv_ps(bestBase, _mm256_castsi256_ps(_mm256_set1_epi32(int32_t(i * 8))), mask);
+    }
+
+    alignas(32) float    dist[8], u[8], v[8];
+    alignas(32) uint32_t face[8];
+    _mm256_store_ps(dist, bestT);
+    _mm256_store_ps(u, bestU);
+    _mm256_store_ps(v, bestV);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(face), _mm256_castps_si256(bestBase));
+    for (uint32_t k = 0; k < 8; ++k)
+    { face[k] += k; }
+
+    return SelectNearestLane(dist, u, v, face, 8, hit);
+}
+#endif//_XM_SSE_INTRINSICS_
+
+IntersectTriPacketsFunc SelectIntersectTriPackets8()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    if (GetCpuFeatures().AVX2)
+        return IntersectTriPacketsAVX2;
+#endif
+    return IntersectTriPacketsVector;
+}
+
+// 幅 width のパケットのレーン lane に三角形を書き込む.
+inline void SetTriangleLane(float* pPacket, size_t width, size_t lane, const D3DXVECTOR3& p0, const D3DXVECTOR3& p1, const D3DXVECTOR3& p2)
+{
+    for (size_t c = 0; c < 3; ++c)
+    {
+        pPacket[c * width + lane]       = p0[c];
+        pPacket[(3 + c) * width + lane] = p1[c] - p0[c];
+        pPacket[(6 + c) * width + lane] = p2[c] - p0[c];
+    }
+}
+
+// 三角形をパケットに詰める. 使わないレーンは 0 のまま残り, det == 0 なので交差しない.
+template<size_t Width>
+void BuildTrianglePackets
+(
+    float*              pOut,
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            stride,
+    const uint32_t*     pIndices,
+    size_t              count
+)
+{
+    const size_t packetCount = (count + Width - 1) / Width;
+    memset(pOut, 0, packetCount * TrianglePacketSize(Width) * sizeof(float));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const D3DXVECTOR3* p[3];
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const size_t index = (pIndices != nullptr) ? pIndices[3 * i + k] : 3 * i + k;
+            p[k] = OffsetPtr(pFirstPosition, index * stride);
+        }
+
+        SetTriangleLane(pOut + (i / Width) * TrianglePacketSize(Width), Width, i % Width, *p[0], *p[1], *p[2]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// IntersectTriRaysArgs structure
+///////////////////////////////////////////////////////////////////////////////
+struct IntersectTriRaysArgs
+{
+    D3DXINTERSECTINFO*  pHits;
+    const float*        pPos[3];
+    const float*        pDir[3];
+    float               V0   [3];
+    float               Edge1[3];
+    float               Edge2[3];
+    uint32_t            FaceIndex;
+};
+
+using IntersectTriRaysFunc = size_t (*)(const IntersectTriRaysArgs& args, size_t begin, size_t end, uint32_t& updated);
+
+inline void UpdateRayHit(const IntersectTriRaysArgs& args, size_t i, float u, float v, float t, uint32_t& updated)
+{
+    auto& hit = args.pHits[i];
+    hit.FaceIndex = args.FaceIndex;
+    hit.U         = u;
+    hit.V         = v;
+    hit.Dist      = t;
+    updated++;
+}
+
+size_t IntersectTriRaysScalar(const IntersectTriRaysArgs& args, size_t begin, size_t end, uint32_t& updated)
+{
+    for (auto i = begin; i < end; ++i)
+    {
+        const float pos[3] = { args.pPos[0][i], args.pPos[1][i], args.pPos[2][i] };
+        const float dir[3] = { args.pDir[0][i], args.pDir[1][i], args.pDir[2][i] };
+
+        float u, v, t;
+        if (IntersectTriScalar(pos, dir, args.V0, args.Edge1, args.Edge2, args.pHits[i].Dist, u, v, t))
+        { UpdateRayHit(args, i, u, v, t, updated); }
+    }
+    return end;
+}
+
+// 三角形を全レーンに複製し, 4本ずつ判定する.
+size_t IntersectTriRaysVector(const IntersectTriRaysArgs& args, size_t begin, size_t end, uint32_t& updated)
+{
+    using namespace DirectX;
+
+    TriangleLanes tri;
+    for (auto c = 0; c < 3; ++c)
+    {
+        tri.V0   [c] = XMVectorReplicate(args.V0[c]);
+        tri.Edge1[c] = XMVectorReplicate(args.Edge1[c]);
+        tri.Edge2[c] = XMVectorReplicate(args.Edge2[c]);
+    }
+
+    const auto pHits = args.pHits;
+
+    auto i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        auto load = [i](const float* p)
+        { return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p + i)); };
+
+        const XMVECTOR pos[3] = { load(args.pPos[0]), load(args.pPos[1]), load(args.pPos[2]) };
+        const XMVECTOR dir[3] = { load(args.pDir[0]), load(args.pDir[1]), load(args.pDir[2]) };
+        const auto maxDist = XMVectorSet(pHits[i].Dist, pHits[i + 1].Dist, pHits[i + 2].Dist, pHits[i + 3].Dist);
+
+        XMVECTOR u, v, t;
+        const auto mask = IntersectTriLanes(pos, dir, tri, maxDist, u, v, t);
+
+        uint32_t hitMask[4];
+        XMStoreInt4(hitMask, mask);
+        if ((hitMask[0] | hitMask[1] | hitMask[2] | hitMask[3]) == 0)
+            continue;
+
+        XMFLOAT4 uu, vv, tt;
+        XMStoreFloat4(&uu, u);
+        XMStoreFloat4(&vv, v);
+        XMStoreFloat4(&tt, t);
+        const float* pU = &uu.x;
+        const float* pV = &vv.x;
+        const float* pT = &tt.x;
+        for (auto k = 0; k < 4; ++k)
+        {
+            if (hitMask[k] != 0)
+            { UpdateRayHit(args, i + k, pU[k], pV[k], pT[k], updated); }
+        }
+    }
+    return i;
+}
+
+#if defined(_XM_SSE_INTRINSICS_)
+// 8本ずつ判定する.
+STUB_TARGET("avx2")
+size_t IntersectTriRaysAVX2(const IntersectTriRaysArgs& args, size_t begin, size_t end, uint32_t& updated)
+{
+    __m256 V0[3], E1[3], E2[3];
+    for (auto c = 0; c < 3; ++c)
+    {
+        V0[c] = _mm256_set1_ps(args.V0[c]);
+        E1[c] = _mm256_set1_ps(args.Edge1[c]);
+        E2[c] = _mm256_set1_ps(args.Edge2[c]);
+    }
+
+    const auto pHits = args.pHits;
+
+    auto i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 P[3] = { _mm256_loadu_ps(args.pPos[0] + i), _mm256_loadu_ps(args.pPos[1] + i), _mm256_loadu_ps(args.pPos[2] + i) };
+        const __m256 D[3] = { _mm256_loadu_ps(args.pDir[0] + i), _mm256_loadu_ps(args.pDir[1] + i), _mm256_loadu_ps(args.pDir[2] + i) };
+        const auto maxDist = _mm256_setr_ps(
+            pHits[i + 0].Dist, pHits[i + 1].Dist, pHits[i + 2].Dist, pHits[i + 3].Dist,
+            pHits[i + 4].Dist, pHits[i + 5].Dist, pHits[i + 6].Dist, pHits[i + 7].Dist);
+
+        __m256 u, v, t;
+        const auto mask = IntersectTriLanesAVX2(P, D, V0, E1, E2, maxDist, u, v, t);
+
+        const auto hitMask = _mm256_movemask_ps(mask);
+        if (hitMask == 0)
+            continue;
+
+        alignas(32) float uu[8], vv[8], tt[8];
+        _mm256_store_ps(uu, u);
+        _mm256_store_ps(vv, v);
+        _mm256_store_ps(tt, t);
+        for (auto k = 0; k < 8; ++k)
+        {
+            if ((hitMask >> k) & 1)
+            { UpdateRayHit(args, i + k, uu[k], vv[k], tt[k], updated); }
+        }
+    }
+    return i;
+}
+#endif//_XM_SSE_INTRINSICS_
+
+IntersectTriRaysFunc SelectIntersectTriRays()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+    if (GetCpuFeatures().AVX2)
+        return IntersectTriRaysAVX2;
+#endif
+    return IntersectTriRaysVector;
+}
+
+} // anonymous namespace
+
+// Intersect a ray with a triangle.
+bool STUB_API D3DXIntersectTri
+(
+    const D3DXVECTOR3*  p0,
+    const D3DXVECTOR3*  p1,
+    const D3DXVECTOR3*  p2,
+    const D3DXVECTOR3*  pRayPos,
+    const D3DXVECTOR3*  pRayDir,
+    float*              pU,
+    float*              pV,
+    float*              pDist
+)
+{
+    assert(p0 != nullptr && p1 != nullptr && p2 != nullptr);
+    assert(pRayPos != nullptr && pRayDir != nullptr);
+    assert(pU != nullptr && pV != nullptr && pDist != nullptr);
+
+    // パケットと同じく辺を先に求めてから判定する.
+    const float e1[3] = { p1->x - p0->x, p1->y - p0->y, p1->z - p0->z };
+    const float e2[3] = { p2->x - p0->x, p2->y - p0->y, p2->z - p0->z };
+
+    float u, v, t;
+    if (!IntersectTriScalar(*pRayPos, *pRayDir, *p0, e1, e2, INFINITY, u, v, t))
+        return false;
+
+    *pU    = u;
+    *pV    = v;
+    *pDist = t;
+    return true;
+}
+
+// Build SoA packets of 4 triangles.
+D3DXTRIANGLE4* STUB_API D3DXTrianglePackets4FromMesh
+(
+    D3DXTRIANGLE4*      pOut,
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            dwStride,
+    const uint32_t*     pIndices,
+    uint32_t            NumTriangles
+)
+{
+    assert(pOut != nullptr);
+    assert(pFirstPosition != nullptr || NumTriangles == 0);
+
+    BuildTrianglePackets<4>(pOut->V0[0], pFirstPosition, dwStride, pIndices, NumTriangles);
+    return pOut;
+}
+
+// Build SoA packets of 8 triangles.
+D3DXTRIANGLE8* STUB_API D3DXTrianglePackets8FromMesh
+(
+    D3DXTRIANGLE8*      pOut,
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            dwStride,
+    const uint32_t*     pIndices,
+    uint32_t            NumTriangles
+)
+{
+    assert(pOut != nullptr);
+    assert(pFirstPosition != nullptr || NumTriangles == 0);
+
+    BuildTrianglePackets<8>(pOut->V0[0], pFirstPosition, dwStride, pIndices, NumTriangles);
+    return pOut;
+}
+
+// Find the nearest triangle of the 4-wide packets hit by a ray.
+bool STUB_API D3DXIntersectTriPackets4
+(
+    D3DXINTERSECTINFO*      pHit,
+    const D3DXTRIANGLE4*    pPackets,
+    uint32_t                NumPackets,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir
+)
+{
+    assert(pHit != nullptr);
+    assert(pPackets != nullptr || NumPackets == 0);
+    assert(pRayPos != nullptr && pRayDir != nullptr);
+
+    if (NumPackets == 0)
+        return false;
+
+    return IntersectTriPacketsVector(pPackets->V0[0], 4, NumPackets, *pRayPos, *pRayDir, *pHit);
+}
+
+// Find the nearest triangle of the 8-wide packets hit by a ray.
+bool STUB_API D3DXIntersectTriPackets8
+(
+    D3DXINTERSECTINFO*      pHit,
+    const D3DXTRIANGLE8*    pPackets,
+    uint32_t                NumPackets,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir
+)
+{
+    assert(pHit != nullptr);
+    assert(pPackets != nullptr || NumPackets == 0);
+    assert(pRayPos != nullptr && pRayDir != nullptr);
+
+    if (NumPackets == 0)
+        return false;
+
+    static const auto pKernel = SelectIntersectTriPackets8();
+    return pKernel(pPackets->V0[0], 8, NumPackets, *pRayPos, *pRayDir, *pHit);
+}
+
+// Intersect SoA rays with one triangle.
+uint32_t STUB_API D3DXIntersectTriRays
+(
+    D3DXINTERSECTINFO*  pHits,
+    const D3DXVECTOR3*  p0,
+    const D3DXVECTOR3*  p1,
+    const D3DXVECTOR3*  p2,
+    uint32_t            FaceIndex,
+    const float*        pPosX,
+    const float*        pPosY,
+    const float*        pPosZ,
+    const float*        pDirX,
+    const float*        pDirY,
+    const float*        pDirZ,
+    uint32_t            n
+)
+{
+    assert(pHits != nullptr || n == 0);
+    assert(p0 != nullptr && p1 != nullptr && p2 != nullptr);
+    assert((pPosX != nullptr && pPosY != nullptr && pPosZ != nullptr) || n == 0);
+    assert((pDirX != nullptr && pDirY != nullptr && pDirZ != nullptr) || n == 0);
+
+    IntersectTriRaysArgs args = {};
+    args.pHits     = pHits;
+    args.pPos[0]   = pPosX;
+    args.pPos[1]   = pPosY;
+    args.pPos[2]   = pPosZ;
+    args.pDir[0]   = pDirX;
+    args.pDir[1]   = pDirY;
+    args.pDir[2]   = pDirZ;
+    args.FaceIndex = FaceIndex;
+    for (auto c = 0; c < 3; ++c)
+    {
+        args.V0   [c] = (*p0)[c];
+        args.Edge1[c] = (*p1)[c] - (*p0)[c];
+        args.Edge2[c] = (*p2)[c] - (*p0)[c];
+    }
+
+    static const auto pKernel = SelectIntersectTriRays();
+
+    uint32_t updated = 0;
+    auto i = pKernel(args, 0, n, updated);
+    i = IntersectTriRaysVector(args, i, n, updated);
+    IntersectTriRaysScalar(args, i, n, updated);
+    return updated;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Triangle BVH
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+const uint32_t kBVHBinCount      = 16;      // SAH を評価する軸ごとの分割数.
+const uint32_t kBVHMaxLeafSize   = 16;      // 葉に入れる三角形数の上限.
+const uint32_t kBVHMaxDepth      = 64;      // 2分木の深さの上限. 超えた場合は葉にする.
+const uint32_t kBVHStackSize     = 3 * kBVHMaxDepth + 4;
+const size_t   kBVHParallelSplit = 4096;    // 子の両方がこれ以上の三角形を持つ場合は別タスクで構築する.
+const size_t   kBVHRayGrain      = 64;      // 並列版の1チャンクで処理する光線数.
+const float    kBVHTraversalCost = 1.0f;    // 4三角形の判定に対するノードの判定の相対コスト.
+
+// 箱の判定の丸め誤差で三角形を見落とさないように, 箱を広げて出口の距離を伸ばす.
+const float    kBVHBoundsPadding = 1.0f / float(1 << 20);
+const float    kBVHRobustScale   = 1.0f + 4.0f * FLT_EPSILON;
+
+///////////////////////////////////////////////////////////////////////////////
+// BVHNode4 structure
+///////////////////////////////////////////////////////////////////////////////
+// 4つの子の箱を SoA で持つノード. 2キャッシュライン分の大きさになる.
+struct alignas(64) BVHNode4
+{
+    float       Bounds[6][4];   // MinX, MinY, MinZ, MaxX, MaxY, MaxZ. 空きは最小値 > 最大値にする.
+    uint32_t    Child[4];       // 内部ノードの番号, 葉の場合は先頭のパケット番号.
+    uint32_t    Count[4];       // 葉のパケット数. 内部ノードは 0.
+
+    D3DX_ALIGNED_OPERATOR_NEW(64)
+};
+
+static_assert(sizeof(BVHNode4) == 128, "Invalid BVHNode4 size.");
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXTRIANGLEBVH structure
+///////////////////////////////////////////////////////////////////////////////
+struct D3DXTRIANGLEBVH
+{
+    std::unique_ptr<BVHNode4[]>     pNodes;         // 深さ優先順. 0 が根.
+    size_t                          NodeCount = 0;
+    std::vector<D3DXTRIANGLE4>      Packets;
+    std::vector<uint32_t>           FaceIndices;    // パケットのレーンごとの元の面番号.
+};
+
+namespace /* anonymous */ {
+
+struct BVHBox
+{
+    DirectX::XMFLOAT3   Min = DirectX::XMFLOAT3( INFINITY,  INFINITY,  INFINITY);
+    DirectX::XMFLOAT3   Max = DirectX::XMFLOAT3(-INFINITY, -INFINITY, -INFINITY);
+
+    void Grow(const BVHBox& box)
+    {
+        DirectX::XMStoreFloat3(&Min, DirectX::XMVectorMin(DirectX::XMLoadFloat3(&Min), DirectX::XMLoadFloat3(&box.Min)));
+        DirectX::XMStoreFloat3(&Max, DirectX::XMVectorMax(DirectX::XMLoadFloat3(&Max), DirectX::XMLoadFloat3(&box.Max)));
+    }
+
+    // 表面積の半分. 空の箱は 0.
+    float HalfArea() const
+    {
+        if (Min.x > Max.x)
+            return 0.0f;
+
+        const float dx = Max.x - Min.x;
+        const float dy = Max.y - Min.y;
+        const float dz = Max.z - Min.z;
+        return dx * dy + dy * dz + dz * dx;
+    }
+};
+
+// ループの中ではレジスタ上で箱を広げ, 最後に BVHBox に書き出す.
+struct BVHBoxLanes
+{
+    DirectX::XMVECTOR   Min = DirectX::XMVectorReplicate( INFINITY);
+    DirectX::XMVECTOR   Max = DirectX::XMVectorReplicate(-INFINITY);
+
+    void Grow(DirectX::FXMVECTOR lower, DirectX::FXMVECTOR upper)
+    {
+        Min = DirectX::XMVectorMin(Min, lower);
+        Max = DirectX::XMVectorMax(Max, upper);
+    }
+
+    void Store(BVHBox& box) const
+    {
+        DirectX::XMStoreFloat3(&box.Min, Min);
+        DirectX::XMStoreFloat3(&box.Max, Max);
+    }
+};
+
+// 三角形の箱. 構築中はこの配列自体を並べ替えるので, 各ノードの走査は連続したメモリへのアクセスになる.
+// 4成分で読み込むと w に Index と Pad が入るが, 使うのは xyz だけ.
+struct BVHPrimRef
+{
+    float       Min[3];
+    uint32_t    Index;      // 元の面番号.
+    float       Max[3];
+    float       Pad;
+
+    DirectX::XMVECTOR LoadMin() const
+    { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(Min)); }
+
+    DirectX::XMVECTOR LoadMax() const
+    { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(Max)); }
+
+    // 重心の2倍.
+    float Center(int axis) const
+    { return Min[axis] + Max[axis]; }
+};
+
+static_assert(sizeof(BVHPrimRef) == 32, "Invalid BVHPrimRef size.");
+
+// 2分木のノード. 三角形 [Begin, Begin + Count) を持つ.
+// 左の子は自身の次, 右の子は自身 + 2 * LeftCount に置く. 部分木の番号が三角形の範囲だけで決まるので,
+// 並列に構築してもノードの配置がスレッド数によらない.
+struct BVHBuildNode
+{
+    BVHBox      Bounds;
+    uint32_t    Begin;
+    uint32_t    Count;
+    uint32_t    LeftCount;      // 0 の場合は葉.
+};
+
+struct BVHRangeBounds
+{
+    BVHBox  Bounds;
+    BVHBox  Centers;    // 重心の2倍の範囲.
+};
+
+struct BVHBins
+{
+    BVHBox      Bounds[3][kBVHBinCount];
+    uint32_t    Counts[3][kBVHBinCount] = {};
+};
+
+inline uint32_t PacketCount(uint32_t triangles)
+{ return (triangles + 3) / 4; }
+
+///////////////////////////////////////////////////////////////////////////////
+// BVHBuilder class
+///////////////////////////////////////////////////////////////////////////////
+class BVHBuilder
+{
+public:
+    BVHBuilder(std::vector<BVHPrimRef>& refs, bool parallel)
+    : m_Refs    (refs)
+    , m_Nodes   (2 * refs.size() - 1)
+    , m_Parallel(parallel)
+    { /* DO_NOTHING */ }
+
+    const std::vector<BVHBuildNode>& Nodes() const
+    { return m_Nodes; }
+
+    // ノード node に三角形 [begin, end) の部分木を構築する.
+    void Build(size_t node, uint32_t begin, uint32_t end, uint32_t depth)
+    {
+        const auto count    = end - begin;
+        const bool parallel = m_Parallel && count >= D3DX_PARALLEL_THRESHOLD;
+
+        BVHRangeBounds range;
+        for (const auto& part : ReduceRange<BVHRangeBounds>(begin, end, parallel, [&](size_t b, size_t e)
+        {
+            BVHBoxLanes bounds, centers;
+            for (auto i = b; i < e; ++i)
+            {
+                const auto lower  = m_Refs[i].LoadMin();
+                const auto upper  = m_Refs[i].LoadMax();
+                const auto center = DirectX::XMVectorAdd(lower, upper);
+                bounds .Grow(lower, upper);
+                centers.Grow(center, center);
+            }
+
+            BVHRangeBounds result;
+            bounds .Store(result.Bounds);
+            centers.Store(result.Centers);
+            return result;
+        }))
+        {
+            range.Bounds .Grow(part.Bounds);
+            range.Centers.Grow(part.Centers);
+        }
+
+        auto& out = m_Nodes[node];
+        out.Bounds    = range.Bounds;
+        out.Begin     = begin;
+        out.Count     = count;
+        out.LeftCount = 0;
+
+        if (count <= 4 || depth >= kBVHMaxDepth)
+            return;
+
+        const auto leftCount = Split(begin, end, range, parallel);
+        if (leftCount == 0)
+            return;
+
+        out.LeftCount = leftCount;
+
+        auto buildChild = [&](size_t begin_, size_t end_)
+        {
+            for (auto i = begin_; i < end_; ++i)
+            {
+                if (i == 0)
+                { Build(node + 1, begin, begin + leftCount, depth + 1); }
+                else
+                { Build(node + 2 * size_t(leftCount), begin + leftCount, end, depth + 1); }
+            }
+        };
+
+        if (m_Parallel && leftCount >= kBVHParallelSplit && count - leftCount >= kBVHParallelSplit)
+        { ParallelFor(2, 1, buildChild); }
+        else
+        { buildChild(0, 2); }
+    }
+
+private:
+    std::vector<BVHPrimRef>&    m_Refs;
+    std::vector<BVHBuildNode>   m_Nodes;
+    bool                        m_Parallel;
+
+    template<typename T, typename Func>
+    std::vector<T> ReduceRange(uint32_t begin, uint32_t end, bool parallel, Func func)
+    {
+        return ReduceBlocks<T>(end - begin, parallel, [&](size_t b, size_t e)
+        { return func(begin + b, begin + e); });
+    }
+
+    // 重心をビンに分けて SAH が最小になる位置で分割し, 左の三角形数を返す.
+    // 葉にした方が良い場合は 0 を返す.
+    uint32_t Split(uint32_t begin, uint32_t end, const BVHRangeBounds& range, bool parallel)
+    {
+        const auto count = end - begin;
+
+        float origin[3], scale[3];
+        bool  flat = true;
+        for (auto a = 0; a < 3; ++a)
+        {
+            const float lower  = (&range.Centers.Min.x)[a];
+            const float extent = (&range.Centers.Max.x)[a] - lower;
+            origin[a] = lower;
+            scale [a] = (extent > 0.0f) ? float(kBVHBinCount) / extent : 0.0f;
+            flat &= (extent <= 0.0f);
+        }
+
+        // 重心が全て一致する場合は番号の中央で分ける.
+        if (flat)
+            return (count > kBVHMaxLeafSize) ? count / 2 : 0;
+
+        auto binOf = [&](const BVHPrimRef& ref, int axis)
+        {
+            const auto bin = uint32_t((ref.Center(axis) - origin[axis]) * scale[axis]);
+            return (bin < kBVHBinCount) ? bin : kBVHBinCount - 1;
+        };
+
+        BVHBins bins;
+        for (const auto& part : ReduceRange<BVHBins>(begin, end, parallel, [&](size_t b, size_t e)
+        {
+            BVHBoxLanes bounds[3][kBVHBinCount];
+            BVHBins     result;
+            for (auto i = b; i < e; ++i)
+            {
+                const auto& ref   = m_Refs[i];
+                const auto  lower = ref.LoadMin();
+                const auto  upper = ref.LoadMax();
+                for (auto a = 0; a < 3; ++a)
+                {
+                    if (scale[a] == 0.0f)
+                        continue;
+
+                    const auto bin = binOf(ref, a);
+                    bounds[a][bin].Grow(lower, upper);
+                    result.Counts[a][bin]++;
+                }
+            }
+
+            for (auto a = 0; a < 3; ++a)
+            {
+                for (uint32_t k = 0; k < kBVHBinCount; ++k)
+                { bounds[a][k].Store(result.Bounds[a][k]); }
+            }
+            return result;
+        }))
+        {
+            for (auto a = 0; a < 3; ++a)
+            {
+                for (uint32_t k = 0; k < kBVHBinCount; ++k)
+                {
+                    bins.Bounds[a][k].Grow(part.Bounds[a][k]);
+                    bins.Counts[a][k] += part.Counts[a][k];
+                }
+            }
+        }
+
+        // 右から累積した面積を求めてから左から走査する. コストは4三角形のパケット数で数える.
+        float    bestCost = INFINITY;
+        int      bestAxis = -1;
+        uint32_t bestBin  = 0;
+        for (auto a = 0; a < 3; ++a)
+        {
+            if (scale[a] == 0.0f)
+                continue;
+
+            float    rightCost[kBVHBinCount];
+            BVHBox   right;
+            uint32_t rightCount = 0;
+            for (auto k = kBVHBinCount - 1; k > 0; --k)
+            {
+                right.Grow(bins.Bounds[a][k]);
+                rightCount += bins.Counts[a][k];
+                rightCost[k] = right.HalfArea() * float(PacketCount(rightCount));
+            }
+
+            BVHBox   left;
+            uint32_t leftCount = 0;
+            for (uint32_t k = 1; k < kBVHBinCount; ++k)
+            {
+                left.Grow(bins.Bounds[a][k - 1]);
+                leftCount += bins.Counts[a][k - 1];
+                if (leftCount == 0 || leftCount == count)
+                    continue;
+
+                const float cost = left.HalfArea() * float(PacketCount(leftCount)) + rightCost[k];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin  = k;
+                }
+            }
+        }
+
+        const float area     = range.Bounds.HalfArea();
+        const float leafCost = float(PacketCount(count));
+        const float cost     = (area > 0.0f) ? kBVHTraversalCost + bestCost / area : leafCost;
+        if (bestAxis < 0 || (count <= kBVHMaxLeafSize && leafCost <= cost))
+            return (count > kBVHMaxLeafSize) ? count / 2 : 0;
+
+        const auto first = m_Refs.begin();
+        const auto mid   = std::partition(first + begin, first + end, [&](const BVHPrimRef& ref)
+        { return binOf(ref, bestAxis) < bestBin; });
+        return uint32_t(mid - (first + begin));
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// BVHFlattener class
+///////////////////////////////////////////////////////////////////////////////
+// 2分木を4分木にまとめ, 深さ優先順に並べる.
+class BVHFlattener
+{
+public:
+    BVHFlattener(const std::vector<BVHBuildNode>& nodes, const std::vector<BVHPrimRef>& refs, const D3DXVECTOR3* pFirstPosition, uint32_t stride, const uint32_t* pIndices)
+    : m_Nodes           (nodes)
+    , m_Refs            (refs)
+    , m_pFirstPosition  (pFirstPosition)
+    , m_Stride          (stride)
+    , m_pIndices        (pIndices)
+    { /* DO_NOTHING */ }
+
+    void Flatten(D3DXTRIANGLEBVH& bvh)
+    {
+        size_t nodeCount = 0, packetCount = 0;
+        Count(0, nodeCount, packetCount);
+
+        bvh.pNodes.reset(new BVHNode4[nodeCount]);
+        bvh.NodeCount = nodeCount;
+        bvh.Packets.assign(packetCount, D3DXTRIANGLE4());
+        bvh.FaceIndices.assign(packetCount * 4, UINT32_MAX);
+        memset(bvh.Packets.data(), 0, packetCount * sizeof(D3DXTRIANGLE4));
+
+        m_pBVH        = &bvh;
+        m_NodeCount   = 0;
+        m_PacketCount = 0;
+        Emit(0);
+        assert(m_NodeCount == nodeCount && m_PacketCount == packetCount);
+    }
+
+private:
+    const std::vector<BVHBuildNode>&    m_Nodes;
+    const std::vector<BVHPrimRef>&      m_Refs;
+    const D3DXVECTOR3*                  m_pFirstPosition;
+    uint32_t                            m_Stride;
+    const uint32_t*                     m_pIndices;
+    D3DXTRIANGLEBVH*                    m_pBVH        = nullptr;
+    size_t                              m_NodeCount   = 0;
+    size_t                              m_PacketCount = 0;
+
+    bool IsLeaf(size_t index) const
+    { return m_Nodes[index].LeftCount == 0; }
+
+    // 内部ノードの子を最大4つ集める. 面積が最大の内部ノードを子に置き換えていく.
+    // 根が葉の場合は根自身を唯一の子にする.
+    uint32_t Gather(size_t index, size_t children[4]) const
+    {
+        if (IsLeaf(index))
+        {
+            children[0] = index;
+            return 1;
+        }
+
+        children[0] = index + 1;
+        children[1] = index + 2 * size_t(m_Nodes[index].LeftCount);
+        uint32_t count = 2;
+        while (count < 4)
+        {
+            int   best     = -1;
+            float bestArea = -1.0f;
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                const auto area = m_Nodes[children[k]].Bounds.HalfArea();
+                if (!IsLeaf(children[k]) && area > bestArea)
+                {
+                    best     = int(k);
+                    bestArea = area;
+                }
+            }
+
+            if (best < 0)
+                break;
+
+            const auto c = children[best];
+            children[best]    = c + 1;
+            children[count++] = c + 2 * size_t(m_Nodes[c].LeftCount);
+        }
+        return count;
+    }
+
+    void Count(size_t index, size_t& nodeCount, size_t& packetCount) const
+    {
+        nodeCount++;
+
+        size_t children[4];
+        const auto count = Gather(index, children);
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            if (IsLeaf(children[k]))
+            { packetCount += PacketCount(m_Nodes[children[k]].Count); }
+            else
+            { Count(children[k], nodeCount, packetCount); }
+        }
+    }
+
+    uint32_t Emit(size_t index)
+    {
+        const auto nodeIndex = m_NodeCount++;
+        auto& node = m_pBVH->pNodes[nodeIndex];
+        for (auto c = 0; c < 3; ++c)
+        {
+            for (auto k = 0; k < 4; ++k)
+            {
+                node.Bounds[c]    [k] =  INFINITY;
+                node.Bounds[3 + c][k] = -INFINITY;
+            }
+        }
+        memset(node.Child, 0, sizeof(node.Child));
+        memset(node.Count, 0, sizeof(node.Count));
+
+        size_t children[4];
+        const auto count = Gather(index, children);
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const auto& child = m_Nodes[children[k]];
+            const auto& box   = child.Bounds;
+            for (auto c = 0; c < 3; ++c)
+            {
+                const float lower = (&box.Min.x)[c];
+                const float upper = (&box.Max.x)[c];
+                const float pad   = (std::max(fabsf(lower), fabsf(upper)) + (upper - lower)) * kBVHBoundsPadding;
+                node.Bounds[c]    [k] = lower - pad;
+                node.Bounds[3 + c][k] = upper + pad;
+            }
+
+            if (child.LeftCount == 0)
+            {
+                node.Child[k] = uint32_t(m_PacketCount);
+                node.Count[k] = PacketCount(child.Count);
+                EmitLeaf(child);
+            }
+            else
+            { node.Child[k] = Emit(children[k]); }
+        }
+        return uint32_t(nodeIndex);
+    }
+
+    void EmitLeaf(const BVHBuildNode& leaf)
+    {
+        for (uint32_t i = 0; i < leaf.Count; ++i)
+        {
+            const auto face   = m_Refs[leaf.Begin + i].Index;
+            const auto packet = m_PacketCount + i / 4;
+
+            const D3DXVECTOR3* p[3];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const size_t index = (m_pIndices != nullptr) ? m_pIndices[3 * size_t(face) + k] : 3 * size_t(face) + k;
+                p[k] = OffsetPtr(m_pFirstPosition, index * m_Stride);
+            }
+
+            SetTriangleLane(m_pBVH->Packets[packet].V0[0], 4, i % 4, *p[0], *p[1], *p[2]);
+            m_pBVH->FaceIndices[packet * 4 + i % 4] = face;
+        }
+        m_PacketCount += PacketCount(leaf.Count);
+    }
+};
+
+HRESULT CreateTriangleBVH
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            numVertices,
+    uint32_t            stride,
+    const uint32_t*     pIndices,
+    uint32_t            numTriangles,
+    bool                parallel,
+    D3DXTRIANGLEBVH**   ppBVH
+)
+{
+    if (!pFirstPosition || !ppBVH || numTriangles == 0)
+        return kD3DERR_INVALIDCALL;
+
+    if (pIndices != nullptr)
+    {
+        for (size_t i = 0; i < size_t(numTriangles) * 3; ++i)
+        {
+            if (pIndices[i] >= numVertices)
+                return kD3DERR_INVALIDCALL;
+        }
+    }
+    else if (size_t(numTriangles) * 3 > numVertices)
+        return kD3DERR_INVALIDCALL;
+
+    // 三角形ごとの箱を求める.
+    std::vector<BVHPrimRef> refs(numTriangles);
+    auto setupRefs = [&](size_t begin, size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            DirectX::XMVECTOR p[3];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const size_t index = (pIndices != nullptr) ? pIndices[3 * i + k] : 3 * i + k;
+                p[k] = DirectX::XMLoadFloat3(OffsetPtr(pFirstPosition, index * stride));
+            }
+
+            auto& ref = refs[i];
+            DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(ref.Min), DirectX::XMVectorMin(p[0], DirectX::XMVectorMin(p[1], p[2])));
+            DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(ref.Max), DirectX::XMVectorMax(p[0], DirectX::XMVectorMax(p[1], p[2])));
+            ref.Index = uint32_t(i);
+            ref.Pad   = 0.0f;
+        }
+    };
+
+    if (parallel)
+    { ParallelFor(numTriangles, GetChunkSize(sizeof(BVHPrimRef)), setupRefs); }
+    else
+    { setupRefs(0, numTriangles); }
+
+    BVHBuilder builder(refs, parallel);
+    builder.Build(0, 0, numTriangles, 0);
+
+    std::unique_ptr<D3DXTRIANGLEBVH> pBVH(new D3DXTRIANGLEBVH());
+    BVHFlattener(builder.Nodes(), refs, pFirstPosition, stride, pIndices).Flatten(*pBVH);
+
+    *ppBVH = pBVH.release();
+    return kD3D_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// BVHRay structure
+///////////////////////////////////////////////////////////////////////////////
+// 4レーンに複製した光線.
+struct BVHRay
+{
+    DirectX::XMVECTOR   Pos   [3];
+    DirectX::XMVECTOR   Dir   [3];
+    DirectX::XMVECTOR   InvDir[3];
+    DirectX::XMVECTOR   Offset[3];  // -Pos * InvDir
+    uint32_t            Near  [3];  // 入口になる面の Bounds の行.
+    uint32_t            Far   [3];  // 出口になる面の Bounds の行.
+
+    BVHRay(const D3DXVECTOR3& pos, const D3DXVECTOR3& dir)
+    {
+        using namespace DirectX;
+
+        for (auto c = 0; c < 3; ++c)
+        {
+            // 0 除算で NaN にならないように, 小さい成分は符号を保ったまま丸める.
+            float d = dir[c];
+            if (fabsf(d) < 1e-20f)
+            { d = (d < 0.0f) ? -1e-20f : 1e-20f; }
+
+            const float inv = 1.0f / d;
+            Pos   [c] = XMVectorReplicate(pos[c]);
+            Dir   [c] = XMVectorReplicate(dir[c]);
+            InvDir[c] = XMVectorReplicate(inv);
+            Offset[c] = XMVectorReplicate(-pos[c] * inv);
+            Near  [c] = (d < 0.0f) ? 3 + c : c;
+            Far   [c] = (d < 0.0f) ? c : 3 + c;
+        }
+    }
+};
+
+// 4つの子の箱との交差を判定し, 入口の距離を tNear に返す.
+inline DirectX::XMVECTOR IntersectBVHNode(const BVHNode4& node, const BVHRay& ray, DirectX::FXMVECTOR maxDist, DirectX::XMVECTOR& tNear)
+{
+    using namespace DirectX;
+
+    auto slab = [&](uint32_t row, int axis)
+    {
+        return XMVectorMultiplyAdd(
+            XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(node.Bounds[row])), ray.InvDir[axis], ray.Offset[axis]);
+    };
+
+    const auto nx = slab(ray.Near[0], 0);
+    const auto ny = slab(ray.Near[1], 1);
+    const auto nz = slab(ray.Near[2], 2);
+    const auto fx = slab(ray.Far [0], 0);
+    const auto fy = slab(ray.Far [1], 1);
+    const auto fz = slab(ray.Far [2], 2);
+
+    tNear = XMVectorMax(XMVectorMax(nx, ny), XMVectorMax(nz, XMVectorZero()));
+    const auto tFar = XMVectorScale(XMVectorMin(XMVectorMin(fx, fy), XMVectorMin(fz, maxDist)), kBVHRobustScale);
+    return XMVectorLessOrEqual(tNear, tFar);
+}
+
+struct BVHStackEntry
+{
+    uint32_t    Index;
+    uint32_t    Count;  // 葉のパケット数. 内部ノードは 0.
+    float       Dist;   // 箱の入口までの距離.
+};
+
+// 最も近い交差を求める. 距離が等しい場合は面番号が小さい方を選ぶ.
+bool IntersectBVH(const D3DXTRIANGLEBVH& bvh, const D3DXVECTOR3& pos, const D3DXVECTOR3& dir, D3DXINTERSECTINFO& hit)
+{
+    using namespace DirectX;
+
+    const BVHRay ray(pos, dir);
+
+    BVHStackEntry stack[kBVHStackSize];
+    uint32_t      top   = 0;
+    bool          found = false;
+    stack[top++] = { 0, 0, 0.0f };
+
+    while (top > 0)
+    {
+        const auto entry = stack[--top];
+        if (entry.Dist > hit.Dist * kBVHRobustScale)
+            continue;
+
+        if (entry.Count != 0)
+        {
+            // 同じ距離の面も判定するために, 交差が見つかった後は上限を1ULP伸ばす.
+            for (auto p = entry.Index; p < entry.Index + entry.Count; ++p)
+            {
+                const auto maxDist = found ? nextafterf(hit.Dist, INFINITY) : hit.Dist;
+
+                XMVECTOR u, v, t;
+                const auto mask = IntersectTriLanes(ray.Pos, ray.Dir, LoadTriangleLanes(bvh.Packets[p].V0[0], 4, 0), XMVectorReplicate(maxDist), u, v, t);
+
+                uint32_t hitMask[4];
+                XMStoreInt4(hitMask, mask);
+                if ((hitMask[0] | hitMask[1] | hitMask[2] | hitMask[3]) == 0)
+                    continue;
+
+                XMFLOAT4 uu, vv, tt;
+                XMStoreFloat4(&uu, u);
+                XMStoreFloat4(&vv, v);
+                XMStoreFloat4(&tt, t);
+                for (auto k = 0; k < 4; ++k)
+                {
+                    const auto face = bvh.FaceIndices[p * 4 + k];
+                    const auto dist = (&tt.x)[k];
+                    if (hitMask[k] == 0 || !(dist < hit.Dist || (found && dist == hit.Dist && face < hit.FaceIndex)))
+                        continue;
+
+                    hit   = { face, (&uu.x)[k], (&vv.x)[k], dist };
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        const auto& node = bvh.pNodes[entry.Index];
+
+        XMVECTOR tNear;
+        const auto mask = IntersectBVHNode(node, ray, XMVectorReplicate(hit.Dist), tNear);
+
+        uint32_t hitMask[4];
+        XMFLOAT4 dist;
+        XMStoreInt4(hitMask, mask);
+        XMStoreFloat4(&dist, tNear);
+
+        // 近い子が先に取り出されるように, 遠い順に積む.
+        BVHStackEntry children[4];
+        uint32_t      count = 0;
+        for (auto k = 0; k < 4; ++k)
+        {
+            if (hitMask[k] == 0)
+                continue;
+
+            BVHStackEntry child = { node.Child[k], node.Count[k], (&dist.x)[k] };
+            auto j = count++;
+            for (; j > 0 && children[j - 1].Dist < child.Dist; --j)
+            { children[j] = children[j - 1]; }
+            children[j] = child;
+        }
+        for (uint32_t k = 0; k < count; ++k)
+        { stack[top++] = children[k]; }
+    }
+
+    return found;
+}
+
+// [0, maxDist) で交差する三角形があるかを調べる.
+bool OccludedBVH(const D3DXTRIANGLEBVH& bvh, const D3DXVECTOR3& pos, const D3DXVECTOR3& dir, float maxDist)
+{
+    using namespace DirectX;
+
+    const BVHRay ray(pos, dir);
+    const auto   maxDistV = XMVectorReplicate(maxDist);
+
+    BVHStackEntry stack[kBVHStackSize];
+    uint32_t      top = 0;
+    stack[top++] = { 0, 0, 0.0f };
+
+    while (top > 0)
+    {
+        const auto entry = stack[--top];
+        if (entry.Count != 0)
+        {
+            for (auto p = entry.Index; p < entry.Index + entry.Count; ++p)
+            {
+                XMVECTOR u, v, t;
+                const auto mask = IntersectTriLanes(ray.Pos, ray.Dir, LoadTriangleLanes(bvh.Packets[p].V0[0], 4, 0), maxDistV, u, v, t);
+
+                uint32_t hitMask[4];
+                XMStoreInt4(hitMask, mask);
+                if ((hitMask[0] | hitMask[1] | hitMask[2] | hitMask[3]) != 0)
+                    return true;
+            }
+            continue;
+        }
+
+        const auto& node = bvh.pNodes[entry.Index];
+
+        XMVECTOR tNear;
+        uint32_t hitMask[4];
+        XMStoreInt4(hitMask, IntersectBVHNode(node, ray, maxDistV, tNear));
+        for (auto k = 0; k < 4; ++k)
+        {
+            if (hitMask[k] != 0)
+            { stack[top++] = { node.Child[k], node.Count[k], 0.0f }; }
+        }
+    }
+
+    return false;
+}
+
+uint32_t IntersectBVHArray
+(
+    D3DXINTERSECTINFO*      pHits,
+    const D3DXTRIANGLEBVH&  bvh,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    size_t                  n,
+    bool                    parallel
+)
+{
+    std::atomic<uint32_t> updated(0);
+    auto intersect = [&](size_t begin, size_t end)
+    {
+        uint32_t count = 0;
+        for (auto i = begin; i < end; ++i)
+        { count += IntersectBVH(bvh, pRayPos[i], pRayDir[i], pHits[i]) ? 1 : 0; }
+        updated += count;
+    };
+
+    if (parallel)
+    { ParallelFor(n, kBVHRayGrain, intersect); }
+    else
+    { intersect(0, n); }
+
+    return updated;
+}
+
+uint32_t OccludedBVHArray
+(
+    uint8_t*                pOut,
+    const D3DXTRIANGLEBVH&  bvh,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    const float*            pMaxDist,
+    size_t                  n,
+    bool                    parallel
+)
+{
+    std::atomic<uint32_t> occluded(0);
+    auto test = [&](size_t begin, size_t end)
+    {
+        uint32_t count = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+            pOut[i] = OccludedBVH(bvh, pRayPos[i], pRayDir[i], pMaxDist[i]) ? 1 : 0;
+            count += pOut[i];
+        }
+        occluded += count;
+    };
+
+    if (parallel)
+    { ParallelFor(n, kBVHRayGrain, test); }
+    else
+    { test(0, n); }
+
+    return occluded;
+}
+
+} // anonymous namespace
+
+HRESULT STUB_API D3DXCreateTriangleBVH
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    const uint32_t*     pIndices,
+    uint32_t            NumTriangles,
+    D3DXTRIANGLEBVH**   ppBVH
+)
+{ return CreateTriangleBVH(pFirstPosition, NumVertices, dwStride, pIndices, NumTriangles, false, ppBVH); }
+
+HRESULT STUB_API D3DXCreateTriangleBVHParallel
+(
+    const D3DXVECTOR3*  pFirstPosition,
+    uint32_t            NumVertices,
+    uint32_t            dwStride,
+    const uint32_t*     pIndices,
+    uint32_t            NumTriangles,
+    D3DXTRIANGLEBVH**   ppBVH
+)
+{ return CreateTriangleBVH(pFirstPosition, NumVertices, dwStride, pIndices, NumTriangles, true, ppBVH); }
+
+void STUB_API D3DXDestroyTriangleBVH(D3DXTRIANGLEBVH* pBVH)
+{ delete pBVH; }
+
+bool STUB_API D3DXTriangleBVHIntersect
+(
+    D3DXINTERSECTINFO*      pHit,
+    const D3DXTRIANGLEBVH*  pBVH,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir
+)
+{
+    assert(pHit != nullptr && pBVH != nullptr);
+    assert(pRayPos != nullptr && pRayDir != nullptr);
+    return IntersectBVH(*pBVH, *pRayPos, *pRayDir, *pHit);
+}
+
+bool STUB_API D3DXTriangleBVHOccluded
+(
+    const D3DXTRIANGLEBVH*  pBVH,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    float                   MaxDist
+)
+{
+    assert(pBVH != nullptr);
+    assert(pRayPos != nullptr && pRayDir != nullptr);
+    return OccludedBVH(*pBVH, *pRayPos, *pRayDir, MaxDist);
+}
+
+uint32_t STUB_API D3DXTriangleBVHIntersectArray
+(
+    D3DXINTERSECTINFO*      pHits,
+    const D3DXTRIANGLEBVH*  pBVH,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    uint32_t                n
+)
+{
+    assert(pBVH != nullptr);
+    assert((pHits != nullptr && pRayPos != nullptr && pRayDir != nullptr) || n == 0);
+    return IntersectBVHArray(pHits, *pBVH, pRayPos, pRayDir, n, false);
+}
+
+uint32_t STUB_API D3DXTriangleBVHOccludedArray
+(
+    uint8_t*                pOut,
+    const D3DXTRIANGLEBVH*  pBVH,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    const float*            pMaxDist,
+    uint32_t                n
+)
+{
+    assert(pBVH != nullptr);
+    assert((pOut != nullptr && pRayPos != nullptr && pRayDir != nullptr && pMaxDist != nullptr) || n == 0);
+    return OccludedBVHArray(pOut, *pBVH, pRayPos, pRayDir, pMaxDist, n, false);
+}
+
+uint32_t STUB_API D3DXTriangleBVHIntersectArrayParallel
+(
+    D3DXINTERSECTINFO*      pHits,
+    const D3DXTRIANGLEBVH*  pBVH,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    uint32_t                n
+)
+{
+    assert(pBVH != nullptr);
+    assert((pHits != nullptr && pRayPos != nullptr && pRayDir != nullptr) || n == 0);
+    return IntersectBVHArray(pHits, *pBVH, pRayPos, pRayDir, n, true);
+}
+
+uint32_t STUB_API D3DXTriangleBVHOccludedArrayParallel
+(
+    uint8_t*                pOut,
+    const D3DXTRIANGLEBVH*  pBVH,
+    const D3DXVECTOR3*      pRayPos,
+    const D3DXVECTOR3*      pRayDir,
+    const float*            pMaxDist,
+    uint32_t                n
+)
+{
+    assert(pBVH != nullptr);
+    assert((pOut != nullptr && pRayPos != nullptr && pRayDir != nullptr && pMaxDist != nullptr) || n == 0);
+    return OccludedBVHArray(pOut, *pBVH, pRayPos, pRayDir, pMaxDist, n, true);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Animation tracks
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+// 4個の四元数を成分ごとのレーンに並べたもの.
+struct QuaternionLanes
+{
+    DirectX::XMVECTOR   x;
+    DirectX::XMVECTOR   y;
+    DirectX::XMVECTOR   z;
+    DirectX::XMVECTOR   w;
+};
+
+inline QuaternionLanes TransposeQuaternions(const DirectX::XMVECTOR q[4])
+{
+    const auto m = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(q[0], q[1], q[2], q[3]));
+    return { m.r[0], m.r[1], m.r[2], m.r[3] };
+}
+
+// レーンを四元数に戻して先頭の count 個を書き込む.
+inline void StoreQuaternionLanes(D3DXQUATERNION* pOut, const QuaternionLanes& q, uint32_t count)
+{
+    const auto m = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(q.x, q.y, q.z, q.w));
+    for (uint32_t k = 0; k < 4 && k < count; ++k)
+    { StoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut[k]), m.r[k]); }
+}
+
+// XMQuaternionSlerpV と同じ計算を4組同時に行う.
+QuaternionLanes SlerpQuaternionLanes(const QuaternionLanes& q0, const QuaternionLanes& q1, DirectX::FXMVECTOR t)
+{
+    const auto one              = DirectX::XMVectorReplicate(1.0f);
+    const auto oneMinusEpsilon  = DirectX::XMVectorReplicate(1.0f - 0.00001f);
+
+    auto cosOmega = DirectX::XMVectorAdd(
+        DirectX::XMVectorMultiplyAdd(q0.x, q1.x, DirectX::XMVectorMultiply(q0.z, q1.z)),
+        DirectX::XMVectorMultiplyAdd(q0.y, q1.y, DirectX::XMVectorMultiply(q0.w, q1.w)));
+
+    // 遠回りにならないように符号をそろえる.
+    const auto sign = DirectX::XMVectorSelect(one, DirectX::XMVectorNegate(one), DirectX::XMVectorLess(cosOmega, DirectX::XMVectorZero()));
+    cosOmega = DirectX::XMVectorMultiply(cosOmega, sign);
+
+    const auto control  = DirectX::XMVectorLess(cosOmega, oneMinusEpsilon);
+    const auto sinOmega = DirectX::XMVectorSqrt(DirectX::XMVectorSubtract(one, DirectX::XMVectorMultiply(cosOmega, cosOmega)));
+    const auto omega    = DirectX::XMVectorATan2(sinOmega, cosOmega);
+
+    // 角度が小さい場合は線形補間にする.
+    const auto t0 = DirectX::XMVectorSubtract(one, t);
+    auto s0 = DirectX::XMVectorDivide(DirectX::XMVectorSin(DirectX::XMVectorMultiply(t0, omega)), sinOmega);
+    auto s1 = DirectX::XMVectorDivide(DirectX::XMVectorSin(DirectX::XMVectorMultiply(t,  omega)), sinOmega);
+    s0 = DirectX::XMVectorSelect(t0, s0, control);
+    s1 = DirectX::XMVectorMultiply(DirectX::XMVectorSelect(t, s1, control), sign);
+
+    return {
+        DirectX::XMVectorMultiplyAdd(q0.x, s0, DirectX::XMVectorMultiply(q1.x, s1)),
+        DirectX::XMVectorMultiplyAdd(q0.y, s0, DirectX::XMVectorMultiply(q1.y, s1)),
+        DirectX::XMVectorMultiplyAdd(q0.z, s0, DirectX::XMVectorMultiply(q1.z, s1)),
+        DirectX::XMVectorMultiplyAdd(q0.w, s0, DirectX::XMVectorMultiply(q1.w, s1)),
+    };
+}
+
+// 時刻 time を含む区間 [pKey, pNext] と区間内の位置 pS を求める.
+// キーの範囲外の場合は端のキーを pKey = pNext, pS = 0 として返す.
+template<typename Tracks>
+inline void FindAnimKey(const Tracks& tracks, uint32_t track, float time, size_t* pKey, size_t* pNext, float* pS)
+{
+    const size_t begin  = tracks.pKeyOffsets[track];
+    const size_t end    = tracks.pKeyOffsets[track + 1];
+    const auto   pTimes = tracks.pTimes;
+
+    if (end - begin < 2 || !(time > pTimes[begin]))
+    {
+        *pKey = *pNext = begin;
+        *pS   = 0.0f;
+        return;
+    }
+
+    if (time >= pTimes[end - 1])
+    {
+        *pKey = *pNext = end - 1;
+        *pS   = 0.0f;
+        return;
+    }
+
+    const auto key = size_t(std::upper_bound(pTimes + begin, pTimes + end, time) - pTimes) - 1;
+    *pKey  = key;
+    *pNext = key + 1;
+    *pS    = (time - pTimes[key]) / (pTimes[key + 1] - pTimes[key]);
+}
+
+// 全トラックを時刻 time で評価する. 4トラックずつまとめて補間し, 端数は最後のトラックで埋める.
+void SampleAnimTracks(const D3DXANIMTRACKS& tracks, float time, D3DXQUATERNION* pRotationOut, D3DXVECTOR3* pTranslationOut)
+{
+    const auto count   = tracks.TrackCount;
+    const auto pKeys   = reinterpret_cast<const DirectX::XMFLOAT4*>(tracks.pRotations);
+    const auto pCtrl   = reinterpret_cast<const DirectX::XMFLOAT4*>(tracks.pControls);
+    const bool squad   = (pCtrl != nullptr);
+    const bool movable = (pTranslationOut != nullptr && tracks.pTranslations != nullptr);
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        DirectX::XMVECTOR q0[4], q1[4], a[4], b[4];
+        DirectX::XMFLOAT4 s;
+        float* pS = &s.x;
+
+        for (uint32_t k = 0; k < 4; ++k)
+        {
+            const auto track = (i + k < count) ? i + k : count - 1;
+
+            size_t key, next;
+            FindAnimKey(tracks, track, time, &key, &next, &pS[k]);
+
+            q0[k] = DirectX::XMLoadFloat4(&pKeys[key]);
+            if (!squad)
+            { q1[k] = DirectX::XMLoadFloat4(&pKeys[next]); }
+            else if (key == next)
+            { a[k] = b[k] = q1[k] = q0[k]; }
+            else
+            {
+                // 制御点は A, B, C の順に並んでいる. C は符号をそろえた次のキー.
+                a [k] = DirectX::XMLoadFloat4(&pCtrl[key * 3 + 0]);
+                b [k] = DirectX::XMLoadFloat4(&pCtrl[key * 3 + 1]);
+                q1[k] = DirectX::XMLoadFloat4(&pCtrl[key * 3 + 2]);
+            }
+
+            if (movable && i + k < count)
+            {
+                const auto p0 = DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(&tracks.pTranslations[key]));
+                const auto p1 = DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(&tracks.pTranslations[next]));
+                DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(&pTranslationOut[i + k]), DirectX::XMVectorLerp(p0, p1, pS[k]));
+            }
+        }
+
+        const auto t = DirectX::XMLoadFloat4(&s);
+
+        QuaternionLanes result;
+        if (squad)
+        {
+            // Slerp(Slerp(Q1, C, t), Slerp(A, B, t), 2t(1-t))
+            const auto q03 = SlerpQuaternionLanes(TransposeQuaternions(q0), TransposeQuaternions(q1), t);
+            const auto q12 = SlerpQuaternionLanes(TransposeQuaternions(a),  TransposeQuaternions(b),  t);
+            const auto tp  = DirectX::XMVectorScale(DirectX::XMVectorNegativeMultiplySubtract(t, t, t), 2.0f);
+            result = SlerpQuaternionLanes(q03, q12, tp);
+        }
+        else
+        { result = SlerpQuaternionLanes(TransposeQuaternions(q0), TransposeQuaternions(q1), t); }
+
+        StoreQuaternionLanes(pRotationOut + i, result, count - i);
+    }
+}
+
+inline bool IsValidAnimTracks(const D3DXANIMTRACKS* pTracks)
+{
+    return pTracks != nullptr
+        && (pTracks->TrackCount == 0
+        || (pTracks->pKeyOffsets != nullptr && pTracks->pTimes != nullptr && pTracks->pRotations != nullptr));
+}
+
+} // anonymous namespace
+
+D3DXQUATERNION* STUB_API D3DXAnimTracksSquadSetup(D3DXQUATERNION* pOut, const D3DXANIMTRACKS* pTracks)
+{
+    if (!pOut || !IsValidAnimTracks(pTracks))
+        return nullptr;
+
+    const auto pKeys = pTracks->pRotations;
+    for (uint32_t track = 0; track < pTracks->TrackCount; ++track)
+    {
+        const size_t begin = pTracks->pKeyOffsets[track];
+        const size_t end   = pTracks->pKeyOffsets[track + 1];
+        if (begin == end)
+            continue;
+
+        // 端の区間は前後のキーを複製して求める.
+        for (auto k = begin; k + 1 < end; ++k)
+        {
+            const auto prev = (k > begin)     ? k - 1 : k;
+            const auto post = (k + 2 < end)   ? k + 2 : k + 1;
+            D3DXQuaternionSquadSetup(&pOut[k * 3 + 0], &pOut[k * 3 + 1], &pOut[k * 3 + 2],
+                &pKeys[prev], &pKeys[k], &pKeys[k + 1], &pKeys[post]);
+        }
+
+        // 最後のキーは区間を持たない.
+        for (auto c = 0; c < 3; ++c)
+        { pOut[(end - 1) * 3 + c] = pKeys[end - 1]; }
+    }
+
+    return pOut;
+}
+
+D3DXQUATERNION* STUB_API D3DXAnimTracksSample
+(
+    D3DXQUATERNION*         pRotationOut,
+    D3DXVECTOR3*            pTranslationOut,
+    const D3DXANIMTRACKS*   pTracks,
+    float                   Time
+)
+{
+    if (!pRotationOut || !IsValidAnimTracks(pTracks))
+        return nullptr;
+
+    SampleAnimTracks(*pTracks, Time, pRotationOut, pTranslationOut);
+    return pRotationOut;
+}
+
+D3DXQUATERNION* STUB_API D3DXAnimTracksSampleParallel
+(
+    D3DXQUATERNION*         pRotationOut,
+    D3DXVECTOR3*            pTranslationOut,
+    const D3DXANIMTRACKS*   pTracks,
+    const float*            pTimes,
+    uint32_t                n
+)
+{
+    if (!pRotationOut || !pTimes || !IsValidAnimTracks(pTracks))
+        return nullptr;
+
+    const size_t count = pTracks->TrackCount;
+    if (count == 0)
+        return pRotationOut;
+
+    auto sampleInstances = [&](size_t begin, size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            SampleAnimTracks(*pTracks, pTimes[i],
+                pRotationOut + i * count,
+                (pTranslationOut != nullptr) ? pTranslationOut + i * count : nullptr);
+        }
+    };
+
+    // 1チャンクで D3DX_PARALLEL_THRESHOLD トラック程度を処理する.
+    const size_t grain = (count < D3DX_PARALLEL_THRESHOLD) ? (D3DX_PARALLEL_THRESHOLD / count) : 1;
+    ParallelFor(n, grain, sampleInstances);
+
+    return pRotationOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Compressed animation tracks
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+// 単位四元数の最大成分以外は [-1/√2, 1/√2] に収まるので, この範囲を15ビットで量子化する.
+const float     kQuaternion48Max   = 0.707106781f;
+const uint32_t  kQuaternion48Steps = 0x7FFF;
+const float     kQuaternion48Scale = 2.0f * kQuaternion48Max / float(kQuaternion48Steps);
+
+D3DXQUATERNION_48 EncodeQuaternion48(const D3DXQUATERNION& q)
+{
+    const float c[4] = { q.x, q.y, q.z, q.w };
+
+    uint32_t index = 0;
+    for (uint32_t k = 1; k < 4; ++k)
+    {
+        if (fabsf(c[k]) > fabsf(c[index]))
+        { index = k; }
+    }
+
+    // q と -q は同じ回転なので, 落とす成分が正になるように符号をそろえる.
+    const float sign = (c[index] < 0.0f) ? -1.0f : 1.0f;
+
+    D3DXQUATERNION_48 ret;
+    for (uint32_t k = 0, j = 0; k < 4; ++k)
+    {
+        if (k == index)
+            continue;
+
+        auto u = (sign * c[k] + kQuaternion48Max) / kQuaternion48Scale + 0.5f;
+        u = (u < 0.0f) ? 0.0f : ((u > float(kQuaternion48Steps)) ? float(kQuaternion48Steps) : u);
+        ret.v[j++] = uint16_t(uint32_t(u) << 1);
+    }
+
+    // 落とした成分の番号は各成分の最下位ビットに入れる.
+    ret.v[0] |= uint16_t(index & 0x1);
+    ret.v[1] |= uint16_t(index >> 1);
+    return ret;
+}
+
+// 4個の D3DXQUATERNION_48 を成分ごとのレーンに展開する.
+QuaternionLanes DecodeQuaternion48Lanes(const D3DXQUATERNION_48* const pKeys[4])
+{
+    uint32_t value[3][4];
+    uint32_t index[4];
+    for (uint32_t k = 0; k < 4; ++k)
+    {
+        const auto& key = *pKeys[k];
+        for (uint32_t c = 0; c < 3; ++c)
+        { value[c][k] = key.v[c] >> 1; }
+        index[k] = (key.v[0] & 0x1) | ((key.v[1] & 0x1) << 1);
+    }
+
+    const auto scale  = DirectX::XMVectorReplicate(kQuaternion48Scale);
+    const auto offset = DirectX::XMVectorReplicate(-kQuaternion48Max);
+
+    DirectX::XMVECTOR s[3];
+    for (uint32_t c = 0; c < 3; ++c)
+    { s[c] = DirectX::XMVectorMultiplyAdd(DirectX::XMConvertVectorUIntToFloat(DirectX::XMLoadInt4(value[c]), 0), scale, offset); }
+
+    // 落とした成分は単位長から求める.
+    auto sum = DirectX::XMVectorMultiply(s[0], s[0]);
+    sum = DirectX::XMVectorMultiplyAdd(s[1], s[1], sum);
+    sum = DirectX::XMVectorMultiplyAdd(s[2], s[2], sum);
+    const auto largest = DirectX::XMVectorSqrt(DirectX::XMVectorMax(
+        DirectX::XMVectorZero(), DirectX::XMVectorSubtract(DirectX::XMVectorReplicate(1.0f), sum)));
+
+    const auto idx = DirectX::XMLoadInt4(index);
+    const auto is0 = DirectX::XMVectorEqualInt(idx, DirectX::XMVectorReplicateInt(0));
+    const auto is1 = DirectX::XMVectorEqualInt(idx, DirectX::XMVectorReplicateInt(1));
+    const auto is2 = DirectX::XMVectorEqualInt(idx, DirectX::XMVectorReplicateInt(2));
+    const auto is3 = DirectX::XMVectorEqualInt(idx, DirectX::XMVectorReplicateInt(3));
+
+    // 落とした成分より後ろの成分は1つずつずれている.
+    return {
+        DirectX::XMVectorSelect(s[0], largest, is0),
+        DirectX::XMVectorSelect(DirectX::XMVectorSelect(s[1], s[0], is0), largest, is1),
+        DirectX::XMVectorSelect(DirectX::XMVectorSelect(s[2], s[1], DirectX::XMVectorOrInt(is0, is1)), largest, is2),
+        DirectX::XMVectorSelect(s[2], largest, is3),
+    };
+}
+
+// 圧縮したトラックを時刻 time で評価する. D3DXANIMTRACKS の slerp と同じ順に計算する.
+void SampleCompressedAnimTracks(const D3DXCOMPRESSEDANIMTRACKS& tracks, float time, D3DXQUATERNION* pRotationOut, D3DXVECTOR3* pTranslationOut)
+{
+    const auto count   = tracks.TrackCount;
+    const bool movable = (pTranslationOut != nullptr && tracks.pTranslations != nullptr);
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        const D3DXQUATERNION_48* pKey [4];
+        const D3DXQUATERNION_48* pNext[4];
+        uint16_t halfs[4][2][3];   // D3DXFLOAT16 のビット列.
+        DirectX::XMFLOAT4 s;
+        float* pS = &s.x;
+
+        for (uint32_t k = 0; k < 4; ++k)
+        {
+            const auto track = (i + k < count) ? i + k : count - 1;
+
+            size_t key, next;
+            FindAnimKey(tracks, track, time, &key, &next, &pS[k]);
+            pKey [k] = &tracks.pRotations[key];
+            pNext[k] = &tracks.pRotations[next];
+
+            if (movable)
+            {
+                memcpy(halfs[k][0], &tracks.pTranslations[key],  sizeof(halfs[k][0]));
+                memcpy(halfs[k][1], &tracks.pTranslations[next], sizeof(halfs[k][1]));
+            }
+        }
+
+        const auto t      = DirectX::XMLoadFloat4(&s);
+        const auto result = SlerpQuaternionLanes(DecodeQuaternion48Lanes(pKey), DecodeQuaternion48Lanes(pNext), t);
+        StoreQuaternionLanes(pRotationOut + i, result, count - i);
+
+        if (movable)
+        {
+            float p[4][2][3];
+            D3DXFloat16To32Array(&p[0][0][0], reinterpret_cast<const D3DXFLOAT16*>(&halfs[0][0][0]), 4 * 2 * 3);
+
+            for (uint32_t k = 0; k < 4 && i + k < count; ++k)
+            {
+                const auto origin = DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(&tracks.pOrigins[i + k]));
+                const auto p0 = DirectX::XMVectorAdd(origin, DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(p[k][0])));
+                const auto p1 = DirectX::XMVectorAdd(origin, DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(p[k][1])));
+                DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(&pTranslationOut[i + k]), DirectX::XMVectorLerp(p0, p1, pS[k]));
+            }
+        }
+    }
+}
+
+inline bool IsValidCompressedAnimTracks(const D3DXCOMPRESSEDANIMTRACKS* pTracks)
+{
+    return pTracks != nullptr
+        && (pTracks->TrackCount == 0
+        || (pTracks->pKeyOffsets != nullptr && pTracks->pTimes != nullptr && pTracks->pRotations != nullptr
+        && (pTracks->pTranslations == nullptr || pTracks->pOrigins != nullptr)));
+}
+
+} // anonymous namespace
+
+D3DXQUATERNION_48* STUB_API D3DXQuaternion32To48Array(D3DXQUATERNION_48* pOut, const D3DXQUATERNION* pIn, uint32_t n)
+{
+    if (!pOut || !pIn)
+        return nullptr;
+
+    for (uint32_t i = 0; i < n; ++i)
+    { pOut[i] = EncodeQuaternion48(pIn[i]); }
+
+    return pOut;
+}
+
+D3DXQUATERNION* STUB_API D3DXQuaternion48To32Array(D3DXQUATERNION* pOut, const D3DXQUATERNION_48* pIn, uint32_t n)
+{
+    if (!pOut || !pIn)
+        return nullptr;
+
+    // 端数は最後の要素で埋める.
+    for (uint32_t i = 0; i < n; i += 4)
+    {
+        const D3DXQUATERNION_48* pKeys[4];
+        for (uint32_t k = 0; k < 4; ++k)
+        { pKeys[k] = &pIn[(i + k < n) ? i + k : n - 1]; }
+
+        StoreQuaternionLanes(pOut + i, DecodeQuaternion48Lanes(pKeys), n - i);
+    }
+
+    return pOut;
+}
+
+D3DXQUATERNION_48* STUB_API D3DXAnimTracksCompress
+(
+    D3DXQUATERNION_48*      pRotationOut,
+    D3DXVECTOR3_16F*        pTranslationOut,
+    D3DXVECTOR3*            pOriginOut,
+    const D3DXANIMTRACKS*   pTracks
+)
+{
+    if (!pRotationOut || !IsValidAnimTracks(pTracks))
+        return nullptr;
+
+    // 途中まで書き込んで失敗しないように, 先に全ての引数を検証する.
+    const bool movable = (pTranslationOut != nullptr) && (pTracks->pTranslations != nullptr);
+    if (movable && !pOriginOut)
+        return nullptr;
+
+    if (pTracks->TrackCount == 0)
+        return pRotationOut;
+
+    const auto keyCount = pTracks->pKeyOffsets[pTracks->TrackCount];
+    D3DXQuaternion32To48Array(pRotationOut, pTracks->pRotations, keyCount);
+
+    if (!movable)
+        return pRotationOut;
+
+    // 範囲の中心からの差を半精度で保存すると, 絶対値が小さくなる分だけ精度が上がる.
+    std::vector<float> offsets;
+    for (uint32_t track = 0; track < pTracks->TrackCount; ++track)
+    {
+        const size_t begin = pTracks->pKeyOffsets[track];
+        const size_t end   = pTracks->pKeyOffsets[track + 1];
+        if (begin == end)
+        {
+            pOriginOut[track] = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
+            continue;
+        }
+
+        auto lower = pTracks->pTranslations[begin];
+        auto upper = lower;
+        for (auto k = begin + 1; k < end; ++k)
+        {
+            D3DXVec3Minimize(&lower, &lower, &pTracks->pTranslations[k]);
+            D3DXVec3Maximize(&upper, &upper, &pTracks->pTranslations[k]);
+        }
+
+        const auto origin = (lower + upper) * 0.5f;
+        pOriginOut[track] = origin;
+
+        offsets.resize((end - begin) * 3);
+        for (auto k = begin; k < end; ++k)
+        {
+            const auto offset = pTracks->pTranslations[k] - origin;
+            memcpy(&offsets[(k - begin) * 3], &offset.x, sizeof(float) * 3);
+        }
+        D3DXFloat32To16Array(&pTranslationOut[begin].x, offsets.data(), uint32_t(offsets.size()));
+    }
+
+    return pRotationOut;
+}
+
+D3DXQUATERNION* STUB_API D3DXCompressedAnimTracksSample
+(
+    D3DXQUATERNION*                     pRotationOut,
+    D3DXVECTOR3*                        pTranslationOut,
+    const D3DXCOMPRESSEDANIMTRACKS*     pTracks,
+    float                               Time
+)
+{
+    if (!pRotationOut || !IsValidCompressedAnimTracks(pTracks))
+        return nullptr;
+
+    SampleCompressedAnimTracks(*pTracks, Time, pRotationOut, pTranslationOut);
+    return pRotationOut;
+}
+
+D3DXQUATERNION* STUB_API D3DXCompressedAnimTracksSampleParallel
+(
+    D3DXQUATERNION*                     pRotationOut,
+    D3DXVECTOR3*                        pTranslationOut,
+    const D3DXCOMPRESSEDANIMTRACKS*     pTracks,
+    const float*                        pTimes,
+    uint32_t                            n
+)
+{
+    if (!pRotationOut || !pTimes || !IsValidCompressedAnimTracks(pTracks))
+        return nullptr;
+
+    const size_t count = pTracks->TrackCount;
+    if (count == 0)
+        return pRotationOut;
+
+    auto sampleInstances = [&](size_t begin, size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            SampleCompressedAnimTracks(*pTracks, pTimes[i],
+                pRotationOut + i * count,
+                (pTranslationOut != nullptr) ? pTranslationOut + i * count : nullptr);
+        }
+    };
+
+    const size_t grain = (count < D3DX_PARALLEL_THRESHOLD) ? (D3DX_PARALLEL_THRESHOLD / count) : 1;
+    ParallelFor(n, grain, sampleInstances);
+
+    return pRotationOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Dual quaternions
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
+
+// ScLERP でねじ軸を求められない (回転がほぼ 0 の) 場合の閾値.
+const float kScLerpEpsilon = 1e-6f;
+
+// 4個の双対四元数を成分ごとのレーンに展開したもの.
+struct DualQuaternionLanes
+{
+    QuaternionLanes     Real;
+    QuaternionLanes     Dual;
+};
+
+// a * b (Hamilton 積) を4組同時に計算する. XMQuaternionMultiply(b, a) と同じ.
+QuaternionLanes MultiplyQuaternionLanes(const QuaternionLanes& a, const QuaternionLanes& b)
+{
+    using namespace DirectX;
+    return {
+        XMVectorSubtract(XMVectorMultiplyAdd(a.w, b.x, XMVectorMultiplyAdd(a.x, b.w, XMVectorMultiply(a.y, b.z))), XMVectorMultiply(a.z, b.y)),
+        XMVectorSubtract(XMVectorMultiplyAdd(a.w, b.y, XMVectorMultiplyAdd(a.y, b.w, XMVectorMultiply(a.z, b.x))), XMVectorMultiply(a.x, b.z)),
+        XMVectorSubtract(XMVectorMultiplyAdd(a.w, b.z, XMVectorMultiplyAdd(a.z, b.w, XMVectorMultiply(a.x, b.y))), XMVectorMultiply(a.y, b.x)),
+        XMVectorSubtract(XMVectorMultiply(a.w, b.w), XMVectorMultiplyAdd(a.x, b.x, XMVectorMultiplyAdd(a.y, b.y, XMVectorMultiply(a.z, b.z)))),
+    };
+}
+
+inline QuaternionLanes AddQuaternionLanes(const QuaternionLanes& a, const QuaternionLanes& b)
+{
+    using namespace DirectX;
+    return { XMVectorAdd(a.x, b.x), XMVectorAdd(a.y, b.y), XMVectorAdd(a.z, b.z), XMVectorAdd(a.w, b.w) };
+}
+
+inline QuaternionLanes ScaleQuaternionLanes(const QuaternionLanes& q, DirectX::FXMVECTOR s)
+{
+    using namespace DirectX;
+    return { XMVectorMultiply(q.x, s), XMVectorMultiply(q.y, s), XMVectorMultiply(q.z, s), XMVectorMultiply(q.w, s) };
+}
+
+inline QuaternionLanes ConjugateQuaternionLanes(const QuaternionLanes& q)
+{ return { DirectX::XMVectorNegate(q.x), DirectX::XMVectorNegate(q.y), DirectX::XMVectorNegate(q.z), q.w }; }
+
+inline DirectX::XMVECTOR DotQuaternionLanes(const QuaternionLanes& a, const QuaternionLanes& b)
+{
+    using namespace DirectX;
+    return XMVectorAdd(
+        XMVectorMultiplyAdd(a.x, b.x, XMVectorMultiply(a.z, b.z)),
+        XMVectorMultiplyAdd(a.y, b.y, XMVectorMultiply(a.w, b.w)));
+}
+
+// 先頭の count 個をレーンに展開する. 端数は最後の要素で埋める.
+DualQuaternionLanes LoadDualQuaternionLanes(const D3DXDUALQUATERNION* pIn, uint32_t count)
+{
+    DirectX::XMVECTOR real[4];
+    DirectX::XMVECTOR dual[4];
+    for (uint32_t k = 0; k < 4; ++k)
+    {
+        const auto& dq = pIn[(k < count) ? k : count - 1];
+        real[k] = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&dq.Real));
+        dual[k] = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&dq.Dual));
+    }
+    return { TransposeQuaternions(real), TransposeQuaternions(dual) };
+}
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector3TransformNormalStream(pOut, OutStride, pV, VStride, n, mat);
-    return pOut;
+// レーンを双対四元数に戻して先頭の count 個を書き込む.
+void StoreDualQuaternionLanes(D3DXDUALQUATERNION* pOut, const DualQuaternionLanes& dq, uint32_t count)
+{
+    const auto real = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(dq.Real.x, dq.Real.y, dq.Real.z, dq.Real.w));
+    const auto dual = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(dq.Dual.x, dq.Dual.y, dq.Dual.z, dq.Dual.w));
+    for (uint32_t k = 0; k < 4 && k < count; ++k)
+    {
+        StoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut[k].Real), real.r[k]);
+        StoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut[k].Dual), dual.r[k]);
+    }
 }
 
-// Project vector from object space into screen space
-D3DXVECTOR3* STUB_API D3DXVec3Project
-(
-    D3DXVECTOR3*        pOut,
-    const D3DXVECTOR3*  pV,
-    const D3DVIEWPORT9* pViewport,
-    const D3DXMATRIX*   pProjection,
-    const D3DXMATRIX*   pView,
-    const D3DXMATRIX*   pWorld
-)
+// a の後に b を適用する. Hamilton 積では b * a になる.
+DualQuaternionLanes MultiplyDualQuaternionLanes(const DualQuaternionLanes& a, const DualQuaternionLanes& b)
 {
-    assert(pOut        != nullptr);
-    assert(pV          != nullptr);
-    assert(pViewport   != nullptr);
-    assert(pProjection != nullptr);
-    assert(pView       != nullptr);
-    assert(pWorld      != nullptr);
+    return {
+        MultiplyQuaternionLanes(b.Real, a.Real),
+        AddQuaternionLanes(MultiplyQuaternionLanes(b.Real, a.Dual), MultiplyQuaternionLanes(b.Dual, a.Real)),
+    };
+}
 
-    auto x = float(pViewport->X);
-    auto y = float(pViewport->Y);
-    auto w = float(pViewport->Width);
-    auto h = float(pViewport->Height);
+// Real を正規化し, Dual から Real 方向の成分を取り除く.
+DualQuaternionLanes NormalizeDualQuaternionLanes(const DualQuaternionLanes& dq)
+{
+    using namespace DirectX;
 
-    auto vec   = DirectX::XMLoadFloat3(pV);
-    auto proj  = DirectX::XMLoadFloat4x4(pProjection);
-    auto view  = DirectX::XMLoadFloat4x4(pView);
-    auto world = DirectX::XMLoadFloat4x4(pWorld);
-    auto ret   = DirectX::XMVector3Project(vec, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
-    DirectX::XMStoreFloat3(pOut, ret);
-    return pOut;
+    const auto invLength = XMVectorReciprocalSqrt(DotQuaternionLanes(dq.Real, dq.Real));
+    const auto real = ScaleQuaternionLanes(dq.Real, invLength);
+    const auto dual = ScaleQuaternionLanes(dq.Dual, invLength);
+    const auto proj = XMVectorNegate(DotQuaternionLanes(real, dual));
+    return {
+        real,
+        {
+            XMVectorMultiplyAdd(real.x, proj, dual.x),
+            XMVectorMultiplyAdd(real.y, proj, dual.y),
+            XMVectorMultiplyAdd(real.z, proj, dual.z),
+            XMVectorMultiplyAdd(real.w, proj, dual.w),
+        },
+    };
+}
+
+// dq^t をねじ運動のパラメータから求める.
+// dq = (cos(θ/2), l sin(θ/2)) + e(-d/2 sin(θ/2), m sin(θ/2) + l d/2 cos(θ/2)) の θ と d を t 倍する.
+DualQuaternionLanes PowDualQuaternionLanes(const DualQuaternionLanes& dq, DirectX::FXMVECTOR t)
+{
+    using namespace DirectX;
+
+    const auto& r = dq.Real;
+    const auto& d = dq.Dual;
+
+    const auto sinHalf = XMVectorSqrt(XMVectorMultiplyAdd(r.x, r.x, XMVectorMultiplyAdd(r.y, r.y, XMVectorMultiply(r.z, r.z))));
+    const auto invSin  = XMVectorReciprocal(sinHalf);
+    const auto screw   = XMVectorGreater(sinHalf, XMVectorReplicate(kScLerpEpsilon));
+
+    // l はねじ軸の方向, halfD は軸方向の移動量の半分, m はねじ軸のモーメント.
+    const XMVECTOR l[3] = { XMVectorMultiply(r.x, invSin), XMVectorMultiply(r.y, invSin), XMVectorMultiply(r.z, invSin) };
+    const auto halfD = XMVectorNegate(XMVectorMultiply(d.w, invSin));
+    const auto lw    = XMVectorMultiply(halfD, r.w);
+    const XMVECTOR m[3] = {
+        XMVectorMultiply(XMVectorSubtract(d.x, XMVectorMultiply(l[0], lw)), invSin),
+        XMVectorMultiply(XMVectorSubtract(d.y, XMVectorMultiply(l[1], lw)), invSin),
+        XMVectorMultiply(XMVectorSubtract(d.z, XMVectorMultiply(l[2], lw)), invSin),
+    };
+
+    XMVECTOR s, c;
+    XMVectorSinCos(&s, &c, XMVectorMultiply(t, XMVectorATan2(sinHalf, r.w)));
+    const auto halfDt = XMVectorMultiply(halfD, t);
+    const auto ldc    = XMVectorMultiply(halfDt, c);
+
+    // 回転がほぼ 0 の場合は平行移動だけを t 倍する.
+    const auto zero = XMVectorZero();
+    return {
+        {
+            XMVectorSelect(zero, XMVectorMultiply(l[0], s), screw),
+            XMVectorSelect(zero, XMVectorMultiply(l[1], s), screw),
+            XMVectorSelect(zero, XMVectorMultiply(l[2], s), screw),
+            XMVectorSelect(XMVectorSplatOne(), c, screw),
+        },
+        {
+            XMVectorSelect(XMVectorMultiply(d.x, t), XMVectorMultiplyAdd(m[0], s, XMVectorMultiply(l[0], ldc)), screw),
+            XMVectorSelect(XMVectorMultiply(d.y, t), XMVectorMultiplyAdd(m[1], s, XMVectorMultiply(l[1], ldc)), screw),
+            XMVectorSelect(XMVectorMultiply(d.z, t), XMVectorMultiplyAdd(m[2], s, XMVectorMultiply(l[2], ldc)), screw),
+            XMVectorSelect(XMVectorMultiply(d.w, t), XMVectorNegate(XMVectorMultiply(halfDt, s)), screw),
+        },
+    };
 }
 
-// Project vector from screen space into object space
-D3DXVECTOR3* STUB_API D3DXVec3Unproject
-(
-    D3DXVECTOR3*        pOut,
-    const D3DXVECTOR3*  pV,
-    const D3DVIEWPORT9* pViewport,
-    const D3DXMATRIX*   pProjection,
-    const D3DXMATRIX*   pView,
-    const D3DXMATRIX*   pWorld
-)
+// q1 * (q1^-1 * q2)^t を4組同時に計算する. 遠回りにならないように q2 の符号をそろえる.
+DualQuaternionLanes ScLerpDualQuaternionLanes(const DualQuaternionLanes& q1, DualQuaternionLanes q2, DirectX::FXMVECTOR t)
 {
-    assert(pOut        != nullptr);
-    assert(pV          != nullptr);
-    assert(pViewport   != nullptr);
-    assert(pProjection != nullptr);
-    assert(pView       != nullptr);
-    assert(pWorld      != nullptr);
+    using namespace DirectX;
 
-    auto x = float(pViewport->X);
-    auto y = float(pViewport->Y);
-    auto w = float(pViewport->Width);
-    auto h = float(pViewport->Height);
+    const auto one  = XMVectorSplatOne();
+    const auto sign = XMVectorSelect(one, XMVectorNegate(one), XMVectorLess(DotQuaternionLanes(q1.Real, q2.Real), XMVectorZero()));
+    q2.Real = ScaleQuaternionLanes(q2.Real, sign);
+    q2.Dual = ScaleQuaternionLanes(q2.Dual, sign);
 
-    auto vec   = DirectX::XMLoadFloat3(pV);
-    auto proj  = DirectX::XMLoadFloat4x4(pProjection);
-    auto view  = DirectX::XMLoadFloat4x4(pView);
-    auto world = DirectX::XMLoadFloat4x4(pWorld);
-    auto ret   = DirectX::XMVector3Unproject(vec, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
-    DirectX::XMStoreFloat3(pOut, ret);
-    return pOut;
+    const DualQuaternionLanes inverse = { ConjugateQuaternionLanes(q1.Real), ConjugateQuaternionLanes(q1.Dual) };
+    return MultiplyDualQuaternionLanes(PowDualQuaternionLanes(MultiplyDualQuaternionLanes(q2, inverse), t), q1);
 }
-      
-// Project vector Array from object space into screen space
-D3DXVECTOR3* STUB_API D3DXVec3ProjectArray
-(
-    D3DXVECTOR3*        pOut,
-    uint32_t            OutStride,
-    const D3DXVECTOR3*  pV,
-    uint32_t            VStride,
-    const D3DVIEWPORT9* pViewport,
-    const D3DXMATRIX*   pProjection,
-    const D3DXMATRIX*   pView,
-    const D3DXMATRIX*   pWorld,
-    uint32_t            n
-)
-{
-    assert(pOut        != nullptr);
-    assert(pV          != nullptr);
-    assert(pViewport   != nullptr);
-    assert(pProjection != nullptr);
-    assert(pView       != nullptr);
-    assert(pWorld      != nullptr);
 
-    auto x = float(pViewport->X);
-    auto y = float(pViewport->Y);
-    auto w = float(pViewport->Width);
-    auto h = float(pViewport->Height);
+// 4個の回転と平行移動から双対四元数を求める. Dual = 0.5 * t * Real.
+DualQuaternionLanes DualQuaternionFromRotationTranslationLanes(const QuaternionLanes& r, const QuaternionLanes& t)
+{ return { r, ScaleQuaternionLanes(MultiplyQuaternionLanes(t, r), DirectX::XMVectorReplicate(0.5f)) }; }
 
-    auto proj  = DirectX::XMLoadFloat4x4(pProjection);
-    auto view  = DirectX::XMLoadFloat4x4(pView);
-    auto world = DirectX::XMLoadFloat4x4(pWorld);
+// 平行移動 2 * Dual * Real^-1 をレーンで求める. w 成分は 0 になる.
+QuaternionLanes TranslationFromDualQuaternionLanes(const DualQuaternionLanes& dq)
+{
+    const auto t = MultiplyQuaternionLanes(dq.Dual, ConjugateQuaternionLanes(dq.Real));
+    const auto two = DirectX::XMVectorReplicate(2.0f);
+    return { DirectX::XMVectorMultiply(t.x, two), DirectX::XMVectorMultiply(t.y, two), DirectX::XMVectorMultiply(t.z, two), DirectX::XMVectorZero() };
+}
 
-    DirectX::XMVector3ProjectStream(
-        pOut, OutStride, pV, VStride, n, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
-    return pOut;
+// 4個の D3DXVECTOR3 を w = 0 の四元数のレーンに展開する.
+QuaternionLanes LoadTranslationLanes(const D3DXVECTOR3* pT)
+{
+    DirectX::XMVECTOR t[4];
+    for (auto k = 0; k < 4; ++k)
+    { t[k] = DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(&pT[k])); }
+    return TransposeQuaternions(t);
 }
 
-// Project vector Array from screen space into object space
-D3DXVECTOR3* STUB_API D3DXVec3UnprojectArray
-(
-    D3DXVECTOR3*        pOut,
-    uint32_t            OutStride,
-    const D3DXVECTOR3*  pV,
-    uint32_t            VStride,
-    const D3DVIEWPORT9* pViewport,
-    const D3DXMATRIX*   pProjection,
-    const D3DXMATRIX*   pView,
-    const D3DXMATRIX*   pWorld,
-    uint32_t            n
-)
+// [begin, end) の行列を分解して双対四元数に変換する. 縮尺は捨てる.
+void DualQuaternionsFromMatrices(D3DXDUALQUATERNION* pOut, const D3DXMATRIX* pM, size_t begin, size_t end)
 {
-    assert(pOut        != nullptr);
-    assert(pV          != nullptr);
-    assert(pViewport   != nullptr);
-    assert(pProjection != nullptr);
-    assert(pView       != nullptr);
-    assert(pWorld      != nullptr);
+    D3DXMATRIX      m[4];
+    D3DXVECTOR3     s[4];
+    D3DXQUATERNION  q[4];
+    D3DXVECTOR3     t[4];
 
-    auto x = float(pViewport->X);
-    auto y = float(pViewport->Y);
-    auto w = float(pViewport->Width);
-    auto h = float(pViewport->Height);
+    for (auto i = begin; i < end; i += 4)
+    {
+        const auto count = uint32_t((end - i < 4) ? end - i : 4);
+
+        // 端数は単位行列で埋めて同じ計算をする.
+        auto pSrc = pM + i;
+        if (count < 4)
+        {
+            for (auto k = 0; k < 4; ++k)
+            { D3DXMatrixIdentity(&m[k]); }
+            std::copy(pSrc, pSrc + count, m);
+            pSrc = m;
+        }
 
-    auto proj  = DirectX::XMLoadFloat4x4(pProjection);
-    auto view  = DirectX::XMLoadFloat4x4(pView);
-    auto world = DirectX::XMLoadFloat4x4(pWorld);
+        DecomposeMatrices4(s, q, t, pSrc);
 
-    DirectX::XMVector3UnprojectStream(
-        pOut, OutStride, pV, VStride, n, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
-    return pOut;
+        DirectX::XMVECTOR r[4];
+        for (auto k = 0; k < 4; ++k)
+        { r[k] = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&q[k])); }
+        StoreDualQuaternionLanes(pOut + i, DualQuaternionFromRotationTranslationLanes(TransposeQuaternions(r), LoadTranslationLanes(t)), count);
+    }
 }
 
+// [begin, end) の双対四元数を回転と平行移動の行列に変換する.
+void MatricesFromDualQuaternions(D3DXMATRIX* pOut, const D3DXDUALQUATERNION* pDQ, size_t begin, size_t end)
+{
+    const D3DXVECTOR3 kOne[4] = { { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } };
 
-///////////////////////////////////////////////////////////////////////////////
-// D3DXVECTOR4
-///////////////////////////////////////////////////////////////////////////////
+    D3DXMATRIX      m[4];
+    D3DXQUATERNION  q[4];
+    D3DXVECTOR3     t[4];
 
-// Cross-product in 4 dimensions.
-D3DXVECTOR4* STUB_API D3DXVec4Cross
-(
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR4*  pV1,
-    const D3DXVECTOR4*  pV2,
-    const D3DXVECTOR4*  pV3
-)
+    for (auto i = begin; i < end; i += 4)
+    {
+        const auto count = uint32_t((end - i < 4) ? end - i : 4);
+        const auto dq    = LoadDualQuaternionLanes(pDQ + i, count);
+
+        StoreQuaternionLanes(q, dq.Real, 4);
+        const auto tl = TranslationFromDualQuaternionLanes(dq);
+        const auto tm = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(tl.x, tl.y, tl.z, tl.w));
+        for (auto k = 0; k < 4; ++k)
+        { DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(&t[k]), tm.r[k]); }
+
+        if (count < 4)
+        {
+            ComposeMatrices4(m, kOne, q, t);
+            std::copy(m, m + count, pOut + i);
+        }
+        else
+        { ComposeMatrices4(pOut + i, kOne, q, t); }
+    }
+}
+
+// 2つの配列の要素ごとに func を適用して4個ずつ処理する.
+template<typename Func>
+void TransformDualQuaternions(D3DXDUALQUATERNION* pOut, const D3DXDUALQUATERNION* pDQ1, const D3DXDUALQUATERNION* pDQ2, uint32_t n, Func func)
 {
-    assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat4(pV1);
-    auto v2  = DirectX::XMLoadFloat4(pV2);
-    auto v3  = DirectX::XMLoadFloat4(pV3);
-    auto ret = DirectX::XMVector4Cross(v1, v2, v3);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+    for (uint32_t i = 0; i < n; i += 4)
+    {
+        const auto count = n - i;
+        StoreDualQuaternionLanes(pOut + i, func(
+            LoadDualQuaternionLanes(pDQ1 + i, count),
+            LoadDualQuaternionLanes(pDQ2 + i, count)), count);
+    }
 }
 
-D3DXVECTOR4* STUB_API D3DXVec4Normalize
+} // anonymous namespace
+
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionRotationTranslation
 (
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR4*  pV
+    D3DXDUALQUATERNION*     pOut,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation
 )
 {
-    assert(pOut != nullptr);
-    assert(pV   != nullptr);
+    assert(pOut      != nullptr);
+    assert(pRotation != nullptr);
+
+    const auto r = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pRotation));
+    const auto t = (pTranslation != nullptr)
+        ? DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(pTranslation))
+        : DirectX::XMVectorZero();
 
-    auto vec = DirectX::XMLoadFloat4(pV);
-    auto ret = DirectX::XMVector4Normalize(vec);
-    DirectX::XMStoreFloat4(pOut, ret);
+    // XMQuaternionMultiply(q1, q2) は q2 * q1 なので t * r になる.
+    DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut->Real), r);
+    DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut->Dual), DirectX::XMVectorScale(DirectX::XMQuaternionMultiply(r, t), 0.5f));
     return pOut;
 }
 
-// Hermite interpolation between position V1, tangent T1 (when s == 0)
-// and position V2, tangent T2 (when s == 1).
-D3DXVECTOR4* STUB_API D3DXVec4Hermite
+void STUB_API D3DXDualQuaternionToRotationTranslation
 (
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR4*  pV1,
-    const D3DXVECTOR4*  pT1,
-    const D3DXVECTOR4*  pV2,
-    const D3DXVECTOR4*  pT2,
-    float               s 
+    D3DXQUATERNION*             pOutRotation,
+    D3DXVECTOR3*                pOutTranslation,
+    const D3DXDUALQUATERNION*   pDQ
 )
 {
-    assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pT1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pT2  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat4(pV1);
-    auto t1  = DirectX::XMLoadFloat4(pT1);
-    auto v2  = DirectX::XMLoadFloat4(pV2);
-    auto t2  = DirectX::XMLoadFloat4(pT2);
-    auto vs  = DirectX::XMVectorSet(s, s, s, s);
-    auto ret = DirectX::XMVectorHermiteV(v1, t1, v2, t2, vs);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+    assert(pDQ != nullptr);
+
+    const auto r = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&pDQ->Real));
+    const auto d = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&pDQ->Dual));
+
+    if (pOutTranslation != nullptr)
+    {
+        const auto t = DirectX::XMQuaternionMultiply(DirectX::XMQuaternionConjugate(r), d);
+        DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(pOutTranslation), DirectX::XMVectorAdd(t, t));
+    }
+
+    if (pOutRotation != nullptr)
+    { *pOutRotation = pDQ->Real; }
 }
 
-// CatmullRom interpolation between V1 (when s == 0) and V2 (when s == 1)
-D3DXVECTOR4* STUB_API D3DXVec4CatmullRom
-(
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR4*  pV0,
-    const D3DXVECTOR4*  pV1,
-    const D3DXVECTOR4*  pV2,
-    const D3DXVECTOR4*  pV3,
-    float               s
-)
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionFromMatrix(D3DXDUALQUATERNION* pOut, const D3DXMATRIX* pM)
 {
     assert(pOut != nullptr);
-    assert(pV0  != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v0  = DirectX::XMLoadFloat4(pV0);
-    auto v1  = DirectX::XMLoadFloat4(pV1);
-    auto v2  = DirectX::XMLoadFloat4(pV2);
-    auto v3  = DirectX::XMLoadFloat4(pV3);
-    auto vs  = DirectX::XMVectorSet(s, s, s, s);
-    auto ret = DirectX::XMVectorCatmullRomV(v0, v1, v2, v3, vs);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+    assert(pM   != nullptr);
+
+    D3DXVECTOR3     s;
+    D3DXQUATERNION  r;
+    D3DXVECTOR3     t;
+    DecomposeMatrix(&s, &r, &t, pM);
+    return D3DXDualQuaternionRotationTranslation(pOut, &r, &t);
 }
 
-// Barycentric coordinates.  V1 + f(V2-V1) + g(V3-V1)
-D3DXVECTOR4* STUB_API D3DXVec4BaryCentric
-(
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR4*  pV1,
-    const D3DXVECTOR4*  pV2,
-    const D3DXVECTOR4*  pV3,
-    float               f,
-    float               g
-)
+D3DXMATRIX* STUB_API D3DXMatrixDualQuaternion(D3DXMATRIX* pOut, const D3DXDUALQUATERNION* pDQ)
 {
     assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat4(pV1);
-    auto v2  = DirectX::XMLoadFloat4(pV2);
-    auto v3  = DirectX::XMLoadFloat4(pV3);
-    auto vf  = DirectX::XMVectorSet(f, f, f, f);
-    auto vg  = DirectX::XMVectorSet(g, g, g, g);
-    auto ret = DirectX::XMVectorBaryCentricV(v1, v2, v3, vf, vg);
-    DirectX::XMStoreFloat4(pOut, ret);
+    assert(pDQ  != nullptr);
+
+    D3DXVECTOR3 t;
+    D3DXDualQuaternionToRotationTranslation(nullptr, &t, pDQ);
+
+    auto m = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&pDQ->Real)));
+    m.r[3] = DirectX::XMVectorSet(t.x, t.y, t.z, 1.0f);
+    StoreMatrix(pOut, m);
     return pOut;
 }
 
-// Transform vector by matrix.
-D3DXVECTOR4* STUB_API D3DXVec4Transform
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionMultiply
 (
-    D3DXVECTOR4*        pOut,
-    const D3DXVECTOR4*  pV,
-    const D3DXMATRIX*   pM
+    D3DXDUALQUATERNION*         pOut,
+    const D3DXDUALQUATERNION*   pDQ1,
+    const D3DXDUALQUATERNION*   pDQ2
 )
 {
     assert(pOut != nullptr);
-    assert(pV   != nullptr);
-    assert(pM   != nullptr);
+    assert(pDQ1 != nullptr);
+    assert(pDQ2 != nullptr);
 
-    auto vec = DirectX::XMLoadFloat4(pV);
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMVector4Transform(vec, mat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    auto load = [](const D3DXQUATERNION& q)
+    { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&q)); };
+
+    const auto r1 = load(pDQ1->Real);
+    const auto d1 = load(pDQ1->Dual);
+    const auto r2 = load(pDQ2->Real);
+    const auto d2 = load(pDQ2->Dual);
+
+    DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut->Real), DirectX::XMQuaternionMultiply(r1, r2));
+    DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&pOut->Dual), DirectX::XMVectorAdd(
+        DirectX::XMQuaternionMultiply(d1, r2),
+        DirectX::XMQuaternionMultiply(r1, d2)));
     return pOut;
 }
-    
-// Transform vector array by matrix.
-D3DXVECTOR4* STUB_API D3DXVec4TransformArray
-(
-    D3DXVECTOR4*        pOut,
-    uint32_t            OutStride,
-    const D3DXVECTOR4*  pV,
-    uint32_t            VStride,
-    const D3DXMATRIX*   pM,
-    uint32_t            n
-)
+
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionNormalize(D3DXDUALQUATERNION* pOut, const D3DXDUALQUATERNION* pDQ)
 {
     assert(pOut != nullptr);
-    assert(pV   != nullptr);
-    assert(pM   != nullptr);
-
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    DirectX::XMVector4TransformStream(pOut, OutStride, pV, VStride, n, mat);
-    return pOut;
+    assert(pDQ  != nullptr);
+    return D3DXDualQuaternionNormalizeArray(pOut, pDQ, 1);
 }
 
-
-///////////////////////////////////////////////////////////////////////////////
-// D3DXMATRIX
-///////////////////////////////////////////////////////////////////////////////
-
-float STUB_API D3DXMatrixDeterminant(const D3DXMATRIX *pM)
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionScLerp
+(
+    D3DXDUALQUATERNION*         pOut,
+    const D3DXDUALQUATERNION*   pDQ1,
+    const D3DXDUALQUATERNION*   pDQ2,
+    float                       t
+)
 {
-    assert(pM != nullptr);
-
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMMatrixDeterminant(mat);
-    return DirectX::XMVectorGetX(ret);
+    assert(pOut != nullptr);
+    assert(pDQ1 != nullptr);
+    assert(pDQ2 != nullptr);
+    return D3DXDualQuaternionScLerpArray(pOut, pDQ1, pDQ2, t, 1);
 }
 
-HRESULT STUB_API D3DXMatrixDecompose
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionBlend
 (
-    D3DXVECTOR3*        pOutScale,
-    D3DXQUATERNION*     pOutRotation,
-    D3DXVECTOR3*        pOutTranslation,
-    const D3DXMATRIX*   pM
+    D3DXDUALQUATERNION*         pOut,
+    const D3DXDUALQUATERNION*   pDQ,
+    const float*                pWeights,
+    uint32_t                    n
 )
 {
-    assert(pOutScale       != nullptr);
-    assert(pOutRotation    != nullptr);
-    assert(pOutTranslation != nullptr);
-    assert(pM              != nullptr);
+    assert(pOut     != nullptr);
+    assert(pDQ      != nullptr);
+    assert(pWeights != nullptr);
+    assert(n > 0);
+
+    using namespace DirectX;
+
+    // 最初の要素と反対側を向いている四元数は符号を反転して足す.
+    const auto zero  = XMVectorZero();
+    const auto pivot = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pDQ[0].Real));
 
-    DirectX::XMVECTOR scale;
-    DirectX::XMVECTOR rotate;
-    DirectX::XMVECTOR translation;
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMMatrixDecompose(&scale, &rotate, &translation, mat);
-    if (!ret)
+    auto real = zero;
+    auto dual = zero;
+    for (uint32_t i = 0; i < n; ++i)
     {
-        return kD3DERR_INVALIDCALL;// D3DERR_INVALIDCALL
-    }
+        const auto r = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pDQ[i].Real));
 
-    DirectX::XMStoreFloat3(pOutScale, scale);
-    DirectX::XMStoreFloat4(pOutRotation, rotate);
-    DirectX::XMStoreFloat3(pOutTranslation, translation);
+        auto w = XMVectorReplicate(pWeights[i]);
+        w    = XMVectorSelect(w, XMVectorNegate(w), XMVectorLess(XMVector4Dot(pivot, r), zero));
+        real = XMVectorMultiplyAdd(r, w, real);
+        dual = XMVectorMultiplyAdd(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pDQ[i].Dual)), w, dual);
+    }
 
-    return kD3D_OK; // S_OK.
+    D3DXDUALQUATERNION sum;
+    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&sum.Real), real);
+    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&sum.Dual), dual);
+    return D3DXDualQuaternionNormalizeArray(pOut, &sum, 1);
 }
 
-D3DXMATRIX* STUB_API D3DXMatrixTranspose(D3DXMATRIX *pOut, const D3DXMATRIX *pM)
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionMultiplyArray
+(
+    D3DXDUALQUATERNION*         pOut,
+    const D3DXDUALQUATERNION*   pDQ1,
+    const D3DXDUALQUATERNION*   pDQ2,
+    uint32_t                    n
+)
 {
     assert(pOut != nullptr);
-    assert(pM   != nullptr);
+    assert(pDQ1 != nullptr);
+    assert(pDQ2 != nullptr);
 
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMMatrixTranspose(mat);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    TransformDualQuaternions(pOut, pDQ1, pDQ2, n, [](const DualQuaternionLanes& a, const DualQuaternionLanes& b)
+    { return MultiplyDualQuaternionLanes(a, b); });
     return pOut;
 }
 
-// Matrix multiplication.  The result represents the transformation M2
-// followed by the transformation M1.  (Out = M1 * M2)
-D3DXMATRIX* STUB_API D3DXMatrixMultiply
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionNormalizeArray
 (
-    D3DXMATRIX*         pOut,
-    const D3DXMATRIX*   pM1,
-    const D3DXMATRIX*   pM2
+    D3DXDUALQUATERNION*         pOut,
+    const D3DXDUALQUATERNION*   pDQ,
+    uint32_t                    n
 )
 {
     assert(pOut != nullptr);
-    assert(pM1  != nullptr);
-    assert(pM2  != nullptr);
+    assert(pDQ  != nullptr);
 
-    auto m1  = DirectX::XMLoadFloat4x4(pM1);
-    auto m2  = DirectX::XMLoadFloat4x4(pM2);
-    auto ret = DirectX::XMMatrixMultiply(m1, m2);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    for (uint32_t i = 0; i < n; i += 4)
+    { StoreDualQuaternionLanes(pOut + i, NormalizeDualQuaternionLanes(LoadDualQuaternionLanes(pDQ + i, n - i)), n - i); }
     return pOut;
 }
 
-// Matrix multiplication, followed by a transpose. (Out = T(M1 * M2))
-D3DXMATRIX* STUB_API D3DXMatrixMultiplyTranspose
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionScLerpArray
 (
-    D3DXMATRIX*         pOut,
-    const D3DXMATRIX*   pM1,
-    const D3DXMATRIX*   pM2
+    D3DXDUALQUATERNION*         pOut,
+    const D3DXDUALQUATERNION*   pDQ1,
+    const D3DXDUALQUATERNION*   pDQ2,
+    float                       t,
+    uint32_t                    n
 )
 {
     assert(pOut != nullptr);
-    assert(pM1  != nullptr);
-    assert(pM2  != nullptr);
+    assert(pDQ1 != nullptr);
+    assert(pDQ2 != nullptr);
 
-    auto m1  = DirectX::XMLoadFloat4x4(pM1);
-    auto m2  = DirectX::XMLoadFloat4x4(pM2);
-    auto ret = DirectX::XMMatrixMultiplyTranspose(m1, m2);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    const auto tv = DirectX::XMVectorReplicate(t);
+    TransformDualQuaternions(pOut, pDQ1, pDQ2, n, [&](const DualQuaternionLanes& a, const DualQuaternionLanes& b)
+    { return ScLerpDualQuaternionLanes(a, b, tv); });
     return pOut;
 }
 
-// Calculate inverse of matrix.  Inversion my fail, in which case NULL will
-// be returned.  The determinant of pM is also returned it pfDeterminant
-// is non-NULL.
-D3DXMATRIX* STUB_API D3DXMatrixInverse
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionFromMatrixArray
 (
-    D3DXMATRIX*         pOut,
-    float*              pDeterminant,
-    const D3DXMATRIX*   pM
+    D3DXDUALQUATERNION* pOut,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
 )
 {
     assert(pOut != nullptr);
-    assert(pM != nullptr);
+    assert(pM   != nullptr);
 
-    DirectX::XMVECTOR det;
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMMatrixInverse(&det, mat);
-    if (pDeterminant != nullptr)
-    {
-        DirectX::XMStoreFloat(pDeterminant, det);
-    }
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    DualQuaternionsFromMatrices(pOut, pM, 0, n);
     return pOut;
 }
 
-// Build a matrix which scales by (sx, sy, sz)
-D3DXMATRIX* STUB_API D3DXMatrixScaling(D3DXMATRIX *pOut, float sx, float sy, float sz)
+D3DXMATRIX* STUB_API D3DXMatrixDualQuaternionArray
+(
+    D3DXMATRIX*                 pOut,
+    const D3DXDUALQUATERNION*   pDQ,
+    uint32_t                    n
+)
 {
     assert(pOut != nullptr);
+    assert(pDQ  != nullptr);
 
-    auto ret = DirectX::XMMatrixScaling(sx, sy, sz);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    MatricesFromDualQuaternions(pOut, pDQ, 0, n);
     return pOut;
 }
 
-// Build a matrix which translates by (x, y, z)
-D3DXMATRIX* STUB_API D3DXMatrixTranslation(D3DXMATRIX *pOut, float x, float y, float z)
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionFromMatrixArrayParallel
+(
+    D3DXDUALQUATERNION* pOut,
+    const D3DXMATRIX*   pM,
+    uint32_t            n
+)
 {
     assert(pOut != nullptr);
+    assert(pM   != nullptr);
+
+    if (n < D3DX_PARALLEL_THRESHOLD)
+        return D3DXDualQuaternionFromMatrixArray(pOut, pM, n);
 
-    auto ret = DirectX::XMMatrixTranslation(x, y, z);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    // チャンクの境界を4の倍数にそろえて, 端数の処理を配列の末尾だけにする.
+    ParallelFor(n, GetChunkSize(sizeof(D3DXMATRIX) + sizeof(D3DXDUALQUATERNION)) & ~size_t(3), [&](size_t begin, size_t end)
+    { DualQuaternionsFromMatrices(pOut, pM, begin, end); });
     return pOut;
 }
 
-// Build a matrix which rotates around the X axis
-D3DXMATRIX* STUB_API D3DXMatrixRotationX(D3DXMATRIX *pOut, float Angle)
+D3DXMATRIX* STUB_API D3DXMatrixDualQuaternionArrayParallel
+(
+    D3DXMATRIX*                 pOut,
+    const D3DXDUALQUATERNION*   pDQ,
+    uint32_t                    n
+)
 {
     assert(pOut != nullptr);
+    assert(pDQ  != nullptr);
 
-    auto ret = DirectX::XMMatrixRotationX(Angle);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    if (n < D3DX_PARALLEL_THRESHOLD)
+        return D3DXMatrixDualQuaternionArray(pOut, pDQ, n);
+
+    ParallelFor(n, GetChunkSize(sizeof(D3DXMATRIX) + sizeof(D3DXDUALQUATERNION)) & ~size_t(3), [&](size_t begin, size_t end)
+    { MatricesFromDualQuaternions(pOut, pDQ, begin, end); });
     return pOut;
 }
 
-// Build a matrix which rotates around the Y axis
-D3DXMATRIX* STUB_API D3DXMatrixRotationY(D3DXMATRIX *pOut, float Angle)
-{
-    assert(pOut != nullptr);
 
-    auto ret = DirectX::XMMatrixRotationY(Angle);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
-}
+///////////////////////////////////////////////////////////////////////////////
+// Skinning
+///////////////////////////////////////////////////////////////////////////////
+namespace /* anonymous */ {
 
-// Build a matrix which rotates around the Z axis
-D3DXMATRIX* STUB_API D3DXMatrixRotationZ(D3DXMATRIX *pOut, float Angle)
-{
-    assert(pOut != nullptr);
+inline const D3DXVECTOR3* SkinPosition(const D3DXSKINSTREAMS& s, size_t i)
+{ return OffsetPtr(s.pPosition, i * s.PositionStride); }
 
-    auto ret = DirectX::XMMatrixRotationZ(Angle);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
-}
+inline const uint8_t* SkinIndices(const D3DXSKINSTREAMS& s, size_t i)
+{ return OffsetPtr(s.pIndices, i * s.IndicesStride); }
 
-// Build a matrix which rotates around an arbitrary axis
-D3DXMATRIX* STUB_API D3DXMatrixRotationAxis(D3DXMATRIX *pOut, const D3DXVECTOR3 *pV, float Angle)
+inline const float* SkinWeights(const D3DXSKINSTREAMS& s, size_t i)
+{ return OffsetPtr(s.pWeights, i * s.WeightsStride); }
+
+// 骨の行列を重み付きで足し合わせてから頂点を変換する.
+void SkinLinear(const D3DXSKINSTREAMS& s, const D3DXMATRIX* pBones, uint32_t boneCount, size_t begin, size_t end)
 {
-    assert(pOut != nullptr);
-    assert(pV   != nullptr);
+    using namespace DirectX;
+    (void)boneCount;
 
-    auto axis = DirectX::XMLoadFloat3(pV);
-    auto ret  = DirectX::XMMatrixRotationAxis(axis, Angle);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    for (auto i = begin; i < end; ++i)
+    {
+        const auto pIndex  = SkinIndices(s, i);
+        const auto pWeight = SkinWeights(s, i);
+
+        XMMATRIX m(XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero());
+        for (uint32_t k = 0; k < s.InfluenceCount; ++k)
+        {
+            assert(pIndex[k] < boneCount);
+            const auto  w    = XMVectorReplicate(pWeight[k]);
+            const auto& bone = pBones[pIndex[k]];
+            for (auto r = 0; r < 4; ++r)
+            { m.r[r] = XMVectorMultiplyAdd(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bone.m[r][0])), w, m.r[r]); }
+        }
+
+        // 入力と出力が同じバッファでも良いように, 読み込んでから書き込む.
+        const auto p = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(SkinPosition(s, i)));
+        if (s.pNormal != nullptr && s.pNormalOut != nullptr)
+        {
+            // 拡大縮小を含む骨でも面に垂直なままになるように, 法線は逆転置行列で変換する.
+            // 余因子行列は逆転置行列の行列式倍なので, 正規化する前に行列式の符号だけをそろえる.
+            const auto c0  = XMVector3Cross(m.r[1], m.r[2]);
+            const auto c1  = XMVector3Cross(m.r[2], m.r[0]);
+            const auto c2  = XMVector3Cross(m.r[0], m.r[1]);
+            const auto det = XMVector3Dot(m.r[0], c0);
+
+            const auto n = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(OffsetPtr(s.pNormal, i * s.NormalStride)));
+            auto t = XMVectorMultiply(XMVectorSplatX(n), c0);
+            t = XMVectorMultiplyAdd(XMVectorSplatY(n), c1, t);
+            t = XMVectorMultiplyAdd(XMVectorSplatZ(n), c2, t);
+            t = XMVectorSelect(t, XMVectorNegate(t), XMVectorLess(det, XMVectorZero()));
+            XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(OffsetPtr(s.pNormalOut, i * s.NormalOutStride)), XMVector3Normalize(t));
+        }
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(OffsetPtr(s.pPositionOut, i * s.PositionOutStride)), XMVector3Transform(p, m));
+    }
 }
 
-// Build a matrix from a quaternion
-D3DXMATRIX* STUB_API D3DXMatrixRotationQuaternion(D3DXMATRIX *pOut, const D3DXQUATERNION *pQ)
+// 双対四元数を重み付きで足し合わせて正規化し, 頂点を変換する.
+void SkinDualQuaternions(const D3DXSKINSTREAMS& s, const D3DXDUALQUATERNION* pBones, uint32_t boneCount, size_t begin, size_t end)
 {
-    assert(pOut != nullptr);
-    assert(pQ   != nullptr);
+    using namespace DirectX;
+    (void)boneCount;
 
-    auto quat = DirectX::XMLoadFloat4(pQ);
-    auto ret  = DirectX::XMMatrixRotationQuaternion(quat);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
-}
+    const auto zero = XMVectorZero();
 
-// Yaw around the Y axis, a pitch around the X axis,
-// and a roll around the Z axis.
-D3DXMATRIX* STUB_API D3DXMatrixRotationYawPitchRoll(D3DXMATRIX *pOut, float Yaw, float Pitch, float Roll)
-{
-    assert(pOut != nullptr);
+    for (auto i = begin; i < end; ++i)
+    {
+        const auto pIndex  = SkinIndices(s, i);
+        const auto pWeight = SkinWeights(s, i);
 
-    auto ret = DirectX::XMMatrixRotationRollPitchYaw(Pitch, Yaw, Roll);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
-}
+        // 最初の骨と反対側を向いている四元数は符号を反転して足す.
+        assert(pIndex[0] < boneCount);
+        const auto pivot = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&pBones[pIndex[0]].Real));
 
-// Build transformation matrix.  NULL arguments are treated as identity.
-// Mout = Msc-1 * Msr-1 * Ms * Msr * Msc * Mrc-1 * Mr * Mrc * Mt
-D3DXMATRIX* STUB_API D3DXMatrixTransformation
-(
-    D3DXMATRIX*             pOut,
-    const D3DXVECTOR3*      pScalingCenter,
-    const D3DXQUATERNION*   pScalingRotation,
-    const D3DXVECTOR3*      pScaling,
-    const D3DXVECTOR3*      pRotationCenter,
-    const D3DXQUATERNION*   pRotation,
-    const D3DXVECTOR3*      pTranslation
-)
-{
-    assert(pOut             != nullptr);
-    assert(pScalingCenter   != nullptr);
-    assert(pScalingRotation != nullptr);
-    assert(pScaling         != nullptr);
-    assert(pRotationCenter  != nullptr);
-    assert(pRotation        != nullptr);
-    assert(pTranslation     != nullptr);
-
-    auto scalingCenter      = DirectX::XMLoadFloat3(pScalingCenter);
-    auto scalingRotation    = DirectX::XMLoadFloat4(pScalingRotation);
-    auto scaling            = DirectX::XMLoadFloat3(pScaling);
-    auto rotationCenter     = DirectX::XMLoadFloat3(pRotationCenter);
-    auto rotation           = DirectX::XMLoadFloat4(pRotation);
-    auto translation        = DirectX::XMLoadFloat3(pTranslation);
-
-    auto ret = DirectX::XMMatrixTransformation(scalingCenter, scalingRotation, scaling, rotationCenter, rotation, translation);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+        auto real = zero;
+        auto dual = zero;
+        for (uint32_t k = 0; k < s.InfluenceCount; ++k)
+        {
+            assert(pIndex[k] < boneCount);
+            const auto& bone = pBones[pIndex[k]];
+            const auto  r    = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bone.Real));
+
+            auto w = XMVectorReplicate(pWeight[k]);
+            w    = XMVectorSelect(w, XMVectorNegate(w), XMVectorLess(XMVector4Dot(pivot, r), zero));
+            real = XMVectorMultiplyAdd(r, w, real);
+            dual = XMVectorMultiplyAdd(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bone.Dual)), w, dual);
+        }
+
+        const auto invLength = XMVectorReciprocal(XMVector4Length(real));
+        real = XMVectorMultiply(real, invLength);
+        dual = XMVectorMultiply(dual, invLength);
+
+        // v' = v + 2 * r.xyz x (r.xyz x v + r.w * v)
+        const auto rw = XMVectorSplatW(real);
+        auto rotate = [&](XMVECTOR v)
+        {
+            const auto c = XMVector3Cross(real, XMVectorMultiplyAdd(rw, v, XMVector3Cross(real, v)));
+            return XMVectorAdd(v, XMVectorAdd(c, c));
+        };
+
+        // t = 2 * (r.w * d.xyz - d.w * r.xyz + r.xyz x d.xyz)
+        auto t = XMVectorAdd(
+            XMVectorSubtract(XMVectorMultiply(rw, dual), XMVectorMultiply(XMVectorSplatW(dual), real)),
+            XMVector3Cross(real, dual));
+        t = XMVectorAdd(t, t);
+
+        const auto p = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(SkinPosition(s, i)));
+        if (s.pNormal != nullptr && s.pNormalOut != nullptr)
+        {
+            const auto n = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(OffsetPtr(s.pNormal, i * s.NormalStride)));
+            XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(OffsetPtr(s.pNormalOut, i * s.NormalOutStride)),
+                XMVector3Normalize(rotate(n)));
+        }
+        XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(OffsetPtr(s.pPositionOut, i * s.PositionOutStride)), XMVectorAdd(rotate(p), t));
+    }
 }
 
-// Build 2D transformation matrix in XY plane.  NULL arguments are treated as identity.
-// Mout = Msc-1 * Msr-1 * Ms * Msr * Msc * Mrc-1 * Mr * Mrc * Mt
-D3DXMATRIX* STUB_API D3DXMatrixTransformation2D
-(
-    D3DXMATRIX*         pOut,
-    const D3DXVECTOR2*  pScalingCenter, 
-    float               ScalingRotation,
-    const D3DXVECTOR2*  pScaling, 
-    const D3DXVECTOR2*  pRotationCenter,
-    float               Rotation, 
-    const D3DXVECTOR2*  pTranslation
-)
+bool IsValidSkinStreams(const D3DXSKINSTREAMS* pStreams)
 {
-    assert(pOut            != nullptr);
-    assert(pScalingCenter  != nullptr);
-    assert(pScaling        != nullptr);
-    assert(pRotationCenter != nullptr);
-    assert(pTranslation    != nullptr);
+    if (!pStreams)
+        return false;
 
-    auto scalingCenter  = DirectX::XMLoadFloat2(pScalingCenter);
-    auto scaling        = DirectX::XMLoadFloat2(pScaling);
-    auto rotationCenter = DirectX::XMLoadFloat2(pRotationCenter);
-    auto translation    = DirectX::XMLoadFloat2(pTranslation);
+    const auto& s = *pStreams;
+    if (s.VertexCount == 0)
+        return true;
 
-    auto ret = DirectX::XMMatrixTransformation2D(scalingCenter, ScalingRotation, scaling, rotationCenter, Rotation, translation);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    return s.InfluenceCount > 0 && s.pPosition && s.pIndices && s.pWeights && s.pPositionOut;
 }
 
-// Build affine transformation matrix.  NULL arguments are treated as identity.
-// Mout = Ms * Mrc-1 * Mr * Mrc * Mt
-D3DXMATRIX* STUB_API D3DXMatrixAffineTransformation
-(
-    D3DXMATRIX*             pOut,
-    float                   Scaling,
-    const D3DXVECTOR3*      pRotationCenter,
-    const D3DXQUATERNION*   pRotation,
-    const D3DXVECTOR3*      pTranslation
-)
+// 頂点をワーカースレッドに分割して func(begin, end) を呼び出す.
+template<typename Func>
+void SplitSkinVertices(const D3DXSKINSTREAMS& s, const Func& func)
 {
-    assert(pOut            != nullptr);
-    assert(pRotationCenter != nullptr);
-    assert(pRotation       != nullptr);
-    assert(pTranslation    != nullptr);
-
-    auto scaling        = DirectX::XMVectorSet(Scaling, Scaling, Scaling, 1.0f);
-    auto rotationCenter = DirectX::XMLoadFloat3(pRotationCenter);
-    auto rotation       = DirectX::XMLoadFloat4(pRotation);
-    auto translation    = DirectX::XMLoadFloat3(pTranslation);
+    if (s.VertexCount < D3DX_PARALLEL_THRESHOLD)
+    {
+        func(0, s.VertexCount);
+        return;
+    }
 
-    auto ret = DirectX::XMMatrixAffineTransformation(scaling, rotationCenter, rotation, translation);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    const auto bytes = s.PositionStride + s.IndicesStride + s.WeightsStride + s.PositionOutStride
+                     + ((s.pNormal != nullptr && s.pNormalOut != nullptr) ? s.NormalStride + s.NormalOutStride : 0);
+    ParallelFor(s.VertexCount, GetChunkSize(bytes), func);
 }
 
-// Build 2D affine transformation matrix in XY plane.  NULL arguments are treated as identity.
-// Mout = Ms * Mrc-1 * Mr * Mrc * Mt
-D3DXMATRIX* STUB_API D3DXMatrixAffineTransformation2D
+// [begin, end) の頂点をスキニングする. 双対四元数の場合は先に骨を変換しておく.
+template<typename Split>
+D3DXVECTOR3* SkinVertices
 (
-    D3DXMATRIX*         pOut,
-    float               Scaling,
-    const D3DXVECTOR2*  pRotationCenter, 
-    float               Rotation,
-    const D3DXVECTOR2*  pTranslation
+    const D3DXSKINSTREAMS*  pStreams,
+    const D3DXMATRIX*       pBones,
+    uint32_t                boneCount,
+    D3DXSKINMETHOD          method,
+    Split                   split
 )
 {
-    assert(pOut            != nullptr);
-    assert(pRotationCenter != nullptr);
-    assert(pTranslation    != nullptr);
+    if (!IsValidSkinStreams(pStreams) || (!pBones && boneCount > 0))
+        return nullptr;
+
+    const auto& s = *pStreams;
+    switch (method)
+    {
+    case D3DXSKIN_LINEAR:
+        split([&](size_t begin, size_t end)
+        { SkinLinear(s, pBones, boneCount, begin, end); });
+        break;
 
-    auto scaling        = DirectX::XMVectorSet(Scaling, Scaling, 1.0f, 1.0f);
-    auto rotationCenter = DirectX::XMLoadFloat2(pRotationCenter);
-    auto translation    = DirectX::XMLoadFloat2(pTranslation);
+    case D3DXSKIN_DUALQUATERNION:
+        {
+            std::vector<D3DXDUALQUATERNION> bones(boneCount);
+            if (boneCount > 0)
+            { D3DXDualQuaternionFromMatrixArray(bones.data(), pBones, boneCount); }
 
-    auto ret = DirectX::XMMatrixAffineTransformation2D(scaling, rotationCenter, Rotation, translation);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+            split([&](size_t begin, size_t end)
+            { SkinDualQuaternions(s, bones.data(), boneCount, begin, end); });
+        }
+        break;
+
+    default:
+        return nullptr;
+    }
+
+    return s.pPositionOut;
 }
 
-// Build a lookat matrix. (right-handed)
-D3DXMATRIX* STUB_API D3DXMatrixLookAtRH
+} // anonymous namespace
+
+D3DXVECTOR3* STUB_API D3DXSkinVertices
 (
-    D3DXMATRIX*         pOut,
-    const D3DXVECTOR3*  pEye,
-    const D3DXVECTOR3*  pAt,
-    const D3DXVECTOR3*  pUp
+    const D3DXSKINSTREAMS*  pStreams,
+    const D3DXMATRIX*       pBones,
+    uint32_t                BoneCount,
+    D3DXSKINMETHOD          Method
 )
 {
-    assert(pOut != nullptr);
-    assert(pEye != nullptr);
-    assert(pAt  != nullptr);
-    assert(pUp  != nullptr);
-
-    auto eye = DirectX::XMLoadFloat3(pEye);
-    auto at  = DirectX::XMLoadFloat3(pAt);
-    auto up  = DirectX::XMLoadFloat3(pUp);
-    auto ret = DirectX::XMMatrixLookAtRH(eye, at, up);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    return SkinVertices(pStreams, pBones, BoneCount, Method, [&](const auto& func)
+    { func(0, pStreams->VertexCount); });
 }
 
-// Build a lookat matrix. (left-handed)
-D3DXMATRIX* STUB_API D3DXMatrixLookAtLH
+D3DXVECTOR3* STUB_API D3DXSkinVerticesParallel
 (
-    D3DXMATRIX*         pOut,
-    const D3DXVECTOR3*  pEye,
-    const D3DXVECTOR3*  pAt,
-    const D3DXVECTOR3*  pUp
+    const D3DXSKINSTREAMS*  pStreams,
+    const D3DXMATRIX*       pBones,
+    uint32_t                BoneCount,
+    D3DXSKINMETHOD          Method
 )
 {
-    assert(pOut != nullptr);
-    assert(pEye != nullptr);
-    assert(pAt  != nullptr);
-    assert(pUp  != nullptr);
-
-    auto eye = DirectX::XMLoadFloat3(pEye);
-    auto at  = DirectX::XMLoadFloat3(pAt);
-    auto up  = DirectX::XMLoadFloat3(pUp);
-    auto ret = DirectX::XMMatrixLookAtLH(eye, at, up);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    return SkinVertices(pStreams, pBones, BoneCount, Method, [&](const auto& func)
+    { SplitSkinVertices(*pStreams, func); });
 }
 
-// Build a perspective projection matrix. (right-handed)
-D3DXMATRIX* STUB_API D3DXMatrixPerspectiveRH
+D3DXVECTOR3* STUB_API D3DXSkinVerticesDualQuaternion
 (
-    D3DXMATRIX* pOut,
-    float       w,
-    float       h,
-    float       zn,
-    float       zf
+    const D3DXSKINSTREAMS*      pStreams,
+    const D3DXDUALQUATERNION*   pBones,
+    uint32_t                    BoneCount
 )
 {
-    assert(pOut != nullptr);
+    if (!IsValidSkinStreams(pStreams) || (!pBones && BoneCount > 0))
+        return nullptr;
 
-    auto ret = DirectX::XMMatrixPerspectiveRH(w, h, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    SkinDualQuaternions(*pStreams, pBones, BoneCount, 0, pStreams->VertexCount);
+    return pStreams->pPositionOut;
 }
 
-// Build a perspective projection matrix. (left-handed)
-D3DXMATRIX* STUB_API D3DXMatrixPerspectiveLH
+D3DXVECTOR3* STUB_API D3DXSkinVerticesDualQuaternionParallel
 (
-    D3DXMATRIX* pOut,
-    float       w,
-    float       h,
-    float       zn,
-    float       zf
+    const D3DXSKINSTREAMS*      pStreams,
+    const D3DXDUALQUATERNION*   pBones,
+    uint32_t                    BoneCount
 )
 {
-    assert(pOut != nullptr);
+    if (!IsValidSkinStreams(pStreams) || (!pBones && BoneCount > 0))
+        return nullptr;
 
-    auto ret = DirectX::XMMatrixPerspectiveLH(w, h, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    SplitSkinVertices(*pStreams, [&](size_t begin, size_t end)
+    { SkinDualQuaternions(*pStreams, pBones, BoneCount, begin, end); });
+    return pStreams->pPositionOut;
 }
 
-// Build a perspective projection matrix. (right-handed)
-D3DXMATRIX* STUB_API D3DXMatrixPerspectiveFovRH
-(
-    D3DXMATRIX* pOut,
-    float       fovy,
-    float       Aspect,
-    float       zn,
-    float       zf
-)
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXCOLOR
+///////////////////////////////////////////////////////////////////////////////
+
+// Interpolate r,g,b between desaturated color and color.
+// DesaturatedColor + s(Color - DesaturatedColor)
+D3DXCOLOR* STUB_API D3DXColorAdjustSaturation(D3DXCOLOR *pOut, const D3DXCOLOR *pC, float s)
 {
     assert(pOut != nullptr);
 
-    auto ret = DirectX::XMMatrixPerspectiveFovRH(fovy, Aspect, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    auto c   = LoadFloat4((DirectX::XMFLOAT4*)pC);
+    auto ret = DirectX::XMColorAdjustSaturation(c, s);
+    StoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
     return pOut;
 }
 
-// Build a perspective projection matrix. (left-handed)
-D3DXMATRIX* STUB_API D3DXMatrixPerspectiveFovLH
-(
-    D3DXMATRIX* pOut,
-    float       fovy,
-    float       Aspect,
-    float       zn,
-    float       zf
-)
+// Interpolate r,g,b between 50% grey and color.  Grey + s(Color - Grey)
+D3DXCOLOR* STUB_API D3DXColorAdjustContrast(D3DXCOLOR *pOut, const D3DXCOLOR *pC, float c)
 {
     assert(pOut != nullptr);
+    assert(pC   != nullptr);
 
-    auto ret = DirectX::XMMatrixPerspectiveFovLH(fovy, Aspect, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
+    auto vc  = LoadFloat4((DirectX::XMFLOAT4*)pC);
+    auto ret = DirectX::XMColorAdjustContrast(vc, c);
+    StoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
     return pOut;
 }
 
-// Build a perspective projection matrix. (right-handed)
-D3DXMATRIX* STUB_API D3DXMatrixPerspectiveOffCenterRH
-(
-    D3DXMATRIX* pOut,
-    float       l,
-    float       r,
-    float       b,
-    float       t,
-    float       zn,
-    float       zf
-)
+namespace /* anonymous */ {
+
+// 2^-13 未満の linear 値は sRGB の 0 に, 1 以上は 255 になる.
+// その間を指数と仮数の上位8ビットで区間に分けると, 1区間での sRGB の変化は 1/255 未満になる.
+const uint32_t kSRGBMinBits      = 0x39000000;  // 2^-13
+const uint32_t kSRGBMaxBits      = 0x3f7fffff;  // 1 の直前の値.
+const uint32_t kSRGBBucketShift  = 15;
+const uint32_t kSRGBBucketCount  = ((kSRGBMaxBits - kSRGBMinBits) >> kSRGBBucketShift) + 1;
+
+inline float AsFloat(uint32_t bits)
 {
-    assert(pOut != nullptr);
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
 
-    auto ret = DirectX::XMMatrixPerspectiveOffCenterRH(l, r, b, t, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+inline uint32_t AsUInt(float value)
+{
+    uint32_t result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
 }
 
-// Build a perspective projection matrix. (left-handed)
-D3DXMATRIX* STUB_API D3DXMatrixPerspectiveOffCenterLH
-(
-    D3DXMATRIX* pOut,
-    float       l,
-    float       r,
-    float       b,
-    float       t,
-    float       zn,
-    float       zf
-)
+double SRGBToLinear(double value)
+{ return (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4); }
+
+///////////////////////////////////////////////////////////////////////////////
+// SRGBTables structure
+///////////////////////////////////////////////////////////////////////////////
+struct SRGBTables
 {
-    assert(pOut != nullptr);
+    float   ToLinear [256];
+    float   Threshold[257];                         // Threshold[k] 以上の linear 値は k 以上に符号化される.
+    uint8_t Encode   [kSRGBBucketCount + 3];        // 区間の始点の符号化結果. 4バイト単位で gather するので3バイト余分に持つ.
 
-    auto ret = DirectX::XMMatrixPerspectiveOffCenterLH(l, r, b, t, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    SRGBTables()
+    {
+        for (auto k = 0; k < 256; ++k)
+        { ToLinear[k] = float(SRGBToLinear(k / 255.0)); }
+
+        // 隣り合う符号の中点が境界になる.
+        Threshold[0]   = -INFINITY;
+        Threshold[256] =  INFINITY;
+        for (auto k = 1; k < 256; ++k)
+        { Threshold[k] = float(SRGBToLinear((k - 0.5) / 255.0)); }
+
+        memset(Encode, 0, sizeof(Encode));
+        for (uint32_t i = 0; i < kSRGBBucketCount; ++i)
+        {
+            const auto x = AsFloat(kSRGBMinBits + (i << kSRGBBucketShift));
+            Encode[i] = uint8_t(std::upper_bound(Threshold + 1, Threshold + 256, x) - (Threshold + 1));
+        }
+    }
+};
+
+const SRGBTables& GetSRGBTables()
+{
+    static const SRGBTables s_Tables;
+    return s_Tables;
 }
 
-// Build an ortho projection matrix. (right-handed)
-D3DXMATRIX* STUB_API D3DXMatrixOrthoRH
-(
-    D3DXMATRIX* pOut,
-    float       w,
-    float       h,
-    float       zn,
-    float       zf
-)
+// operator uint32_t と同じ丸め. NaN は 0 にする.
+inline uint32_t FloatToUNorm8(float value)
 {
-    assert(pOut != nullptr);
+    const float v = value * 255.0f + 0.5f;
+    return (v > 0.0f) ? ((v < 255.0f) ? uint32_t(v) : 255) : 0;
+}
 
-    auto ret = DirectX::XMMatrixOrthographicRH(w, h, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+// 最も近い sRGB の値に符号化する. NaN は 0 にする.
+inline uint32_t LinearToSRGB8(const SRGBTables& tables, float value)
+{
+    const float x = (value > AsFloat(kSRGBMinBits)) ? ((value < AsFloat(kSRGBMaxBits)) ? value : AsFloat(kSRGBMaxBits)) : AsFloat(kSRGBMinBits);
+    const uint32_t c = tables.Encode[(AsUInt(x) - kSRGBMinBits) >> kSRGBBucketShift];
+    return (x >= tables.Threshold[c + 1]) ? c + 1 : c;
 }
 
-// Build an ortho projection matrix. (left-handed)
-D3DXMATRIX* STUB_API D3DXMatrixOrthoLH
-(
-    D3DXMATRIX* pOut,
-    float       w,
-    float       h,
-    float       zn,
-    float       zf
-)
+typedef void (*ColorFromARGBFunc)(D3DXCOLOR* pOut, const uint32_t* pIn, size_t n, bool srgb);
+typedef void (*ColorToARGBFunc)(uint32_t* pOut, const D3DXCOLOR* pIn, size_t n, bool srgb);
+
+void ColorFromARGBScalar(D3DXCOLOR* pOut, const uint32_t* pIn, size_t n, bool srgb)
 {
-    assert(pOut != nullptr);
+    if (!srgb)
+    {
+        for (size_t i = 0; i < n; ++i)
+        { pOut[i] = D3DXCOLOR(pIn[i]); }
+        return;
+    }
 
-    auto ret = DirectX::XMMatrixOrthographicLH(w, h, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    const auto& tables = GetSRGBTables();
+    const float f      = 1.0f / 255.0f;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto dw = pIn[i];
+        pOut[i].r = tables.ToLinear[uint8_t(dw >> 16)];
+        pOut[i].g = tables.ToLinear[uint8_t(dw >>  8)];
+        pOut[i].b = tables.ToLinear[uint8_t(dw >>  0)];
+        pOut[i].a = f * (float) uint8_t(dw >> 24);
+    }
 }
 
-// Build an ortho projection matrix. (right-handed)
-D3DXMATRIX* STUB_API D3DXMatrixOrthoOffCenterRH
-(
-    D3DXMATRIX* pOut,
-    float       l,
-    float       r,
-    float       b,
-    float       t,
-    float       zn,
-    float       zf
-)
+void ColorToARGBScalar(uint32_t* pOut, const D3DXCOLOR* pIn, size_t n, bool srgb)
 {
-    assert(pOut != nullptr);
+    if (!srgb)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto& c = pIn[i];
+            pOut[i] = (FloatToUNorm8(c.a) << 24) | (FloatToUNorm8(c.r) << 16) | (FloatToUNorm8(c.g) << 8) | FloatToUNorm8(c.b);
+        }
+        return;
+    }
 
-    auto ret = DirectX::XMMatrixOrthographicOffCenterRH(l, r, b, t, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    const auto& tables = GetSRGBTables();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto& c = pIn[i];
+        pOut[i] = (FloatToUNorm8(c.a) << 24)
+                | (LinearToSRGB8(tables, c.r) << 16)
+                | (LinearToSRGB8(tables, c.g) <<  8)
+                | (LinearToSRGB8(tables, c.b) <<  0);
+    }
 }
 
-// Build an ortho projection matrix. (left-handed)
-D3DXMATRIX* STUB_API D3DXMatrixOrthoOffCenterLH
-(
-    D3DXMATRIX* pOut,
-    float       l,
-    float       r,
-    float       b,
-    float       t,
-    float       zn,
-    float       zf
-)
+#if defined(_XM_SSE_INTRINSICS_)
+// 4画素ずつ処理する. gather が無いので sRGB はスカラー版で処理する.
+void ColorFromARGBSSE2(D3DXCOLOR* pOut, const uint32_t* pIn, size_t n, bool srgb)
 {
-    assert(pOut != nullptr);
+    if (srgb)
+    {
+        ColorFromARGBScalar(pOut, pIn, n, srgb);
+        return;
+    }
 
-    auto ret = DirectX::XMMatrixOrthographicOffCenterLH(l, r, b, t, zn, zf);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    const auto zero  = _mm_setzero_si128();
+    const auto scale = _mm_set1_ps(1.0f / 255.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        // b, g, r, a の順に32ビットに広げてから r, g, b, a に並べ替える.
+        const auto v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + i));
+        const auto lo = _mm_unpacklo_epi8(v, zero);
+        const auto hi = _mm_unpackhi_epi8(v, zero);
+        const __m128i px[4] = {
+            _mm_unpacklo_epi16(lo, zero),
+            _mm_unpackhi_epi16(lo, zero),
+            _mm_unpacklo_epi16(hi, zero),
+            _mm_unpackhi_epi16(hi, zero),
+        };
+        for (auto k = 0; k < 4; ++k)
+        {
+            const auto c = _mm_shuffle_epi32(px[k], _MM_SHUFFLE(3, 0, 1, 2));
+            _mm_storeu_ps(&pOut[i + k].r, _mm_mul_ps(_mm_cvtepi32_ps(c), scale));
+        }
+    }
+    ColorFromARGBScalar(pOut + i, pIn + i, n - i, srgb);
 }
 
-// Build a matrix which flattens geometry into a plane, as if casting
-// a shadow from a light.
-D3DXMATRIX* STUB_API D3DXMatrixShadow
-(
-    D3DXMATRIX*         pOut,
-    const D3DXVECTOR4*  pLight,
-    const D3DXPLANE*    pPlane
-)
+void ColorToARGBSSE2(uint32_t* pOut, const D3DXCOLOR* pIn, size_t n, bool srgb)
 {
-    assert(pOut  != nullptr);
-    assert(pLight != nullptr);
-    assert(pPlane != nullptr);
+    if (srgb)
+    {
+        ColorToARGBScalar(pOut, pIn, n, srgb);
+        return;
+    }
 
-    auto plane = DirectX::XMVectorSet(pPlane->a, pPlane->b, pPlane->c, pPlane->d);
-    auto light = DirectX::XMLoadFloat4(pLight);
+    const auto zero  = _mm_setzero_ps();
+    const auto limit = _mm_set1_ps(255.0f);
+    const auto half  = _mm_set1_ps(0.5f);
 
-    auto ret = DirectX::XMMatrixShadow(plane, light);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        // FloatToUNorm8 と同じく乗算と加算を分けて丸める. max は NaN を 0 にする.
+        __m128i px[4];
+        for (auto k = 0; k < 4; ++k)
+        {
+            auto v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&pIn[i + k].r), limit), half);
+            v = _mm_min_ps(_mm_max_ps(v, zero), limit);
+            px[k] = _mm_shuffle_epi32(_mm_cvttps_epi32(v), _MM_SHUFFLE(3, 0, 1, 2));
+        }
+        const auto packed = _mm_packus_epi16(_mm_packs_epi32(px[0], px[1]), _mm_packs_epi32(px[2], px[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), packed);
+    }
+    ColorToARGBScalar(pOut + i, pIn + i, n - i, srgb);
 }
 
-// Build a matrix which reflects the coordinate system about a plane
-D3DXMATRIX* STUB_API D3DXMatrixReflect(D3DXMATRIX *pOut, const D3DXPLANE *pPlane)
+// 8画素ずつ処理する. 2画素を1つのレジスタに r, g, b, a の順で持つ.
+STUB_TARGET("avx2")
+void ColorFromARGBAVX2(D3DXCOLOR* pOut, const uint32_t* pIn, size_t n, bool srgb)
 {
-    assert(pOut   != nullptr);
-    assert(pPlane != nullptr);
+    const auto& tables = GetSRGBTables();
+    const auto  scale  = _mm256_set1_ps(1.0f / 255.0f);
 
-    auto plane = DirectX::XMVectorSet(pPlane->a, pPlane->b, pPlane->c, pPlane->d);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        for (auto k = 0; k < 8; k += 2)
+        {
+            auto c = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pIn + i + k)));
+            c = _mm256_shuffle_epi32(c, _MM_SHUFFLE(3, 0, 1, 2));
 
-    auto ret = DirectX::XMMatrixReflect(plane);
-    DirectX::XMStoreFloat4x4(pOut, ret);
-    return pOut;
+            auto f = _mm256_mul_ps(_mm256_cvtepi32_ps(c), scale);
+            if (srgb)
+            { f = _mm256_blend_ps(_mm256_i32gather_ps(tables.ToLinear, c, 4), f, 0x88); }
+            _mm256_storeu_ps(&pOut[i + k].r, f);
+        }
+    }
+    ColorFromARGBScalar(pOut + i, pIn + i, n - i, srgb);
 }
 
-///////////////////////////////////////////////////////////////////////////////
-// D3DXQUATERNION
-///////////////////////////////////////////////////////////////////////////////
-
-// Compute a quaternin's axis and angle of rotation. Expects unit quaternions.
-void STUB_API D3DXQuaternionToAxisAngle
-(
-    const D3DXQUATERNION*   pQ,
-    D3DXVECTOR3*            pAxis,
-    float*                  pAngle
-)
+STUB_TARGET("avx2")
+void ColorToARGBAVX2(uint32_t* pOut, const D3DXCOLOR* pIn, size_t n, bool srgb)
 {
-    assert(pQ     != nullptr);
-    assert(pAxis  != nullptr);
-    assert(pAngle != nullptr);
+    const auto& tables  = GetSRGBTables();
+    const auto  zero    = _mm256_setzero_ps();
+    const auto  limit   = _mm256_set1_ps(255.0f);
+    const auto  half    = _mm256_set1_ps(0.5f);
+    const auto  lower   = _mm256_set1_ps(AsFloat(kSRGBMinBits));
+    const auto  upper   = _mm256_set1_ps(AsFloat(kSRGBMaxBits));
+    const auto  minBits = _mm256_set1_epi32(int(kSRGBMinBits));
+    const auto  byte    = _mm256_set1_epi32(0xff);
+    const auto  order   = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i px[4];
+        for (auto k = 0; k < 4; ++k)
+        {
+            const auto x = _mm256_loadu_ps(&pIn[i + 2 * k].r);
 
-    auto quat = DirectX::XMLoadFloat4(pQ);
+            // 乗算と加算を分けて丸める. FMA を使うと FloatToUNorm8 と結果が変わる.
+            auto v = _mm256_add_ps(_mm256_mul_ps(x, limit), half);
+            auto c = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(v, zero), limit));
 
-    DirectX::XMVECTOR axis;
-    DirectX::XMQuaternionToAxisAngle(&axis, pAngle, quat);
+            if (srgb)
+            {
+                // LinearToSRGB8 と同じく区間の符号を引いてから境界と比べて補正する.
+                const auto xs     = _mm256_min_ps(_mm256_max_ps(x, lower), upper);
+                const auto bucket = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_castps_si256(xs), minBits), kSRGBBucketShift);
+                auto e = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.Encode), bucket, 1), byte);
+                const auto threshold = _mm256_i32gather_ps(tables.Threshold + 1, e, 4);
+                e = _mm256_sub_epi32(e, _mm256_castps_si256(_mm256_cmp_ps(xs, threshold, _CMP_GE_OQ)));
+                c = _mm256_blend_epi32(e, c, 0x88);
+            }
+            px[k] = _mm256_shuffle_epi32(c, _MM_SHUFFLE(3, 0, 1, 2));
+        }
 
-    DirectX::XMStoreFloat3(pAxis, axis);
+        // レーンごとに詰めると画素の順序が 0, 2, 4, 6, 1, 3, 5, 7 になるので並べ直す.
+        const auto packed = _mm256_packus_epi16(_mm256_packs_epi32(px[0], px[1]), _mm256_packs_epi32(px[2], px[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    ColorToARGBScalar(pOut + i, pIn + i, n - i, srgb);
 }
+#endif//_XM_SSE_INTRINSICS_
 
-// Build a quaternion from a rotation matrix.
-D3DXQUATERNION* STUB_API D3DXQuaternionRotationMatrix(D3DXQUATERNION *pOut, const D3DXMATRIX *pM)
+ColorFromARGBFunc SelectColorFromARGB()
 {
-    assert(pOut != nullptr);
-    assert(pM   != nullptr);
-
-    auto mat = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMQuaternionRotationMatrix(mat);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+#if defined(_XM_SSE_INTRINSICS_)
+    return GetCpuFeatures().AVX2 ? ColorFromARGBAVX2 : ColorFromARGBSSE2;
+#else
+    return ColorFromARGBScalar;
+#endif
 }
 
-// Rotation about arbitrary axis.
-D3DXQUATERNION* STUB_API D3DXQuaternionRotationAxis
-(
-    D3DXQUATERNION*     pOut,
-    const D3DXVECTOR3*  pV,
-    float               Angle
-)
+ColorToARGBFunc SelectColorToARGB()
 {
-    assert(pOut != nullptr);
-    assert(pV   != nullptr);
-
-    auto v   = DirectX::XMLoadFloat3(pV);
-    auto ret = DirectX::XMQuaternionRotationAxis(v, Angle);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+#if defined(_XM_SSE_INTRINSICS_)
+    return GetCpuFeatures().AVX2 ? ColorToARGBAVX2 : ColorToARGBSSE2;
+#else
+    return ColorToARGBScalar;
+#endif
 }
 
-// Yaw around the Y axis, a pitch around the X axis,
-// and a roll around the Z axis.
-D3DXQUATERNION* STUB_API D3DXQuaternionRotationYawPitchRoll
-(
-    D3DXQUATERNION* pOut,
-    float           Yaw,
-    float           Pitch,
-    float           Roll
-)
+void ColorFromARGB(D3DXCOLOR* pOut, const uint32_t* pIn, size_t n, D3DXCOLORSPACE colorSpace, bool parallel)
 {
-    assert(pOut != nullptr);
+    assert(colorSpace == D3DXCOLORSPACE_LINEAR || colorSpace == D3DXCOLORSPACE_SRGB);
 
-    auto ret = DirectX::XMQuaternionRotationRollPitchYaw(Pitch, Yaw, Roll);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+    static const auto pConvert = SelectColorFromARGB();
+    const bool srgb = (colorSpace == D3DXCOLORSPACE_SRGB);
+
+    if (!parallel || n < D3DX_PARALLEL_THRESHOLD)
+    {
+        pConvert(pOut, pIn, n, srgb);
+        return;
+    }
+
+    ParallelFor(n, GetChunkSize(sizeof(D3DXCOLOR) + sizeof(uint32_t)), [&](size_t begin, size_t end)
+    { pConvert(pOut + begin, pIn + begin, end - begin, srgb); });
 }
 
-// Quaternion multiplication.  The result represents the rotation Q2
-// followed by the rotation Q1.  (Out = Q2 * Q1)
-D3DXQUATERNION* STUB_API D3DXQuaternionMultiply
-(
-    D3DXQUATERNION*         pOut,
-    const D3DXQUATERNION*   pQ1,
-    const D3DXQUATERNION*   pQ2
-)
+void ColorToARGB(uint32_t* pOut, const D3DXCOLOR* pIn, size_t n, D3DXCOLORSPACE colorSpace, bool parallel)
 {
-    assert(pOut != nullptr);
-    assert(pQ1  != nullptr);
-    assert(pQ2  != nullptr);
+    assert(colorSpace == D3DXCOLORSPACE_LINEAR || colorSpace == D3DXCOLORSPACE_SRGB);
 
-    auto q1 = DirectX::XMLoadFloat4(pQ1);
-    auto q2 = DirectX::XMLoadFloat4(pQ2);
-    auto ret = DirectX::XMQuaternionMultiply(q1, q2);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+    static const auto pConvert = SelectColorToARGB();
+    const bool srgb = (colorSpace == D3DXCOLORSPACE_SRGB);
+
+    if (!parallel || n < D3DX_PARALLEL_THRESHOLD)
+    {
+        pConvert(pOut, pIn, n, srgb);
+        return;
+    }
+
+    ParallelFor(n, GetChunkSize(sizeof(D3DXCOLOR) + sizeof(uint32_t)), [&](size_t begin, size_t end)
+    { pConvert(pOut + begin, pIn + begin, end - begin, srgb); });
 }
 
-D3DXQUATERNION* STUB_API D3DXQuaternionNormalize(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+} // anonymous namespace
+
+D3DXCOLOR* STUB_API D3DXColorFromARGBArray(D3DXCOLOR* pOut, const uint32_t* pIn, uint32_t n, D3DXCOLORSPACE ColorSpace)
 {
     assert(pOut != nullptr);
-    assert(pQ   != nullptr);
+    assert(pIn  != nullptr);
 
-    auto quat = DirectX::XMLoadFloat4(pQ);
-    auto ret  = DirectX::XMQuaternionNormalize(quat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    ColorFromARGB(pOut, pIn, n, ColorSpace, false);
     return pOut;
 }
 
-// Conjugate and re-norm
-D3DXQUATERNION* STUB_API D3DXQuaternionInverse(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+uint32_t* STUB_API D3DXColorToARGBArray(uint32_t* pOut, const D3DXCOLOR* pIn, uint32_t n, D3DXCOLORSPACE ColorSpace)
 {
     assert(pOut != nullptr);
-    assert(pQ   != nullptr);
+    assert(pIn  != nullptr);
 
-    auto quat = DirectX::XMLoadFloat4(pQ);
-    auto ret  = DirectX::XMQuaternionInverse(quat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    ColorToARGB(pOut, pIn, n, ColorSpace, false);
     return pOut;
 }
 
-// Expects unit quaternions.
-// if q = (cos(theta), sin(theta) * v); ln(q) = (0, theta * v)
-D3DXQUATERNION* STUB_API D3DXQuaternionLn(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+// Multithreaded version. Small arrays stay on the calling thread.
+D3DXCOLOR* STUB_API D3DXColorFromARGBArrayParallel(D3DXCOLOR* pOut, const uint32_t* pIn, uint32_t n, D3DXCOLORSPACE ColorSpace)
 {
     assert(pOut != nullptr);
-    assert(pQ   != nullptr);
+    assert(pIn  != nullptr);
 
-    auto quat = DirectX::XMLoadFloat4(pQ);
-    auto ret  = DirectX::XMQuaternionLn(quat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    ColorFromARGB(pOut, pIn, n, ColorSpace, true);
     return pOut;
 }
 
-// Expects pure quaternions. (w == 0)  w is ignored in calculation.
-// if q = (0, theta * v); exp(q) = (cos(theta), sin(theta) * v)
-D3DXQUATERNION* STUB_API D3DXQuaternionExp(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+// Multithreaded version. Small arrays stay on the calling thread.
+uint32_t* STUB_API D3DXColorToARGBArrayParallel(uint32_t* pOut, const D3DXCOLOR* pIn, uint32_t n, D3DXCOLORSPACE ColorSpace)
 {
     assert(pOut != nullptr);
-    assert(pQ   != nullptr);
+    assert(pIn  != nullptr);
 
-    auto quat = DirectX::XMLoadFloat4(pQ);
-    auto ret  = DirectX::XMQuaternionExp(quat);
-    DirectX::XMStoreFloat4(pOut, ret);
+    ColorToARGB(pOut, pIn, n, ColorSpace, true);
     return pOut;
 }
-      
-// Spherical linear interpolation between Q1 (t == 0) and Q2 (t == 1).
-// Expects unit quaternions.
-D3DXQUATERNION* STUB_API D3DXQuaternionSlerp
-(
-    D3DXQUATERNION*         pOut,
-    const D3DXQUATERNION*   pQ1,
-    const D3DXQUATERNION*   pQ2,
-    float                   t
-)
+
+namespace /* anonymous */ {
+
+const uint32_t kColorTileWidth    = 256; // 1回に変換する画素数. 4の倍数にする.
+const size_t   kColorTileGrain    = 4;   // 並列版の1チャンクで処理するタイル数.
+const uint32_t kColorTileOperands = 2;   // スタック上のバッファに置ける演算の画像の数.
+
+size_t GetColorTexelSize(D3DXCOLORFORMAT format)
 {
-    assert(pOut != nullptr);
-    assert(pQ1  != nullptr);
-    assert(pQ2  != nullptr);
+    switch (format)
+    {
+    case D3DXCOLORFORMAT_A32B32G32R32F: return sizeof(D3DXCOLOR);
+    case D3DXCOLORFORMAT_A16B16G16R16F: return sizeof(D3DXFLOAT16) * 4;
+    case D3DXCOLORFORMAT_A8R8G8B8:
+    case D3DXCOLORFORMAT_A8R8G8B8_SRGB: return sizeof(uint32_t);
+    }
+    return 0;
+}
 
-    auto q1  = DirectX::XMLoadFloat4(pQ1);
-    auto q2  = DirectX::XMLoadFloat4(pQ2);
-    auto ret = DirectX::XMQuaternionSlerp(q1, q2, t);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+bool IsValidColorImage(const D3DXCOLORIMAGE& image, uint32_t width, uint32_t height)
+{
+    const auto texelSize = GetColorTexelSize(image.Format);
+    return image.pBits != nullptr
+        && texelSize   != 0
+        && image.Width  == width
+        && image.Height == height
+        && image.Pitch  >= width * texelSize;
 }
 
-// Spherical quadrangle interpolation.
-// Slerp(Slerp(Q1, C, t), Slerp(A, B, t), 2t(1-t))
-D3DXQUATERNION* STUB_API D3DXQuaternionSquad
-(
-    D3DXQUATERNION*         pOut,
-    const D3DXQUATERNION*   pQ1,
-    const D3DXQUATERNION*   pA,
-    const D3DXQUATERNION*   pB,
-    const D3DXQUATERNION*   pC,
-    float                   t
-)
+// 行 y の [x, x + count) を D3DXCOLOR に変換する.
+void LoadColorRow(const D3DXCOLORIMAGE& image, uint32_t x, uint32_t y, uint32_t count, D3DXCOLOR* pOut)
 {
-    assert(pOut != nullptr);
-    assert(pQ1  != nullptr);
-    assert(pA   != nullptr);
-    assert(pB   != nullptr);
-    assert(pC   != nullptr);
+    auto pRow = static_cast<const uint8_t*>(image.pBits) + size_t(y) * image.Pitch + x * GetColorTexelSize(image.Format);
+    switch (image.Format)
+    {
+    case D3DXCOLORFORMAT_A32B32G32R32F:
+        memcpy(pOut, pRow, count * sizeof(D3DXCOLOR));
+        break;
 
-    auto q1  = DirectX::XMLoadFloat4(pQ1);
-    auto a   = DirectX::XMLoadFloat4(pA);
-    auto b   = DirectX::XMLoadFloat4(pB);
-    auto c   = DirectX::XMLoadFloat4(pC);
-    auto ret = DirectX::XMQuaternionSquad(q1, a, b, c, t);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
+    case D3DXCOLORFORMAT_A16B16G16R16F:
+        D3DXFloat16To32Array(&pOut->r, reinterpret_cast<const D3DXFLOAT16*>(pRow), count * 4);
+        break;
+
+    case D3DXCOLORFORMAT_A8R8G8B8:
+        ColorFromARGB(pOut, reinterpret_cast<const uint32_t*>(pRow), count, D3DXCOLORSPACE_LINEAR, false);
+        break;
+
+    case D3DXCOLORFORMAT_A8R8G8B8_SRGB:
+        ColorFromARGB(pOut, reinterpret_cast<const uint32_t*>(pRow), count, D3DXCOLORSPACE_SRGB, false);
+        break;
+    }
 }
 
-// Setup control points for spherical quadrangle interpolation
-// from Q1 to Q2.  The control points are chosen in such a way 
-// to ensure the continuity of tangents with adjacent segments.
-void STUB_API D3DXQuaternionSquadSetup
-(
-    D3DXQUATERNION*         pAOut,
-    D3DXQUATERNION*         pBOut,
-    D3DXQUATERNION*         pCOut,
-    const D3DXQUATERNION*   pQ0,
-    const D3DXQUATERNION*   pQ1, 
-    const D3DXQUATERNION*   pQ2,
-    const D3DXQUATERNION*   pQ3
-)
+void StoreColorRow(const D3DXCOLORIMAGE& image, uint32_t x, uint32_t y, uint32_t count, const D3DXCOLOR* pIn)
 {
-    assert(pAOut != nullptr);
-    assert(pBOut != nullptr);
-    assert(pCOut != nullptr);
-    assert(pQ0   != nullptr);
-    assert(pQ1   != nullptr);
-    assert(pQ2   != nullptr);
-    assert(pQ3   != nullptr);
-
-    auto q0 = DirectX::XMLoadFloat4(pQ0);
-    auto q1 = DirectX::XMLoadFloat4(pQ1);
-    auto q2 = DirectX::XMLoadFloat4(pQ2);
-    auto q3 = DirectX::XMLoadFloat4(pQ3);
-
-    DirectX::XMVECTOR a, b, c;
-    DirectX::XMQuaternionSquadSetup(&a, &b, &c, q0, q1, q2, q3);
-    DirectX::XMStoreFloat4(pAOut, a);
-    DirectX::XMStoreFloat4(pBOut, b);
-    DirectX::XMStoreFloat4(pCOut, c);
-}
-
-// Barycentric interpolation.
-// Slerp(Slerp(Q1, Q2, f+g), Slerp(Q1, Q3, f+g), g/(f+g))
-D3DXQUATERNION* STUB_API D3DXQuaternionBaryCentric
-(
-    D3DXQUATERNION*         pOut,
-    const D3DXQUATERNION*   pQ1,
-    const D3DXQUATERNION*   pQ2,
-    const D3DXQUATERNION*   pQ3,
-    float                   f,
-    float                   g
-)
-{
-    assert(pOut != nullptr);
-    assert(pQ1  != nullptr);
-    assert(pQ2  != nullptr);
-    assert(pQ3  != nullptr);
-
-    auto q1  = DirectX::XMLoadFloat4(pQ1);
-    auto q2  = DirectX::XMLoadFloat4(pQ2);
-    auto q3  = DirectX::XMLoadFloat4(pQ3);
-    auto ret = DirectX::XMQuaternionBaryCentric(q1, q2, q3, f, g);
-    DirectX::XMStoreFloat4(pOut, ret);
-    return pOut;
-}
+    auto pRow = static_cast<uint8_t*>(image.pBits) + size_t(y) * image.Pitch + x * GetColorTexelSize(image.Format);
+    switch (image.Format)
+    {
+    case D3DXCOLORFORMAT_A32B32G32R32F:
+        memcpy(pRow, pIn, count * sizeof(D3DXCOLOR));
+        break;
 
+    case D3DXCOLORFORMAT_A16B16G16R16F:
+        D3DXFloat32To16Array(reinterpret_cast<D3DXFLOAT16*>(pRow), &pIn->r, count * 4);
+        break;
 
-///////////////////////////////////////////////////////////////////////////////
-// D3DXPLANE
-///////////////////////////////////////////////////////////////////////////////
+    case D3DXCOLORFORMAT_A8R8G8B8:
+        ColorToARGB(reinterpret_cast<uint32_t*>(pRow), pIn, count, D3DXCOLORSPACE_LINEAR, false);
+        break;
+
+    case D3DXCOLORFORMAT_A8R8G8B8_SRGB:
+        ColorToARGB(reinterpret_cast<uint32_t*>(pRow), pIn, count, D3DXCOLORSPACE_SRGB, false);
+        break;
+    }
+}
 
-// Normalize plane (so that |a,b,c| == 1)
-D3DXPLANE* STUB_API D3DXPlaneNormalize(D3DXPLANE *pOut, const D3DXPLANE *pP)
+// 4画素を成分ごとのレーンに並べたもの.
+struct ColorLanes
 {
-    assert(pOut != nullptr);
-    assert(pP   != nullptr);
+    DirectX::XMVECTOR   R;
+    DirectX::XMVECTOR   G;
+    DirectX::XMVECTOR   B;
+    DirectX::XMVECTOR   A;
+};
 
-    auto p   = DirectX::XMLoadFloat4((DirectX::XMFLOAT4*)pP);
-    auto ret = DirectX::XMPlaneNormalize(p);
-    DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
-    return pOut;
+inline ColorLanes LoadColorLanes(const D3DXCOLOR* pIn)
+{
+    const auto m = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(
+        DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn + 0)),
+        DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn + 1)),
+        DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn + 2)),
+        DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn + 3))));
+    return { m.r[0], m.r[1], m.r[2], m.r[3] };
 }
 
-// Find the intersection between a plane and a line.  If the line is
-// parallel to the plane, NULL is returned.
-D3DXVECTOR3* STUB_API D3DXPlaneIntersectLine
-(
-    D3DXVECTOR3*        pOut,
-    const D3DXPLANE*    pP,
-    const D3DXVECTOR3*  pV1,
-    const D3DXVECTOR3*  pV2
-)
+inline void StoreColorLanes(D3DXCOLOR* pOut, const ColorLanes& c)
 {
-    assert(pOut != nullptr);
-    assert(pP   != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-
-    auto p   = DirectX::XMLoadFloat4((DirectX::XMFLOAT4*)pP);
-    auto v1  = DirectX::XMLoadFloat3(pV1);
-    auto v2  = DirectX::XMLoadFloat3(pV2);
-    auto ret = DirectX::XMPlaneIntersectLine(p, v1, v2);
-    DirectX::XMStoreFloat3(pOut, ret);
-    return pOut;
+    const auto m = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(c.R, c.G, c.B, c.A));
+    for (auto i = 0; i < 4; ++i)
+    { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(pOut + i), m.r[i]); }
 }
 
-// Construct a plane from a point and a normal
-D3DXPLANE* STUB_API D3DXPlaneFromPointNormal
-(
-    D3DXPLANE*          pOut,
-    const D3DXVECTOR3*  pPoint,
-    const D3DXVECTOR3*  pNormal
-)
+// 1つの演算を4画素に適用する. 彩度とコントラストはアルファを変えない.
+inline void ApplyColorOp(const D3DXCOLOROP& op, const ColorLanes& operand, ColorLanes& c)
 {
-    assert(pOut    != nullptr);
-    assert(pPoint  != nullptr);
-    assert(pNormal != nullptr);
+    using namespace DirectX;
 
-    auto p   = DirectX::XMLoadFloat3(pPoint);
-    auto n   = DirectX::XMLoadFloat3(pNormal);
-    auto ret = DirectX::XMPlaneFromPointNormal(p, n);
-    DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
-    return pOut;
+    const auto s = XMVectorReplicate(op.Factor);
+    switch (op.Type)
+    {
+    case D3DXCOLOROP_ADJUSTSATURATION:
+        {
+            const auto lum = XMVectorAdd(
+                XMVectorAdd(XMVectorScale(c.R, 0.2125f), XMVectorScale(c.G, 0.7154f)),
+                XMVectorScale(c.B, 0.0721f));
+            c.R = XMVectorMultiplyAdd(XMVectorSubtract(c.R, lum), s, lum);
+            c.G = XMVectorMultiplyAdd(XMVectorSubtract(c.G, lum), s, lum);
+            c.B = XMVectorMultiplyAdd(XMVectorSubtract(c.B, lum), s, lum);
+        }
+        break;
+
+    case D3DXCOLOROP_ADJUSTCONTRAST:
+        {
+            const auto half = XMVectorReplicate(0.5f);
+            c.R = XMVectorMultiplyAdd(XMVectorSubtract(c.R, half), s, half);
+            c.G = XMVectorMultiplyAdd(XMVectorSubtract(c.G, half), s, half);
+            c.B = XMVectorMultiplyAdd(XMVectorSubtract(c.B, half), s, half);
+        }
+        break;
+
+    case D3DXCOLOROP_MODULATE:
+        c.R = XMVectorMultiply(c.R, operand.R);
+        c.G = XMVectorMultiply(c.G, operand.G);
+        c.B = XMVectorMultiply(c.B, operand.B);
+        c.A = XMVectorMultiply(c.A, operand.A);
+        break;
+
+    case D3DXCOLOROP_LERP:
+        c.R = XMVectorAdd(c.R, XMVectorMultiply(s, XMVectorSubtract(operand.R, c.R)));
+        c.G = XMVectorAdd(c.G, XMVectorMultiply(s, XMVectorSubtract(operand.G, c.G)));
+        c.B = XMVectorAdd(c.B, XMVectorMultiply(s, XMVectorSubtract(operand.B, c.B)));
+        c.A = XMVectorAdd(c.A, XMVectorMultiply(s, XMVectorSubtract(operand.A, c.A)));
+        break;
+    }
 }
 
-// Construct a plane from 3 points
-D3DXPLANE* STUB_API D3DXPlaneFromPoints
-(
-    D3DXPLANE*          pOut,
-    const D3DXVECTOR3*  pV1,
-    const D3DXVECTOR3*  pV2,
-    const D3DXVECTOR3*  pV3
-)
+struct ColorImageJob
 {
-    assert(pOut != nullptr);
-    assert(pV1  != nullptr);
-    assert(pV2  != nullptr);
-    assert(pV3  != nullptr);
-
-    auto v1  = DirectX::XMLoadFloat3(pV1);
-    auto v2  = DirectX::XMLoadFloat3(pV2);
-    auto v3  = DirectX::XMLoadFloat3(pV3);
-    auto ret = DirectX::XMPlaneFromPoints(v1, v2, v3);
-    DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
-    return pOut;
-}
+    const D3DXCOLORIMAGE*   pDest;
+    const D3DXCOLORIMAGE*   pSrc;
+    const D3DXCOLOROP*      pOps;
+    uint32_t                NumOps;
+    uint32_t                OperandCount;   // pImage を持つ演算の数.
+    uint32_t                TilesPerRow;
+};
 
-// Transform a plane by a matrix.  The vector (a,b,c) must be normal.
-// M should be the inverse transpose of the transformation desired.
-D3DXPLANE* STUB_API D3DXPlaneTransform
-(
-    D3DXPLANE*          pOut,
-    const D3DXPLANE*    pP,
-    const D3DXMATRIX*   pM
-)
+// タイル [begin, end) を処理する. タイルは1行の kColorTileWidth 画素で, 行の順に番号を付ける.
+// タイルごとに読み込み, 全ての演算を適用してから書き出すので, 画像を1回しか読み書きしない.
+void ApplyColorTiles(const ColorImageJob& job, size_t begin, size_t end)
 {
-    assert(pOut != nullptr);
-    assert(pP   != nullptr);
-    assert(pM   != nullptr);
+    // 先頭がタイル, 続いて演算の画像の同じ範囲を置く.
+    // 演算の画像が少なければスタック上のバッファを使い, チャンクごとにヒープを確保しない.
+    D3DXCOLOR stackBuffer[kColorTileWidth * (1 + kColorTileOperands)];
+    std::vector<D3DXCOLOR> heapBuffer;
 
-    auto p   = DirectX::XMLoadFloat4((DirectX::XMFLOAT4*)pP);
-    auto m   = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMPlaneTransform(p, m);
-    DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
-    return pOut;
+    auto pTile = stackBuffer;
+    if (job.OperandCount > kColorTileOperands)
+    {
+        heapBuffer.resize(size_t(kColorTileWidth) * (1 + job.OperandCount));
+        pTile = heapBuffer.data();
+    }
+
+    for (auto t = begin; t < end; ++t)
+    {
+        const auto y     = uint32_t(t / job.TilesPerRow);
+        const auto x     = uint32_t(t % job.TilesPerRow) * kColorTileWidth;
+        const auto count = std::min(kColorTileWidth, job.pDest->Width - x);
+
+        LoadColorRow(*job.pSrc, x, y, count, pTile);
+        for (uint32_t k = 0, j = 0; k < job.NumOps; ++k)
+        {
+            if (job.pOps[k].pImage != nullptr)
+            { LoadColorRow(*job.pOps[k].pImage, x, y, count, pTile + size_t(++j) * kColorTileWidth); }
+        }
+
+        // 端数の画素も4画素単位で計算し, 書き出す時に捨てる. 余りのレーンは 0 で埋めておく.
+        const auto padded = (count + 3) & ~3u;
+        for (uint32_t j = 0; j <= job.OperandCount; ++j)
+        {
+            for (auto i = count; i < padded; ++i)
+            { pTile[size_t(j) * kColorTileWidth + i] = D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f); }
+        }
+
+        for (uint32_t i = 0; i < count; i += 4)
+        {
+            auto c = LoadColorLanes(pTile + i);
+            for (uint32_t k = 0, j = 0; k < job.NumOps; ++k)
+            {
+                const auto& op = job.pOps[k];
+
+                ColorLanes operand = {};
+                if (op.pImage != nullptr)
+                { operand = LoadColorLanes(pTile + size_t(++j) * kColorTileWidth + i); }
+                else if (op.Type == D3DXCOLOROP_MODULATE || op.Type == D3DXCOLOROP_LERP)
+                {
+                    operand.R = DirectX::XMVectorReplicate(op.Color.r);
+                    operand.G = DirectX::XMVectorReplicate(op.Color.g);
+                    operand.B = DirectX::XMVectorReplicate(op.Color.b);
+                    operand.A = DirectX::XMVectorReplicate(op.Color.a);
+                }
+
+                ApplyColorOp(op, operand, c);
+            }
+            StoreColorLanes(pTile + i, c);
+        }
+
+        StoreColorRow(*job.pDest, x, y, count, pTile);
+    }
 }
-    
-// Transform an array of planes by a matrix.  The vectors (a,b,c) must be normal.
-// M should be the inverse transpose of the transformation desired.
-D3DXPLANE* STUB_API D3DXPlaneTransformArray
+
+HRESULT ApplyColorImage
 (
-    D3DXPLANE*          pOut,
-    uint32_t            OutStride,
-    const D3DXPLANE*    pP,
-    uint32_t            PStride,
-    const D3DXMATRIX*   pM,
-    uint32_t            n
+    const D3DXCOLORIMAGE*   pDest,
+    const D3DXCOLORIMAGE*   pSrc,
+    const D3DXCOLOROP*      pOps,
+    uint32_t                numOps,
+    bool                    parallel
 )
 {
-    assert(pOut != nullptr);
-    assert(pP   != nullptr);
-    assert(pM   != nullptr);
-    
-    auto m   = DirectX::XMLoadFloat4x4(pM);
-    auto ret = DirectX::XMPlaneTransformStream(
-        (DirectX::XMFLOAT4*)pOut, OutStride, (DirectX::XMFLOAT4*)pP, PStride, n, m);
-    return pOut;
-}
+    if (!pDest || (!pOps && numOps > 0))
+        return kD3DERR_INVALIDCALL;
 
+    if (!pSrc)
+    { pSrc = pDest; }
 
-///////////////////////////////////////////////////////////////////////////////
-// D3DXCOLOR
-///////////////////////////////////////////////////////////////////////////////
+    const auto width  = pDest->Width;
+    const auto height = pDest->Height;
+    if (!IsValidColorImage(*pDest, width, height) || !IsValidColorImage(*pSrc, width, height))
+        return kD3DERR_INVALIDCALL;
 
-// Interpolate r,g,b between desaturated color and color.
-// DesaturatedColor + s(Color - DesaturatedColor)
-D3DXCOLOR* STUB_API D3DXColorAdjustSaturation(D3DXCOLOR *pOut, const D3DXCOLOR *pC, float s)
-{
-    assert(pOut != nullptr);
+    // 画像を演算対象に持てるのは MODULATE と LERP だけ.
+    uint32_t operandCount = 0;
+    for (uint32_t k = 0; k < numOps; ++k)
+    {
+        const auto& op = pOps[k];
+        switch (op.Type)
+        {
+        case D3DXCOLOROP_ADJUSTSATURATION:
+        case D3DXCOLOROP_ADJUSTCONTRAST:
+            if (op.pImage != nullptr)
+                return kD3DERR_INVALIDCALL;
+            break;
 
-    auto c   = DirectX::XMLoadFloat4((DirectX::XMFLOAT4*)pC);
-    auto ret = DirectX::XMColorAdjustSaturation(c, s);
-    DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
-    return pOut;
-}
+        case D3DXCOLOROP_MODULATE:
+        case D3DXCOLOROP_LERP:
+            if (op.pImage != nullptr)
+            {
+                if (!IsValidColorImage(*op.pImage, width, height))
+                    return kD3DERR_INVALIDCALL;
+                operandCount++;
+            }
+            break;
 
-// Interpolate r,g,b between 50% grey and color.  Grey + s(Color - Grey)
-D3DXCOLOR* STUB_API D3DXColorAdjustContrast(D3DXCOLOR *pOut, const D3DXCOLOR *pC, float c)
-{
-    assert(pOut != nullptr);
-    assert(pC   != nullptr);
+        default:
+            return kD3DERR_INVALIDCALL;
+        }
+    }
 
-    auto vc  = DirectX::XMLoadFloat4((DirectX::XMFLOAT4*)pC);
-    auto ret = DirectX::XMColorAdjustContrast(vc, c);
-    DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
-    return pOut;
+    ColorImageJob job;
+    job.pDest        = pDest;
+    job.pSrc         = pSrc;
+    job.pOps         = pOps;
+    job.NumOps       = numOps;
+    job.OperandCount = operandCount;
+    job.TilesPerRow  = (width + kColorTileWidth - 1) / kColorTileWidth;
+
+    const size_t tileCount = size_t(job.TilesPerRow) * height;
+    if (parallel && size_t(width) * height >= D3DX_PARALLEL_THRESHOLD)
+    {
+        ParallelFor(tileCount, kColorTileGrain, [&](size_t begin, size_t end)
+        { ApplyColorTiles(job, begin, end); });
+    }
+    else
+    { ApplyColorTiles(job, 0, tileCount); }
+
+    return kD3D_OK;
 }
 
+} // anonymous namespace
+
+HRESULT STUB_API D3DXColorImageApply
+(
+    const D3DXCOLORIMAGE*   pDest,
+    const D3DXCOLORIMAGE*   pSrc,
+    const D3DXCOLOROP*      pOps,
+    uint32_t                NumOps
+)
+{ return ApplyColorImage(pDest, pSrc, pOps, NumOps, false); }
+
+HRESULT STUB_API D3DXColorImageApplyParallel
+(
+    const D3DXCOLORIMAGE*   pDest,
+    const D3DXCOLORIMAGE*   pSrc,
+    const D3DXCOLOROP*      pOps,
+    uint32_t                NumOps
+)
+{ return ApplyColorImage(pDest, pSrc, pOps, NumOps, true); }
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Misc
@@ -1749,6 +7221,22 @@ float STUB_API D3DXFresnelTerm(float CosTheta, float RefractionIndex)
     return DirectX::XMVectorGetX(ret);
 }
 
+// Set the number of threads used by the multithreaded array APIs.
+void STUB_API D3DXSetWorkerThreadCount(uint32_t ThreadCount)
+{
+    std::lock_guard<std::mutex> lock(g_WorkerPoolMutex);
+    if (g_WorkerThreadCount == ThreadCount)
+        return;
+
+    // 次回使用時に作り直す.
+    g_WorkerThreadCount = ThreadCount;
+    g_pWorkerPool.reset();
+}
+
+// Get the number of threads used by the multithreaded array APIs.
+uint32_t STUB_API D3DXGetWorkerThreadCount()
+{ return GetWorkerPool()->GetThreadCount(); }
+
 ///////////////////////////////////////////////////////////////////////////////
 // Spherical Harmonics
 ///////////////////////////////////////////////////////////////////////////////
@@ -1830,66 +7318,100 @@ const float SHEvalHemisphereLight_fSqrtPi3 = sqrtf(DirectX::XM_PI / 3.0f);
 using REAL = float;
 #define CONSTANT(x) (x ## f)
 
-inline void sh_eval_basis_1(REAL x, REAL y, REAL z, REAL b[4])
+///////////////////////////////////////////////////////////////////////////////
+// SHLane4 structure
+///////////////////////////////////////////////////////////////////////////////
+// 独立した4組の計算をまとめて行うための型.
+// sh_eval_basis_* や SHMultiply* のテンプレート引数として float の代わりに使う.
+struct SHLane4
+{
+    DirectX::XMVECTOR   v;
+
+    SHLane4() = default;
+    SHLane4(float s) : v(DirectX::XMVectorReplicate(s)) {}
+    explicit SHLane4(DirectX::FXMVECTOR value) : v(value) {}
+};
+
+inline SHLane4 operator + (const SHLane4& a, const SHLane4& b)
+{ return SHLane4(DirectX::XMVectorAdd(a.v, b.v)); }
+
+inline SHLane4 operator - (const SHLane4& a, const SHLane4& b)
+{ return SHLane4(DirectX::XMVectorSubtract(a.v, b.v)); }
+
+inline SHLane4 operator * (const SHLane4& a, const SHLane4& b)
+{ return SHLane4(DirectX::XMVectorMultiply(a.v, b.v)); }
+
+inline SHLane4 operator * (float s, const SHLane4& a)
+{ return SHLane4(DirectX::XMVectorScale(a.v, s)); }
+
+inline SHLane4& operator += (SHLane4& a, const SHLane4& b)
+{
+    a.v = DirectX::XMVectorAdd(a.v, b.v);
+    return a;
+}
+
+template<typename T>
+inline void sh_eval_basis_1(T x, T y, T z, T b[4])
 {
     /* m=0 */
 
     // l=0
-    const REAL p_0_0 = CONSTANT(0.282094791773878140);
+    const T p_0_0 = CONSTANT(0.282094791773878140);
     b[0] = p_0_0; // l=0,m=0
     // l=1
-    const REAL p_1_0 = CONSTANT(0.488602511902919920) * z;
+    const T p_1_0 = CONSTANT(0.488602511902919920) * z;
     b[2] = p_1_0; // l=1,m=0
 
     /* m=1 */
-    const REAL s1 = y;
-    const REAL c1 = x;
+    const T s1 = y;
+    const T c1 = x;
 
     // l=1
-    const REAL p_1_1 = CONSTANT(-0.488602511902919920);
+    const T p_1_1 = CONSTANT(-0.488602511902919920);
     b[1] = p_1_1 * s1; // l=1,m=-1
     b[3] = p_1_1 * c1; // l=1,m=+1
 }
 
-inline void sh_eval_basis_2(REAL x, REAL y, REAL z, REAL b[9])
+template<typename T>
+inline void sh_eval_basis_2(T x, T y, T z, T b[9])
 {
-    const REAL z2 = z * z;
+    const T z2 = z * z;
 
     /* m=0 */
 
     // l=0
-    const REAL p_0_0 = CONSTANT(0.282094791773878140);
+    const T p_0_0 = CONSTANT(0.282094791773878140);
     b[0] = p_0_0; // l=0,m=0
     // l=1
-    const REAL p_1_0 = CONSTANT(0.488602511902919920) * z;
+    const T p_1_0 = CONSTANT(0.488602511902919920) * z;
     b[2] = p_1_0; // l=1,m=0
     // l=2
-    const REAL p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
+    const T p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
     b[6] = p_2_0; // l=2,m=0
 
 
     /* m=1 */
 
-    const REAL s1 = y;
-    const REAL c1 = x;
+    const T s1 = y;
+    const T c1 = x;
 
     // l=1
-    const REAL p_1_1 = CONSTANT(-0.488602511902919920);
+    const T p_1_1 = CONSTANT(-0.488602511902919920);
     b[1] = p_1_1 * s1; // l=1,m=-1
     b[3] = p_1_1 * c1; // l=1,m=+1
     // l=2
-    const REAL p_2_1 = CONSTANT(-1.092548430592079200) * z;
+    const T p_2_1 = CONSTANT(-1.092548430592079200) * z;
     b[5] = p_2_1 * s1; // l=2,m=-1
     b[7] = p_2_1 * c1; // l=2,m=+1
 
 
     /* m=2 */
 
-    const REAL s2 = x * s1 + y * c1;
-    const REAL c2 = x * c1 - y * s1;
+    const T s2 = x * s1 + y * c1;
+    const T c2 = x * c1 - y * s1;
 
     // l=2
-    const REAL p_2_2 = CONSTANT(0.546274215296039590);
+    const T p_2_2 = CONSTANT(0.546274215296039590);
     b[4] = p_2_2 * s2; // l=2,m=-2
     b[8] = p_2_2 * c2; // l=2,m=+2
 }
@@ -1898,68 +7420,69 @@ inline void sh_eval_basis_2(REAL x, REAL y, REAL z, REAL b[9])
 // inputs (x,y,z) are a point on the sphere (i.e., must be unit length)
 // output is vector b with SH basis evaluated at (x,y,z).
 //
-void sh_eval_basis_3(REAL x, REAL y, REAL z, REAL b[16])
+template<typename T>
+inline void sh_eval_basis_3(T x, T y, T z, T b[16])
 {
-    const REAL z2 = z * z;
+    const T z2 = z * z;
 
 
     /* m=0 */
 
     // l=0
-    const REAL p_0_0 = CONSTANT(0.282094791773878140);
+    const T p_0_0 = CONSTANT(0.282094791773878140);
     b[0] = p_0_0; // l=0,m=0
     // l=1
-    const REAL p_1_0 = CONSTANT(0.488602511902919920) * z;
+    const T p_1_0 = CONSTANT(0.488602511902919920) * z;
     b[2] = p_1_0; // l=1,m=0
     // l=2
-    const REAL p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
+    const T p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
     b[6] = p_2_0; // l=2,m=0
     // l=3
-    const REAL p_3_0 = z * (CONSTANT(1.865881662950577000) * z2 + CONSTANT(-1.119528997770346200));
+    const T p_3_0 = z * (CONSTANT(1.865881662950577000) * z2 + CONSTANT(-1.119528997770346200));
     b[12] = p_3_0; // l=3,m=0
 
 
     /* m=1 */
 
-    const REAL s1 = y;
-    const REAL c1 = x;
+    const T s1 = y;
+    const T c1 = x;
 
     // l=1
-    const REAL p_1_1 = CONSTANT(-0.488602511902919920);
+    const T p_1_1 = CONSTANT(-0.488602511902919920);
     b[1] = p_1_1 * s1; // l=1,m=-1
     b[3] = p_1_1 * c1; // l=1,m=+1
     // l=2
-    const REAL p_2_1 = CONSTANT(-1.092548430592079200) * z;
+    const T p_2_1 = CONSTANT(-1.092548430592079200) * z;
     b[5] = p_2_1 * s1; // l=2,m=-1
     b[7] = p_2_1 * c1; // l=2,m=+1
     // l=3
-    const REAL p_3_1 = CONSTANT(-2.285228997322328800) * z2 + CONSTANT(0.457045799464465770);
+    const T p_3_1 = CONSTANT(-2.285228997322328800) * z2 + CONSTANT(0.457045799464465770);
     b[11] = p_3_1 * s1; // l=3,m=-1
     b[13] = p_3_1 * c1; // l=3,m=+1
 
 
     /* m=2 */
 
-    const REAL s2 = x * s1 + y * c1;
-    const REAL c2 = x * c1 - y * s1;
+    const T s2 = x * s1 + y * c1;
+    const T c2 = x * c1 - y * s1;
 
     // l=2
-    const REAL p_2_2 = CONSTANT(0.546274215296039590);
+    const T p_2_2 = CONSTANT(0.546274215296039590);
     b[4] = p_2_2 * s2; // l=2,m=-2
     b[8] = p_2_2 * c2; // l=2,m=+2
     // l=3
-    const REAL p_3_2 = CONSTANT(1.445305721320277100) * z;
+    const T p_3_2 = CONSTANT(1.445305721320277100) * z;
     b[10] = p_3_2 * s2; // l=3,m=-2
     b[14] = p_3_2 * c2; // l=3,m=+2
 
 
     /* m=3 */
 
-    const REAL s3 = x * s2 + y * c2;
-    const REAL c3 = x * c2 - y * s2;
+    const T s3 = x * s2 + y * c2;
+    const T c3 = x * c2 - y * s2;
 
     // l=3
-    const REAL p_3_3 = CONSTANT(-0.590043589926643520);
+    const T p_3_3 = CONSTANT(-0.590043589926643520);
     b[9] = p_3_3 * s3; // l=3,m=-3
     b[15] = p_3_3 * c3; // l=3,m=+3
 }
@@ -1968,94 +7491,95 @@ void sh_eval_basis_3(REAL x, REAL y, REAL z, REAL b[16])
 // inputs (x,y,z) are a point on the sphere (i.e., must be unit length)
 // output is vector b with SH basis evaluated at (x,y,z).
 //
-void sh_eval_basis_4(REAL x, REAL y, REAL z, REAL b[25])
+template<typename T>
+inline void sh_eval_basis_4(T x, T y, T z, T b[25])
 {
-    const REAL z2 = z * z;
+    const T z2 = z * z;
 
 
     /* m=0 */
 
     // l=0
-    const REAL p_0_0 = CONSTANT(0.282094791773878140);
+    const T p_0_0 = CONSTANT(0.282094791773878140);
     b[0] = p_0_0; // l=0,m=0
     // l=1
-    const REAL p_1_0 = CONSTANT(0.488602511902919920) * z;
+    const T p_1_0 = CONSTANT(0.488602511902919920) * z;
     b[2] = p_1_0; // l=1,m=0
     // l=2
-    const REAL p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
+    const T p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
     b[6] = p_2_0; // l=2,m=0
     // l=3
-    const REAL p_3_0 = z * (CONSTANT(1.865881662950577000) * z2 + CONSTANT(-1.119528997770346200));
+    const T p_3_0 = z * (CONSTANT(1.865881662950577000) * z2 + CONSTANT(-1.119528997770346200));
     b[12] = p_3_0; // l=3,m=0
     // l=4
-    const REAL p_4_0 = CONSTANT(1.984313483298443000) * z * p_3_0 + CONSTANT(-1.006230589874905300) * p_2_0;
+    const T p_4_0 = CONSTANT(1.984313483298443000) * z * p_3_0 + CONSTANT(-1.006230589874905300) * p_2_0;
     b[20] = p_4_0; // l=4,m=0
 
 
     /* m=1 */
 
-    const REAL s1 = y;
-    const REAL c1 = x;
+    const T s1 = y;
+    const T c1 = x;
 
     // l=1
-    const REAL p_1_1 = CONSTANT(-0.488602511902919920);
+    const T p_1_1 = CONSTANT(-0.488602511902919920);
     b[1] = p_1_1 * s1; // l=1,m=-1
     b[3] = p_1_1 * c1; // l=1,m=+1
     // l=2
-    const REAL p_2_1 = CONSTANT(-1.092548430592079200) * z;
+    const T p_2_1 = CONSTANT(-1.092548430592079200) * z;
     b[5] = p_2_1 * s1; // l=2,m=-1
     b[7] = p_2_1 * c1; // l=2,m=+1
     // l=3
-    const REAL p_3_1 = CONSTANT(-2.285228997322328800) * z2 + CONSTANT(0.457045799464465770);
+    const T p_3_1 = CONSTANT(-2.285228997322328800) * z2 + CONSTANT(0.457045799464465770);
     b[11] = p_3_1 * s1; // l=3,m=-1
     b[13] = p_3_1 * c1; // l=3,m=+1
     // l=4
-    const REAL p_4_1 = z * (CONSTANT(-4.683325804901024000) * z2 + CONSTANT(2.007139630671867200));
+    const T p_4_1 = z * (CONSTANT(-4.683325804901024000) * z2 + CONSTANT(2.007139630671867200));
     b[19] = p_4_1 * s1; // l=4,m=-1
     b[21] = p_4_1 * c1; // l=4,m=+1
 
 
     /* m=2 */
 
-    const REAL s2 = x * s1 + y * c1;
-    const REAL c2 = x * c1 - y * s1;
+    const T s2 = x * s1 + y * c1;
+    const T c2 = x * c1 - y * s1;
 
     // l=2
-    const REAL p_2_2 = CONSTANT(0.546274215296039590);
+    const T p_2_2 = CONSTANT(0.546274215296039590);
     b[4] = p_2_2 * s2; // l=2,m=-2
     b[8] = p_2_2 * c2; // l=2,m=+2
     // l=3
-    const REAL p_3_2 = CONSTANT(1.445305721320277100) * z;
+    const T p_3_2 = CONSTANT(1.445305721320277100) * z;
     b[10] = p_3_2 * s2; // l=3,m=-2
     b[14] = p_3_2 * c2; // l=3,m=+2
     // l=4
-    const REAL p_4_2 = CONSTANT(3.311611435151459800) * z2 + CONSTANT(-0.473087347878779980);
+    const T p_4_2 = CONSTANT(3.311611435151459800) * z2 + CONSTANT(-0.473087347878779980);
     b[18] = p_4_2 * s2; // l=4,m=-2
     b[22] = p_4_2 * c2; // l=4,m=+2
 
 
     /* m=3 */
 
-    const REAL s3 = x * s2 + y * c2;
-    const REAL c3 = x * c2 - y * s2;
+    const T s3 = x * s2 + y * c2;
+    const T c3 = x * c2 - y * s2;
 
     // l=3
-    const REAL p_3_3 = CONSTANT(-0.590043589926643520);
+    const T p_3_3 = CONSTANT(-0.590043589926643520);
     b[9] = p_3_3 * s3; // l=3,m=-3
     b[15] = p_3_3 * c3; // l=3,m=+3
     // l=4
-    const REAL p_4_3 = CONSTANT(-1.770130769779930200) * z;
+    const T p_4_3 = CONSTANT(-1.770130769779930200) * z;
     b[17] = p_4_3 * s3; // l=4,m=-3
     b[23] = p_4_3 * c3; // l=4,m=+3
 
 
     /* m=4 */
 
-    const REAL s4 = x * s3 + y * c3;
-    const REAL c4 = x * c3 - y * s3;
+    const T s4 = x * s3 + y * c3;
+    const T c4 = x * c3 - y * s3;
 
     // l=4
-    const REAL p_4_4 = CONSTANT(0.625835735449176030);
+    const T p_4_4 = CONSTANT(0.625835735449176030);
     b[16] = p_4_4 * s4; // l=4,m=-4
     b[24] = p_4_4 * c4; // l=4,m=+4
 }
@@ -2064,124 +7588,125 @@ void sh_eval_basis_4(REAL x, REAL y, REAL z, REAL b[25])
 // inputs (x,y,z) are a point on the sphere (i.e., must be unit length)
 // output is vector b with SH basis evaluated at (x,y,z).
 //
-void sh_eval_basis_5(REAL x, REAL y, REAL z, REAL b[36])
+template<typename T>
+inline void sh_eval_basis_5(T x, T y, T z, T b[36])
 {
-    const REAL z2 = z * z;
+    const T z2 = z * z;
 
 
     /* m=0 */
 
     // l=0
-    const REAL p_0_0 = CONSTANT(0.282094791773878140);
+    const T p_0_0 = CONSTANT(0.282094791773878140);
     b[0] = p_0_0; // l=0,m=0
     // l=1
-    const REAL p_1_0 = CONSTANT(0.488602511902919920) * z;
+    const T p_1_0 = CONSTANT(0.488602511902919920) * z;
     b[2] = p_1_0; // l=1,m=0
     // l=2
-    const REAL p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
+    const T p_2_0 = CONSTANT(0.946174695757560080) * z2 + CONSTANT(-0.315391565252520050);
     b[6] = p_2_0; // l=2,m=0
     // l=3
-    const REAL p_3_0 = z * (CONSTANT(1.865881662950577000) * z2 + CONSTANT(-1.119528997770346200));
+    const T p_3_0 = z * (CONSTANT(1.865881662950577000) * z2 + CONSTANT(-1.119528997770346200));
     b[12] = p_3_0; // l=3,m=0
     // l=4
-    const REAL p_4_0 = CONSTANT(1.984313483298443000) * z * p_3_0 + CONSTANT(-1.006230589874905300) * p_2_0;
+    const T p_4_0 = CONSTANT(1.984313483298443000) * z * p_3_0 + CONSTANT(-1.006230589874905300) * p_2_0;
     b[20] = p_4_0; // l=4,m=0
     // l=5
-    const REAL p_5_0 = CONSTANT(1.989974874213239700) * z * p_4_0 + CONSTANT(-1.002853072844814000) * p_3_0;
+    const T p_5_0 = CONSTANT(1.989974874213239700) * z * p_4_0 + CONSTANT(-1.002853072844814000) * p_3_0;
     b[30] = p_5_0; // l=5,m=0
 
 
     /* m=1 */
 
-    const REAL s1 = y;
-    const REAL c1 = x;
+    const T s1 = y;
+    const T c1 = x;
 
     // l=1
-    const REAL p_1_1 = CONSTANT(-0.488602511902919920);
+    const T p_1_1 = CONSTANT(-0.488602511902919920);
     b[1] = p_1_1 * s1; // l=1,m=-1
     b[3] = p_1_1 * c1; // l=1,m=+1
     // l=2
-    const REAL p_2_1 = CONSTANT(-1.092548430592079200) * z;
+    const T p_2_1 = CONSTANT(-1.092548430592079200) * z;
     b[5] = p_2_1 * s1; // l=2,m=-1
     b[7] = p_2_1 * c1; // l=2,m=+1
     // l=3
-    const REAL p_3_1 = CONSTANT(-2.285228997322328800) * z2 + CONSTANT(0.457045799464465770);
+    const T p_3_1 = CONSTANT(-2.285228997322328800) * z2 + CONSTANT(0.457045799464465770);
     b[11] = p_3_1 * s1; // l=3,m=-1
     b[13] = p_3_1 * c1; // l=3,m=+1
     // l=4
-    const REAL p_4_1 = z * (CONSTANT(-4.683325804901024000) * z2 + CONSTANT(2.007139630671867200));
+    const T p_4_1 = z * (CONSTANT(-4.683325804901024000) * z2 + CONSTANT(2.007139630671867200));
     b[19] = p_4_1 * s1; // l=4,m=-1
     b[21] = p_4_1 * c1; // l=4,m=+1
     // l=5
-    const REAL p_5_1 = CONSTANT(2.031009601158990200) * z * p_4_1 + CONSTANT(-0.991031208965114650) * p_3_1;
+    const T p_5_1 = CONSTANT(2.031009601158990200) * z * p_4_1 + CONSTANT(-0.991031208965114650) * p_3_1;
     b[29] = p_5_1 * s1; // l=5,m=-1
     b[31] = p_5_1 * c1; // l=5,m=+1
 
 
     /* m=2 */
 
-    const REAL s2 = x * s1 + y * c1;
-    const REAL c2 = x * c1 - y * s1;
+    const T s2 = x * s1 + y * c1;
+    const T c2 = x * c1 - y * s1;
 
     // l=2
-    const REAL p_2_2 = CONSTANT(0.546274215296039590);
+    const T p_2_2 = CONSTANT(0.546274215296039590);
     b[4] = p_2_2 * s2; // l=2,m=-2
     b[8] = p_2_2 * c2; // l=2,m=+2
     // l=3
-    const REAL p_3_2 = CONSTANT(1.445305721320277100) * z;
+    const T p_3_2 = CONSTANT(1.445305721320277100) * z;
     b[10] = p_3_2 * s2; // l=3,m=-2
     b[14] = p_3_2 * c2; // l=3,m=+2
     // l=4
-    const REAL p_4_2 = CONSTANT(3.311611435151459800) * z2 + CONSTANT(-0.473087347878779980);
+    const T p_4_2 = CONSTANT(3.311611435151459800) * z2 + CONSTANT(-0.473087347878779980);
     b[18] = p_4_2 * s2; // l=4,m=-2
     b[22] = p_4_2 * c2; // l=4,m=+2
     // l=5
-    const REAL p_5_2 = z * (CONSTANT(7.190305177459987500) * z2 + CONSTANT(-2.396768392486662100));
+    const T p_5_2 = z * (CONSTANT(7.190305177459987500) * z2 + CONSTANT(-2.396768392486662100));
     b[28] = p_5_2 * s2; // l=5,m=-2
     b[32] = p_5_2 * c2; // l=5,m=+2
 
 
     /* m=3 */
 
-    const REAL s3 = x * s2 + y * c2;
-    const REAL c3 = x * c2 - y * s2;
+    const T s3 = x * s2 + y * c2;
+    const T c3 = x * c2 - y * s2;
 
     // l=3
-    const REAL p_3_3 = CONSTANT(-0.590043589926643520);
+    const T p_3_3 = CONSTANT(-0.590043589926643520);
     b[9] = p_3_3 * s3; // l=3,m=-3
     b[15] = p_3_3 * c3; // l=3,m=+3
     // l=4
-    const REAL p_4_3 = CONSTANT(-1.770130769779930200) * z;
+    const T p_4_3 = CONSTANT(-1.770130769779930200) * z;
     b[17] = p_4_3 * s3; // l=4,m=-3
     b[23] = p_4_3 * c3; // l=4,m=+3
     // l=5
-    const REAL p_5_3 = CONSTANT(-4.403144694917253700) * z2 + CONSTANT(0.489238299435250430);
+    const T p_5_3 = CONSTANT(-4.403144694917253700) * z2 + CONSTANT(0.489238299435250430);
     b[27] = p_5_3 * s3; // l=5,m=-3
     b[33] = p_5_3 * c3; // l=5,m=+3
 
 
     /* m=4 */
 
-    const REAL s4 = x * s3 + y * c3;
-    const REAL c4 = x * c3 - y * s3;
+    const T s4 = x * s3 + y * c3;
+    const T c4 = x * c3 - y * s3;
 
     // l=4
-    const REAL p_4_4 = CONSTANT(0.625835735449176030);
+    const T p_4_4 = CONSTANT(0.625835735449176030);
     b[16] = p_4_4 * s4; // l=4,m=-4
     b[24] = p_4_4 * c4; // l=4,m=+4
     // l=5
-    const REAL p_5_4 = CONSTANT(2.075662314881041100) * z;
+    const T p_5_4 = CONSTANT(2.075662314881041100) * z;
     b[26] = p_5_4 * s4; // l=5,m=-4
     b[34] = p_5_4 * c4; // l=5,m=+4
 
 
     /* m=5 */
 
-    const REAL s5 = x * s4 + y * c4;
-    const REAL c5 = x * c4 - y * s4;
+    const T s5 = x * s4 + y * c4;
+    const T c5 = x * c4 - y * s4;
 
     // l=5
-    const REAL p_5_5 = CONSTANT(-0.656382056840170150);
+    const T p_5_5 = CONSTANT(-0.656382056840170150);
     b[25] = p_5_5 * s5; // l=5,m=-5
     b[35] = p_5_5 * c5; // l=5,m=+5
 }
@@ -2683,44 +8208,258 @@ inline void SimpMatMul(size_t dim, const float* matrix, const float* input, floa
     }
 }
 
-}; // anonymous namespace
+}; // anonymous namespace
+
+float* STUB_API D3DXSHEvalDirection(float* pOut, uint32_t Order, const D3DXVECTOR3* pDir)
+{
+    if (!pOut || !pDir)
+        return nullptr;
+
+    const float fX = pDir->x;
+    const float fY = pDir->y;
+    const float fZ = pDir->z;
+
+    switch (Order)
+    {
+    case 2:
+        sh_eval_basis_1(fX, fY, fZ, pOut);
+        break;
+
+    case 3:
+        sh_eval_basis_2(fX, fY, fZ, pOut);
+        break;
+
+    case 4:
+        sh_eval_basis_3(fX, fY, fZ, pOut);
+        break;
+
+    case 5:
+        sh_eval_basis_4(fX, fY, fZ, pOut);
+        break;
+
+    case 6:
+        sh_eval_basis_5(fX, fY, fZ, pOut);
+        break;
+
+    default:
+        assert(Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER);
+        return nullptr;
+    }
+
+    return pOut;
+}
+
+namespace /* anonymous */ {
+
+// 次数に応じた基底関数を評価する.
+template<typename T>
+inline void SHEvalBasis(uint32_t order, T x, T y, T z, T* b)
+{
+    switch (order)
+    {
+    case 2: sh_eval_basis_1(x, y, z, b); break;
+    case 3: sh_eval_basis_2(x, y, z, b); break;
+    case 4: sh_eval_basis_3(x, y, z, b); break;
+    case 5: sh_eval_basis_4(x, y, z, b); break;
+    case 6: sh_eval_basis_5(x, y, z, b); break;
+    }
+}
+
+// ストライド付きの D3DXVECTOR3 配列から方向を読み込む.
+struct SHDirectionArray
+{
+    const D3DXVECTOR3*  pDir;
+    uint32_t            stride;
+
+    void Load(size_t k, float& x, float& y, float& z) const
+    {
+        const auto& dir = *OffsetPtr(pDir, k * stride);
+        x = dir.x;
+        y = dir.y;
+        z = dir.z;
+    }
+
+    void Load(size_t k, SHLane4& x, SHLane4& y, SHLane4& z) const
+    {
+        // 4方向を行として読み込み, 転置して成分ごとのレーンにする.
+        auto m = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(
+            DirectX::XMLoadFloat3(OffsetPtr(pDir, (k + 0) * stride)),
+            DirectX::XMLoadFloat3(OffsetPtr(pDir, (k + 1) * stride)),
+            DirectX::XMLoadFloat3(OffsetPtr(pDir, (k + 2) * stride)),
+            DirectX::XMLoadFloat3(OffsetPtr(pDir, (k + 3) * stride))));
+        x.v = m.r[0];
+        y.v = m.r[1];
+        z.v = m.r[2];
+    }
+};
+
+// x, y, z 成分ごとの配列から方向を読み込む.
+struct SHDirectionSoA
+{
+    const float*    pX;
+    const float*    pY;
+    const float*    pZ;
+
+    void Load(size_t k, float& x, float& y, float& z) const
+    {
+        x = pX[k];
+        y = pY[k];
+        z = pZ[k];
+    }
+
+    void Load(size_t k, SHLane4& x, SHLane4& y, SHLane4& z) const
+    {
+        x.v = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pX + k));
+        y.v = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pY + k));
+        z.v = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pZ + k));
+    }
+};
+
+// 方向 [begin, end) の基底関数を評価し, k番目の方向の係数 i を pOut[i * n + k] に書き込む.
+// 4方向ずつ SHLane4 で計算し, 端数は float で計算する.
+template<typename Source>
+void SHEvalDirectionBatch(float* pOut, uint32_t order, size_t n, size_t begin, size_t end, const Source& src)
+{
+    // 係数ごとの行は n 要素離れているため, 16方向分をまとめて 64 バイトずつ書き込む.
+    // 4方向ごとに書き込むと n が 2 のべき乗のときにキャッシュのセットが競合して遅くなる.
+    const size_t kBlock = 4;
+    const size_t count  = order * order;
+
+    SHLane4 x, y, z;
+    SHLane4 b[kBlock][D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+
+    size_t k = begin;
+    for (; k + 4 * kBlock <= end; k += 4 * kBlock)
+    {
+        for (size_t j = 0; j < kBlock; ++j)
+        {
+            src.Load(k + j * 4, x, y, z);
+            SHEvalBasis(order, x, y, z, b[j]);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto row = pOut + i * n + k;
+            for (size_t j = 0; j < kBlock; ++j)
+            { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(row + j * 4), b[j][i].v); }
+        }
+    }
+
+    for (; k + 4 <= end; k += 4)
+    {
+        src.Load(k, x, y, z);
+        SHEvalBasis(order, x, y, z, b[0]);
+
+        for (size_t i = 0; i < count; ++i)
+        { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(pOut + i * n + k), b[0][i].v); }
+    }
+
+    float sx, sy, sz;
+    float sb[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+
+    for (; k < end; ++k)
+    {
+        src.Load(k, sx, sy, sz);
+        SHEvalBasis(order, sx, sy, sz, sb);
+
+        for (size_t i = 0; i < count; ++i)
+        { pOut[i * n + k] = sb[i]; }
+    }
+}
+
+// 方向を分割して並列に評価する. 各スレッドは出力の別の列に書き込む.
+template<typename Source>
+void SHEvalDirectionBatchParallel(float* pOut, uint32_t order, size_t n, const Source& src, size_t bytesPerElement)
+{
+    ParallelFor(n, GetChunkSize(bytesPerElement), [&](size_t begin, size_t end)
+    { SHEvalDirectionBatch(pOut, order, n, begin, end, src); });
+}
+
+} // anonymous namespace
+
+float* STUB_API D3DXSHEvalDirectionArray
+(
+    float*              pOut,
+    uint32_t            Order,
+    const D3DXVECTOR3*  pDir,
+    uint32_t            DirStride,
+    uint32_t            n
+)
+{
+    if (!pOut || !pDir)
+        return nullptr;
+
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return nullptr;
+
+    SHEvalDirectionBatch(pOut, Order, n, 0, n, SHDirectionArray{ pDir, DirStride });
+    return pOut;
+}
+
+float* STUB_API D3DXSHEvalDirectionSoA
+(
+    float*          pOut,
+    uint32_t        Order,
+    const float*    pX,
+    const float*    pY,
+    const float*    pZ,
+    uint32_t        n
+)
+{
+    if (!pOut || !pX || !pY || !pZ)
+        return nullptr;
+
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return nullptr;
+
+    SHEvalDirectionBatch(pOut, Order, n, 0, n, SHDirectionSoA{ pX, pY, pZ });
+    return pOut;
+}
 
-float* STUB_API D3DXSHEvalDirection(float* pOut, uint32_t Order, const D3DXVECTOR3* pDir)
+float* STUB_API D3DXSHEvalDirectionArrayParallel
+(
+    float*              pOut,
+    uint32_t            Order,
+    const D3DXVECTOR3*  pDir,
+    uint32_t            DirStride,
+    uint32_t            n
+)
 {
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXSHEvalDirectionArray(pOut, Order, pDir, DirStride, n); }
+
     if (!pOut || !pDir)
         return nullptr;
 
-    const float fX = pDir->x;
-    const float fY = pDir->y;
-    const float fZ = pDir->z;
-
-    switch (Order)
-    {
-    case 2:
-        sh_eval_basis_1(fX, fY, fZ, pOut);
-        break;
-
-    case 3:
-        sh_eval_basis_2(fX, fY, fZ, pOut);
-        break;
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return nullptr;
 
-    case 4:
-        sh_eval_basis_3(fX, fY, fZ, pOut);
-        break;
+    SHEvalDirectionBatchParallel(pOut, Order, n, SHDirectionArray{ pDir, DirStride },
+        Order * Order * sizeof(float) + DirStride);
+    return pOut;
+}
 
-    case 5:
-        sh_eval_basis_4(fX, fY, fZ, pOut);
-        break;
+float* STUB_API D3DXSHEvalDirectionSoAParallel
+(
+    float*          pOut,
+    uint32_t        Order,
+    const float*    pX,
+    const float*    pY,
+    const float*    pZ,
+    uint32_t        n
+)
+{
+    if (n < D3DX_PARALLEL_THRESHOLD)
+    { return D3DXSHEvalDirectionSoA(pOut, Order, pX, pY, pZ, n); }
 
-    case 6:
-        sh_eval_basis_5(fX, fY, fZ, pOut);
-        break;
+    if (!pOut || !pX || !pY || !pZ)
+        return nullptr;
 
-    default:
-        assert(Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER);
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
         return nullptr;
-    }
 
+    SHEvalDirectionBatchParallel(pOut, Order, n, SHDirectionSoA{ pX, pY, pZ },
+        (Order * Order + 3) * sizeof(float));
     return pOut;
 }
 
@@ -3010,6 +8749,165 @@ float* STUB_API D3DXSHRotateZ(float* pOut, uint32_t Order, float Angle, const fl
     return pOut;
 }
 
+namespace /* anonymous */ {
+
+// 帯域 l の回転ブロックの先頭位置. 列ごとに行数を4の倍数に切り上げて格納する.
+const uint32_t kSHRotateBlockOffset[D3DXSH_MAXORDER] = { 0, 0, 12, 52, 108, 216 };
+
+static_assert(216 + 12 * 11 == D3DXSH_ROTATEPLAN_SIZE, "Invalid D3DXSH_ROTATEPLAN_SIZE.");
+
+inline uint32_t SHRotateBlockRows(uint32_t l)
+{ return (2 * l + 1 + 3) & ~3u; }
+
+// 先頭の異なる2つの配列の範囲が重なっているか. 同じ配列への書き込みは許す.
+inline bool IsPartialOverlap(const float* pA, const float* pB, size_t count)
+{
+    const auto a    = reinterpret_cast<uintptr_t>(pA);
+    const auto b    = reinterpret_cast<uintptr_t>(pB);
+    const auto size = count * sizeof(float);
+    return (a != b) && (a < b + size) && (b < a + size);
+}
+
+// 1つの SH 関数に回転を適用する. 帯域ごとに各列へ入力の係数を掛けて足し合わせる.
+// 4行ずつまとめて書き込むため, pOut には Order * Order + 3 要素必要.
+inline void SHRotatePlanApply(const D3DXSHROTATEPLAN& plan, const float* pIn, float* pOut)
+{
+    pOut[0] = pIn[0];
+
+    // 後の帯域が前の帯域のはみ出した分を上書きするので, 小さい帯域から順に処理する.
+    for (uint32_t l = 1; l < plan.Order; ++l)
+    {
+        const auto size  = 2 * l + 1;
+        const auto rows  = SHRotateBlockRows(l);
+        const auto pIn_l = pIn + l * l;
+        const auto pCol  = plan.Block + kSHRotateBlockOffset[l];
+
+        for (uint32_t r = 0; r < rows; r += 4)
+        {
+            auto acc = DirectX::XMVectorZero();
+            for (uint32_t j = 0; j < size; ++j)
+            {
+                acc = DirectX::XMVectorMultiplyAdd(
+                    DirectX::XMLoadFloat4A(reinterpret_cast<const DirectX::XMFLOAT4A*>(pCol + j * rows + r)),
+                    DirectX::XMVectorReplicate(pIn_l[j]),
+                    acc);
+            }
+            DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(pOut + l * l + r), acc);
+        }
+    }
+}
+
+// SoA形式の関数に回転を適用する. T が SHLane4 の場合は4個分をまとめて計算する.
+// load(i), store(i, value) で係数 i を読み書きする.
+template<typename T, typename Load, typename Store>
+void SHRotatePlanApplySoA(const D3DXSHROTATEPLAN& plan, Load load, Store store)
+{
+    store(0, load(0));
+
+    for (uint32_t l = 1; l < plan.Order; ++l)
+    {
+        const auto size = 2 * l + 1;
+        const auto rows = SHRotateBlockRows(l);
+        const auto pCol = plan.Block + kSHRotateBlockOffset[l];
+
+        T in[2 * (D3DXSH_MAXORDER - 1) + 1];
+        for (uint32_t j = 0; j < size; ++j)
+        { in[j] = load(l * l + j); }
+
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            T acc = pCol[i] * in[0];
+            for (uint32_t j = 1; j < size; ++j)
+            { acc += pCol[j * rows + i] * in[j]; }
+            store(l * l + i, acc);
+        }
+    }
+}
+
+} // anonymous namespace
+
+D3DXSHROTATEPLAN* STUB_API D3DXSHRotatePlanInit(D3DXSHROTATEPLAN* pOut, uint32_t Order, const D3DXMATRIX* pMatrix)
+{
+    if (!pOut || !pMatrix)
+        return nullptr;
+
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return nullptr;
+
+    memset(pOut->Block, 0, sizeof(pOut->Block));
+    pOut->Order = Order;
+
+    // D3DXSHRotate は線形なので, 帯域 l の基底を1つずつ回転させて各列を求める.
+    float basis[D3DXSH_MAXORDER * D3DXSH_MAXORDER] = {};
+    float column[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    for (uint32_t l = 1; l < Order; ++l)
+    {
+        const auto size = 2 * l + 1;
+        const auto rows = SHRotateBlockRows(l);
+        auto pCol = pOut->Block + kSHRotateBlockOffset[l];
+
+        for (uint32_t j = 0; j < size; ++j)
+        {
+            basis[l * l + j] = 1.0f;
+            D3DXSHRotate(column, l + 1, pMatrix, basis);
+            basis[l * l + j] = 0.0f;
+
+            for (uint32_t i = 0; i < size; ++i)
+            { pCol[j * rows + i] = column[l * l + i]; }
+        }
+    }
+
+    return pOut;
+}
+
+float* STUB_API D3DXSHRotatePlanApply(float* pOut, const D3DXSHROTATEPLAN* pPlan, const float* pIn, uint32_t n)
+{
+    if (!pOut || !pPlan || !pIn)
+        return nullptr;
+
+    // 1つずつ一時領域に計算してから書き込むので, pOut == pIn でも良い.
+    const size_t count = pPlan->Order * pPlan->Order;
+    if (IsPartialOverlap(pOut, pIn, n * count))
+        return nullptr;
+
+    float tmp[D3DXSH_MAXORDER * D3DXSH_MAXORDER + 3];
+    for (size_t k = 0; k < n; ++k)
+    {
+        SHRotatePlanApply(*pPlan, pIn + k * count, tmp);
+        memcpy(pOut + k * count, tmp, count * sizeof(float));
+    }
+
+    return pOut;
+}
+
+float* STUB_API D3DXSHRotatePlanApplySoA(float* pOut, const D3DXSHROTATEPLAN* pPlan, const float* pIn, uint32_t n)
+{
+    if (!pOut || !pPlan || !pIn)
+        return nullptr;
+
+    // 帯域ごとに全ての係数を読み込んでから書き込むので, pOut == pIn でも良い.
+    if (IsPartialOverlap(pOut, pIn, size_t(n) * pPlan->Order * pPlan->Order))
+        return nullptr;
+
+    // 4個ずつ SHLane4 で計算し, 端数は float で計算する.
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        SHRotatePlanApplySoA<SHLane4>(*pPlan,
+            [&](size_t i) { return SHLane4(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pIn + i * n + k))); },
+            [&](size_t i, const SHLane4& value) { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(pOut + i * n + k), value.v); });
+    }
+
+    for (; k < n; ++k)
+    {
+        SHRotatePlanApplySoA<float>(*pPlan,
+            [&](size_t i) { return pIn[i * n + k]; },
+            [&](size_t i, float value) { pOut[i * n + k] = value; });
+    }
+
+    return pOut;
+}
+
 float* STUB_API D3DXSHAdd(float* pOut, uint32_t Order, const float* pA, const float* pB)
 {
     if (!pOut || !pA || !pB)
@@ -3057,12 +8955,12 @@ float STUB_API D3DXSHDot(uint32_t Order, const float* pA, const float* pB)
     return result;
 }
 
-float* STUB_API D3DXSHMultiply2(float* y, const float* f, const float* g)
-{
-    if (!y || !f || !g)
-        return nullptr;
+namespace /* anonymous */ {
 
-    REAL tf, tg, t;
+template<typename T>
+inline void SHMultiply2(T* y, const T* f, const T* g)
+{
+    T tf, tg, t;
     // [0,0]: 0,
     y[0] = CONSTANT(0.282094792935999980) * f[0] * g[0];
 
@@ -3088,16 +8986,12 @@ float* STUB_API D3DXSHMultiply2(float* y, const float* f, const float* g)
     y[0] += CONSTANT(0.282094791773000010) * t;
 
     // multiply count=20
-
-    return y;
 }
 
-float* STUB_API D3DXSHMultiply3(float* y, const float* f, const float* g)
+template<typename T>
+inline void SHMultiply3(T* y, const T* f, const T* g)
 {
-    if (!y || !f || !g)
-        return nullptr;
-
-    REAL tf, tg, t;
+    T tf, tg, t;
     // [0,0]: 0,
     y[0] = CONSTANT(0.282094792935999980) * f[0] * g[0];
 
@@ -3202,16 +9096,12 @@ float* STUB_API D3DXSHMultiply3(float* y, const float* f, const float* g)
     y[6] += CONSTANT(-0.180223751576000010) * t;
 
     // multiply count=120
-
-    return y;
 }
 
-float* STUB_API D3DXSHMultiply4(float* y, const float* f, const float* g)
+template<typename T>
+inline void SHMultiply4(T* y, const T* f, const T* g)
 {
-    if (!y || !f || !g)
-        return nullptr;
-
-    REAL tf, tg, t;
+    T tf, tg, t;
     // [0,0]: 0,
     y[0] = CONSTANT(0.282094792935999980) * f[0] * g[0];
 
@@ -3529,16 +9419,12 @@ float* STUB_API D3DXSHMultiply4(float* y, const float* f, const float* g)
     y[6] += CONSTANT(-0.210261043508000010) * t;
 
     // multiply count=399
-
-    return y;
 }
 
-float* STUB_API D3DXSHMultiply5(float* y, const float* f, const float* g)
+template<typename T>
+inline void SHMultiply5(T* y, const T* f, const T* g)
 {
-    if (!y || !f || !g)
-        return nullptr;
-
-    REAL tf, tg, t;
+    T tf, tg, t;
     // [0,0]: 0,
     y[0] = CONSTANT(0.282094792935999980) * f[0] * g[0];
 
@@ -4337,16 +10223,12 @@ float* STUB_API D3DXSHMultiply5(float* y, const float* f, const float* g)
     y[20] += CONSTANT(0.106525305981000000) * t;
 
     // multiply count=1135
-
-    return y;
 }
 
-float* STUB_API D3DXSHMultiply6(float* y, const float* f, const float* g)
+template<typename T>
+inline void SHMultiply6(T* y, const T* f, const T* g)
 {
-    if (!y || !f || !g)
-        return nullptr;
-
-    REAL tf, tg, t;
+    T tf, tg, t;
     // [0,0]: 0,
     y[0] = CONSTANT(0.282094792935999980) * f[0] * g[0];
 
@@ -6000,27 +11882,192 @@ float* STUB_API D3DXSHMultiply6(float* y, const float* f, const float* g)
     y[20] += CONSTANT(-0.130197596204999990) * t;
     y[0] += CONSTANT(0.282094791770000020) * t;
 
-    // [34,34]: 20,6,0,
-    tf = CONSTANT(-0.130197596207000000) * f[20] + CONSTANT(-0.097043558542400002) * f[6] + CONSTANT(0.282094791766000000) * f[0];
-    tg = CONSTANT(-0.130197596207000000) * g[20] + CONSTANT(-0.097043558542400002) * g[6] + CONSTANT(0.282094791766000000) * g[0];
-    y[34] += tf * g[34] + tg * f[34];
-    t = f[34] * g[34];
-    y[20] += CONSTANT(-0.130197596207000000) * t;
-    y[6] += CONSTANT(-0.097043558542400002) * t;
-    y[0] += CONSTANT(0.282094791766000000) * t;
+    // [34,34]: 20,6,0,
+    tf = CONSTANT(-0.130197596207000000) * f[20] + CONSTANT(-0.097043558542400002) * f[6] + CONSTANT(0.282094791766000000) * f[0];
+    tg = CONSTANT(-0.130197596207000000) * g[20] + CONSTANT(-0.097043558542400002) * g[6] + CONSTANT(0.282094791766000000) * g[0];
+    y[34] += tf * g[34] + tg * f[34];
+    t = f[34] * g[34];
+    y[20] += CONSTANT(-0.130197596207000000) * t;
+    y[6] += CONSTANT(-0.097043558542400002) * t;
+    y[0] += CONSTANT(0.282094791766000000) * t;
+
+    // [35,35]: 6,0,20,
+    tf = CONSTANT(-0.242608896358999990) * f[6] + CONSTANT(0.282094791761999970) * f[0] + CONSTANT(0.130197596198000000) * f[20];
+    tg = CONSTANT(-0.242608896358999990) * g[6] + CONSTANT(0.282094791761999970) * g[0] + CONSTANT(0.130197596198000000) * g[20];
+    y[35] += tf * g[35] + tg * f[35];
+    t = f[35] * g[35];
+    y[6] += CONSTANT(-0.242608896358999990) * t;
+    y[0] += CONSTANT(0.282094791761999970) * t;
+    y[20] += CONSTANT(0.130197596198000000) * t;
+
+    // multiply count=2527
+}
+
+// SoA形式の n 組の積を求める. 4組ずつ SHLane4 で計算し, 端数は float で計算する.
+template<uint32_t Order, typename Kernel>
+void SHMultiplySoA(float* pOut, const float* pF, const float* pG, size_t n, Kernel kernel)
+{
+    const size_t count = Order * Order;
+
+    SHLane4 y[count];
+    SHLane4 f[count];
+    SHLane4 g[count];
+
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            f[i].v = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pF + i * n + k));
+            g[i].v = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(pG + i * n + k));
+        }
+
+        kernel(y, f, g);
+
+        for (size_t i = 0; i < count; ++i)
+        { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(pOut + i * n + k), y[i].v); }
+    }
+
+    float sy[count];
+    float sf[count];
+    float sg[count];
+
+    for (; k < n; ++k)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            sf[i] = pF[i * n + k];
+            sg[i] = pG[i * n + k];
+        }
+
+        kernel(sy, sf, sg);
+
+        for (size_t i = 0; i < count; ++i)
+        { pOut[i * n + k] = sy[i]; }
+    }
+}
+
+} // anonymous namespace
+
+// D3DXSHMultiply2 - 6 は一時領域に計算してから y に書き込む. 入力を全て読み終えてから書き込むので
+// y が f や g と同じ領域でも正しく計算でき, 出力が入力と重ならないことをコンパイラに示す効果もある.
+float* STUB_API D3DXSHMultiply2(float* y, const float* f, const float* g)
+{
+    if (!y || !f || !g)
+        return nullptr;
+
+    float tmp[4];
+    SHMultiply2(tmp, f, g);
+    memcpy(y, tmp, sizeof(tmp));
+    return y;
+}
+
+float* STUB_API D3DXSHMultiply3(float* y, const float* f, const float* g)
+{
+    if (!y || !f || !g)
+        return nullptr;
+
+    float tmp[9];
+    SHMultiply3(tmp, f, g);
+    memcpy(y, tmp, sizeof(tmp));
+    return y;
+}
+
+float* STUB_API D3DXSHMultiply4(float* y, const float* f, const float* g)
+{
+    if (!y || !f || !g)
+        return nullptr;
+
+    float tmp[16];
+    SHMultiply4(tmp, f, g);
+    memcpy(y, tmp, sizeof(tmp));
+    return y;
+}
+
+float* STUB_API D3DXSHMultiply5(float* y, const float* f, const float* g)
+{
+    if (!y || !f || !g)
+        return nullptr;
+
+    float tmp[25];
+    SHMultiply5(tmp, f, g);
+    memcpy(y, tmp, sizeof(tmp));
+    return y;
+}
+
+float* STUB_API D3DXSHMultiply6(float* y, const float* f, const float* g)
+{
+    if (!y || !f || !g)
+        return nullptr;
+
+    float tmp[36];
+    SHMultiply6(tmp, f, g);
+    memcpy(y, tmp, sizeof(tmp));
+    return y;
+}
+
+float* STUB_API D3DXSHMultiplySoA(float* pOut, uint32_t Order, const float* pF, const float* pG, uint32_t n)
+{
+    if (!pOut || !pF || !pG)
+        return nullptr;
+
+    switch (Order)
+    {
+    case 2:
+        SHMultiplySoA<2>(pOut, pF, pG, n, [](auto* y, const auto* f, const auto* g) { SHMultiply2(y, f, g); });
+        break;
+
+    case 3:
+        SHMultiplySoA<3>(pOut, pF, pG, n, [](auto* y, const auto* f, const auto* g) { SHMultiply3(y, f, g); });
+        break;
+
+    case 4:
+        SHMultiplySoA<4>(pOut, pF, pG, n, [](auto* y, const auto* f, const auto* g) { SHMultiply4(y, f, g); });
+        break;
+
+    case 5:
+        SHMultiplySoA<5>(pOut, pF, pG, n, [](auto* y, const auto* f, const auto* g) { SHMultiply5(y, f, g); });
+        break;
+
+    case 6:
+        SHMultiplySoA<6>(pOut, pF, pG, n, [](auto* y, const auto* f, const auto* g) { SHMultiply6(y, f, g); });
+        break;
+
+    default:
+        return nullptr;
+    }
+
+    return pOut;
+}
+
+float* STUB_API D3DXSHAoSToSoA(float* pOut, uint32_t Order, const float* pIn, uint32_t n)
+{
+    if (!pOut || !pIn)
+        return nullptr;
 
-    // [35,35]: 6,0,20,
-    tf = CONSTANT(-0.242608896358999990) * f[6] + CONSTANT(0.282094791761999970) * f[0] + CONSTANT(0.130197596198000000) * f[20];
-    tg = CONSTANT(-0.242608896358999990) * g[6] + CONSTANT(0.282094791761999970) * g[0] + CONSTANT(0.130197596198000000) * g[20];
-    y[35] += tf * g[35] + tg * f[35];
-    t = f[35] * g[35];
-    y[6] += CONSTANT(-0.242608896358999990) * t;
-    y[0] += CONSTANT(0.282094791761999970) * t;
-    y[20] += CONSTANT(0.130197596198000000) * t;
+    const size_t count = Order * Order;
+    for (size_t k = 0; k < n; ++k)
+    {
+        for (size_t i = 0; i < count; ++i)
+        { pOut[i * n + k] = pIn[k * count + i]; }
+    }
 
-    // multiply count=2527
+    return pOut;
+}
 
-    return y;
+float* STUB_API D3DXSHSoAToAoS(float* pOut, uint32_t Order, const float* pIn, uint32_t n)
+{
+    if (!pOut || !pIn)
+        return nullptr;
+
+    const size_t count = Order * Order;
+    for (size_t k = 0; k < n; ++k)
+    {
+        for (size_t i = 0; i < count; ++i)
+        { pOut[k * count + i] = pIn[i * n + k]; }
+    }
+
+    return pOut;
 }
 
 HRESULT STUB_API D3DXSHEvalDirectionalLight
@@ -6409,3 +12456,540 @@ HRESULT STUB_API D3DXSHEvalHemisphereLight
     return kD3D_OK;
 }
 
+namespace /* anonymous */ {
+
+inline float SHHorizontalSum(const SHLane4& value)
+{
+    DirectX::XMFLOAT4 lanes;
+    DirectX::XMStoreFloat4(&lanes, value.v);
+    return (lanes.x + lanes.y) + (lanes.z + lanes.w);
+}
+
+// 光源を方向と帯域ごとの重みに変換する. 係数は Y_lm(dir) * pWeight[c * order + l] になる.
+// 重みは D3DXSHEval*Light と同じ順序で掛け合わせる.
+bool SHPrepareLight(uint32_t order, const D3DXSHLIGHT& light, const D3DXVECTOR3& origin, D3DXVECTOR3& dir, float* pWeight)
+{
+    const float intensity[3] = { light.Color.r, light.Color.g, light.Color.b };
+    float fTmpL0[D3DXSH_MAXORDER];
+
+    switch (light.Type)
+    {
+    case D3DXSHLIGHT_CONE:
+        if (light.Radius < 0.f || light.Radius > (DirectX::XM_PI * 1.00001f))
+            return false;
+
+        if (light.Radius < 0.0001f)
+        {
+            // turn it into a pure directional light...
+            auto directional = light;
+            directional.Type = D3DXSHLIGHT_DIRECTIONAL;
+            return SHPrepareLight(order, directional, origin, dir, pWeight);
+        }
+        else
+        {
+            const float fAngCheck = (light.Radius > DirectX::XM_PIDIV2) ? (DirectX::XM_PIDIV2) : light.Radius;
+            const float fNewNorm  = 1.0f / (sinf(fAngCheck) * sinf(fAngCheck));
+
+            ComputeCapInt(order, light.Radius, fTmpL0);
+
+            dir = light.Vector;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                for (uint32_t l = 0; l < order; ++l)
+                { pWeight[c * order + l] = fTmpL0[l] * intensity[c] * fNewNorm * fExtraNormFac[l]; }
+            }
+        }
+        return true;
+
+    case D3DXSHLIGHT_DIRECTIONAL:
+        {
+            const float fNorm = DirectX::XM_PI / CosWtInt(order);
+
+            dir = light.Vector;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                for (uint32_t l = 0; l < order; ++l)
+                { pWeight[c * order + l] = fNorm * intensity[c]; }
+            }
+        }
+        return true;
+
+    case D3DXSHLIGHT_SPHERICAL:
+        {
+            if (light.Radius < 0.f)
+                return false;
+
+            const auto  pos        = light.Vector - origin;
+            const float fDist      = D3DXVec3Length(&pos);
+            const float fConeAngle = (fDist <= light.Radius) ? (DirectX::XM_PIDIV2) : asinf(light.Radius / fDist);
+
+            ComputeCapInt(order, fConeAngle, fTmpL0);
+
+            D3DXVec3Normalize(&dir, &pos);
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                for (uint32_t l = 0; l < order; ++l)
+                { pWeight[c * order + l] = fTmpL0[l] * intensity[c] * 1.0f * fExtraNormFac[l]; }
+            }
+        }
+        return true;
+
+    case D3DXSHLIGHT_HEMISPHERE:
+        {
+            const float fNewNorm = 3.0f / 2.0f;
+            const float top[3]    = { light.Color.r,  light.Color.g,  light.Color.b };
+            const float bottom[3] = { light.Bottom.r, light.Bottom.g, light.Bottom.b };
+
+            dir = light.Vector;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                const float fAvrg = (top[c] + bottom[c]) * 0.5f;
+                fTmpL0[0] = fAvrg * 2.0f * SHEvalHemisphereLight_fSqrtPi;
+                fTmpL0[1] = (top[c] - fAvrg) * 2.0f * SHEvalHemisphereLight_fSqrtPi3;
+
+                for (uint32_t l = 0; l < order; ++l)
+                { pWeight[c * order + l] = (l < 2) ? fTmpL0[l] * fNewNorm * fExtraNormFac[l] : 0.0f; }
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// 4灯ずつ処理するために SoA 形式に並べた光源. 端数は重み 0 の光源で埋める.
+// 4灯ごとに方向と重みをまとめて, 1グループ分が連続するように並べる.
+struct SHLightBatch
+{
+    uint32_t            Order  = 0;
+    size_t              Count  = 0;     // 4の倍数に切り上げた光源数.
+    size_t              Stride = 0;     // 1グループの要素数.
+    std::vector<float>  Data;           // グループごとに [x, y, z, weight(c * Order + l)][4]
+
+    void Reset(uint32_t order, size_t n)
+    {
+        Order  = order;
+        Count  = (n + 3) & ~size_t(3);
+        Stride = (3 + 3 * order) * 4;
+        Data.assign(Count / 4 * Stride, 0.0f);
+    }
+
+    bool Set(size_t k, const D3DXSHLIGHT& light, const D3DXVECTOR3& origin)
+    {
+        D3DXVECTOR3 dir;
+        float weight[3 * D3DXSH_MAXORDER];
+        if (!SHPrepareLight(Order, light, origin, dir, weight))
+            return false;
+
+        auto pGroup = Data.data() + (k / 4) * Stride + (k % 4);
+        pGroup[0] = dir.x;
+        pGroup[4] = dir.y;
+        pGroup[8] = dir.z;
+        for (uint32_t i = 0; i < 3 * Order; ++i)
+        { pGroup[(3 + i) * 4] = weight[i]; }
+        return true;
+    }
+};
+
+// 全光源の係数を足し合わせて pSum[c][i] に書き込む.
+void SHAccumulateLights(const SHLightBatch& batch, float (*pSum)[D3DXSH_MAXORDER * D3DXSH_MAXORDER])
+{
+    const auto order = batch.Order;
+
+    SHLane4 acc[3][D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        for (uint32_t i = 0; i < order * order; ++i)
+        { acc[c][i] = 0.0f; }
+    }
+
+    auto load = [](const float* p)
+    { return SHLane4(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(p))); };
+
+    SHLane4 b[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    for (size_t k = 0; k < batch.Count; k += 4)
+    {
+        const auto pGroup = batch.Data.data() + (k / 4) * batch.Stride;
+        SHEvalBasis(order, load(pGroup + 0), load(pGroup + 4), load(pGroup + 8), b);
+
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            for (uint32_t l = 0; l < order; ++l)
+            {
+                const auto w = load(pGroup + (3 + c * order + l) * 4);
+                for (uint32_t i = l * l; i < (l + 1) * (l + 1); ++i)
+                { acc[c][i] += b[i] * w; }
+            }
+        }
+    }
+
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        for (uint32_t i = 0; i < order * order; ++i)
+        { pSum[c][i] = SHHorizontalSum(acc[c][i]); }
+    }
+}
+
+} // anonymous namespace
+
+HRESULT STUB_API D3DXSHEvalLights
+(
+    uint32_t            Order,
+    const D3DXSHLIGHT*  pLights,
+    uint32_t            n,
+    float*              pROut,
+    float*              pGOut,
+    float*              pBOut
+)
+{
+    if (!pROut || (!pLights && n > 0))
+        return kD3DERR_INVALIDCALL;
+
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return kD3DERR_INVALIDCALL;
+
+    const D3DXVECTOR3 origin(0.0f, 0.0f, 0.0f);
+
+    SHLightBatch batch;
+    batch.Reset(Order, n);
+    for (uint32_t k = 0; k < n; ++k)
+    {
+        if (!batch.Set(k, pLights[k], origin))
+            return kD3DERR_INVALIDCALL;
+    }
+
+    float sum[3][D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    SHAccumulateLights(batch, sum);
+
+    float* outputs[3] = { pROut, pGOut, pBOut };
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        if (outputs[c])
+        { memcpy(outputs[c], sum[c], Order * Order * sizeof(float)); }
+    }
+
+    return kD3D_OK;
+}
+
+HRESULT STUB_API D3DXSHEvalLightsAtProbes
+(
+    uint32_t            Order,
+    const D3DXSHLIGHT*  pLights,
+    uint32_t            nLights,
+    const D3DXVECTOR3*  pProbes,
+    uint32_t            nProbes,
+    float*              pROut,
+    float*              pGOut,
+    float*              pBOut
+)
+{
+    if (!pROut || (!pLights && nLights > 0) || (!pProbes && nProbes > 0))
+        return kD3DERR_INVALIDCALL;
+
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return kD3DERR_INVALIDCALL;
+
+    // 位置によらない光源は先に1回だけ計算し, 球光源だけをプローブごとに計算する.
+    const D3DXVECTOR3 origin(0.0f, 0.0f, 0.0f);
+
+    std::vector<uint32_t> spherical;
+    size_t others = 0;
+    for (uint32_t k = 0; k < nLights; ++k)
+    {
+        if (pLights[k].Type == D3DXSHLIGHT_SPHERICAL)
+        {
+            if (pLights[k].Radius < 0.f)
+                return kD3DERR_INVALIDCALL;
+            spherical.push_back(k);
+        }
+        else
+        { others++; }
+    }
+
+    SHLightBatch batch;
+    batch.Reset(Order, others);
+    for (uint32_t k = 0, index = 0; k < nLights; ++k)
+    {
+        if (pLights[k].Type == D3DXSHLIGHT_SPHERICAL)
+            continue;
+
+        if (!batch.Set(index++, pLights[k], origin))
+            return kD3DERR_INVALIDCALL;
+    }
+
+    float base[3][D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    SHAccumulateLights(batch, base);
+
+    const size_t count   = Order * Order;
+    float*       outputs[3] = { pROut, pGOut, pBOut };
+
+    auto evalProbes = [&](size_t begin, size_t end)
+    {
+        SHLightBatch local;
+        float sum[3][D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+
+        for (auto p = begin; p < end; ++p)
+        {
+            if (!spherical.empty())
+            {
+                local.Reset(Order, spherical.size());
+                for (size_t k = 0; k < spherical.size(); ++k)
+                { local.Set(k, pLights[spherical[k]], pProbes[p]); }
+                SHAccumulateLights(local, sum);
+            }
+
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                if (!outputs[c])
+                    continue;
+
+                auto pOut = outputs[c] + p * count;
+                for (size_t i = 0; i < count; ++i)
+                { pOut[i] = spherical.empty() ? base[c][i] : base[c][i] + sum[c][i]; }
+            }
+        }
+    };
+
+    // 1チャンクで D3DX_PARALLEL_THRESHOLD 灯程度を処理する.
+    const size_t perProbe = spherical.empty() ? 1 : spherical.size();
+    const size_t grain    = (perProbe < D3DX_PARALLEL_THRESHOLD) ? (D3DX_PARALLEL_THRESHOLD / perProbe) : 1;
+    ParallelFor(nProbes, grain, evalProbes);
+
+    return kD3D_OK;
+}
+
+namespace /* anonymous */ {
+
+// キューブマップの面ごとの方向. (u, v, 1) の成分を並べ替えて符号を付けたものになる.
+struct SHCubeFace
+{
+    uint32_t    Axis[3];
+    float       Sign[3];
+};
+
+const SHCubeFace kSHCubeFaces[6] = {
+    { { 2, 1, 0 }, {  1.0f, -1.0f, -1.0f } },  // +X
+    { { 2, 1, 0 }, { -1.0f, -1.0f,  1.0f } },  // -X
+    { { 0, 2, 1 }, {  1.0f,  1.0f,  1.0f } },  // +Y
+    { { 0, 2, 1 }, {  1.0f, -1.0f, -1.0f } },  // -Y
+    { { 0, 1, 2 }, {  1.0f, -1.0f,  1.0f } },  // +Z
+    { { 0, 1, 2 }, { -1.0f, -1.0f, -1.0f } },  // -Z
+};
+
+// メモリ上のキューブマップ.
+struct SHCubeMapSource
+{
+    const void* const*  ppFaces;
+    uint32_t            Size;
+    uint32_t            Pitch;
+    D3DXSHCUBEFORMAT    Format;
+
+    // 1行を float の RGBA に変換する.
+    void LoadRow(uint32_t face, uint32_t y, DirectX::XMFLOAT4* pRow) const
+    {
+        auto pSrc = static_cast<const uint8_t*>(ppFaces[face]) + size_t(y) * Pitch;
+        switch (Format)
+        {
+        case D3DXSHCUBEFORMAT_A32B32G32R32F:
+            memcpy(pRow, pSrc, Size * sizeof(DirectX::XMFLOAT4));
+            break;
+
+        case D3DXSHCUBEFORMAT_A16B16G16R16F:
+            D3DXFloat16To32Array(&pRow->x, reinterpret_cast<const D3DXFLOAT16*>(pSrc), Size * 4);
+            break;
+
+        case D3DXSHCUBEFORMAT_A8B8G8R8:
+            {
+                auto pTexel = reinterpret_cast<const DirectX::PackedVector::XMUBYTEN4*>(pSrc);
+                for (uint32_t x = 0; x < Size; ++x)
+                { DirectX::XMStoreFloat4(&pRow[x], DirectX::PackedVector::XMLoadUByteN4(&pTexel[x])); }
+            }
+            break;
+        }
+    }
+
+    size_t GetTexelSize() const
+    {
+        switch (Format)
+        {
+        case D3DXSHCUBEFORMAT_A32B32G32R32F: return sizeof(float) * 4;
+        case D3DXSHCUBEFORMAT_A16B16G16R16F: return sizeof(D3DXFLOAT16) * 4;
+        case D3DXSHCUBEFORMAT_A8B8G8R8:      return sizeof(uint8_t) * 4;
+        }
+        return 0;
+    }
+};
+
+// ブロックごとの部分和.
+struct SHCubeMapSum
+{
+    float   R[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    float   G[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    float   B[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    float   Weight;
+};
+
+// 全面を通した行番号 [begin, end) のテクセルを立体角で重み付けして積分する.
+// 4テクセルずつ SHLane4 で計算する. 行の端数は色を 0 で埋め, 重みを 0 にする.
+void SHProjectCubeMapRows(const SHCubeMapSource& src, uint32_t order, size_t begin, size_t end, SHCubeMapSum& sum)
+{
+    const size_t count   = order * order;
+    const auto   size    = src.Size;
+    const auto   invSize = 1.0f / float(size);
+
+    std::vector<DirectX::XMFLOAT4> row((size + 3) & ~3u, DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+
+    SHLane4 accR[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    SHLane4 accG[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    SHLane4 accB[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+    SHLane4 accW = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        accR[i] = 0.0f;
+        accG[i] = 0.0f;
+        accB[i] = 0.0f;
+    }
+
+    // テクセル中心の座標は (2x + 1) / size - 1.
+    const auto kOffset = DirectX::XMVectorSet(1.0f, 3.0f, 5.0f, 7.0f);
+    const auto kIndex  = DirectX::XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+    const auto sizeV   = DirectX::XMVectorReplicate(float(size));
+
+    SHLane4 b[D3DXSH_MAXORDER * D3DXSH_MAXORDER];
+
+    for (auto r = begin; r < end; ++r)
+    {
+        const auto  face = uint32_t(r / size);
+        const auto  y    = uint32_t(r % size);
+        const auto& f    = kSHCubeFaces[face];
+        src.LoadRow(face, y, row.data());
+
+        const float v = float(2 * y + 1) * invSize - 1.0f;
+
+        for (uint32_t x = 0; x < size; x += 4)
+        {
+            const auto fx = DirectX::XMVectorReplicate(float(x));
+            const auto u = invSize * SHLane4(DirectX::XMVectorAdd(DirectX::XMVectorAdd(fx, fx), kOffset)) - 1.0f;
+
+            // 方向の正規化と立体角 4 / (1 + u^2 + v^2)^(3/2) は同じ長さから求まる.
+            const SHLane4 invLen(DirectX::XMVectorReciprocalSqrt((u * u + (1.0f + v * v)).v));
+            const SHLane4 uvw[3] = { u * invLen, v * invLen, invLen };
+            const SHLane4 weight(DirectX::XMVectorAndInt(
+                (4.0f * (invLen * invLen * invLen)).v,
+                DirectX::XMVectorLess(DirectX::XMVectorAdd(fx, kIndex), sizeV)));
+
+            SHEvalBasis(order,
+                f.Sign[0] * uvw[f.Axis[0]],
+                f.Sign[1] * uvw[f.Axis[1]],
+                f.Sign[2] * uvw[f.Axis[2]],
+                b);
+
+            // 4テクセルを転置して成分ごとのレーンにする.
+            auto color = DirectX::XMMatrixTranspose(DirectX::XMMATRIX(
+                DirectX::XMLoadFloat4(&row[x + 0]),
+                DirectX::XMLoadFloat4(&row[x + 1]),
+                DirectX::XMLoadFloat4(&row[x + 2]),
+                DirectX::XMLoadFloat4(&row[x + 3])));
+            const auto cr = SHLane4(color.r[0]) * weight;
+            const auto cg = SHLane4(color.r[1]) * weight;
+            const auto cb = SHLane4(color.r[2]) * weight;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                accR[i] += b[i] * cr;
+                accG[i] += b[i] * cg;
+                accB[i] += b[i] * cb;
+            }
+            accW += weight;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        sum.R[i] = SHHorizontalSum(accR[i]);
+        sum.G[i] = SHHorizontalSum(accG[i]);
+        sum.B[i] = SHHorizontalSum(accB[i]);
+    }
+    sum.Weight = SHHorizontalSum(accW);
+}
+
+} // anonymous namespace
+
+HRESULT STUB_API D3DXSHProjectCubeMap
+(
+    uint32_t            Order,
+    const void* const*  ppFaces,
+    uint32_t            Size,
+    uint32_t            Pitch,
+    D3DXSHCUBEFORMAT    Format,
+    float*              pROut,
+    float*              pGOut,
+    float*              pBOut
+)
+{
+    if (!pROut || !ppFaces || Size == 0)
+        return kD3DERR_INVALIDCALL;
+
+    if (Order < D3DXSH_MINORDER || Order > D3DXSH_MAXORDER)
+        return kD3DERR_INVALIDCALL;
+
+    const SHCubeMapSource src = { ppFaces, Size, Pitch, Format };
+    const auto texelSize = src.GetTexelSize();
+    if (texelSize == 0 || Pitch < Size * texelSize)
+        return kD3DERR_INVALIDCALL;
+
+    for (auto face = 0; face < 6; ++face)
+    {
+        if (!ppFaces[face])
+            return kD3DERR_INVALIDCALL;
+    }
+
+    // 行をスレッド数によらない固定のブロックに分けて部分和を求め, 順番に足し合わせる.
+    // こうしておくとワーカースレッド数が変わっても結果が変わらない.
+    const size_t rowCount     = size_t(Size) * 6;
+    const size_t rowsPerBlock = (Size < 4096) ? (4096 / Size) : 1;
+    const size_t blockCount   = (rowCount + rowsPerBlock - 1) / rowsPerBlock;
+
+    std::vector<SHCubeMapSum> sums(blockCount);
+    auto projectBlocks = [&](size_t begin, size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto rowEnd = (i + 1) * rowsPerBlock;
+            SHProjectCubeMapRows(src, Order, i * rowsPerBlock, (rowEnd < rowCount) ? rowEnd : rowCount, sums[i]);
+        }
+    };
+
+    if (rowCount * Size < D3DX_PARALLEL_THRESHOLD)
+    { projectBlocks(0, blockCount); }
+    else
+    { ParallelFor(blockCount, 1, projectBlocks); }
+
+    const size_t count = Order * Order;
+    double R[D3DXSH_MAXORDER * D3DXSH_MAXORDER] = {};
+    double G[D3DXSH_MAXORDER * D3DXSH_MAXORDER] = {};
+    double B[D3DXSH_MAXORDER * D3DXSH_MAXORDER] = {};
+    double weight = 0.0;
+    for (const auto& sum : sums)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            R[i] += sum.R[i];
+            G[i] += sum.G[i];
+            B[i] += sum.B[i];
+        }
+        weight += sum.Weight;
+    }
+
+    // 立体角の総和が 4π になるように正規化する.
+    const double norm = (4.0 * DirectX::XM_PI) / weight;
+    for (size_t i = 0; i < count; ++i)
+    {
+        pROut[i] = float(R[i] * norm);
+        if (pGOut) pGOut[i] = float(G[i] * norm);
+        if (pBOut) pBOut[i] = float(B[i] * norm);
+    }
+
+    return kD3D_OK;
+}
+
@@ -9,9 +9,15 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cstring> // for memcpy.
+#include <cstdlib>
+#include <new>
 #include <DirectXMath.h>
 #include <DirectXPackedVector.h>
 
+#if defined(_WIN32)
+#include <malloc.h> // for _aligned_malloc.
+#endif
+
 // 既にインクルード済みかチェック.
 #ifdef __D3DX9MATH_H__
 #error "d3dx9math.h Already Included."
@@ -35,6 +41,25 @@
 #define STUB_API
 #endif//STUB_API
 
+// 並列版の配列APIで呼び出しスレッドのみで処理する要素数の上限.
+// ライブラリのビルド時の設定なので, 変更する場合はライブラリと利用側の両方で同じ値を定義すること.
+// ヘッダーを読み込む前に定義し直しても, ビルド済みのライブラリの動作は変わらない.
+#ifndef D3DX_PARALLEL_THRESHOLD
+#define D3DX_PARALLEL_THRESHOLD     (16 * 1024)
+#endif//D3DX_PARALLEL_THRESHOLD
+
+// D3DX9MATH_STUB_INLINE を定義するとDirectXMathの薄いラッパー関数をヘッダーでインライン定義する.
+// ライブラリ側の関数とシンボルが衝突しないようにインライン名前空間に配置する.
+#if defined(D3DX9MATH_STUB_INLINE)
+#define D3DX_STUB_INLINE            inline
+#define D3DX_STUB_INLINE_BEGIN      inline namespace d3dx9math_stub_inline {
+#define D3DX_STUB_INLINE_END        }
+#else
+#define D3DX_STUB_INLINE
+#define D3DX_STUB_INLINE_BEGIN
+#define D3DX_STUB_INLINE_END
+#endif//D3DX9MATH_STUB_INLINE
+
 #ifndef FALSE
 #define FALSE 0
 #endif//FALSE
@@ -130,6 +155,48 @@ inline float D3DXToRadian(float degree)
 inline float D3DXToDegree(float radian)
 { return DirectX::XMConvertToDegrees(radian); }
 
+// Allocate memory aligned to the given power of two. Returns NULL on failure.
+inline void* D3DXAlignedMalloc(size_t size, size_t alignment)
+{
+#if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    void* p = nullptr;
+    if (alignment < sizeof(void*))
+    { alignment = sizeof(void*); }
+    return (posix_memalign(&p, alignment, size) == 0) ? p : nullptr;
+#endif
+}
+
+// Free memory allocated with D3DXAlignedMalloc.
+inline void D3DXAlignedFree(void* p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// アラインメント指定型を new で確保した場合もアラインメントを保証する.
+#define D3DX_ALIGNED_OPERATOR_NEW(alignment)                    \
+    static void* operator new (size_t size)                     \
+    {                                                           \
+        auto p = D3DXAlignedMalloc(size, alignment);            \
+        if (p == nullptr) { throw std::bad_alloc(); }           \
+        return p;                                               \
+    }                                                           \
+    static void* operator new[] (size_t size)                   \
+    { return operator new(size); }                              \
+    static void* operator new (size_t, void* p)                 \
+    { return p; }                                               \
+    static void operator delete (void* p)                       \
+    { D3DXAlignedFree(p); }                                     \
+    static void operator delete[] (void* p)                     \
+    { D3DXAlignedFree(p); }                                     \
+    static void operator delete (void*, void*)                  \
+    { /* DO_NOTHING */ }
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXFLOAT16 structure
@@ -581,6 +648,40 @@ public:
     { return x != v.x || y != v.y || z != v.z || w != v.w; }
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// D3DXVECTOR4A16 structure
+///////////////////////////////////////////////////////////////////////////////
+struct alignas(16) D3DXVECTOR4A16 : public D3DXVECTOR4
+{
+    D3DXVECTOR4A16()
+    { /* DO_NOTHING */ }
+
+    D3DXVECTOR4A16(const float* pf)
+    : D3DXVECTOR4(pf)
+    { /* DO_NOTHING */ }
+
+    D3DXVECTOR4A16(const D3DXFLOAT16* pf)
+    : D3DXVECTOR4(pf)
+    { /* DO_NOTHING */ }
+
+    D3DXVECTOR4A16(const D3DVECTOR& v, float f)
+    : D3DXVECTOR4(v, f)
+    { /* DO_NOTHING */ }
+
+    D3DXVECTOR4A16(float fx, float fy, float fz, float fw)
+    : D3DXVECTOR4(fx, fy, fz, fw)
+    { /* DO_NOTHING */ }
+
+    // assignment operators
+    D3DXVECTOR4A16& operator = (const D3DXVECTOR4& rhs)
+    {
+        memcpy(&x, &rhs, sizeof(D3DXVECTOR4));
+        return *this;
+    }
+
+    D3DX_ALIGNED_OPERATOR_NEW(16)
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXVECTOR4_16F structure
 ///////////////////////////////////////////////////////////////////////////////
@@ -811,7 +912,7 @@ public:
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXMATRIXA16 structure
 ///////////////////////////////////////////////////////////////////////////////
-struct D3DXMATRIXA16 : public D3DXMATRIX
+struct alignas(16) D3DXMATRIXA16 : public D3DXMATRIX
 {
     D3DXMATRIXA16() 
     { /* DO_NOTHING */ }
@@ -845,6 +946,8 @@ struct D3DXMATRIXA16 : public D3DXMATRIX
         memcpy(&_11, &rhs, sizeof(D3DXMATRIX));
         return *this;
     }
+
+    D3DX_ALIGNED_OPERATOR_NEW(16)
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -971,6 +1074,36 @@ public:
     { return x != q.x || y != q.y || z != q.z || w != q.w; }
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// D3DXQUATERNIONA16 structure
+///////////////////////////////////////////////////////////////////////////////
+struct alignas(16) D3DXQUATERNIONA16 : public D3DXQUATERNION
+{
+    D3DXQUATERNIONA16()
+    { /* DO_NOTHING */ }
+
+    D3DXQUATERNIONA16(const float* pf)
+    : D3DXQUATERNION(pf)
+    { /* DO_NOTHING */ }
+
+    D3DXQUATERNIONA16(const D3DXFLOAT16* pf)
+    : D3DXQUATERNION(pf)
+    { /* DO_NOTHING */ }
+
+    D3DXQUATERNIONA16(float fx, float fy, float fz, float fw)
+    : D3DXQUATERNION(fx, fy, fz, fw)
+    { /* DO_NOTHING */ }
+
+    // assignment operators
+    D3DXQUATERNIONA16& operator = (const D3DXQUATERNION& rhs)
+    {
+        memcpy(&x, &rhs, sizeof(D3DXQUATERNION));
+        return *this;
+    }
+
+    D3DX_ALIGNED_OPERATOR_NEW(16)
+};
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXPLANE structure
@@ -1327,6 +1460,7 @@ inline D3DXVECTOR2* D3DXVec2Lerp(D3DXVECTOR2 *pOut, const D3DXVECTOR2 *pV1, cons
     return pOut;
 }
 
+D3DX_STUB_INLINE_BEGIN
 D3DXVECTOR2* STUB_API D3DXVec2Normalize(D3DXVECTOR2 *pOut, const D3DXVECTOR2 *pV);
 
 // Hermite interpolation between position V1, tangent T1 (when s == 0)
@@ -1356,6 +1490,7 @@ D3DXVECTOR2* STUB_API D3DXVec2TransformCoord(
 // Transform (x, y, 0, 0) by matrix.
 D3DXVECTOR2* STUB_API D3DXVec2TransformNormal(
     D3DXVECTOR2 *pOut, const D3DXVECTOR2 *pV, const D3DXMATRIX *pM);
+D3DX_STUB_INLINE_END
      
 // Transform Array (x, y, 0, 1) by matrix.
 D3DXVECTOR4* STUB_API D3DXVec2TransformArray(
@@ -1369,6 +1504,15 @@ D3DXVECTOR2* STUB_API D3DXVec2TransformCoordArray(
 D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArray(
     D3DXVECTOR2 *pOut, uint32_t OutStride, const D3DXVECTOR2 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
 
+// Multithreaded versions of the array transforms above. The array is split
+// into chunks processed by the worker pool; arrays with fewer than
+// D3DX_PARALLEL_THRESHOLD elements are processed on the calling thread.
+D3DXVECTOR2* STUB_API D3DXVec2TransformCoordArrayParallel(
+    D3DXVECTOR2 *pOut, uint32_t OutStride, const D3DXVECTOR2 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
+
+D3DXVECTOR2* STUB_API D3DXVec2TransformNormalArrayParallel(
+    D3DXVECTOR2 *pOut, uint32_t OutStride, const D3DXVECTOR2 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXVECTOR3 Methods
@@ -1475,6 +1619,7 @@ inline D3DXVECTOR3* D3DXVec3Lerp(D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV1, cons
     return pOut;
 }
 
+D3DX_STUB_INLINE_BEGIN
 D3DXVECTOR3* STUB_API D3DXVec3Normalize(
     D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV);
 
@@ -1507,6 +1652,7 @@ D3DXVECTOR3* STUB_API D3DXVec3TransformCoord(
 // transpose of the inverse of the matrix you would use to transform a coord.
 D3DXVECTOR3* STUB_API D3DXVec3TransformNormal(
     D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV, const D3DXMATRIX *pM);
+D3DX_STUB_INLINE_END
 
 // Transform Array (x, y, z, 1) by matrix. 
 D3DXVECTOR4* STUB_API D3DXVec3TransformArray(
@@ -1522,6 +1668,16 @@ D3DXVECTOR3* STUB_API D3DXVec3TransformCoordArray(
 D3DXVECTOR3* STUB_API D3DXVec3TransformNormalArray(
     D3DXVECTOR3 *pOut, uint32_t OutStride, const D3DXVECTOR3 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
 
+// Multithreaded versions of the array transforms above. The array is split
+// into chunks processed by the worker pool; arrays with fewer than
+// D3DX_PARALLEL_THRESHOLD elements are processed on the calling thread.
+D3DXVECTOR3* STUB_API D3DXVec3TransformCoordArrayParallel(
+    D3DXVECTOR3 *pOut, uint32_t OutStride, const D3DXVECTOR3 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
+
+D3DXVECTOR3* STUB_API D3DXVec3TransformNormalArrayParallel(
+    D3DXVECTOR3 *pOut, uint32_t OutStride, const D3DXVECTOR3 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
+
+D3DX_STUB_INLINE_BEGIN
 // Project vector from object space into screen space
 D3DXVECTOR3* STUB_API D3DXVec3Project(
     D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV, const D3DVIEWPORT9 *pViewport,
@@ -1531,6 +1687,7 @@ D3DXVECTOR3* STUB_API D3DXVec3Project(
 D3DXVECTOR3* STUB_API D3DXVec3Unproject(
     D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV, const D3DVIEWPORT9 *pViewport,
     const D3DXMATRIX *pProjection, const D3DXMATRIX *pView, const D3DXMATRIX *pWorld);
+D3DX_STUB_INLINE_END
       
 // Project vector Array from object space into screen space
 D3DXVECTOR3* STUB_API D3DXVec3ProjectArray(
@@ -1640,6 +1797,7 @@ inline D3DXVECTOR4* D3DXVec4Lerp(D3DXVECTOR4 *pOut, const D3DXVECTOR4 *pV1, cons
     return pOut;
 }
 
+D3DX_STUB_INLINE_BEGIN
 // Cross-product in 4 dimensions.
 D3DXVECTOR4* STUB_API D3DXVec4Cross(D3DXVECTOR4 *pOut, const D3DXVECTOR4 *pV1, const D3DXVECTOR4 *pV2, const D3DXVECTOR4 *pV3);
 
@@ -1663,11 +1821,17 @@ D3DXVECTOR4* STUB_API D3DXVec4BaryCentric(
 
 // Transform vector by matrix.
 D3DXVECTOR4* STUB_API D3DXVec4Transform(D3DXVECTOR4 *pOut, const D3DXVECTOR4 *pV, const D3DXMATRIX *pM );
+D3DX_STUB_INLINE_END
     
 // Transform vector array by matrix.
 D3DXVECTOR4* STUB_API D3DXVec4TransformArray(
     D3DXVECTOR4 *pOut, uint32_t OutStride, const D3DXVECTOR4 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
 
+// Multithreaded version of D3DXVec4TransformArray. Arrays with fewer than
+// D3DX_PARALLEL_THRESHOLD elements are processed on the calling thread.
+D3DXVECTOR4* STUB_API D3DXVec4TransformArrayParallel(
+    D3DXVECTOR4 *pOut, uint32_t OutStride, const D3DXVECTOR4 *pV, uint32_t VStride, const D3DXMATRIX *pM, uint32_t n);
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1695,6 +1859,7 @@ inline bool D3DXMatrixIsIdentity(const D3DXMATRIX *pM)
            pM->m[3][0] == 0.0f && pM->m[3][1] == 0.0f && pM->m[3][2] == 0.0f && pM->m[3][3] == 1.0f;
 }
 
+D3DX_STUB_INLINE_BEGIN
 float STUB_API D3DXMatrixDeterminant(const D3DXMATRIX *pM);
 
 HRESULT STUB_API D3DXMatrixDecompose(
@@ -1712,7 +1877,86 @@ D3DXMATRIX* STUB_API D3DXMatrixMultiply(
 // Matrix multiplication, followed by a transpose. (Out = T(M1 * M2))
 D3DXMATRIX* STUB_API D3DXMatrixMultiplyTranspose(
     D3DXMATRIX *pOut, const D3DXMATRIX *pM1, const D3DXMATRIX *pM2);
+D3DX_STUB_INLINE_END
+
+// Multiply arrays of matrices pairwise. (Out[i] = M1[i] * M2[i])
+// pOut may be the same array as pM1 or pM2.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArray(
+    D3DXMATRIX *pOut, const D3DXMATRIX *pM1, const D3DXMATRIX *pM2, uint32_t n);
+
+// Multiply an array of matrices by a single matrix. (Out[i] = M1[i] * M2)
+// pOut may be the same array as pM1.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArrayByMatrix(
+    D3DXMATRIX *pOut, const D3DXMATRIX *pM1, const D3DXMATRIX *pM2, uint32_t n);
+
+// Propagate local transforms down a hierarchy. (World[i] = Local[i] * World[Parent[i]])
+// Parents must precede their children (Parent[i] < i). Roots have a negative
+// parent index and use World[i] = Local[i] * Root, or Local[i] when pRoot is NULL.
+// pWorld may be the same array as pLocal.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyHierarchy(
+    D3DXMATRIX *pWorld, const D3DXMATRIX *pLocal, const int32_t *pParent, const D3DXMATRIX *pRoot, uint32_t n);
+
+// Multithreaded versions of the batch multiplications above. Arrays with fewer
+// than D3DX_PARALLEL_THRESHOLD matrices are processed on the calling thread.
+// The hierarchy is processed one depth level at a time.
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArrayParallel(
+    D3DXMATRIX *pOut, const D3DXMATRIX *pM1, const D3DXMATRIX *pM2, uint32_t n);
+
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyArrayByMatrixParallel(
+    D3DXMATRIX *pOut, const D3DXMATRIX *pM1, const D3DXMATRIX *pM2, uint32_t n);
+
+D3DXMATRIX* STUB_API D3DXMatrixMultiplyHierarchyParallel(
+    D3DXMATRIX *pWorld, const D3DXMATRIX *pLocal, const int32_t *pParent, const D3DXMATRIX *pRoot, uint32_t n);
+
+// Decompose an array of matrices into scale, rotation and translation.
+// Bit (i % 32) of pFailed[i / 32] is set when pM[i] is not a scale-rotation-
+// translation matrix; the outputs of such elements are set to identity.
+// pFailed may be NULL. Returns the number of failed elements.
+uint32_t STUB_API D3DXMatrixDecomposeArray(
+    D3DXVECTOR3 *pOutScale, D3DXQUATERNION *pOutRotation, D3DXVECTOR3 *pOutTranslation,
+    uint32_t *pFailed, const D3DXMATRIX *pM, uint32_t n);
+
+// Build an array of matrices from scale, rotation and translation.
+// (Out[i] = Ms[i] * Mr[i] * Mt[i])  NULL arrays are treated as identity.
+D3DXMATRIX* STUB_API D3DXMatrixComposeArray(
+    D3DXMATRIX *pOut, const D3DXVECTOR3 *pScale, const D3DXQUATERNION *pRotation,
+    const D3DXVECTOR3 *pTranslation, uint32_t n);
+
+// Multithreaded versions of the batch decomposition above. Arrays with fewer
+// than D3DX_PARALLEL_THRESHOLD matrices are processed on the calling thread.
+uint32_t STUB_API D3DXMatrixDecomposeArrayParallel(
+    D3DXVECTOR3 *pOutScale, D3DXQUATERNION *pOutRotation, D3DXVECTOR3 *pOutTranslation,
+    uint32_t *pFailed, const D3DXMATRIX *pM, uint32_t n);
+
+D3DXMATRIX* STUB_API D3DXMatrixComposeArrayParallel(
+    D3DXMATRIX *pOut, const D3DXVECTOR3 *pScale, const D3DXQUATERNION *pRotation,
+    const D3DXVECTOR3 *pTranslation, uint32_t n);
+
+// Classification of a matrix used to choose the cheapest inverse.
+enum D3DXMATRIXCLASS
+{
+    D3DXMATRIXCLASS_GENERAL = 0,    // Any 4x4 matrix.
+    D3DXMATRIXCLASS_AFFINE  = 1,    // The last column is (0, 0, 0, 1).
+    D3DXMATRIXCLASS_RIGID   = 2,    // Affine with an orthonormal upper 3x3.
+};
+
+// Classify a matrix. The upper 3x3 of a rigid matrix times its transpose
+// must be within 1e-6 of the identity.
+D3DXMATRIXCLASS STUB_API D3DXMatrixClassify(const D3DXMATRIX *pM);
 
+// Invert an array of matrices. Rigid matrices are inverted by transposing the
+// rotation, affine matrices by inverting the upper 3x3 only, and the others
+// as D3DXMatrixInverse does. Determinants are returned in pDeterminant when it
+// is non-NULL. pOut may be the same array as pM.
+D3DXMATRIX* STUB_API D3DXMatrixInverseArray(
+    D3DXMATRIX *pOut, float *pDeterminant, const D3DXMATRIX *pM, uint32_t n);
+
+// Multithreaded version of D3DXMatrixInverseArray. Arrays with fewer than
+// D3DX_PARALLEL_THRESHOLD matrices are processed on the calling thread.
+D3DXMATRIX* STUB_API D3DXMatrixInverseArrayParallel(
+    D3DXMATRIX *pOut, float *pDeterminant, const D3DXMATRIX *pM, uint32_t n);
+
+D3DX_STUB_INLINE_BEGIN
 // Calculate inverse of matrix.  Inversion my fail, in which case NULL will
 // be returned.  The determinant of pM is also returned it pfDeterminant
 // is non-NULL.
@@ -1827,6 +2071,7 @@ D3DXMATRIX* STUB_API D3DXMatrixShadow(
 
 // Build a matrix which reflects the coordinate system about a plane
 D3DXMATRIX* STUB_API D3DXMatrixReflect(D3DXMATRIX *pOut, const D3DXPLANE *pPlane);
+D3DX_STUB_INLINE_END
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1880,6 +2125,7 @@ inline D3DXQUATERNION* D3DXQuaternionConjugate(D3DXQUATERNION *pOut, const D3DXQ
     return pOut;
 }
 
+D3DX_STUB_INLINE_BEGIN
 // Compute a quaternin's axis and angle of rotation. Expects unit quaternions.
 void STUB_API D3DXQuaternionToAxisAngle(
     const D3DXQUATERNION *pQ, D3DXVECTOR3 *pAxis, float *pAngle);
@@ -1945,6 +2191,7 @@ D3DXQUATERNION* STUB_API D3DXQuaternionBaryCentric(
     D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ1,
     const D3DXQUATERNION *pQ2, const D3DXQUATERNION *pQ3,
     float f, float g);
+D3DX_STUB_INLINE_END
 
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXPLANE methods.
@@ -1985,6 +2232,7 @@ inline D3DXPLANE* D3DXPlaneScale(D3DXPLANE *pOut, const D3DXPLANE *pP, float s)
     return pOut;
 }
 
+D3DX_STUB_INLINE_BEGIN
 // Normalize plane (so that |a,b,c| == 1)
 D3DXPLANE* STUB_API D3DXPlaneNormalize(D3DXPLANE *pOut, const D3DXPLANE *pP);
 
@@ -2005,12 +2253,522 @@ D3DXPLANE* STUB_API D3DXPlaneFromPoints(
 // M should be the inverse transpose of the transformation desired.
 D3DXPLANE* STUB_API D3DXPlaneTransform(
     D3DXPLANE *pOut, const D3DXPLANE *pP, const D3DXMATRIX *pM);
+D3DX_STUB_INLINE_END
     
 // Transform an array of planes by a matrix.  The vectors (a,b,c) must be normal.
 // M should be the inverse transpose of the transformation desired.
 D3DXPLANE* STUB_API D3DXPlaneTransformArray(
     D3DXPLANE *pOut, uint32_t OutStride, const D3DXPLANE *pP, uint32_t PStride, const D3DXMATRIX *pM, uint32_t n);
 
+///////////////////////////////////////////////////////////////////////////////
+// Structure of Arrays
+///////////////////////////////////////////////////////////////////////////////
+
+// Each component is stored in its own array, so 4 (SSE/NEON) or 8 (AVX2)
+// elements are processed per instruction. Output arrays may be the same as
+// the corresponding input arrays, but must not partially overlap them.
+
+// Split an array of vectors into separate x, y, z arrays.
+void STUB_API D3DXVec3AoSToSoA(
+    float *pX, float *pY, float *pZ, const D3DXVECTOR3 *pV, uint32_t VStride, uint32_t n);
+
+// Interleave separate x, y, z arrays into an array of vectors.
+void STUB_API D3DXVec3SoAToAoS(
+    D3DXVECTOR3 *pOut, uint32_t OutStride, const float *pX, const float *pY, const float *pZ, uint32_t n);
+
+// Split an array of vectors into separate x, y, z, w arrays.
+void STUB_API D3DXVec4AoSToSoA(
+    float *pX, float *pY, float *pZ, float *pW, const D3DXVECTOR4 *pV, uint32_t VStride, uint32_t n);
+
+// Interleave separate x, y, z, w arrays into an array of vectors.
+void STUB_API D3DXVec4SoAToAoS(
+    D3DXVECTOR4 *pOut, uint32_t OutStride, const float *pX, const float *pY, const float *pZ, const float *pW, uint32_t n);
+
+// Split an array of planes into separate a, b, c, d arrays.
+void STUB_API D3DXPlaneAoSToSoA(
+    float *pA, float *pB, float *pC, float *pD, const D3DXPLANE *pP, uint32_t PStride, uint32_t n);
+
+// Interleave separate a, b, c, d arrays into an array of planes.
+void STUB_API D3DXPlaneSoAToAoS(
+    D3DXPLANE *pOut, uint32_t OutStride, const float *pA, const float *pB, const float *pC, const float *pD, uint32_t n);
+
+// Transform SoA (x, y, z, 1) by matrix. pOutW may be NULL.
+void STUB_API D3DXVec3TransformSoA(
+    float *pOutX, float *pOutY, float *pOutZ, float *pOutW,
+    const float *pX, const float *pY, const float *pZ, const D3DXMATRIX *pM, uint32_t n);
+
+// Transform SoA (x, y, z, 1) by matrix, project result back into w=1.
+void STUB_API D3DXVec3TransformCoordSoA(
+    float *pOutX, float *pOutY, float *pOutZ,
+    const float *pX, const float *pY, const float *pZ, const D3DXMATRIX *pM, uint32_t n);
+
+// Transform SoA (x, y, z, 0) by matrix.
+void STUB_API D3DXVec3TransformNormalSoA(
+    float *pOutX, float *pOutY, float *pOutZ,
+    const float *pX, const float *pY, const float *pZ, const D3DXMATRIX *pM, uint32_t n);
+
+// Project SoA vectors from object space into screen space
+void STUB_API D3DXVec3ProjectSoA(
+    float *pOutX, float *pOutY, float *pOutZ,
+    const float *pX, const float *pY, const float *pZ, const D3DVIEWPORT9 *pViewport,
+    const D3DXMATRIX *pProjection, const D3DXMATRIX *pView, const D3DXMATRIX *pWorld, uint32_t n);
+
+// Transform SoA planes by a matrix.  The vectors (a,b,c) must be normal.
+// M should be the inverse transpose of the transformation desired.
+void STUB_API D3DXPlaneTransformSoA(
+    float *pOutA, float *pOutB, float *pOutC, float *pOutD,
+    const float *pA, const float *pB, const float *pC, const float *pD, const D3DXMATRIX *pM, uint32_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// Frustum culling
+///////////////////////////////////////////////////////////////////////////////
+
+// Result of classifying a bounding volume against a frustum.
+enum D3DXCULL
+{
+    D3DXCULL_OUTSIDE    = 0,
+    D3DXCULL_INTERSECT  = 1,
+    D3DXCULL_INSIDE     = 2,
+};
+
+// Normalized planes of a frustum (left, right, bottom, top, near, far).
+// The normals point into the frustum.
+struct D3DXFRUSTUM
+{
+    D3DXPLANE   Planes[6];
+};
+
+// Extract the frustum planes from a view-projection matrix (0 <= z <= w).
+// Pass a world-view-projection matrix to get the planes in object space.
+D3DXFRUSTUM* STUB_API D3DXFrustumFromMatrix(D3DXFRUSTUM *pOut, const D3DXMATRIX *pM);
+
+// The classifiers take SoA bounds and write one D3DXCULL value per object.
+// 4 (SSE/NEON) or 8 (AVX2) objects are tested against all six planes at
+// once. They return the number of objects that are not D3DXCULL_OUTSIDE.
+
+// Classify spheres (center, radius).
+uint32_t STUB_API D3DXFrustumClassifySpheres(
+    uint8_t *pOut, const D3DXFRUSTUM *pFrustum,
+    const float *pX, const float *pY, const float *pZ, const float *pRadius, uint32_t n);
+
+// Classify axis-aligned boxes (center, half extents).
+uint32_t STUB_API D3DXFrustumClassifyAABBs(
+    uint8_t *pOut, const D3DXFRUSTUM *pFrustum,
+    const float *pX, const float *pY, const float *pZ,
+    const float *pExtentX, const float *pExtentY, const float *pExtentZ, uint32_t n);
+
+// Classify oriented boxes (center, half extents, axes). pAxis holds 9 arrays
+// of n floats; pAxis[(3 * i + j) * n + k] is component j of local axis i of
+// box k, i.e. row i of its rotation matrix.
+uint32_t STUB_API D3DXFrustumClassifyOBBs(
+    uint8_t *pOut, const D3DXFRUSTUM *pFrustum,
+    const float *pX, const float *pY, const float *pZ,
+    const float *pExtentX, const float *pExtentY, const float *pExtentZ, const float *pAxis, uint32_t n);
+
+// Multithreaded versions of the classifiers above. Arrays with fewer than
+// D3DX_PARALLEL_THRESHOLD objects are processed on the calling thread.
+uint32_t STUB_API D3DXFrustumClassifySpheresParallel(
+    uint8_t *pOut, const D3DXFRUSTUM *pFrustum,
+    const float *pX, const float *pY, const float *pZ, const float *pRadius, uint32_t n);
+
+uint32_t STUB_API D3DXFrustumClassifyAABBsParallel(
+    uint8_t *pOut, const D3DXFRUSTUM *pFrustum,
+    const float *pX, const float *pY, const float *pZ,
+    const float *pExtentX, const float *pExtentY, const float *pExtentZ, uint32_t n);
+
+uint32_t STUB_API D3DXFrustumClassifyOBBsParallel(
+    uint8_t *pOut, const D3DXFRUSTUM *pFrustum,
+    const float *pX, const float *pY, const float *pZ,
+    const float *pExtentX, const float *pExtentY, const float *pExtentZ, const float *pAxis, uint32_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// Bounding volumes
+///////////////////////////////////////////////////////////////////////////////
+
+// The functions below read NumVertices positions dwStride bytes apart, so
+// they work directly on interleaved vertex buffers. Vertices are reduced in
+// fixed blocks whose partial results are combined in order, so the
+// multithreaded versions return exactly the same values.
+
+enum D3DXSPHEREMETHOD
+{
+    // Center at the centroid, as D3DXComputeBoundingSphere.
+    D3DXSPHERE_CENTROID = 0,
+
+    // Ritter: start from the sphere through a pair of distant vertices.
+    D3DXSPHERE_RITTER   = 1,
+
+    // EPOS-14: start from the minimum sphere of the extremal vertices along
+    // 7 directions. Usually within a few percent of the optimal sphere.
+    D3DXSPHERE_EPOS     = 2,
+};
+
+// Compute the axis-aligned bounding box of the vertices.
+HRESULT STUB_API D3DXComputeBoundingBox(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXVECTOR3 *pMin, D3DXVECTOR3 *pMax);
+
+// Compute the average of the vertices.
+HRESULT STUB_API D3DXComputeCentroid(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXVECTOR3 *pCentroid);
+
+// Compute a sphere centered at the centroid that encloses the vertices.
+HRESULT STUB_API D3DXComputeBoundingSphere(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXVECTOR3 *pCenter, float *pRadius);
+
+// Compute a bounding sphere with the given method. Ritter and EPOS spheres
+// are grown to enclose the farthest outside vertex until none is left.
+HRESULT STUB_API D3DXComputeBoundingSphereEx(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXSPHEREMETHOD Method,
+    D3DXVECTOR3 *pCenter, float *pRadius);
+
+// Multithreaded versions of the functions above. Meshes with fewer than
+// D3DX_PARALLEL_THRESHOLD vertices are processed on the calling thread.
+HRESULT STUB_API D3DXComputeBoundingBoxParallel(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXVECTOR3 *pMin, D3DXVECTOR3 *pMax);
+
+HRESULT STUB_API D3DXComputeCentroidParallel(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXVECTOR3 *pCentroid);
+
+HRESULT STUB_API D3DXComputeBoundingSphereParallel(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXVECTOR3 *pCenter, float *pRadius);
+
+HRESULT STUB_API D3DXComputeBoundingSphereExParallel(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride, D3DXSPHEREMETHOD Method,
+    D3DXVECTOR3 *pCenter, float *pRadius);
+
+///////////////////////////////////////////////////////////////////////////////
+// Ray intersection
+///////////////////////////////////////////////////////////////////////////////
+
+// Result of a ray/triangle test. The hit point is
+// D3DXVec3BaryCentric(p0, p1, p2, U, V), which equals RayPos + Dist * RayDir.
+struct D3DXINTERSECTINFO
+{
+    uint32_t    FaceIndex;
+    float       U;
+    float       V;
+    float       Dist;
+};
+
+// Intersect a ray with a triangle, from either side. Returns true and writes
+// the barycentric coordinates and the distance along the ray in units of
+// |pRayDir| if the triangle is hit at Dist >= 0.
+bool STUB_API D3DXIntersectTri(
+    const D3DXVECTOR3 *p0, const D3DXVECTOR3 *p1, const D3DXVECTOR3 *p2,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir, float *pU, float *pV, float *pDist);
+
+// 4 or 8 triangles in SoA layout. V0[c][k] is component c of the first vertex
+// of triangle k, Edge1 and Edge2 are p1 - p0 and p2 - p0.
+struct D3DXTRIANGLE4
+{
+    float   V0   [3][4];
+    float   Edge1[3][4];
+    float   Edge2[3][4];
+};
+
+struct D3DXTRIANGLE8
+{
+    float   V0   [3][8];
+    float   Edge1[3][8];
+    float   Edge2[3][8];
+};
+
+// Pack a triangle list into (NumTriangles + 3) / 4 or (NumTriangles + 7) / 8
+// packets. Triangle i uses the positions pIndices[3 * i + k], or 3 * i + k if
+// pIndices is NULL. Unused lanes of the last packet are never hit.
+D3DXTRIANGLE4* STUB_API D3DXTrianglePackets4FromMesh(
+    D3DXTRIANGLE4 *pOut, const D3DXVECTOR3 *pFirstPosition, uint32_t dwStride, const uint32_t *pIndices, uint32_t NumTriangles);
+
+D3DXTRIANGLE8* STUB_API D3DXTrianglePackets8FromMesh(
+    D3DXTRIANGLE8 *pOut, const D3DXVECTOR3 *pFirstPosition, uint32_t dwStride, const uint32_t *pIndices, uint32_t NumTriangles);
+
+// Find the nearest triangle of the packets hit by a ray. Only hits closer
+// than pHit->Dist are accepted, so set it to the maximum distance (e.g.
+// FLT_MAX) before the first call. FaceIndex is packet * 4 + lane (or 8).
+// Equally distant hits go to the smaller face index. Returns true if pHit
+// was updated. Packets of 8 are tested at once on AVX2.
+bool STUB_API D3DXIntersectTriPackets4(
+    D3DXINTERSECTINFO *pHit, const D3DXTRIANGLE4 *pPackets, uint32_t NumPackets,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir);
+
+bool STUB_API D3DXIntersectTriPackets8(
+    D3DXINTERSECTINFO *pHit, const D3DXTRIANGLE8 *pPackets, uint32_t NumPackets,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir);
+
+// Intersect n rays in SoA layout with one triangle, 4 (SSE/NEON) or 8 (AVX2)
+// rays at once. pHits[k] is set to the hit of ray k with FaceIndex if it is
+// closer than pHits[k].Dist. Returns the number of updated rays.
+uint32_t STUB_API D3DXIntersectTriRays(
+    D3DXINTERSECTINFO *pHits, const D3DXVECTOR3 *p0, const D3DXVECTOR3 *p1, const D3DXVECTOR3 *p2, uint32_t FaceIndex,
+    const float *pPosX, const float *pPosY, const float *pPosZ,
+    const float *pDirX, const float *pDirY, const float *pDirZ, uint32_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// Triangle BVH
+///////////////////////////////////////////////////////////////////////////////
+
+// Bounding volume hierarchy over a triangle list, built with binned SAH and
+// stored as 4-wide nodes whose leaves hold D3DXTRIANGLE4 packets.
+struct D3DXTRIANGLEBVH;
+
+// Build a BVH for the triangles of a mesh (see D3DXTrianglePackets4FromMesh
+// for the layout). The positions are copied, so the mesh may be released
+// afterwards. Returns D3DERR_INVALIDCALL if NumTriangles is 0 or an index is
+// out of range. The Parallel variant builds the same tree with worker threads.
+HRESULT STUB_API D3DXCreateTriangleBVH(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride,
+    const uint32_t *pIndices, uint32_t NumTriangles, D3DXTRIANGLEBVH **ppBVH);
+
+HRESULT STUB_API D3DXCreateTriangleBVHParallel(
+    const D3DXVECTOR3 *pFirstPosition, uint32_t NumVertices, uint32_t dwStride,
+    const uint32_t *pIndices, uint32_t NumTriangles, D3DXTRIANGLEBVH **ppBVH);
+
+void STUB_API D3DXDestroyTriangleBVH(D3DXTRIANGLEBVH *pBVH);
+
+// Closest hit. Same rules as D3DXIntersectTriPackets4: only hits closer than
+// pHit->Dist are accepted, ties go to the smaller face index, and FaceIndex
+// is the index of the triangle in the mesh. Returns true if pHit was updated.
+bool STUB_API D3DXTriangleBVHIntersect(
+    D3DXINTERSECTINFO *pHit, const D3DXTRIANGLEBVH *pBVH, const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir);
+
+// Any hit. Returns true if some triangle is hit at 0 <= Dist < MaxDist.
+bool STUB_API D3DXTriangleBVHOccluded(
+    const D3DXTRIANGLEBVH *pBVH, const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir, float MaxDist);
+
+// Array versions. The Intersect functions return the number of updated hits,
+// the Occluded functions write 1 or 0 per ray and return the number of 1s.
+uint32_t STUB_API D3DXTriangleBVHIntersectArray(
+    D3DXINTERSECTINFO *pHits, const D3DXTRIANGLEBVH *pBVH,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir, uint32_t n);
+
+uint32_t STUB_API D3DXTriangleBVHOccludedArray(
+    uint8_t *pOut, const D3DXTRIANGLEBVH *pBVH,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir, const float *pMaxDist, uint32_t n);
+
+uint32_t STUB_API D3DXTriangleBVHIntersectArrayParallel(
+    D3DXINTERSECTINFO *pHits, const D3DXTRIANGLEBVH *pBVH,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir, uint32_t n);
+
+uint32_t STUB_API D3DXTriangleBVHOccludedArrayParallel(
+    uint8_t *pOut, const D3DXTRIANGLEBVH *pBVH,
+    const D3DXVECTOR3 *pRayPos, const D3DXVECTOR3 *pRayDir, const float *pMaxDist, uint32_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// Animation tracks
+///////////////////////////////////////////////////////////////////////////////
+
+// Keyframes of a set of tracks (e.g. the bones of a skeleton) stored
+// contiguously. Track i owns keys [pKeyOffsets[i], pKeyOffsets[i + 1]) and
+// must have at least one key. Key times must be ascending within a track.
+struct D3DXANIMTRACKS
+{
+    uint32_t                TrackCount;
+    const uint32_t*         pKeyOffsets;    // TrackCount + 1 entries.
+    const float*            pTimes;
+    const D3DXQUATERNION*   pRotations;
+    const D3DXVECTOR3*      pTranslations;  // May be NULL.
+    const D3DXQUATERNION*   pControls;      // Squad control points, or NULL to use slerp.
+};
+
+// Compute the D3DXQuaternionSquadSetup control points (A, B, C) of every
+// key once. pOut receives 3 * pKeyOffsets[TrackCount] quaternions; point
+// pControls at it to sample the tracks with squad.
+D3DXQUATERNION* STUB_API D3DXAnimTracksSquadSetup(D3DXQUATERNION *pOut, const D3DXANIMTRACKS *pTracks);
+
+// Sample all tracks at Time. Rotations are interpolated with slerp (or squad
+// when pControls is set) and translations linearly. Times outside a track
+// clamp to its first or last key. 4 tracks are interpolated at once with SIMD.
+// pTranslationOut may be NULL.
+D3DXQUATERNION* STUB_API D3DXAnimTracksSample(
+    D3DXQUATERNION *pRotationOut, D3DXVECTOR3 *pTranslationOut, const D3DXANIMTRACKS *pTracks, float Time);
+
+// Sample n instances of the tracks (e.g. characters playing the same clip)
+// at pTimes[i]. Instance i is written to pRotationOut + i * TrackCount.
+// Instances are split across the worker pool.
+D3DXQUATERNION* STUB_API D3DXAnimTracksSampleParallel(
+    D3DXQUATERNION *pRotationOut, D3DXVECTOR3 *pTranslationOut, const D3DXANIMTRACKS *pTracks, const float *pTimes, uint32_t n);
+
+// Smallest-three quantized rotation (6 bytes). The largest component is made
+// positive and dropped, the other three are stored in the upper 15 bits of
+// v[0..2], and the index of the dropped component in the lowest bits of v[0]
+// and v[1].
+struct D3DXQUATERNION_48
+{
+    uint16_t    v[3];
+};
+
+// Convert an array of unit quaternions to D3DXQUATERNION_48 and back.
+// Each component of the decoded q (or -q) is within 1e-4 of the input.
+// The decoder expands 4 quaternions at once with SIMD.
+D3DXQUATERNION_48* STUB_API D3DXQuaternion32To48Array(D3DXQUATERNION_48 *pOut, const D3DXQUATERNION *pIn, uint32_t n);
+D3DXQUATERNION* STUB_API D3DXQuaternion48To32Array(D3DXQUATERNION *pOut, const D3DXQUATERNION_48 *pIn, uint32_t n);
+
+// Compressed keyframes of D3DXANIMTRACKS: 12 bytes per key instead of 28.
+// Translations are stored as half floats relative to a per-track origin at
+// the center of the track's translation range.
+struct D3DXCOMPRESSEDANIMTRACKS
+{
+    uint32_t                    TrackCount;
+    const uint32_t*             pKeyOffsets;    // TrackCount + 1 entries.
+    const float*                pTimes;
+    const D3DXQUATERNION_48*    pRotations;
+    const D3DXVECTOR3_16F*      pTranslations;  // May be NULL.
+    const D3DXVECTOR3*          pOrigins;       // TrackCount entries, required with pTranslations.
+};
+
+// Compress the keys of pTracks. pRotationOut and pTranslationOut receive
+// pKeyOffsets[TrackCount] keys and pOriginOut TrackCount origins. Key offsets
+// and times are shared with the source tracks. pTranslationOut may be NULL.
+D3DXQUATERNION_48* STUB_API D3DXAnimTracksCompress(
+    D3DXQUATERNION_48 *pRotationOut, D3DXVECTOR3_16F *pTranslationOut, D3DXVECTOR3 *pOriginOut, const D3DXANIMTRACKS *pTracks);
+
+// D3DXAnimTracksSample with slerp on compressed tracks. The keys are decoded
+// straight into the SIMD lanes of the interpolation.
+D3DXQUATERNION* STUB_API D3DXCompressedAnimTracksSample(
+    D3DXQUATERNION *pRotationOut, D3DXVECTOR3 *pTranslationOut, const D3DXCOMPRESSEDANIMTRACKS *pTracks, float Time);
+
+D3DXQUATERNION* STUB_API D3DXCompressedAnimTracksSampleParallel(
+    D3DXQUATERNION *pRotationOut, D3DXVECTOR3 *pTranslationOut, const D3DXCOMPRESSEDANIMTRACKS *pTracks, const float *pTimes, uint32_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// Dual quaternions
+///////////////////////////////////////////////////////////////////////////////
+
+// Rigid transform (rotation and translation) in 8 floats. Real is the
+// rotation and Dual is 0.5 * t * Real, where t = (x, y, z, 0). Like
+// D3DXQuaternionMultiply, products apply the first argument first.
+struct D3DXDUALQUATERNION
+{
+    D3DXQUATERNION  Real;
+    D3DXQUATERNION  Dual;
+};
+
+// (0, 0, 0, 1) + e(0, 0, 0, 0)
+inline D3DXDUALQUATERNION* D3DXDualQuaternionIdentity(D3DXDUALQUATERNION *pOut)
+{
+    assert(pOut != nullptr);
+    pOut->Real = D3DXQUATERNION(0.0f, 0.0f, 0.0f, 1.0f);
+    pOut->Dual = D3DXQUATERNION(0.0f, 0.0f, 0.0f, 0.0f);
+    return pOut;
+}
+
+// Build a dual quaternion from a unit rotation and a translation.
+// pTranslation may be NULL.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionRotationTranslation(
+    D3DXDUALQUATERNION *pOut, const D3DXQUATERNION *pRotation, const D3DXVECTOR3 *pTranslation);
+
+// Extract the rotation and translation. Either output may be NULL.
+void STUB_API D3DXDualQuaternionToRotationTranslation(
+    D3DXQUATERNION *pOutRotation, D3DXVECTOR3 *pOutTranslation, const D3DXDUALQUATERNION *pDQ);
+
+// Build a dual quaternion from a matrix. Scaling is removed as in
+// D3DXMatrixDecompose; matrices that cannot be decomposed give identity.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionFromMatrix(D3DXDUALQUATERNION *pOut, const D3DXMATRIX *pM);
+
+// Build a rotation-translation matrix from a unit dual quaternion.
+D3DXMATRIX* STUB_API D3DXMatrixDualQuaternion(D3DXMATRIX *pOut, const D3DXDUALQUATERNION *pDQ);
+
+// Transform DQ1 then DQ2, like D3DXMatrixMultiply.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionMultiply(
+    D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ1, const D3DXDUALQUATERNION *pDQ2);
+
+// Make Real unit length and Dual orthogonal to it.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionNormalize(D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ);
+
+// Screw linear interpolation: constant speed rotation about and translation
+// along the screw axis between two unit dual quaternions (shortest path).
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionScLerp(
+    D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ1, const D3DXDUALQUATERNION *pDQ2, float t);
+
+// Dual quaternion linear blending of n unit dual quaternions. Elements are
+// flipped to the hemisphere of pDQ[0] before the weighted sum is normalized.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionBlend(
+    D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ, const float *pWeights, uint32_t n);
+
+// Array versions of the functions above. 4 elements are processed at once
+// with SIMD. Outputs may be the same arrays as the inputs.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionMultiplyArray(
+    D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ1, const D3DXDUALQUATERNION *pDQ2, uint32_t n);
+
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionNormalizeArray(
+    D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ, uint32_t n);
+
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionScLerpArray(
+    D3DXDUALQUATERNION *pOut, const D3DXDUALQUATERNION *pDQ1, const D3DXDUALQUATERNION *pDQ2, float t, uint32_t n);
+
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionFromMatrixArray(
+    D3DXDUALQUATERNION *pOut, const D3DXMATRIX *pM, uint32_t n);
+
+D3DXMATRIX* STUB_API D3DXMatrixDualQuaternionArray(
+    D3DXMATRIX *pOut, const D3DXDUALQUATERNION *pDQ, uint32_t n);
+
+// Multithreaded versions of the matrix conversions. Arrays with fewer than
+// D3DX_PARALLEL_THRESHOLD elements are processed on the calling thread.
+D3DXDUALQUATERNION* STUB_API D3DXDualQuaternionFromMatrixArrayParallel(
+    D3DXDUALQUATERNION *pOut, const D3DXMATRIX *pM, uint32_t n);
+
+D3DXMATRIX* STUB_API D3DXMatrixDualQuaternionArrayParallel(
+    D3DXMATRIX *pOut, const D3DXDUALQUATERNION *pDQ, uint32_t n);
+
+///////////////////////////////////////////////////////////////////////////////
+// Skinning
+///////////////////////////////////////////////////////////////////////////////
+
+// Vertex streams of D3DXSkinVertices. Every stream has its own stride in
+// bytes, so the streams may be interleaved in one vertex buffer. Vertex i
+// is influenced by bones pIndices[k] with weights pWeights[k] for
+// k < InfluenceCount. pNormal and pNormalOut may be NULL, and the outputs
+// may be the same buffers as the inputs.
+struct D3DXSKINSTREAMS
+{
+    uint32_t            VertexCount;
+    uint32_t            InfluenceCount;
+    const D3DXVECTOR3*  pPosition;
+    uint32_t            PositionStride;
+    const D3DXVECTOR3*  pNormal;
+    uint32_t            NormalStride;
+    const uint8_t*      pIndices;
+    uint32_t            IndicesStride;
+    const float*        pWeights;
+    uint32_t            WeightsStride;
+    D3DXVECTOR3*        pPositionOut;
+    uint32_t            PositionOutStride;
+    D3DXVECTOR3*        pNormalOut;
+    uint32_t            NormalOutStride;
+};
+
+enum D3DXSKINMETHOD
+{
+    // Blend the bone matrices with the weights. Bones may contain scaling;
+    // normals are transformed by the inverse transpose of the blended matrix.
+    D3DXSKIN_LINEAR         = 0,
+
+    // Blend the bones as dual quaternions, which keeps the volume of twisted
+    // joints. Bones must be rigid (rotation and translation only), and
+    // normals are transformed by the blended rotation.
+    D3DXSKIN_DUALQUATERNION = 1,
+};
+
+// Skin the vertices with a palette of BoneCount bone matrices in one pass.
+// Positions are transformed as (x, y, z, 1). Normals are transformed as
+// described for each method, then renormalized. Returns NULL for invalid
+// arguments.
+D3DXVECTOR3* STUB_API D3DXSkinVertices(
+    const D3DXSKINSTREAMS *pStreams, const D3DXMATRIX *pBones, uint32_t BoneCount, D3DXSKINMETHOD Method);
+
+// Multithreaded version of D3DXSkinVertices. Meshes with fewer than
+// D3DX_PARALLEL_THRESHOLD vertices are processed on the calling thread.
+D3DXVECTOR3* STUB_API D3DXSkinVerticesParallel(
+    const D3DXSKINSTREAMS *pStreams, const D3DXMATRIX *pBones, uint32_t BoneCount, D3DXSKINMETHOD Method);
+
+// Skin the vertices with a palette of dual quaternions, skipping the matrix
+// conversion of D3DXSKIN_DUALQUATERNION.
+D3DXVECTOR3* STUB_API D3DXSkinVerticesDualQuaternion(
+    const D3DXSKINSTREAMS *pStreams, const D3DXDUALQUATERNION *pBones, uint32_t BoneCount);
+
+D3DXVECTOR3* STUB_API D3DXSkinVerticesDualQuaternionParallel(
+    const D3DXSKINSTREAMS *pStreams, const D3DXDUALQUATERNION *pBones, uint32_t BoneCount);
+
 ///////////////////////////////////////////////////////////////////////////////
 // D3DXCOLOR methods.
 ///////////////////////////////////////////////////////////////////////////////
@@ -2097,6 +2855,79 @@ D3DXCOLOR* STUB_API D3DXColorAdjustSaturation(
 D3DXCOLOR* STUB_API D3DXColorAdjustContrast(
     D3DXCOLOR *pOut, const D3DXCOLOR *pC, float c);
 
+// Color space of packed colors for D3DXColorFromARGBArray / D3DXColorToARGBArray.
+enum D3DXCOLORSPACE
+{
+    D3DXCOLORSPACE_LINEAR   = 0,    // same as D3DXCOLOR(uint32_t) and operator uint32_t
+    D3DXCOLORSPACE_SRGB     = 1,    // r, g, b are sRGB encoded, a is linear
+};
+
+// Convert n A8R8G8B8 colors to D3DXCOLOR and back. With D3DXCOLORSPACE_SRGB,
+// r, g and b are decoded to linear on load and encoded to the nearest 8-bit
+// sRGB value on store. Values are clamped to [0, 1] and NaN is stored as 0.
+D3DXCOLOR* STUB_API D3DXColorFromARGBArray(
+    D3DXCOLOR *pOut, const uint32_t *pIn, uint32_t n, D3DXCOLORSPACE ColorSpace);
+
+uint32_t* STUB_API D3DXColorToARGBArray(
+    uint32_t *pOut, const D3DXCOLOR *pIn, uint32_t n, D3DXCOLORSPACE ColorSpace);
+
+D3DXCOLOR* STUB_API D3DXColorFromARGBArrayParallel(
+    D3DXCOLOR *pOut, const uint32_t *pIn, uint32_t n, D3DXCOLORSPACE ColorSpace);
+
+uint32_t* STUB_API D3DXColorToARGBArrayParallel(
+    uint32_t *pOut, const D3DXCOLOR *pIn, uint32_t n, D3DXCOLORSPACE ColorSpace);
+
+// Pixel formats of D3DXCOLORIMAGE.
+enum D3DXCOLORFORMAT
+{
+    D3DXCOLORFORMAT_A32B32G32R32F   = 0,    // D3DXCOLOR
+    D3DXCOLORFORMAT_A16B16G16R16F   = 1,    // D3DXFLOAT16 in r, g, b, a order
+    D3DXCOLORFORMAT_A8R8G8B8        = 2,    // uint32_t, same as D3DXCOLOR(uint32_t)
+    D3DXCOLORFORMAT_A8R8G8B8_SRGB   = 3,    // uint32_t, r, g, b are sRGB encoded
+};
+
+// 2D image in memory. pBits points to the top-left pixel and Pitch is the
+// number of bytes between rows.
+struct D3DXCOLORIMAGE
+{
+    void*               pBits;
+    uint32_t            Width;
+    uint32_t            Height;
+    uint32_t            Pitch;
+    D3DXCOLORFORMAT     Format;
+};
+
+// Per-pixel operations of D3DXColorImageApply. Each one matches the D3DXColor
+// function of the same name applied to the pixel to within 1 ulp.
+enum D3DXCOLOROPTYPE
+{
+    D3DXCOLOROP_ADJUSTSATURATION    = 0,    // D3DXColorAdjustSaturation(c, Factor)
+    D3DXCOLOROP_ADJUSTCONTRAST      = 1,    // D3DXColorAdjustContrast(c, Factor)
+    D3DXCOLOROP_MODULATE            = 2,    // D3DXColorModulate(c, operand)
+    D3DXCOLOROP_LERP                = 3,    // D3DXColorLerp(c, operand, Factor)
+};
+
+// The operand of MODULATE and LERP is the pixel at the same position of
+// pImage, or Color if pImage is NULL.
+struct D3DXCOLOROP
+{
+    D3DXCOLOROPTYPE         Type;
+    float                   Factor;
+    D3DXCOLOR               Color;
+    const D3DXCOLORIMAGE*   pImage;
+};
+
+// Apply NumOps operations in order to every pixel of pSrc and write the
+// result to pDest, converting between the formats on the way. The image is
+// processed in tiles and each pixel is loaded and stored once however many
+// operations are chained. pSrc may be NULL or equal to pDest to work in place.
+// All images must have the same size.
+HRESULT STUB_API D3DXColorImageApply(
+    const D3DXCOLORIMAGE *pDest, const D3DXCOLORIMAGE *pSrc, const D3DXCOLOROP *pOps, uint32_t NumOps);
+
+HRESULT STUB_API D3DXColorImageApplyParallel(
+    const D3DXCOLORIMAGE *pDest, const D3DXCOLORIMAGE *pSrc, const D3DXCOLOROP *pOps, uint32_t NumOps);
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Misc Methods.
@@ -2106,6 +2937,14 @@ D3DXCOLOR* STUB_API D3DXColorAdjustContrast(
 // taking the dot of two normals), and the refraction index of the material.
 float STUB_API D3DXFresnelTerm(float CosTheta, float RefractionIndex); 
 
+// Set the number of threads (including the calling thread) used by the
+// multithreaded array APIs. 0 selects the hardware thread count, 1 disables
+// worker threads. Must not be called while a multithreaded call is running.
+void STUB_API D3DXSetWorkerThreadCount(uint32_t ThreadCount);
+
+// Get the number of threads used by the multithreaded array APIs.
+uint32_t STUB_API D3DXGetWorkerThreadCount();
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Spherical Harmonic Methods
@@ -2114,15 +2953,65 @@ float STUB_API D3DXFresnelTerm(float CosTheta, float RefractionIndex);
 #define D3DXSH_MINORDER 2
 #define D3DXSH_MAXORDER 6
 
+// Floats needed to store the rotation blocks of bands 1 .. D3DXSH_MAXORDER-1.
+// Each column is padded to a multiple of four.
+#define D3DXSH_ROTATEPLAN_SIZE  348
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXSHROTATEPLAN structure
+///////////////////////////////////////////////////////////////////////////////
+// Rotation of SH functions by a fixed matrix. Build it once with
+// D3DXSHRotatePlanInit and apply it to many functions, instead of calling
+// D3DXSHRotate with the same matrix repeatedly.
+struct alignas(16) D3DXSHROTATEPLAN
+{
+    float       Block[D3DXSH_ROTATEPLAN_SIZE];  // dense (2l+1)x(2l+1) block of each band l > 0.
+    uint32_t    Order;
+
+    D3DX_ALIGNED_OPERATOR_NEW(16)
+};
+
 float* STUB_API D3DXSHEvalDirection(
     float *pOut, uint32_t Order, const D3DXVECTOR3 *pDir);
 
+// Evaluate the SH basis for n unit directions. Coefficient i of the k-th
+// direction is stored at pOut[i * n + k], the layout used by
+// D3DXSHMultiplySoA. Four directions are evaluated at once with SIMD.
+float* STUB_API D3DXSHEvalDirectionArray(
+    float *pOut, uint32_t Order, const D3DXVECTOR3 *pDir, uint32_t DirStride, uint32_t n);
+
+float* STUB_API D3DXSHEvalDirectionSoA(
+    float *pOut, uint32_t Order, const float *pX, const float *pY, const float *pZ, uint32_t n);
+
+// Multithreaded versions of the batch evaluation above. Arrays with fewer
+// than D3DX_PARALLEL_THRESHOLD directions are processed on the calling thread.
+float* STUB_API D3DXSHEvalDirectionArrayParallel(
+    float *pOut, uint32_t Order, const D3DXVECTOR3 *pDir, uint32_t DirStride, uint32_t n);
+
+float* STUB_API D3DXSHEvalDirectionSoAParallel(
+    float *pOut, uint32_t Order, const float *pX, const float *pY, const float *pZ, uint32_t n);
+
 float* STUB_API D3DXSHRotate(
     float *pOut, uint32_t Order, const D3DXMATRIX *pMatrix, const float *pIn);
 
 float* STUB_API D3DXSHRotateZ(
     float *pOut, uint32_t Order, float Angle, const float *pIn);
 
+// Build a rotation plan for SH functions of the given order.
+D3DXSHROTATEPLAN* STUB_API D3DXSHRotatePlanInit(
+    D3DXSHROTATEPLAN *pOut, uint32_t Order, const D3DXMATRIX *pMatrix);
+
+// Rotate n SH functions of Order * Order floats each. pOut may equal pIn to
+// rotate in place; NULL is returned if they partially overlap.
+float* STUB_API D3DXSHRotatePlanApply(
+    float *pOut, const D3DXSHROTATEPLAN *pPlan, const float *pIn, uint32_t n);
+
+// Rotate n SH functions stored as structure of arrays, the layout used by
+// D3DXSHMultiplySoA. Four functions are rotated at once with SIMD. The same
+// aliasing rules as D3DXSHRotatePlanApply apply.
+float* STUB_API D3DXSHRotatePlanApplySoA(
+    float *pOut, const D3DXSHROTATEPLAN *pPlan, const float *pIn, uint32_t n);
+
 float* STUB_API D3DXSHAdd(
     float *pOut, uint32_t Order, const float *pA, const float *pB);
 
@@ -2132,12 +3021,27 @@ float* STUB_API D3DXSHScale(
 float STUB_API D3DXSHDot(
     uint32_t Order, const float *pA, const float *pB);
 
+// Multiply two SH functions. pOut may be the same as pF or pG.
 float* STUB_API D3DXSHMultiply2(float *pOut, const float *pF, const float *pG);
 float* STUB_API D3DXSHMultiply3(float *pOut, const float *pF, const float *pG);
 float* STUB_API D3DXSHMultiply4(float *pOut, const float *pF, const float *pG);
 float* STUB_API D3DXSHMultiply5(float *pOut, const float *pF, const float *pG);
 float* STUB_API D3DXSHMultiply6(float *pOut, const float *pF, const float *pG);
 
+// Multiply n pairs of SH functions stored as structure of arrays. Coefficient
+// i of the k-th function is stored at p[i * n + k]. Four products are
+// evaluated at once with SIMD.
+float* STUB_API D3DXSHMultiplySoA(
+    float *pOut, uint32_t Order, const float *pF, const float *pG, uint32_t n);
+
+// Split an array of n SH functions (Order * Order floats each) into
+// coefficient planes for D3DXSHMultiplySoA, and back again.
+float* STUB_API D3DXSHAoSToSoA(
+    float *pOut, uint32_t Order, const float *pIn, uint32_t n);
+
+float* STUB_API D3DXSHSoAToAoS(
+    float *pOut, uint32_t Order, const float *pIn, uint32_t n);
+
 HRESULT STUB_API D3DXSHEvalDirectionalLight(
     uint32_t Order, const D3DXVECTOR3 *pDir, 
     float RIntensity, float GIntensity, float BIntensity,
@@ -2157,9 +3061,70 @@ HRESULT STUB_API D3DXSHEvalHemisphereLight(
     uint32_t Order, const D3DXVECTOR3 *pDir, D3DXCOLOR Top, D3DXCOLOR Bottom,
     float *pROut, float *pGOut, float *pBOut);
 
+// Light types accepted by D3DXSHEvalLights.
+enum D3DXSHLIGHTTYPE
+{
+    D3DXSHLIGHT_DIRECTIONAL = 0,    // D3DXSHEvalDirectionalLight
+    D3DXSHLIGHT_SPHERICAL   = 1,    // D3DXSHEvalSphericalLight
+    D3DXSHLIGHT_CONE        = 2,    // D3DXSHEvalConeLight
+    D3DXSHLIGHT_HEMISPHERE  = 3,    // D3DXSHEvalHemisphereLight
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXSHLIGHT structure
+///////////////////////////////////////////////////////////////////////////////
+struct D3DXSHLIGHT
+{
+    D3DXSHLIGHTTYPE Type;
+    D3DXVECTOR3     Vector;     // direction, or position of a spherical light.
+    float           Radius;     // radius of a spherical light, or cone angle.
+    D3DXCOLOR       Color;      // intensity, or top color of a hemisphere light.
+    D3DXCOLOR       Bottom;     // bottom color of a hemisphere light.
+};
+
+// Sum the SH projections of n lights, as if each light were evaluated with
+// the matching D3DXSHEval*Light function and the results added. Four lights
+// are evaluated at once with SIMD.
+HRESULT STUB_API D3DXSHEvalLights(
+    uint32_t Order, const D3DXSHLIGHT *pLights, uint32_t n,
+    float *pROut, float *pGOut, float *pBOut);
+
+// Evaluate the lights at nProbes positions. Spherical lights are placed
+// relative to each probe; the other lights do not depend on the position and
+// are evaluated once. The result of probe k is stored at pROut + k * Order * Order.
+// Probes are processed by the worker pool when there is enough work.
+HRESULT STUB_API D3DXSHEvalLightsAtProbes(
+    uint32_t Order, const D3DXSHLIGHT *pLights, uint32_t nLights,
+    const D3DXVECTOR3 *pProbes, uint32_t nProbes,
+    float *pROut, float *pGOut, float *pBOut);
+
 #if 0
 // 非サポート.
 HRESULT WINAPI D3DXSHProjectCubeMap(
     uint32_t uOrder, LPDIRECT3DCUBETEXTURE9 pCubeMap,
     float* pROut, float* pGOut, float* pBOut );
-#endif
\ No newline at end of file
+#endif
+
+// Texel formats of cube map faces given to D3DXSHProjectCubeMap.
+// Channels are stored in R, G, B, A order.
+enum D3DXSHCUBEFORMAT
+{
+    D3DXSHCUBEFORMAT_A32B32G32R32F  = 0,    // float
+    D3DXSHCUBEFORMAT_A16B16G16R16F  = 1,    // D3DXFLOAT16
+    D3DXSHCUBEFORMAT_A8B8G8R8       = 2,    // 8bit unsigned normalized
+};
+
+// Project a cube map held in memory onto the SH basis. ppFaces points to the
+// top-left texel of each face in D3DCUBEMAP_FACE_POSITIVE_X .. NEGATIVE_Z
+// order. Each face is Size x Size texels and rows are Pitch bytes apart.
+// Large cube maps are processed by the worker pool.
+HRESULT STUB_API D3DXSHProjectCubeMap(
+    uint32_t Order, const void* const* ppFaces, uint32_t Size, uint32_t Pitch,
+    D3DXSHCUBEFORMAT Format, float *pROut, float *pGOut, float *pBOut);
+
+
+#if defined(D3DX9MATH_STUB_INLINE)
+D3DX_STUB_INLINE_BEGIN
+#include "d3dx9math_stub.inl"
+D3DX_STUB_INLINE_END
+#endif//D3DX9MATH_STUB_INLINE
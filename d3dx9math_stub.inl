@@ -0,0 +1,1475 @@
+﻿//-----------------------------------------------------------------------------
+// File : d3dx9math_stub.inl
+// Desc : Thin DirectXMath wrappers.
+//        Compiled out-of-line by d3dx9math_stub.cpp, or inline from
+//        d3dx9math_stub.h when D3DX9MATH_STUB_INLINE is defined.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+// ラッパー関数の内部で使う補助関数. D3DX9MATH_STUB_INLINE の場合は利用側から見えるので,
+// 一般的な名前と衝突しないようにライブラリ固有の名前空間に置く.
+namespace d3dx9math_stub_detail {
+
+static constexpr HRESULT kD3D_OK               = 0;            // S_OK.
+static constexpr HRESULT kD3DERR_INVALIDCALL   = MAKE_D3DHRESULT(2156);
+
+// 16バイト境界に揃っている場合はアラインメント指定のロード/ストアを使う.
+inline bool IsAligned16(const void* ptr)
+{ return (reinterpret_cast<uintptr_t>(ptr) & 0xF) == 0; }
+
+inline DirectX::XMMATRIX LoadMatrix(const DirectX::XMFLOAT4X4* pM)
+{
+    return IsAligned16(pM)
+        ? DirectX::XMLoadFloat4x4A(reinterpret_cast<const DirectX::XMFLOAT4X4A*>(pM))
+        : DirectX::XMLoadFloat4x4(pM);
+}
+
+inline void StoreMatrix(DirectX::XMFLOAT4X4* pOut, DirectX::FXMMATRIX m)
+{
+    if (IsAligned16(pOut))
+    { DirectX::XMStoreFloat4x4A(reinterpret_cast<DirectX::XMFLOAT4X4A*>(pOut), m); }
+    else
+    { DirectX::XMStoreFloat4x4(pOut, m); }
+}
+
+inline DirectX::XMVECTOR LoadFloat4(const DirectX::XMFLOAT4* pV)
+{
+    return IsAligned16(pV)
+        ? DirectX::XMLoadFloat4A(reinterpret_cast<const DirectX::XMFLOAT4A*>(pV))
+        : DirectX::XMLoadFloat4(pV);
+}
+
+inline void StoreFloat4(DirectX::XMFLOAT4* pOut, DirectX::FXMVECTOR v)
+{
+    if (IsAligned16(pOut))
+    { DirectX::XMStoreFloat4A(reinterpret_cast<DirectX::XMFLOAT4A*>(pOut), v); }
+    else
+    { DirectX::XMStoreFloat4(pOut, v); }
+}
+
+} // namespace d3dx9math_stub_detail
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXVECTOR2
+///////////////////////////////////////////////////////////////////////////////
+D3DX_STUB_INLINE D3DXVECTOR2* STUB_API D3DXVec2Normalize(D3DXVECTOR2 *pOut, const D3DXVECTOR2 *pV)
+{
+    auto v   = DirectX::XMLoadFloat2(pV);
+    auto ret = DirectX::XMVector2Normalize(v);
+    DirectX::XMStoreFloat2(pOut, ret);
+    return pOut;
+}
+
+// Hermite interpolation between position V1, tangent T1 (when s == 0)
+// and position V2, tangent T2 (when s == 1).
+D3DX_STUB_INLINE D3DXVECTOR2* STUB_API D3DXVec2Hermite
+(
+     D3DXVECTOR2*       pOut,
+    const D3DXVECTOR2*  pV1,
+    const D3DXVECTOR2*  pT1,
+    const D3DXVECTOR2*  pV2,
+    const D3DXVECTOR2*  pT2,
+    float               s
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pT1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pT2  != nullptr);
+
+    auto v1  = DirectX::XMLoadFloat2(pV1);
+    auto t1  = DirectX::XMLoadFloat2(pT1);
+    auto v2  = DirectX::XMLoadFloat2(pV2);
+    auto t2  = DirectX::XMLoadFloat2(pT2);
+    auto vs  = DirectX::XMVectorSet(s, s, 0.0f, 0.0f);
+    auto ret = DirectX::XMVectorHermiteV(v1, t1, v2, t2, vs);
+    DirectX::XMStoreFloat2(pOut, ret);
+    return pOut;
+}
+
+// CatmullRom interpolation between V1 (when s == 0) and V2 (when s == 1)
+D3DX_STUB_INLINE D3DXVECTOR2* STUB_API D3DXVec2CatmullRom
+(
+    D3DXVECTOR2*        pOut,
+    const D3DXVECTOR2*  pV0,
+    const D3DXVECTOR2*  pV1,
+    const D3DXVECTOR2*  pV2,
+    const D3DXVECTOR2*  pV3,
+    float               s
+)
+{
+    assert(pOut != nullptr);
+    assert(pV0  != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v0  = DirectX::XMLoadFloat2(pV0);
+    auto v1  = DirectX::XMLoadFloat2(pV1);
+    auto v2  = DirectX::XMLoadFloat2(pV2);
+    auto v3  = DirectX::XMLoadFloat2(pV3);
+    auto vs  = DirectX::XMVectorSet(s, s, 0.0f, 0.0f);
+    auto ret = DirectX::XMVectorCatmullRomV(v0, v1, v2, v3, vs);
+    DirectX::XMStoreFloat2(pOut, ret);
+    return pOut;
+}
+
+// Barycentric coordinates.  V1 + f(V2-V1) + g(V3-V1)
+D3DX_STUB_INLINE D3DXVECTOR2* STUB_API D3DXVec2BaryCentric
+(
+    D3DXVECTOR2*        pOut,
+    const D3DXVECTOR2*  pV1,
+    const D3DXVECTOR2*  pV2,
+    const D3DXVECTOR2*  pV3,
+    float               f,
+    float               g
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v1  = DirectX::XMLoadFloat2(pV1);
+    auto v2  = DirectX::XMLoadFloat2(pV2);
+    auto v3  = DirectX::XMLoadFloat2(pV3);
+    auto vf  = DirectX::XMVectorSet(f, f, 0.0f, 0.0f);
+    auto vg  = DirectX::XMVectorSet(g, g, 0.0f, 0.0f);
+    auto ret = DirectX::XMVectorBaryCentricV(v1, v2, v3, vf, vg);
+    DirectX::XMStoreFloat2(pOut, ret);
+    return pOut;
+}
+
+// Transform (x, y, 0, 1) by matrix.
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec2Transform
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR2*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat2(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector2Transform(vec, mat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Transform (x, y, 0, 1) by matrix, project result back into w=1.
+D3DX_STUB_INLINE D3DXVECTOR2* STUB_API D3DXVec2TransformCoord
+(
+    D3DXVECTOR2*        pOut,
+    const D3DXVECTOR2*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat2(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector2TransformCoord(vec, mat);
+    DirectX::XMStoreFloat2(pOut, ret);
+    return pOut;
+}
+
+// Transform (x, y, 0, 0) by matrix.
+D3DX_STUB_INLINE D3DXVECTOR2* STUB_API D3DXVec2TransformNormal
+(
+    D3DXVECTOR2*        pOut,
+    const D3DXVECTOR2*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat2(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector2TransformNormal(vec, mat);
+    DirectX::XMStoreFloat2(pOut, ret);
+    return pOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXVECTOR3
+///////////////////////////////////////////////////////////////////////////////
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3Normalize(D3DXVECTOR3 *pOut, const D3DXVECTOR3 *pV)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat3(pV);
+    auto ret = DirectX::XMVector3Normalize(vec);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Hermite interpolation between position V1, tangent T1 (when s == 0)
+// and position V2, tangent T2 (when s == 1).
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3Hermite
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV1,
+    const D3DXVECTOR3*  pT1,
+    const D3DXVECTOR3*  pV2,
+    const D3DXVECTOR3*  pT2,
+    float               s
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pT1  != nullptr);
+    assert(pV2  != nullptr);
+
+    auto v1  = DirectX::XMLoadFloat3(pV1);
+    auto t1  = DirectX::XMLoadFloat3(pT1);
+    auto v2  = DirectX::XMLoadFloat3(pV2);
+    auto t2  = DirectX::XMLoadFloat3(pT2);
+    auto vs  = DirectX::XMVectorSet(s, s, s, 0.0f);
+    auto ret = DirectX::XMVectorHermiteV(v1, t1, v2, t2, vs);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// CatmullRom interpolation between V1 (when s == 0) and V2 (when s == 1)
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3CatmullRom
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV0,
+    const D3DXVECTOR3*  pV1,
+    const D3DXVECTOR3*  pV2,
+    const D3DXVECTOR3*  pV3,
+    float               s
+)
+{
+    assert(pOut != nullptr);
+    assert(pV0  != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v0  = DirectX::XMLoadFloat3(pV0);
+    auto v1  = DirectX::XMLoadFloat3(pV1);
+    auto v2  = DirectX::XMLoadFloat3(pV2);
+    auto v3  = DirectX::XMLoadFloat3(pV3);
+    auto vs  = DirectX::XMVectorSet(s, s, s, 0.0f);
+    auto ret = DirectX::XMVectorCatmullRomV(v0, v1, v2, v3, vs);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Barycentric coordinates.  V1 + f(V2-V1) + g(V3-V1)
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3BaryCentric
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV1,
+    const D3DXVECTOR3*  pV2,
+    const D3DXVECTOR3*  pV3,
+    float               f,
+    float               g
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v1  = DirectX::XMLoadFloat3(pV1);
+    auto v2  = DirectX::XMLoadFloat3(pV2);
+    auto v3  = DirectX::XMLoadFloat3(pV3);
+    auto vf  = DirectX::XMVectorSet(f, f, f, 0.0f);
+    auto vg  = DirectX::XMVectorSet(g, g, g, 0.0f);
+    auto ret = DirectX::XMVectorBaryCentricV(v1, v2, v3, vf, vg);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Transform (x, y, z, 1) by matrix.
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec3Transform
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR3*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat3(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector3Transform(vec, mat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Transform (x, y, z, 1) by matrix, project result back into w=1.
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3TransformCoord
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat3(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector3TransformCoord(vec, mat);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Transform (x, y, z, 0) by matrix.  If you transforming a normal by a 
+// non-affine matrix, the matrix you pass to this function should be the 
+// transpose of the inverse of the matrix you would use to transform a coord.
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3TransformNormal
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = DirectX::XMLoadFloat3(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector3TransformNormal(vec, mat);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Project vector from object space into screen space
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3Project
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV,
+    const D3DVIEWPORT9* pViewport,
+    const D3DXMATRIX*   pProjection,
+    const D3DXMATRIX*   pView,
+    const D3DXMATRIX*   pWorld
+)
+{
+    assert(pOut        != nullptr);
+    assert(pV          != nullptr);
+    assert(pViewport   != nullptr);
+    assert(pProjection != nullptr);
+    assert(pView       != nullptr);
+    assert(pWorld      != nullptr);
+
+    auto x = float(pViewport->X);
+    auto y = float(pViewport->Y);
+    auto w = float(pViewport->Width);
+    auto h = float(pViewport->Height);
+
+    auto vec   = DirectX::XMLoadFloat3(pV);
+    auto proj  = d3dx9math_stub_detail::LoadMatrix(pProjection);
+    auto view  = d3dx9math_stub_detail::LoadMatrix(pView);
+    auto world = d3dx9math_stub_detail::LoadMatrix(pWorld);
+    auto ret   = DirectX::XMVector3Project(vec, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Project vector from screen space into object space
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXVec3Unproject
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXVECTOR3*  pV,
+    const D3DVIEWPORT9* pViewport,
+    const D3DXMATRIX*   pProjection,
+    const D3DXMATRIX*   pView,
+    const D3DXMATRIX*   pWorld
+)
+{
+    assert(pOut        != nullptr);
+    assert(pV          != nullptr);
+    assert(pViewport   != nullptr);
+    assert(pProjection != nullptr);
+    assert(pView       != nullptr);
+    assert(pWorld      != nullptr);
+
+    auto x = float(pViewport->X);
+    auto y = float(pViewport->Y);
+    auto w = float(pViewport->Width);
+    auto h = float(pViewport->Height);
+
+    auto vec   = DirectX::XMLoadFloat3(pV);
+    auto proj  = d3dx9math_stub_detail::LoadMatrix(pProjection);
+    auto view  = d3dx9math_stub_detail::LoadMatrix(pView);
+    auto world = d3dx9math_stub_detail::LoadMatrix(pWorld);
+    auto ret   = DirectX::XMVector3Unproject(vec, x, y, w, h, pViewport->MinZ, pViewport->MaxZ, proj, view, world);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXVECTOR4
+///////////////////////////////////////////////////////////////////////////////
+// Cross-product in 4 dimensions.
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec4Cross
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR4*  pV1,
+    const D3DXVECTOR4*  pV2,
+    const D3DXVECTOR4*  pV3
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v1  = d3dx9math_stub_detail::LoadFloat4(pV1);
+    auto v2  = d3dx9math_stub_detail::LoadFloat4(pV2);
+    auto v3  = d3dx9math_stub_detail::LoadFloat4(pV3);
+    auto ret = DirectX::XMVector4Cross(v1, v2, v3);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec4Normalize
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR4*  pV
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+
+    auto vec = d3dx9math_stub_detail::LoadFloat4(pV);
+    auto ret = DirectX::XMVector4Normalize(vec);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Hermite interpolation between position V1, tangent T1 (when s == 0)
+// and position V2, tangent T2 (when s == 1).
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec4Hermite
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR4*  pV1,
+    const D3DXVECTOR4*  pT1,
+    const D3DXVECTOR4*  pV2,
+    const D3DXVECTOR4*  pT2,
+    float               s 
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pT1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pT2  != nullptr);
+
+    auto v1  = d3dx9math_stub_detail::LoadFloat4(pV1);
+    auto t1  = d3dx9math_stub_detail::LoadFloat4(pT1);
+    auto v2  = d3dx9math_stub_detail::LoadFloat4(pV2);
+    auto t2  = d3dx9math_stub_detail::LoadFloat4(pT2);
+    auto vs  = DirectX::XMVectorSet(s, s, s, s);
+    auto ret = DirectX::XMVectorHermiteV(v1, t1, v2, t2, vs);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// CatmullRom interpolation between V1 (when s == 0) and V2 (when s == 1)
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec4CatmullRom
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR4*  pV0,
+    const D3DXVECTOR4*  pV1,
+    const D3DXVECTOR4*  pV2,
+    const D3DXVECTOR4*  pV3,
+    float               s
+)
+{
+    assert(pOut != nullptr);
+    assert(pV0  != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v0  = d3dx9math_stub_detail::LoadFloat4(pV0);
+    auto v1  = d3dx9math_stub_detail::LoadFloat4(pV1);
+    auto v2  = d3dx9math_stub_detail::LoadFloat4(pV2);
+    auto v3  = d3dx9math_stub_detail::LoadFloat4(pV3);
+    auto vs  = DirectX::XMVectorSet(s, s, s, s);
+    auto ret = DirectX::XMVectorCatmullRomV(v0, v1, v2, v3, vs);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Barycentric coordinates.  V1 + f(V2-V1) + g(V3-V1)
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec4BaryCentric
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR4*  pV1,
+    const D3DXVECTOR4*  pV2,
+    const D3DXVECTOR4*  pV3,
+    float               f,
+    float               g
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v1  = d3dx9math_stub_detail::LoadFloat4(pV1);
+    auto v2  = d3dx9math_stub_detail::LoadFloat4(pV2);
+    auto v3  = d3dx9math_stub_detail::LoadFloat4(pV3);
+    auto vf  = DirectX::XMVectorSet(f, f, f, f);
+    auto vg  = DirectX::XMVectorSet(g, g, g, g);
+    auto ret = DirectX::XMVectorBaryCentricV(v1, v2, v3, vf, vg);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Transform vector by matrix.
+D3DX_STUB_INLINE D3DXVECTOR4* STUB_API D3DXVec4Transform
+(
+    D3DXVECTOR4*        pOut,
+    const D3DXVECTOR4*  pV,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+    assert(pM   != nullptr);
+
+    auto vec = d3dx9math_stub_detail::LoadFloat4(pV);
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMVector4Transform(vec, mat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXMATRIX
+///////////////////////////////////////////////////////////////////////////////
+D3DX_STUB_INLINE float STUB_API D3DXMatrixDeterminant(const D3DXMATRIX *pM)
+{
+    assert(pM != nullptr);
+
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMMatrixDeterminant(mat);
+    return DirectX::XMVectorGetX(ret);
+}
+
+D3DX_STUB_INLINE HRESULT STUB_API D3DXMatrixDecompose
+(
+    D3DXVECTOR3*        pOutScale,
+    D3DXQUATERNION*     pOutRotation,
+    D3DXVECTOR3*        pOutTranslation,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOutScale       != nullptr);
+    assert(pOutRotation    != nullptr);
+    assert(pOutTranslation != nullptr);
+    assert(pM              != nullptr);
+
+    DirectX::XMVECTOR scale;
+    DirectX::XMVECTOR rotate;
+    DirectX::XMVECTOR translation;
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMMatrixDecompose(&scale, &rotate, &translation, mat);
+    if (!ret)
+    {
+        return d3dx9math_stub_detail::kD3DERR_INVALIDCALL;// D3DERR_INVALIDCALL
+    }
+
+    DirectX::XMStoreFloat3(pOutScale, scale);
+    d3dx9math_stub_detail::StoreFloat4(pOutRotation, rotate);
+    DirectX::XMStoreFloat3(pOutTranslation, translation);
+
+    return d3dx9math_stub_detail::kD3D_OK; // S_OK.
+}
+
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixTranspose(D3DXMATRIX *pOut, const D3DXMATRIX *pM)
+{
+    assert(pOut != nullptr);
+    assert(pM   != nullptr);
+
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMMatrixTranspose(mat);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Matrix multiplication.  The result represents the transformation M2
+// followed by the transformation M1.  (Out = M1 * M2)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixMultiply
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2
+)
+{
+    assert(pOut != nullptr);
+    assert(pM1  != nullptr);
+    assert(pM2  != nullptr);
+
+    auto m1  = d3dx9math_stub_detail::LoadMatrix(pM1);
+    auto m2  = d3dx9math_stub_detail::LoadMatrix(pM2);
+    auto ret = DirectX::XMMatrixMultiply(m1, m2);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Matrix multiplication, followed by a transpose. (Out = T(M1 * M2))
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixMultiplyTranspose
+(
+    D3DXMATRIX*         pOut,
+    const D3DXMATRIX*   pM1,
+    const D3DXMATRIX*   pM2
+)
+{
+    assert(pOut != nullptr);
+    assert(pM1  != nullptr);
+    assert(pM2  != nullptr);
+
+    auto m1  = d3dx9math_stub_detail::LoadMatrix(pM1);
+    auto m2  = d3dx9math_stub_detail::LoadMatrix(pM2);
+    auto ret = DirectX::XMMatrixMultiplyTranspose(m1, m2);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Calculate inverse of matrix.  Inversion my fail, in which case NULL will
+// be returned.  The determinant of pM is also returned it pfDeterminant
+// is non-NULL.
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixInverse
+(
+    D3DXMATRIX*         pOut,
+    float*              pDeterminant,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pM != nullptr);
+
+    DirectX::XMVECTOR det;
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMMatrixInverse(&det, mat);
+    if (pDeterminant != nullptr)
+    {
+        DirectX::XMStoreFloat(pDeterminant, det);
+    }
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which scales by (sx, sy, sz)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixScaling(D3DXMATRIX *pOut, float sx, float sy, float sz)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixScaling(sx, sy, sz);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which translates by (x, y, z)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixTranslation(D3DXMATRIX *pOut, float x, float y, float z)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixTranslation(x, y, z);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which rotates around the X axis
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixRotationX(D3DXMATRIX *pOut, float Angle)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixRotationX(Angle);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which rotates around the Y axis
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixRotationY(D3DXMATRIX *pOut, float Angle)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixRotationY(Angle);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which rotates around the Z axis
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixRotationZ(D3DXMATRIX *pOut, float Angle)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixRotationZ(Angle);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which rotates around an arbitrary axis
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixRotationAxis(D3DXMATRIX *pOut, const D3DXVECTOR3 *pV, float Angle)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+
+    auto axis = DirectX::XMLoadFloat3(pV);
+    auto ret  = DirectX::XMMatrixRotationAxis(axis, Angle);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix from a quaternion
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixRotationQuaternion(D3DXMATRIX *pOut, const D3DXQUATERNION *pQ)
+{
+    assert(pOut != nullptr);
+    assert(pQ   != nullptr);
+
+    auto quat = d3dx9math_stub_detail::LoadFloat4(pQ);
+    auto ret  = DirectX::XMMatrixRotationQuaternion(quat);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Yaw around the Y axis, a pitch around the X axis,
+// and a roll around the Z axis.
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixRotationYawPitchRoll(D3DXMATRIX *pOut, float Yaw, float Pitch, float Roll)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixRotationRollPitchYaw(Pitch, Yaw, Roll);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build transformation matrix.  NULL arguments are treated as identity.
+// Mout = Msc-1 * Msr-1 * Ms * Msr * Msc * Mrc-1 * Mr * Mrc * Mt
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixTransformation
+(
+    D3DXMATRIX*             pOut,
+    const D3DXVECTOR3*      pScalingCenter,
+    const D3DXQUATERNION*   pScalingRotation,
+    const D3DXVECTOR3*      pScaling,
+    const D3DXVECTOR3*      pRotationCenter,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation
+)
+{
+    assert(pOut             != nullptr);
+    assert(pScalingCenter   != nullptr);
+    assert(pScalingRotation != nullptr);
+    assert(pScaling         != nullptr);
+    assert(pRotationCenter  != nullptr);
+    assert(pRotation        != nullptr);
+    assert(pTranslation     != nullptr);
+
+    auto scalingCenter      = DirectX::XMLoadFloat3(pScalingCenter);
+    auto scalingRotation    = d3dx9math_stub_detail::LoadFloat4(pScalingRotation);
+    auto scaling            = DirectX::XMLoadFloat3(pScaling);
+    auto rotationCenter     = DirectX::XMLoadFloat3(pRotationCenter);
+    auto rotation           = d3dx9math_stub_detail::LoadFloat4(pRotation);
+    auto translation        = DirectX::XMLoadFloat3(pTranslation);
+
+    auto ret = DirectX::XMMatrixTransformation(scalingCenter, scalingRotation, scaling, rotationCenter, rotation, translation);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build 2D transformation matrix in XY plane.  NULL arguments are treated as identity.
+// Mout = Msc-1 * Msr-1 * Ms * Msr * Msc * Mrc-1 * Mr * Mrc * Mt
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixTransformation2D
+(
+    D3DXMATRIX*         pOut,
+    const D3DXVECTOR2*  pScalingCenter, 
+    float               ScalingRotation,
+    const D3DXVECTOR2*  pScaling, 
+    const D3DXVECTOR2*  pRotationCenter,
+    float               Rotation, 
+    const D3DXVECTOR2*  pTranslation
+)
+{
+    assert(pOut            != nullptr);
+    assert(pScalingCenter  != nullptr);
+    assert(pScaling        != nullptr);
+    assert(pRotationCenter != nullptr);
+    assert(pTranslation    != nullptr);
+
+    auto scalingCenter  = DirectX::XMLoadFloat2(pScalingCenter);
+    auto scaling        = DirectX::XMLoadFloat2(pScaling);
+    auto rotationCenter = DirectX::XMLoadFloat2(pRotationCenter);
+    auto translation    = DirectX::XMLoadFloat2(pTranslation);
+
+    auto ret = DirectX::XMMatrixTransformation2D(scalingCenter, ScalingRotation, scaling, rotationCenter, Rotation, translation);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build affine transformation matrix.  NULL arguments are treated as identity.
+// Mout = Ms * Mrc-1 * Mr * Mrc * Mt
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixAffineTransformation
+(
+    D3DXMATRIX*             pOut,
+    float                   Scaling,
+    const D3DXVECTOR3*      pRotationCenter,
+    const D3DXQUATERNION*   pRotation,
+    const D3DXVECTOR3*      pTranslation
+)
+{
+    assert(pOut            != nullptr);
+    assert(pRotationCenter != nullptr);
+    assert(pRotation       != nullptr);
+    assert(pTranslation    != nullptr);
+
+    auto scaling        = DirectX::XMVectorSet(Scaling, Scaling, Scaling, 1.0f);
+    auto rotationCenter = DirectX::XMLoadFloat3(pRotationCenter);
+    auto rotation       = d3dx9math_stub_detail::LoadFloat4(pRotation);
+    auto translation    = DirectX::XMLoadFloat3(pTranslation);
+
+    auto ret = DirectX::XMMatrixAffineTransformation(scaling, rotationCenter, rotation, translation);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build 2D affine transformation matrix in XY plane.  NULL arguments are treated as identity.
+// Mout = Ms * Mrc-1 * Mr * Mrc * Mt
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixAffineTransformation2D
+(
+    D3DXMATRIX*         pOut,
+    float               Scaling,
+    const D3DXVECTOR2*  pRotationCenter, 
+    float               Rotation,
+    const D3DXVECTOR2*  pTranslation
+)
+{
+    assert(pOut            != nullptr);
+    assert(pRotationCenter != nullptr);
+    assert(pTranslation    != nullptr);
+
+    auto scaling        = DirectX::XMVectorSet(Scaling, Scaling, 1.0f, 1.0f);
+    auto rotationCenter = DirectX::XMLoadFloat2(pRotationCenter);
+    auto translation    = DirectX::XMLoadFloat2(pTranslation);
+
+    auto ret = DirectX::XMMatrixAffineTransformation2D(scaling, rotationCenter, Rotation, translation);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a lookat matrix. (right-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixLookAtRH
+(
+    D3DXMATRIX*         pOut,
+    const D3DXVECTOR3*  pEye,
+    const D3DXVECTOR3*  pAt,
+    const D3DXVECTOR3*  pUp
+)
+{
+    assert(pOut != nullptr);
+    assert(pEye != nullptr);
+    assert(pAt  != nullptr);
+    assert(pUp  != nullptr);
+
+    auto eye = DirectX::XMLoadFloat3(pEye);
+    auto at  = DirectX::XMLoadFloat3(pAt);
+    auto up  = DirectX::XMLoadFloat3(pUp);
+    auto ret = DirectX::XMMatrixLookAtRH(eye, at, up);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a lookat matrix. (left-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixLookAtLH
+(
+    D3DXMATRIX*         pOut,
+    const D3DXVECTOR3*  pEye,
+    const D3DXVECTOR3*  pAt,
+    const D3DXVECTOR3*  pUp
+)
+{
+    assert(pOut != nullptr);
+    assert(pEye != nullptr);
+    assert(pAt  != nullptr);
+    assert(pUp  != nullptr);
+
+    auto eye = DirectX::XMLoadFloat3(pEye);
+    auto at  = DirectX::XMLoadFloat3(pAt);
+    auto up  = DirectX::XMLoadFloat3(pUp);
+    auto ret = DirectX::XMMatrixLookAtLH(eye, at, up);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a perspective projection matrix. (right-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixPerspectiveRH
+(
+    D3DXMATRIX* pOut,
+    float       w,
+    float       h,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixPerspectiveRH(w, h, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a perspective projection matrix. (left-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixPerspectiveLH
+(
+    D3DXMATRIX* pOut,
+    float       w,
+    float       h,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixPerspectiveLH(w, h, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a perspective projection matrix. (right-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixPerspectiveFovRH
+(
+    D3DXMATRIX* pOut,
+    float       fovy,
+    float       Aspect,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixPerspectiveFovRH(fovy, Aspect, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a perspective projection matrix. (left-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixPerspectiveFovLH
+(
+    D3DXMATRIX* pOut,
+    float       fovy,
+    float       Aspect,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixPerspectiveFovLH(fovy, Aspect, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a perspective projection matrix. (right-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixPerspectiveOffCenterRH
+(
+    D3DXMATRIX* pOut,
+    float       l,
+    float       r,
+    float       b,
+    float       t,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixPerspectiveOffCenterRH(l, r, b, t, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a perspective projection matrix. (left-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixPerspectiveOffCenterLH
+(
+    D3DXMATRIX* pOut,
+    float       l,
+    float       r,
+    float       b,
+    float       t,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixPerspectiveOffCenterLH(l, r, b, t, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build an ortho projection matrix. (right-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixOrthoRH
+(
+    D3DXMATRIX* pOut,
+    float       w,
+    float       h,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixOrthographicRH(w, h, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build an ortho projection matrix. (left-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixOrthoLH
+(
+    D3DXMATRIX* pOut,
+    float       w,
+    float       h,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixOrthographicLH(w, h, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build an ortho projection matrix. (right-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixOrthoOffCenterRH
+(
+    D3DXMATRIX* pOut,
+    float       l,
+    float       r,
+    float       b,
+    float       t,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixOrthographicOffCenterRH(l, r, b, t, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build an ortho projection matrix. (left-handed)
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixOrthoOffCenterLH
+(
+    D3DXMATRIX* pOut,
+    float       l,
+    float       r,
+    float       b,
+    float       t,
+    float       zn,
+    float       zf
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMMatrixOrthographicOffCenterLH(l, r, b, t, zn, zf);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which flattens geometry into a plane, as if casting
+// a shadow from a light.
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixShadow
+(
+    D3DXMATRIX*         pOut,
+    const D3DXVECTOR4*  pLight,
+    const D3DXPLANE*    pPlane
+)
+{
+    assert(pOut  != nullptr);
+    assert(pLight != nullptr);
+    assert(pPlane != nullptr);
+
+    auto plane = DirectX::XMVectorSet(pPlane->a, pPlane->b, pPlane->c, pPlane->d);
+    auto light = d3dx9math_stub_detail::LoadFloat4(pLight);
+
+    auto ret = DirectX::XMMatrixShadow(plane, light);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+// Build a matrix which reflects the coordinate system about a plane
+D3DX_STUB_INLINE D3DXMATRIX* STUB_API D3DXMatrixReflect(D3DXMATRIX *pOut, const D3DXPLANE *pPlane)
+{
+    assert(pOut   != nullptr);
+    assert(pPlane != nullptr);
+
+    auto plane = DirectX::XMVectorSet(pPlane->a, pPlane->b, pPlane->c, pPlane->d);
+
+    auto ret = DirectX::XMMatrixReflect(plane);
+    d3dx9math_stub_detail::StoreMatrix(pOut, ret);
+    return pOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXQUATERNION
+///////////////////////////////////////////////////////////////////////////////
+// Compute a quaternin's axis and angle of rotation. Expects unit quaternions.
+D3DX_STUB_INLINE void STUB_API D3DXQuaternionToAxisAngle
+(
+    const D3DXQUATERNION*   pQ,
+    D3DXVECTOR3*            pAxis,
+    float*                  pAngle
+)
+{
+    assert(pQ     != nullptr);
+    assert(pAxis  != nullptr);
+    assert(pAngle != nullptr);
+
+    auto quat = d3dx9math_stub_detail::LoadFloat4(pQ);
+
+    DirectX::XMVECTOR axis;
+    DirectX::XMQuaternionToAxisAngle(&axis, pAngle, quat);
+
+    DirectX::XMStoreFloat3(pAxis, axis);
+}
+
+// Build a quaternion from a rotation matrix.
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionRotationMatrix(D3DXQUATERNION *pOut, const D3DXMATRIX *pM)
+{
+    assert(pOut != nullptr);
+    assert(pM   != nullptr);
+
+    auto mat = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMQuaternionRotationMatrix(mat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Rotation about arbitrary axis.
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionRotationAxis
+(
+    D3DXQUATERNION*     pOut,
+    const D3DXVECTOR3*  pV,
+    float               Angle
+)
+{
+    assert(pOut != nullptr);
+    assert(pV   != nullptr);
+
+    auto v   = DirectX::XMLoadFloat3(pV);
+    auto ret = DirectX::XMQuaternionRotationAxis(v, Angle);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Yaw around the Y axis, a pitch around the X axis,
+// and a roll around the Z axis.
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionRotationYawPitchRoll
+(
+    D3DXQUATERNION* pOut,
+    float           Yaw,
+    float           Pitch,
+    float           Roll
+)
+{
+    assert(pOut != nullptr);
+
+    auto ret = DirectX::XMQuaternionRotationRollPitchYaw(Pitch, Yaw, Roll);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Quaternion multiplication.  The result represents the rotation Q2
+// followed by the rotation Q1.  (Out = Q2 * Q1)
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionMultiply
+(
+    D3DXQUATERNION*         pOut,
+    const D3DXQUATERNION*   pQ1,
+    const D3DXQUATERNION*   pQ2
+)
+{
+    assert(pOut != nullptr);
+    assert(pQ1  != nullptr);
+    assert(pQ2  != nullptr);
+
+    auto q1 = d3dx9math_stub_detail::LoadFloat4(pQ1);
+    auto q2 = d3dx9math_stub_detail::LoadFloat4(pQ2);
+    auto ret = DirectX::XMQuaternionMultiply(q1, q2);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionNormalize(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+{
+    assert(pOut != nullptr);
+    assert(pQ   != nullptr);
+
+    auto quat = d3dx9math_stub_detail::LoadFloat4(pQ);
+    auto ret  = DirectX::XMQuaternionNormalize(quat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Conjugate and re-norm
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionInverse(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+{
+    assert(pOut != nullptr);
+    assert(pQ   != nullptr);
+
+    auto quat = d3dx9math_stub_detail::LoadFloat4(pQ);
+    auto ret  = DirectX::XMQuaternionInverse(quat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Expects unit quaternions.
+// if q = (cos(theta), sin(theta) * v); ln(q) = (0, theta * v)
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionLn(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+{
+    assert(pOut != nullptr);
+    assert(pQ   != nullptr);
+
+    auto quat = d3dx9math_stub_detail::LoadFloat4(pQ);
+    auto ret  = DirectX::XMQuaternionLn(quat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Expects pure quaternions. (w == 0)  w is ignored in calculation.
+// if q = (0, theta * v); exp(q) = (cos(theta), sin(theta) * v)
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionExp(D3DXQUATERNION *pOut, const D3DXQUATERNION *pQ)
+{
+    assert(pOut != nullptr);
+    assert(pQ   != nullptr);
+
+    auto quat = d3dx9math_stub_detail::LoadFloat4(pQ);
+    auto ret  = DirectX::XMQuaternionExp(quat);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Spherical linear interpolation between Q1 (t == 0) and Q2 (t == 1).
+// Expects unit quaternions.
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionSlerp
+(
+    D3DXQUATERNION*         pOut,
+    const D3DXQUATERNION*   pQ1,
+    const D3DXQUATERNION*   pQ2,
+    float                   t
+)
+{
+    assert(pOut != nullptr);
+    assert(pQ1  != nullptr);
+    assert(pQ2  != nullptr);
+
+    auto q1  = d3dx9math_stub_detail::LoadFloat4(pQ1);
+    auto q2  = d3dx9math_stub_detail::LoadFloat4(pQ2);
+    auto ret = DirectX::XMQuaternionSlerp(q1, q2, t);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Spherical quadrangle interpolation.
+// Slerp(Slerp(Q1, C, t), Slerp(A, B, t), 2t(1-t))
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionSquad
+(
+    D3DXQUATERNION*         pOut,
+    const D3DXQUATERNION*   pQ1,
+    const D3DXQUATERNION*   pA,
+    const D3DXQUATERNION*   pB,
+    const D3DXQUATERNION*   pC,
+    float                   t
+)
+{
+    assert(pOut != nullptr);
+    assert(pQ1  != nullptr);
+    assert(pA   != nullptr);
+    assert(pB   != nullptr);
+    assert(pC   != nullptr);
+
+    auto q1  = d3dx9math_stub_detail::LoadFloat4(pQ1);
+    auto a   = d3dx9math_stub_detail::LoadFloat4(pA);
+    auto b   = d3dx9math_stub_detail::LoadFloat4(pB);
+    auto c   = d3dx9math_stub_detail::LoadFloat4(pC);
+    auto ret = DirectX::XMQuaternionSquad(q1, a, b, c, t);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+// Setup control points for spherical quadrangle interpolation
+// from Q1 to Q2.  The control points are chosen in such a way 
+// to ensure the continuity of tangents with adjacent segments.
+D3DX_STUB_INLINE void STUB_API D3DXQuaternionSquadSetup
+(
+    D3DXQUATERNION*         pAOut,
+    D3DXQUATERNION*         pBOut,
+    D3DXQUATERNION*         pCOut,
+    const D3DXQUATERNION*   pQ0,
+    const D3DXQUATERNION*   pQ1, 
+    const D3DXQUATERNION*   pQ2,
+    const D3DXQUATERNION*   pQ3
+)
+{
+    assert(pAOut != nullptr);
+    assert(pBOut != nullptr);
+    assert(pCOut != nullptr);
+    assert(pQ0   != nullptr);
+    assert(pQ1   != nullptr);
+    assert(pQ2   != nullptr);
+    assert(pQ3   != nullptr);
+
+    auto q0 = d3dx9math_stub_detail::LoadFloat4(pQ0);
+    auto q1 = d3dx9math_stub_detail::LoadFloat4(pQ1);
+    auto q2 = d3dx9math_stub_detail::LoadFloat4(pQ2);
+    auto q3 = d3dx9math_stub_detail::LoadFloat4(pQ3);
+
+    DirectX::XMVECTOR a, b, c;
+    DirectX::XMQuaternionSquadSetup(&a, &b, &c, q0, q1, q2, q3);
+    d3dx9math_stub_detail::StoreFloat4(pAOut, a);
+    d3dx9math_stub_detail::StoreFloat4(pBOut, b);
+    d3dx9math_stub_detail::StoreFloat4(pCOut, c);
+}
+
+// Barycentric interpolation.
+// Slerp(Slerp(Q1, Q2, f+g), Slerp(Q1, Q3, f+g), g/(f+g))
+D3DX_STUB_INLINE D3DXQUATERNION* STUB_API D3DXQuaternionBaryCentric
+(
+    D3DXQUATERNION*         pOut,
+    const D3DXQUATERNION*   pQ1,
+    const D3DXQUATERNION*   pQ2,
+    const D3DXQUATERNION*   pQ3,
+    float                   f,
+    float                   g
+)
+{
+    assert(pOut != nullptr);
+    assert(pQ1  != nullptr);
+    assert(pQ2  != nullptr);
+    assert(pQ3  != nullptr);
+
+    auto q1  = d3dx9math_stub_detail::LoadFloat4(pQ1);
+    auto q2  = d3dx9math_stub_detail::LoadFloat4(pQ2);
+    auto q3  = d3dx9math_stub_detail::LoadFloat4(pQ3);
+    auto ret = DirectX::XMQuaternionBaryCentric(q1, q2, q3, f, g);
+    d3dx9math_stub_detail::StoreFloat4(pOut, ret);
+    return pOut;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// D3DXPLANE
+///////////////////////////////////////////////////////////////////////////////
+// Normalize plane (so that |a,b,c| == 1)
+D3DX_STUB_INLINE D3DXPLANE* STUB_API D3DXPlaneNormalize(D3DXPLANE *pOut, const D3DXPLANE *pP)
+{
+    assert(pOut != nullptr);
+    assert(pP   != nullptr);
+
+    auto p   = d3dx9math_stub_detail::LoadFloat4((DirectX::XMFLOAT4*)pP);
+    auto ret = DirectX::XMPlaneNormalize(p);
+    d3dx9math_stub_detail::StoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
+    return pOut;
+}
+
+// Find the intersection between a plane and a line.  If the line is
+// parallel to the plane, NULL is returned.
+D3DX_STUB_INLINE D3DXVECTOR3* STUB_API D3DXPlaneIntersectLine
+(
+    D3DXVECTOR3*        pOut,
+    const D3DXPLANE*    pP,
+    const D3DXVECTOR3*  pV1,
+    const D3DXVECTOR3*  pV2
+)
+{
+    assert(pOut != nullptr);
+    assert(pP   != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+
+    auto p   = d3dx9math_stub_detail::LoadFloat4((DirectX::XMFLOAT4*)pP);
+    auto v1  = DirectX::XMLoadFloat3(pV1);
+    auto v2  = DirectX::XMLoadFloat3(pV2);
+    auto ret = DirectX::XMPlaneIntersectLine(p, v1, v2);
+    DirectX::XMStoreFloat3(pOut, ret);
+    return pOut;
+}
+
+// Construct a plane from a point and a normal
+D3DX_STUB_INLINE D3DXPLANE* STUB_API D3DXPlaneFromPointNormal
+(
+    D3DXPLANE*          pOut,
+    const D3DXVECTOR3*  pPoint,
+    const D3DXVECTOR3*  pNormal
+)
+{
+    assert(pOut    != nullptr);
+    assert(pPoint  != nullptr);
+    assert(pNormal != nullptr);
+
+    auto p   = DirectX::XMLoadFloat3(pPoint);
+    auto n   = DirectX::XMLoadFloat3(pNormal);
+    auto ret = DirectX::XMPlaneFromPointNormal(p, n);
+    d3dx9math_stub_detail::StoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
+    return pOut;
+}
+
+// Construct a plane from 3 points
+D3DX_STUB_INLINE D3DXPLANE* STUB_API D3DXPlaneFromPoints
+(
+    D3DXPLANE*          pOut,
+    const D3DXVECTOR3*  pV1,
+    const D3DXVECTOR3*  pV2,
+    const D3DXVECTOR3*  pV3
+)
+{
+    assert(pOut != nullptr);
+    assert(pV1  != nullptr);
+    assert(pV2  != nullptr);
+    assert(pV3  != nullptr);
+
+    auto v1  = DirectX::XMLoadFloat3(pV1);
+    auto v2  = DirectX::XMLoadFloat3(pV2);
+    auto v3  = DirectX::XMLoadFloat3(pV3);
+    auto ret = DirectX::XMPlaneFromPoints(v1, v2, v3);
+    d3dx9math_stub_detail::StoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
+    return pOut;
+}
+
+// Transform a plane by a matrix.  The vector (a,b,c) must be normal.
+// M should be the inverse transpose of the transformation desired.
+D3DX_STUB_INLINE D3DXPLANE* STUB_API D3DXPlaneTransform
+(
+    D3DXPLANE*          pOut,
+    const D3DXPLANE*    pP,
+    const D3DXMATRIX*   pM
+)
+{
+    assert(pOut != nullptr);
+    assert(pP   != nullptr);
+    assert(pM   != nullptr);
+
+    auto p   = d3dx9math_stub_detail::LoadFloat4((DirectX::XMFLOAT4*)pP);
+    auto m   = d3dx9math_stub_detail::LoadMatrix(pM);
+    auto ret = DirectX::XMPlaneTransform(p, m);
+    d3dx9math_stub_detail::StoreFloat4((DirectX::XMFLOAT4*)pOut, ret);
+    return pOut;
+}
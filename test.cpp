@@ -1,6 +1,8 @@
 ﻿
 
+#if defined(_WIN32)
 #include <d3d9.h>
+#endif
 #include "d3dx9math_stub.h"
 
 int main(int argc, char** argv)
@@ -0,0 +1,5238 @@
+﻿//-----------------------------------------------------------------------------
+// File : verify.cpp
+// Desc : Correctness test against double precision reference.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "d3dx9math_stub.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values
+//-----------------------------------------------------------------------------
+const size_t kCount         = 512;                              // 1要素版の入力数.
+const size_t kArrayCount    = 4 * 1024;                         // 配列版の入力数.
+const size_t kParallelCount = D3DX_PARALLEL_THRESHOLD * 3 + 7;  // 並列版の入力数.
+const double kPi            = 3.14159265358979323846;
+
+///////////////////////////////////////////////////////////////////////////////
+// TestContext class
+///////////////////////////////////////////////////////////////////////////////
+class TestContext
+{
+public:
+    explicit TestContext(double maxUlp)
+    : m_MaxUlp(maxUlp)
+    { m_Message[0] = '\0'; }
+
+    // 参照値との誤差を max(|expected|, magnitude) のULP単位で評価する.
+    void Check(float value, double expected, double magnitude)
+    {
+        double ulp = HUGE_VAL;
+        if (std::isfinite(value))
+        {
+            auto scale = std::max(std::fabs(expected), magnitude);
+            ulp = std::fabs(double(value) - expected) / UlpOf(scale);
+        }
+
+        ++m_Checks;
+        m_WorstUlp = std::max(m_WorstUlp, ulp);
+
+        if (ulp > m_MaxUlp)
+        {
+            if (m_Failures == 0)
+            { snprintf(m_Message, sizeof(m_Message), "value %.9g, expected %.9g (%.1f ulp)", value, expected, ulp); }
+            ++m_Failures;
+        }
+    }
+
+    // 数値で比較できない結果を検証する.
+    void Expect(bool condition, const char* message)
+    {
+        ++m_Checks;
+        if (!condition)
+        {
+            if (m_Failures == 0)
+            { snprintf(m_Message, sizeof(m_Message), "%s", message); }
+            ++m_Failures;
+        }
+    }
+
+    // count要素を処理する関数の1要素あたりの処理時間を計測する.
+    template<typename Func>
+    void Measure(size_t count, Func func)
+    {
+        using Clock = std::chrono::steady_clock;
+        const double kMinTime = 0.01;
+
+        uint64_t iterations = 0;
+        double   elapsed    = 0.0;
+        const auto start = Clock::now();
+        do
+        {
+            func();
+            ++iterations;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        while (elapsed < kMinTime);
+
+        m_NsPerOp = elapsed * 1e9 / double(iterations * count);
+    }
+
+    double MaxUlp() const
+    { return m_MaxUlp; }
+
+    double WorstUlp() const
+    { return m_WorstUlp; }
+
+    double NsPerOp() const
+    { return m_NsPerOp; }
+
+    uint64_t Checks() const
+    { return m_Checks; }
+
+    uint64_t Failures() const
+    { return m_Failures; }
+
+    const char* Message() const
+    { return m_Message; }
+
+private:
+    double      m_MaxUlp    = 0.0;
+    double      m_WorstUlp  = 0.0;
+    double      m_NsPerOp   = 0.0;
+    uint64_t    m_Checks    = 0;
+    uint64_t    m_Failures  = 0;
+    char        m_Message[256];
+
+    // 大きさscaleの単精度浮動小数の1ULP.
+    static double UlpOf(double scale)
+    {
+        int exponent = 0;
+        std::frexp(std::max(scale, double(FLT_MIN)), &exponent);
+        return std::ldexp(1.0, exponent - 24);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// TestCase structure
+///////////////////////////////////////////////////////////////////////////////
+struct TestCase
+{
+    using Func = void (*)(TestContext&);
+
+    const char* Name;
+    double      MaxUlp;
+    Func        Function;
+};
+
+std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> s_TestCases;
+    return s_TestCases;
+}
+
+bool RegisterTestCase(const char* name, double maxUlp, TestCase::Func func)
+{
+    GetTestCases().push_back({ name, maxUlp, func });
+    return true;
+}
+
+#define TEST_CONCAT2(a, b)  a##b
+#define TEST_CONCAT(a, b)   TEST_CONCAT2(a, b)
+#define TEST_CASE(func, maxUlp) \
+    static bool TEST_CONCAT(s_Test_, __LINE__) = RegisterTestCase(#func, maxUlp, func)
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Reference
+///////////////////////////////////////////////////////////////////////////////
+using RefVector = std::array<double, 4>;
+
+struct RefMatrix
+{
+    double m[4][4];
+};
+
+RefVector RefVec(const float* p, int count, double w = 0.0)
+{
+    RefVector ret = { 0.0, 0.0, 0.0, w };
+    for (int i = 0; i < count; ++i)
+    { ret[i] = p[i]; }
+    return ret;
+}
+
+RefVector RefVec(const D3DXVECTOR2& v, double z = 0.0, double w = 0.0)
+{ return { v.x, v.y, z, w }; }
+
+RefVector RefVec(const D3DXVECTOR3& v, double w = 0.0)
+{ return { v.x, v.y, v.z, w }; }
+
+RefVector RefVec(const D3DXVECTOR4& v)
+{ return { v.x, v.y, v.z, v.w }; }
+
+RefVector RefVec(const D3DXQUATERNION& q)
+{ return { q.x, q.y, q.z, q.w }; }
+
+RefVector RefVec(const D3DXPLANE& p)
+{ return { p.a, p.b, p.c, p.d }; }
+
+RefVector RefVec(const D3DXCOLOR& c)
+{ return { c.r, c.g, c.b, c.a }; }
+
+RefVector operator + (const RefVector& a, const RefVector& b)
+{ return { a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3] }; }
+
+RefVector operator - (const RefVector& a, const RefVector& b)
+{ return { a[0] - b[0], a[1] - b[1], a[2] - b[2], a[3] - b[3] }; }
+
+RefVector operator * (const RefVector& a, double s)
+{ return { a[0] * s, a[1] * s, a[2] * s, a[3] * s }; }
+
+double RefDot3(const RefVector& a, const RefVector& b)
+{ return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+double RefDot4(const RefVector& a, const RefVector& b)
+{ return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]; }
+
+RefVector RefCross3(const RefVector& a, const RefVector& b)
+{
+    return {
+        a[1] * b[2] - a[2] * b[1],
+        a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0],
+        0.0 };
+}
+
+RefVector RefNormalize3(const RefVector& v)
+{
+    auto len = std::sqrt(RefDot3(v, v));
+    return { v[0] / len, v[1] / len, v[2] / len, 0.0 };
+}
+
+RefVector RefNormalize4(const RefVector& v)
+{ return v * (1.0 / std::sqrt(RefDot4(v, v))); }
+
+RefMatrix RefMat(const D3DXMATRIX& m)
+{
+    RefMatrix ret;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    { ret.m[i][j] = m.m[i][j]; }
+    return ret;
+}
+
+D3DXMATRIX ToFloat(const RefMatrix& m)
+{
+    D3DXMATRIX ret;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    { ret.m[i][j] = float(m.m[i][j]); }
+    return ret;
+}
+
+RefMatrix RefIdentity()
+{
+    RefMatrix ret = {};
+    ret.m[0][0] = ret.m[1][1] = ret.m[2][2] = ret.m[3][3] = 1.0;
+    return ret;
+}
+
+RefMatrix operator * (const RefMatrix& a, const RefMatrix& b)
+{
+    RefMatrix ret;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    {
+        ret.m[i][j] = a.m[i][0] * b.m[0][j]
+                    + a.m[i][1] * b.m[1][j]
+                    + a.m[i][2] * b.m[2][j]
+                    + a.m[i][3] * b.m[3][j];
+    }
+    return ret;
+}
+
+RefMatrix RefTranspose(const RefMatrix& a)
+{
+    RefMatrix ret;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    { ret.m[i][j] = a.m[j][i]; }
+    return ret;
+}
+
+// 部分ピボット付きガウス・ジョルダン法.
+RefMatrix RefInverse(const RefMatrix& a, double* pDeterminant)
+{
+    double work[4][8];
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    {
+        work[i][j]     = a.m[i][j];
+        work[i][j + 4] = (i == j) ? 1.0 : 0.0;
+    }
+
+    double det = 1.0;
+    for (int col = 0; col < 4; ++col)
+    {
+        auto pivot = col;
+        for (int row = col + 1; row < 4; ++row)
+        {
+            if (std::fabs(work[row][col]) > std::fabs(work[pivot][col]))
+            { pivot = row; }
+        }
+
+        if (pivot != col)
+        {
+            for (int j = 0; j < 8; ++j)
+            { std::swap(work[pivot][j], work[col][j]); }
+            det = -det;
+        }
+
+        auto p = work[col][col];
+        det *= p;
+        if (p == 0.0)
+            break;
+
+        for (int j = 0; j < 8; ++j)
+        { work[col][j] /= p; }
+
+        for (int row = 0; row < 4; ++row)
+        {
+            if (row == col)
+                continue;
+
+            auto f = work[row][col];
+            for (int j = 0; j < 8; ++j)
+            { work[row][j] -= f * work[col][j]; }
+        }
+    }
+
+    if (pDeterminant != nullptr)
+    { *pDeterminant = det; }
+
+    RefMatrix ret;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    { ret.m[i][j] = work[i][j + 4]; }
+    return ret;
+}
+
+// 行ベクトル v * M.
+RefVector RefTransform(const RefVector& v, const RefMatrix& m)
+{
+    RefVector ret;
+    for (int j = 0; j < 4; ++j)
+    { ret[j] = v[0] * m.m[0][j] + v[1] * m.m[1][j] + v[2] * m.m[2][j] + v[3] * m.m[3][j]; }
+    return ret;
+}
+
+RefMatrix RefScaling(double x, double y, double z)
+{
+    auto ret = RefIdentity();
+    ret.m[0][0] = x;
+    ret.m[1][1] = y;
+    ret.m[2][2] = z;
+    return ret;
+}
+
+RefMatrix RefTranslation(double x, double y, double z)
+{
+    auto ret = RefIdentity();
+    ret.m[3][0] = x;
+    ret.m[3][1] = y;
+    ret.m[3][2] = z;
+    return ret;
+}
+
+RefMatrix RefRotationX(double angle)
+{
+    auto ret = RefIdentity();
+    auto c = std::cos(angle);
+    auto s = std::sin(angle);
+    ret.m[1][1] =  c; ret.m[1][2] = s;
+    ret.m[2][1] = -s; ret.m[2][2] = c;
+    return ret;
+}
+
+RefMatrix RefRotationY(double angle)
+{
+    auto ret = RefIdentity();
+    auto c = std::cos(angle);
+    auto s = std::sin(angle);
+    ret.m[0][0] = c; ret.m[0][2] = -s;
+    ret.m[2][0] = s; ret.m[2][2] =  c;
+    return ret;
+}
+
+RefMatrix RefRotationZ(double angle)
+{
+    auto ret = RefIdentity();
+    auto c = std::cos(angle);
+    auto s = std::sin(angle);
+    ret.m[0][0] =  c; ret.m[0][1] = s;
+    ret.m[1][0] = -s; ret.m[1][1] = c;
+    return ret;
+}
+
+RefMatrix RefRotationQuaternion(const RefVector& q)
+{
+    const auto x = q[0], y = q[1], z = q[2], w = q[3];
+
+    auto ret = RefIdentity();
+    ret.m[0][0] = 1.0 - 2.0 * (y * y + z * z);
+    ret.m[0][1] = 2.0 * (x * y + z * w);
+    ret.m[0][2] = 2.0 * (x * z - y * w);
+    ret.m[1][0] = 2.0 * (x * y - z * w);
+    ret.m[1][1] = 1.0 - 2.0 * (x * x + z * z);
+    ret.m[1][2] = 2.0 * (y * z + x * w);
+    ret.m[2][0] = 2.0 * (x * z + y * w);
+    ret.m[2][1] = 2.0 * (y * z - x * w);
+    ret.m[2][2] = 1.0 - 2.0 * (x * x + y * y);
+    return ret;
+}
+
+RefVector RefQuaternionAxis(const RefVector& axis, double angle)
+{
+    auto n = RefNormalize3(axis);
+    auto s = std::sin(angle * 0.5);
+    return { n[0] * s, n[1] * s, n[2] * s, std::cos(angle * 0.5) };
+}
+
+// D3DXQuaternionMultiply と同じく Q1 の回転の後に Q2 の回転を行う (Q2 * Q1).
+RefVector RefQuaternionMultiply(const RefVector& q1, const RefVector& q2)
+{
+    const auto& a = q2;
+    const auto& b = q1;
+    return {
+        a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
+        a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0],
+        a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3],
+        a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2] };
+}
+
+RefVector RefQuaternionInverse(const RefVector& q)
+{
+    auto lenSq = RefDot4(q, q);
+    return { -q[0] / lenSq, -q[1] / lenSq, -q[2] / lenSq, q[3] / lenSq };
+}
+
+RefVector RefQuaternionLn(const RefVector& q)
+{
+    auto len = std::sqrt(RefDot3(q, q));
+    auto scale = (len > 0.0) ? std::atan2(len, q[3]) / len : 1.0;
+    return { q[0] * scale, q[1] * scale, q[2] * scale, 0.0 };
+}
+
+RefVector RefQuaternionExp(const RefVector& q)
+{
+    auto theta = std::sqrt(RefDot3(q, q));
+    auto scale = (theta > 0.0) ? std::sin(theta) / theta : 1.0;
+    return { q[0] * scale, q[1] * scale, q[2] * scale, std::cos(theta) };
+}
+
+// 最短経路の球面線形補間.
+RefVector RefQuaternionSlerp(const RefVector& q1, RefVector q2, double t)
+{
+    auto c = RefDot4(q1, q2);
+    if (c < 0.0)
+    {
+        q2 = q2 * -1.0;
+        c  = -c;
+    }
+
+    double s0 = 1.0 - t;
+    double s1 = t;
+    if (c < 1.0 - 1e-12)
+    {
+        auto omega = std::acos(c);
+        auto s     = std::sin(omega);
+        s0 = std::sin((1.0 - t) * omega) / s;
+        s1 = std::sin(t * omega) / s;
+    }
+
+    return q1 * s0 + q2 * s1;
+}
+
+// 直交行列の回転成分からクォータニオンを求める.
+RefVector RefQuaternionFromMatrix(const RefMatrix& mtx)
+{
+    const auto& m = mtx.m;
+    auto trace = m[0][0] + m[1][1] + m[2][2];
+
+    RefVector q;
+    if (trace > 0.0)
+    {
+        auto s = std::sqrt(trace + 1.0) * 2.0;
+        q = { (m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25 * s };
+    }
+    else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+    {
+        auto s = std::sqrt(1.0 + m[0][0] - m[1][1] - m[2][2]) * 2.0;
+        q = { 0.25 * s, (m[0][1] + m[1][0]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s };
+    }
+    else if (m[1][1] > m[2][2])
+    {
+        auto s = std::sqrt(1.0 + m[1][1] - m[0][0] - m[2][2]) * 2.0;
+        q = { (m[0][1] + m[1][0]) / s, 0.25 * s, (m[1][2] + m[2][1]) / s, (m[2][0] - m[0][2]) / s };
+    }
+    else
+    {
+        auto s = std::sqrt(1.0 + m[2][2] - m[0][0] - m[1][1]) * 2.0;
+        q = { (m[2][0] + m[0][2]) / s, (m[1][2] + m[2][1]) / s, 0.25 * s, (m[0][1] - m[1][0]) / s };
+    }
+    return q;
+}
+
+RefMatrix RefRotationYawPitchRoll(double yaw, double pitch, double roll)
+{ return RefRotationZ(roll) * RefRotationX(pitch) * RefRotationY(yaw); }
+
+///////////////////////////////////////////////////////////////////////////////
+// Spherical Harmonics Reference
+///////////////////////////////////////////////////////////////////////////////
+const int kSHMaxCoeffs = D3DXSH_MAXORDER * D3DXSH_MAXORDER;
+
+// 実球面調和関数 (Condon-Shortley位相込み). 添字は l * l + l + m.
+void RefSHEval(uint32_t order, const RefVector& dir, double* pOut)
+{
+    const auto x = dir[0], y = dir[1], z = dir[2];
+
+    // cs[m] + i sn[m] = (x + iy)^m = sin^m(theta) * e^(i m phi).
+    double cs[D3DXSH_MAXORDER];
+    double sn[D3DXSH_MAXORDER];
+    cs[0] = 1.0;
+    sn[0] = 0.0;
+    for (uint32_t m = 1; m < order; ++m)
+    {
+        cs[m] = cs[m - 1] * x - sn[m - 1] * y;
+        sn[m] = cs[m - 1] * y + sn[m - 1] * x;
+    }
+
+    for (uint32_t m = 0; m < order; ++m)
+    {
+        // sin^m を除いたルジャンドル陪関数 P_l^m.
+        double pmm = 1.0;
+        for (uint32_t k = 1; k <= m; ++k)
+        { pmm *= -double(2 * k - 1); }
+
+        double p0 = 0.0;
+        double p1 = pmm;
+        for (uint32_t l = m; l < order; ++l)
+        {
+            double p;
+            if (l == m)
+            { p = pmm; }
+            else if (l == m + 1)
+            { p = z * double(2 * m + 1) * pmm; }
+            else
+            { p = (double(2 * l - 1) * z * p1 - double(l + m - 1) * p0) / double(l - m); }
+
+            if (l > m)
+            {
+                p0 = p1;
+                p1 = p;
+            }
+
+            double ratio = 1.0;
+            for (uint32_t k = l - m + 1; k <= l + m; ++k)
+            { ratio /= double(k); }
+            auto K = std::sqrt(double(2 * l + 1) / (4.0 * kPi) * ratio);
+
+            if (m == 0)
+            { pOut[l * l + l] = K * p; }
+            else
+            {
+                pOut[l * l + l + m] = std::sqrt(2.0) * K * cs[m] * p;
+                pOut[l * l + l - m] = std::sqrt(2.0) * K * sn[m] * p;
+            }
+        }
+    }
+}
+
+// ルジャンドル多項式 P_l(t).
+double RefLegendre(int l, double t)
+{
+    if (l < 0)
+        return 1.0;
+
+    double p0 = 1.0;
+    double p1 = t;
+    if (l == 0)
+        return p0;
+
+    for (int k = 2; k <= l; ++k)
+    {
+        auto p = (double(2 * k - 1) * t * p1 - double(k - 1) * p0) / double(k);
+        p0 = p1;
+        p1 = p;
+    }
+    return p1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SHQuadrature structure
+///////////////////////////////////////////////////////////////////////////////
+// 最大次数の積でも厳密となる球面上の数値積分.
+struct SHQuadrature
+{
+    std::vector<RefVector>  Dirs;
+    std::vector<double>     Weights;
+    std::vector<double>     Basis;      // Dirs.size() * kSHMaxCoeffs.
+    std::vector<double>     Triple;     // kSHMaxCoeffs^3.
+};
+
+const SHQuadrature& GetSHQuadrature()
+{
+    static SHQuadrature s_Quadrature;
+    if (!s_Quadrature.Dirs.empty())
+        return s_Quadrature;
+
+    // cos(theta)方向はガウス・ルジャンドル, phi方向は等間隔.
+    const int kThetaCount = 24;
+    const int kPhiCount   = 48;
+
+    for (int i = 0; i < kThetaCount; ++i)
+    {
+        auto t = std::cos(kPi * (i + 0.75) / (kThetaCount + 0.5));
+        double dp = 0.0;
+        for (int iter = 0; iter < 100; ++iter)
+        {
+            auto p  = RefLegendre(kThetaCount, t);
+            auto pm = RefLegendre(kThetaCount - 1, t);
+            dp = kThetaCount * (t * p - pm) / (t * t - 1.0);
+            auto dt = p / dp;
+            t -= dt;
+            if (std::fabs(dt) < 1e-16)
+                break;
+        }
+        auto w = 2.0 / ((1.0 - t * t) * dp * dp);
+
+        for (int j = 0; j < kPhiCount; ++j)
+        {
+            auto phi = 2.0 * kPi * (j + 0.5) / kPhiCount;
+            auto st  = std::sqrt(1.0 - t * t);
+            s_Quadrature.Dirs.push_back({ st * std::cos(phi), st * std::sin(phi), t, 0.0 });
+            s_Quadrature.Weights.push_back(w * 2.0 * kPi / kPhiCount);
+        }
+    }
+
+    const auto count = s_Quadrature.Dirs.size();
+    s_Quadrature.Basis.resize(count * kSHMaxCoeffs);
+    for (size_t i = 0; i < count; ++i)
+    { RefSHEval(D3DXSH_MAXORDER, s_Quadrature.Dirs[i], &s_Quadrature.Basis[i * kSHMaxCoeffs]); }
+
+    s_Quadrature.Triple.assign(size_t(kSHMaxCoeffs) * kSHMaxCoeffs * kSHMaxCoeffs, 0.0);
+    for (size_t s = 0; s < count; ++s)
+    {
+        const auto Y = &s_Quadrature.Basis[s * kSHMaxCoeffs];
+        const auto w = s_Quadrature.Weights[s];
+        for (int i = 0; i < kSHMaxCoeffs; ++i)
+        for (int j = 0; j < kSHMaxCoeffs; ++j)
+        {
+            auto wij = w * Y[i] * Y[j];
+            auto dst = &s_Quadrature.Triple[(size_t(i) * kSHMaxCoeffs + j) * kSHMaxCoeffs];
+            for (int k = 0; k < kSHMaxCoeffs; ++k)
+            { dst[k] += wij * Y[k]; }
+        }
+    }
+
+    return s_Quadrature;
+}
+
+// f * g を order 次で打ち切った射影.
+void RefSHMultiply(uint32_t order, const float* pF, const float* pG, double* pOut)
+{
+    const auto& quad = GetSHQuadrature();
+    const auto  n    = int(order * order);
+
+    for (int k = 0; k < n; ++k)
+    { pOut[k] = 0.0; }
+
+    for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+    {
+        auto fg  = double(pF[i]) * double(pG[j]);
+        auto src = &quad.Triple[(size_t(i) * kSHMaxCoeffs + j) * kSHMaxCoeffs];
+        for (int k = 0; k < n; ++k)
+        { pOut[k] += fg * src[k]; }
+    }
+}
+
+// 回転後の関数 g(d) = f(M d) を射影する. 方向 d を回転 d * M^T で移すことに相当.
+void RefSHRotate(uint32_t order, const RefMatrix& m, const float* pIn, double* pOut)
+{
+    const auto& quad = GetSHQuadrature();
+    const auto  n    = int(order * order);
+
+    for (int k = 0; k < n; ++k)
+    { pOut[k] = 0.0; }
+
+    double Y[kSHMaxCoeffs];
+    for (size_t s = 0; s < quad.Dirs.size(); ++s)
+    {
+        const auto& d = quad.Dirs[s];
+        RefVector r = {
+            m.m[0][0] * d[0] + m.m[0][1] * d[1] + m.m[0][2] * d[2],
+            m.m[1][0] * d[0] + m.m[1][1] * d[1] + m.m[1][2] * d[2],
+            m.m[2][0] * d[0] + m.m[2][1] * d[1] + m.m[2][2] * d[2],
+            0.0 };
+        RefSHEval(order, r, Y);
+
+        double f = 0.0;
+        for (int j = 0; j < n; ++j)
+        { f += double(pIn[j]) * Y[j]; }
+
+        f *= quad.Weights[s];
+        const auto B = &quad.Basis[s * kSHMaxCoeffs];
+        for (int k = 0; k < n; ++k)
+        { pOut[k] += f * B[k]; }
+    }
+}
+
+// 軸 dir 周りに対称な放射輝度 g(d・dir) の射影 (Funk-Hecke).
+// zonal[l] は int_{-1}^{1} g(t) P_l(t) dt.
+void RefSHZonal(uint32_t order, const RefVector& dir, const double* zonal, double scale, double* pOut)
+{
+    double Y[kSHMaxCoeffs];
+    RefSHEval(order, dir, Y);
+
+    for (uint32_t l = 0; l < order; ++l)
+    for (uint32_t i = l * l; i < (l + 1) * (l + 1); ++i)
+    { pOut[i] = scale * 2.0 * kPi * zonal[l] * Y[i]; }
+}
+
+// 法線方向の放射輝度を1に正規化する係数 (完全拡散面, アルベド1).
+// 余弦ローブの畳み込み係数 A_l を order 次で打ち切る.
+double RefSHIrradianceNorm(uint32_t order)
+{
+    const double A[D3DXSH_MAXORDER] = {
+        kPi, 2.0 * kPi / 3.0, kPi / 4.0, 0.0, -kPi / 24.0, 0.0 };
+
+    double sum = 0.0;
+    for (uint32_t l = 0; l < order; ++l)
+    { sum += A[l] * double(2 * l + 1) / (4.0 * kPi); }
+    return kPi / sum;
+}
+
+// 半角 radius の円錐内で一定の放射輝度 1 を持つ光源.
+void RefSHConeZonal(uint32_t order, double radius, double* zonal)
+{
+    auto c = std::cos(radius);
+    for (uint32_t l = 0; l < order; ++l)
+    {
+        // int_c^1 P_l(t) dt.
+        zonal[l] = (l == 0)
+            ? 1.0 - c
+            : (RefLegendre(int(l) - 1, c) - RefLegendre(int(l) + 1, c)) / double(2 * l + 1);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Float16 Reference
+///////////////////////////////////////////////////////////////////////////////
+
+// 最近接偶数丸め.
+uint16_t RefFloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+
+    double a = std::fabs(double(value));
+    if (std::isnan(value))
+        return uint16_t(sign | 0x7E00);
+
+    if (a >= 65520.0)
+        return uint16_t(sign | 0x7C00);
+
+    if (a < std::ldexp(1.0, -14))
+    { return uint16_t(sign | uint16_t(std::nearbyint(std::ldexp(a, 24)))); }
+
+    int exponent = 0;
+    std::frexp(a, &exponent);
+    exponent -= 1;
+
+    auto mantissa = std::nearbyint((std::ldexp(a, -exponent) - 1.0) * 1024.0);
+    if (mantissa >= 1024.0)
+    {
+        mantissa = 0.0;
+        exponent++;
+    }
+
+    return uint16_t(sign | ((exponent + 15) << 10) | uint16_t(mantissa));
+}
+
+double RefHalfToFloat(uint16_t value)
+{
+    const auto sign     = (value & 0x8000) ? -1.0 : 1.0;
+    const auto exponent = (value >> 10) & 0x1F;
+    const auto mantissa = value & 0x3FF;
+
+    if (exponent == 0)
+        return sign * std::ldexp(double(mantissa), -24);
+
+    return sign * std::ldexp(1.0 + mantissa / 1024.0, exponent - 15);
+}
+
+uint16_t HalfBits(const D3DXFLOAT16& value)
+{
+    uint16_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Random class
+///////////////////////////////////////////////////////////////////////////////
+class Random
+{
+public:
+    explicit Random(uint32_t seed = 12345)
+    : m_Engine(seed)
+    { /* DO_NOTHING */ }
+
+    float Uniform(float minValue, float maxValue)
+    { return std::uniform_real_distribution<float>(minValue, maxValue)(m_Engine); }
+
+    D3DXVECTOR2 Vec2(float range = 10.0f)
+    { return D3DXVECTOR2(Uniform(-range, range), Uniform(-range, range)); }
+
+    D3DXVECTOR3 Vec3(float range = 10.0f)
+    { return D3DXVECTOR3(Uniform(-range, range), Uniform(-range, range), Uniform(-range, range)); }
+
+    D3DXVECTOR4 Vec4(float range = 10.0f)
+    { return D3DXVECTOR4(Uniform(-range, range), Uniform(-range, range), Uniform(-range, range), Uniform(-range, range)); }
+
+    // 単位ベクトル.
+    D3DXVECTOR3 Direction()
+    {
+        for (;;)
+        {
+            auto v = RefVec(Vec3(1.0f));
+            auto lenSq = RefDot3(v, v);
+            if (lenSq < 0.01 || lenSq > 1.0)
+                continue;
+
+            auto n = RefNormalize3(v);
+            return D3DXVECTOR3(float(n[0]), float(n[1]), float(n[2]));
+        }
+    }
+
+    // 単位クォータニオン.
+    D3DXQUATERNION Rotation()
+    {
+        for (;;)
+        {
+            auto q = RefVec(Vec4(1.0f));
+            auto lenSq = RefDot4(q, q);
+            if (lenSq < 0.01 || lenSq > 1.0)
+                continue;
+
+            auto n = RefNormalize4(q);
+            return D3DXQUATERNION(float(n[0]), float(n[1]), float(n[2]), float(n[3]));
+        }
+    }
+
+    // 回転, 拡大縮小, 平行移動からなる条件数の小さいアフィン行列.
+    D3DXMATRIX Affine()
+    {
+        auto q = Rotation();
+        auto s = RefScaling(Uniform(0.5f, 2.0f), Uniform(0.5f, 2.0f), Uniform(0.5f, 2.0f));
+        auto t = RefTranslation(Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f), Uniform(-10.0f, 10.0f));
+        return ToFloat(s * RefRotationQuaternion(RefVec(q)) * t);
+    }
+
+    // 対角優位な一般の行列.
+    D3DXMATRIX General()
+    {
+        D3DXMATRIX ret;
+        for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+        { ret.m[i][j] = Uniform(-1.0f, 1.0f) + ((i == j) ? 4.0f : 0.0f); }
+        return ret;
+    }
+
+    // 射影を含む変換.
+    D3DXMATRIX Projective()
+    {
+        auto m = Affine();
+        m._14 = Uniform(-0.05f, 0.05f);
+        m._24 = Uniform(-0.05f, 0.05f);
+        m._34 = Uniform(-0.05f, 0.05f);
+        m._44 = Uniform( 1.5f,  2.0f);
+        return m;
+    }
+
+private:
+    std::mt19937 m_Engine;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Check functions
+///////////////////////////////////////////////////////////////////////////////
+
+// 各成分を全成分の最大値を基準に比較する.
+void CheckValues(TestContext& ctx, const float* value, const double* expected, int count, double magnitude = 0.0)
+{
+    for (int i = 0; i < count; ++i)
+    { magnitude = std::max(magnitude, std::fabs(expected[i])); }
+
+    for (int i = 0; i < count; ++i)
+    { ctx.Check(value[i], expected[i], magnitude); }
+}
+
+void CheckVector(TestContext& ctx, const float* value, const RefVector& expected, int count, double magnitude = 0.0)
+{ CheckValues(ctx, value, expected.data(), count, magnitude); }
+
+void CheckMatrix(TestContext& ctx, const D3DXMATRIX& value, const RefMatrix& expected, double magnitude = 0.0)
+{ CheckValues(ctx, &value._11, &expected.m[0][0], 16, magnitude); }
+
+// q と -q は同じ回転を表す.
+void CheckRotation(TestContext& ctx, const D3DXQUATERNION& value, RefVector expected)
+{
+    if (RefDot4(RefVec(value), expected) < 0.0)
+    { expected = expected * -1.0; }
+    CheckVector(ctx, &value.x, expected, 4);
+}
+
+double MaxAbs(const RefMatrix& m)
+{
+    double ret = 0.0;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    { ret = std::max(ret, std::fabs(m.m[i][j])); }
+    return ret;
+}
+
+double MaxAbs(const RefVector& v)
+{ return std::max(std::max(std::fabs(v[0]), std::fabs(v[1])), std::max(std::fabs(v[2]), std::fabs(v[3]))); }
+
+// 行列とベクトルの積で生じる桁落ちの基準 |v| * |M|.
+double TransformMagnitude(const RefVector& v, const RefMatrix& m)
+{
+    double ret = 0.0;
+    for (int j = 0; j < 4; ++j)
+    {
+        double sum = 0.0;
+        for (int i = 0; i < 4; ++i)
+        { sum += std::fabs(v[i] * m.m[i][j]); }
+        ret = std::max(ret, sum);
+    }
+    return ret;
+}
+
+double ProductMagnitude(const RefMatrix& a, const RefMatrix& b)
+{
+    RefMatrix absA, absB;
+    for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+    {
+        absA.m[i][j] = std::fabs(a.m[i][j]);
+        absB.m[i][j] = std::fabs(b.m[i][j]);
+    }
+    return MaxAbs(absA * absB);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXVec2Basic(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto a = rng.Vec2();
+        auto b = rng.Vec2();
+        auto s = rng.Uniform(-2.0f, 2.0f);
+        auto ra = RefVec(a);
+        auto rb = RefVec(b);
+
+        ctx.Check(D3DXVec2Length(&a), std::sqrt(RefDot3(ra, ra)), 0.0);
+        ctx.Check(D3DXVec2LengthSq(&a), RefDot3(ra, ra), 0.0);
+        ctx.Check(D3DXVec2Dot(&a, &b), RefDot3(ra, rb), std::fabs(ra[0] * rb[0]) + std::fabs(ra[1] * rb[1]));
+        ctx.Check(D3DXVec2CCW(&a, &b), ra[0] * rb[1] - ra[1] * rb[0], std::fabs(ra[0] * rb[1]) + std::fabs(ra[1] * rb[0]));
+
+        D3DXVECTOR2 v;
+        CheckVector(ctx, &D3DXVec2Lerp(&v, &a, &b, s)->x, ra + (rb - ra) * s, 2, MaxAbs(ra) + MaxAbs(rb) * 2.0);
+        CheckVector(ctx, &D3DXVec2Scale(&v, &a, s)->x, ra * s, 2);
+    }
+}
+TEST_CASE(Test_D3DXVec2Basic, 4.0);
+
+void Test_D3DXVec3Basic(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto a = rng.Vec3();
+        auto b = rng.Vec3();
+        auto s = rng.Uniform(-2.0f, 2.0f);
+        auto ra = RefVec(a);
+        auto rb = RefVec(b);
+        auto magnitude = MaxAbs(ra) * MaxAbs(rb) * 3.0;
+
+        ctx.Check(D3DXVec3Length(&a), std::sqrt(RefDot3(ra, ra)), 0.0);
+        ctx.Check(D3DXVec3Dot(&a, &b), RefDot3(ra, rb), magnitude);
+
+        D3DXVECTOR3 v;
+        CheckVector(ctx, &D3DXVec3Cross(&v, &a, &b)->x, RefCross3(ra, rb), 3, magnitude);
+        CheckVector(ctx, &D3DXVec3Lerp(&v, &a, &b, s)->x, ra + (rb - ra) * s, 3, MaxAbs(ra) + MaxAbs(rb) * 2.0);
+    }
+}
+TEST_CASE(Test_D3DXVec3Basic, 4.0);
+
+void Test_D3DXVec4Basic(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto a = rng.Vec4();
+        auto b = rng.Vec4();
+        auto ra = RefVec(a);
+        auto rb = RefVec(b);
+
+        ctx.Check(D3DXVec4Length(&a), std::sqrt(RefDot4(ra, ra)), 0.0);
+        ctx.Check(D3DXVec4Dot(&a, &b), RefDot4(ra, rb), MaxAbs(ra) * MaxAbs(rb) * 4.0);
+    }
+}
+TEST_CASE(Test_D3DXVec4Basic, 4.0);
+
+void Test_D3DXVecNormalize(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXVECTOR2> v2(kCount), r2(kCount);
+    std::vector<D3DXVECTOR3> v3(kCount), r3(kCount);
+    std::vector<D3DXVECTOR4> v4(kCount), r4(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        v2[i] = rng.Vec2();
+        v3[i] = rng.Vec3();
+        v4[i] = rng.Vec4();
+    }
+
+    ctx.Measure(kCount * 3, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        {
+            D3DXVec2Normalize(&r2[i], &v2[i]);
+            D3DXVec3Normalize(&r3[i], &v3[i]);
+            D3DXVec4Normalize(&r4[i], &v4[i]);
+        }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto a = RefVec(v2[i]);
+        auto b = RefVec(v3[i]);
+        auto c = RefVec(v4[i]);
+        CheckVector(ctx, &r2[i].x, a * (1.0 / std::sqrt(RefDot3(a, a))), 2);
+        CheckVector(ctx, &r3[i].x, b * (1.0 / std::sqrt(RefDot3(b, b))), 3);
+        CheckVector(ctx, &r4[i].x, c * (1.0 / std::sqrt(RefDot4(c, c))), 4);
+    }
+}
+TEST_CASE(Test_D3DXVecNormalize, 4.0);
+
+// Hermite / CatmullRom / BaryCentric の参照値.
+RefVector RefHermite(const RefVector& v1, const RefVector& t1, const RefVector& v2, const RefVector& t2, double s)
+{
+    auto s2 = s * s;
+    auto s3 = s2 * s;
+    return v1 * (2.0 * s3 - 3.0 * s2 + 1.0)
+         + t1 * (s3 - 2.0 * s2 + s)
+         + v2 * (-2.0 * s3 + 3.0 * s2)
+         + t2 * (s3 - s2);
+}
+
+RefVector RefCatmullRom(const RefVector& v0, const RefVector& v1, const RefVector& v2, const RefVector& v3, double s)
+{
+    auto s2 = s * s;
+    auto s3 = s2 * s;
+    return (v1 * 2.0
+          + (v2 - v0) * s
+          + (v0 * 2.0 - v1 * 5.0 + v2 * 4.0 - v3) * s2
+          + (v1 * 3.0 - v0 - v2 * 3.0 + v3) * s3) * 0.5;
+}
+
+RefVector RefBaryCentric(const RefVector& v1, const RefVector& v2, const RefVector& v3, double f, double g)
+{ return v1 + (v2 - v1) * f + (v3 - v1) * g; }
+
+void Test_D3DXVecInterpolate(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        D3DXVECTOR4 p[4] = { rng.Vec4(), rng.Vec4(), rng.Vec4(), rng.Vec4() };
+        RefVector   r[4] = { RefVec(p[0]), RefVec(p[1]), RefVec(p[2]), RefVec(p[3]) };
+        auto s = rng.Uniform(0.0f, 1.0f);
+        auto f = rng.Uniform(-1.0f, 1.0f);
+        auto g = rng.Uniform(-1.0f, 1.0f);
+
+        // 中間値の大きさを誤差の基準にする.
+        auto magnitude = std::max(std::max(MaxAbs(r[0]), MaxAbs(r[1])), std::max(MaxAbs(r[2]), MaxAbs(r[3]))) * 8.0;
+
+        auto hermite = RefHermite(r[0], r[1], r[2], r[3], s);
+        auto catmull = RefCatmullRom(r[0], r[1], r[2], r[3], s);
+        auto bary    = RefBaryCentric(r[0], r[1], r[2], f, g);
+
+        D3DXVECTOR2 p2[4] = { D3DXVECTOR2(&p[0].x), D3DXVECTOR2(&p[1].x), D3DXVECTOR2(&p[2].x), D3DXVECTOR2(&p[3].x) };
+        D3DXVECTOR3 p3[4] = { D3DXVECTOR3(&p[0].x), D3DXVECTOR3(&p[1].x), D3DXVECTOR3(&p[2].x), D3DXVECTOR3(&p[3].x) };
+        D3DXVECTOR2 o2;
+        D3DXVECTOR3 o3;
+        D3DXVECTOR4 o4;
+
+        CheckVector(ctx, &D3DXVec2Hermite(&o2, &p2[0], &p2[1], &p2[2], &p2[3], s)->x, hermite, 2, magnitude);
+        CheckVector(ctx, &D3DXVec3Hermite(&o3, &p3[0], &p3[1], &p3[2], &p3[3], s)->x, hermite, 3, magnitude);
+        CheckVector(ctx, &D3DXVec4Hermite(&o4, &p [0], &p [1], &p [2], &p [3], s)->x, hermite, 4, magnitude);
+
+        CheckVector(ctx, &D3DXVec2CatmullRom(&o2, &p2[0], &p2[1], &p2[2], &p2[3], s)->x, catmull, 2, magnitude);
+        CheckVector(ctx, &D3DXVec3CatmullRom(&o3, &p3[0], &p3[1], &p3[2], &p3[3], s)->x, catmull, 3, magnitude);
+        CheckVector(ctx, &D3DXVec4CatmullRom(&o4, &p [0], &p [1], &p [2], &p [3], s)->x, catmull, 4, magnitude);
+
+        CheckVector(ctx, &D3DXVec2BaryCentric(&o2, &p2[0], &p2[1], &p2[2], f, g)->x, bary, 2, magnitude);
+        CheckVector(ctx, &D3DXVec3BaryCentric(&o3, &p3[0], &p3[1], &p3[2], f, g)->x, bary, 3, magnitude);
+        CheckVector(ctx, &D3DXVec4BaryCentric(&o4, &p [0], &p [1], &p [2], f, g)->x, bary, 4, magnitude);
+    }
+}
+TEST_CASE(Test_D3DXVecInterpolate, 8.0);
+
+void Test_D3DXVec4Cross(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto u = rng.Vec4();
+        auto v = rng.Vec4();
+        auto w = rng.Vec4();
+
+        // 3x3小行列式による一般化外積.
+        auto ru = RefVec(u), rv = RefVec(v), rw = RefVec(w);
+        auto minor = [&](int a, int b, int c)
+        {
+            return ru[a] * (rv[b] * rw[c] - rv[c] * rw[b])
+                 - ru[b] * (rv[a] * rw[c] - rv[c] * rw[a])
+                 + ru[c] * (rv[a] * rw[b] - rv[b] * rw[a]);
+        };
+        RefVector expected = { minor(1, 2, 3), -minor(0, 2, 3), minor(0, 1, 3), -minor(0, 1, 2) };
+
+        D3DXVECTOR4 ret;
+        D3DXVec4Cross(&ret, &u, &v, &w);
+        CheckVector(ctx, &ret.x, expected, 4, MaxAbs(ru) * MaxAbs(rv) * MaxAbs(rw) * 6.0);
+    }
+}
+TEST_CASE(Test_D3DXVec4Cross, 8.0);
+
+void Test_D3DXVecTransform(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXVECTOR3> src(kCount);
+    std::vector<D3DXMATRIX>  mtx(kCount);
+    std::vector<D3DXVECTOR4> dst(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        src[i] = rng.Vec3();
+        mtx[i] = rng.General();
+    }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXVec3Transform(&dst[i], &src[i], &mtx[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto m  = RefMat(mtx[i]);
+        auto v3 = RefVec(src[i], 1.0);
+        auto v2 = RefVec(D3DXVECTOR2(src[i].x, src[i].y), 0.0, 1.0);
+        auto v4 = RefVec(D3DXVECTOR4(src[i].x, src[i].y, src[i].z, src[i].x));
+
+        CheckVector(ctx, &dst[i].x, RefTransform(v3, m), 4, TransformMagnitude(v3, m));
+
+        D3DXVECTOR2 p2(src[i].x, src[i].y);
+        D3DXVECTOR4 p4(src[i].x, src[i].y, src[i].z, src[i].x);
+        D3DXVECTOR4 ret;
+        CheckVector(ctx, &D3DXVec2Transform(&ret, &p2, &mtx[i])->x, RefTransform(v2, m), 4, TransformMagnitude(v2, m));
+        CheckVector(ctx, &D3DXVec4Transform(&ret, &p4, &mtx[i])->x, RefTransform(v4, m), 4, TransformMagnitude(v4, m));
+    }
+}
+TEST_CASE(Test_D3DXVecTransform, 4.0);
+
+void Test_D3DXVecTransformCoord(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXVECTOR3> src(kCount);
+    std::vector<D3DXMATRIX>  mtx(kCount);
+    std::vector<D3DXVECTOR3> dst(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        src[i] = rng.Vec3();
+        mtx[i] = rng.Projective();
+    }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXVec3TransformCoord(&dst[i], &src[i], &mtx[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto m  = RefMat(mtx[i]);
+        auto v3 = RefVec(src[i], 1.0);
+        auto v2 = RefVec(D3DXVECTOR2(src[i].x, src[i].y), 0.0, 1.0);
+        auto t3 = RefTransform(v3, m);
+        auto t2 = RefTransform(v2, m);
+
+        CheckVector(ctx, &dst[i].x, t3 * (1.0 / t3[3]), 3, TransformMagnitude(v3, m) / std::fabs(t3[3]));
+
+        D3DXVECTOR2 p2(src[i].x, src[i].y);
+        D3DXVECTOR2 ret;
+        CheckVector(ctx, &D3DXVec2TransformCoord(&ret, &p2, &mtx[i])->x, t2 * (1.0 / t2[3]), 2, TransformMagnitude(v2, m) / std::fabs(t2[3]));
+    }
+}
+TEST_CASE(Test_D3DXVecTransformCoord, 8.0);
+
+void Test_D3DXVecTransformNormal(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto v   = rng.Vec3();
+        auto mtx = rng.General();
+        auto m   = RefMat(mtx);
+        auto v3  = RefVec(v, 0.0);
+        auto v2  = RefVec(D3DXVECTOR2(v.x, v.y), 0.0, 0.0);
+
+        D3DXVECTOR3 r3;
+        D3DXVECTOR2 r2;
+        D3DXVECTOR2 p2(v.x, v.y);
+        CheckVector(ctx, &D3DXVec3TransformNormal(&r3, &v, &mtx)->x, RefTransform(v3, m), 3, TransformMagnitude(v3, m));
+        CheckVector(ctx, &D3DXVec2TransformNormal(&r2, &p2, &mtx)->x, RefTransform(v2, m), 2, TransformMagnitude(v2, m));
+    }
+}
+TEST_CASE(Test_D3DXVecTransformNormal, 4.0);
+
+// 配列版と並列版を1要素版の参照値と比較する.
+template<typename Vector, typename Output, typename Func>
+void CheckTransformArray(TestContext& ctx, size_t count, double w, bool divide, Func func)
+{
+    Random rng;
+    const int dim = int(sizeof(Vector) / sizeof(float));
+    const int out = int(sizeof(Output) / sizeof(float));
+
+    std::vector<Vector> src(count);
+    std::vector<Output> dst(count);
+    auto mtx = divide ? rng.Projective() : rng.General();
+    auto m   = RefMat(mtx);
+    for (auto& v : src)
+    {
+        for (int c = 0; c < dim; ++c)
+        { (&v.x)[c] = rng.Uniform(-10.0f, 10.0f); }
+    }
+
+    ctx.Measure(count, [&]()
+    { func(dst.data(), uint32_t(sizeof(Output)), src.data(), uint32_t(sizeof(Vector)), &mtx, uint32_t(count)); });
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto v = RefVec(&src[i].x, dim, w);
+        if (dim < 4)
+        { v[3] = w; }
+
+        auto t = RefTransform(v, m);
+        auto magnitude = TransformMagnitude(v, m);
+        if (divide)
+        {
+            magnitude /= std::fabs(t[3]);
+            t = t * (1.0 / t[3]);
+        }
+        CheckVector(ctx, &dst[i].x, t, out, magnitude);
+    }
+}
+
+void Test_D3DXVecTransformArray(TestContext& ctx)
+{
+    CheckTransformArray<D3DXVECTOR2, D3DXVECTOR4>(ctx, kArrayCount, 1.0, false, D3DXVec2TransformArray);
+    CheckTransformArray<D3DXVECTOR3, D3DXVECTOR4>(ctx, kArrayCount, 1.0, false, D3DXVec3TransformArray);
+    CheckTransformArray<D3DXVECTOR4, D3DXVECTOR4>(ctx, kArrayCount, 0.0, false, D3DXVec4TransformArray);
+}
+TEST_CASE(Test_D3DXVecTransformArray, 4.0);
+
+void Test_D3DXVecTransformCoordArray(TestContext& ctx)
+{
+    CheckTransformArray<D3DXVECTOR2, D3DXVECTOR2>(ctx, kArrayCount, 1.0, true, D3DXVec2TransformCoordArray);
+    CheckTransformArray<D3DXVECTOR3, D3DXVECTOR3>(ctx, kArrayCount, 1.0, true, D3DXVec3TransformCoordArray);
+}
+TEST_CASE(Test_D3DXVecTransformCoordArray, 8.0);
+
+void Test_D3DXVecTransformNormalArray(TestContext& ctx)
+{
+    CheckTransformArray<D3DXVECTOR2, D3DXVECTOR2>(ctx, kArrayCount, 0.0, false, D3DXVec2TransformNormalArray);
+    CheckTransformArray<D3DXVECTOR3, D3DXVECTOR3>(ctx, kArrayCount, 0.0, false, D3DXVec3TransformNormalArray);
+}
+TEST_CASE(Test_D3DXVecTransformNormalArray, 4.0);
+
+void Test_D3DXVecTransformArrayParallel(TestContext& ctx)
+{
+    CheckTransformArray<D3DXVECTOR2, D3DXVECTOR2>(ctx, kParallelCount, 1.0, true,  D3DXVec2TransformCoordArrayParallel);
+    CheckTransformArray<D3DXVECTOR3, D3DXVECTOR3>(ctx, kParallelCount, 1.0, true,  D3DXVec3TransformCoordArrayParallel);
+    CheckTransformArray<D3DXVECTOR2, D3DXVECTOR2>(ctx, kParallelCount, 0.0, false, D3DXVec2TransformNormalArrayParallel);
+    CheckTransformArray<D3DXVECTOR3, D3DXVECTOR3>(ctx, kParallelCount, 0.0, false, D3DXVec3TransformNormalArrayParallel);
+    CheckTransformArray<D3DXVECTOR4, D3DXVECTOR4>(ctx, kParallelCount, 0.0, false, D3DXVec4TransformArrayParallel);
+}
+TEST_CASE(Test_D3DXVecTransformArrayParallel, 8.0);
+
+// D3DXVec3Project の参照値.
+RefVector RefProject(const RefVector& v, const D3DVIEWPORT9& vp, const RefMatrix& wvp)
+{
+    auto t = RefTransform(v, wvp);
+    t = t * (1.0 / t[3]);
+    return {
+        vp.X + (1.0 + t[0]) * vp.Width  * 0.5,
+        vp.Y + (1.0 - t[1]) * vp.Height * 0.5,
+        vp.MinZ + t[2] * (vp.MaxZ - vp.MinZ),
+        0.0 };
+}
+
+struct ProjectSetup
+{
+    D3DVIEWPORT9    Viewport;
+    D3DXMATRIX      World;
+    D3DXMATRIX      View;
+    D3DXMATRIX      Proj;
+    RefMatrix       WVP;
+
+    ProjectSetup()
+    {
+        Random rng(54321);
+        Viewport.X      = 16;
+        Viewport.Y      = 32;
+        Viewport.Width  = 1280;
+        Viewport.Height = 720;
+        Viewport.MinZ   = 0.0f;
+        Viewport.MaxZ   = 1.0f;
+
+        D3DXVECTOR3 eye(3.0f, 4.0f, -40.0f), at(0.0f, 0.0f, 0.0f), up(0.0f, 1.0f, 0.0f);
+        World = rng.Affine();
+        D3DXMatrixLookAtLH(&View, &eye, &at, &up);
+        D3DXMatrixPerspectiveFovLH(&Proj, 1.0f, 16.0f / 9.0f, 0.5f, 200.0f);
+        WVP = RefMat(World) * RefMat(View) * RefMat(Proj);
+    }
+};
+
+void Test_D3DXVec3Project(TestContext& ctx)
+{
+    ProjectSetup setup;
+    Random rng;
+    std::vector<D3DXVECTOR3> src(kArrayCount), dst(kArrayCount), arr(kArrayCount), back(kArrayCount);
+    for (auto& v : src)
+    { v = rng.Vec3(5.0f); }
+
+    ctx.Measure(kArrayCount, [&]()
+    {
+        for (size_t i = 0; i < kArrayCount; ++i)
+        { D3DXVec3Project(&dst[i], &src[i], &setup.Viewport, &setup.Proj, &setup.View, &setup.World); }
+    });
+
+    D3DXVec3ProjectArray(arr.data(), sizeof(D3DXVECTOR3), src.data(), sizeof(D3DXVECTOR3),
+        &setup.Viewport, &setup.Proj, &setup.View, &setup.World, uint32_t(kArrayCount));
+
+    // 行列積の丸め誤差はビューポート幅で拡大される.
+    const double magnitude = setup.Viewport.Width;
+    for (size_t i = 0; i < kArrayCount; ++i)
+    {
+        auto expected = RefProject(RefVec(src[i], 1.0), setup.Viewport, setup.WVP);
+        CheckVector(ctx, &dst[i].x, expected, 2, magnitude);
+        CheckVector(ctx, &arr[i].x, expected, 2, magnitude);
+        ctx.Check(dst[i].z, expected[2], 1.0);
+        ctx.Check(arr[i].z, expected[2], 1.0);
+    }
+}
+TEST_CASE(Test_D3DXVec3Project, 64.0);
+
+void Test_D3DXVec3Unproject(TestContext& ctx)
+{
+    ProjectSetup setup;
+    Random rng;
+    std::vector<D3DXVECTOR3> src(kArrayCount), dst(kArrayCount), arr(kArrayCount);
+    for (auto& v : src)
+    { v = D3DXVECTOR3(rng.Uniform(0.0f, 1280.0f), rng.Uniform(0.0f, 720.0f), rng.Uniform(0.9f, 0.99f)); }
+
+    ctx.Measure(kArrayCount, [&]()
+    {
+        for (size_t i = 0; i < kArrayCount; ++i)
+        { D3DXVec3Unproject(&dst[i], &src[i], &setup.Viewport, &setup.Proj, &setup.View, &setup.World); }
+    });
+
+    D3DXVec3UnprojectArray(arr.data(), sizeof(D3DXVECTOR3), src.data(), sizeof(D3DXVECTOR3),
+        &setup.Viewport, &setup.Proj, &setup.View, &setup.World, uint32_t(kArrayCount));
+
+    auto inv = RefInverse(setup.WVP, nullptr);
+    for (size_t i = 0; i < kArrayCount; ++i)
+    {
+        const auto& vp = setup.Viewport;
+        RefVector ndc = {
+            (src[i].x - vp.X) / (vp.Width * 0.5) - 1.0,
+            1.0 - (src[i].y - vp.Y) / (vp.Height * 0.5),
+            (src[i].z - vp.MinZ) / (vp.MaxZ - vp.MinZ),
+            1.0 };
+        auto t = RefTransform(ndc, inv);
+        t = t * (1.0 / t[3]);
+
+        // 遠方ほど奥行き方向の誤差が拡大するため視点からの距離を基準にする.
+        auto magnitude = std::sqrt(RefDot3(t, t)) + 40.0;
+        CheckVector(ctx, &dst[i].x, t, 3, magnitude);
+        CheckVector(ctx, &arr[i].x, t, 3, magnitude);
+    }
+}
+TEST_CASE(Test_D3DXVec3Unproject, 512.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Matrix
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXMatrixMultiply(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXMATRIX> a(kCount), b(kCount), dst(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        a[i] = rng.General();
+        b[i] = rng.General();
+    }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXMatrixMultiply(&dst[i], &a[i], &b[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto ra = RefMat(a[i]);
+        auto rb = RefMat(b[i]);
+        auto magnitude = ProductMagnitude(ra, rb);
+        CheckMatrix(ctx, dst[i], ra * rb, magnitude);
+
+        D3DXMATRIX t;
+        CheckMatrix(ctx, *D3DXMatrixMultiplyTranspose(&t, &a[i], &b[i]), RefTranspose(ra * rb), magnitude);
+        CheckMatrix(ctx, *D3DXMatrixTranspose(&t, &a[i]), RefTranspose(ra));
+    }
+}
+TEST_CASE(Test_D3DXMatrixMultiply, 4.0);
+
+void Test_D3DXMatrixMultiplyArray(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kParallelCount;
+    std::vector<D3DXMATRIX> a(n), b(n), dst(n), par(n), one(n), onePar(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = rng.General();
+        b[i] = rng.General();
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXMatrixMultiplyArray(dst.data(), a.data(), b.data(), uint32_t(n)); });
+
+    D3DXMatrixMultiplyArrayParallel(par.data(), a.data(), b.data(), uint32_t(n));
+    D3DXMatrixMultiplyArrayByMatrix(one.data(), a.data(), &b[0], uint32_t(n));
+    D3DXMatrixMultiplyArrayByMatrixParallel(onePar.data(), a.data(), &b[0], uint32_t(n));
+
+    const auto rb0 = RefMat(b[0]);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto ra = RefMat(a[i]);
+        auto rb = RefMat(b[i]);
+        CheckMatrix(ctx, dst[i], ra * rb, ProductMagnitude(ra, rb));
+        CheckMatrix(ctx, par[i], ra * rb, ProductMagnitude(ra, rb));
+        CheckMatrix(ctx, one[i], ra * rb0, ProductMagnitude(ra, rb0));
+        CheckMatrix(ctx, onePar[i], ra * rb0, ProductMagnitude(ra, rb0));
+    }
+}
+TEST_CASE(Test_D3DXMatrixMultiplyArray, 4.0);
+
+void Test_D3DXMatrixMultiplyHierarchy(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kParallelCount;
+    std::vector<D3DXMATRIX> local(n), world(n), par(n);
+    std::vector<int32_t>    parent(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        // 深い階層で誤差が増えすぎないよう回転と平行移動のみにする.
+        auto q = rng.Rotation();
+        D3DXMatrixRotationQuaternion(&local[i], &q);
+        local[i]._41 = rng.Uniform(-1.0f, 1.0f);
+        local[i]._42 = rng.Uniform(-1.0f, 1.0f);
+        local[i]._43 = rng.Uniform(-1.0f, 1.0f);
+        parent[i] = (i < 4) ? -1 : int32_t(i - 1 - (rng.Uniform(0.0f, 1.0f) < 0.5f ? 0 : i / 2));
+    }
+    auto root = rng.Affine();
+
+    ctx.Measure(n, [&]()
+    { D3DXMatrixMultiplyHierarchy(world.data(), local.data(), parent.data(), &root, uint32_t(n)); });
+
+    D3DXMatrixMultiplyHierarchyParallel(par.data(), local.data(), parent.data(), &root, uint32_t(n));
+
+    std::vector<RefMatrix> expected(n);
+    std::vector<int>       depth(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto p = parent[i];
+        expected[i] = RefMat(local[i]) * ((p < 0) ? RefMat(root) : expected[p]);
+        depth[i]    = (p < 0) ? 1 : depth[p] + 1;
+    }
+
+    // 丸め誤差は階層の深さに比例して蓄積する.
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto magnitude = (MaxAbs(expected[i]) + 1.0) * std::sqrt(double(depth[i]));
+        CheckMatrix(ctx, world[i], expected[i], magnitude);
+        CheckMatrix(ctx, par[i], expected[i], magnitude);
+    }
+}
+TEST_CASE(Test_D3DXMatrixMultiplyHierarchy, 64.0);
+
+void Test_D3DXMatrixInverse(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXMATRIX> src(kCount), dst(kCount);
+    std::vector<float>      det(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    { src[i] = (i & 1) ? rng.General() : rng.Affine(); }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXMatrixInverse(&dst[i], &det[i], &src[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        double d;
+        auto m   = RefMat(src[i]);
+        auto inv = RefInverse(m, &d);
+
+        // 誤差は条件数 |M| |M^-1| に比例する.
+        auto cond = MaxAbs(m) * MaxAbs(inv) * 4.0;
+        CheckMatrix(ctx, dst[i], inv, MaxAbs(inv) * cond);
+        ctx.Check(det[i], d, std::fabs(d) * cond);
+        ctx.Check(D3DXMatrixDeterminant(&src[i]), d, std::fabs(d) * cond);
+    }
+}
+TEST_CASE(Test_D3DXMatrixInverse, 16.0);
+
+void Test_D3DXMatrixInverseArray(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kParallelCount;
+    std::vector<D3DXMATRIX>      src(n), dst(n), par(n), inPlace(n);
+    std::vector<float>           det(n), parDet(n);
+    std::vector<D3DXMATRIXCLASS> type(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        // 剛体変換 (鏡映を含む), アフィン変換, 一般の行列を混ぜる.
+        switch (i % 3)
+        {
+        case 0:
+            {
+                auto q = rng.Rotation();
+                auto m = RefRotationQuaternion(RefVec(q)) * RefTranslation(rng.Uniform(-10.0f, 10.0f), rng.Uniform(-10.0f, 10.0f), rng.Uniform(-10.0f, 10.0f));
+                if (i % 2)
+                { m = RefScaling(-1.0, 1.0, 1.0) * m; }
+                src[i]  = ToFloat(m);
+                type[i] = D3DXMATRIXCLASS_RIGID;
+            }
+            break;
+
+        case 1:
+            src[i]  = rng.Affine();
+            type[i] = D3DXMATRIXCLASS_AFFINE;
+            break;
+
+        default:
+            src[i]  = rng.General();
+            type[i] = D3DXMATRIXCLASS_GENERAL;
+            break;
+        }
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXMatrixInverseArray(dst.data(), det.data(), src.data(), uint32_t(n)); });
+
+    D3DXMatrixInverseArrayParallel(par.data(), parDet.data(), src.data(), uint32_t(n));
+    ctx.Expect(memcmp(par.data(), dst.data(), n * sizeof(D3DXMATRIX)) == 0 &&
+               memcmp(parDet.data(), det.data(), n * sizeof(float)) == 0, "D3DXMatrixInverseArrayParallel");
+
+    inPlace = src;
+    D3DXMatrixInverseArray(inPlace.data(), nullptr, inPlace.data(), uint32_t(n));
+    ctx.Expect(memcmp(inPlace.data(), dst.data(), n * sizeof(D3DXMATRIX)) == 0, "D3DXMatrixInverseArray in place");
+
+    bool classified = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+        classified &= (D3DXMatrixClassify(&src[i]) == type[i]);
+
+        double d;
+        auto m   = RefMat(src[i]);
+        auto inv = RefInverse(m, &d);
+
+        // 誤差は条件数 |M| |M^-1| に比例する.
+        auto cond = MaxAbs(m) * MaxAbs(inv) * 4.0;
+        CheckMatrix(ctx, dst[i], inv, MaxAbs(inv) * cond);
+        ctx.Check(det[i], d, std::fabs(d) * cond);
+    }
+    ctx.Expect(classified, "D3DXMatrixClassify");
+}
+TEST_CASE(Test_D3DXMatrixInverseArray, 16.0);
+
+void Test_D3DXMatrixBuild(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto x = rng.Uniform(-10.0f, 10.0f);
+        auto y = rng.Uniform(-10.0f, 10.0f);
+        auto z = rng.Uniform(-10.0f, 10.0f);
+        auto angle = rng.Uniform(-6.0f, 6.0f);
+        auto axis  = rng.Vec3();
+        auto q     = rng.Rotation();
+
+        D3DXMATRIX m;
+        CheckMatrix(ctx, *D3DXMatrixScaling(&m, x, y, z), RefScaling(x, y, z));
+        CheckMatrix(ctx, *D3DXMatrixTranslation(&m, x, y, z), RefTranslation(x, y, z));
+        CheckMatrix(ctx, *D3DXMatrixRotationX(&m, angle), RefRotationX(angle));
+        CheckMatrix(ctx, *D3DXMatrixRotationY(&m, angle), RefRotationY(angle));
+        CheckMatrix(ctx, *D3DXMatrixRotationZ(&m, angle), RefRotationZ(angle));
+        CheckMatrix(ctx, *D3DXMatrixRotationAxis(&m, &axis, angle), RefRotationQuaternion(RefQuaternionAxis(RefVec(axis), angle)));
+        CheckMatrix(ctx, *D3DXMatrixRotationQuaternion(&m, &q), RefRotationQuaternion(RefVec(q)));
+        CheckMatrix(ctx, *D3DXMatrixRotationYawPitchRoll(&m, x, y, z), RefRotationYawPitchRoll(x, y, z));
+    }
+
+    D3DXMATRIX identity;
+    D3DXMatrixIdentity(&identity);
+    CheckMatrix(ctx, identity, RefIdentity());
+    ctx.Expect(D3DXMatrixIsIdentity(&identity) != FALSE, "D3DXMatrixIsIdentity");
+}
+TEST_CASE(Test_D3DXMatrixBuild, 16.0);
+
+void Test_D3DXMatrixTransformation(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto sc = rng.Vec3();
+        auto sr = rng.Rotation();
+        auto s  = D3DXVECTOR3(rng.Uniform(0.5f, 2.0f), rng.Uniform(0.5f, 2.0f), rng.Uniform(0.5f, 2.0f));
+        auto rc = rng.Vec3();
+        auto r  = rng.Rotation();
+        auto t  = rng.Vec3();
+        auto uniform = rng.Uniform(0.5f, 2.0f);
+
+        auto Msr = RefRotationQuaternion(RefVec(sr));
+        auto Mr  = RefRotationQuaternion(RefVec(r));
+        auto expected = RefTranslation(-sc.x, -sc.y, -sc.z) * RefTranspose(Msr) * RefScaling(s.x, s.y, s.z) * Msr
+                      * RefTranslation(sc.x, sc.y, sc.z) * RefTranslation(-rc.x, -rc.y, -rc.z) * Mr
+                      * RefTranslation(rc.x, rc.y, rc.z) * RefTranslation(t.x, t.y, t.z);
+
+        // 中心点の平行移動が打ち消し合うため入力の大きさを基準にする.
+        auto magnitude = MaxAbs(expected) + 40.0;
+
+        D3DXMATRIX m;
+        CheckMatrix(ctx, *D3DXMatrixTransformation(&m, &sc, &sr, &s, &rc, &r, &t), expected, magnitude);
+
+        auto affine = RefScaling(uniform, uniform, uniform) * RefTranslation(-rc.x, -rc.y, -rc.z) * Mr
+                    * RefTranslation(rc.x, rc.y, rc.z) * RefTranslation(t.x, t.y, t.z);
+        CheckMatrix(ctx, *D3DXMatrixAffineTransformation(&m, uniform, &rc, &r, &t), affine, MaxAbs(affine) + 40.0);
+
+        // 2D版はXY平面内の変換.
+        auto sc2 = D3DXVECTOR2(sc.x, sc.y);
+        auto s2  = D3DXVECTOR2(s.x, s.y);
+        auto rc2 = D3DXVECTOR2(rc.x, rc.y);
+        auto t2  = D3DXVECTOR2(t.x, t.y);
+        auto sa  = rng.Uniform(-3.0f, 3.0f);
+        auto ra  = rng.Uniform(-3.0f, 3.0f);
+
+        auto Msr2 = RefRotationZ(sa);
+        auto Mr2  = RefRotationZ(ra);
+        auto expected2 = RefTranslation(-sc2.x, -sc2.y, 0.0) * RefTranspose(Msr2) * RefScaling(s2.x, s2.y, 1.0) * Msr2
+                       * RefTranslation(sc2.x, sc2.y, 0.0) * RefTranslation(-rc2.x, -rc2.y, 0.0) * Mr2
+                       * RefTranslation(rc2.x, rc2.y, 0.0) * RefTranslation(t2.x, t2.y, 0.0);
+        CheckMatrix(ctx, *D3DXMatrixTransformation2D(&m, &sc2, sa, &s2, &rc2, ra, &t2), expected2, MaxAbs(expected2) + 40.0);
+
+        auto affine2 = RefScaling(uniform, uniform, 1.0) * RefTranslation(-rc2.x, -rc2.y, 0.0) * Mr2
+                     * RefTranslation(rc2.x, rc2.y, 0.0) * RefTranslation(t2.x, t2.y, 0.0);
+        CheckMatrix(ctx, *D3DXMatrixAffineTransformation2D(&m, uniform, &rc2, ra, &t2), affine2, MaxAbs(affine2) + 40.0);
+    }
+}
+TEST_CASE(Test_D3DXMatrixTransformation, 32.0);
+
+void Test_D3DXMatrixDecompose(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXMATRIX>     src(kCount);
+    std::vector<D3DXVECTOR3>    scale(kCount), trans(kCount);
+    std::vector<D3DXQUATERNION> rot(kCount);
+    std::vector<RefVector>      refScale(kCount), refRot(kCount), refTrans(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto q = rng.Rotation();
+        auto s = rng.Vec3(2.0f);
+        auto t = rng.Vec3();
+        for (int c = 0; c < 3; ++c)
+        { (&s.x)[c] = std::fabs((&s.x)[c]) + 0.25f; }
+
+        src[i]      = ToFloat(RefScaling(s.x, s.y, s.z) * RefRotationQuaternion(RefVec(q)) * RefTranslation(t.x, t.y, t.z));
+        refScale[i] = RefVec(s);
+        refRot[i]   = RefVec(q);
+        refTrans[i] = RefVec(t);
+    }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXMatrixDecompose(&scale[i], &rot[i], &trans[i], &src[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        // 入力行列自体が単精度に丸められているため, 行列の大きさを基準にする.
+        auto magnitude = MaxAbs(RefMat(src[i]));
+        CheckVector(ctx, &scale[i].x, refScale[i], 3, magnitude);
+        CheckVector(ctx, &trans[i].x, refTrans[i], 3, magnitude);
+        CheckRotation(ctx, rot[i], refRot[i]);
+    }
+}
+TEST_CASE(Test_D3DXMatrixDecompose, 64.0);
+
+void Test_D3DXMatrixDecomposeArray(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kParallelCount;
+    std::vector<D3DXMATRIX>     src(n), dst(n), par(n);
+    std::vector<D3DXVECTOR3>    scale(n), trans(n), parScale(n), parTrans(n);
+    std::vector<D3DXQUATERNION> rot(n), parRot(n);
+    std::vector<uint32_t>       failed((n + 31) / 32), parFailed((n + 31) / 32);
+    std::vector<int>            kind(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto q = rng.Rotation();
+        auto s = rng.Vec3(2.0f);
+        auto t = rng.Vec3();
+        for (int c = 0; c < 3; ++c)
+        { (&s.x)[c] = std::copysign(std::fabs((&s.x)[c]) + 0.25f, (&s.x)[c]); }
+
+        // 0: 通常の行列, 1: 縮尺が 0 の軸を持つ行列, 2: せん断を含む行列.
+        kind[i] = (i % 17 == 5) ? 1 : (i % 23 == 7) ? 2 : 0;
+        if (kind[i] == 1)
+        { (&s.x)[i % 3] = 0.0f; }
+
+        auto m = RefScaling(s.x, s.y, s.z) * RefRotationQuaternion(RefVec(q)) * RefTranslation(t.x, t.y, t.z);
+        if (kind[i] == 2)
+        {
+            // 2行目をほぼ1行目と同じ向きにする.
+            for (int c = 0; c < 3; ++c)
+            { m.m[1][c] = m.m[0][c] + 0.1 * m.m[1][c]; }
+        }
+        src[i] = ToFloat(m);
+    }
+
+    uint32_t count = 0;
+    ctx.Measure(n, [&]()
+    { count = D3DXMatrixDecomposeArray(scale.data(), rot.data(), trans.data(), failed.data(), src.data(), uint32_t(n)); });
+
+    auto parCount = D3DXMatrixDecomposeArrayParallel(parScale.data(), parRot.data(), parTrans.data(), parFailed.data(), src.data(), uint32_t(n));
+    ctx.Expect(parCount == count && parFailed == failed, "D3DXMatrixDecomposeArrayParallel failed bits");
+    ctx.Expect(memcmp(parScale.data(), scale.data(), n * sizeof(D3DXVECTOR3)) == 0 &&
+               memcmp(parRot.data(), rot.data(), n * sizeof(D3DXQUATERNION)) == 0 &&
+               memcmp(parTrans.data(), trans.data(), n * sizeof(D3DXVECTOR3)) == 0, "D3DXMatrixDecomposeArrayParallel");
+
+    // 組み立て直すと元の行列に戻る. 縮尺の符号は一意に決まらないので行列で比較する.
+    D3DXMatrixComposeArray(dst.data(), scale.data(), rot.data(), trans.data(), uint32_t(n));
+
+    uint32_t expectedCount = 0;
+    bool     matched       = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const bool bit = (failed[i / 32] >> (i % 32)) & 1;
+        if (kind[i] == 1)
+        {
+            // 縮尺が 0 の軸の補い方は D3DXMatrixDecompose と同じになる.
+            D3DXVECTOR3    s, t;
+            D3DXQUATERNION q;
+            const bool ok = (D3DXMatrixDecompose(&s, &q, &t, &src[i]) == 0);
+            matched &= (ok != bit);
+            if (ok)
+            {
+                matched &= (memcmp(&s, &scale[i], sizeof(s)) == 0);
+                matched &= (memcmp(&q, &rot[i], sizeof(q)) == 0);
+                matched &= (memcmp(&t, &trans[i], sizeof(t)) == 0);
+            }
+        }
+        else if (kind[i] == 2)
+        {
+            matched &= bit;
+            matched &= (scale[i] == D3DXVECTOR3(1.0f, 1.0f, 1.0f));
+            matched &= (rot[i] == D3DXQUATERNION(0.0f, 0.0f, 0.0f, 1.0f));
+            matched &= (trans[i] == D3DXVECTOR3(0.0f, 0.0f, 0.0f));
+        }
+        else
+        {
+            matched &= !bit;
+            CheckMatrix(ctx, dst[i], RefMat(src[i]), MaxAbs(RefMat(src[i])));
+        }
+        expectedCount += bit ? 1 : 0;
+    }
+    ctx.Expect(matched, "D3DXMatrixDecomposeArray failed elements");
+    ctx.Expect(count == expectedCount, "D3DXMatrixDecomposeArray failed count");
+}
+TEST_CASE(Test_D3DXMatrixDecomposeArray, 64.0);
+
+void Test_D3DXMatrixComposeArray(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kParallelCount;
+    std::vector<D3DXMATRIX>     dst(n), par(n), noScale(n), onlyRot(n);
+    std::vector<D3DXVECTOR3>    scale(n), trans(n);
+    std::vector<D3DXQUATERNION> rot(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        scale[i] = rng.Vec3(2.0f);
+        rot[i]   = rng.Rotation();
+        trans[i] = rng.Vec3();
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXMatrixComposeArray(dst.data(), scale.data(), rot.data(), trans.data(), uint32_t(n)); });
+
+    D3DXMatrixComposeArrayParallel(par.data(), scale.data(), rot.data(), trans.data(), uint32_t(n));
+    D3DXMatrixComposeArray(noScale.data(), nullptr, rot.data(), trans.data(), uint32_t(n));
+    D3DXMatrixComposeArray(onlyRot.data(), nullptr, rot.data(), nullptr, uint32_t(n));
+    ctx.Expect(memcmp(par.data(), dst.data(), n * sizeof(D3DXMATRIX)) == 0, "D3DXMatrixComposeArrayParallel");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto s = scale[i];
+        auto t = trans[i];
+        auto r = RefRotationQuaternion(RefVec(rot[i]));
+        auto expected = RefScaling(s.x, s.y, s.z) * r * RefTranslation(t.x, t.y, t.z);
+        CheckMatrix(ctx, dst[i], expected, MaxAbs(expected));
+        CheckMatrix(ctx, noScale[i], r * RefTranslation(t.x, t.y, t.z), MaxAbs(expected));
+        CheckMatrix(ctx, onlyRot[i], r, 1.0);
+    }
+}
+TEST_CASE(Test_D3DXMatrixComposeArray, 16.0);
+
+void Test_D3DXMatrixView(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto eye = rng.Vec3();
+        auto at  = rng.Vec3();
+        auto up  = D3DXVECTOR3(0.0f, 1.0f, 0.0f);
+
+        auto re = RefVec(eye);
+        auto ra = RefVec(at);
+        auto ru = RefVec(up);
+
+        for (int lh = 0; lh < 2; ++lh)
+        {
+            auto zaxis = RefNormalize3(lh ? ra - re : re - ra);
+            auto xaxis = RefNormalize3(RefCross3(ru, zaxis));
+            auto yaxis = RefCross3(zaxis, xaxis);
+
+            RefMatrix expected = {{
+                { xaxis[0], yaxis[0], zaxis[0], 0.0 },
+                { xaxis[1], yaxis[1], zaxis[1], 0.0 },
+                { xaxis[2], yaxis[2], zaxis[2], 0.0 },
+                { -RefDot3(xaxis, re), -RefDot3(yaxis, re), -RefDot3(zaxis, re), 1.0 } }};
+
+            D3DXMATRIX m;
+            if (lh)
+            { D3DXMatrixLookAtLH(&m, &eye, &at, &up); }
+            else
+            { D3DXMatrixLookAtRH(&m, &eye, &at, &up); }
+
+            CheckMatrix(ctx, m, expected, MaxAbs(re) * 3.0);
+        }
+    }
+}
+TEST_CASE(Test_D3DXMatrixView, 16.0);
+
+void Test_D3DXMatrixProjection(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        double w  = rng.Uniform(0.5f, 4.0f);
+        double h  = rng.Uniform(0.5f, 4.0f);
+        double zn = rng.Uniform(0.1f, 1.0f);
+        double zf = rng.Uniform(10.0f, 1000.0f);
+        double l  = rng.Uniform(-4.0f, -0.5f);
+        double r  = rng.Uniform(0.5f, 4.0f);
+        double b  = rng.Uniform(-4.0f, -0.5f);
+        double t  = rng.Uniform(0.5f, 4.0f);
+        double fov    = rng.Uniform(0.3f, 2.5f);
+        double aspect = rng.Uniform(0.5f, 2.5f);
+
+        const auto fw  = float(w),  fh  = float(h);
+        const auto fzn = float(zn), fzf = float(zf);
+        const auto fl  = float(l),  fr  = float(r), fb = float(b), ft = float(t);
+
+        D3DXMATRIX m;
+        RefMatrix  e;
+
+        // Perspective.
+        e = {{ { 2 * zn / w, 0, 0, 0 }, { 0, 2 * zn / h, 0, 0 }, { 0, 0, zf / (zf - zn), 1 }, { 0, 0, zn * zf / (zn - zf), 0 } }};
+        CheckMatrix(ctx, *D3DXMatrixPerspectiveLH(&m, fw, fh, fzn, fzf), e);
+        e = {{ { 2 * zn / w, 0, 0, 0 }, { 0, 2 * zn / h, 0, 0 }, { 0, 0, zf / (zn - zf), -1 }, { 0, 0, zn * zf / (zn - zf), 0 } }};
+        CheckMatrix(ctx, *D3DXMatrixPerspectiveRH(&m, fw, fh, fzn, fzf), e);
+
+        // PerspectiveFov.
+        auto ys = 1.0 / std::tan(double(float(fov)) * 0.5);
+        auto xs = ys / double(float(aspect));
+        e = {{ { xs, 0, 0, 0 }, { 0, ys, 0, 0 }, { 0, 0, zf / (zf - zn), 1 }, { 0, 0, -zn * zf / (zf - zn), 0 } }};
+        CheckMatrix(ctx, *D3DXMatrixPerspectiveFovLH(&m, float(fov), float(aspect), fzn, fzf), e);
+        e = {{ { xs, 0, 0, 0 }, { 0, ys, 0, 0 }, { 0, 0, zf / (zn - zf), -1 }, { 0, 0, zn * zf / (zn - zf), 0 } }};
+        CheckMatrix(ctx, *D3DXMatrixPerspectiveFovRH(&m, float(fov), float(aspect), fzn, fzf), e);
+
+        // PerspectiveOffCenter.
+        e = {{ { 2 * zn / (r - l), 0, 0, 0 }, { 0, 2 * zn / (t - b), 0, 0 },
+               { (l + r) / (l - r), (t + b) / (b - t), zf / (zf - zn), 1 }, { 0, 0, zn * zf / (zn - zf), 0 } }};
+        CheckMatrix(ctx, *D3DXMatrixPerspectiveOffCenterLH(&m, fl, fr, fb, ft, fzn, fzf), e);
+        e = {{ { 2 * zn / (r - l), 0, 0, 0 }, { 0, 2 * zn / (t - b), 0, 0 },
+               { (l + r) / (r - l), (t + b) / (t - b), zf / (zn - zf), -1 }, { 0, 0, zn * zf / (zn - zf), 0 } }};
+        CheckMatrix(ctx, *D3DXMatrixPerspectiveOffCenterRH(&m, fl, fr, fb, ft, fzn, fzf), e);
+
+        // Ortho.
+        e = {{ { 2 / w, 0, 0, 0 }, { 0, 2 / h, 0, 0 }, { 0, 0, 1 / (zf - zn), 0 }, { 0, 0, zn / (zn - zf), 1 } }};
+        CheckMatrix(ctx, *D3DXMatrixOrthoLH(&m, fw, fh, fzn, fzf), e);
+        e = {{ { 2 / w, 0, 0, 0 }, { 0, 2 / h, 0, 0 }, { 0, 0, 1 / (zn - zf), 0 }, { 0, 0, zn / (zn - zf), 1 } }};
+        CheckMatrix(ctx, *D3DXMatrixOrthoRH(&m, fw, fh, fzn, fzf), e);
+
+        // OrthoOffCenter.
+        e = {{ { 2 / (r - l), 0, 0, 0 }, { 0, 2 / (t - b), 0, 0 }, { 0, 0, 1 / (zf - zn), 0 },
+               { (l + r) / (l - r), (t + b) / (b - t), zn / (zn - zf), 1 } }};
+        CheckMatrix(ctx, *D3DXMatrixOrthoOffCenterLH(&m, fl, fr, fb, ft, fzn, fzf), e);
+        e = {{ { 2 / (r - l), 0, 0, 0 }, { 0, 2 / (t - b), 0, 0 }, { 0, 0, 1 / (zn - zf), 0 },
+               { (l + r) / (l - r), (t + b) / (b - t), zn / (zn - zf), 1 } }};
+        CheckMatrix(ctx, *D3DXMatrixOrthoOffCenterRH(&m, fl, fr, fb, ft, fzn, fzf), e);
+    }
+}
+TEST_CASE(Test_D3DXMatrixProjection, 16.0);
+
+void Test_D3DXMatrixShadowReflect(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto light = rng.Vec4();
+        light.w = (i & 1) ? 1.0f : 0.0f;
+        auto n     = rng.Direction();
+        auto plane = D3DXPLANE(n.x * 2.0f, n.y * 2.0f, n.z * 2.0f, rng.Uniform(-4.0f, 4.0f));
+
+        auto P = RefVec(plane);
+        P = P * (1.0 / std::sqrt(RefDot3(P, P)));
+        auto L = RefVec(light);
+        auto d = RefDot4(P, L);
+
+        // DirectXMath と同じく D3DX の式を -1 倍した行列 (射影としては等価).
+        RefMatrix shadow;
+        for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+        { shadow.m[r][c] = ((r == c) ? d : 0.0) - P[r] * L[c]; }
+
+        RefMatrix reflect = RefIdentity();
+        for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 3; ++c)
+        { reflect.m[r][c] -= 2.0 * P[r] * P[c]; }
+
+        D3DXMATRIX m;
+        CheckMatrix(ctx, *D3DXMatrixShadow(&m, &light, &plane), shadow, MaxAbs(L) * (MaxAbs(P) + 1.0) * 4.0);
+        CheckMatrix(ctx, *D3DXMatrixReflect(&m, &plane), reflect, (MaxAbs(P) + 1.0) * 4.0);
+    }
+}
+TEST_CASE(Test_D3DXMatrixShadowReflect, 16.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Quaternion
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXQuaternionBasic(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto va = rng.Vec4(2.0f);
+        auto vb = rng.Vec4(2.0f);
+        auto a = D3DXQUATERNION(&va.x);
+        auto b = D3DXQUATERNION(&vb.x);
+        auto ra = RefVec(a);
+        auto rb = RefVec(b);
+        auto magnitude = MaxAbs(ra) * MaxAbs(rb) * 4.0;
+
+        D3DXQUATERNION q;
+        CheckVector(ctx, &D3DXQuaternionMultiply(&q, &a, &b)->x, RefQuaternionMultiply(ra, rb), 4, magnitude);
+        CheckVector(ctx, &D3DXQuaternionNormalize(&q, &a)->x, RefNormalize4(ra), 4);
+        CheckVector(ctx, &D3DXQuaternionInverse(&q, &a)->x, RefQuaternionInverse(ra), 4);
+        CheckVector(ctx, &D3DXQuaternionConjugate(&q, &a)->x, RefVector{ -ra[0], -ra[1], -ra[2], ra[3] }, 4);
+        ctx.Check(D3DXQuaternionLength(&a), std::sqrt(RefDot4(ra, ra)), 0.0);
+        ctx.Check(D3DXQuaternionDot(&a, &b), RefDot4(ra, rb), magnitude);
+    }
+}
+TEST_CASE(Test_D3DXQuaternionBasic, 8.0);
+
+void Test_D3DXQuaternionRotation(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXMATRIX>     mtx(kCount);
+    std::vector<D3DXQUATERNION> src(kCount), dst(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        src[i] = rng.Rotation();
+        mtx[i] = ToFloat(RefRotationQuaternion(RefVec(src[i])));
+    }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXQuaternionRotationMatrix(&dst[i], &mtx[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        CheckRotation(ctx, dst[i], RefQuaternionFromMatrix(RefMat(mtx[i])));
+
+        auto axis  = rng.Vec3();
+        auto angle = rng.Uniform(-6.0f, 6.0f);
+        auto yaw   = rng.Uniform(-3.0f, 3.0f);
+        auto pitch = rng.Uniform(-3.0f, 3.0f);
+        auto roll  = rng.Uniform(-3.0f, 3.0f);
+
+        D3DXQUATERNION q;
+        CheckRotation(ctx, *D3DXQuaternionRotationAxis(&q, &axis, angle), RefQuaternionAxis(RefVec(axis), angle));
+        CheckRotation(ctx, *D3DXQuaternionRotationYawPitchRoll(&q, yaw, pitch, roll),
+            RefQuaternionFromMatrix(RefRotationYawPitchRoll(yaw, pitch, roll)));
+
+        // 回転軸は正規化されず, 角度は 2 acos(w).
+        D3DXVECTOR3 outAxis;
+        float outAngle;
+        D3DXQuaternionToAxisAngle(&src[i], &outAxis, &outAngle);
+        CheckVector(ctx, &outAxis.x, RefVec(src[i]), 3);
+        ctx.Check(outAngle, 2.0 * std::acos(double(src[i].w)), 2.0 * kPi);
+    }
+}
+TEST_CASE(Test_D3DXQuaternionRotation, 64.0);
+
+void Test_D3DXQuaternionLnExp(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto q  = rng.Rotation();
+        auto v  = D3DXQUATERNION(rng.Uniform(-1.0f, 1.0f), rng.Uniform(-1.0f, 1.0f), rng.Uniform(-1.0f, 1.0f), 0.0f);
+
+        D3DXQUATERNION ret;
+        CheckVector(ctx, &D3DXQuaternionLn(&ret, &q)->x, RefQuaternionLn(RefVec(q)), 4, kPi);
+        CheckVector(ctx, &D3DXQuaternionExp(&ret, &v)->x, RefQuaternionExp(RefVec(v)), 4, 1.0);
+    }
+}
+TEST_CASE(Test_D3DXQuaternionLnExp, 64.0);
+
+void Test_D3DXQuaternionSlerp(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXQUATERNION> a(kCount), b(kCount), dst(kCount);
+    std::vector<float>          t(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        a[i] = rng.Rotation();
+        b[i] = rng.Rotation();
+        t[i] = rng.Uniform(0.0f, 1.0f);
+    }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXQuaternionSlerp(&dst[i], &a[i], &b[i], t[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    { CheckVector(ctx, &dst[i].x, RefQuaternionSlerp(RefVec(a[i]), RefVec(b[i]), t[i]), 4, 1.0); }
+}
+TEST_CASE(Test_D3DXQuaternionSlerp, 64.0);
+
+void Test_D3DXQuaternionSquad(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        D3DXQUATERNION q[4] = { rng.Rotation(), rng.Rotation(), rng.Rotation(), rng.Rotation() };
+        RefVector      r[4] = { RefVec(q[0]), RefVec(q[1]), RefVec(q[2]), RefVec(q[3]) };
+        auto t = rng.Uniform(0.0f, 1.0f);
+        auto f = rng.Uniform(0.1f, 0.5f);
+        auto g = rng.Uniform(0.1f, 0.5f);
+
+        // Slerp(Slerp(Q1, C, t), Slerp(A, B, t), 2t(1-t)).
+        auto squad = RefQuaternionSlerp(RefQuaternionSlerp(r[0], r[3], t), RefQuaternionSlerp(r[1], r[2], t), 2.0 * t * (1.0 - t));
+
+        D3DXQUATERNION ret;
+        CheckRotation(ctx, *D3DXQuaternionSquad(&ret, &q[0], &q[1], &q[2], &q[3], t), squad);
+
+        auto bary = RefQuaternionSlerp(RefQuaternionSlerp(r[0], r[1], f + g), RefQuaternionSlerp(r[0], r[2], f + g), g / (f + g));
+        CheckRotation(ctx, *D3DXQuaternionBaryCentric(&ret, &q[0], &q[1], &q[2], f, g), bary);
+
+        // SquadSetup: 隣接するクォータニオンを同じ半球に揃えてから接線を求める.
+        auto q0 = r[0], q1 = r[1], q2 = r[2], q3 = r[3];
+        if (RefDot4(q0 + q1, q0 + q1) < RefDot4(q0 - q1, q0 - q1)) q0 = q0 * -1.0;
+        if (RefDot4(q1 + q2, q1 + q2) < RefDot4(q1 - q2, q1 - q2)) q2 = q2 * -1.0;
+        if (RefDot4(q2 + q3, q2 + q3) < RefDot4(q2 - q3, q2 - q3)) q3 = q3 * -1.0;
+
+        auto inv1 = RefQuaternionInverse(q1);
+        auto inv2 = RefQuaternionInverse(q2);
+        auto ln0  = RefQuaternionLn(RefQuaternionMultiply(inv1, q0));
+        auto ln2  = RefQuaternionLn(RefQuaternionMultiply(inv1, q2));
+        auto ln1  = RefQuaternionLn(RefQuaternionMultiply(inv2, q1));
+        auto ln3  = RefQuaternionLn(RefQuaternionMultiply(inv2, q3));
+        auto A = RefQuaternionMultiply(q1, RefQuaternionExp((ln0 + ln2) * -0.25));
+        auto B = RefQuaternionMultiply(q2, RefQuaternionExp((ln1 + ln3) * -0.25));
+
+        D3DXQUATERNION a, b, c;
+        D3DXQuaternionSquadSetup(&a, &b, &c, &q[0], &q[1], &q[2], &q[3]);
+        CheckVector(ctx, &a.x, A, 4, 1.0);
+        CheckVector(ctx, &b.x, B, 4, 1.0);
+        CheckVector(ctx, &c.x, q2, 4, 1.0);
+    }
+}
+TEST_CASE(Test_D3DXQuaternionSquad, 128.0);
+
+// 時刻 time を含むキー区間を線形探索で求める.
+void RefFindKey(const std::vector<float>& times, uint32_t begin, uint32_t end, float time, uint32_t& key, uint32_t& next, double& s)
+{
+    key = next = begin;
+    s   = 0.0;
+    if (time <= times[begin])
+        return;
+
+    key = next = end - 1;
+    for (auto k = begin; k + 1 < end; ++k)
+    {
+        if (time < times[k + 1])
+        {
+            key  = k;
+            next = k + 1;
+            s    = (double(time) - times[k]) / (double(times[k + 1]) - times[k]);
+            break;
+        }
+    }
+}
+
+void Test_D3DXAnimTracks(TestContext& ctx)
+{
+    Random rng;
+
+    // 端数のトラックとキーが1個だけのトラックを含める.
+    const uint32_t trackCount = 37;
+    std::vector<uint32_t>       offsets(trackCount + 1);
+    std::vector<float>          times;
+    std::vector<D3DXQUATERNION> rotations;
+    std::vector<D3DXVECTOR3>    translations;
+    for (uint32_t i = 0; i < trackCount; ++i)
+    {
+        offsets[i] = uint32_t(times.size());
+        const auto keys = (i % 7 == 3) ? 1u : 2u + uint32_t(rng.Uniform(0.0f, 8.0f));
+        auto time = rng.Uniform(0.0f, 0.5f);
+        for (uint32_t k = 0; k < keys; ++k)
+        {
+            times.push_back(time);
+            rotations.push_back(rng.Rotation());
+            translations.push_back(rng.Vec3());
+            time += rng.Uniform(0.05f, 0.5f);
+        }
+    }
+    offsets[trackCount] = uint32_t(times.size());
+
+    D3DXANIMTRACKS tracks = {};
+    tracks.TrackCount    = trackCount;
+    tracks.pKeyOffsets   = offsets.data();
+    tracks.pTimes        = times.data();
+    tracks.pRotations    = rotations.data();
+    tracks.pTranslations = translations.data();
+
+    // 制御点は区間ごとに D3DXQuaternionSquadSetup を呼んだ結果と一致する.
+    std::vector<D3DXQUATERNION> controls(times.size() * 3);
+    D3DXAnimTracksSquadSetup(controls.data(), &tracks);
+
+    bool matched = true;
+    for (uint32_t i = 0; i < trackCount; ++i)
+    {
+        for (auto k = offsets[i]; k + 1 < offsets[i + 1]; ++k)
+        {
+            const auto prev = (k > offsets[i]) ? k - 1 : k;
+            const auto post = (k + 2 < offsets[i + 1]) ? k + 2 : k + 1;
+            D3DXQUATERNION abc[3];
+            D3DXQuaternionSquadSetup(&abc[0], &abc[1], &abc[2], &rotations[prev], &rotations[k], &rotations[k + 1], &rotations[post]);
+            matched &= (memcmp(abc, &controls[k * 3], sizeof(abc)) == 0);
+        }
+    }
+    ctx.Expect(matched, "D3DXAnimTracksSquadSetup");
+
+    std::vector<D3DXQUATERNION> slerp(trackCount), squad(trackCount);
+    std::vector<D3DXVECTOR3>    position(trackCount);
+    for (size_t n = 0; n < kCount / 4; ++n)
+    {
+        const auto time = rng.Uniform(-0.5f, 5.0f);
+
+        tracks.pControls = nullptr;
+        D3DXAnimTracksSample(slerp.data(), position.data(), &tracks, time);
+        tracks.pControls = controls.data();
+        D3DXAnimTracksSample(squad.data(), nullptr, &tracks, time);
+
+        for (uint32_t i = 0; i < trackCount; ++i)
+        {
+            uint32_t key, next;
+            double   s;
+            RefFindKey(times, offsets[i], offsets[i + 1], time, key, next, s);
+
+            const auto q0 = RefVec(rotations[key]);
+            const auto p0 = RefVec(translations[key]);
+            const auto p1 = RefVec(translations[next]);
+            CheckVector(ctx, &slerp[i].x, RefQuaternionSlerp(q0, RefVec(rotations[next]), s), 4, 1.0);
+            CheckVector(ctx, &position[i].x, p0 + (p1 - p0) * s, 3, MaxAbs(p0) + MaxAbs(p1));
+
+            if (key == next)
+            {
+                CheckRotation(ctx, squad[i], q0);
+                continue;
+            }
+
+            const auto a = RefVec(controls[key * 3 + 0]);
+            const auto b = RefVec(controls[key * 3 + 1]);
+            const auto c = RefVec(controls[key * 3 + 2]);
+            CheckRotation(ctx, squad[i], RefQuaternionSlerp(RefQuaternionSlerp(q0, c, s), RefQuaternionSlerp(a, b, s), 2.0 * s * (1.0 - s)));
+        }
+    }
+
+    // 並列版は1インスタンスずつ同じ処理を行う.
+    const auto instances = D3DX_PARALLEL_THRESHOLD / 8 + 3;
+    std::vector<float>          instanceTimes(instances);
+    std::vector<D3DXQUATERNION> parallel(instances * trackCount);
+    std::vector<D3DXVECTOR3>    parallelPosition(instances * trackCount);
+    for (auto& t : instanceTimes)
+    { t = rng.Uniform(-0.5f, 5.0f); }
+
+    ctx.Measure(instances * trackCount, [&]()
+    { D3DXAnimTracksSampleParallel(parallel.data(), parallelPosition.data(), &tracks, instanceTimes.data(), uint32_t(instances)); });
+
+    matched = true;
+    for (size_t i = 0; i < instances; ++i)
+    {
+        D3DXAnimTracksSample(squad.data(), position.data(), &tracks, instanceTimes[i]);
+        matched &= (memcmp(squad.data(), &parallel[i * trackCount], trackCount * sizeof(D3DXQUATERNION)) == 0);
+        matched &= (memcmp(position.data(), &parallelPosition[i * trackCount], trackCount * sizeof(D3DXVECTOR3)) == 0);
+    }
+    ctx.Expect(matched, "D3DXAnimTracksSampleParallel");
+}
+TEST_CASE(Test_D3DXAnimTracks, 128.0);
+
+void Test_D3DXQuaternion48(TestContext& ctx)
+{
+    // 保存する3成分の誤差は量子化の刻み 2 * 0.7071 / 32767 の半分 (2.2e-5) 以下.
+    // 落とした成分 sqrt(1 - Σc^2) は 1/2 以上なので, その誤差は 3 * 0.7071 * 2.2e-5 / 0.5 (9.2e-5) 以下.
+    const float kBound = 1.0e-4f;
+
+    Random rng;
+    std::vector<D3DXQUATERNION> src;
+
+    // 落とす成分の位置ごとに, 正と負の場合.
+    for (uint32_t index = 0; index < 4; ++index)
+    {
+        for (auto sign : { 1.0f, -1.0f })
+        {
+            for (auto i = 0; i < 16; ++i)
+            {
+                float c[4];
+                float sum = 0.0f;
+                for (uint32_t k = 0; k < 4; ++k)
+                {
+                    c[k] = (k == index) ? 0.0f : rng.Uniform(-0.45f, 0.45f);
+                    sum += c[k] * c[k];
+                }
+                c[index] = sign * sqrtf(1.0f - sum);
+                src.push_back(D3DXQUATERNION(c[0], c[1], c[2], c[3]));
+            }
+        }
+    }
+
+    // 絶対値の等しい成分があれば先頭の成分を落とす.
+    const float h = 0.5f;
+    const float r = 0.70710678f;
+    src.push_back(D3DXQUATERNION( h,  h,  h,  h));
+    src.push_back(D3DXQUATERNION(-h,  h, -h,  h));
+    src.push_back(D3DXQUATERNION( h, -h, -h, -h));
+    src.push_back(D3DXQUATERNION(0.0f,  r, -r, 0.0f));
+    src.push_back(D3DXQUATERNION(0.0f, -r,  r, 0.0f));
+    src.push_back(D3DXQUATERNION(0.0f, 0.0f, -r, -r));
+    src.push_back(D3DXQUATERNION(0.0f, 0.0f, 0.0f, -1.0f));
+
+    // SIMD の端数を含む任意の回転.
+    for (size_t i = 0; i < kArrayCount + 3; ++i)
+    { src.push_back(rng.Rotation()); }
+
+    const auto n = src.size();
+    std::vector<D3DXQUATERNION_48> packed(n);
+    std::vector<D3DXQUATERNION>    back(n);
+    D3DXQuaternion32To48Array(packed.data(), src.data(), uint32_t(n));
+    D3DXQuaternion48To32Array(back.data(), packed.data(), uint32_t(n));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float c[4] = { src[i].x, src[i].y, src[i].z, src[i].w };
+
+        uint32_t index = 0;
+        for (uint32_t k = 1; k < 4; ++k)
+        {
+            if (fabsf(c[k]) > fabsf(c[index]))
+            { index = k; }
+        }
+
+        const auto& key = packed[i];
+        ctx.Expect(((key.v[0] & 0x1) | ((key.v[1] & 0x1) << 1)) == index, "D3DXQuaternion32To48Array index");
+
+        // 落とした成分が正になるように q と -q を選ぶ.
+        const float sign = (c[index] < 0.0f) ? -1.0f : 1.0f;
+        const float d[4] = { back[i].x, back[i].y, back[i].z, back[i].w };
+        for (uint32_t k = 0; k < 4; ++k)
+        { ctx.Expect(fabsf(d[k] - sign * c[k]) <= kBound, "D3DXQuaternion48To32Array"); }
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXQuaternion32To48Array(packed.data(), src.data(), uint32_t(n)); });
+}
+TEST_CASE(Test_D3DXQuaternion48, 0.0);
+
+void Test_D3DXCompressedAnimTracks(TestContext& ctx)
+{
+    Random rng;
+
+    const uint32_t trackCount = 37;
+    std::vector<uint32_t>       offsets(trackCount + 1);
+    std::vector<float>          times;
+    std::vector<D3DXQUATERNION> rotations;
+    std::vector<D3DXVECTOR3>    translations;
+    for (uint32_t i = 0; i < trackCount; ++i)
+    {
+        offsets[i] = uint32_t(times.size());
+        const auto keys   = (i % 7 == 3) ? 1u : 2u + uint32_t(rng.Uniform(0.0f, 8.0f));
+        const auto center = rng.Vec3(100.0f);
+        auto time = rng.Uniform(0.0f, 0.5f);
+        for (uint32_t k = 0; k < keys; ++k)
+        {
+            times.push_back(time);
+            rotations.push_back(rng.Rotation());
+            translations.push_back(center + rng.Vec3(1.0f));
+            time += rng.Uniform(0.05f, 0.5f);
+        }
+    }
+    offsets[trackCount] = uint32_t(times.size());
+
+    D3DXANIMTRACKS tracks = {};
+    tracks.TrackCount    = trackCount;
+    tracks.pKeyOffsets   = offsets.data();
+    tracks.pTimes        = times.data();
+    tracks.pRotations    = rotations.data();
+    tracks.pTranslations = translations.data();
+
+    const auto keyCount = times.size();
+    std::vector<D3DXQUATERNION_48> packed(keyCount);
+    std::vector<D3DXVECTOR3_16F>   packedTranslations(keyCount);
+    std::vector<D3DXVECTOR3>       origins(trackCount);
+    D3DXAnimTracksCompress(packed.data(), packedTranslations.data(), origins.data(), &tracks);
+
+    D3DXCOMPRESSEDANIMTRACKS compressed = {};
+    compressed.TrackCount    = trackCount;
+    compressed.pKeyOffsets   = offsets.data();
+    compressed.pTimes        = times.data();
+    compressed.pRotations    = packed.data();
+    compressed.pTranslations = packedTranslations.data();
+    compressed.pOrigins      = origins.data();
+
+    // 15ビットの量子化誤差は 2^-16 程度で, 落とした成分の誤差はその数倍になる.
+    std::vector<D3DXQUATERNION> decoded(keyCount);
+    D3DXQuaternion48To32Array(decoded.data(), packed.data(), uint32_t(keyCount));
+
+    std::vector<D3DXVECTOR3> decodedTranslations(keyCount);
+    bool precise = true;
+    for (uint32_t i = 0; i < trackCount; ++i)
+    {
+        for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+            CheckRotation(ctx, decoded[k], RefVec(rotations[k]));
+
+            // 半精度の相対誤差は 2^-11 以下.
+            D3DXVECTOR3 offset(packedTranslations[k]);
+            decodedTranslations[k] = origins[i] + offset;
+            const auto expected = translations[k] - origins[i];
+            for (int c = 0; c < 3; ++c)
+            { precise &= std::fabs(double(offset[c]) - expected[c]) <= std::fabs(expected[c]) * (1.0 / 2048.0); }
+        }
+    }
+    ctx.Expect(precise, "D3DXAnimTracksCompress translation");
+
+    // 展開したキーで D3DXAnimTracksSample を呼んだ結果と一致する.
+    D3DXANIMTRACKS expanded = tracks;
+    expanded.pRotations    = decoded.data();
+    expanded.pTranslations = decodedTranslations.data();
+
+    std::vector<D3DXQUATERNION> rotation(trackCount), expected(trackCount);
+    std::vector<D3DXVECTOR3>    translation(trackCount), expectedTranslation(trackCount);
+    bool matched = true;
+    for (size_t n = 0; n < kCount / 4; ++n)
+    {
+        const auto time = rng.Uniform(-0.5f, 5.0f);
+        D3DXCompressedAnimTracksSample(rotation.data(), translation.data(), &compressed, time);
+        D3DXAnimTracksSample(expected.data(), expectedTranslation.data(), &expanded, time);
+        matched &= (memcmp(rotation.data(), expected.data(), trackCount * sizeof(D3DXQUATERNION)) == 0);
+        matched &= (memcmp(translation.data(), expectedTranslation.data(), trackCount * sizeof(D3DXVECTOR3)) == 0);
+    }
+    ctx.Expect(matched, "D3DXCompressedAnimTracksSample");
+
+    const auto instances = D3DX_PARALLEL_THRESHOLD / 8 + 3;
+    std::vector<float>          instanceTimes(instances);
+    std::vector<D3DXQUATERNION> parallel(instances * trackCount);
+    std::vector<D3DXVECTOR3>    parallelTranslation(instances * trackCount);
+    for (auto& t : instanceTimes)
+    { t = rng.Uniform(-0.5f, 5.0f); }
+
+    ctx.Measure(instances * trackCount, [&]()
+    { D3DXCompressedAnimTracksSampleParallel(parallel.data(), parallelTranslation.data(), &compressed, instanceTimes.data(), uint32_t(instances)); });
+
+    matched = true;
+    for (size_t i = 0; i < instances; ++i)
+    {
+        D3DXCompressedAnimTracksSample(rotation.data(), translation.data(), &compressed, instanceTimes[i]);
+        matched &= (memcmp(rotation.data(), &parallel[i * trackCount], trackCount * sizeof(D3DXQUATERNION)) == 0);
+        matched &= (memcmp(translation.data(), &parallelTranslation[i * trackCount], trackCount * sizeof(D3DXVECTOR3)) == 0);
+    }
+    ctx.Expect(matched, "D3DXCompressedAnimTracksSampleParallel");
+}
+TEST_CASE(Test_D3DXCompressedAnimTracks, 1024.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Dual quaternions
+///////////////////////////////////////////////////////////////////////////////
+
+struct RefDualQuaternion
+{
+    RefVector   Real;
+    RefVector   Dual;
+};
+
+RefDualQuaternion RefDQ(const D3DXDUALQUATERNION& dq)
+{ return { RefVec(dq.Real), RefVec(dq.Dual) }; }
+
+// 回転 q の後に平行移動 t を行う双対四元数. Dual = 0.5 * t * q.
+RefDualQuaternion RefDualQuaternionRigid(const RefVector& q, const RefVector& t)
+{ return { q, RefQuaternionMultiply(q, RefVector{ t[0], t[1], t[2], 0.0 }) * 0.5 }; }
+
+// D3DXDualQuaternionMultiply と同じく a の後に b を適用する.
+RefDualQuaternion RefDualQuaternionMultiply(const RefDualQuaternion& a, const RefDualQuaternion& b)
+{ return { RefQuaternionMultiply(a.Real, b.Real), RefQuaternionMultiply(a.Dual, b.Real) + RefQuaternionMultiply(a.Real, b.Dual) }; }
+
+// 2 * Dual * Real^-1 の xyz 成分.
+RefVector RefDualQuaternionTranslation(const RefDualQuaternion& dq)
+{
+    auto t = RefQuaternionMultiply(RefQuaternionInverse(dq.Real), dq.Dual) * 2.0;
+    return { t[0], t[1], t[2], 0.0 };
+}
+
+RefMatrix RefDualQuaternionMatrix(const RefDualQuaternion& dq)
+{
+    auto t = RefDualQuaternionTranslation(dq);
+    return RefRotationQuaternion(dq.Real) * RefTranslation(t[0], t[1], t[2]);
+}
+
+// 双対四元数を回転と平行移動に分けて比較する.
+void CheckDualQuaternion(TestContext& ctx, const D3DXDUALQUATERNION& value, const RefDualQuaternion& expected)
+{
+    CheckRotation(ctx, value.Real, expected.Real);
+
+    auto t = RefDualQuaternionTranslation(expected);
+    CheckVector(ctx, &value.Dual.x, (RefDot4(RefVec(value.Real), expected.Real) < 0.0) ? expected.Dual * -1.0 : expected.Dual, 4, MaxAbs(t));
+}
+
+// 行列の回転と平行移動から ScLERP の参照値を求める.
+// M1^-1 を掛けた相対変換をねじ運動 (軸周りの回転と軸方向の移動) として t 倍する.
+RefDualQuaternion RefDualQuaternionScLerp(const RefDualQuaternion& dq1, RefDualQuaternion dq2, double t)
+{
+    if (RefDot4(dq1.Real, dq2.Real) < 0.0)
+    {
+        dq2.Real = dq2.Real * -1.0;
+        dq2.Dual = dq2.Dual * -1.0;
+    }
+
+    const auto m1   = RefDualQuaternionMatrix(dq1);
+    const auto diff = RefDualQuaternionMatrix(dq2) * RefInverse(m1, nullptr);
+    const auto q    = RefQuaternionFromMatrix(diff);
+    const auto r    = (q[3] < 0.0) ? q * -1.0 : q;
+    const RefVector td = { diff.m[3][0], diff.m[3][1], diff.m[3][2], 0.0 };
+
+    const double sinHalf = std::sqrt(RefDot3(r, r));
+    RefMatrix power;
+    if (sinHalf < 1e-12)
+    { power = RefTranslation(td[0] * t, td[1] * t, td[2] * t); }
+    else
+    {
+        // 軸上の点 c は (I - R) c = td の軸に垂直な成分を解いて求める.
+        const auto angle = 2.0 * std::atan2(sinHalf, r[3]);
+        const auto l     = RefVector{ r[0], r[1], r[2], 0.0 } * (1.0 / sinHalf);
+        const auto d     = RefDot3(td, l);
+        const auto perp  = td - l * d;
+        const auto c     = (perp + RefCross3(l, perp) * (1.0 / std::tan(angle * 0.5))) * 0.5;
+        const auto rot   = RefRotationQuaternion(RefQuaternionAxis(l, angle * t));
+        const auto tc    = c - RefTransform(c, rot) + l * (d * t);
+        power = rot * RefTranslation(tc[0], tc[1], tc[2]);
+    }
+
+    const auto m = power * m1;
+    auto real = RefQuaternionFromMatrix(m);
+    if (RefDot4(real, dq1.Real) < 0.0)
+    { real = real * -1.0; }
+    return RefDualQuaternionRigid(real, { m.m[3][0], m.m[3][1], m.m[3][2], 0.0 });
+}
+
+void Test_D3DXDualQuaternionBasic(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        const auto q1 = rng.Rotation();
+        const auto q2 = rng.Rotation();
+        const auto t1 = rng.Vec3();
+        const auto t2 = rng.Vec3();
+        const auto e1 = RefDualQuaternionRigid(RefVec(q1), RefVec(t1));
+        const auto e2 = RefDualQuaternionRigid(RefVec(q2), RefVec(t2));
+
+        D3DXDUALQUATERNION dq1, dq2, dq;
+        D3DXDualQuaternionRotationTranslation(&dq1, &q1, &t1);
+        D3DXDualQuaternionRotationTranslation(&dq2, &q2, &t2);
+        CheckDualQuaternion(ctx, dq1, e1);
+
+        D3DXQUATERNION q;
+        D3DXVECTOR3    t;
+        D3DXDualQuaternionToRotationTranslation(&q, &t, &dq1);
+        CheckRotation(ctx, q, RefVec(q1));
+        CheckVector(ctx, &t.x, RefVec(t1), 3);
+
+        D3DXDualQuaternionMultiply(&dq, &dq1, &dq2);
+        CheckDualQuaternion(ctx, dq, RefDualQuaternionMultiply(e1, e2));
+
+        // 縮尺を含む行列からは縮尺を取り除いて変換する.
+        const auto s = RefScaling(rng.Uniform(0.5f, 2.0f), rng.Uniform(0.5f, 2.0f), rng.Uniform(0.5f, 2.0f));
+        const auto m = ToFloat(s * RefDualQuaternionMatrix(e1));
+        D3DXDualQuaternionFromMatrix(&dq, &m);
+        CheckDualQuaternion(ctx, dq, e1);
+
+        D3DXMATRIX mtx;
+        D3DXMatrixDualQuaternion(&mtx, &dq1);
+        CheckMatrix(ctx, mtx, RefDualQuaternionMatrix(RefDQ(dq1)), 10.0);
+
+        // Real の長さと Dual の Real 方向の成分を崩してから正規化する.
+        auto scaled = dq1;
+        const auto k = rng.Uniform(0.5f, 2.0f);
+        const auto j = rng.Uniform(-1.0f, 1.0f);
+        scaled.Real = dq1.Real * k;
+        scaled.Dual = (dq1.Dual + dq1.Real * j) * k;
+        D3DXDualQuaternionNormalize(&dq, &scaled);
+
+        auto r = RefVec(scaled.Real);
+        auto d = RefVec(scaled.Dual);
+        const auto len = std::sqrt(RefDot4(r, r));
+        r = r * (1.0 / len);
+        d = d * (1.0 / len);
+        d = d - r * RefDot4(r, d);
+        CheckVector(ctx, &dq.Real.x, r, 4);
+        CheckVector(ctx, &dq.Dual.x, d, 4, 10.0);
+    }
+
+    D3DXDUALQUATERNION identity;
+    D3DXDualQuaternionIdentity(&identity);
+    ctx.Expect(identity.Real == D3DXQUATERNION(0.0f, 0.0f, 0.0f, 1.0f) && identity.Dual == D3DXQUATERNION(0.0f, 0.0f, 0.0f, 0.0f), "D3DXDualQuaternionIdentity");
+
+    // 分解できない行列は単位元になる.
+    D3DXMATRIX singular;
+    D3DXMatrixScaling(&singular, 1.0f, 0.0f, 0.0f);
+    D3DXDUALQUATERNION dq;
+    D3DXDualQuaternionFromMatrix(&dq, &singular);
+    ctx.Expect(memcmp(&dq, &identity, sizeof(dq)) == 0, "D3DXDualQuaternionFromMatrix singular");
+}
+TEST_CASE(Test_D3DXDualQuaternionBasic, 16.0);
+
+void Test_D3DXDualQuaternionArray(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kParallelCount;
+    std::vector<D3DXDUALQUATERNION> dq1(n), dq2(n), dst(n), par(n), inPlace(n);
+    std::vector<D3DXMATRIX>         src(n), mtx(n), parMtx(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto q1 = rng.Rotation();
+        const auto q2 = rng.Rotation();
+        const auto t1 = rng.Vec3();
+        const auto t2 = rng.Vec3();
+        D3DXDualQuaternionRotationTranslation(&dq1[i], &q1, &t1);
+        D3DXDualQuaternionRotationTranslation(&dq2[i], &q2, &t2);
+        src[i] = rng.Affine();
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXDualQuaternionMultiplyArray(dst.data(), dq1.data(), dq2.data(), uint32_t(n)); });
+
+    inPlace = dq1;
+    D3DXDualQuaternionMultiplyArray(inPlace.data(), inPlace.data(), dq2.data(), uint32_t(n));
+    ctx.Expect(memcmp(inPlace.data(), dst.data(), n * sizeof(D3DXDUALQUATERNION)) == 0, "D3DXDualQuaternionMultiplyArray in place");
+
+    for (size_t i = 0; i < n; ++i)
+    { CheckDualQuaternion(ctx, dst[i], RefDualQuaternionMultiply(RefDQ(dq1[i]), RefDQ(dq2[i]))); }
+
+    D3DXDualQuaternionNormalizeArray(par.data(), dst.data(), uint32_t(n));
+    for (size_t i = 0; i < n; ++i)
+    {
+        D3DXDUALQUATERNION dq;
+        D3DXDualQuaternionNormalize(&dq, &dst[i]);
+        CheckDualQuaternion(ctx, par[i], RefDQ(dq));
+    }
+
+    // 行列との変換. 配列の端数も同じ結果になる.
+    D3DXDualQuaternionFromMatrixArray(dst.data(), src.data(), uint32_t(n));
+    D3DXDualQuaternionFromMatrixArrayParallel(par.data(), src.data(), uint32_t(n));
+    ctx.Expect(memcmp(par.data(), dst.data(), n * sizeof(D3DXDUALQUATERNION)) == 0, "D3DXDualQuaternionFromMatrixArrayParallel");
+
+    D3DXMatrixDualQuaternionArray(mtx.data(), dst.data(), uint32_t(n));
+    D3DXMatrixDualQuaternionArrayParallel(parMtx.data(), dst.data(), uint32_t(n));
+    ctx.Expect(memcmp(parMtx.data(), mtx.data(), n * sizeof(D3DXMATRIX)) == 0, "D3DXMatrixDualQuaternionArrayParallel");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        D3DXDUALQUATERNION dq;
+        D3DXDualQuaternionFromMatrix(&dq, &src[i]);
+        CheckDualQuaternion(ctx, dst[i], RefDQ(dq));
+        CheckMatrix(ctx, mtx[i], RefDualQuaternionMatrix(RefDQ(dst[i])), 10.0);
+    }
+
+    for (uint32_t count = 1; count < 8; ++count)
+    {
+        D3DXDUALQUATERNION tail[8];
+        D3DXMATRIX         tailMtx[8];
+        D3DXDualQuaternionFromMatrixArray(tail, src.data(), count);
+        D3DXMatrixDualQuaternionArray(tailMtx, dst.data(), count);
+        ctx.Expect(memcmp(tail, dst.data(), count * sizeof(D3DXDUALQUATERNION)) == 0 &&
+                   memcmp(tailMtx, mtx.data(), count * sizeof(D3DXMATRIX)) == 0, "dual quaternion array tail");
+    }
+}
+TEST_CASE(Test_D3DXDualQuaternionArray, 64.0);
+
+void Test_D3DXDualQuaternionScLerp(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kArrayCount;
+    std::vector<D3DXDUALQUATERNION> dq1(n), dq2(n), dst(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto q1 = rng.Rotation();
+        const auto q2 = rng.Rotation();
+        const auto t1 = rng.Vec3();
+        const auto t2 = rng.Vec3();
+        D3DXDualQuaternionRotationTranslation(&dq1[i], &q1, &t1);
+        D3DXDualQuaternionRotationTranslation(&dq2[i], &q2, &t2);
+
+        // 回転が同じで平行移動だけが異なる組も含める.
+        if (i % 13 == 3)
+        { D3DXDualQuaternionRotationTranslation(&dq2[i], &q1, &t2); }
+    }
+
+    for (auto t : { 0.0f, 0.25f, 0.5f, 0.8f, 1.0f })
+    {
+        if (t == 0.5f)
+        {
+            ctx.Measure(n, [&]()
+            { D3DXDualQuaternionScLerpArray(dst.data(), dq1.data(), dq2.data(), t, uint32_t(n)); });
+        }
+        else
+        { D3DXDualQuaternionScLerpArray(dst.data(), dq1.data(), dq2.data(), t, uint32_t(n)); }
+
+        bool matched = true;
+        for (size_t i = 0; i < n; ++i)
+        {
+            D3DXDUALQUATERNION dq;
+            D3DXDualQuaternionScLerp(&dq, &dq1[i], &dq2[i], t);
+            matched &= (memcmp(&dq, &dst[i], sizeof(dq)) == 0);
+
+            CheckDualQuaternion(ctx, dst[i], RefDualQuaternionScLerp(RefDQ(dq1[i]), RefDQ(dq2[i]), t));
+        }
+        ctx.Expect(matched, "D3DXDualQuaternionScLerp");
+    }
+
+    // DLB は重み付きの和を正規化したものになる.
+    for (size_t i = 0; i + 4 <= n; i += 4)
+    {
+        float weights[4];
+        for (auto& w : weights)
+        { w = rng.Uniform(0.1f, 1.0f); }
+
+        D3DXDUALQUATERNION dq;
+        D3DXDualQuaternionBlend(&dq, &dq1[i], weights, 4);
+
+        RefVector r = {}, d = {};
+        for (int k = 0; k < 4; ++k)
+        {
+            auto w = (RefDot4(RefVec(dq1[i].Real), RefVec(dq1[i + k].Real)) < 0.0) ? -weights[k] : double(weights[k]);
+            r = r + RefVec(dq1[i + k].Real) * w;
+            d = d + RefVec(dq1[i + k].Dual) * w;
+        }
+        const auto len = std::sqrt(RefDot4(r, r));
+        r = r * (1.0 / len);
+        d = d * (1.0 / len);
+        d = d - r * RefDot4(r, d);
+        CheckDualQuaternion(ctx, dq, { r, d });
+    }
+}
+TEST_CASE(Test_D3DXDualQuaternionScLerp, 128.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Skinning
+///////////////////////////////////////////////////////////////////////////////
+
+// 頂点バッファ内の配置.
+struct SkinVertex
+{
+    D3DXVECTOR3 Position;
+    D3DXVECTOR3 Normal;
+    float       Weights[4];
+    uint8_t     Indices[4];
+};
+
+D3DXSKINSTREAMS MakeSkinStreams(const std::vector<SkinVertex>& src, std::vector<SkinVertex>& dst, bool normal)
+{
+    D3DXSKINSTREAMS s = {};
+    s.VertexCount       = uint32_t(src.size());
+    s.InfluenceCount    = 4;
+    s.pPosition         = &src[0].Position;
+    s.PositionStride    = sizeof(SkinVertex);
+    s.pNormal           = normal ? &src[0].Normal : nullptr;
+    s.NormalStride      = sizeof(SkinVertex);
+    s.pIndices          = src[0].Indices;
+    s.IndicesStride     = sizeof(SkinVertex);
+    s.pWeights          = src[0].Weights;
+    s.WeightsStride     = sizeof(SkinVertex);
+    s.pPositionOut      = &dst[0].Position;
+    s.PositionOutStride = sizeof(SkinVertex);
+    s.pNormalOut        = normal ? &dst[0].Normal : nullptr;
+    s.NormalOutStride   = sizeof(SkinVertex);
+    return s;
+}
+
+void Test_D3DXSkinVertices(TestContext& ctx)
+{
+    Random rng;
+    const size_t boneCount = 32;
+    const auto   n         = kParallelCount;
+
+    std::vector<D3DXMATRIX> bones(boneCount);
+    std::vector<RefVector>  real(boneCount), dual(boneCount);
+    for (size_t b = 0; b < boneCount; ++b)
+    {
+        auto q = rng.Rotation();
+        auto t = rng.Vec3();
+        bones[b] = ToFloat(RefRotationQuaternion(RefVec(q)) * RefTranslation(t.x, t.y, t.z));
+
+        // 単精度に丸めた行列から双対四元数を求める.
+        real[b] = RefQuaternionFromMatrix(RefMat(bones[b]));
+        dual[b] = RefQuaternionMultiply(real[b], RefVec(&bones[b]._41, 3)) * 0.5;
+    }
+
+    std::vector<SkinVertex> src(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto& v = src[i];
+        v.Position = rng.Vec3();
+        v.Normal   = rng.Direction();
+
+        // 影響する骨の数は1から4.
+        double sum = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            v.Indices[k] = uint8_t(rng.Uniform(0.0f, float(boneCount) - 0.5f));
+            v.Weights[k] = (k <= int(i % 4)) ? rng.Uniform(0.1f, 1.0f) : 0.0f;
+            sum += v.Weights[k];
+        }
+        for (auto& w : v.Weights)
+        { w = float(w / sum); }
+    }
+
+    for (auto method : { D3DXSKIN_LINEAR, D3DXSKIN_DUALQUATERNION })
+    {
+        auto dst = src, par = src, inPlace = src;
+        auto streams = MakeSkinStreams(src, dst, true);
+
+        if (method == D3DXSKIN_LINEAR)
+        {
+            ctx.Measure(n, [&]()
+            { D3DXSkinVertices(&streams, bones.data(), uint32_t(boneCount), method); });
+        }
+        else
+        { D3DXSkinVertices(&streams, bones.data(), uint32_t(boneCount), method); }
+
+        auto parStreams = MakeSkinStreams(src, par, true);
+        D3DXSkinVerticesParallel(&parStreams, bones.data(), uint32_t(boneCount), method);
+        ctx.Expect(memcmp(par.data(), dst.data(), n * sizeof(SkinVertex)) == 0, "D3DXSkinVerticesParallel");
+
+        auto inPlaceStreams = MakeSkinStreams(inPlace, inPlace, true);
+        D3DXSkinVertices(&inPlaceStreams, bones.data(), uint32_t(boneCount), method);
+        ctx.Expect(memcmp(inPlace.data(), dst.data(), n * sizeof(SkinVertex)) == 0, "D3DXSkinVertices in place");
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto& v = src[i];
+            const auto  p = RefVec(v.Position, 1.0);
+            const auto  m = RefVec(v.Normal);
+
+            RefVector position = {}, normal = {};
+            if (method == D3DXSKIN_LINEAR)
+            {
+                RefMatrix blend = {};
+                for (int k = 0; k < 4; ++k)
+                {
+                    auto bone = RefMat(bones[v.Indices[k]]);
+                    position = position + RefTransform(p, bone) * v.Weights[k];
+                    for (int r = 0; r < 4; ++r)
+                    {
+                        for (int c = 0; c < 4; ++c)
+                        { blend.m[r][c] += bone.m[r][c] * v.Weights[k]; }
+                    }
+                }
+
+                // 法線は合成した行列の逆転置行列で変換する.
+                normal = RefTransform(m, RefTranspose(RefInverse(blend, nullptr)));
+            }
+            else
+            {
+                RefVector r = {}, d = {};
+                const auto& pivot = real[v.Indices[0]];
+                for (int k = 0; k < 4; ++k)
+                {
+                    auto w = (RefDot4(pivot, real[v.Indices[k]]) < 0.0) ? -v.Weights[k] : double(v.Weights[k]);
+                    r = r + real[v.Indices[k]] * w;
+                    d = d + dual[v.Indices[k]] * w;
+                }
+                const auto len = std::sqrt(RefDot4(r, r));
+                r = r * (1.0 / len);
+                d = d * (1.0 / len);
+
+                auto rot   = RefRotationQuaternion(r);
+                auto t     = RefQuaternionMultiply(RefQuaternionInverse(r), d) * 2.0;
+                position = RefTransform(RefVec(v.Position), rot) + RefVector{ t[0], t[1], t[2], 0.0 };
+                normal   = RefTransform(m, rot);
+            }
+
+            CheckVector(ctx, &dst[i].Position.x, position, 3, 20.0);
+            CheckVector(ctx, &dst[i].Normal.x, RefNormalize3(normal), 3, 1.0);
+        }
+
+        // 双対四元数の骨を直接渡しても同じ結果になる.
+        if (method == D3DXSKIN_DUALQUATERNION)
+        {
+            std::vector<D3DXDUALQUATERNION> dqBones(boneCount);
+            D3DXDualQuaternionFromMatrixArray(dqBones.data(), bones.data(), uint32_t(boneCount));
+
+            auto dq = src, dqPar = src;
+            auto dqStreams    = MakeSkinStreams(src, dq, true);
+            auto dqParStreams = MakeSkinStreams(src, dqPar, true);
+            D3DXSkinVerticesDualQuaternion(&dqStreams, dqBones.data(), uint32_t(boneCount));
+            D3DXSkinVerticesDualQuaternionParallel(&dqParStreams, dqBones.data(), uint32_t(boneCount));
+            ctx.Expect(memcmp(dq.data(), dst.data(), n * sizeof(SkinVertex)) == 0, "D3DXSkinVerticesDualQuaternion");
+            ctx.Expect(memcmp(dqPar.data(), dst.data(), n * sizeof(SkinVertex)) == 0, "D3DXSkinVerticesDualQuaternionParallel");
+        }
+    }
+
+    // 法線を省略した場合は位置だけを書き込む.
+    auto dst = src;
+    auto streams = MakeSkinStreams(src, dst, false);
+    D3DXSkinVertices(&streams, bones.data(), uint32_t(boneCount), D3DXSKIN_LINEAR);
+
+    bool untouched = true;
+    for (size_t i = 0; i < n; ++i)
+    { untouched &= (memcmp(&dst[i].Normal, &src[i].Normal, sizeof(D3DXVECTOR3)) == 0); }
+    ctx.Expect(untouched, "D3DXSkinVertices without normals");
+
+    streams.InfluenceCount = 0;
+    ctx.Expect(D3DXSkinVertices(&streams, bones.data(), uint32_t(boneCount), D3DXSKIN_LINEAR) == nullptr, "invalid influence count accepted");
+}
+TEST_CASE(Test_D3DXSkinVertices, 64.0);
+
+// 拡大縮小を含む骨では, 法線が変換後の面に垂直なままになる.
+void Test_D3DXSkinVerticesScaled(TestContext& ctx)
+{
+    Random rng;
+    const size_t boneCount = 9;
+    const auto   n         = kArrayCount + 3;
+
+    // 最後の骨は鏡映を含む.
+    std::vector<D3DXMATRIX> bones(boneCount);
+    std::vector<RefMatrix>  refBones(boneCount);
+    for (size_t b = 0; b < boneCount; ++b)
+    {
+        auto q = rng.Rotation();
+        auto t = rng.Vec3();
+        auto s = (b + 1 < boneCount) ? RefScaling(rng.Uniform(0.25f, 4.0f), rng.Uniform(0.25f, 4.0f), rng.Uniform(0.25f, 4.0f)) : RefScaling(-1.0, 2.0, 0.5);
+        bones[b]    = ToFloat(s * RefRotationQuaternion(RefVec(q)) * RefTranslation(t.x, t.y, t.z));
+        refBones[b] = RefMat(bones[b]);
+    }
+
+    std::vector<SkinVertex> src(n);
+    std::vector<RefVector>  tangents(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto& v = src[i];
+        v.Position = rng.Vec3();
+        v.Normal   = rng.Direction();
+
+        // 鏡映の骨は単独で使い, 他は1から4本の拡大縮小を含む骨を混ぜる.
+        const auto count = (i % 5 == 4) ? 1 : int(i % 4) + 1;
+        double sum = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            v.Indices[k] = (i % 5 == 4) ? uint8_t(boneCount - 1) : uint8_t(rng.Uniform(0.0f, float(boneCount) - 1.5f));
+            v.Weights[k] = (k < count) ? rng.Uniform(0.1f, 1.0f) : 0.0f;
+            sum += v.Weights[k];
+        }
+        for (auto& w : v.Weights)
+        { w = float(w / sum); }
+
+        // 法線に垂直な接線.
+        const auto axis = RefVec(rng.Direction());
+        const auto nrm  = RefVec(v.Normal);
+        tangents[i] = axis - nrm * RefDot3(axis, nrm);
+    }
+
+    auto dst = src;
+    auto streams = MakeSkinStreams(src, dst, true);
+    ctx.Expect(D3DXSkinVertices(&streams, bones.data(), uint32_t(boneCount), D3DXSKIN_LINEAR) != nullptr, "D3DXSkinVertices");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto& v = src[i];
+
+        RefMatrix blend = {};
+        for (int k = 0; k < 4; ++k)
+        {
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                { blend.m[r][c] += refBones[v.Indices[k]].m[r][c] * v.Weights[k]; }
+            }
+        }
+
+        const auto expected = RefNormalize3(RefTransform(RefVec(v.Normal), RefTranspose(RefInverse(blend, nullptr))));
+        CheckVector(ctx, &dst[i].Normal.x, expected, 3, 1.0);
+
+        // 変換した接線との内積は 0 になる.
+        const auto tangent = RefNormalize3(RefTransform(tangents[i], blend));
+        ctx.Expect(std::fabs(RefDot3(RefVec(dst[i].Normal), tangent)) < 1e-5, "skinned normal is not perpendicular to the surface");
+    }
+}
+TEST_CASE(Test_D3DXSkinVerticesScaled, 64.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Plane
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXPlane(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto vp = rng.Vec4();
+        auto plane = D3DXPLANE(&vp.x);
+        auto v1 = rng.Vec3();
+        auto v2 = rng.Vec3();
+        auto v3 = rng.Vec3();
+        auto rp = RefVec(plane);
+        auto r1 = RefVec(v1, 1.0), r2 = RefVec(v2, 1.0), r3 = RefVec(v3, 1.0);
+
+        auto magnitude = MaxAbs(rp) * (MaxAbs(r1) + 1.0) * 4.0;
+        auto v4 = D3DXVECTOR4(v1.x, v1.y, v1.z, 1.0f);
+        ctx.Check(D3DXPlaneDot(&plane, &v4), RefDot4(rp, r1), magnitude);
+        ctx.Check(D3DXPlaneDotCoord(&plane, &v1), RefDot4(rp, r1), magnitude);
+        ctx.Check(D3DXPlaneDotNormal(&plane, &v1), RefDot3(rp, r1), magnitude);
+
+        D3DXPLANE p;
+        CheckVector(ctx, &D3DXPlaneNormalize(&p, &plane)->a, rp * (1.0 / std::sqrt(RefDot3(rp, rp))), 4);
+
+        auto n  = RefNormalize3(RefCross3(r2 - r1, r3 - r1));
+        auto fp = n;
+        fp[3] = -RefDot3(n, r1);
+        CheckVector(ctx, &D3DXPlaneFromPoints(&p, &v1, &v2, &v3)->a, fp, 4, MaxAbs(r1) * 8.0);
+
+        auto normal = rng.Direction();
+        auto rn = RefVec(normal);
+        auto pn = rn;
+        pn[3] = -RefDot3(rn, r1);
+        CheckVector(ctx, &D3DXPlaneFromPointNormal(&p, &v1, &normal)->a, pn, 4, MaxAbs(r1) * 3.0);
+
+        // 線分と平面の交点.
+        D3DXVECTOR3 hit;
+        auto denom = RefDot3(rp, r2 - r1);
+        auto ret   = D3DXPlaneIntersectLine(&hit, &plane, &v1, &v2);
+        if (std::fabs(denom) > 1e-3 * MaxAbs(rp) * MaxAbs(r2 - r1))
+        {
+            auto t = -RefDot4(rp, r1) / denom;
+            ctx.Expect(ret != nullptr, "D3DXPlaneIntersectLine returned NULL");
+            if (ret != nullptr)
+            {
+                // 交点の誤差は平面と線分のなす角に反比例する.
+                auto cond = MaxAbs(rp) * MaxAbs(r2 - r1) / std::fabs(denom);
+                CheckVector(ctx, &hit.x, r1 + (r2 - r1) * t, 3, (MaxAbs(r1) + MaxAbs(r2)) * cond * 4.0);
+            }
+        }
+    }
+}
+TEST_CASE(Test_D3DXPlane, 64.0);
+
+void Test_D3DXPlaneTransform(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXPLANE> src(kArrayCount), dst(kArrayCount), arr(kArrayCount);
+    for (auto& p : src)
+    {
+        auto v = rng.Vec4();
+        p = D3DXPLANE(&v.x);
+    }
+    auto mtx = rng.General();
+    auto m   = RefMat(mtx);
+
+    ctx.Measure(kArrayCount, [&]()
+    {
+        for (size_t i = 0; i < kArrayCount; ++i)
+        { D3DXPlaneTransform(&dst[i], &src[i], &mtx); }
+    });
+
+    D3DXPlaneTransformArray(arr.data(), sizeof(D3DXPLANE), src.data(), sizeof(D3DXPLANE), &mtx, uint32_t(kArrayCount));
+
+    for (size_t i = 0; i < kArrayCount; ++i)
+    {
+        auto p = RefVec(src[i]);
+        CheckVector(ctx, &dst[i].a, RefTransform(p, m), 4, TransformMagnitude(p, m));
+        CheckVector(ctx, &arr[i].a, RefTransform(p, m), 4, TransformMagnitude(p, m));
+    }
+}
+TEST_CASE(Test_D3DXPlaneTransform, 4.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Structure of Arrays
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXSoA(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kArrayCount + 3;
+    std::vector<float> x(n), y(n), z(n), w(n), ox(n), oy(n), oz(n), ow(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        x[i] = rng.Uniform(-10.0f, 10.0f);
+        y[i] = rng.Uniform(-10.0f, 10.0f);
+        z[i] = rng.Uniform(-10.0f, 10.0f);
+        w[i] = rng.Uniform(-10.0f, 10.0f);
+    }
+
+    auto mtx = rng.Projective();
+    auto m   = RefMat(mtx);
+
+    ctx.Measure(n, [&]()
+    { D3DXVec3TransformCoordSoA(ox.data(), oy.data(), oz.data(), x.data(), y.data(), z.data(), &mtx, uint32_t(n)); });
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        RefVector v = { x[i], y[i], z[i], 1.0 };
+        auto t = RefTransform(v, m);
+        float out[3] = { ox[i], oy[i], oz[i] };
+        CheckVector(ctx, out, t * (1.0 / t[3]), 3, TransformMagnitude(v, m) / std::fabs(t[3]));
+    }
+
+    D3DXVec3TransformSoA(ox.data(), oy.data(), oz.data(), ow.data(), x.data(), y.data(), z.data(), &mtx, uint32_t(n));
+    for (size_t i = 0; i < n; ++i)
+    {
+        RefVector v = { x[i], y[i], z[i], 1.0 };
+        float out[4] = { ox[i], oy[i], oz[i], ow[i] };
+        CheckVector(ctx, out, RefTransform(v, m), 4, TransformMagnitude(v, m));
+    }
+
+    D3DXVec3TransformNormalSoA(ox.data(), oy.data(), oz.data(), x.data(), y.data(), z.data(), &mtx, uint32_t(n));
+    for (size_t i = 0; i < n; ++i)
+    {
+        RefVector v = { x[i], y[i], z[i], 0.0 };
+        float out[3] = { ox[i], oy[i], oz[i] };
+        CheckVector(ctx, out, RefTransform(v, m), 3, TransformMagnitude(v, m));
+    }
+
+    D3DXPlaneTransformSoA(ox.data(), oy.data(), oz.data(), ow.data(), x.data(), y.data(), z.data(), w.data(), &mtx, uint32_t(n));
+    for (size_t i = 0; i < n; ++i)
+    {
+        RefVector v = { x[i], y[i], z[i], w[i] };
+        float out[4] = { ox[i], oy[i], oz[i], ow[i] };
+        CheckVector(ctx, out, RefTransform(v, m), 4, TransformMagnitude(v, m));
+    }
+
+    // AoS <-> SoA は値をそのまま並べ替える.
+    std::vector<D3DXVECTOR4> aos(n), back(n);
+    for (size_t i = 0; i < n; ++i)
+    { aos[i] = D3DXVECTOR4(x[i], y[i], z[i], w[i]); }
+
+    D3DXVec4AoSToSoA(ox.data(), oy.data(), oz.data(), ow.data(), aos.data(), sizeof(D3DXVECTOR4), uint32_t(n));
+    D3DXVec4SoAToAoS(back.data(), sizeof(D3DXVECTOR4), ox.data(), oy.data(), oz.data(), ow.data(), uint32_t(n));
+    ctx.Expect(memcmp(ox.data(), x.data(), n * sizeof(float)) == 0 && memcmp(ow.data(), w.data(), n * sizeof(float)) == 0, "D3DXVec4AoSToSoA");
+    ctx.Expect(memcmp(back.data(), aos.data(), n * sizeof(D3DXVECTOR4)) == 0, "D3DXVec4SoAToAoS");
+}
+TEST_CASE(Test_D3DXSoA, 8.0);
+
+// AoS -> SoA -> AoS の往復で値がビット単位で保たれることを調べる.
+// ストライドに余白がある場合と, 4 や 8 の倍数でない要素数を含める.
+template<typename T, typename ToSoA, typename ToAoS>
+void CheckSoARoundTrip(TestContext& ctx, Random& rng, ToSoA toSoA, ToAoS toAoS, const char* soaName, const char* aosName)
+{
+    const size_t   kComponents = sizeof(T) / sizeof(float);
+    const float    kSentinel   = 12345.0f;  // 書き込まれてはいけない位置の値.
+    const size_t   counts[]    = { 1, 3, 7, 13, kArrayCount + 5 };
+    const uint32_t strides[]   = { uint32_t(sizeof(T)), uint32_t(sizeof(T) + 12) };
+
+    for (auto n : counts)
+    {
+        for (auto stride : strides)
+        {
+            const size_t pitch = stride / sizeof(float);
+            std::vector<float> src(n * pitch), dst(n * pitch, kSentinel);
+            for (auto& value : src)
+            { value = rng.Uniform(-100.0f, 100.0f); }
+
+            // 末尾の1要素は書き込まれないことを確認するために使う.
+            std::vector<float> soa[4];
+            float* pSoA[4] = {};
+            for (size_t k = 0; k < kComponents; ++k)
+            {
+                soa[k].assign(n + 1, kSentinel);
+                pSoA[k] = soa[k].data();
+            }
+
+            toSoA(pSoA, reinterpret_cast<const T*>(src.data()), stride, uint32_t(n));
+
+            bool ok = true;
+            for (size_t k = 0; k < kComponents; ++k)
+            {
+                for (size_t i = 0; i < n; ++i)
+                { ok = ok && memcmp(&soa[k][i], &src[i * pitch + k], sizeof(float)) == 0; }
+                ok = ok && soa[k][n] == kSentinel;
+            }
+            ctx.Expect(ok, soaName);
+
+            toAoS(reinterpret_cast<T*>(dst.data()), stride, pSoA, uint32_t(n));
+
+            ok = true;
+            for (size_t i = 0; i < n; ++i)
+            {
+                ok = ok && memcmp(&dst[i * pitch], &src[i * pitch], sizeof(T)) == 0;
+                for (auto j = kComponents; j < pitch; ++j)
+                { ok = ok && dst[i * pitch + j] == kSentinel; }
+            }
+            ctx.Expect(ok, aosName);
+        }
+    }
+}
+
+void Test_D3DXSoAConvert(TestContext& ctx)
+{
+    Random rng;
+
+    CheckSoARoundTrip<D3DXVECTOR3>(ctx, rng,
+        [](float* const* p, const D3DXVECTOR3* pV, uint32_t stride, uint32_t n)
+        { D3DXVec3AoSToSoA(p[0], p[1], p[2], pV, stride, n); },
+        [](D3DXVECTOR3* pOut, uint32_t stride, float* const* p, uint32_t n)
+        { D3DXVec3SoAToAoS(pOut, stride, p[0], p[1], p[2], n); },
+        "D3DXVec3AoSToSoA", "D3DXVec3SoAToAoS");
+
+    CheckSoARoundTrip<D3DXVECTOR4>(ctx, rng,
+        [](float* const* p, const D3DXVECTOR4* pV, uint32_t stride, uint32_t n)
+        { D3DXVec4AoSToSoA(p[0], p[1], p[2], p[3], pV, stride, n); },
+        [](D3DXVECTOR4* pOut, uint32_t stride, float* const* p, uint32_t n)
+        { D3DXVec4SoAToAoS(pOut, stride, p[0], p[1], p[2], p[3], n); },
+        "D3DXVec4AoSToSoA", "D3DXVec4SoAToAoS");
+
+    CheckSoARoundTrip<D3DXPLANE>(ctx, rng,
+        [](float* const* p, const D3DXPLANE* pP, uint32_t stride, uint32_t n)
+        { D3DXPlaneAoSToSoA(p[0], p[1], p[2], p[3], pP, stride, n); },
+        [](D3DXPLANE* pOut, uint32_t stride, float* const* p, uint32_t n)
+        { D3DXPlaneSoAToAoS(pOut, stride, p[0], p[1], p[2], p[3], n); },
+        "D3DXPlaneAoSToSoA", "D3DXPlaneSoAToAoS");
+
+    const size_t n = kArrayCount + 5;
+    std::vector<D3DXVECTOR3> src(n);
+    std::vector<float> x(n), y(n), z(n);
+    for (auto& v : src)
+    { v = rng.Vec3(100.0f); }
+
+    ctx.Measure(n, [&]()
+    { D3DXVec3AoSToSoA(x.data(), y.data(), z.data(), src.data(), sizeof(D3DXVECTOR3), uint32_t(n)); });
+}
+TEST_CASE(Test_D3DXSoAConvert, 0.0);
+
+void Test_D3DXVec3ProjectSoA(TestContext& ctx)
+{
+    // 原点と奥行きの範囲が 0 でないビューポート.
+    ProjectSetup setup;
+    setup.Viewport.MinZ = 0.25f;
+    setup.Viewport.MaxZ = 0.75f;
+
+    Random rng;
+    const size_t n = kArrayCount + 5;
+    std::vector<float> x(n), y(n), z(n), ox(n), oy(n), oz(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto v = rng.Vec3(5.0f);
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+
+    ctx.Measure(n, [&]()
+    {
+        D3DXVec3ProjectSoA(ox.data(), oy.data(), oz.data(), x.data(), y.data(), z.data(),
+            &setup.Viewport, &setup.Proj, &setup.View, &setup.World, uint32_t(n));
+    });
+
+    // 1要素ずつの D3DXVec3Project と比較する. 行列積の丸め誤差はビューポート幅で拡大される.
+    const double magnitude = setup.Viewport.Width;
+    for (size_t i = 0; i < n; ++i)
+    {
+        D3DXVECTOR3 v(x[i], y[i], z[i]), expected;
+        D3DXVec3Project(&expected, &v, &setup.Viewport, &setup.Proj, &setup.View, &setup.World);
+        ctx.Check(ox[i], expected.x, magnitude);
+        ctx.Check(oy[i], expected.y, magnitude);
+        ctx.Check(oz[i], expected.z, 1.0);
+    }
+}
+TEST_CASE(Test_D3DXVec3ProjectSoA, 8.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Frustum culling
+///////////////////////////////////////////////////////////////////////////////
+
+// 平面ごとの距離 d と広がり r から分類する. 境界付近で判定が変わる場合は -1 を返す.
+int RefClassify(const D3DXFRUSTUM& frustum, const RefVector& center, const RefVector& extent, const RefMatrix& axis, double radius)
+{
+    bool outside = false;
+    bool inside  = true;
+    for (const auto& plane : frustum.Planes)
+    {
+        auto p = RefVec(plane);
+        auto d = RefDot4(p, center);
+        auto r = radius;
+        for (int k = 0; k < 3; ++k)
+        { r += extent[k] * std::fabs(p[0] * axis.m[k][0] + p[1] * axis.m[k][1] + p[2] * axis.m[k][2]); }
+
+        const auto eps = 1e-4 * (MaxAbs(center) + r + std::fabs(p[3]) + 1.0);
+        if (std::fabs(d + r) < eps || std::fabs(d - r) < eps)
+            return -1;
+
+        outside |= (d < -r);
+        inside  &= (d >= r);
+    }
+    return inside ? D3DXCULL_INSIDE : (outside ? D3DXCULL_OUTSIDE : D3DXCULL_INTERSECT);
+}
+
+void Test_D3DXFrustum(TestContext& ctx)
+{
+    Random rng;
+
+    D3DXMATRIX view, proj, viewProj;
+    const D3DXVECTOR3 eye(3.0f, 2.0f, -20.0f), at(0.0f, 0.0f, 0.0f), up(0.0f, 1.0f, 0.0f);
+    D3DXMatrixLookAtLH(&view, &eye, &at, &up);
+    D3DXMatrixPerspectiveFovLH(&proj, 1.0f, 16.0f / 9.0f, 0.5f, 40.0f);
+    D3DXMatrixMultiply(&viewProj, &view, &proj);
+
+    // 平面は行列の列の和と差を正規化したものになる.
+    D3DXFRUSTUM frustum;
+    D3DXFrustumFromMatrix(&frustum, &viewProj);
+
+    const auto m = RefTranspose(RefMat(viewProj));
+    const RefVector col[4] = {
+        { m.m[0][0], m.m[0][1], m.m[0][2], m.m[0][3] },
+        { m.m[1][0], m.m[1][1], m.m[1][2], m.m[1][3] },
+        { m.m[2][0], m.m[2][1], m.m[2][2], m.m[2][3] },
+        { m.m[3][0], m.m[3][1], m.m[3][2], m.m[3][3] },
+    };
+    const RefVector planes[6] = {
+        col[3] + col[0], col[3] - col[0], col[3] + col[1], col[3] - col[1], col[2], col[3] - col[2]
+    };
+    for (int p = 0; p < 6; ++p)
+    {
+        auto expected = planes[p] * (1.0 / std::sqrt(RefDot3(planes[p], planes[p])));
+        CheckVector(ctx, &frustum.Planes[p].a, expected, 4, MaxAbs(expected));
+    }
+
+    // 視錐台の周辺に球, AABB, OBB をばらまく.
+    const auto n = kParallelCount;
+    std::vector<float> x(n), y(n), z(n), radius(n), ex(n), ey(n), ez(n), axis(n * 9);
+    std::vector<RefMatrix> rotation(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        x[i] = rng.Uniform(-30.0f, 30.0f);
+        y[i] = rng.Uniform(-20.0f, 20.0f);
+        z[i] = rng.Uniform(-25.0f, 30.0f);
+        radius[i] = rng.Uniform(0.1f, 5.0f);
+        ex[i] = rng.Uniform(0.1f, 5.0f);
+        ey[i] = rng.Uniform(0.1f, 5.0f);
+        ez[i] = rng.Uniform(0.1f, 5.0f);
+
+        D3DXMATRIX r;
+        auto q = rng.Rotation();
+        D3DXMatrixRotationQuaternion(&r, &q);
+        rotation[i] = RefMat(r);
+        for (int k = 0; k < 9; ++k)
+        { axis[k * n + i] = r.m[k / 3][k % 3]; }
+    }
+
+    std::vector<uint8_t> spheres(n), aabbs(n), obbs(n), parallel(n);
+    uint32_t visible[3] = {};
+
+    ctx.Measure(n, [&]()
+    { visible[2] = D3DXFrustumClassifyOBBs(obbs.data(), &frustum, x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(), axis.data(), uint32_t(n)); });
+
+    visible[0] = D3DXFrustumClassifySpheres(spheres.data(), &frustum, x.data(), y.data(), z.data(), radius.data(), uint32_t(n));
+    visible[1] = D3DXFrustumClassifyAABBs(aabbs.data(), &frustum, x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(), uint32_t(n));
+
+    const RefMatrix identity = RefIdentity();
+    const uint8_t*  results[3] = { spheres.data(), aabbs.data(), obbs.data() };
+    uint32_t        counts [3] = {};
+    size_t          tested[3]  = {};
+    bool            matched    = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const RefVector center = { x[i], y[i], z[i], 1.0 };
+        const RefVector extent = { ex[i], ey[i], ez[i], 0.0 };
+        const RefVector zero   = {};
+        const int expected[3] = {
+            RefClassify(frustum, center, zero,   identity,    radius[i]),
+            RefClassify(frustum, center, extent, identity,    0.0),
+            RefClassify(frustum, center, extent, rotation[i], 0.0),
+        };
+
+        for (int s = 0; s < 3; ++s)
+        {
+            counts[s] += (results[s][i] != D3DXCULL_OUTSIDE) ? 1 : 0;
+            if (expected[s] < 0)
+                continue;
+
+            tested[s] += (expected[s] == D3DXCULL_INTERSECT) ? 1 : 0;
+            matched &= (results[s][i] == expected[s]);
+        }
+    }
+    ctx.Expect(matched, "D3DXFrustumClassify mismatch");
+    ctx.Expect(visible[0] == counts[0] && visible[1] == counts[1] && visible[2] == counts[2], "D3DXFrustumClassify visible count");
+    ctx.Expect(tested[0] > 0 && tested[1] > 0 && tested[2] > 0, "D3DXFrustumClassify no intersecting bounds");
+
+    // 並列版は同じカーネルで処理するので結果が一致する.
+    auto count = D3DXFrustumClassifySpheresParallel(parallel.data(), &frustum, x.data(), y.data(), z.data(), radius.data(), uint32_t(n));
+    ctx.Expect(count == visible[0] && parallel == spheres, "D3DXFrustumClassifySpheresParallel");
+
+    count = D3DXFrustumClassifyAABBsParallel(parallel.data(), &frustum, x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(), uint32_t(n));
+    ctx.Expect(count == visible[1] && parallel == aabbs, "D3DXFrustumClassifyAABBsParallel");
+
+    count = D3DXFrustumClassifyOBBsParallel(parallel.data(), &frustum, x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(), axis.data(), uint32_t(n));
+    ctx.Expect(count == visible[2] && parallel == obbs, "D3DXFrustumClassifyOBBsParallel");
+}
+TEST_CASE(Test_D3DXFrustum, 16.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Bounding volumes
+///////////////////////////////////////////////////////////////////////////////
+
+// 頂点バッファ内の配置. 位置の後に他の要素が続く.
+struct BoundsVertex
+{
+    D3DXVECTOR3 Position;
+    float       TexCoord[2];
+};
+
+// 原点から離れた位置にある, 点の集まり. shape が 0 は箱, 1 は球面.
+std::vector<BoundsVertex> MakeBoundsVertices(Random& rng, size_t count, int shape)
+{
+    const D3DXVECTOR3 offset(1000.0f, -500.0f, 250.0f);
+
+    std::vector<BoundsVertex> result(count);
+    for (auto& v : result)
+    {
+        v.Position    = (shape == 0) ? rng.Vec3() : rng.Direction() * 10.0f;
+        v.Position   += offset;
+        v.TexCoord[0] = rng.Uniform(0.0f, 1.0f);
+        v.TexCoord[1] = rng.Uniform(0.0f, 1.0f);
+    }
+    return result;
+}
+
+void Test_D3DXComputeBoundingBox(TestContext& ctx)
+{
+    Random rng;
+    const auto n      = kParallelCount;
+    const auto src    = MakeBoundsVertices(rng, n, 0);
+    const auto stride = uint32_t(sizeof(BoundsVertex));
+
+    D3DXVECTOR3 lower, upper;
+    ctx.Measure(n, [&]()
+    { D3DXComputeBoundingBox(&src[0].Position, uint32_t(n), stride, &lower, &upper); });
+
+    // 最小値と最大値は丸めを含まないので完全に一致する.
+    for (auto count : { size_t(1), size_t(3), size_t(4), size_t(9), n })
+    {
+        auto expectedMin = src[0].Position;
+        auto expectedMax = src[0].Position;
+        for (size_t i = 1; i < count; ++i)
+        {
+            D3DXVec3Minimize(&expectedMin, &expectedMin, &src[i].Position);
+            D3DXVec3Maximize(&expectedMax, &expectedMax, &src[i].Position);
+        }
+
+        D3DXVECTOR3 parMin, parMax;
+        const auto hr    = D3DXComputeBoundingBox(&src[0].Position, uint32_t(count), stride, &lower, &upper);
+        const auto parHr = D3DXComputeBoundingBoxParallel(&src[0].Position, uint32_t(count), stride, &parMin, &parMax);
+        ctx.Expect(hr == 0 && lower == expectedMin && upper == expectedMax, "D3DXComputeBoundingBox");
+        ctx.Expect(parHr == 0 && parMin == expectedMin && parMax == expectedMax, "D3DXComputeBoundingBoxParallel");
+    }
+
+    ctx.Expect(D3DXComputeBoundingBox(&src[0].Position, 0, stride, &lower, &upper) != 0, "empty mesh accepted");
+    ctx.Expect(D3DXComputeBoundingBox(nullptr, uint32_t(n), stride, &lower, &upper) != 0, "null positions accepted");
+}
+TEST_CASE(Test_D3DXComputeBoundingBox, 0.0);
+
+void Test_D3DXComputeCentroid(TestContext& ctx)
+{
+    Random rng;
+    const auto n      = kParallelCount;
+    const auto src    = MakeBoundsVertices(rng, n, 0);
+    const auto stride = uint32_t(sizeof(BoundsVertex));
+
+    D3DXVECTOR3 centroid, parCentroid;
+    ctx.Measure(n, [&]()
+    { D3DXComputeCentroid(&src[0].Position, uint32_t(n), stride, &centroid); });
+
+    D3DXComputeCentroidParallel(&src[0].Position, uint32_t(n), stride, &parCentroid);
+    ctx.Expect(memcmp(&centroid, &parCentroid, sizeof(centroid)) == 0, "D3DXComputeCentroidParallel");
+
+    for (auto count : { size_t(1), size_t(7), n })
+    {
+        RefVector sum = {};
+        for (size_t i = 0; i < count; ++i)
+        { sum = sum + RefVec(src[i].Position); }
+
+        D3DXComputeCentroid(&src[0].Position, uint32_t(count), stride, &centroid);
+        CheckVector(ctx, &centroid.x, sum * (1.0 / double(count)), 3);
+    }
+}
+TEST_CASE(Test_D3DXComputeCentroid, 4.0);
+
+void Test_D3DXComputeBoundingSphere(TestContext& ctx)
+{
+    Random rng;
+    const auto n      = kParallelCount;
+    const auto stride = uint32_t(sizeof(BoundsVertex));
+
+    for (auto shape : { 0, 1 })
+    {
+        const auto src = MakeBoundsVertices(rng, n, shape);
+
+        // 最小の球の半径. 箱は対角線の半分, 球面は 10 に近い.
+        D3DXVECTOR3 lower, upper;
+        D3DXComputeBoundingBox(&src[0].Position, uint32_t(n), stride, &lower, &upper);
+        const auto diagonal = upper - lower;
+        const auto optimal  = (shape == 0) ? double(D3DXVec3Length(&diagonal)) * 0.5 : 10.0;
+
+        for (auto method : { D3DXSPHERE_CENTROID, D3DXSPHERE_RITTER, D3DXSPHERE_EPOS })
+        {
+            D3DXVECTOR3 center, parCenter;
+            float       radius = 0.0f, parRadius = 0.0f;
+            if (shape == 0 && method == D3DXSPHERE_EPOS)
+            {
+                ctx.Measure(n, [&]()
+                { D3DXComputeBoundingSphereEx(&src[0].Position, uint32_t(n), stride, method, &center, &radius); });
+            }
+            else
+            { D3DXComputeBoundingSphereEx(&src[0].Position, uint32_t(n), stride, method, &center, &radius); }
+
+            D3DXComputeBoundingSphereExParallel(&src[0].Position, uint32_t(n), stride, method, &parCenter, &parRadius);
+            ctx.Expect(memcmp(&center, &parCenter, sizeof(center)) == 0 && radius == parRadius, "D3DXComputeBoundingSphereExParallel");
+
+            // 全ての頂点が球に含まれる.
+            double farthest = 0.0;
+            for (const auto& v : src)
+            {
+                const auto d = RefVec(v.Position) - RefVec(center);
+                farthest = std::max(farthest, std::sqrt(RefDot3(d, d)));
+            }
+            ctx.Expect(farthest <= double(radius) * (1.0 + 1e-6), "vertex outside of the bounding sphere");
+
+            if (method == D3DXSPHERE_CENTROID)
+            {
+                D3DXVECTOR3 centroid;
+                D3DXComputeCentroid(&src[0].Position, uint32_t(n), stride, &centroid);
+                ctx.Expect(centroid == center, "D3DXComputeBoundingSphere center");
+                ctx.Check(radius, farthest, farthest);
+
+                D3DXVECTOR3 c;
+                float       r = 0.0f;
+                D3DXComputeBoundingSphere(&src[0].Position, uint32_t(n), stride, &c, &r);
+                ctx.Expect(c == center && r == radius, "D3DXComputeBoundingSphere");
+
+                // 並列版も固定のブロックで集計するので, ビット単位で一致する.
+                D3DXVECTOR3 parC;
+                float       parR = 0.0f;
+                const auto  hr = D3DXComputeBoundingSphereParallel(&src[0].Position, uint32_t(n), stride, &parC, &parR);
+                ctx.Expect(hr == 0 && memcmp(&parC, &c, sizeof(c)) == 0 && memcmp(&parR, &r, sizeof(r)) == 0, "D3DXComputeBoundingSphereParallel");
+            }
+            else if (method == D3DXSPHERE_EPOS)
+            { ctx.Expect(radius <= optimal * 1.05, "EPOS sphere too large"); }
+            else
+            { ctx.Expect(radius <= optimal * 1.2, "Ritter sphere too large"); }
+        }
+    }
+
+    // 1頂点の場合は半径 0 になる.
+    const auto src = MakeBoundsVertices(rng, 1, 0);
+    for (auto method : { D3DXSPHERE_CENTROID, D3DXSPHERE_RITTER, D3DXSPHERE_EPOS })
+    {
+        D3DXVECTOR3 center;
+        float       radius = -1.0f;
+        D3DXComputeBoundingSphereEx(&src[0].Position, 1, stride, method, &center, &radius);
+        ctx.Expect(center == src[0].Position && radius == 0.0f, "single vertex sphere");
+    }
+
+    D3DXVECTOR3 center;
+    float       radius;
+    ctx.Expect(D3DXComputeBoundingSphereEx(&src[0].Position, 1, stride, D3DXSPHEREMETHOD(7), &center, &radius) != 0, "invalid method accepted");
+}
+TEST_CASE(Test_D3DXComputeBoundingSphere, 4.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Ray intersection
+///////////////////////////////////////////////////////////////////////////////
+
+// 倍精度の Möller–Trumbore 法.
+bool RefIntersectTri
+(
+    const RefVector&    p0,
+    const RefVector&    p1,
+    const RefVector&    p2,
+    const RefVector&    pos,
+    const RefVector&    dir,
+    double&             u,
+    double&             v,
+    double&             t
+)
+{
+    const auto e1  = p1 - p0;
+    const auto e2  = p2 - p0;
+    const auto p   = RefCross3(dir, e2);
+    const auto det = RefDot3(e1, p);
+    if (det == 0.0)
+        return false;
+
+    const auto s = pos - p0;
+    const auto q = RefCross3(s, e1);
+    u = RefDot3(s, p) / det;
+    v = RefDot3(dir, q) / det;
+    t = RefDot3(e2, q) / det;
+    return u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0;
+}
+
+// 原点付近に散らばった大きさ2程度の三角形.
+std::vector<D3DXVECTOR3> MakeRayTriangles(Random& rng, size_t count)
+{
+    std::vector<D3DXVECTOR3> result(count * 3);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto center = rng.Vec3(8.0f);
+        for (size_t k = 0; k < 3; ++k)
+        { result[i * 3 + k] = center + rng.Vec3(2.0f); }
+    }
+    return result;
+}
+
+// 半径30の球面上から原点付近に向かう光線.
+void MakeRay(Random& rng, D3DXVECTOR3& pos, D3DXVECTOR3& dir)
+{
+    pos = rng.Direction() * 30.0f;
+    dir = rng.Vec3(8.0f) - pos;
+}
+
+// 面を順番に調べて最も近い交差を求める. 距離が等しい場合は先の面を選ぶ.
+bool NearestIntersectTri(const std::vector<D3DXVECTOR3>& tri, const D3DXVECTOR3& pos, const D3DXVECTOR3& dir, D3DXINTERSECTINFO& hit)
+{
+    bool found = false;
+    for (size_t i = 0; i < tri.size() / 3; ++i)
+    {
+        float u, v, t;
+        if (D3DXIntersectTri(&tri[i * 3 + 0], &tri[i * 3 + 1], &tri[i * 3 + 2], &pos, &dir, &u, &v, &t) && t < hit.Dist)
+        {
+            hit = { uint32_t(i), u, v, t };
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool operator == (const D3DXINTERSECTINFO& a, const D3DXINTERSECTINFO& b)
+{ return a.FaceIndex == b.FaceIndex && a.U == b.U && a.V == b.V && a.Dist == b.Dist; }
+
+void Test_D3DXIntersectTri(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        const auto p0 = rng.Vec3();
+        const auto p1 = rng.Vec3();
+        const auto p2 = rng.Vec3();
+
+        // 三角形の内側の点を狙う光線. 辺の近くは丸めで判定が変わるので避ける.
+        const auto a = rng.Uniform(0.05f, 0.9f);
+        const auto b = rng.Uniform(0.05f, 0.95f - a);
+        D3DXVECTOR3 target, pos;
+        D3DXVec3BaryCentric(&target, &p0, &p1, &p2, a, b);
+        pos = rng.Vec3(30.0f);
+        const auto dir = (target - pos) * rng.Uniform(0.1f, 2.0f);
+
+        double eu = 0.0, ev = 0.0, et = 0.0;
+        if (!RefIntersectTri(RefVec(p0), RefVec(p1), RefVec(p2), RefVec(pos), RefVec(dir), eu, ev, et))
+            continue;
+
+        // 三角形が光線とほぼ平行な場合は誤差が大きいので除く.
+        const auto normal = RefCross3(RefVec(p1) - RefVec(p0), RefVec(p2) - RefVec(p0));
+        const auto cosine = RefDot3(normal, RefVec(dir)) / std::sqrt(RefDot3(normal, normal) * RefDot3(RefVec(dir), RefVec(dir)));
+        if (std::fabs(cosine) < 0.2)
+            continue;
+
+        float u = 0.0f, v = 0.0f, t = 0.0f;
+        ctx.Expect(D3DXIntersectTri(&p0, &p1, &p2, &pos, &dir, &u, &v, &t), "D3DXIntersectTri missed");
+        ctx.Check(u, eu, 1.0);
+        ctx.Check(v, ev, 1.0);
+        ctx.Check(t, et, 1.0);
+
+        // 重心座標の点と光線上の点が一致する. 誤差は光線の始点の大きさに比例する.
+        D3DXVECTOR3 onTri;
+        D3DXVec3BaryCentric(&onTri, &p0, &p1, &p2, u, v);
+        const auto onRay = RefVec(pos) + RefVec(dir) * double(t);
+        CheckVector(ctx, &onTri.x, onRay, 3, 30.0);
+
+        // 逆向きの光線と三角形の外側を狙う光線は交差しない.
+        const auto back = -dir;
+        D3DXVECTOR3 outside;
+        D3DXVec3BaryCentric(&outside, &p0, &p1, &p2, 1.0f - b, b + 0.2f);
+        const auto miss = outside - pos;
+        ctx.Expect(!D3DXIntersectTri(&p0, &p1, &p2, &pos, &back, &u, &v, &t), "D3DXIntersectTri hit behind the ray");
+        ctx.Expect(!D3DXIntersectTri(&p0, &p1, &p2, &pos, &miss, &u, &v, &t), "D3DXIntersectTri hit outside the triangle");
+    }
+
+    // 縮退した三角形には交差しない.
+    const D3DXVECTOR3 p0(0.0f, 0.0f, 0.0f), p1(1.0f, 0.0f, 0.0f), pos(0.5f, 0.0f, -1.0f), dir(0.0f, 0.0f, 1.0f);
+    float u, v, t;
+    ctx.Expect(!D3DXIntersectTri(&p0, &p1, &p1, &pos, &dir, &u, &v, &t), "D3DXIntersectTri hit a degenerate triangle");
+
+    const auto tri = MakeRayTriangles(rng, kCount);
+    std::vector<D3DXVECTOR3> rays(kCount * 2);
+    for (size_t i = 0; i < kCount; ++i)
+    { MakeRay(rng, rays[i * 2], rays[i * 2 + 1]); }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXIntersectTri(&tri[i * 3 + 0], &tri[i * 3 + 1], &tri[i * 3 + 2], &rays[i * 2], &rays[i * 2 + 1], &u, &v, &t); }
+    });
+}
+TEST_CASE(Test_D3DXIntersectTri, 64.0);
+
+void Test_D3DXIntersectTriPackets(TestContext& ctx)
+{
+    Random rng;
+    const size_t triCount = 203;
+    const auto   tri      = MakeRayTriangles(rng, triCount);
+
+    // 面を逆順に並べたインデックス.
+    std::vector<uint32_t> indices(triCount * 3);
+    for (size_t i = 0; i < triCount; ++i)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        { indices[i * 3 + k] = uint32_t((triCount - 1 - i) * 3 + k); }
+    }
+
+    std::vector<D3DXTRIANGLE4> packets4((triCount + 3) / 4);
+    std::vector<D3DXTRIANGLE8> packets8((triCount + 7) / 8);
+    std::vector<D3DXTRIANGLE8> reversed8((triCount + 7) / 8);
+    D3DXTrianglePackets4FromMesh(packets4.data(), tri.data(), sizeof(D3DXVECTOR3), nullptr, uint32_t(triCount));
+    D3DXTrianglePackets8FromMesh(packets8.data(), tri.data(), sizeof(D3DXVECTOR3), nullptr, uint32_t(triCount));
+    D3DXTrianglePackets8FromMesh(reversed8.data(), tri.data(), sizeof(D3DXVECTOR3), indices.data(), uint32_t(triCount));
+
+    size_t hitCount = 0;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        D3DXVECTOR3 pos, dir;
+        MakeRay(rng, pos, dir);
+
+        D3DXINTERSECTINFO expected = { 0, 0.0f, 0.0f, FLT_MAX };
+        const bool found = NearestIntersectTri(tri, pos, dir, expected);
+        hitCount += found ? 1 : 0;
+
+        // スカラー版と同じ演算順なので結果は完全に一致する.
+        D3DXINTERSECTINFO hit4 = { 0, 0.0f, 0.0f, FLT_MAX };
+        D3DXINTERSECTINFO hit8 = { 0, 0.0f, 0.0f, FLT_MAX };
+        D3DXINTERSECTINFO hitR = { 0, 0.0f, 0.0f, FLT_MAX };
+        ctx.Expect(D3DXIntersectTriPackets4(&hit4, packets4.data(), uint32_t(packets4.size()), &pos, &dir) == found, "D3DXIntersectTriPackets4 result");
+        ctx.Expect(D3DXIntersectTriPackets8(&hit8, packets8.data(), uint32_t(packets8.size()), &pos, &dir) == found, "D3DXIntersectTriPackets8 result");
+        D3DXIntersectTriPackets8(&hitR, reversed8.data(), uint32_t(reversed8.size()), &pos, &dir);
+        if (!found)
+            continue;
+
+        ctx.Expect(hit4 == expected, "D3DXIntersectTriPackets4");
+        ctx.Expect(hit8 == expected, "D3DXIntersectTriPackets8");
+        ctx.Expect(hitR.Dist == expected.Dist && hitR.FaceIndex == triCount - 1 - expected.FaceIndex, "D3DXTrianglePackets8FromMesh indices");
+
+        // 既に見つかっている交差より遠いものは採用しない.
+        auto limited = expected;
+        ctx.Expect(!D3DXIntersectTriPackets8(&limited, packets8.data(), uint32_t(packets8.size()), &pos, &dir) && limited == expected, "D3DXIntersectTriPackets8 max distance");
+    }
+    ctx.Expect(hitCount > kCount / 4, "too few hits");
+
+    // 同じ距離の交差は面番号が小さい方を選ぶ.
+    std::vector<D3DXVECTOR3> twins(tri.begin(), tri.begin() + 3);
+    for (size_t i = 0; i < 12; ++i)
+    { twins.insert(twins.end(), tri.begin(), tri.begin() + 3); }
+    std::vector<D3DXTRIANGLE4> twinPackets(4);
+    D3DXTrianglePackets4FromMesh(twinPackets.data(), twins.data(), sizeof(D3DXVECTOR3), nullptr, 13);
+
+    D3DXVECTOR3 target, pos(0.0f, 0.0f, 0.0f);
+    D3DXVec3BaryCentric(&target, &tri[0], &tri[1], &tri[2], 0.25f, 0.25f);
+    const auto dir = target - pos;
+    D3DXINTERSECTINFO twin = { 0, 0.0f, 0.0f, FLT_MAX };
+    ctx.Expect(D3DXIntersectTriPackets4(&twin, twinPackets.data(), 4, &pos, &dir) && twin.FaceIndex == 0, "D3DXIntersectTriPackets4 tie");
+
+    std::vector<D3DXVECTOR3> rays(kCount * 2);
+    for (size_t i = 0; i < kCount; ++i)
+    { MakeRay(rng, rays[i * 2], rays[i * 2 + 1]); }
+
+    ctx.Measure(kCount * triCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        {
+            D3DXINTERSECTINFO hit = { 0, 0.0f, 0.0f, FLT_MAX };
+            D3DXIntersectTriPackets8(&hit, packets8.data(), uint32_t(packets8.size()), &rays[i * 2], &rays[i * 2 + 1]);
+        }
+    });
+}
+TEST_CASE(Test_D3DXIntersectTriPackets, 0.0);
+
+void Test_D3DXIntersectTriRays(TestContext& ctx)
+{
+    Random rng;
+    const size_t triCount = 37;
+    const size_t n        = kArrayCount + 5;
+    const auto   tri      = MakeRayTriangles(rng, triCount);
+
+    std::vector<D3DXVECTOR3> pos(n), dir(n);
+    std::vector<float> px(n), py(n), pz(n), dx(n), dy(n), dz(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        MakeRay(rng, pos[i], dir[i]);
+        px[i] = pos[i].x; py[i] = pos[i].y; pz[i] = pos[i].z;
+        dx[i] = dir[i].x; dy[i] = dir[i].y; dz[i] = dir[i].z;
+    }
+
+    std::vector<D3DXINTERSECTINFO> hits(n);
+    auto intersectAll = [&]()
+    {
+        for (auto& hit : hits)
+        { hit = { 0, 0.0f, 0.0f, FLT_MAX }; }
+
+        uint32_t updated = 0;
+        for (size_t i = 0; i < triCount; ++i)
+        {
+            updated += D3DXIntersectTriRays(hits.data(), &tri[i * 3 + 0], &tri[i * 3 + 1], &tri[i * 3 + 2], uint32_t(i),
+                px.data(), py.data(), pz.data(), dx.data(), dy.data(), dz.data(), uint32_t(n));
+        }
+        return updated;
+    };
+
+    const auto updated = intersectAll();
+
+    // 面を順番に調べた結果と完全に一致する.
+    uint32_t expectedUpdated = 0;
+    size_t   hitCount        = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        D3DXINTERSECTINFO expected = { 0, 0.0f, 0.0f, FLT_MAX };
+        for (size_t f = 0; f < triCount; ++f)
+        {
+            float u, v, t;
+            if (D3DXIntersectTri(&tri[f * 3 + 0], &tri[f * 3 + 1], &tri[f * 3 + 2], &pos[i], &dir[i], &u, &v, &t) && t < expected.Dist)
+            {
+                expected = { uint32_t(f), u, v, t };
+                expectedUpdated++;
+            }
+        }
+        hitCount += (expected.Dist < FLT_MAX) ? 1 : 0;
+        ctx.Expect(hits[i] == expected, "D3DXIntersectTriRays");
+    }
+    ctx.Expect(updated == expectedUpdated, "D3DXIntersectTriRays updated count");
+    ctx.Expect(hitCount > n / 8, "too few hits");
+
+    ctx.Measure(n * triCount, [&]() { intersectAll(); });
+}
+TEST_CASE(Test_D3DXIntersectTriRays, 0.0);
+
+// 面を順番に調べて [0, maxDist) に交差があるかを求める.
+bool AnyIntersectTri(const std::vector<D3DXVECTOR3>& tri, const D3DXVECTOR3& pos, const D3DXVECTOR3& dir, float maxDist)
+{
+    for (size_t i = 0; i < tri.size() / 3; ++i)
+    {
+        float u, v, t;
+        if (D3DXIntersectTri(&tri[i * 3 + 0], &tri[i * 3 + 1], &tri[i * 3 + 2], &pos, &dir, &u, &v, &t) && t < maxDist)
+            return true;
+    }
+    return false;
+}
+
+void Test_D3DXTriangleBVH(TestContext& ctx)
+{
+    Random rng;
+    const size_t triCount = 3001;
+    const auto   tri      = MakeRayTriangles(rng, triCount);
+
+    D3DXTRIANGLEBVH* pBVH = nullptr;
+    ctx.Expect(D3DXCreateTriangleBVH(tri.data(), uint32_t(tri.size()), sizeof(D3DXVECTOR3), nullptr, uint32_t(triCount), &pBVH) == 0, "D3DXCreateTriangleBVH");
+
+    // 面を順番に調べた結果と完全に一致する.
+    std::vector<D3DXVECTOR3>       pos(kCount), dir(kCount);
+    std::vector<D3DXINTERSECTINFO> expected(kCount);
+    size_t hitCount = 0;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        MakeRay(rng, pos[i], dir[i]);
+
+        expected[i] = { 0, 0.0f, 0.0f, FLT_MAX };
+        const bool found = NearestIntersectTri(tri, pos[i], dir[i], expected[i]);
+        hitCount += found ? 1 : 0;
+
+        D3DXINTERSECTINFO hit = { 0, 0.0f, 0.0f, FLT_MAX };
+        ctx.Expect(D3DXTriangleBVHIntersect(&hit, pBVH, &pos[i], &dir[i]) == found, "D3DXTriangleBVHIntersect result");
+        if (!found)
+        {
+            ctx.Expect(!D3DXTriangleBVHOccluded(pBVH, &pos[i], &dir[i], FLT_MAX), "D3DXTriangleBVHOccluded miss");
+            continue;
+        }
+
+        ctx.Expect(hit == expected[i], "D3DXTriangleBVHIntersect");
+
+        // 最も近い交差の距離は含まない.
+        const auto dist = expected[i].Dist;
+        ctx.Expect(!D3DXTriangleBVHOccluded(pBVH, &pos[i], &dir[i], dist), "D3DXTriangleBVHOccluded at the nearest hit");
+        ctx.Expect(D3DXTriangleBVHOccluded(pBVH, &pos[i], &dir[i], nextafterf(dist, FLT_MAX)), "D3DXTriangleBVHOccluded after the nearest hit");
+
+        // 既に見つかっている交差より遠いものは採用しない.
+        auto limited = expected[i];
+        ctx.Expect(!D3DXTriangleBVHIntersect(&limited, pBVH, &pos[i], &dir[i]) && limited == expected[i], "D3DXTriangleBVHIntersect max distance");
+    }
+    ctx.Expect(hitCount > kCount / 4, "too few hits");
+
+    // 配列版.
+    std::vector<float> maxDist(kCount);
+    for (auto& d : maxDist)
+    { d = rng.Uniform(0.0f, 1.0f); }
+
+    std::vector<D3DXINTERSECTINFO> hits(kCount, D3DXINTERSECTINFO{ 0, 0.0f, 0.0f, FLT_MAX });
+    std::vector<uint8_t>           occluded(kCount);
+    ctx.Expect(D3DXTriangleBVHIntersectArray(hits.data(), pBVH, pos.data(), dir.data(), uint32_t(kCount)) == hitCount, "D3DXTriangleBVHIntersectArray count");
+    const auto occludedCount = D3DXTriangleBVHOccludedArray(occluded.data(), pBVH, pos.data(), dir.data(), maxDist.data(), uint32_t(kCount));
+
+    uint32_t expectedOccluded = 0;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        const bool any = AnyIntersectTri(tri, pos[i], dir[i], maxDist[i]);
+        expectedOccluded += any ? 1 : 0;
+        ctx.Expect(hits[i] == expected[i], "D3DXTriangleBVHIntersectArray");
+        ctx.Expect(occluded[i] == (any ? 1 : 0), "D3DXTriangleBVHOccludedArray");
+    }
+    ctx.Expect(occludedCount == expectedOccluded, "D3DXTriangleBVHOccludedArray count");
+
+    // 同じ位置の面は面番号が小さい方を選ぶ. インデックスで面を逆順に参照する.
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 40; ++i)
+    {
+        indices.push_back(2);
+        indices.push_back(1);
+        indices.push_back(0);
+    }
+    D3DXTRIANGLEBVH* pTwins = nullptr;
+    ctx.Expect(D3DXCreateTriangleBVH(tri.data(), 3, sizeof(D3DXVECTOR3), indices.data(), 40, &pTwins) == 0, "D3DXCreateTriangleBVH indices");
+
+    D3DXVECTOR3 target, origin(0.0f, 0.0f, 0.0f);
+    D3DXVec3BaryCentric(&target, &tri[0], &tri[1], &tri[2], 0.25f, 0.25f);
+    const auto toward = target - origin;
+    D3DXINTERSECTINFO twin = { 0, 0.0f, 0.0f, FLT_MAX };
+    ctx.Expect(D3DXTriangleBVHIntersect(&twin, pTwins, &origin, &toward) && twin.FaceIndex == 0, "D3DXTriangleBVHIntersect tie");
+    D3DXDestroyTriangleBVH(pTwins);
+
+    // 不正な引数.
+    D3DXTRIANGLEBVH* pInvalid = nullptr;
+    indices[4] = 3;
+    ctx.Expect(D3DXCreateTriangleBVH(tri.data(), 3, sizeof(D3DXVECTOR3), indices.data(), 40, &pInvalid) != 0, "D3DXCreateTriangleBVH index out of range");
+    ctx.Expect(D3DXCreateTriangleBVH(tri.data(), 3, sizeof(D3DXVECTOR3), nullptr, 2, &pInvalid) != 0, "D3DXCreateTriangleBVH too few vertices");
+    ctx.Expect(D3DXCreateTriangleBVH(tri.data(), 3, sizeof(D3DXVECTOR3), nullptr, 0, &pInvalid) != 0, "D3DXCreateTriangleBVH no triangles");
+    ctx.Expect(pInvalid == nullptr, "D3DXCreateTriangleBVH output on failure");
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (auto& hit : hits)
+        { hit = { 0, 0.0f, 0.0f, FLT_MAX }; }
+        D3DXTriangleBVHIntersectArray(hits.data(), pBVH, pos.data(), dir.data(), uint32_t(kCount));
+    });
+
+    D3DXDestroyTriangleBVH(pBVH);
+}
+TEST_CASE(Test_D3DXTriangleBVH, 0.0);
+
+void Test_D3DXTriangleBVHParallel(TestContext& ctx)
+{
+    // 大きいメッシュでは部分木を並列に構築する. 結果は並列に構築しない場合と一致する.
+    Random rng;
+    const size_t triCount = kParallelCount;
+    const auto   tri      = MakeRayTriangles(rng, triCount);
+
+    D3DXTRIANGLEBVH* pSerial   = nullptr;
+    D3DXTRIANGLEBVH* pParallel = nullptr;
+    ctx.Expect(D3DXCreateTriangleBVH(tri.data(), uint32_t(tri.size()), sizeof(D3DXVECTOR3), nullptr, uint32_t(triCount), &pSerial) == 0, "D3DXCreateTriangleBVH");
+    ctx.Expect(D3DXCreateTriangleBVHParallel(tri.data(), uint32_t(tri.size()), sizeof(D3DXVECTOR3), nullptr, uint32_t(triCount), &pParallel) == 0, "D3DXCreateTriangleBVHParallel");
+
+    const size_t n = kArrayCount + 5;
+    std::vector<D3DXVECTOR3> pos(n), dir(n);
+    std::vector<float>       maxDist(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        MakeRay(rng, pos[i], dir[i]);
+        maxDist[i] = rng.Uniform(0.0f, 1.0f);
+    }
+
+    std::vector<D3DXINTERSECTINFO> serial(n, D3DXINTERSECTINFO{ 0, 0.0f, 0.0f, FLT_MAX });
+    std::vector<D3DXINTERSECTINFO> parallel(n, D3DXINTERSECTINFO{ 0, 0.0f, 0.0f, FLT_MAX });
+    std::vector<uint8_t>           serialOccluded(n), parallelOccluded(n);
+    const auto updated = D3DXTriangleBVHIntersectArray(serial.data(), pSerial, pos.data(), dir.data(), uint32_t(n));
+    ctx.Expect(D3DXTriangleBVHIntersectArrayParallel(parallel.data(), pParallel, pos.data(), dir.data(), uint32_t(n)) == updated, "D3DXTriangleBVHIntersectArrayParallel count");
+    const auto occluded = D3DXTriangleBVHOccludedArray(serialOccluded.data(), pSerial, pos.data(), dir.data(), maxDist.data(), uint32_t(n));
+    ctx.Expect(D3DXTriangleBVHOccludedArrayParallel(parallelOccluded.data(), pParallel, pos.data(), dir.data(), maxDist.data(), uint32_t(n)) == occluded, "D3DXTriangleBVHOccludedArrayParallel count");
+    ctx.Expect(updated > n / 4, "too few hits");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ctx.Expect(serial[i] == parallel[i], "D3DXTriangleBVHIntersectArrayParallel");
+        ctx.Expect(serialOccluded[i] == parallelOccluded[i], "D3DXTriangleBVHOccludedArrayParallel");
+    }
+
+    // 一部の光線は面を順番に調べた結果と比べる.
+    for (size_t i = 0; i < n; i += 97)
+    {
+        D3DXINTERSECTINFO expected = { 0, 0.0f, 0.0f, FLT_MAX };
+        NearestIntersectTri(tri, pos[i], dir[i], expected);
+        ctx.Expect(parallel[i] == expected, "D3DXTriangleBVHIntersectArrayParallel reference");
+        ctx.Expect(parallelOccluded[i] == (AnyIntersectTri(tri, pos[i], dir[i], maxDist[i]) ? 1 : 0), "D3DXTriangleBVHOccludedArrayParallel reference");
+    }
+
+    ctx.Measure(triCount, [&]()
+    {
+        D3DXTRIANGLEBVH* pBVH = nullptr;
+        D3DXCreateTriangleBVHParallel(tri.data(), uint32_t(tri.size()), sizeof(D3DXVECTOR3), nullptr, uint32_t(triCount), &pBVH);
+        D3DXDestroyTriangleBVH(pBVH);
+    });
+
+    D3DXDestroyTriangleBVH(pSerial);
+    D3DXDestroyTriangleBVH(pParallel);
+}
+TEST_CASE(Test_D3DXTriangleBVHParallel, 0.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Color
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXColor(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto c = D3DXCOLOR(rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f));
+        auto s = rng.Uniform(0.0f, 2.0f);
+        auto rc = RefVec(c);
+
+        auto grey = rc[0] * 0.2125 + rc[1] * 0.7154 + rc[2] * 0.0721;
+        RefVector saturation = { grey + s * (rc[0] - grey), grey + s * (rc[1] - grey), grey + s * (rc[2] - grey), rc[3] };
+        RefVector contrast   = { 0.5 + s * (rc[0] - 0.5), 0.5 + s * (rc[1] - 0.5), 0.5 + s * (rc[2] - 0.5), rc[3] };
+
+        D3DXCOLOR ret;
+        CheckVector(ctx, &D3DXColorAdjustSaturation(&ret, &c, s)->r, saturation, 4, 2.0);
+        CheckVector(ctx, &D3DXColorAdjustContrast(&ret, &c, s)->r, contrast, 4, 2.0);
+        CheckVector(ctx, &D3DXColorNegative(&ret, &c)->r, RefVector{ 1.0 - rc[0], 1.0 - rc[1], 1.0 - rc[2], rc[3] }, 4, 1.0);
+    }
+}
+TEST_CASE(Test_D3DXColor, 8.0);
+
+double RefSRGBToLinear(double value)
+{ return (value <= 0.04045) ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4); }
+
+double RefLinearToSRGB(double value)
+{ return (value <= 0.0031308) ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055; }
+
+// 8bit に丸める前の sRGB の値.
+double RefSRGB8(float value)
+{
+    if (!(value > 0.0f))
+        return 0.0;
+    return (value < 1.0f) ? RefLinearToSRGB(value) * 255.0 : 255.0;
+}
+
+uint32_t RandomARGB(Random& rng)
+{
+    uint32_t result = 0;
+    for (auto k = 0; k < 4; ++k)
+    { result = (result << 8) | (uint32_t(rng.Uniform(0.0f, 256.0f)) & 0xff); }
+    return result;
+}
+
+void Test_D3DXColorARGBArray(TestContext& ctx)
+{
+    Random rng;
+    const size_t n = kArrayCount + 7;
+
+    // 8bit の全ての値を含める.
+    std::vector<uint32_t> packed(n);
+    for (size_t i = 0; i < n; ++i)
+    { packed[i] = (i < 256) ? uint32_t(i) * 0x01010101u : RandomARGB(rng); }
+
+    std::vector<D3DXCOLOR> linear(n), srgb(n);
+    D3DXColorFromARGBArray(linear.data(), packed.data(), uint32_t(n), D3DXCOLORSPACE_LINEAR);
+    D3DXColorFromARGBArray(srgb.data(), packed.data(), uint32_t(n), D3DXCOLORSPACE_SRGB);
+
+    std::vector<uint32_t> roundTrip(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const D3DXCOLOR expected(packed[i]);
+        ctx.Expect(memcmp(&linear[i], &expected, sizeof(D3DXCOLOR)) == 0, "D3DXColorFromARGBArray linear");
+
+        const uint8_t bytes[3] = { uint8_t(packed[i] >> 16), uint8_t(packed[i] >> 8), uint8_t(packed[i]) };
+        ctx.Check(srgb[i].r, RefSRGBToLinear(bytes[0] / 255.0), 0.0);
+        ctx.Check(srgb[i].g, RefSRGBToLinear(bytes[1] / 255.0), 0.0);
+        ctx.Check(srgb[i].b, RefSRGBToLinear(bytes[2] / 255.0), 0.0);
+        ctx.Expect(srgb[i].a == expected.a, "D3DXColorFromARGBArray sRGB alpha");
+    }
+
+    // 8bit から変換した値は元に戻る.
+    D3DXColorToARGBArray(roundTrip.data(), linear.data(), uint32_t(n), D3DXCOLORSPACE_LINEAR);
+    ctx.Expect(roundTrip == packed, "D3DXColorToARGBArray linear round trip");
+    D3DXColorToARGBArray(roundTrip.data(), srgb.data(), uint32_t(n), D3DXCOLORSPACE_SRGB);
+    ctx.Expect(roundTrip == packed, "D3DXColorToARGBArray sRGB round trip");
+
+    // 範囲外の値と特殊な値を含む色.
+    const float specials[] = { 0.0f, -0.0f, 1.0f, 1e-30f, 1.0f / 8192.0f, 1.5e-4f, 0.0031308f, 0.5f, 0.99f, 2.0f, -1.0f, INFINITY, -INFINITY, NAN };
+    const size_t specialCount = sizeof(specials) / sizeof(specials[0]);
+
+    std::vector<D3DXCOLOR> colors(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto value = [&](size_t k)
+        { return (i < specialCount * 4) ? specials[(i + k * 5) % specialCount] : rng.Uniform(-0.25f, 1.25f); };
+        colors[i] = D3DXCOLOR(value(0), value(1), value(2), value(3));
+    }
+
+    std::vector<uint32_t> toLinear(n), toSRGB(n);
+    D3DXColorToARGBArray(toLinear.data(), colors.data(), uint32_t(n), D3DXCOLORSPACE_LINEAR);
+    D3DXColorToARGBArray(toSRGB.data(), colors.data(), uint32_t(n), D3DXCOLORSPACE_SRGB);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const auto& c = colors[i];
+        const float channels[4] = { c.b, c.g, c.r, c.a };
+        for (auto k = 0; k < 4; ++k)
+        {
+            // NaN は 0 になる.
+            const auto actual = (toLinear[i] >> (8 * k)) & 0xff;
+            if (std::isnan(channels[k]))
+            {
+                ctx.Expect(actual == 0, "D3DXColorToARGBArray NaN");
+                ctx.Expect(((toSRGB[i] >> (8 * k)) & 0xff) == 0, "D3DXColorToARGBArray sRGB NaN");
+                continue;
+            }
+
+            D3DXCOLOR single(0.0f, 0.0f, 0.0f, 0.0f);
+            (&single.r)[(k < 3) ? 2 - k : 3] = channels[k];
+            ctx.Expect(actual == ((uint32_t(single) >> (8 * k)) & 0xff), "D3DXColorToARGBArray linear");
+
+            const auto srgbActual = (toSRGB[i] >> (8 * k)) & 0xff;
+            if (k == 3)
+            {
+                ctx.Expect(srgbActual == actual, "D3DXColorToARGBArray sRGB alpha");
+                continue;
+            }
+
+            // 丸めの境界の近くは判定しない.
+            const auto ref = RefSRGB8(channels[k]);
+            if (std::fabs(ref - std::floor(ref) - 0.5) > 1e-3)
+            { ctx.Expect(srgbActual == uint32_t(std::floor(ref + 0.5)), "D3DXColorToARGBArray sRGB"); }
+        }
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXColorToARGBArray(toSRGB.data(), colors.data(), uint32_t(n), D3DXCOLORSPACE_SRGB); });
+}
+TEST_CASE(Test_D3DXColorARGBArray, 1.0);
+
+void Test_D3DXColorARGBArrayParallel(TestContext& ctx)
+{
+    Random rng;
+    const size_t n = kParallelCount;
+
+    std::vector<uint32_t>  packed(n);
+    std::vector<D3DXCOLOR> colors(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        packed[i] = RandomARGB(rng);
+        colors[i] = D3DXCOLOR(rng.Uniform(-0.25f, 1.25f), rng.Uniform(-0.25f, 1.25f), rng.Uniform(-0.25f, 1.25f), rng.Uniform(-0.25f, 1.25f));
+    }
+
+    // 分割しない場合と完全に一致する.
+    const D3DXCOLORSPACE spaces[] = { D3DXCOLORSPACE_LINEAR, D3DXCOLORSPACE_SRGB };
+    for (auto space : spaces)
+    {
+        std::vector<D3DXCOLOR> serialColors(n), parallelColors(n);
+        D3DXColorFromARGBArray(serialColors.data(), packed.data(), uint32_t(n), space);
+        D3DXColorFromARGBArrayParallel(parallelColors.data(), packed.data(), uint32_t(n), space);
+        ctx.Expect(memcmp(serialColors.data(), parallelColors.data(), n * sizeof(D3DXCOLOR)) == 0, "D3DXColorFromARGBArrayParallel");
+
+        std::vector<uint32_t> serialPacked(n), parallelPacked(n);
+        D3DXColorToARGBArray(serialPacked.data(), colors.data(), uint32_t(n), space);
+        D3DXColorToARGBArrayParallel(parallelPacked.data(), colors.data(), uint32_t(n), space);
+        ctx.Expect(serialPacked == parallelPacked, "D3DXColorToARGBArrayParallel");
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXColorFromARGBArrayParallel(colors.data(), packed.data(), uint32_t(n), D3DXCOLORSPACE_SRGB); });
+}
+TEST_CASE(Test_D3DXColorARGBArrayParallel, 0.0);
+
+// 画像の作成. 行の末尾に余白を入れる.
+template<typename T>
+D3DXCOLORIMAGE MakeColorImage(std::vector<T>& bits, uint32_t width, uint32_t height, uint32_t texelsPerPixel, D3DXCOLORFORMAT format)
+{
+    const uint32_t stride = (width + 3) * texelsPerPixel;
+    bits.assign(size_t(stride) * height, T());
+
+    D3DXCOLORIMAGE image;
+    image.pBits  = bits.data();
+    image.Width  = width;
+    image.Height = height;
+    image.Pitch  = stride * sizeof(T);
+    image.Format = format;
+    return image;
+}
+
+// 1画素ずつ単体の関数で演算を適用する.
+D3DXCOLOR RefColorOps(D3DXCOLOR c, const D3DXCOLOROP* pOps, uint32_t numOps, const D3DXCOLOR* pOperands)
+{
+    for (uint32_t k = 0; k < numOps; ++k)
+    {
+        const auto& op = pOps[k];
+        const auto operand = op.pImage ? pOperands[k] : op.Color;
+        switch (op.Type)
+        {
+        case D3DXCOLOROP_ADJUSTSATURATION: D3DXColorAdjustSaturation(&c, &c, op.Factor); break;
+        case D3DXCOLOROP_ADJUSTCONTRAST:   D3DXColorAdjustContrast(&c, &c, op.Factor); break;
+        case D3DXCOLOROP_MODULATE:         D3DXColorModulate(&c, &c, &operand); break;
+        case D3DXCOLOROP_LERP:             D3DXColorLerp(&c, &c, &operand, op.Factor); break;
+        }
+    }
+    return c;
+}
+
+void Test_D3DXColorImage(TestContext& ctx)
+{
+    Random rng;
+    const uint32_t width  = 267;    // タイルの端数を含む幅.
+    const uint32_t height = 13;
+    const uint32_t stride = width + 3;
+
+    auto randomColor = [&]()
+    { return D3DXCOLOR(rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f)); };
+
+    std::vector<D3DXCOLOR> srcBits, dstBits, lerpBits;
+    std::vector<D3DXFLOAT16> mulBits;
+    auto src  = MakeColorImage(srcBits,  width, height, 1, D3DXCOLORFORMAT_A32B32G32R32F);
+    auto dst  = MakeColorImage(dstBits,  width, height, 1, D3DXCOLORFORMAT_A32B32G32R32F);
+    auto lerp = MakeColorImage(lerpBits, width, height, 1, D3DXCOLORFORMAT_A32B32G32R32F);
+    auto mul  = MakeColorImage(mulBits,  width, height, 4, D3DXCOLORFORMAT_A16B16G16R16F);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            srcBits [y * stride + x] = randomColor();
+            lerpBits[y * stride + x] = randomColor();
+            const auto c = randomColor();
+            D3DXFloat32To16Array(&mulBits[(y * stride + x) * 4], &c.r, 4);
+        }
+    }
+
+    // 彩度, コントラスト, 画像との乗算, 定数との補間, 画像との補間の順に適用する.
+    const D3DXCOLOROP ops[] = {
+        { D3DXCOLOROP_ADJUSTSATURATION, 0.6f,  D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f),  nullptr },
+        { D3DXCOLOROP_ADJUSTCONTRAST,   1.3f,  D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f),  nullptr },
+        { D3DXCOLOROP_MODULATE,         0.0f,  D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f),  &mul },
+        { D3DXCOLOROP_LERP,             0.25f, D3DXCOLOR(0.2f, 0.4f, 0.6f, 0.8f),  nullptr },
+        { D3DXCOLOROP_LERP,             0.5f,  D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f),  &lerp },
+    };
+    const auto numOps = uint32_t(sizeof(ops) / sizeof(ops[0]));
+
+    // 演算1つずつと, まとめて適用した場合.
+    for (uint32_t k = 0; k <= numOps; ++k)
+    {
+        const auto first = (k < numOps) ? k : 0;
+        const auto count = (k < numOps) ? 1 : numOps;
+
+        ctx.Expect(D3DXColorImageApply(&dst, &src, ops + first, count) == 0, "D3DXColorImageApply");
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                D3DXCOLOR operands[numOps];
+                D3DXFloat16To32Array(&operands[2].r, &mulBits[(y * stride + x) * 4], 4);
+                operands[4] = lerpBits[y * stride + x];
+
+                const auto ref = RefColorOps(srcBits[y * stride + x], ops + first, count, operands + first);
+                CheckVector(ctx, &dstBits[y * stride + x].r, RefVec(ref), 4, 1.0);
+            }
+        }
+    }
+
+    // 同じ画像に書き込んでも結果は変わらない.
+    auto inPlaceBits = srcBits;
+    auto inPlace     = src;
+    inPlace.pBits = inPlaceBits.data();
+    ctx.Expect(D3DXColorImageApply(&inPlace, nullptr, ops, numOps) == 0, "D3DXColorImageApply in place");
+    ctx.Expect(inPlaceBits == dstBits, "D3DXColorImageApply in place");
+
+    // 格納形式ごとの結果は, float の結果を配列版で変換したものと一致する.
+    const D3DXCOLORFORMAT formats[] = { D3DXCOLORFORMAT_A16B16G16R16F, D3DXCOLORFORMAT_A8R8G8B8, D3DXCOLORFORMAT_A8R8G8B8_SRGB };
+    for (auto format : formats)
+    {
+        std::vector<uint32_t> bits;
+        auto image = MakeColorImage(bits, width, height, (format == D3DXCOLORFORMAT_A16B16G16R16F) ? 2 : 1, format);
+        ctx.Expect(D3DXColorImageApply(&image, &src, ops, numOps) == 0, "D3DXColorImageApply format");
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const auto pRow = reinterpret_cast<const uint8_t*>(bits.data()) + size_t(y) * image.Pitch;
+            const auto pRef = &dstBits[y * stride];
+            if (format == D3DXCOLORFORMAT_A16B16G16R16F)
+            {
+                std::vector<D3DXFLOAT16> ref(width * 4);
+                D3DXFloat32To16Array(ref.data(), &pRef->r, width * 4);
+                ctx.Expect(memcmp(ref.data(), pRow, width * 4 * sizeof(D3DXFLOAT16)) == 0, "D3DXColorImageApply half");
+            }
+            else
+            {
+                const auto space = (format == D3DXCOLORFORMAT_A8R8G8B8) ? D3DXCOLORSPACE_LINEAR : D3DXCOLORSPACE_SRGB;
+                std::vector<uint32_t> ref(width);
+                D3DXColorToARGBArray(ref.data(), pRef, width, space);
+                ctx.Expect(memcmp(ref.data(), pRow, width * sizeof(uint32_t)) == 0, "D3DXColorImageApply ARGB");
+            }
+        }
+
+        // 読み込みも同じ変換を使う.
+        std::vector<D3DXCOLOR> loadedBits;
+        auto loaded = MakeColorImage(loadedBits, width, height, 1, D3DXCOLORFORMAT_A32B32G32R32F);
+        ctx.Expect(D3DXColorImageApply(&loaded, &image, nullptr, 0) == 0, "D3DXColorImageApply load");
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const auto pRow = reinterpret_cast<const uint8_t*>(bits.data()) + size_t(y) * image.Pitch;
+            std::vector<D3DXCOLOR> ref(width);
+            if (format == D3DXCOLORFORMAT_A16B16G16R16F)
+            { D3DXFloat16To32Array(&ref[0].r, reinterpret_cast<const D3DXFLOAT16*>(pRow), width * 4); }
+            else
+            { D3DXColorFromARGBArray(ref.data(), reinterpret_cast<const uint32_t*>(pRow), width, (format == D3DXCOLORFORMAT_A8R8G8B8) ? D3DXCOLORSPACE_LINEAR : D3DXCOLORSPACE_SRGB); }
+            ctx.Expect(memcmp(ref.data(), &loadedBits[y * stride], width * sizeof(D3DXCOLOR)) == 0, "D3DXColorImageApply load");
+        }
+    }
+
+    // 演算の画像が多い場合.
+    const D3DXCOLOROP imageOps[] = {
+        { D3DXCOLOROP_MODULATE, 0.0f,  D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), &mul },
+        { D3DXCOLOROP_LERP,     0.5f,  D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), &lerp },
+        { D3DXCOLOROP_LERP,     0.75f, D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), &src },
+    };
+    ctx.Expect(D3DXColorImageApply(&dst, &src, imageOps, 3) == 0, "D3DXColorImageApply images");
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            D3DXCOLOR operands[3];
+            D3DXFloat16To32Array(&operands[0].r, &mulBits[(y * stride + x) * 4], 4);
+            operands[1] = lerpBits[y * stride + x];
+            operands[2] = srcBits[y * stride + x];
+
+            const auto ref = RefColorOps(srcBits[y * stride + x], imageOps, 3, operands);
+            CheckVector(ctx, &dstBits[y * stride + x].r, RefVec(ref), 4, 1.0);
+        }
+    }
+
+    // 不正な引数.
+    auto badPitch = dst;
+    badPitch.Pitch = width * sizeof(D3DXCOLOR) - 1;
+    auto badSize = src;
+    badSize.Width = width - 1;
+    auto badFormat = dst;
+    badFormat.Format = D3DXCOLORFORMAT(4);
+    D3DXCOLOROP badOp = ops[0];
+    badOp.pImage = &lerp;
+    D3DXCOLOROP badType = ops[0];
+    badType.Type = D3DXCOLOROPTYPE(4);
+    D3DXCOLOROP badOperand = ops[4];
+    badOperand.pImage = &badSize;
+
+    ctx.Expect(D3DXColorImageApply(nullptr, &src, ops, numOps) != 0, "D3DXColorImageApply null dest");
+    ctx.Expect(D3DXColorImageApply(&dst, &src, nullptr, 1) != 0, "D3DXColorImageApply null ops");
+    ctx.Expect(D3DXColorImageApply(&badPitch, &src, ops, numOps) != 0, "D3DXColorImageApply pitch");
+    ctx.Expect(D3DXColorImageApply(&dst, &badSize, ops, numOps) != 0, "D3DXColorImageApply size");
+    ctx.Expect(D3DXColorImageApply(&badFormat, &src, ops, numOps) != 0, "D3DXColorImageApply format");
+    ctx.Expect(D3DXColorImageApply(&dst, &src, &badOp, 1) != 0, "D3DXColorImageApply operand");
+    ctx.Expect(D3DXColorImageApply(&dst, &src, &badType, 1) != 0, "D3DXColorImageApply type");
+    ctx.Expect(D3DXColorImageApply(&dst, &src, &badOperand, 1) != 0, "D3DXColorImageApply operand size");
+
+    ctx.Measure(size_t(width) * height, [&]()
+    { D3DXColorImageApply(&dst, &src, ops, numOps); });
+}
+TEST_CASE(Test_D3DXColorImage, 1.0);
+
+void Test_D3DXColorImageParallel(TestContext& ctx)
+{
+    Random rng;
+    const uint32_t width  = 1023;
+    const uint32_t height = 67;
+
+    std::vector<uint32_t> srcBits, serialBits, parallelBits;
+    auto src      = MakeColorImage(srcBits,      width, height, 1, D3DXCOLORFORMAT_A8R8G8B8_SRGB);
+    auto serial   = MakeColorImage(serialBits,   width, height, 1, D3DXCOLORFORMAT_A8R8G8B8);
+    auto parallel = MakeColorImage(parallelBits, width, height, 1, D3DXCOLORFORMAT_A8R8G8B8);
+    for (auto& texel : srcBits)
+    { texel = RandomARGB(rng); }
+
+    const D3DXCOLOROP ops[] = {
+        { D3DXCOLOROP_ADJUSTSATURATION, 1.4f, D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), nullptr },
+        { D3DXCOLOROP_LERP,             0.3f, D3DXCOLOR(0.0f, 0.0f, 0.0f, 1.0f), &src },
+        { D3DXCOLOROP_ADJUSTCONTRAST,   0.7f, D3DXCOLOR(0.0f, 0.0f, 0.0f, 0.0f), nullptr },
+    };
+    const auto numOps = uint32_t(sizeof(ops) / sizeof(ops[0]));
+
+    // 分割しない場合と完全に一致する.
+    ctx.Expect(D3DXColorImageApply(&serial, &src, ops, numOps) == 0, "D3DXColorImageApply");
+    ctx.Expect(D3DXColorImageApplyParallel(&parallel, &src, ops, numOps) == 0, "D3DXColorImageApplyParallel");
+    ctx.Expect(serialBits == parallelBits, "D3DXColorImageApplyParallel");
+
+    ctx.Measure(size_t(width) * height, [&]()
+    { D3DXColorImageApplyParallel(&parallel, &src, ops, numOps); });
+}
+TEST_CASE(Test_D3DXColorImageParallel, 0.0);
+
+void Test_D3DXFresnelTerm(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        double c = rng.Uniform(0.0f, 1.0f);
+        double n = rng.Uniform(1.0f, 3.0f);
+        auto g = std::sqrt(n * n + c * c - 1.0);
+        auto a = (g - c) / (g + c);
+        auto b = (c * (g + c) - 1.0) / (c * (g - c) + 1.0);
+        auto expected = std::min(0.5 * a * a * (1.0 + b * b), 1.0);
+
+        ctx.Check(D3DXFresnelTerm(float(c), float(n)), expected, 1.0);
+    }
+}
+TEST_CASE(Test_D3DXFresnelTerm, 64.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Spherical Harmonics
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXSHEvalDirection(TestContext& ctx)
+{
+    Random rng;
+    std::vector<D3DXVECTOR3> dirs(kCount);
+    std::vector<float>       dst(kCount * kSHMaxCoeffs);
+    for (auto& d : dirs)
+    { d = rng.Direction(); }
+
+    ctx.Measure(kCount, [&]()
+    {
+        for (size_t i = 0; i < kCount; ++i)
+        { D3DXSHEvalDirection(&dst[i * kSHMaxCoeffs], D3DXSH_MAXORDER, &dirs[i]); }
+    });
+
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        double expected[kSHMaxCoeffs];
+        RefSHEval(D3DXSH_MAXORDER, RefVec(dirs[i]), expected);
+        CheckValues(ctx, &dst[i * kSHMaxCoeffs], expected, kSHMaxCoeffs);
+
+        for (uint32_t order = D3DXSH_MINORDER; order < D3DXSH_MAXORDER; ++order)
+        {
+            float low[kSHMaxCoeffs];
+            D3DXSHEvalDirection(low, order, &dirs[i]);
+            CheckValues(ctx, low, expected, int(order * order), MaxAbs(RefVector{ expected[0], expected[1], expected[2], expected[3] }));
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHEvalDirection, 16.0);
+
+// SoA形式で出力された n 方向分の係数を参照値と比較する.
+void CheckSHEvalBatch(TestContext& ctx, uint32_t order, const std::vector<D3DXVECTOR3>& dirs, const float* pOut, size_t n)
+{
+    for (size_t k = 0; k < n; ++k)
+    {
+        double expected[kSHMaxCoeffs];
+        RefSHEval(order, RefVec(dirs[k]), expected);
+
+        float actual[kSHMaxCoeffs];
+        for (uint32_t i = 0; i < order * order; ++i)
+        { actual[i] = pOut[i * n + k]; }
+
+        CheckValues(ctx, actual, expected, int(order * order), MaxAbs(RefVector{ expected[0], expected[1], expected[2], expected[3] }));
+    }
+}
+
+void Test_D3DXSHEvalDirectionArray(TestContext& ctx)
+{
+    Random rng;
+    const size_t counts[] = { kArrayCount + 3, kParallelCount };
+
+    for (auto n : counts)
+    {
+        std::vector<D3DXVECTOR3> dirs(n);
+        std::vector<float>       x(n), y(n), z(n);
+        std::vector<float>       dst(n * kSHMaxCoeffs);
+        for (size_t k = 0; k < n; ++k)
+        {
+            dirs[k] = rng.Direction();
+            x[k] = dirs[k].x;
+            y[k] = dirs[k].y;
+            z[k] = dirs[k].z;
+        }
+
+        const bool parallel = (n == kParallelCount);
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            auto evalArray = [&]()
+            {
+                return parallel
+                    ? D3DXSHEvalDirectionArrayParallel(dst.data(), order, dirs.data(), sizeof(D3DXVECTOR3), uint32_t(n))
+                    : D3DXSHEvalDirectionArray(dst.data(), order, dirs.data(), sizeof(D3DXVECTOR3), uint32_t(n));
+            };
+            auto evalSoA = [&]()
+            {
+                return parallel
+                    ? D3DXSHEvalDirectionSoAParallel(dst.data(), order, x.data(), y.data(), z.data(), uint32_t(n))
+                    : D3DXSHEvalDirectionSoA(dst.data(), order, x.data(), y.data(), z.data(), uint32_t(n));
+            };
+
+            if (!parallel && order == D3DXSH_MAXORDER)
+            { ctx.Measure(n, [&]() { evalArray(); }); }
+
+            ctx.Expect(evalArray() == dst.data(), "D3DXSHEvalDirectionArray failed");
+            CheckSHEvalBatch(ctx, order, dirs, dst.data(), n);
+
+            ctx.Expect(evalSoA() == dst.data(), "D3DXSHEvalDirectionSoA failed");
+            CheckSHEvalBatch(ctx, order, dirs, dst.data(), n);
+        }
+    }
+
+    float out[kSHMaxCoeffs];
+    D3DXVECTOR3 dir(0.0f, 0.0f, 1.0f);
+    ctx.Expect(D3DXSHEvalDirectionArray(out, 1, &dir, sizeof(dir), 1) == nullptr, "invalid order accepted");
+    ctx.Expect(D3DXSHEvalDirectionSoA(nullptr, 3, &dir.x, &dir.y, &dir.z, 1) == nullptr, "null output accepted");
+}
+TEST_CASE(Test_D3DXSHEvalDirectionArray, 16.0);
+
+void Test_D3DXSHRotate(TestContext& ctx)
+{
+    Random rng;
+    const size_t count = 64;
+    std::vector<D3DXMATRIX> mtx(count);
+    std::vector<float>      src(count * kSHMaxCoeffs), dst(count * kSHMaxCoeffs);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto q = rng.Rotation();
+        D3DXMatrixRotationQuaternion(&mtx[i], &q);
+        for (int j = 0; j < kSHMaxCoeffs; ++j)
+        { src[i * kSHMaxCoeffs + j] = rng.Uniform(-1.0f, 1.0f); }
+    }
+
+    for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+    {
+        if (order == D3DXSH_MAXORDER)
+        {
+            ctx.Measure(count, [&]()
+            {
+                for (size_t i = 0; i < count; ++i)
+                { D3DXSHRotate(&dst[i * kSHMaxCoeffs], order, &mtx[i], &src[i * kSHMaxCoeffs]); }
+            });
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            { D3DXSHRotate(&dst[i * kSHMaxCoeffs], order, &mtx[i], &src[i * kSHMaxCoeffs]); }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            double expected[kSHMaxCoeffs];
+            RefSHRotate(order, RefMat(mtx[i]), &src[i * kSHMaxCoeffs], expected);
+
+            // 回転は係数のノルムを保存するので入力のノルムを基準にする.
+            double norm = 0.0;
+            for (uint32_t j = 0; j < order * order; ++j)
+            { norm += double(src[i * kSHMaxCoeffs + j]) * src[i * kSHMaxCoeffs + j]; }
+            CheckValues(ctx, &dst[i * kSHMaxCoeffs], expected, int(order * order), std::sqrt(norm));
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHRotate, 64.0);
+
+void Test_D3DXSHRotatePlan(TestContext& ctx)
+{
+    Random rng;
+    const size_t count = 256 + 3;
+    std::vector<float> src(count * kSHMaxCoeffs), dst(src.size()), soa(src.size()), rot(src.size());
+    for (auto& value : src)
+    { value = rng.Uniform(-1.0f, 1.0f); }
+
+    auto q = rng.Rotation();
+    D3DXMATRIX mtx;
+    D3DXMatrixRotationQuaternion(&mtx, &q);
+
+    for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+    {
+        const auto n = order * order;
+        D3DXSHROTATEPLAN plan;
+        ctx.Expect(D3DXSHRotatePlanInit(&plan, order, &mtx) == &plan, "D3DXSHRotatePlanInit failed");
+
+        if (order == D3DXSH_MAXORDER)
+        { ctx.Measure(count, [&]() { D3DXSHRotatePlanApply(dst.data(), &plan, src.data(), uint32_t(count)); }); }
+        else
+        { D3DXSHRotatePlanApply(dst.data(), &plan, src.data(), uint32_t(count)); }
+
+        D3DXSHAoSToSoA(soa.data(), order, src.data(), uint32_t(count));
+        D3DXSHRotatePlanApplySoA(rot.data(), &plan, soa.data(), uint32_t(count));
+        D3DXSHSoAToAoS(soa.data(), order, rot.data(), uint32_t(count));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            double expected[kSHMaxCoeffs];
+            RefSHRotate(order, RefMat(mtx), &src[i * n], expected);
+
+            double norm = 0.0;
+            for (uint32_t j = 0; j < n; ++j)
+            { norm += double(src[i * n + j]) * src[i * n + j]; }
+            CheckValues(ctx, &dst[i * n], expected, int(n), std::sqrt(norm));
+            CheckValues(ctx, &soa[i * n], expected, int(n), std::sqrt(norm));
+        }
+
+        // 同じ配列に書き込んでも結果は変わらない.
+        auto inPlace = src;
+        ctx.Expect(D3DXSHRotatePlanApply(inPlace.data(), &plan, inPlace.data(), uint32_t(count)) == inPlace.data()
+            && memcmp(inPlace.data(), dst.data(), count * n * sizeof(float)) == 0, "D3DXSHRotatePlanApply in place");
+
+        D3DXSHAoSToSoA(inPlace.data(), order, src.data(), uint32_t(count));
+        ctx.Expect(D3DXSHRotatePlanApplySoA(inPlace.data(), &plan, inPlace.data(), uint32_t(count)) == inPlace.data()
+            && memcmp(inPlace.data(), rot.data(), count * n * sizeof(float)) == 0, "D3DXSHRotatePlanApplySoA in place");
+
+        // 一部だけ重なる場合は失敗する.
+        ctx.Expect(D3DXSHRotatePlanApply(inPlace.data() + n, &plan, inPlace.data(), uint32_t(count - 1)) == nullptr, "partial overlap accepted");
+        ctx.Expect(D3DXSHRotatePlanApply(inPlace.data(), &plan, inPlace.data() + 1, uint32_t(count - 1)) == nullptr, "partial overlap accepted");
+        ctx.Expect(D3DXSHRotatePlanApplySoA(inPlace.data() + 1, &plan, inPlace.data(), uint32_t(count - 1)) == nullptr, "partial overlap accepted");
+    }
+
+    D3DXSHROTATEPLAN plan;
+    ctx.Expect(D3DXSHRotatePlanInit(&plan, 1, &mtx) == nullptr, "invalid order accepted");
+}
+TEST_CASE(Test_D3DXSHRotatePlan, 64.0);
+
+void Test_D3DXSHRotateZ(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < 64; ++i)
+    {
+        float src[kSHMaxCoeffs], dst[kSHMaxCoeffs];
+        for (auto& v : src)
+        { v = rng.Uniform(-1.0f, 1.0f); }
+
+        auto angle = rng.Uniform(-6.0f, 6.0f);
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            double expected[kSHMaxCoeffs];
+            RefSHRotate(order, RefRotationZ(angle), src, expected);
+
+            double norm = 0.0;
+            for (uint32_t j = 0; j < order * order; ++j)
+            { norm += double(src[j]) * src[j]; }
+
+            D3DXSHRotateZ(dst, order, angle, src);
+            CheckValues(ctx, dst, expected, int(order * order), std::sqrt(norm));
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHRotateZ, 64.0);
+
+void Test_D3DXSHArithmetic(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        float a[kSHMaxCoeffs], b[kSHMaxCoeffs], ret[kSHMaxCoeffs];
+        double add[kSHMaxCoeffs], scale[kSHMaxCoeffs], dot = 0.0, dotMag = 0.0;
+        auto s = rng.Uniform(-2.0f, 2.0f);
+        for (int j = 0; j < kSHMaxCoeffs; ++j)
+        {
+            a[j] = rng.Uniform(-1.0f, 1.0f);
+            b[j] = rng.Uniform(-1.0f, 1.0f);
+            add[j]   = double(a[j]) + b[j];
+            scale[j] = double(a[j]) * s;
+            dot     += double(a[j]) * b[j];
+            dotMag  += std::fabs(double(a[j]) * b[j]);
+        }
+
+        CheckValues(ctx, D3DXSHAdd(ret, D3DXSH_MAXORDER, a, b), add, kSHMaxCoeffs, 2.0);
+        CheckValues(ctx, D3DXSHScale(ret, D3DXSH_MAXORDER, a, s), scale, kSHMaxCoeffs);
+        ctx.Check(D3DXSHDot(D3DXSH_MAXORDER, a, b), dot, dotMag);
+    }
+}
+TEST_CASE(Test_D3DXSHArithmetic, 8.0);
+
+void Test_D3DXSHMultiply(TestContext& ctx)
+{
+    using MultiplyFunc = float* (STUB_API *)(float*, const float*, const float*);
+    const MultiplyFunc funcs[] = {
+        D3DXSHMultiply2, D3DXSHMultiply3, D3DXSHMultiply4, D3DXSHMultiply5, D3DXSHMultiply6 };
+
+    Random rng;
+    const size_t count = 256;
+    std::vector<float> f(count * kSHMaxCoeffs), g(count * kSHMaxCoeffs), dst(count * kSHMaxCoeffs);
+    for (size_t i = 0; i < f.size(); ++i)
+    {
+        f[i] = rng.Uniform(-1.0f, 1.0f);
+        g[i] = rng.Uniform(-1.0f, 1.0f);
+    }
+
+    for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+    {
+        auto func = funcs[order - D3DXSH_MINORDER];
+        if (order == 3)
+        {
+            ctx.Measure(count, [&]()
+            {
+                for (size_t i = 0; i < count; ++i)
+                { func(&dst[i * kSHMaxCoeffs], &f[i * kSHMaxCoeffs], &g[i * kSHMaxCoeffs]); }
+            });
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+            { func(&dst[i * kSHMaxCoeffs], &f[i * kSHMaxCoeffs], &g[i * kSHMaxCoeffs]); }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            double expected[kSHMaxCoeffs];
+            RefSHMultiply(order, &f[i * kSHMaxCoeffs], &g[i * kSHMaxCoeffs], expected);
+
+            // 積和の項数に応じた大きさを基準にする.
+            double magnitude = 0.0;
+            for (uint32_t j = 0; j < order * order; ++j)
+            { magnitude += std::fabs(f[i * kSHMaxCoeffs + j]) * std::fabs(g[i * kSHMaxCoeffs + j]); }
+            CheckValues(ctx, &dst[i * kSHMaxCoeffs], expected, int(order * order), magnitude * 0.3);
+        }
+
+        // 出力先が入力と同じでも結果は変わらない.
+        for (size_t i = 0; i < count; ++i)
+        {
+            float y[kSHMaxCoeffs];
+            memcpy(y, &f[i * kSHMaxCoeffs], sizeof(y));
+            func(y, y, &g[i * kSHMaxCoeffs]);
+            ctx.Expect(memcmp(y, &dst[i * kSHMaxCoeffs], order * order * sizeof(float)) == 0, "D3DXSHMultiply y == f");
+
+            memcpy(y, &g[i * kSHMaxCoeffs], sizeof(y));
+            func(y, &f[i * kSHMaxCoeffs], y);
+            ctx.Expect(memcmp(y, &dst[i * kSHMaxCoeffs], order * order * sizeof(float)) == 0, "D3DXSHMultiply y == g");
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHMultiply, 64.0);
+
+void Test_D3DXSHMultiplySoA(TestContext& ctx)
+{
+    Random rng;
+    const size_t count = 1024 + 3;
+    std::vector<float> f(count * kSHMaxCoeffs), g(count * kSHMaxCoeffs);
+    std::vector<float> sf(f.size()), sg(g.size()), sy(f.size()), dst(f.size());
+    for (size_t i = 0; i < f.size(); ++i)
+    {
+        f[i] = rng.Uniform(-1.0f, 1.0f);
+        g[i] = rng.Uniform(-1.0f, 1.0f);
+    }
+
+    for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+    {
+        const auto n = order * order;
+        D3DXSHAoSToSoA(sf.data(), order, f.data(), uint32_t(count));
+        D3DXSHAoSToSoA(sg.data(), order, g.data(), uint32_t(count));
+
+        if (order == 3)
+        {
+            ctx.Measure(count, [&]()
+            { D3DXSHMultiplySoA(sy.data(), order, sf.data(), sg.data(), uint32_t(count)); });
+        }
+        else
+        { D3DXSHMultiplySoA(sy.data(), order, sf.data(), sg.data(), uint32_t(count)); }
+
+        D3DXSHSoAToAoS(dst.data(), order, sy.data(), uint32_t(count));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            // 1組ずつの版と同じ式なので同じ許容値で比較する.
+            double expected[kSHMaxCoeffs];
+            RefSHMultiply(order, &f[i * n], &g[i * n], expected);
+
+            double magnitude = 0.0;
+            for (uint32_t j = 0; j < n; ++j)
+            { magnitude += std::fabs(f[i * n + j]) * std::fabs(g[i * n + j]); }
+            CheckValues(ctx, &dst[i * n], expected, int(n), magnitude * 0.3);
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHMultiplySoA, 64.0);
+
+// 光源の係数を RGB それぞれ参照値と比較する.
+// cond は円錐の積分で生じる桁落ちの大きさ.
+template<typename Func, typename Reference>
+void CheckSHLight(TestContext& ctx, uint32_t order, const float* intensity, double magnitude, double cond, Func func, Reference reference)
+{
+    float R[kSHMaxCoeffs], G[kSHMaxCoeffs], B[kSHMaxCoeffs];
+    const float* outputs[3] = { R, G, B };
+
+    ctx.Expect(func(R, G, B) == 0, "D3DXSHEval*Light failed");
+    for (int c = 0; c < 3; ++c)
+    {
+        double expected[kSHMaxCoeffs];
+        reference(intensity[c], expected);
+
+        auto scale = magnitude;
+        for (uint32_t j = 0; j < order * order; ++j)
+        { scale = std::max(scale, std::fabs(expected[j])); }
+        CheckValues(ctx, outputs[c], expected, int(order * order), scale * cond);
+    }
+}
+
+void Test_D3DXSHEvalDirectionalLight(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto dir = rng.Direction();
+        const float intensity[3] = { rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f) };
+
+        // デルタ関数の射影を, 法線方向の放射照度が強度と一致するよう正規化したもの.
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            CheckSHLight(ctx, order, intensity, 0.0, 1.0,
+                [&](float* R, float* G, float* B)
+                { return D3DXSHEvalDirectionalLight(order, &dir, intensity[0], intensity[1], intensity[2], R, G, B); },
+                [&](double scale, double* expected)
+                {
+                    RefSHEval(order, RefVec(dir), expected);
+                    for (uint32_t j = 0; j < order * order; ++j)
+                    { expected[j] *= scale * RefSHIrradianceNorm(order); }
+                });
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHEvalDirectionalLight, 16.0);
+
+void Test_D3DXSHEvalConeLight(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto dir = rng.Direction();
+        const float intensity[3] = { rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f) };
+
+        // 放射輝度 1/sin^2(r) の円錐 (r > pi/2 では 1).
+        auto radius = rng.Uniform(0.05f, 3.0f);
+        auto k = 1.0 / std::pow(std::sin(std::min(double(radius), kPi * 0.5)), 2.0);
+
+        // 帯ごとの積分は cos(r) の多項式で求めるため, 小さな円錐では 1 - cos(r) 程度の桁落ちが生じる.
+        auto cond = 1.0 / (1.0 - std::cos(std::min(double(radius), kPi * 0.5)));
+
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            double zonal[D3DXSH_MAXORDER];
+            RefSHConeZonal(order, radius, zonal);
+            CheckSHLight(ctx, order, intensity, 0.0, cond,
+                [&](float* R, float* G, float* B)
+                { return D3DXSHEvalConeLight(order, &dir, radius, intensity[0], intensity[1], intensity[2], R, G, B); },
+                [&](double scale, double* expected)
+                { RefSHZonal(order, RefVec(dir), zonal, k * scale, expected); });
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHEvalConeLight, 64.0);
+
+void Test_D3DXSHEvalSphericalLight(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        const float intensity[3] = { rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f) };
+
+        // 原点から見た球の視半径の円錐で, 放射輝度 1.
+        auto pos    = rng.Vec3();
+        auto radius = rng.Uniform(0.1f, 0.9f) * D3DXVec3Length(&pos);
+        auto rp     = RefVec(pos);
+        auto angle  = std::asin(radius / std::sqrt(RefDot3(rp, rp)));
+        auto cond   = 1.0 / (1.0 - std::cos(angle));
+
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            double zonal[D3DXSH_MAXORDER];
+            RefSHConeZonal(order, angle, zonal);
+            CheckSHLight(ctx, order, intensity, 0.0, cond,
+                [&](float* R, float* G, float* B)
+                { return D3DXSHEvalSphericalLight(order, &pos, radius, intensity[0], intensity[1], intensity[2], R, G, B); },
+                [&](double scale, double* expected)
+                { RefSHZonal(order, RefNormalize3(rp), zonal, scale, expected); });
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHEvalSphericalLight, 64.0);
+
+void Test_D3DXSHEvalHemisphereLight(TestContext& ctx)
+{
+    Random rng;
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        auto dir = rng.Direction();
+        auto top    = D3DXCOLOR(rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), 1.0f);
+        auto bottom = D3DXCOLOR(rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), rng.Uniform(0.0f, 2.0f), 1.0f);
+        const float channel[3] = { 0.0f, 1.0f, 2.0f };
+
+        // 軸方向に Bottom から Top へ線形に変化する放射輝度を 3/2 倍したもの.
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            CheckSHLight(ctx, order, channel, 1.0, 1.0,
+                [&](float* R, float* G, float* B)
+                { return D3DXSHEvalHemisphereLight(order, &dir, top, bottom, R, G, B); },
+                [&](double c, double* expected)
+                {
+                    double t = (&top.r)[int(c)];
+                    double b = (&bottom.r)[int(c)];
+                    double zonal[D3DXSH_MAXORDER] = { t + b, (t - b) / 3.0, 0.0, 0.0, 0.0, 0.0 };
+                    RefSHZonal(order, RefVec(dir), zonal, 1.5, expected);
+                });
+        }
+    }
+}
+TEST_CASE(Test_D3DXSHEvalHemisphereLight, 16.0);
+
+std::vector<D3DXSHLIGHT> RandomSHLights(Random& rng, size_t count)
+{
+    std::vector<D3DXSHLIGHT> lights(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& light = lights[i];
+        light.Type   = D3DXSHLIGHTTYPE(i % 4);
+        light.Vector = (light.Type == D3DXSHLIGHT_SPHERICAL) ? rng.Vec3(10.0f) : rng.Direction();
+        light.Radius = (light.Type == D3DXSHLIGHT_CONE) ? rng.Uniform(0.0f, 3.0f) : rng.Uniform(0.1f, 2.0f);
+        light.Color  = D3DXCOLOR(rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), 1.0f);
+        light.Bottom = D3DXCOLOR(rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), rng.Uniform(0.0f, 1.0f), 1.0f);
+    }
+    return lights;
+}
+
+// 1灯ずつ D3DXSHEval*Light で求めた係数を倍精度で足し合わせる.
+// magnitude には各係数の絶対値の和の最大値を返す.
+void SumSHLights(uint32_t order, const D3DXSHLIGHT* pLights, size_t count, const D3DXVECTOR3& probe, double (*pSum)[kSHMaxCoeffs], double& magnitude)
+{
+    double abs[kSHMaxCoeffs] = {};
+    for (int c = 0; c < 3; ++c)
+    {
+        for (int i = 0; i < kSHMaxCoeffs; ++i)
+        { pSum[c][i] = 0.0; }
+    }
+
+    for (size_t k = 0; k < count; ++k)
+    {
+        const auto& light = pLights[k];
+        float R[kSHMaxCoeffs], G[kSHMaxCoeffs], B[kSHMaxCoeffs];
+        switch (light.Type)
+        {
+        case D3DXSHLIGHT_DIRECTIONAL:
+            D3DXSHEvalDirectionalLight(order, &light.Vector, light.Color.r, light.Color.g, light.Color.b, R, G, B);
+            break;
+
+        case D3DXSHLIGHT_SPHERICAL:
+            {
+                auto pos = light.Vector - probe;
+                D3DXSHEvalSphericalLight(order, &pos, light.Radius, light.Color.r, light.Color.g, light.Color.b, R, G, B);
+            }
+            break;
+
+        case D3DXSHLIGHT_CONE:
+            D3DXSHEvalConeLight(order, &light.Vector, light.Radius, light.Color.r, light.Color.g, light.Color.b, R, G, B);
+            break;
+
+        case D3DXSHLIGHT_HEMISPHERE:
+            D3DXSHEvalHemisphereLight(order, &light.Vector, light.Color, light.Bottom, R, G, B);
+            break;
+        }
+
+        const float* outputs[3] = { R, G, B };
+        for (uint32_t i = 0; i < order * order; ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                pSum[c][i] += outputs[c][i];
+                abs[i] += std::fabs(outputs[c][i]);
+            }
+        }
+    }
+
+    magnitude = 0.0;
+    for (uint32_t i = 0; i < order * order; ++i)
+    { magnitude = std::max(magnitude, abs[i]); }
+}
+
+void Test_D3DXSHEvalLights(TestContext& ctx)
+{
+    Random rng;
+    const auto lights = RandomSHLights(rng, 1024 + 3);
+    const D3DXVECTOR3 origin(0.0f, 0.0f, 0.0f);
+
+    for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+    {
+        float R[kSHMaxCoeffs], G[kSHMaxCoeffs], B[kSHMaxCoeffs];
+        if (order == D3DXSH_MAXORDER)
+        {
+            ctx.Measure(lights.size(), [&]()
+            { D3DXSHEvalLights(order, lights.data(), uint32_t(lights.size()), R, G, B); });
+        }
+
+        ctx.Expect(D3DXSHEvalLights(order, lights.data(), uint32_t(lights.size()), R, G, B) == 0, "D3DXSHEvalLights failed");
+
+        double expected[3][kSHMaxCoeffs];
+        double magnitude = 0.0;
+        SumSHLights(order, lights.data(), lights.size(), origin, expected, magnitude);
+
+        const float* outputs[3] = { R, G, B };
+        for (int c = 0; c < 3; ++c)
+        { CheckValues(ctx, outputs[c], expected[c], int(order * order), magnitude); }
+    }
+
+    // 並列に処理される数のプローブで, 各プローブの値を1灯ずつの和と比べる.
+    const auto probeLights = RandomSHLights(rng, 64 + 1);
+    std::vector<D3DXVECTOR3> probes(1024);
+    for (auto& probe : probes)
+    { probe = rng.Vec3(4.0f); }
+
+    const uint32_t order = 4;
+    const size_t   count = order * order;
+    std::vector<float> R(probes.size() * count), G(R.size()), B(R.size());
+    ctx.Expect(D3DXSHEvalLightsAtProbes(order, probeLights.data(), uint32_t(probeLights.size()),
+        probes.data(), uint32_t(probes.size()), R.data(), G.data(), B.data()) == 0, "D3DXSHEvalLightsAtProbes failed");
+
+    for (size_t p = 0; p < probes.size(); p += 31)
+    {
+        double expected[3][kSHMaxCoeffs];
+        double magnitude = 0.0;
+        SumSHLights(order, probeLights.data(), probeLights.size(), probes[p], expected, magnitude);
+
+        const float* outputs[3] = { &R[p * count], &G[p * count], &B[p * count] };
+        for (int c = 0; c < 3; ++c)
+        { CheckValues(ctx, outputs[c], expected[c], int(count), magnitude); }
+    }
+
+    auto invalid = lights[2];
+    invalid.Radius = 4.0f;
+    float out[kSHMaxCoeffs];
+    ctx.Expect(D3DXSHEvalLights(3, &invalid, 1, out, nullptr, nullptr) != 0, "invalid cone accepted");
+}
+TEST_CASE(Test_D3DXSHEvalLights, 16.0);
+
+// テクセル中心の方向と立体角で重み付けした和を倍精度で求める.
+// magnitude には各係数の絶対値の和を返す.
+void RefSHProjectCubeMap(uint32_t order, uint32_t size, const std::vector<RefVector>* faces, double* pOut[3], double& magnitude)
+{
+    const int count = int(order * order);
+    double sum[3][kSHMaxCoeffs] = {};
+    double abs[kSHMaxCoeffs] = {};
+    double weight = 0.0;
+
+    for (int face = 0; face < 6; ++face)
+    {
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const double u = (2.0 * x + 1.0) / size - 1.0;
+                const double v = (2.0 * y + 1.0) / size - 1.0;
+
+                RefVector dir = { 0.0, 0.0, 0.0, 0.0 };
+                switch (face)
+                {
+                case 0: dir = {  1.0,  -v,  -u, 0.0 }; break;
+                case 1: dir = { -1.0,  -v,   u, 0.0 }; break;
+                case 2: dir = {    u, 1.0,   v, 0.0 }; break;
+                case 3: dir = {    u, -1.0, -v, 0.0 }; break;
+                case 4: dir = {    u,  -v, 1.0, 0.0 }; break;
+                case 5: dir = {   -u,  -v, -1.0, 0.0 }; break;
+                }
+
+                const double len = std::sqrt(1.0 + u * u + v * v);
+                const double w   = 4.0 / (len * len * len);
+                dir = dir * (1.0 / len);
+
+                double Y[kSHMaxCoeffs];
+                RefSHEval(order, dir, Y);
+
+                const auto& color = faces[face][y * size + x];
+                for (int i = 0; i < count; ++i)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    { sum[c][i] += Y[i] * color[c] * w; }
+                    abs[i] += std::fabs(Y[i]) * w;
+                }
+                weight += w;
+            }
+        }
+    }
+
+    const double norm = 4.0 * kPi / weight;
+    magnitude = 0.0;
+    for (int i = 0; i < count; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        { pOut[c][i] = sum[c][i] * norm; }
+        magnitude = std::max(magnitude, abs[i] * norm);
+    }
+}
+
+void Test_D3DXSHProjectCubeMap(TestContext& ctx)
+{
+    struct Case
+    {
+        D3DXSHCUBEFORMAT    Format;
+        uint32_t            Size;
+    };
+    // 4の倍数でない辺と, 並列版に切り替わる大きさを含める.
+    const Case cases[] = {
+        { D3DXSHCUBEFORMAT_A32B32G32R32F, 5 },
+        { D3DXSHCUBEFORMAT_A32B32G32R32F, 64 },
+        { D3DXSHCUBEFORMAT_A16B16G16R16F, 30 },
+        { D3DXSHCUBEFORMAT_A8B8G8R8,      17 },
+    };
+
+    Random rng;
+    for (const auto& c : cases)
+    {
+        const auto texels = size_t(c.Size) * c.Size;
+
+        // 各形式の値を作り, 参照実装には変換後の値を渡す.
+        std::vector<RefVector>   colors[6];
+        std::vector<float>       f32[6];
+        std::vector<D3DXFLOAT16> f16[6];
+        std::vector<uint8_t>     u8[6];
+        const void*              faces[6];
+        uint32_t                 pitch = 0;
+        for (int face = 0; face < 6; ++face)
+        {
+            colors[face].resize(texels);
+            f32[face].resize(texels * 4);
+            f16[face].resize(texels * 4);
+            u8[face].resize(texels * 4);
+            for (size_t i = 0; i < texels * 4; ++i)
+            {
+                const auto value = rng.Uniform(0.0f, 1.0f);
+                f32[face][i] = value;
+                f16[face][i] = D3DXFLOAT16(value);
+                u8[face][i]  = uint8_t(value * 255.0f + 0.5f);
+
+                double ref = value;
+                if (c.Format == D3DXSHCUBEFORMAT_A16B16G16R16F)
+                { ref = float(f16[face][i]); }
+                else if (c.Format == D3DXSHCUBEFORMAT_A8B8G8R8)
+                { ref = u8[face][i] / 255.0; }
+                colors[face][i / 4][i % 4] = ref;
+            }
+
+            switch (c.Format)
+            {
+            case D3DXSHCUBEFORMAT_A32B32G32R32F: faces[face] = f32[face].data(); pitch = c.Size * sizeof(float) * 4; break;
+            case D3DXSHCUBEFORMAT_A16B16G16R16F: faces[face] = f16[face].data(); pitch = c.Size * sizeof(D3DXFLOAT16) * 4; break;
+            case D3DXSHCUBEFORMAT_A8B8G8R8:      faces[face] = u8[face].data();  pitch = c.Size * 4; break;
+            }
+        }
+
+        for (uint32_t order = D3DXSH_MINORDER; order <= D3DXSH_MAXORDER; ++order)
+        {
+            float R[kSHMaxCoeffs], G[kSHMaxCoeffs], B[kSHMaxCoeffs];
+            if (c.Size == 64 && order == D3DXSH_MAXORDER)
+            {
+                ctx.Measure(texels * 6, [&]()
+                { D3DXSHProjectCubeMap(order, faces, c.Size, pitch, c.Format, R, G, B); });
+            }
+
+            ctx.Expect(D3DXSHProjectCubeMap(order, faces, c.Size, pitch, c.Format, R, G, B) == 0, "D3DXSHProjectCubeMap failed");
+
+            double expected[3][kSHMaxCoeffs];
+            double* pExpected[3] = { expected[0], expected[1], expected[2] };
+            double magnitude = 0.0;
+            RefSHProjectCubeMap(order, c.Size, colors, pExpected, magnitude);
+
+            const float* outputs[3] = { R, G, B };
+            for (int ch = 0; ch < 3; ++ch)
+            { CheckValues(ctx, outputs[ch], expected[ch], int(order * order), magnitude); }
+        }
+    }
+
+    float R[kSHMaxCoeffs];
+    const void* faces[6] = {};
+    ctx.Expect(D3DXSHProjectCubeMap(3, faces, 4, 64, D3DXSHCUBEFORMAT_A32B32G32R32F, R, nullptr, nullptr) != 0, "null face accepted");
+}
+TEST_CASE(Test_D3DXSHProjectCubeMap, 64.0);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Float16
+///////////////////////////////////////////////////////////////////////////////
+
+void Test_D3DXFloat16(TestContext& ctx)
+{
+    Random rng;
+    const auto n = kArrayCount + 5;
+    std::vector<float> src(n), back(n);
+    std::vector<D3DXFLOAT16> half(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        // 正規化数, 非正規化数, オーバーフローを含める.
+        switch (i % 4)
+        {
+        case 0:  src[i] = rng.Uniform(-1000.0f, 1000.0f); break;
+        case 1:  src[i] = rng.Uniform(-1.0f, 1.0f); break;
+        case 2:  src[i] = rng.Uniform(-1e-4f, 1e-4f); break;
+        default: src[i] = rng.Uniform(-70000.0f, 70000.0f); break;
+        }
+    }
+
+    ctx.Measure(n, [&]()
+    { D3DXFloat32To16Array(half.data(), src.data(), uint32_t(n)); });
+
+    D3DXFloat16To32Array(back.data(), half.data(), uint32_t(n));
+
+    char message[128];
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto expected = RefFloatToHalf(src[i]);
+        auto actual   = HalfBits(half[i]);
+        snprintf(message, sizeof(message), "D3DXFloat32To16Array(%.9g) = 0x%04x, expected 0x%04x", src[i], actual, expected);
+        ctx.Expect(actual == expected, message);
+
+        if (std::isfinite(RefHalfToFloat(actual)) && ((actual & 0x7C00) != 0x7C00))
+        { ctx.Check(back[i], RefHalfToFloat(actual), 0.0); }
+    }
+}
+TEST_CASE(Test_D3DXFloat16, 0.0);
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    // 引数が指定された場合は名前に含まれるものだけ実行.
+    const char* filter = (argc > 1) ? argv[1] : nullptr;
+
+    // 並列版が複数スレッドで実行されるようにする.
+    D3DXSetWorkerThreadCount(4);
+
+    int failed = 0;
+    for (const auto& test : GetTestCases())
+    {
+        if (filter != nullptr && strstr(test.Name, filter) == nullptr)
+            continue;
+
+        TestContext ctx(test.MaxUlp);
+        test.Function(ctx);
+
+        const auto ok = (ctx.Failures() == 0);
+        printf("%-40s %10.2f ulp (max %7.1f)", test.Name, ctx.WorstUlp(), ctx.MaxUlp());
+        if (ctx.NsPerOp() > 0.0)
+        { printf(" %10.2f ns/op", ctx.NsPerOp()); }
+        else
+        { printf(" %16s", ""); }
+        printf("  %s\n", ok ? "OK" : "FAILED");
+
+        if (!ok)
+        {
+            printf("    %llu / %llu checks failed: %s\n",
+                (unsigned long long)ctx.Failures(), (unsigned long long)ctx.Checks(), ctx.Message());
+            ++failed;
+        }
+    }
+
+    return (failed == 0) ? 0 : 1;
+}